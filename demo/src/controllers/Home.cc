@@ -7,9 +7,12 @@
 #include <json/value.h>
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace demo::controllers {
 namespace {
@@ -19,6 +22,37 @@ const auto kProcessStartedMs = std::chrono::duration_cast<std::chrono::milliseco
 
 using HttpCallback = std::function<void(const drogon::HttpResponsePtr &)>;
 
+bool tokensEqual(const std::string &left, const std::string &right) {
+    if (left.size() != right.size()) {
+        return false;
+    }
+    unsigned char diff = 0;
+    for (std::size_t i = 0; i < left.size(); ++i) {
+        diff |= static_cast<unsigned char>(left[i] ^ right[i]);
+    }
+    return diff == 0;
+}
+
+// Gate for the admin endpoints (/__hydra/reload, /__hydra/prerender). They
+// are off unless `custom_config.hydra_admin.enabled` is true and then take
+// loopback callers only; a non-empty `token` must also be sent as
+// `Authorization: Bearer <token>`, since a reverse proxy on the same host
+// makes every request look local. Returns the rejection, or null.
+drogon::HttpResponsePtr rejectAdminRequest(const drogon::HttpRequestPtr &req) {
+    const auto &admin = drogon::app().getCustomConfig()["hydra_admin"];
+    if (!admin.isObject() || !admin["enabled"].asBool()) {
+        return drogon::HttpResponse::newNotFoundResponse();
+    }
+    const auto token = admin["token"].asString();
+    if (!req->peerAddr().isLoopbackIp() ||
+        (!token.empty() && !tokensEqual(req->getHeader("authorization"), "Bearer " + token))) {
+        auto response = drogon::HttpResponse::newHttpResponse();
+        response->setStatusCode(drogon::k403Forbidden);
+        return response;
+    }
+    return nullptr;
+}
+
 std::string buildPathWithQuery(const drogon::HttpRequestPtr &req) {
     if (!req) {
         return "/";
@@ -98,7 +132,10 @@ class Home final : public drogon::HttpController<Home> {
     ADD_METHOD_TO(Home::redirectHome, "/go-home", drogon::Get);
     ADD_METHOD_TO(Home::notFoundPage, "/not-found", drogon::Get);
     ADD_METHOD_TO(Home::test, "/__hydra/test", drogon::Get);
+    ADD_METHOD_TO(Home::ready, "/__hydra/ready", drogon::Get);
     ADD_METHOD_TO(Home::metrics, "/__hydra/metrics", drogon::Get);
+    ADD_METHOD_TO(Home::reload, "/__hydra/reload", drogon::Post);
+    ADD_METHOD_TO(Home::prerender, "/__hydra/prerender", drogon::Post);
     METHOD_LIST_END
 
     void index(const drogon::HttpRequestPtr &req,
@@ -135,6 +172,10 @@ class Home final : public drogon::HttpController<Home> {
             props["__hydra_test"] = std::move(testConfig);
         }
 
+        if (wantsStream(req)) {
+            streamPage(req, std::move(callback), std::move(props));
+            return;
+        }
         renderPage(req, std::move(callback), std::move(props));
     }
 
@@ -162,6 +203,10 @@ class Home final : public drogon::HttpController<Home> {
             path,
             pathWithQuery);
 
+        if (wantsStream(req)) {
+            streamPage(req, std::move(callback), std::move(props));
+            return;
+        }
         renderPage(req, std::move(callback), std::move(props));
     }
 
@@ -219,6 +264,25 @@ class Home final : public drogon::HttpController<Home> {
         callback(drogon::HttpResponse::newHttpJsonResponse(payload));
     }
 
+    // Readiness probe: 503 until the isolate pool has finished warm-up, so a
+    // load balancer only routes to warmed instances.
+    void ready(const drogon::HttpRequestPtr &,
+               HttpCallback &&callback) const {
+        auto hydra = drogon::app().getPlugin<hydra::HydraSsrPlugin>();
+        const auto readiness = hydra->readiness();
+        Json::Value payload;
+        payload["ready"] = readiness.ready;
+        payload["generation"] = static_cast<Json::UInt64>(readiness.generation);
+        if (!readiness.ready) {
+            payload["reason"] = readiness.reason;
+        }
+        auto response = drogon::HttpResponse::newHttpJsonResponse(payload);
+        response->setStatusCode(readiness.ready ? drogon::k200OK
+                                                : drogon::k503ServiceUnavailable);
+        response->addHeader("Cache-Control", "no-store");
+        callback(response);
+    }
+
     void metrics(const drogon::HttpRequestPtr &,
                  HttpCallback &&callback) const {
         auto hydra = drogon::app().getPlugin<hydra::HydraSsrPlugin>();
@@ -229,22 +293,84 @@ class Home final : public drogon::HttpController<Home> {
         callback(response);
     }
 
+    // Swaps in the SSR bundle and manifest currently on disk, e.g.
+    // `curl -X POST localhost:8080/__hydra/reload` after a deploy. Admin
+    // endpoint, see rejectAdminRequest().
+    void reload(const drogon::HttpRequestPtr &req,
+                HttpCallback &&callback) const {
+        if (auto rejection = rejectAdminRequest(req)) {
+            callback(rejection);
+            return;
+        }
+        auto hydra = drogon::app().getPlugin<hydra::HydraSsrPlugin>();
+        hydra->reloadAsync("admin", [callback = std::move(callback)](hydra::ReloadResult result) {
+            Json::Value payload;
+            payload["ok"] = result.ok;
+            payload["generation"] = static_cast<Json::UInt64>(result.generation);
+            payload["message"] = result.message;
+            auto response = drogon::HttpResponse::newHttpJsonResponse(payload);
+            if (!result.ok) {
+                response->setStatusCode(drogon::k500InternalServerError);
+            }
+            callback(response);
+        });
+    }
+
+    // Queues prerendered routes for regeneration; a JSON body of
+    // `{"paths": ["/", ...]}` limits it to those routes. Admin endpoint, see
+    // rejectAdminRequest().
+    void prerender(const drogon::HttpRequestPtr &req,
+                   HttpCallback &&callback) const {
+        if (auto rejection = rejectAdminRequest(req)) {
+            callback(rejection);
+            return;
+        }
+        std::vector<std::string> paths;
+        const auto body = req->getJsonObject();
+        if (body && (*body)["paths"].isArray()) {
+            for (const auto &path : (*body)["paths"]) {
+                if (path.isString()) {
+                    paths.push_back(path.asString());
+                }
+            }
+        }
+        auto hydra = drogon::app().getPlugin<hydra::HydraSsrPlugin>();
+        Json::Value payload;
+        payload["queued"] = static_cast<Json::UInt64>(hydra->prerender(paths));
+        callback(drogon::HttpResponse::newHttpJsonResponse(payload));
+    }
+
   private:
     void renderPage(const drogon::HttpRequestPtr &req,
                     HttpCallback &&callback,
                     Json::Value props) const {
         auto hydra = drogon::app().getPlugin<hydra::HydraSsrPlugin>();
-        const auto rendered = hydra->renderResult(req, props);
+        hydra->renderResultAsync(
+            req,
+            std::move(props),
+            {},
+            [callback = std::move(callback)](hydra::SsrRenderResult rendered) {
+                auto response = drogon::HttpResponse::newHttpResponse();
+                const auto normalizedStatus = std::clamp(rendered.status, 100, 599);
+                response->setStatusCode(static_cast<drogon::HttpStatusCode>(normalizedStatus));
+                response->setContentTypeCode(drogon::CT_TEXT_HTML);
+                response->setBody(std::move(rendered.html));
+                for (const auto &[headerName, headerValue] : rendered.headers) {
+                    response->addHeader(headerName, headerValue);
+                }
+                callback(response);
+            });
+    }
 
-        auto response = drogon::HttpResponse::newHttpResponse();
-        const auto normalizedStatus = std::clamp(rendered.status, 100, 599);
-        response->setStatusCode(static_cast<drogon::HttpStatusCode>(normalizedStatus));
-        response->setContentTypeCode(drogon::CT_TEXT_HTML);
-        response->setBody(rendered.html);
-        for (const auto &[headerName, headerValue] : rendered.headers) {
-            response->addHeader(headerName, headerValue);
-        }
-        callback(response);
+    static bool wantsStream(const drogon::HttpRequestPtr &req) {
+        return req->getParameter("stream") == "1";
+    }
+
+    void streamPage(const drogon::HttpRequestPtr &req,
+                    HttpCallback &&callback,
+                    Json::Value props) const {
+        auto hydra = drogon::app().getPlugin<hydra::HydraSsrPlugin>();
+        hydra->renderStream(req, std::move(props), {}, std::move(callback));
     }
 };
 
@@ -0,0 +1,326 @@
+#include "hydra/HtmlEscape.h"
+#include "hydra/HtmlShell.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+hydra::HtmlShellAssets makeAssets() {
+    hydra::HtmlShellAssets assets;
+    assets.title = "HydraStack <Demo> & Friends";
+    assets.description = "Server-rendered React on Drogon with \"fast\" hydration.";
+    assets.canonicalUrl = "https://example.com/posts/123?ref=bench&x=1";
+    assets.robots = "index,follow";
+    assets.imageUrl = "https://example.com/og.png";
+    assets.siteName = "HydraStack";
+    assets.cssPath = "/assets/app-4f2c1a.css";
+    assets.clientJsPath = "/assets/client-9b7e21.js";
+    return assets;
+}
+
+std::string makeAppHtml() {
+    std::string html;
+    for (int i = 0; i < 120; ++i) {
+        html += "<article class=\"post\"><h2>Post " + std::to_string(i) +
+                "</h2><p>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</p></article>";
+    }
+    return html;
+}
+
+std::string makePropsJson() {
+    std::string json = "{\"page\":\"home\",\"posts\":[";
+    for (int i = 0; i < 60; ++i) {
+        if (i > 0) {
+            json += ",";
+        }
+        json += "{\"id\":" + std::to_string(i) +
+                ",\"title\":\"Post <" + std::to_string(i) + "> & more\",\"likes\":42}";
+    }
+    json += "],\"__hydra_request\":{\"routeUrl\":\"/\",\"requestId\":\"hydra-bench\"}}";
+    return json;
+}
+
+// The ostringstream wrap HtmlShell used before the shell was compiled,
+// kept here as the baseline (HtmlShell::wrap now forwards to
+// CompiledHtmlShell). HMR and dev-reload scripts are left out; the bench
+// assets set neither.
+namespace baseline {
+
+std::string escapeHtmlText(std::string_view value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const auto ch : value) {
+        switch (ch) {
+            case '&':
+                escaped.append("&amp;");
+                break;
+            case '<':
+                escaped.append("&lt;");
+                break;
+            case '>':
+                escaped.append("&gt;");
+                break;
+            default:
+                escaped.push_back(ch);
+                break;
+        }
+    }
+    return escaped;
+}
+
+std::string escapeHtmlAttribute(std::string_view value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const auto ch : value) {
+        switch (ch) {
+            case '&':
+                escaped.append("&amp;");
+                break;
+            case '<':
+                escaped.append("&lt;");
+                break;
+            case '>':
+                escaped.append("&gt;");
+                break;
+            case '"':
+                escaped.append("&quot;");
+                break;
+            default:
+                escaped.push_back(ch);
+                break;
+        }
+    }
+    return escaped;
+}
+
+std::string escapeForScriptTag(std::string_view value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char ch : value) {
+        switch (ch) {
+            case '<':
+                escaped.append("\\u003c");
+                break;
+            case '>':
+                escaped.append("\\u003e");
+                break;
+            case '&':
+                escaped.append("\\u0026");
+                break;
+            default:
+                escaped.push_back(ch);
+                break;
+        }
+    }
+    return escaped;
+}
+
+void appendMetaName(std::ostringstream &html,
+                    std::string_view name,
+                    const std::string &content) {
+    if (content.empty()) {
+        return;
+    }
+    html << "    <meta name=\"" << name << "\" content=\""
+         << escapeHtmlAttribute(content) << "\" />\n";
+}
+
+void appendMetaProperty(std::ostringstream &html,
+                        std::string_view property,
+                        const std::string &content) {
+    if (content.empty()) {
+        return;
+    }
+    html << "    <meta property=\"" << property << "\" content=\""
+         << escapeHtmlAttribute(content) << "\" />\n";
+}
+
+std::string shellPrefix(const hydra::HtmlShellAssets &assets) {
+    std::ostringstream html;
+    html << "<!doctype html>\n"
+         << "<html lang=\"en\">\n"
+         << "  <head>\n"
+         << "    <meta charset=\"utf-8\" />\n"
+         << "    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1\" />\n"
+         << "    <title>" << escapeHtmlText(assets.title.empty() ? "HydraStack" : assets.title)
+         << "</title>\n";
+
+    const auto title = assets.title.empty() ? std::string("HydraStack") : assets.title;
+    const auto twitterCard = !assets.twitterCard.empty()
+                                 ? assets.twitterCard
+                                 : (assets.imageUrl.empty() ? "summary" : "summary_large_image");
+    appendMetaName(html, "description", assets.description);
+    appendMetaName(html, "robots", assets.robots);
+    appendMetaProperty(html, "og:title", title);
+    appendMetaProperty(html, "og:description", assets.description);
+    appendMetaProperty(html, "og:type", assets.ogType.empty() ? "website" : assets.ogType);
+    appendMetaProperty(html, "og:url", assets.canonicalUrl);
+    appendMetaProperty(html, "og:image", assets.imageUrl);
+    appendMetaProperty(html, "og:site_name", assets.siteName);
+    appendMetaName(html, "twitter:card", twitterCard);
+    appendMetaName(html, "twitter:title", title);
+    appendMetaName(html, "twitter:description", assets.description);
+    appendMetaName(html, "twitter:image", assets.imageUrl);
+    if (!assets.canonicalUrl.empty()) {
+        html << "    <link rel=\"canonical\" href=\""
+             << escapeHtmlAttribute(assets.canonicalUrl) << "\" />\n";
+    }
+
+    html << "    <link rel=\"preconnect\" href=\"https://fonts.googleapis.com\" />\n"
+         << "    <link rel=\"preconnect\" href=\"https://fonts.gstatic.com\" crossorigin />\n"
+         << "    <link rel=\"stylesheet\" href=\"https://fonts.googleapis.com/css2?family=Sora:wght@400;500;600;700&display=swap\" />\n";
+
+    if (!assets.cssPath.empty()) {
+        html << "    <link rel=\"stylesheet\" href=\"" << assets.cssPath << "\" />\n";
+    }
+
+    html << "  </head>\n"
+         << "  <body>\n"
+         << "    <div id=\"root\">";
+    return html.str();
+}
+
+std::string shellSuffix(const std::string &propsJson, const hydra::HtmlShellAssets &assets) {
+    std::ostringstream html;
+    const auto nonceAttr =
+        assets.scriptNonce.empty() ? std::string() : " nonce=\"" + assets.scriptNonce + "\"";
+
+    html << "</div>\n"
+         << "    <script id=\"__HYDRA_PROPS__\" type=\"application/json\"" << nonceAttr << ">"
+         << escapeForScriptTag(propsJson) << "</script>\n";
+
+    if (!assets.clientJsPath.empty()) {
+        if (assets.clientJsModule) {
+            html << "    <script type=\"module\" src=\"" << assets.clientJsPath
+                 << "\"" << nonceAttr << "></script>\n";
+        } else {
+            html << "    <script src=\"" << assets.clientJsPath << "\" defer"
+                 << nonceAttr << "></script>\n";
+        }
+    }
+
+    html << "  </body>\n"
+         << "</html>\n";
+    return html.str();
+}
+
+std::string wrap(const std::string &appHtml,
+                 const std::string &propsJson,
+                 const hydra::HtmlShellAssets &assets) {
+    auto html = shellPrefix(assets);
+    html.append(appHtml);
+    html.append(shellSuffix(propsJson, assets));
+    return html;
+}
+
+}  // namespace baseline
+
+template <typename Fn>
+double nsPerPage(std::uint64_t iterations, Fn &&fn) {
+    std::size_t sink = 0;
+    const auto startedAt = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+        sink += fn().size();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - startedAt;
+    if (sink == 0) {
+        std::cerr << "[html-shell-bench] empty output\n";
+    }
+    return static_cast<double>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           static_cast<double>(iterations);
+}
+
+void report(const std::string &label, double ns, double baselineNs) {
+    std::cout << "[html-shell-bench] " << std::left << std::setw(24) << label << std::right
+              << std::fixed << std::setprecision(0) << std::setw(10) << ns << " ns/page"
+              << std::setprecision(2) << "  x" << (baselineNs / ns) << '\n';
+}
+
+}  // namespace
+
+// Usage: hydra_html_shell_bench [iterations]
+int main(int argc, char **argv) {
+    const std::uint64_t iterations =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    if (iterations == 0) {
+        std::cerr << "[html-shell-bench] iterations must be > 0\n";
+        return 1;
+    }
+
+    auto assets = makeAssets();
+    assets.scriptNonce = "bench-nonce-0123456789abcdef";
+    const auto appHtml = makeAppHtml();
+    const auto propsJson = makePropsJson();
+    const hydra::CompiledHtmlShell compiled(assets);
+    hydra::HtmlShellPageMeta pageMeta;
+    pageMeta.title = "Post 123: Controller-provided test data";
+
+    if (baseline::wrap(appHtml, propsJson, assets) !=
+        compiled.wrap(appHtml, propsJson, {}, assets.scriptNonce)) {
+        std::cerr << "[html-shell-bench] baseline and compiled output differ\n";
+        return 1;
+    }
+
+    // Warm caches and the allocator before timing.
+    (void)nsPerPage(iterations / 10 + 1,
+                    [&] { return baseline::wrap(appHtml, propsJson, assets); });
+
+    const auto baselineNs = nsPerPage(
+        iterations, [&] { return baseline::wrap(appHtml, propsJson, assets); });
+    const auto oneShotNs = nsPerPage(
+        iterations, [&] { return hydra::HtmlShell::wrap(appHtml, propsJson, assets); });
+    const auto compiledNs = nsPerPage(iterations, [&] {
+        return compiled.wrap(appHtml, propsJson, {}, assets.scriptNonce);
+    });
+    const auto compiledMetaNs = nsPerPage(iterations, [&] {
+        return compiled.wrap(appHtml, propsJson, pageMeta, assets.scriptNonce);
+    });
+
+    std::cout << "[html-shell-bench] iterations=" << iterations
+              << " app_bytes=" << appHtml.size() << " props_bytes=" << propsJson.size()
+              << '\n';
+    report("ostringstream baseline", baselineNs, baselineNs);
+    report("HtmlShell::wrap", oneShotNs, baselineNs);
+    report("compiled wrap", compiledNs, baselineNs);
+    report("compiled wrap +page meta", compiledMetaNs, baselineNs);
+
+    // Props escaping on a large product-page payload, per scanning kernel.
+    std::string largeProps;
+    while (largeProps.size() < 128 * 1024) {
+        largeProps += propsJson;
+    }
+    const auto escapeIterations = iterations / 50 + 1;
+    std::cout << "[html-shell-bench] escape props_bytes=" << largeProps.size()
+              << " active=" << hydra::html_escape::kernelName(hydra::html_escape::activeKernel())
+              << '\n';
+    double scalarNs = 0;
+    for (const auto kernel : {hydra::html_escape::Kernel::Scalar,
+                              hydra::html_escape::Kernel::Sse2,
+                              hydra::html_escape::Kernel::Avx2,
+                              hydra::html_escape::Kernel::Neon}) {
+        if (!hydra::html_escape::kernelSupported(kernel)) {
+            continue;
+        }
+        const auto ns = nsPerPage(escapeIterations, [&] {
+            std::string out;
+            out.reserve(hydra::html_escape::escapedSize(
+                largeProps, hydra::html_escape::Mode::ScriptTag, kernel));
+            hydra::html_escape::appendEscaped(
+                out, largeProps, hydra::html_escape::Mode::ScriptTag, kernel);
+            return out;
+        });
+        if (kernel == hydra::html_escape::Kernel::Scalar) {
+            scalarNs = ns;
+        }
+        report(std::string("escape ") + hydra::html_escape::kernelName(kernel), ns, scalarNs);
+    }
+    return 0;
+}
@@ -0,0 +1,423 @@
+#include "hydra/HtmlEscape.h"
+#include "hydra/HtmlShell.h"
+#include "hydra/PropsJson.h"
+#include "hydra/RequestContext.h"
+#include "hydra/SsrEnvelope.h"
+
+#include <drogon/HttpRequest.h>
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr const char *kUsage =
+    "Usage: hydra_request_bench [options]\n"
+    "\n"
+    "Times the helpers that run on every SSR request, on inputs sized like\n"
+    "busy production traffic.\n"
+    "\n"
+    "  --iterations N           calls per case for the cheapest cases (200000)\n"
+    "  --filter TEXT            only cases whose name contains TEXT\n"
+    "  --out PATH               write the JSON report here as well\n"
+    "  --baseline PATH          compare against a stored report\n"
+    "  --tolerance-pct P        allowed ns/op increase per case (25)\n"
+    "\n"
+    "Exit status: 0 ok, 1 error, 2 regression against --baseline.\n";
+
+struct Options {
+    std::uint64_t iterations = 200000;
+    std::string filter;
+    std::string outPath;
+    std::string baselinePath;
+    double tolerancePct = 25.0;
+};
+
+Options parseOptions(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") {
+            std::cout << kUsage;
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::runtime_error(flag + " needs a value");
+        }
+        const std::string value = argv[++i];
+        if (flag == "--iterations") {
+            options.iterations = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--filter") {
+            options.filter = value;
+        } else if (flag == "--out") {
+            options.outPath = value;
+        } else if (flag == "--baseline") {
+            options.baselinePath = value;
+        } else if (flag == "--tolerance-pct") {
+            options.tolerancePct = std::strtod(value.c_str(), nullptr);
+        } else {
+            throw std::runtime_error("unknown option " + flag);
+        }
+    }
+    if (options.iterations == 0) {
+        throw std::runtime_error("--iterations must be > 0");
+    }
+    return options;
+}
+
+// What a browser with a long language list sends, plus the odd malformed
+// entry and wildcard.
+std::string makeAcceptLanguage() {
+    return "fr-CH, fr;q=0.9, en;q=0.8, de;q=0.7, *;q=0.5, pt-BR;q=0.45, pt;q=0.4, "
+           "es-419;q=0.35, es;q=0.3, it;q=0.25, nl;q=0.2, sv;q=0.15, zh-Hant-TW;q=0.12, "
+           "zh;q=0.1, ja;q=0.09, ko;q=0.08, ru;q=0.07, pl;q=0.06, tr;q=0.05, "
+           "ar;q=0.04, he;q=0.03, hi;q=0.02, q=bad;q=x, ;q=0.01";
+}
+
+// Analytics, consent and session cookies: about 4 KiB in 40 entries.
+std::vector<std::pair<std::string, std::string>> makeCookieJar() {
+    std::vector<std::pair<std::string, std::string>> cookies = {
+        {"hydra_lang", "fr-CH"},
+        {"hydra_theme", "sunset"},
+        {"session", std::string(96, 's')},
+    };
+    for (int i = 0; cookies.size() < 40; ++i) {
+        cookies.emplace_back("_tracker_" + std::to_string(i),
+                             std::string(96, static_cast<char>('a' + i % 26)));
+    }
+    return cookies;
+}
+
+drogon::HttpRequestPtr makeRequest() {
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setMethod(drogon::Get);
+    req->setPath("/products/sku-123456/reviews");
+    req->setParameter("page", "2");
+    req->setParameter("sort", "newest");
+    req->addHeader("host", "shop.example.com");
+    req->addHeader("x-forwarded-host", "www.example.com, edge.internal");
+    req->addHeader("x-forwarded-proto", "https");
+    req->addHeader("x-forwarded-for", "203.0.113.7, 10.0.0.2");
+    req->addHeader("x-request-id", "  edge-7f3a9c2e-4b1d-4e8f-9a6b-2c5d8e1f0a3b-retry#2  ");
+    req->addHeader("accept-language", makeAcceptLanguage());
+    req->addHeader("user-agent",
+                   "Mozilla/5.0 (Macintosh; Intel Mac OS X 14_5) AppleWebKit/605.1.15 "
+                   "(KHTML, like Gecko) Version/17.5 Safari/605.1.15");
+    req->addHeader("accept", "text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8");
+    req->addHeader("accept-encoding", "gzip, deflate, br, zstd");
+    req->addHeader("authorization", "Bearer " + std::string(600, 't'));
+    req->addHeader("referer", "https://www.example.com/products/sku-123456");
+    req->addHeader("sec-ch-ua", "\"Chromium\";v=\"126\", \"Not.A/Brand\";v=\"24\"");
+    req->addHeader("sec-fetch-mode", "navigate");
+    std::string cookieHeader;
+    for (const auto &[name, value] : makeCookieJar()) {
+        req->addCookie(name, value);
+        if (!cookieHeader.empty()) {
+            cookieHeader.append("; ");
+        }
+        cookieHeader.append(name + "=" + value);
+    }
+    req->addHeader("cookie", cookieHeader);
+    return req;
+}
+
+hydra::RequestContextOptions makeContextOptions() {
+    hydra::RequestContextOptions options;
+    options.supportedLocaleOrder = {"en", "fr", "fr-ch", "de", "pt-br", "es", "zh-hant"};
+    options.supportedLocales = {options.supportedLocaleOrder.begin(),
+                                options.supportedLocaleOrder.end()};
+    options.includeLocaleCandidates = true;
+    options.supportedThemeOrder = {"ocean", "sunset", "forest"};
+    options.supportedThemes = {options.supportedThemeOrder.begin(),
+                               options.supportedThemeOrder.end()};
+    return options;
+}
+
+// About 100 KiB of product-listing props with a __hydra_route block.
+std::string makeLargeProps() {
+    std::string json = "{\"__hydra_route\":{\"pageId\":\"product\"},\"items\":[";
+    for (int i = 0; json.size() < 100 * 1024; ++i) {
+        if (i > 0) {
+            json += ",";
+        }
+        json += "{\"id\":" + std::to_string(i) + ",\"name\":\"Item <" + std::to_string(i) +
+                "> & \\\"co\\\"\",\"price\":19.99,\"tags\":[\"new\",\"sale\"],"
+                "\"blurb\":\"Lorem ipsum dolor sit amet, consectetur adipiscing elit.\"}";
+    }
+    json += "]}";
+    return json;
+}
+
+// What render() returns for a content-heavy page: ~200 KiB of HTML plus
+// headers and full SEO meta.
+std::string makeLargeEnvelope() {
+    std::string html;
+    for (int i = 0; html.size() < 200 * 1024; ++i) {
+        html += "<article class=\"post\"><h2>Post " + std::to_string(i) +
+                "</h2><p>Lorem ipsum dolor sit amet, \"consectetur\" adipiscing elit.</p>"
+                "</article>\n";
+    }
+    Json::Value envelope(Json::objectValue);
+    envelope["html"] = html;
+    envelope["status"] = 200;
+    envelope["headers"]["Cache-Control"] = "public, max-age=60";
+    envelope["headers"]["X-Render-Route"] = "product";
+    envelope["headers"]["X-Experiment"] = true;
+    envelope["meta"]["title"] = "Product 123456 reviews";
+    envelope["meta"]["description"] = std::string(300, 'd');
+    envelope["meta"]["canonicalUrl"] = "https://www.example.com/products/sku-123456/reviews";
+    envelope["meta"]["ogType"] = "product";
+    envelope["meta"]["imageUrl"] = "https://cdn.example.com/sku-123456.jpg";
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, envelope);
+}
+
+struct CaseResult {
+    std::string name;
+    std::uint64_t iterations = 0;
+    double nsPerOp = 0;
+};
+
+class Bench {
+  public:
+    explicit Bench(const Options &options) : options_(options) {}
+
+    // `fn` returns something with size(); `divisor` scales the iteration
+    // count down for cases that touch ~100 KiB per call.
+    template <typename Fn>
+    void run(const std::string &name, std::uint64_t divisor, Fn &&fn) {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) {
+            return;
+        }
+        const auto iterations = options_.iterations / divisor + 1;
+        std::size_t sink = 0;
+        // Warm caches and the allocator before timing.
+        for (std::uint64_t i = 0; i < iterations / 10 + 1; ++i) {
+            sink += fn().size();
+        }
+        const auto startedAt = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            sink += fn().size();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - startedAt;
+        if (sink == 0) {
+            std::cerr << "[request-bench] " << name << ": empty output\n";
+        }
+        CaseResult result{name, iterations,
+                          static_cast<double>(
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                                  .count()) /
+                              static_cast<double>(iterations)};
+        std::cout << "[request-bench] " << std::left << std::setw(34) << name << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(12) << result.nsPerOp
+                  << " ns/op\n";
+        results_.push_back(std::move(result));
+    }
+
+    [[nodiscard]] const std::vector<CaseResult> &results() const {
+        return results_;
+    }
+
+  private:
+    const Options &options_;
+    std::vector<CaseResult> results_;
+};
+
+Json::Value toJson(const Options &options, const std::vector<CaseResult> &results) {
+    Json::Value report(Json::objectValue);
+    report["iterations"] = static_cast<Json::UInt64>(options.iterations);
+    report["cases"] = Json::Value(Json::objectValue);
+    for (const auto &result : results) {
+        Json::Value entry(Json::objectValue);
+        entry["iterations"] = static_cast<Json::UInt64>(result.iterations);
+        entry["ns_per_op"] = result.nsPerOp;
+        report["cases"][result.name] = std::move(entry);
+    }
+    return report;
+}
+
+Json::Value readJsonFile(const std::string &path) {
+    std::ifstream input(path);
+    if (!input) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    Json::CharReaderBuilder builder;
+    Json::Value value;
+    JSONCPP_STRING errors;
+    if (!Json::parseFromStream(builder, input, &value, &errors) || !value.isObject()) {
+        throw std::runtime_error(path + " is not a JSON object: " + errors);
+    }
+    return value;
+}
+
+// Cases missing from either side are skipped, so the baseline can be
+// extended without failing older reports.
+bool reportRegressions(const std::vector<CaseResult> &results,
+                       const Json::Value &baseline,
+                       double tolerancePct) {
+    bool regressed = false;
+    const auto &cases = baseline["cases"];
+    for (const auto &result : results) {
+        if (!cases.isObject() || !cases.isMember(result.name)) {
+            continue;
+        }
+        const auto baselineNs = cases[result.name]["ns_per_op"].asDouble();
+        if (baselineNs <= 0.0) {
+            continue;
+        }
+        const auto deltaPct = (result.nsPerOp - baselineNs) / baselineNs * 100.0;
+        const bool slower = deltaPct > tolerancePct;
+        regressed = regressed || slower;
+        std::cout << "[request-bench] " << (slower ? "REGRESSION " : "ok         ") << std::left
+                  << std::setw(34) << result.name << std::right << std::showpos << std::fixed
+                  << std::setprecision(1) << deltaPct << std::noshowpos << "% vs baseline\n";
+    }
+    return regressed;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    try {
+        const auto options = parseOptions(argc, argv);
+
+        const auto req = makeRequest();
+        const auto contextOptions = makeContextOptions();
+        auto uncachedOptions = contextOptions;
+        uncachedOptions.localeCacheEntries = 0;
+        auto cookieOptions = contextOptions;
+        cookieOptions.includeCookies = true;
+        cookieOptions.includeCookieMap = true;
+        auto allowlistOptions = cookieOptions;
+        allowlistOptions.allowedCookies = {"session", "hydra_lang", "hydra_theme"};
+        allowlistOptions.headerAllowlist = {"accept-language", "user-agent", "referer"};
+        auto lazyOptions = cookieOptions;
+        lazyOptions.lazyDetails = true;
+        const hydra::RequestContextBuilder contextBuilder(contextOptions);
+        const hydra::RequestContextBuilder uncachedBuilder(uncachedOptions);
+        const hydra::RequestContextBuilder cookieBuilder(cookieOptions);
+        const hydra::RequestContextBuilder allowlistBuilder(allowlistOptions);
+        const hydra::RequestContextBuilder lazyBuilder(lazyOptions);
+
+        const auto acceptLanguage = makeAcceptLanguage();
+        const auto rawRequestId = req->getHeader("x-request-id");
+        const auto largeProps = makeLargeProps();
+        const auto largeEnvelope = makeLargeEnvelope();
+        const auto parsedEnvelope = *hydra::tryParseSsrEnvelope(largeEnvelope);
+        const auto routeUrl = std::string("/products/sku-123456/reviews?page=2&sort=newest");
+        const auto requestContextJson = [&] {
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            return Json::writeString(
+                builder,
+                contextBuilder.build(req, routeUrl, "bench"));
+        }();
+
+        hydra::HtmlShellAssets assets;
+        assets.title = "Product 123456 reviews";
+        assets.cssPath = "/assets/app-4f2c1a.css";
+        assets.clientJsPath = "/assets/client-9b7e21.js";
+        assets.scriptNonce = "bench-nonce-0123456789abcdef";
+
+        std::cout << "[request-bench] iterations=" << options.iterations
+                  << " accept_language_bytes=" << acceptLanguage.size()
+                  << " cookies=" << req->getCookies().size()
+                  << " props_bytes=" << largeProps.size()
+                  << " envelope_bytes=" << largeEnvelope.size() << '\n';
+
+        Bench bench(options);
+        namespace rc = hydra::request_context;
+        bench.run("parseAcceptLanguageCandidates", 1, [&] {
+            return rc::parseAcceptLanguageCandidates(acceptLanguage);
+        });
+        bench.run("localeFallbackChain", 1, [&] {
+            return rc::localeFallbackChain(rc::normalizeLocaleTag("zh_Hant_TW-x-private"));
+        });
+        bench.run("sanitizeRequestId", 1, [&] {
+            return rc::sanitizeRequestId(rc::firstHeaderToken(rawRequestId));
+        });
+        bench.run("generateScriptNonce", 1, [] { return rc::generateScriptNonce(); });
+        bench.run("buildRequestContext", 10, [&] {
+            return contextBuilder.build(req, routeUrl, "bench").getMemberNames();
+        });
+        bench.run("buildRequestContext uncached", 10, [&] {
+            return uncachedBuilder.build(req, routeUrl, "bench").getMemberNames();
+        });
+        bench.run("buildRequestContext +cookies", 10, [&] {
+            return cookieBuilder.build(req, routeUrl, "bench").getMemberNames();
+        });
+        bench.run("buildRequestContext +allowlists", 10, [&] {
+            return allowlistBuilder.build(req, routeUrl, "bench").getMemberNames();
+        });
+        bench.run("buildRequestContext lazy", 10, [&] {
+            return lazyBuilder.build(req, routeUrl, "bench").getMemberNames();
+        });
+        bench.run("props scan+splice 100KiB", 100, [&] {
+            const auto shape = hydra::props_json::scanObject(largeProps);
+            return hydra::props_json::appendMember(
+                largeProps, shape, "__hydra_request", requestContextJson);
+        });
+        bench.run("tryParseSsrEnvelope 200KiB", 200, [&] {
+            return hydra::tryParseSsrEnvelope(largeEnvelope)->html;
+        });
+        bench.run("finishSsrEnvelope 200KiB", 200, [&] {
+            // The object path: fields already read off V8, html copied once.
+            hydra::SsrEnvelopeFields fields;
+            fields.html = parsedEnvelope.html;
+            fields.status = 200.0;
+            fields.headers.assign(parsedEnvelope.headers.begin(), parsedEnvelope.headers.end());
+            fields.meta = {{"title", parsedEnvelope.title},
+                           {"description", parsedEnvelope.description},
+                           {"canonicalUrl", parsedEnvelope.canonicalUrl},
+                           {"ogType", parsedEnvelope.ogType},
+                           {"imageUrl", parsedEnvelope.imageUrl}};
+            return hydra::finishSsrEnvelope(std::move(fields)).html;
+        });
+        bench.run("tryParseSsrEnvelope bare html", 1, [&] {
+            // The common case: render() returned HTML, rejected on byte one.
+            return hydra::tryParseSsrEnvelope(parsedEnvelope.html).has_value() ? std::string("x")
+                                                                             : std::string("-");
+        });
+        bench.run("HtmlShell::wrap 200KiB+100KiB", 200, [&] {
+            return hydra::HtmlShell::wrap(parsedEnvelope.html, largeProps, assets);
+        });
+        for (const auto mode : {hydra::html_escape::Mode::ScriptTag,
+                                hydra::html_escape::Mode::HtmlText,
+                                hydra::html_escape::Mode::HtmlAttribute,
+                                hydra::html_escape::Mode::JsString}) {
+            static constexpr const char *kModeNames[] = {"text", "attribute", "script", "js"};
+            bench.run(std::string("escape ") + kModeNames[static_cast<int>(mode)] + " 100KiB",
+                      100,
+                      [&] { return hydra::html_escape::escape(largeProps, mode); });
+        }
+
+        const auto report = toJson(options, bench.results());
+        if (!options.outPath.empty()) {
+            std::ofstream output(options.outPath, std::ios::trunc);
+            output << report.toStyledString();
+            if (!output) {
+                throw std::runtime_error("cannot write " + options.outPath);
+            }
+        }
+        if (!options.baselinePath.empty() &&
+            reportRegressions(bench.results(), readJsonFile(options.baselinePath),
+                              options.tolerancePct)) {
+            return 2;
+        }
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[request-bench] " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,674 @@
+#include "hydra/HydraSsrPlugin.h"
+#include "hydra/LatencyHistogram.h"
+// Complete type for HydraSsrPlugin's constructor, which is used directly here.
+#include "hydra/RenderExecutor.h"
+#include "hydra/V8IsolatePool.h"
+#include "hydra/V8Platform.h"
+
+#include <drogon/HttpClient.h>
+#include <drogon/drogon.h>
+#include <json/reader.h>
+#include <json/writer.h>
+#include <trantor/net/EventLoopThread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr const char *kUsage =
+    "Usage: hydra_bench [--mode pool|plugin|http] [options]\n"
+    "\n"
+    "  pool    renders through V8IsolatePool directly (bundle only)\n"
+    "  plugin  renders through HydraSsrPlugin::renderResult (full config)\n"
+    "  http    drives a running hydra_demo over HTTP/1.1 keep-alive\n"
+    "\n"
+    "  --concurrency N          closed-loop workers (8)\n"
+    "  --pool-size N            runtimes for pool/plugin modes (4)\n"
+    "  --duration-s S           measured seconds (10)\n"
+    "  --warmup-s S             unmeasured seconds first (1)\n"
+    "  --props-kb K             pad props to about K KiB (0, pool/plugin)\n"
+    "  --burn-ms M              __hydra_test burnMs per render (0)\n"
+    "  --bridge-path P          __hydra_test bridgePath per render\n"
+    "  --bundle PATH            ./public/assets/ssr-bundle.js (pool)\n"
+    "  --config PATH            ./demo/config.json (plugin)\n"
+    "  --url URL                http://127.0.0.1:8070 (http)\n"
+    "  --path PATH              request path (/)\n"
+    "  --render-timeout-ms N    pool mode render timeout (5000)\n"
+    "  --acquire-timeout-ms N   pool mode acquire timeout, 0 = wait (0)\n"
+    "  --server-pid PID         report this process's RSS (http)\n"
+    "  --out PATH               write the JSON report here as well as stdout\n"
+    "  --baseline PATH          compare against a stored report\n"
+    "  --write-baseline PATH    store this report as the new baseline\n"
+    "  --tolerance-pct P        allowed throughput/p99 drift (10)\n"
+    "\n"
+    "Exit status: 0 ok, 1 error, 2 regression against --baseline.\n";
+
+struct BenchOptions {
+    std::string mode = "pool";
+    std::size_t concurrency = 8;
+    std::size_t poolSize = 4;
+    double durationSec = 10.0;
+    double warmupSec = 1.0;
+    std::size_t propsKb = 0;
+    std::uint64_t burnMs = 0;
+    std::string bridgePath;
+    std::string bundlePath = "./public/assets/ssr-bundle.js";
+    std::string configPath = "./demo/config.json";
+    std::string url = "http://127.0.0.1:8070";
+    std::string path = "/";
+    std::uint64_t renderTimeoutMs = 5000;
+    std::uint64_t acquireTimeoutMs = 0;
+    long serverPid = 0;
+    std::string outPath;
+    std::string baselinePath;
+    std::string writeBaselinePath;
+    double tolerancePct = 10.0;
+};
+
+struct Sample {
+    bool ok = false;
+    // Set when the mode can see the isolate acquire directly.
+    std::optional<std::uint64_t> acquireUs;
+};
+
+// One render or request, issued by worker `worker`.
+using RenderOnce = std::function<Sample(std::size_t worker)>;
+
+struct RunStats {
+    double elapsedSec = 0.0;
+    std::uint64_t ok = 0;
+    std::uint64_t failed = 0;
+    std::uint64_t maxUs = 0;
+    hydra::LatencyHistogram latency;
+    hydra::LatencyHistogram acquire;
+    bool acquireMeasured = false;
+};
+
+std::uint64_t parseUInt(const std::string &flag, const std::string &value) {
+    char *end = nullptr;
+    const auto parsed = std::strtoull(value.c_str(), &end, 10);
+    if (value.empty() || end == nullptr || *end != '\0') {
+        throw std::runtime_error(flag + " expects a non-negative integer");
+    }
+    return parsed;
+}
+
+double parseDouble(const std::string &flag, const std::string &value) {
+    char *end = nullptr;
+    const auto parsed = std::strtod(value.c_str(), &end);
+    if (value.empty() || end == nullptr || *end != '\0' || parsed < 0.0) {
+        throw std::runtime_error(flag + " expects a non-negative number");
+    }
+    return parsed;
+}
+
+BenchOptions parseOptions(int argc, char **argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") {
+            std::cout << kUsage;
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::runtime_error("missing value for " + flag);
+        }
+        const std::string value = argv[++i];
+        if (flag == "--mode") {
+            options.mode = value;
+        } else if (flag == "--concurrency") {
+            options.concurrency = parseUInt(flag, value);
+        } else if (flag == "--pool-size") {
+            options.poolSize = parseUInt(flag, value);
+        } else if (flag == "--duration-s") {
+            options.durationSec = parseDouble(flag, value);
+        } else if (flag == "--warmup-s") {
+            options.warmupSec = parseDouble(flag, value);
+        } else if (flag == "--props-kb") {
+            options.propsKb = parseUInt(flag, value);
+        } else if (flag == "--burn-ms") {
+            options.burnMs = parseUInt(flag, value);
+        } else if (flag == "--bridge-path") {
+            options.bridgePath = value;
+        } else if (flag == "--bundle") {
+            options.bundlePath = value;
+        } else if (flag == "--config") {
+            options.configPath = value;
+        } else if (flag == "--url") {
+            options.url = value;
+        } else if (flag == "--path") {
+            options.path = value;
+        } else if (flag == "--render-timeout-ms") {
+            options.renderTimeoutMs = parseUInt(flag, value);
+        } else if (flag == "--acquire-timeout-ms") {
+            options.acquireTimeoutMs = parseUInt(flag, value);
+        } else if (flag == "--server-pid") {
+            options.serverPid = static_cast<long>(parseUInt(flag, value));
+        } else if (flag == "--out") {
+            options.outPath = value;
+        } else if (flag == "--baseline") {
+            options.baselinePath = value;
+        } else if (flag == "--write-baseline") {
+            options.writeBaselinePath = value;
+        } else if (flag == "--tolerance-pct") {
+            options.tolerancePct = parseDouble(flag, value);
+        } else {
+            throw std::runtime_error("unknown option " + flag);
+        }
+    }
+    if (options.mode != "pool" && options.mode != "plugin" && options.mode != "http") {
+        throw std::runtime_error("--mode must be pool, plugin or http");
+    }
+    if (options.concurrency == 0 || options.poolSize == 0) {
+        throw std::runtime_error("--concurrency and --pool-size must be > 0");
+    }
+    if (options.durationSec <= 0.0) {
+        throw std::runtime_error("--duration-s must be > 0");
+    }
+    return options;
+}
+
+// What Home::index builds for "/", plus the bench knobs and padding.
+Json::Value makeProps(const BenchOptions &options) {
+    Json::Value props(Json::objectValue);
+    props["page"] = "home";
+    props["path"] = options.path;
+    props["pathWithQuery"] = options.path;
+    if (options.burnMs > 0 || !options.bridgePath.empty()) {
+        Json::Value testConfig(Json::objectValue);
+        if (options.burnMs > 0) {
+            testConfig["burnMs"] = static_cast<Json::UInt64>(options.burnMs);
+        }
+        if (!options.bridgePath.empty()) {
+            testConfig["bridgePath"] = options.bridgePath;
+        }
+        props["__hydra_test"] = std::move(testConfig);
+    }
+    // Small records rather than one long string, so the bundle's JSON.parse
+    // does representative work.
+    Json::Value items(Json::arrayValue);
+    const std::size_t itemBytes = 96;
+    for (std::size_t i = 0; i < options.propsKb * 1024 / itemBytes; ++i) {
+        Json::Value item(Json::objectValue);
+        item["id"] = static_cast<Json::UInt64>(i);
+        item["title"] = "Bench item " + std::to_string(i);
+        item["body"] = "Lorem ipsum dolor sit amet, consectetur adipiscing.";
+        items.append(std::move(item));
+    }
+    if (!items.empty()) {
+        props["__bench_items"] = std::move(items);
+    }
+    return props;
+}
+
+std::string toCompactJson(const Json::Value &value) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, value);
+}
+
+Json::Value readJsonFile(const std::string &path) {
+    std::ifstream input(path);
+    if (!input) {
+        throw std::runtime_error("unable to read " + path);
+    }
+    Json::CharReaderBuilder builder;
+    Json::Value value;
+    std::string errors;
+    if (!Json::parseFromStream(builder, input, &value, &errors)) {
+        throw std::runtime_error("invalid JSON in " + path + ": " + errors);
+    }
+    return value;
+}
+
+void writeJsonFile(const std::string &path, const Json::Value &value) {
+    std::ofstream output(path, std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("unable to write " + path);
+    }
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "  ";
+    output << Json::writeString(builder, value) << '\n';
+}
+
+// VmRSS / VmHWM in MiB for `pid` (0 = this process). Linux only.
+std::optional<std::pair<double, double>> readRssMb(long pid) {
+#ifdef __linux__
+    std::ifstream status(pid > 0 ? "/proc/" + std::to_string(pid) + "/status"
+                                 : std::string("/proc/self/status"));
+    std::optional<double> current;
+    std::optional<double> peak;
+    std::string line;
+    while (std::getline(status, line)) {
+        const auto readKb = [&line](const char *key) -> std::optional<double> {
+            if (line.rfind(key, 0) != 0) {
+                return std::nullopt;
+            }
+            return std::strtod(line.c_str() + std::char_traits<char>::length(key), nullptr) /
+                   1024.0;
+        };
+        if (auto value = readKb("VmRSS:")) {
+            current = value;
+        } else if (auto value = readKb("VmHWM:")) {
+            peak = value;
+        }
+    }
+    if (current && peak) {
+        return std::make_pair(*current, *peak);
+    }
+#else
+    (void)pid;
+#endif
+    return std::nullopt;
+}
+
+// Closed loop: every worker issues its next render as soon as the last one
+// returns, for `seconds`. Nothing is recorded when `stats` is null.
+void runFor(const BenchOptions &options, double seconds, const RenderOnce &renderOnce,
+            RunStats *stats) {
+    using Clock = std::chrono::steady_clock;
+    const auto startedAt = Clock::now();
+    const auto deadline = startedAt + std::chrono::duration_cast<Clock::duration>(
+                                          std::chrono::duration<double>(seconds));
+    std::atomic<std::uint64_t> ok{0};
+    std::atomic<std::uint64_t> failed{0};
+    std::atomic<bool> acquireMeasured{false};
+    std::vector<std::uint64_t> maxUs(options.concurrency, 0);
+
+    std::vector<std::thread> workers;
+    workers.reserve(options.concurrency);
+    for (std::size_t worker = 0; worker < options.concurrency; ++worker) {
+        workers.emplace_back([&, worker] {
+            while (Clock::now() < deadline) {
+                const auto requestStartedAt = Clock::now();
+                Sample sample;
+                try {
+                    sample = renderOnce(worker);
+                } catch (const std::exception &) {
+                    sample.ok = false;
+                }
+                const auto us = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                                          requestStartedAt)
+                        .count());
+                if (stats == nullptr) {
+                    continue;
+                }
+                (sample.ok ? ok : failed).fetch_add(1, std::memory_order_relaxed);
+                stats->latency.record(us);
+                maxUs[worker] = std::max(maxUs[worker], us);
+                if (sample.acquireUs.has_value()) {
+                    stats->acquire.record(*sample.acquireUs);
+                    acquireMeasured.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    if (stats != nullptr) {
+        stats->elapsedSec =
+            std::chrono::duration<double>(Clock::now() - startedAt).count();
+        stats->ok = ok.load();
+        stats->failed = failed.load();
+        stats->maxUs = *std::max_element(maxUs.begin(), maxUs.end());
+        stats->acquireMeasured = acquireMeasured.load();
+    }
+}
+
+Json::Value quantilesMs(const hydra::LatencyHistogram::Snapshot &snapshot) {
+    Json::Value out(Json::objectValue);
+    out["mean"] = snapshot.count == 0 ? 0.0
+                                      : static_cast<double>(snapshot.sumUs) / 1000.0 /
+                                            static_cast<double>(snapshot.count);
+    out["p50"] = snapshot.quantileUs(0.50) / 1000.0;
+    out["p90"] = snapshot.quantileUs(0.90) / 1000.0;
+    out["p99"] = snapshot.quantileUs(0.99) / 1000.0;
+    return out;
+}
+
+Json::Value makeReport(const BenchOptions &options, const RunStats &stats,
+                       std::size_t propsBytes) {
+    Json::Value report(Json::objectValue);
+    report["mode"] = options.mode;
+
+    Json::Value params(Json::objectValue);
+    params["concurrency"] = static_cast<Json::UInt64>(options.concurrency);
+    params["pool_size"] = options.mode == "http"
+                              ? Json::Value()
+                              : Json::Value(static_cast<Json::UInt64>(options.poolSize));
+    params["props_kb"] = static_cast<Json::UInt64>(options.propsKb);
+    params["burn_ms"] = static_cast<Json::UInt64>(options.burnMs);
+    params["bridge_path"] = options.bridgePath;
+    params["path"] = options.path;
+    params["duration_s"] = options.durationSec;
+    params["warmup_s"] = options.warmupSec;
+    report["params"] = std::move(params);
+
+    const auto requests = stats.ok + stats.failed;
+    report["requests"] = static_cast<Json::UInt64>(requests);
+    report["failures"] = static_cast<Json::UInt64>(stats.failed);
+    if (propsBytes > 0) {
+        report["props_bytes"] = static_cast<Json::UInt64>(propsBytes);
+    }
+    report["elapsed_s"] = stats.elapsedSec;
+    report["throughput_rps"] =
+        stats.elapsedSec > 0.0 ? static_cast<double>(requests) / stats.elapsedSec : 0.0;
+
+    auto latency = quantilesMs(stats.latency.snapshot());
+    latency["max"] = static_cast<double>(stats.maxUs) / 1000.0;
+    report["latency_ms"] = std::move(latency);
+    report["acquire_wait_ms"] =
+        stats.acquireMeasured ? quantilesMs(stats.acquire.snapshot()) : Json::Value();
+    return report;
+}
+
+void attachRss(Json::Value *report, long pid) {
+    if (const auto rss = readRssMb(pid)) {
+        Json::Value out(Json::objectValue);
+        out["current"] = rss->first;
+        out["peak"] = rss->second;
+        out["process"] = pid > 0 ? "server" : "bench";
+        (*report)["rss_mb"] = std::move(out);
+    } else {
+        (*report)["rss_mb"] = Json::Value();
+    }
+}
+
+Json::Value runPoolMode(const BenchOptions &options) {
+    const auto propsJson = toCompactJson(makeProps(options));
+    Json::Value requestContext(Json::objectValue);
+    requestContext["routeUrl"] = options.path;
+    requestContext["routePath"] = options.path;
+    requestContext["url"] = options.path;
+    requestContext["pathWithQuery"] = options.path;
+    requestContext["requestId"] = "hydra-bench";
+    requestContext["locale"] = "en";
+    const auto requestContextJson = toCompactJson(requestContext);
+
+    const hydra::V8IsolatePool::FetchBridge bridge =
+        [](const hydra::V8SsrRuntime::BridgeRequest &) {
+            hydra::V8SsrRuntime::BridgeResponse response;
+            response.status = 200;
+            response.body = "{\"ok\":true}";
+            return response;
+        };
+
+    hydra::V8Platform::initialize();
+    RunStats stats;
+    {
+        hydra::V8IsolatePoolOptions poolOptions;
+        poolOptions.minSize = options.poolSize;
+        hydra::V8IsolatePool pool(poolOptions, options.bundlePath, options.renderTimeoutMs, bridge);
+        const RenderOnce renderOnce = [&](std::size_t) {
+            const auto acquireStartedAt = std::chrono::steady_clock::now();
+            auto lease = pool.acquire(options.acquireTimeoutMs);
+            Sample sample;
+            sample.acquireUs = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - acquireStartedAt)
+                    .count());
+            try {
+                sample.ok = !lease->render(options.path, propsJson, requestContextJson,
+                                           pool.renderTimeoutMs())
+                                 .empty();
+            } catch (const std::exception &) {
+                lease.markForRecycle();
+                throw;
+            }
+            return sample;
+        };
+        runFor(options, options.warmupSec, renderOnce, nullptr);
+        runFor(options, options.durationSec, renderOnce, &stats);
+    }
+    hydra::V8Platform::shutdown();
+
+    auto report = makeReport(options, stats, propsJson.size());
+    attachRss(&report, 0);
+    return report;
+}
+
+// The HydraSsrPlugin block of a Drogon config, with logging and dev mode off
+// and the pool pinned to --pool-size, the same way the load regression
+// script prepares it.
+Json::Value loadPluginConfig(const BenchOptions &options) {
+    const auto appConfig = readJsonFile(options.configPath);
+    for (const auto &plugin : appConfig["plugins"]) {
+        if (plugin.get("name", "").asString() != "hydra::HydraSsrPlugin") {
+            continue;
+        }
+        auto config = plugin["config"];
+        config["asset_mode"] = "prod";
+        config["log_render_metrics"] = false;
+        config["log_request_routes"] = false;
+        if (config["dev_mode"].isObject()) {
+            config["dev_mode"]["enabled"] = false;
+        }
+        config.removeMember("pool");
+        config.removeMember("isolate_pool_size");
+        config["pool_size"] = static_cast<Json::UInt64>(options.poolSize);
+        return config;
+    }
+    throw std::runtime_error(options.configPath + " has no hydra::HydraSsrPlugin block");
+}
+
+Json::Value runPluginMode(const BenchOptions &options) {
+    const auto props = makeProps(options);
+    hydra::HydraSsrPlugin plugin;
+    plugin.initAndStart(loadPluginConfig(options));
+    plugin.setApiBridgeHandler([](const hydra::ApiBridgeRequest &) {
+        hydra::ApiBridgeResponse response;
+        response.status = 200;
+        response.body = "{\"ok\":true}";
+        return response;
+    });
+
+    // One request object per worker, as each would come off its own loop.
+    std::vector<drogon::HttpRequestPtr> requests;
+    for (std::size_t i = 0; i < options.concurrency; ++i) {
+        requests.push_back(drogon::HttpRequest::newHttpRequest());
+        requests.back()->setPath(options.path);
+    }
+    const RenderOnce renderOnce = [&](std::size_t worker) {
+        Sample sample;
+        sample.ok = plugin.renderResult(requests[worker], props).status < 500;
+        return sample;
+    };
+
+    RunStats stats;
+    runFor(options, options.warmupSec, renderOnce, nullptr);
+    const auto before = plugin.metricsSnapshot();
+    runFor(options, options.durationSec, renderOnce, &stats);
+    const auto after = plugin.metricsSnapshot();
+
+    auto report = makeReport(options, stats, toCompactJson(props).size());
+    // The plugin keeps acquire wait in its own histogram since start; the
+    // delta of the running totals is exact for the measured window.
+    const auto renders = (after.requestsOk + after.requestsFail) -
+                         (before.requestsOk + before.requestsFail);
+    Json::Value acquire(Json::objectValue);
+    acquire["mean"] = renders == 0 ? 0.0
+                                   : static_cast<double>(after.totalAcquireWaitUs -
+                                                         before.totalAcquireWaitUs) /
+                                         1000.0 / static_cast<double>(renders);
+    const auto quantiles = plugin.observatoryReport()["latency"]["quantiles"]["acquire_wait_ms"];
+    for (const auto &key : quantiles.getMemberNames()) {
+        acquire[key + "_since_start"] = quantiles[key];
+    }
+    report["acquire_wait_ms"] = std::move(acquire);
+    attachRss(&report, 0);
+    plugin.shutdown();
+    return report;
+}
+
+// hydra_acquire_wait_ms_{sum,count} from the demo's Prometheus endpoint.
+std::optional<std::pair<double, double>> scrapeAcquireWait(const drogon::HttpClientPtr &client) {
+    auto req = drogon::HttpRequest::newHttpRequest();
+    req->setPath("/__hydra/metrics");
+    const auto [result, response] = client->sendRequest(req, 5.0);
+    if (result != drogon::ReqResult::Ok || !response) {
+        return std::nullopt;
+    }
+    std::istringstream lines{std::string(response->getBody())};
+    std::optional<double> sum;
+    std::optional<double> count;
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.rfind("hydra_acquire_wait_ms_sum ", 0) == 0) {
+            sum = std::strtod(line.c_str() + 26, nullptr);
+        } else if (line.rfind("hydra_acquire_wait_ms_count ", 0) == 0) {
+            count = std::strtod(line.c_str() + 28, nullptr);
+        }
+    }
+    if (sum && count) {
+        return std::make_pair(*sum, *count);
+    }
+    return std::nullopt;
+}
+
+Json::Value runHttpMode(const BenchOptions &options) {
+    // One loop and keep-alive connection per worker, like independent clients.
+    std::vector<std::unique_ptr<trantor::EventLoopThread>> loops;
+    std::vector<drogon::HttpClientPtr> clients;
+    for (std::size_t i = 0; i < options.concurrency + 1; ++i) {
+        loops.push_back(std::make_unique<trantor::EventLoopThread>("hydra-bench"));
+        loops.back()->run();
+        clients.push_back(drogon::HttpClient::newHttpClient(options.url, loops.back()->getLoop()));
+    }
+    const auto &metricsClient = clients.back();
+
+    const RenderOnce renderOnce = [&](std::size_t worker) {
+        auto req = drogon::HttpRequest::newHttpRequest();
+        req->setPath(options.path);
+        if (options.burnMs > 0) {
+            req->setParameter("burn_ms", std::to_string(options.burnMs));
+        }
+        if (!options.bridgePath.empty()) {
+            req->setParameter("bridge_path", options.bridgePath);
+        }
+        const auto [result, response] = clients[worker]->sendRequest(req, 30.0);
+        Sample sample;
+        sample.ok = result == drogon::ReqResult::Ok && response &&
+                    static_cast<int>(response->getStatusCode()) < 500;
+        return sample;
+    };
+
+    RunStats stats;
+    runFor(options, options.warmupSec, renderOnce, nullptr);
+    const auto before = scrapeAcquireWait(metricsClient);
+    runFor(options, options.durationSec, renderOnce, &stats);
+    const auto after = scrapeAcquireWait(metricsClient);
+
+    auto report = makeReport(options, stats, 0);
+    if (before && after && after->second > before->second) {
+        Json::Value acquire(Json::objectValue);
+        acquire["mean"] = (after->first - before->first) / (after->second - before->second);
+        report["acquire_wait_ms"] = std::move(acquire);
+    }
+    if (options.serverPid > 0) {
+        attachRss(&report, options.serverPid);
+    } else {
+        report["rss_mb"] = Json::Value();
+    }
+    clients.clear();
+    loops.clear();
+    return report;
+}
+
+double percentDelta(double current, double baseline) {
+    return baseline == 0.0 ? 0.0 : (current - baseline) / baseline * 100.0;
+}
+
+// Throughput may not drop, and p99 may not rise, by more than the
+// tolerance. A run that fails requests the baseline served is a regression
+// regardless of speed.
+Json::Value compareWithBaseline(const Json::Value &report, const Json::Value &baseline,
+                                double tolerancePct, bool *regressed) {
+    Json::Value out(Json::objectValue);
+    out["tolerance_pct"] = tolerancePct;
+    out["params_match"] = report["mode"] == baseline["mode"] &&
+                          report["params"] == baseline["params"];
+
+    const auto throughputDelta = percentDelta(report["throughput_rps"].asDouble(),
+                                              baseline["throughput_rps"].asDouble());
+    const auto p99Delta = percentDelta(report["latency_ms"]["p99"].asDouble(),
+                                       baseline["latency_ms"]["p99"].asDouble());
+    out["throughput_rps"] = baseline["throughput_rps"];
+    out["throughput_delta_pct"] = throughputDelta;
+    out["p99_ms"] = baseline["latency_ms"]["p99"];
+    out["p99_delta_pct"] = p99Delta;
+
+    Json::Value reasons(Json::arrayValue);
+    if (throughputDelta < -tolerancePct) {
+        reasons.append("throughput");
+    }
+    if (p99Delta > tolerancePct) {
+        reasons.append("p99");
+    }
+    if (report["failures"].asUInt64() > 0 && baseline["failures"].asUInt64() == 0) {
+        reasons.append("failures");
+    }
+    *regressed = !reasons.empty();
+    out["regressed"] = *regressed;
+    out["reasons"] = std::move(reasons);
+    return out;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    try {
+        const auto options = parseOptions(argc, argv);
+        Json::Value report;
+        if (options.mode == "pool") {
+            report = runPoolMode(options);
+        } else if (options.mode == "plugin") {
+            report = runPluginMode(options);
+        } else {
+            report = runHttpMode(options);
+        }
+
+        bool regressed = false;
+        if (!options.baselinePath.empty()) {
+            report["baseline"] = compareWithBaseline(
+                report, readJsonFile(options.baselinePath), options.tolerancePct, &regressed);
+            if (!report["baseline"]["params_match"].asBool()) {
+                std::cerr << "[hydra-bench] baseline was recorded with different params\n";
+            }
+        }
+        if (!options.writeBaselinePath.empty()) {
+            auto stored = report;
+            stored.removeMember("baseline");
+            writeJsonFile(options.writeBaselinePath, stored);
+        }
+        if (!options.outPath.empty()) {
+            writeJsonFile(options.outPath, report);
+        }
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "  ";
+        std::cout << Json::writeString(builder, report) << '\n';
+        if (regressed) {
+            std::cerr << "[hydra-bench] REGRESSION against " << options.baselinePath << '\n';
+            return 2;
+        }
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[hydra-bench] " << ex.what() << "\n\n" << kUsage;
+        return 1;
+    }
+}
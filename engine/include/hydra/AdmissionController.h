@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+namespace hydra {
+
+// Most to least important.
+enum class RequestPriority : std::uint8_t {
+    // Health checks and probes; never shed.
+    kCritical,
+    // Signed-in users.
+    kHigh,
+    kNormal,
+    // Crawlers and other bots.
+    kLow,
+};
+
+inline constexpr std::size_t kRequestPriorityCount = 4;
+
+[[nodiscard]] const char *requestPriorityName(RequestPriority priority);
+
+enum class ShedAction : std::uint8_t {
+    // 200 with the shell and an empty root; the client bundle renders.
+    kShell,
+    // 503 with Retry-After.
+    kReject,
+};
+
+// Thrown on the render path when a request is shed, either up front or
+// because the admitted request still missed its acquire deadline.
+class AdmissionRejectedError : public std::runtime_error {
+  public:
+    AdmissionRejectedError(RequestPriority priority, std::uint64_t expectedWaitUs, bool timedOut);
+
+    [[nodiscard]] RequestPriority priority() const;
+    [[nodiscard]] std::uint64_t expectedWaitUs() const;
+    [[nodiscard]] bool timedOut() const;
+
+  private:
+    RequestPriority priority_;
+    std::uint64_t expectedWaitUs_ = 0;
+    bool timedOut_ = false;
+};
+
+// Decides, before a request queues for a runtime, whether it can be served
+// in time. The expected wait is derived from the number of renders already
+// admitted, the runtimes available to serve them and a moving average of
+// recent render latency. Every counter is an atomic; nothing here locks.
+class AdmissionController {
+  public:
+    struct PriorityPolicy {
+        // Longest expected wait admitted, and the acquire deadline once
+        // admitted; 0 = never shed.
+        std::uint64_t maxWaitUs = 0;
+        ShedAction action = ShedAction::kShell;
+    };
+
+    struct Options {
+        // Indexed by RequestPriority. The critical policy is ignored.
+        std::array<PriorityPolicy, kRequestPriorityCount> policies{};
+        // Render latency assumed until renders have been observed.
+        std::uint64_t initialRenderUs = 50000;
+    };
+
+    // Holds an in-flight slot from admit() until the render finishes. An
+    // empty ticket means the request was shed.
+    class Ticket {
+      public:
+        Ticket() = default;
+        ~Ticket();
+
+        Ticket(const Ticket &) = delete;
+        Ticket &operator=(const Ticket &) = delete;
+
+        Ticket(Ticket &&other) noexcept;
+        Ticket &operator=(Ticket &&other) noexcept;
+
+        [[nodiscard]] explicit operator bool() const;
+        [[nodiscard]] std::uint64_t expectedWaitUs() const;
+        void release();
+
+      private:
+        friend class AdmissionController;
+
+        Ticket(AdmissionController *controller, std::uint64_t expectedWaitUs);
+
+        AdmissionController *controller_ = nullptr;
+        std::uint64_t expectedWaitUs_ = 0;
+    };
+
+    struct PriorityStats {
+        std::uint64_t admitted = 0;
+        std::uint64_t shed = 0;
+        // Admitted, then shed at the acquire deadline.
+        std::uint64_t timedOut = 0;
+    };
+
+    struct Stats {
+        std::size_t inFlight = 0;
+        std::uint64_t renderEstimateUs = 0;
+        std::array<PriorityStats, kRequestPriorityCount> priorities{};
+    };
+
+    explicit AdmissionController(Options options);
+
+    AdmissionController(const AdmissionController &) = delete;
+    AdmissionController &operator=(const AdmissionController &) = delete;
+
+    // `capacity` is the number of runtimes that can render at once. On shed
+    // the returned ticket is empty but still carries the expected wait.
+    // `pending` is work already queued for or running on a render thread;
+    // not all of it holds a ticket yet, so the request is quoted behind the
+    // larger of that and the tickets in flight.
+    [[nodiscard]] Ticket admit(RequestPriority priority,
+                               std::size_t capacity,
+                               std::size_t pending = 0);
+    // Acquire timeout for an admitted request: the tighter of the priority's
+    // max wait and `configuredTimeoutMs` (where 0 = unbounded).
+    [[nodiscard]] std::uint64_t acquireTimeoutMs(RequestPriority priority,
+                                                 std::uint64_t configuredTimeoutMs) const;
+    void recordTimeout(RequestPriority priority);
+    void observeRender(std::uint64_t renderUs);
+
+    // Wait the next request would be quoted with `capacity` runtimes.
+    [[nodiscard]] std::uint64_t expectedWaitUs(std::size_t capacity) const;
+    [[nodiscard]] const PriorityPolicy &policy(RequestPriority priority) const;
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    struct Counters {
+        std::atomic<std::uint64_t> admitted{0};
+        std::atomic<std::uint64_t> shed{0};
+        std::atomic<std::uint64_t> timedOut{0};
+    };
+
+    [[nodiscard]] std::uint64_t waitForPosition(std::size_t ahead, std::size_t capacity) const;
+
+    Options options_;
+    std::atomic<std::size_t> inFlight_{0};
+    std::atomic<std::uint64_t> renderEstimateUs_{0};
+    std::array<Counters, kRequestPriorityCount> counters_{};
+};
+
+}  // namespace hydra
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hydra {
+
+// One file a page should start fetching before its client entry runs.
+struct AssetPreload {
+    enum class Kind : std::uint8_t { kScript, kStyle };
+    Kind kind = Kind::kScript;
+    // Public URL path.
+    std::string href;
+};
+
+// The chunk graph of a Vite build manifest (manifest.json), indexed once per
+// generation so per-request preload lists are lookups rather than JSON walks.
+class AssetManifest {
+  public:
+    struct Chunk {
+        std::string file;
+        std::string name;
+        bool isEntry = false;
+        bool isDynamicEntry = false;
+        std::vector<std::string> imports;
+        std::vector<std::string> dynamicImports;
+        std::vector<std::string> css;
+    };
+
+    // Throws std::runtime_error when `json` is not a manifest object. Chunk
+    // files are served under `publicPrefix`.
+    [[nodiscard]] static AssetManifest parse(std::string_view json, std::string publicPrefix);
+    [[nodiscard]] static AssetManifest load(const std::filesystem::path &path,
+                                            std::string publicPrefix);
+
+    [[nodiscard]] const Chunk *chunk(const std::string &key) const;
+    [[nodiscard]] std::size_t size() const { return chunks_.size(); }
+
+    // Key of the client entry: `preferredKey` when the manifest has it, else
+    // the entry that looks like the client one, else the first JS entry.
+    // Empty when the manifest has no entry.
+    [[nodiscard]] std::string clientEntryKey(const std::string &preferredKey) const;
+
+    // Stylesheet the shell links for `entryKey`: its own css, then that of
+    // its imports, then style.css, then any css file. Empty when none.
+    [[nodiscard]] std::string stylesheetFor(const std::string &entryKey) const;
+
+    // `keys` and their static imports, followed by the css all of them pull
+    // in, each file once. Unknown keys are skipped.
+    [[nodiscard]] std::vector<AssetPreload> preloadsFor(const std::vector<std::string> &keys) const;
+
+    // Chunks loaded with import() anywhere below `entryKey`, by the
+    // pageKey() of their chunk name; Vite names a lazy page chunk after its
+    // module, so `pages/PostDetail.tsx` is found for pageId "post-detail".
+    [[nodiscard]] std::map<std::string, std::string> lazyChunksByPage(
+        const std::string &entryKey) const;
+
+    // Lowercase ASCII letters and digits of `name`.
+    [[nodiscard]] static std::string pageKey(std::string_view name);
+
+    // `file` as served under the public prefix.
+    [[nodiscard]] std::string publicPath(std::string file) const;
+    // The chunk or css file served at `publicPath`, relative to the
+    // manifest's directory; empty when the manifest has none.
+    [[nodiscard]] std::string fileFor(const std::string &publicPath) const;
+
+  private:
+    std::map<std::string, Chunk> chunks_;
+    std::string publicPrefix_;
+};
+
+// Link header value preloading `preloads`; scripts are modulepreload when
+// the client entry is an ES module and classic script preloads otherwise.
+[[nodiscard]] std::string formatLinkHeader(const std::vector<AssetPreload> &preloads,
+                                           bool moduleScripts);
+
+}  // namespace hydra
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "hydra/RenderExecutor.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+struct BridgeRequest {
+    std::string method = "GET";
+    std::string path;
+    std::string query;
+    std::string body;
+    std::unordered_map<std::string, std::string> headers;
+};
+
+struct BridgeResponse {
+    int status = 200;
+    std::string body;
+    std::unordered_map<std::string, std::string> headers;
+};
+
+// API bridge activity of one render.
+struct BridgeRenderStats {
+    // hydra.fetch() and hydra.fetchAsync()/fetch() calls, memoized ones
+    // included.
+    std::uint32_t syncCalls = 0;
+    std::uint32_t asyncCalls = 0;
+    // Calls answered from the render's memo without reaching the handler.
+    std::uint32_t memoized = 0;
+    // Batch handler invocations.
+    std::uint32_t batches = 0;
+    // Time the render spent blocked on outstanding async calls.
+    std::uint64_t waitUs = 0;
+};
+
+// Runs async bridge calls on a dedicated worker pool so independent loads
+// issued by one render overlap instead of queueing behind each other on the
+// render thread. Calls handed over together can go to the batch handler in
+// groups of up to maxBatch; otherwise each call is its own task. The trace
+// active on the dispatching thread is reinstated around every handler call.
+class BridgeDispatcher {
+  public:
+    using Handler = std::function<BridgeResponse(const BridgeRequest &)>;
+    // One response per request, in request order.
+    using BatchHandler =
+        std::function<std::vector<BridgeResponse>(const std::vector<BridgeRequest> &)>;
+    // Called once per request, from a worker thread, with the request's
+    // index in the dispatched vector.
+    using Completion = std::function<void(std::size_t index, BridgeResponse response)>;
+
+    struct Options {
+        std::size_t threads = 4;
+        // 0 or 1 disables batching.
+        std::size_t maxBatch = 0;
+    };
+
+    struct Stats {
+        std::size_t threads = 0;
+        std::size_t maxBatch = 0;
+        std::size_t queueDepth = 0;
+        std::size_t active = 0;
+        std::uint64_t calls = 0;
+        std::uint64_t batches = 0;
+    };
+
+    BridgeDispatcher(Options options, Handler handler, BatchHandler batchHandler = {});
+    ~BridgeDispatcher();
+
+    BridgeDispatcher(const BridgeDispatcher &) = delete;
+    BridgeDispatcher &operator=(const BridgeDispatcher &) = delete;
+
+    // Queues `requests`; returns the number of batch handler invocations
+    // used. Handler exceptions become 500 responses, and after shutdown()
+    // every call completes at once with a 503.
+    std::size_t dispatch(std::vector<BridgeRequest> requests, Completion onResponse);
+
+    // Drains queued calls and joins the workers.
+    void shutdown();
+
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    Options options_;
+    Handler handler_;
+    BatchHandler batchHandler_;
+    std::atomic<std::uint64_t> calls_{0};
+    std::atomic<std::uint64_t> batches_{0};
+    RenderExecutor executor_;
+};
+
+}  // namespace hydra
@@ -4,6 +4,7 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace hydra {
@@ -14,6 +15,35 @@ enum class HydraAssetMode {
     kProd,
 };
 
+// Per-pageId render cache policy; a ttlMs of 0 leaves the page uncached.
+struct HydraRenderCachePageConfig {
+    std::uint64_t ttlMs = 0;
+    std::uint64_t staleWhileRevalidateMs = 0;
+};
+
+// Admission policy for one request priority; a maxWaitMs of 0 never sheds.
+struct HydraAdmissionPriorityConfig {
+    std::uint64_t maxWaitMs = 0;
+    // false = degrade to the shell-only render, true = 503 with Retry-After.
+    bool reject = false;
+};
+
+// One prerendered route. Empty locale/theme lists mean every supported
+// value; a revalidateSec of 0 renders the page once and keeps it.
+struct HydraPrerenderRouteConfig {
+    std::string path;
+    std::uint64_t revalidateSec = 0;
+    std::vector<std::string> locales;
+    std::vector<std::string> themes;
+};
+
+// One warm-up render: a route URL and the controller props for it, as
+// compact JSON.
+struct HydraWarmupRouteConfig {
+    std::string url;
+    std::string propsJson = "{}";
+};
+
 struct HydraSsrPluginConfig {
     std::string shellTitle = "HydraStack";
     std::string shellDescription;
@@ -31,10 +61,142 @@ struct HydraSsrPluginConfig {
     std::string clientManifestEntry = "src/entry-client.tsx";
     std::uint64_t acquireTimeoutMs = 0;
     std::uint64_t renderTimeoutMs = 250;
+    std::uint64_t renderThreads = 0;
+    // Renders allowed to wait for a render thread; beyond it requests get a
+    // 503 right away. 0 = unbounded.
+    std::uint64_t renderQueueMax = 1024;
+    // 0 = one runtime per Drogon IO thread.
+    std::uint64_t poolSize = 0;
+    // Elastic pool bounds; 0 falls back to poolSize. poolMax > poolMin lets
+    // the pool grow under load and reap idle runtimes.
+    std::uint64_t poolMin = 0;
+    std::uint64_t poolMax = 0;
+    std::uint64_t poolGrowQueueDepth = 1;
+    std::uint64_t poolGrowWaitMs = 5;
+    std::uint64_t poolIdleTtlMs = 60000;
+    // Pre-built runtimes kept aside so a failed runtime is replaced without
+    // compiling the bundle on the request thread.
+    std::uint64_t poolStandby = 1;
+    // Pin each acquiring thread to the runtime it leased first.
+    bool poolThreadAffinity = true;
+    // Renders warmupRoutes through every new runtime, warmupIterations
+    // times, before it takes traffic. No routes means "/" with empty props.
+    bool warmupEnabled = false;
+    std::uint64_t warmupIterations = 50;
+    std::vector<HydraWarmupRouteConfig> warmupRoutes;
+    bool v8SnapshotEnabled = false;
+    bool v8SnapshotPersist = true;
+    std::string v8SnapshotPath;
+    bool v8CodeCacheEnabled = true;
+    bool v8CodeCachePersist = false;
+    std::string v8CodeCachePath;
+    // Rebuilds the isolate pool from an updated bundle and manifest and
+    // swaps it in without dropping requests. Triggered by
+    // HydraSsrPlugin::reload(), a file watch and/or SIGHUP.
+    bool hotReloadEnabled = false;
+    bool hotReloadWatch = true;
+    std::uint64_t hotReloadWatchIntervalMs = 1000;
+    bool hotReloadSignal = false;
+    // Per-isolate heap cap and recycle policy; 0 disables a limit.
+    std::uint64_t v8HeapMaxMb = 0;
+    std::uint64_t v8HeapRecycleAfterRenders = 0;
+    std::uint64_t v8HeapRecycleGrowthPercent = 0;
+    bool v8HeapIdleGc = true;
+    std::uint64_t v8HeapIdleGcDelayMs = 1000;
+    bool renderCacheEnabled = false;
+    std::uint64_t renderCacheMaxBytes = 64ULL * 1024 * 1024;
+    std::uint64_t renderCacheShards = 16;
+    HydraRenderCachePageConfig renderCacheDefaultPolicy;
+    std::unordered_map<std::string, HydraRenderCachePageConfig> renderCachePages;
+    // Second tier behind the render cache, shared through one of Drogon's
+    // Redis clients by every node using the same key prefix. Lookups give
+    // up after timeout_ms; tag versions are re-read every tag_refresh_ms
+    // (0: only invalidation messages update them).
+    bool renderCacheSharedEnabled = false;
+    std::string renderCacheSharedRedisClient = "default";
+    std::string renderCacheSharedKeyPrefix = "hydra";
+    std::uint64_t renderCacheSharedTimeoutMs = 5;
+    std::uint64_t renderCacheSharedMaxEntryBytes = 1024ULL * 1024;
+    bool renderCacheSharedGzip = true;
+    std::uint64_t renderCacheSharedTagRefreshMs = 5000;
+    // Routes rendered ahead of time into files under Drogon's document_root
+    // and served by its static file handler, then regenerated in the
+    // background once their revalidate interval expires.
+    bool prerenderEnabled = false;
+    std::string prerenderOutputDir = "_prerender";
+    std::uint64_t prerenderRevalidateSec = 300;
+    std::vector<HydraPrerenderRouteConfig> prerenderRoutes;
+    // Compresses SSR responses on the render executor when Accept-Encoding
+    // allows it. Render cache entries also keep gzip blocks of the document
+    // parts their hits share, so hits are spliced rather than recompressed.
+    bool compressionEnabled = false;
+    bool compressionGzip = true;
+    bool compressionBrotli = true;
+    std::uint64_t compressionGzipLevel = 6;
+    std::uint64_t compressionBrotliQuality = 5;
+    std::uint64_t compressionMinBytes = 1024;
+    // Has Drogon's static file handler serve the .gz/.br sidecars the UI
+    // build writes next to hashed assets.
+    bool compressionStaticSidecars = true;
+    // Preloads derived from the asset manifest's chunk graph: a Link header
+    // on SSR documents (flushed before the render for streams) and matching
+    // <link> tags in the shell head. Each page adds the lazy chunk named like
+    // its pageId, or the manifest keys listed for it in earlyHintsPages.
+    bool earlyHintsEnabled = false;
+    bool earlyHintsHtmlTags = true;
+    std::uint64_t earlyHintsMaxLinks = 16;
+    std::unordered_map<std::string, std::vector<std::string>> earlyHintsPages;
+    // Inlines the stylesheet rules a page's HTML can match, picked by class,
+    // and links the full stylesheet after the app markup instead of in the
+    // head. Selections over criticalCssMaxBytes keep the blocking <link>.
+    bool criticalCssEnabled = false;
+    std::uint64_t criticalCssMaxBytes = 16 * 1024;
+    std::uint64_t criticalCssCacheEntries = 1024;
+    // Weak ETags on SSR documents, hashed from the body without its script
+    // nonce and request context. A matching If-None-Match gets a 304, before
+    // any isolate is acquired when the render cache holds the page.
+    bool etagEnabled = false;
     bool wrapFragment = true;
     bool apiBridgeEnabled = true;
     bool logRenderMetrics = true;
     bool logRequestRoutes = false;
+    // Fraction of fast, successful renders that reach the log; failures and
+    // renders slower than renderLogSlowMs are always logged.
+    double renderLogSampleRate = 1.0;
+    std::uint64_t renderLogSlowMs = 0;
+    bool renderLogAlwaysFailures = true;
+    std::uint64_t renderLogRingCapacity = 512;
+    std::uint64_t renderLogFlushIntervalMs = 50;
+    // Sheds renders whose expected pool wait exceeds their priority's budget.
+    bool admissionEnabled = false;
+    std::uint64_t admissionRetryAfterSec = 1;
+    HydraAdmissionPriorityConfig admissionHigh{2000, false};
+    HydraAdmissionPriorityConfig admissionNormal{500, false};
+    HydraAdmissionPriorityConfig admissionLow{100, true};
+    // Path prefixes served at critical priority.
+    std::vector<std::string> admissionHealthPaths = {"/health", "/healthz", "/readyz"};
+    // Any of these cookies marks a signed-in (high priority) request.
+    std::vector<std::string> admissionSessionCookies;
+    // Case-insensitive User-Agent substrings for low priority requests.
+    std::vector<std::string> admissionBotUserAgents = {
+        "bot", "crawler", "spider", "slurp", "facebookexternalhit"};
+    // Prometheus `le` bounds and exported quantiles for the latency
+    // histograms. Routes past metricsMaxRoutes share one series; 0 turns
+    // per-route histograms off.
+    std::vector<double> metricsHistogramBoundsMs = {
+        1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+    std::vector<double> metricsQuantiles = {0.5, 0.9, 0.99};
+    std::uint64_t metricsMaxRoutes = 64;
+    // Phase-level request traces. A request is traced when its traceparent
+    // is sampled or it wins the sample_rate draw; traces go out as a
+    // Server-Timing header and/or OTLP/HTTP JSON to tracingOtlpEndpoint.
+    bool tracingEnabled = false;
+    double tracingSampleRate = 0.01;
+    bool tracingServerTiming = false;
+    std::string tracingOtlpEndpoint;
+    std::string tracingServiceName = "hydrastack";
+    std::uint64_t tracingFlushIntervalMs = 1000;
+    std::uint64_t tracingMaxQueuedTraces = 2048;
 
     HydraAssetMode configuredAssetMode = HydraAssetMode::kAuto;
     std::string configuredAssetModeRaw = "auto";
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+// A stylesheet indexed by the class names its selectors use, so the rules a
+// page can match are picked from the classes in its HTML. Rules whose
+// selectors need no class (element, universal, :root) and at-rules other than
+// @media/@supports/@layer/@container are always kept; those four wrap
+// whatever they contain that matched. Classes inside :is()/:not()/[...] do
+// not narrow a selector, so a selection errs towards including a rule.
+class CriticalCss {
+  public:
+    struct Options {
+        // Selections larger than this are not inlined.
+        std::size_t maxBytes = 16 * 1024;
+        // Entries of each lookup cache (by page and by class set).
+        std::size_t cacheEntries = 1024;
+    };
+
+    enum class Source : std::uint8_t {
+        // Same pageId and HTML as an earlier call; nothing was scanned.
+        kPage,
+        // Scanned; an earlier page used the same classes.
+        kClassSet,
+        // Scanned and selected.
+        kSelected,
+    };
+
+    CriticalCss(std::string_view stylesheet, Options options);
+    CriticalCss(const CriticalCss &) = delete;
+    CriticalCss &operator=(const CriticalCss &) = delete;
+
+    // Throws std::runtime_error when `path` cannot be read.
+    [[nodiscard]] static std::unique_ptr<CriticalCss> load(const std::filesystem::path &path,
+                                                          Options options);
+
+    // The rules `appHtml` can match, in stylesheet order and wrapped in their
+    // conditional at-rules. Null when they exceed maxBytes. A 64-bit hash
+    // collision can only hand a page another page's rules, which the full
+    // stylesheet loaded after it corrects.
+    [[nodiscard]] std::shared_ptr<const std::string> rulesFor(std::string_view pageId,
+                                                              std::string_view appHtml,
+                                                              Source *source = nullptr) const;
+
+    [[nodiscard]] std::size_t ruleCount() const { return rules_.size(); }
+    [[nodiscard]] std::size_t classCount() const { return classNames_.size(); }
+
+    // Calls `visit` with each class token of the class attributes in `html`,
+    // entity-decoded; tokens repeat as often as they occur.
+    static void forEachClass(std::string_view html,
+                             const std::function<void(std::string_view)> &visit);
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view value) const {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    struct Rule {
+        std::string text;
+        // Index into groups_; 0 is the top level.
+        std::uint32_t group = 0;
+        // Class ids each selector of the list needs; the rule matches when
+        // every id of one of them is present. Empty for rules always kept.
+        std::vector<std::vector<std::uint32_t>> selectors;
+    };
+
+    // A conditional at-rule; `prelude` is its text up to the `{`.
+    struct Group {
+        std::string prelude;
+        std::uint32_t parent = 0;
+    };
+
+    using Selection = std::shared_ptr<const std::string>;
+    using SelectionCache = std::unordered_map<std::uint64_t, Selection>;
+
+    void parseBlock(std::string_view css, std::size_t begin, std::size_t end, std::uint32_t group);
+    void addRule(std::string_view selector, std::string_view body, std::uint32_t group);
+    void addAlways(std::string text, std::uint32_t group);
+    [[nodiscard]] std::uint32_t internClass(std::string name);
+    [[nodiscard]] Selection select(const std::vector<std::uint32_t> &classIds) const;
+    void remember(SelectionCache &cache, std::uint64_t key, const Selection &value) const;
+
+    Options options_;
+    std::vector<Rule> rules_;
+    std::vector<Group> groups_;
+    std::vector<std::string> classNames_;
+    std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> classIds_;
+    // Rules by one class of each of their selectors; a rule is a candidate
+    // when that class is present and matches when the rest are too.
+    std::vector<std::vector<std::uint32_t>> rulesByClass_;
+    std::vector<std::uint32_t> alwaysRules_;
+
+    mutable std::mutex cacheMutex_;
+    mutable SelectionCache byPage_;
+    mutable SelectionCache byClassSet_;
+};
+
+}  // namespace hydra
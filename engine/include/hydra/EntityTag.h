@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace hydra {
+
+// W/"<16 hex digits>". Weak because the validated bytes still differ per
+// request (script nonce, request context) and per Content-Encoding; the tag
+// only promises the same page.
+[[nodiscard]] std::string weakEntityTag(std::uint64_t digest);
+
+// Whether an If-None-Match header is `*` or lists `etag` under weak
+// comparison (W/ prefixes ignored on both sides). Malformed members are
+// skipped.
+[[nodiscard]] bool ifNoneMatchMatches(std::string_view ifNoneMatch, std::string_view etag);
+
+}  // namespace hydra
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace hydra {
+
+// XXH64-compatible 64-bit content hash. Used for cache keys (bundle
+// snapshots, code cache, render cache) where speed matters and collisions
+// are only a cache-miss concern, never a security boundary.
+namespace hash_detail {
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline std::uint64_t rotl(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline std::uint64_t read64(const unsigned char *ptr) {
+    std::uint64_t value = 0;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t read32(const unsigned char *ptr) {
+    std::uint32_t value = 0;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+inline std::uint64_t round(std::uint64_t acc, std::uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t value) {
+    acc ^= round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+}  // namespace hash_detail
+
+[[nodiscard]] inline std::uint64_t hash64(std::string_view data, std::uint64_t seed = 0) {
+    using namespace hash_detail;
+
+    const auto *ptr = reinterpret_cast<const unsigned char *>(data.data());
+    const auto *const end = ptr + data.size();
+    std::uint64_t h64 = 0;
+
+    if (data.size() >= 32) {
+        std::uint64_t v1 = seed + kPrime1 + kPrime2;
+        std::uint64_t v2 = seed + kPrime2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - kPrime1;
+        const auto *const limit = end - 32;
+        do {
+            v1 = round(v1, read64(ptr));
+            v2 = round(v2, read64(ptr + 8));
+            v3 = round(v3, read64(ptr + 16));
+            v4 = round(v4, read64(ptr + 24));
+            ptr += 32;
+        } while (ptr <= limit);
+
+        h64 = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h64 = mergeRound(h64, v1);
+        h64 = mergeRound(h64, v2);
+        h64 = mergeRound(h64, v3);
+        h64 = mergeRound(h64, v4);
+    } else {
+        h64 = seed + kPrime5;
+    }
+
+    h64 += static_cast<std::uint64_t>(data.size());
+
+    while (ptr + 8 <= end) {
+        h64 ^= round(0, read64(ptr));
+        h64 = rotl(h64, 27) * kPrime1 + kPrime4;
+        ptr += 8;
+    }
+    if (ptr + 4 <= end) {
+        h64 ^= static_cast<std::uint64_t>(read32(ptr)) * kPrime1;
+        h64 = rotl(h64, 23) * kPrime2 + kPrime3;
+        ptr += 4;
+    }
+    while (ptr < end) {
+        h64 ^= static_cast<std::uint64_t>(*ptr) * kPrime5;
+        h64 = rotl(h64, 11) * kPrime1;
+        ++ptr;
+    }
+
+    h64 ^= h64 >> 33;
+    h64 *= kPrime2;
+    h64 ^= h64 >> 29;
+    h64 *= kPrime3;
+    h64 ^= h64 >> 32;
+    return h64;
+}
+
+// Order-dependent mix of two hashes, for keys built from several parts.
+[[nodiscard]] inline std::uint64_t combineHash(std::uint64_t seed, std::uint64_t value) {
+    return hash_detail::mergeRound(seed ^ hash_detail::kPrime5, value);
+}
+
+[[nodiscard]] inline std::string hashToHex(std::uint64_t value) {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string out(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        out[static_cast<std::size_t>(i)] = kDigits[value & 0xFU];
+        value >>= 4;
+    }
+    return out;
+}
+
+}  // namespace hydra
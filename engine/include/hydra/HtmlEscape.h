@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace hydra::html_escape {
+
+enum class Mode : std::uint8_t {
+    // & < > as HTML entities.
+    HtmlText,
+    // HtmlText plus ".
+    HtmlAttribute,
+    // & < > as \u00XX, for JSON inside <script> elements.
+    ScriptTag,
+    // Body of a double-quoted JS string literal: \ " \n \r \t and <.
+    JsString,
+};
+
+// Scanning kernels. Scalar is the reference implementation; the vector
+// kernels look for special bytes 16/32 bytes at a time and bulk-copy clean
+// runs. All kernels produce identical output.
+enum class Kernel : std::uint8_t { Scalar, Sse2, Avx2, Neon };
+
+// Best kernel supported by this CPU, detected once; used by the overloads
+// without a Kernel argument.
+[[nodiscard]] Kernel activeKernel();
+[[nodiscard]] bool kernelSupported(Kernel kernel);
+[[nodiscard]] const char *kernelName(Kernel kernel);
+
+// Exact size of `value` once escaped for `mode`. Explicit-kernel overloads
+// throw std::runtime_error when the kernel is not supported on this CPU.
+[[nodiscard]] std::size_t escapedSize(std::string_view value, Mode mode);
+[[nodiscard]] std::size_t escapedSize(std::string_view value, Mode mode, Kernel kernel);
+
+// Appends escaped `value`; reserve escapedSize() first to avoid regrowth.
+void appendEscaped(std::string &out, std::string_view value, Mode mode);
+void appendEscaped(std::string &out, std::string_view value, Mode mode, Kernel kernel);
+
+[[nodiscard]] std::string escape(std::string_view value, Mode mode);
+
+}  // namespace hydra::html_escape
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace hydra {
 
@@ -17,19 +20,163 @@ struct HtmlShellAssets {
     std::string twitterCard;
     std::string cssPath = "/assets/app.css";
     std::string clientJsPath = "/assets/client.js";
+    // Head preloads after the stylesheet: scripts as modulepreload (classic
+    // preload when !clientJsModule) and stylesheets as preload as=style.
+    std::vector<std::string> scriptPreloadPaths;
+    std::vector<std::string> stylePreloadPaths;
     std::string hmrClientPath;
     std::string scriptNonce;
     bool clientJsModule = false;
+    // Pages given HtmlShellPageMeta::criticalCss get it in a <style> in place
+    // of the cssPath <link>, which moves to the end of the body behind a
+    // preload; pages without it keep the blocking <link>.
+    bool inlineCriticalCss = false;
     std::string devReloadProbePath;
     std::uint64_t devReloadIntervalMs = 0;
 };
 
+// Per-render head metadata (from the SSR envelope). Empty fields fall back to
+// the shell defaults the template was compiled with.
+struct HtmlShellPageMeta {
+    std::string_view title;
+    std::string_view description;
+    std::string_view canonicalUrl;
+    std::string_view robots;
+    std::string_view ogType;
+    std::string_view imageUrl;
+    std::string_view siteName;
+    std::string_view twitterCard;
+    // Rules inlined by a shell compiled with inlineCriticalCss; must not
+    // contain "</".
+    std::string_view criticalCss;
+};
+
+// HtmlShellAssets pre-rendered once into static segments, with slots for the
+// parts that change per render: page metadata, app HTML, props and the script
+// nonce. wrap() computes the exact document size and writes it into a single
+// reserved buffer. assets.scriptNonce is ignored; the nonce is a slot.
+// prefix()/suffix() ignore page.criticalCss, since a streamed head goes out
+// before the app HTML it would be picked for.
+class CompiledHtmlShell {
+  public:
+    explicit CompiledHtmlShell(const HtmlShellAssets &assets);
+
+    [[nodiscard]] std::string wrap(std::string_view appHtml,
+                                   std::string_view propsJson,
+                                   const HtmlShellPageMeta &page,
+                                   std::string_view scriptNonce) const;
+
+    // wrap() cut into alternating runs for splicing cached compressed
+    // pieces around per-request ones. Even runs depend only on the app HTML,
+    // page metadata and the props outside [requestBegin, requestEnd); odd
+    // runs hold the script nonce and the props bytes inside that range. The
+    // run count depends only on the template and on whether page.criticalCss
+    // is empty.
+    [[nodiscard]] std::vector<std::string> wrapRuns(std::string_view appHtml,
+                                                    std::string_view propsJson,
+                                                    std::size_t requestBegin,
+                                                    std::size_t requestEnd,
+                                                    const HtmlShellPageMeta &page,
+                                                    std::string_view scriptNonce) const;
+
+    // Digest of what wrap() would produce minus the per-request bytes (the
+    // script nonce and the props inside [requestBegin, requestEnd)), taken
+    // from the inputs without assembling the document. Shells compiled from
+    // equal assets give equal digests, so it validates a page across
+    // requests, restarts and nodes.
+    [[nodiscard]] std::uint64_t contentHash(std::string_view appHtml,
+                                            std::string_view propsJson,
+                                            std::size_t requestBegin,
+                                            std::size_t requestEnd,
+                                            const HtmlShellPageMeta &page) const;
+
+    // Streaming halves of wrap(); see HtmlShell::shellPrefix().
+    [[nodiscard]] std::string prefix(const HtmlShellPageMeta &page) const;
+    [[nodiscard]] std::string suffix(std::string_view propsJson,
+                                     std::string_view scriptNonce) const;
+
+  private:
+    enum class MetaField : std::uint8_t {
+        Title,
+        Description,
+        CanonicalUrl,
+        Robots,
+        OgType,
+        ImageUrl,
+        SiteName,
+        TwitterCard,
+        Count,
+    };
+    static constexpr std::size_t kMetaFieldCount = static_cast<std::size_t>(MetaField::Count);
+
+    struct Segment {
+        enum class Kind : std::uint8_t {
+            Static,
+            Nonce,
+            Props,
+            Meta,
+            MetaText,
+            // `text` is the blocking stylesheet <link>, `close` the preload
+            // that follows an inlined <style>.
+            CriticalStyle,
+            // The stylesheet <link> `text`, emitted after an inlined <style>.
+            DeferredStyle,
+        };
+        Kind kind = Kind::Static;
+        MetaField field = MetaField::Title;
+        // Static text, or the markup opening a Meta/MetaText value.
+        std::string text;
+        // Markup closing a Meta/MetaText value.
+        std::string close;
+    };
+
+    // Effective value of one metadata field for a render; `fromDefault`
+    // selects the pre-escaped default instead of escaping `value`.
+    struct MetaValue {
+        std::string_view value;
+        bool fromDefault = false;
+    };
+    using ResolvedMeta = std::array<MetaValue, kMetaFieldCount>;
+
+    // Per-render values of the slots; `meta` is null for the suffix.
+    struct Slots {
+        const ResolvedMeta *meta = nullptr;
+        std::string_view criticalCss;
+        std::string_view propsJson;
+        std::string_view scriptNonce;
+    };
+
+    [[nodiscard]] ResolvedMeta resolve(const HtmlShellPageMeta &page) const;
+    [[nodiscard]] std::size_t measure(const std::vector<Segment> &segments,
+                                      const Slots &slots) const;
+    void emit(std::string &out, const std::vector<Segment> &segments, const Slots &slots) const;
+    void emitSegment(std::string &out, const Segment &segment, const Slots &slots) const;
+
+    std::vector<Segment> prefix_;
+    std::vector<Segment> suffix_;
+    std::array<std::string, kMetaFieldCount> defaults_;
+    std::array<std::string, kMetaFieldCount> defaultsEscaped_;
+    std::string defaultTitleText_;
+    // Digest of the compiled segments, the base of contentHash().
+    std::uint64_t templateHash_ = 0;
+};
+
+// One-shot helpers for callers without a long-lived CompiledHtmlShell; each
+// call compiles the template first and uses assets.scriptNonce. Compiling
+// costs more than it saves on a single page, so request paths keep a
+// CompiledHtmlShell instead.
 class HtmlShell {
   public:
     [[nodiscard]] static std::string wrap(const std::string &appHtml,
                                           const std::string &propsJson,
                                           const HtmlShellAssets &assets);
 
+    // Streaming halves of wrap(): wrap() == shellPrefix() + appHtml + shellSuffix().
+    // The prefix ends inside the open root container.
+    [[nodiscard]] static std::string shellPrefix(const HtmlShellAssets &assets);
+    [[nodiscard]] static std::string shellSuffix(const std::string &propsJson,
+                                                 const HtmlShellAssets &assets);
+
     [[nodiscard]] static std::string errorPage(const std::string &message);
     [[nodiscard]] static std::string escapeForScriptTag(std::string_view value);
 };
@@ -1,33 +1,78 @@
 #pragma once
 
+#include "hydra/AdmissionController.h"
+#include "hydra/AssetManifest.h"
+#include "hydra/BridgeDispatcher.h"
 #include "hydra/Config.h"
+#include "hydra/CriticalCss.h"
+#include "hydra/HtmlShell.h"
+#include "hydra/LatencyHistogram.h"
+#include "hydra/PropsJson.h"
+#include "hydra/RenderCache.h"
+#include "hydra/RenderEventLog.h"
+#include "hydra/RenderTrace.h"
+#include "hydra/RequestContext.h"
+#include "hydra/ResponseCompression.h"
+#include "hydra/SharedRenderCache.h"
+#include "hydra/SsrRenderResult.h"
 
 #include <drogon/HttpRequest.h>
+#include <drogon/HttpResponse.h>
 #include <drogon/plugins/Plugin.h>
+#include <drogon/utils/coroutine.h>
 #include <json/value.h>
 
 #include <cstddef>
 #include <cstdint>
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace hydra {
 
+class Prerenderer;
+class RenderExecutor;
+class V8CodeCache;
 class V8IsolatePool;
+class V8StartupSnapshot;
 
 struct V8IsolatePoolDeleter {
     void operator()(V8IsolatePool *pool) const noexcept;
 };
 
+// Body of a renderFragment() response.
+enum class FragmentFormat : std::uint8_t {
+    // {"component","status","html","props"} as application/json, plus
+    // "redirect" for a redirect.
+    kJson,
+    // The subtree HTML as text/html, then the props delta (when there is
+    // one) in a <script type="application/json" data-hydra-fragment> block.
+    kHtml,
+};
+
 struct RenderOptions {
     std::string urlOverride;
+    // Admission priority; by default derived from the request (health check
+    // path, bot User-Agent, session cookie).
+    std::optional<RequestPriority> priority;
+    // With compression configured, renderResult() may return `html` already
+    // encoded for the request's Accept-Encoding (named by the result's
+    // Content-Encoding header). render() always turns this off.
+    bool compress = true;
+    // renderFragment() only.
+    FragmentFormat fragmentFormat = FragmentFormat::kJson;
 };
 
 struct ApiBridgeRequest {
@@ -45,6 +90,11 @@ struct ApiBridgeResponse {
 };
 
 using ApiBridgeHandler = std::function<ApiBridgeResponse(const ApiBridgeRequest &)>;
+// Serves a group of async bridge calls in one invocation; must return one
+// response per request, in order. Requests have already passed the method,
+// path and body checks.
+using ApiBridgeBatchHandler =
+    std::function<std::vector<ApiBridgeResponse>(const std::vector<ApiBridgeRequest> &)>;
 
 struct HydraMetricsSnapshot {
     std::uint64_t requestsOk = 0;
@@ -57,26 +107,31 @@ struct HydraMetricsSnapshot {
     std::uint64_t totalRenderUs = 0;
     std::uint64_t totalWrapUs = 0;
     std::uint64_t totalRequestUs = 0;
+    std::uint64_t renders = 0;
     std::uint64_t totalAcquireWaitMs = 0;
     std::uint64_t totalRenderMs = 0;
     std::uint64_t totalWrapMs = 0;
     std::uint64_t totalRequestMs = 0;
 };
 
-struct SsrRenderResult {
-    std::string html;
-    int status = 200;
-    std::unordered_map<std::string, std::string> headers;
-    std::string title;
-    std::string description;
-    std::string canonicalUrl;
-    std::string robots;
-    std::string ogType;
-    std::string imageUrl;
-    std::string siteName;
-    std::string twitterCard;
+struct ReloadResult {
+    bool ok = false;
+    // Generation serving requests afterwards.
+    std::uint64_t generation = 0;
+    std::string message;
+};
+
+struct ReadinessReport {
+    bool ready = false;
+    // "not_initialized" or "warming" when not ready.
+    std::string reason;
+    // Generation serving requests; 0 before the first one is built.
+    std::uint64_t generation = 0;
 };
 
+using SsrRenderCallback = std::function<void(SsrRenderResult)>;
+using SsrStreamCallback = std::function<void(const drogon::HttpResponsePtr &)>;
+
 class HydraSsrPlugin : public drogon::Plugin<HydraSsrPlugin> {
   public:
     ~HydraSsrPlugin();
@@ -98,25 +153,368 @@ class HydraSsrPlugin : public drogon::Plugin<HydraSsrPlugin> {
                                                const std::string &propsJson,
                                                const RenderOptions &options = {}) const;
 
+    // Non-blocking render: the work runs on the render executor and `callback`
+    // is resumed on the calling Drogon event loop (or on the executor thread
+    // when called from outside an event loop).
+    void renderResultAsync(const drogon::HttpRequestPtr &req,
+                           Json::Value props,
+                           const RenderOptions &options,
+                           SsrRenderCallback callback) const;
+    void renderResultAsync(const drogon::HttpRequestPtr &req,
+                           std::string propsJson,
+                           const RenderOptions &options,
+                           SsrRenderCallback callback) const;
+    // Streaming render: `callback` immediately receives a chunked 200 response
+    // whose first chunk is the shell head up to the root container. App HTML
+    // follows as the bundle's globalThis.renderStream writes it, then the
+    // props/scripts suffix. Routes that rely on the SSR envelope (redirects,
+    // error statuses, per-page head metadata) should keep using renderResult.
+    void renderStream(const drogon::HttpRequestPtr &req,
+                      Json::Value props,
+                      const RenderOptions &options,
+                      SsrStreamCallback callback) const;
+    void renderStream(const drogon::HttpRequestPtr &req,
+                      std::string propsJson,
+                      const RenderOptions &options,
+                      SsrStreamCallback callback) const;
+    // Renders one component subtree without the HTML shell, for client-side
+    // navigation data and partial page updates. The bundle's
+    // globalThis.renderFragment(url, propsJson, requestContextJson,
+    // componentId) runs with the same pool, admission, render cache and
+    // compression as renderResult(); `html` is the payload in
+    // options.fragmentFormat. A redirect keeps its status but moves its
+    // target from Location to X-Hydra-Redirect, so fetch() does not follow
+    // it to a full document.
+    [[nodiscard]] SsrRenderResult renderFragment(const drogon::HttpRequestPtr &req,
+                                                 const Json::Value &props,
+                                                 const std::string &componentId,
+                                                 const RenderOptions &options = {}) const;
+    [[nodiscard]] SsrRenderResult renderFragment(const drogon::HttpRequestPtr &req,
+                                                 const std::string &propsJson,
+                                                 const std::string &componentId,
+                                                 const RenderOptions &options = {}) const;
+    // renderFragment() on the render executor; see renderResultAsync().
+    void renderFragmentAsync(const drogon::HttpRequestPtr &req,
+                             Json::Value props,
+                             std::string componentId,
+                             const RenderOptions &options,
+                             SsrRenderCallback callback) const;
+#ifdef __cpp_impl_coroutine
+    [[nodiscard]] drogon::Task<SsrRenderResult> renderResultCoro(
+        drogon::HttpRequestPtr req,
+        Json::Value props,
+        RenderOptions options = {}) const;
+    [[nodiscard]] drogon::Task<SsrRenderResult> renderResultCoro(
+        drogon::HttpRequestPtr req,
+        std::string propsJson,
+        RenderOptions options = {}) const;
+#endif
+
     [[nodiscard]] HydraMetricsSnapshot metricsSnapshot() const;
     [[nodiscard]] std::string metricsPrometheus() const;
     [[nodiscard]] Json::Value observatoryReport() const;
+    // Whether this instance should take traffic: the plugin is initialized
+    // and the serving pool's initial runtimes have finished warm-up. For a
+    // load balancer readiness probe.
+    [[nodiscard]] ReadinessReport readiness() const;
+
+    // Builds a new isolate pool from the SSR bundle and asset manifest on
+    // disk and swaps it in. Renders already running finish on the old pool,
+    // which is torn down once they drain; a failed build leaves the old one
+    // serving. Blocks until done, so keep it off the event loops. Requires
+    // hot_reload.enabled.
+    ReloadResult reload(std::string reason = "api");
+    // reload() from the reload thread; `done`, when set, runs there.
+    void reloadAsync(std::string reason, std::function<void(ReloadResult)> done = {});
+
+    // Queues the prerendered variants of `paths` (every prerender route when
+    // empty) for background regeneration. Returns the number of variants
+    // queued; 0 when prerendering is off or no path matched.
+    std::size_t prerender(const std::vector<std::string> &paths = {});
+
+    // Retires the cached renders of `pageId` on every node that shares the
+    // render cache tier (render_cache.shared); returns before the other
+    // nodes have heard of it. Without the shared tier it clears this node's
+    // render cache.
+    void invalidateRenderCache(const std::string &pageId);
 
     void setApiBridgeHandler(ApiBridgeHandler handler);
+    // Used for async calls when api_bridge.max_batch > 1; without one the
+    // calls of a batch go to the single-call handler one by one.
+    void setApiBridgeBatchHandler(ApiBridgeBatchHandler handler);
 
   private:
+    // One build of the UI: the SSR bundle's isolate pool and the shell
+    // compiled against the asset manifest shipped with it. A request holds
+    // its generation for the whole render, so a reload can swap in the next
+    // one while in-flight leases finish on this one.
+    struct RenderGeneration {
+        std::uint64_t id = 0;
+        std::string reason;
+        std::chrono::system_clock::time_point loadedAt;
+        std::uint64_t buildMs = 0;
+        std::string cssPath;
+        std::string clientJsPath;
+        std::shared_ptr<const V8StartupSnapshot> snapshot;
+        std::string snapshotStatus = "disabled";
+        // The stylesheet indexed for critical CSS; null unless critical_css
+        // is on and the stylesheet could be read.
+        std::unique_ptr<const CriticalCss> criticalCss;
+        std::unique_ptr<const CompiledHtmlShell> shell;
+        // Link header of `shell`'s preloads; empty unless early hints are on.
+        std::string linkHeader;
+        // Pages with chunks of their own get a shell preloading them too,
+        // keyed by AssetManifest::pageKey() of the pageId.
+        struct PagePreloads {
+            std::unique_ptr<const CompiledHtmlShell> shell;
+            std::string linkHeader;
+        };
+        std::unordered_map<std::string, PagePreloads> pagePreloads;
+        // Digest of the SSR bundle, manifest and shell: nodes agreeing on it
+        // render identical pages and may share cache entries. Empty unless
+        // the shared render cache tier is on.
+        std::string buildId;
+        std::unique_ptr<V8IsolatePool, V8IsolatePoolDeleter> pool;
+    };
+    using GenerationPtr = std::shared_ptr<const RenderGeneration>;
+
+    struct ReloadRequest {
+        std::string reason;
+        std::function<void(ReloadResult)> done;
+    };
+
+    struct PreparedRender {
+        std::string routeUrl;
+        std::string requestId;
+        std::string requestContextJson;
+        // Props with __hydra_request spliced in; the same buffer is handed to
+        // V8 and embedded as __HYDRA_PROPS__.
+        std::shared_ptr<const std::string> propsJson;
+        std::string pageId;
+        std::string scriptNonce;
+        std::string locale;
+        std::string theme;
+        RequestPriority priority = RequestPriority::kNormal;
+        // Per-page latency series; null when route metrics are off.
+        RouteLatencyMetrics::Route *latencyRoute = nullptr;
+        // Null unless this request was sampled for tracing.
+        std::shared_ptr<RenderTrace> trace;
+        // Kept for __hydraRequestDetail reads; null unless lazy_details.
+        drogon::HttpRequestPtr lazyRequest;
+        GenerationPtr generation;
+        // The generation's shell and Link header for pageId.
+        const CompiledHtmlShell *shell = nullptr;
+        const std::string *linkHeader = nullptr;
+        // Bytes of *propsJson taken by __hydra_request, which differ on every
+        // request; the rest are the controller props.
+        std::size_t requestPropsBegin = 0;
+        std::size_t requestPropsEnd = 0;
+        // Negotiated from Accept-Encoding; identity unless compression is on
+        // and the caller takes an encoded body.
+        ContentEncoding encoding = ContentEncoding::kIdentity;
+        bool gzipAccepted = false;
+        // If-None-Match of a GET or HEAD; empty unless ETags are on.
+        std::string ifNoneMatch;
+        // Set by renderFragment(): the subtree rendered instead of the page.
+        std::string componentId;
+        FragmentFormat fragmentFormat = FragmentFormat::kJson;
+        // Held from admission on the calling thread until the render ends;
+        // null when the render is admitted where it runs.
+        std::shared_ptr<AdmissionController::Ticket> admission;
+        // When the render was handed to the render executor; the wait for a
+        // render thread comes out of the acquire timeout.
+        std::chrono::steady_clock::time_point queuedAt{};
+    };
+
+    struct FragmentTiming {
+        std::uint64_t acquireWaitUs = 0;
+        std::uint64_t renderUs = 0;
+        std::uint64_t renderIndex = 0;
+        BridgeRenderStats bridge;
+    };
+
+    [[nodiscard]] PreparedRender prepareRender(const drogon::HttpRequestPtr &req,
+                                               const std::string &propsJson,
+                                               const RenderOptions &options) const;
+    [[nodiscard]] PreparedRender prepareRender(const drogon::HttpRequestPtr &req,
+                                               const std::string &propsJson,
+                                               const props_json::ObjectShape &propsShape,
+                                               const RenderOptions &options) const;
+    [[nodiscard]] SsrRenderResult renderPrepared(const drogon::HttpRequestPtr &req,
+                                                 const std::string &propsJson,
+                                                 const PreparedRender &prepared) const;
+    // renderPrepared() for a renderFragment() request.
+    [[nodiscard]] SsrRenderResult renderComponentPrepared(const drogon::HttpRequestPtr &req,
+                                                          const std::string &propsJson,
+                                                          const PreparedRender &prepared) const;
+    // The renderFragment() body for `fragment` in prepared.fragmentFormat;
+    // a non-empty `error` replaces the subtree.
+    [[nodiscard]] std::string fragmentPayload(const PreparedRender &prepared,
+                                              const SsrRenderResult &fragment,
+                                              std::string_view error) const;
+    // Leases a runtime and renders the pre-shell SSR result, or
+    // prepared.componentId's subtree. Render latency
+    // and count are recorded here so cache refreshes are accounted for too.
+    [[nodiscard]] SsrRenderResult renderOnIsolate(const PreparedRender &prepared,
+                                                  FragmentTiming *timing) const;
+    [[nodiscard]] RequestPriority classifyRequest(const drogon::HttpRequestPtr &req,
+                                                  const RenderOptions &options) const;
+    // Takes an admission ticket or throws AdmissionRejectedError.
+    [[nodiscard]] AdmissionController::Ticket admitRender(const PreparedRender &prepared) const;
+    // Acquire timeout for `prepared`, less the time it spent queued.
+    [[nodiscard]] std::uint64_t acquireTimeoutFor(const PreparedRender &prepared) const;
+    // Admits `prepared` and queues it on the render executor; a shed or a
+    // full queue is answered right away.
+    void postPrepared(const drogon::HttpRequestPtr &req,
+                      std::string propsJson,
+                      PreparedRender prepared,
+                      SsrRenderCallback callback) const;
+    // Shell-only or 503 response for a shed request, with the request
+    // counted and logged.
+    [[nodiscard]] SsrRenderResult shedRequest(const PreparedRender &prepared,
+                                              const AdmissionRejectedError &error,
+                                              std::chrono::steady_clock::time_point requestStartedAt,
+                                              std::uint64_t acquireWaitUs) const;
+    [[nodiscard]] RenderCache::Policy renderCachePolicyFor(const std::string &pageId) const;
+    // Render cache key for `prepared` under its page's current tag version.
+    [[nodiscard]] RenderCache::Key renderCacheKey(const PreparedRender &prepared,
+                                                  std::string_view routeKey,
+                                                  std::string_view propsJson) const;
+    // The route part of the cache key: the URL, or the URL and the
+    // component for a fragment.
+    [[nodiscard]] std::string renderCacheRoute(const PreparedRender &prepared) const;
+    // The render cache producer: the shared tier's copy when it has one
+    // (setting *sharedHit), else a fresh render that is also written there.
+    [[nodiscard]] RenderCache::Value produceCachedRender(const RenderCache::Key &key,
+                                                         const RenderCache::Policy &policy,
+                                                         const PreparedRender &prepared,
+                                                         FragmentTiming *timing,
+                                                         bool *sharedHit) const;
+    void shareCachedRender(const RenderCache::Key &key,
+                           const RenderCache::Policy &policy,
+                           const PreparedRender &prepared,
+                           const CachedRender &value) const;
+    // Whether a pre-shell result is wrapped in the generation's shell.
+    [[nodiscard]] bool wrapsFragment(const SsrRenderResult &fragment) const;
+    // A render cache value for `fragment`, with gzip blocks of the runs every
+    // hit shares when compression is on. A component render is stored as its
+    // finished payload, which is one shared run. Runs wherever the render
+    // did.
+    [[nodiscard]] RenderCache::Value makeCachedRender(const PreparedRender &prepared,
+                                                      SsrRenderResult fragment) const;
+    // Whether `cached` holds gzip blocks a hit for `prepared` can splice.
+    [[nodiscard]] bool canSpliceGzip(const PreparedRender &prepared,
+                                     const CachedRender *cached) const;
+    // Encodes the finished body for prepared.encoding; `runs`, when set, are
+    // the wrapped document's runs to splice with cached->sharedGzip.
+    void encodeResponse(const PreparedRender &prepared,
+                        const CachedRender *cached,
+                        const std::vector<std::string> *runs,
+                        SsrRenderResult *response) const;
+    void refreshCachedRender(const RenderCache::Key &key,
+                             const RenderCache::Policy &policy,
+                             PreparedRender prepared) const;
+    // Weak ETag for `page` as `prepared` sends it, or empty when the
+    // response is not revalidated. `meta` is the page metadata it is
+    // wrapped with, null when it goes out unwrapped.
+    [[nodiscard]] std::string entityTagFor(const PreparedRender &prepared,
+                                           const SsrRenderResult &page,
+                                           const HtmlShellPageMeta *meta) const;
+    // Configured shell head defaults plus a generation's asset paths and
+    // critical CSS mode, compiled into its shells.
+    [[nodiscard]] HtmlShellAssets shellDefaults(const RenderGeneration &generation) const;
+    // pageMetaFor(page) with the critical CSS for page.html, which
+    // `criticalCss` keeps alive.
+    [[nodiscard]] HtmlShellPageMeta shellPageMeta(
+        const PreparedRender &prepared,
+        const SsrRenderResult &page,
+        std::shared_ptr<const std::string> *criticalCss) const;
+    // The asset manifest's chunk graph, or nullopt (logged) when it cannot
+    // be read.
+    [[nodiscard]] std::optional<AssetManifest> loadAssetManifest() const;
+    // Indexes the stylesheet served at `cssPath`, which must be a manifest
+    // file; null (logged) when it is not or cannot be read.
+    [[nodiscard]] std::unique_ptr<const CriticalCss> loadCriticalCss(
+        const AssetManifest *manifest,
+        const std::string &cssPath) const;
+    // css and client script paths for a new generation: configured values
+    // win, then the manifest, then the dev server or built-in defaults.
+    void resolveAssetPaths(const AssetManifest *manifest,
+                           std::string *cssPath,
+                           std::string *clientJsPath) const;
+    // Compiles the generation's shells with the entry's preloads, plus one
+    // per page that has lazy chunks, and their Link headers.
+    void buildPreloads(const AssetManifest &manifest, RenderGeneration *generation) const;
+    // Sets the Link header of `prepared`'s preloads on an SSR document;
+    // `streamed` marks the head of a streamed one.
+    void applyLinkHeader(const PreparedRender &prepared,
+                         bool streamed,
+                         SsrRenderResult *response) const;
+    // Sets a non-empty `etag` on a full response, counting it as modified
+    // when the request carried If-None-Match.
+    void applyEntityTag(const PreparedRender &prepared,
+                        std::string etag,
+                        SsrRenderResult *response) const;
+    [[nodiscard]] GenerationPtr currentGeneration() const;
+    // Builds and publishes the generation after `previous`; runs on the
+    // reload thread.
+    [[nodiscard]] ReloadResult performReload(const GenerationPtr &previous,
+                                             const std::string &reason);
+    void runReloadLoop();
+    // Pre-routing advice: points a prerendered route at its file under
+    // document_root so the static file handler serves it.
+    void routeToPrerendered(const drogon::HttpRequestPtr &req) const;
+    // Sampling gate for the render event log; false when logging is off.
+    [[nodiscard]] bool shouldLogRenderEvent(bool failed, std::uint64_t totalUs) const;
+    // Fills in the request identity and queues the event; formatting happens
+    // on the log's drain thread in writeRenderEvent().
+    void logRenderEvent(const PreparedRender &prepared, RenderEvent &event) const;
+    void writeRenderEvent(const RenderEvent &event) const;
+    void applySecurityHeaders(SsrRenderResult *response,
+                              bool wrappedWithShell,
+                              const std::string &scriptNonce) const;
+    void streamDocument(const PreparedRender &prepared,
+                        drogon::ResponseStream &stream,
+                        const std::string &suffix,
+                        std::chrono::steady_clock::time_point requestStartedAt) const;
+    void failStreamedDocument(const PreparedRender &prepared,
+                              drogon::ResponseStream &stream,
+                              const std::string &suffix,
+                              const std::string &message,
+                              std::chrono::steady_clock::time_point requestStartedAt,
+                              std::uint64_t acquireWaitUs) const;
     [[nodiscard]] std::string buildRouteUrl(const drogon::HttpRequestPtr &req,
                                             const RenderOptions &options) const;
     [[nodiscard]] Json::Value buildRequestContext(const drogon::HttpRequestPtr &req,
                                                   const std::string &routeUrl,
                                                   const std::string &requestId) const;
     [[nodiscard]] std::string resolveRequestId(const drogon::HttpRequestPtr &req) const;
-    void observeAcquireWait(double valueMs) const;
-    void observeRenderLatency(double valueMs) const;
-    void observeRequestLatency(double valueMs) const;
+    [[nodiscard]] SsrRenderResult unavailableResult(const drogon::HttpRequestPtr &req,
+                                                    int status,
+                                                    const std::string &message) const;
+    // Sampling decision for a new request: a sampled traceparent always
+    // wins, otherwise tracing.sample_rate applies. Null when not traced.
+    [[nodiscard]] std::shared_ptr<RenderTrace> startTrace(const drogon::HttpRequestPtr &req,
+                                                          const std::string &requestId) const;
+    // Ends the root span, adds Server-Timing to `response` when configured
+    // and queues the trace for export. `response` is null for streams.
+    void finishTrace(const PreparedRender &prepared,
+                     int httpStatus,
+                     bool failed,
+                     SsrRenderResult *response) const;
+    void observeAcquireWait(std::uint64_t acquireWaitUs) const;
+    void observeRenderLatency(const PreparedRender &prepared, std::uint64_t renderUs) const;
+    void observeRequestLatency(const PreparedRender &prepared, std::uint64_t totalUs) const;
     void observeRequestCode(int statusCode) const;
+    void observeBridgeCalls(const BridgeRenderStats &stats) const;
     [[nodiscard]] ApiBridgeResponse dispatchApiBridge(
         const ApiBridgeRequest &request) const;
+    // Normalizes the method and applies the enabled, method, path and body
+    // checks; the rejection response, or nullopt when the call may proceed.
+    [[nodiscard]] std::optional<ApiBridgeResponse> rejectApiBridge(
+        ApiBridgeRequest *request) const;
+    [[nodiscard]] std::vector<ApiBridgeResponse> dispatchApiBridgeBatch(
+        std::vector<ApiBridgeRequest> requests) const;
     void registerDevProxyRoutes();
 
     std::string ssrBundlePath_;
@@ -133,9 +531,16 @@ class HydraSsrPlugin : public drogon::Plugin<HydraSsrPlugin> {
     std::string assetManifestPath_ = "./public/assets/manifest.json";
     std::string assetPublicPrefix_ = "/assets";
     std::string clientManifestEntry_ = "src/entry-client.tsx";
+    // Shell engine only: the document shell, compiled once at initAndStart.
+    std::unique_ptr<const CompiledHtmlShell> staticShell_;
+    // Elastic pool bounds; equal for a fixed pool.
     std::size_t isolatePoolSize_ = 0;
+    std::size_t isolatePoolMax_ = 0;
     std::uint64_t isolateAcquireTimeoutMs_ = 0;
     std::uint64_t renderTimeoutMs_ = 250;
+    std::size_t renderThreadCount_ = 0;
+    // Shared across generations; keyed by bundle content.
+    std::shared_ptr<V8CodeCache> v8CodeCache_;
     bool wrapFragment_ = true;
     bool clientJsModule_ = false;
     std::string hmrClientPath_;
@@ -153,31 +558,18 @@ class HydraSsrPlugin : public drogon::Plugin<HydraSsrPlugin> {
     std::string devReloadProbePath_ = "/__hydra/test";
     std::uint64_t devReloadIntervalMs_ = 1000;
     bool apiBridgeEnabled_ = true;
-    std::string i18nDefaultLocale_ = "en";
-    std::string i18nQueryParam_ = "lang";
-    std::string i18nCookieName_ = "hydra_lang";
-    bool i18nIncludeLocaleCandidates_ = false;
-    std::unordered_set<std::string> i18nSupportedLocales_;
-    std::vector<std::string> i18nSupportedLocaleOrder_;
-    std::string themeDefault_ = "ocean";
-    std::string themeQueryParam_ = "theme";
-    std::string themeCookieName_ = "hydra_theme";
-    bool themeIncludeThemeCandidates_ = false;
-    std::unordered_set<std::string> themeSupportedThemes_;
-    std::vector<std::string> themeSupportedThemeOrder_;
-    bool requestContextIncludeCookies_ = false;
-    bool requestContextIncludeCookieMap_ = false;
-    std::unordered_set<std::string> requestContextAllowedCookies_;
-    std::unordered_set<std::string> requestContextHeaderAllowlist_;
-    std::unordered_set<std::string> requestContextHeaderBlocklist_ = {
-        "authorization",
-        "proxy-authorization",
-        "cookie",
-        "set-cookie",
-        "x-api-key",
-    };
+    RequestContextOptions requestContext_;
+    std::unique_ptr<RequestContextBuilder> requestContextBuilder_;
+    std::vector<std::string> admissionHealthPaths_;
+    std::vector<std::string> admissionSessionCookies_;
+    std::vector<std::string> admissionBotUserAgents_;
+    std::uint64_t admissionRetryAfterSec_ = 1;
+    bool tracingEnabled_ = false;
+    double tracingSampleRate_ = 0.0;
+    bool tracingServerTiming_ = false;
     bool logRequestRoutes_ = false;
     bool logRenderMetrics_ = true;
+    bool etagEnabled_ = false;
     HydraSsrPluginConfig normalizedConfig_;
     mutable std::atomic<std::uint64_t> renderCount_{0};
     mutable std::atomic<std::uint64_t> poolTimeoutCount_{0};
@@ -192,23 +584,82 @@ class HydraSsrPlugin : public drogon::Plugin<HydraSsrPlugin> {
     mutable std::atomic<std::uint64_t> totalRequestUs_{0};
     mutable std::atomic<std::uint64_t> requestIdCounter_{0};
     mutable std::atomic<bool> warnedUnwrappedFragment_{false};
-    static constexpr std::size_t kLatencyHistogramBucketCount = 13;
-    mutable std::array<std::atomic<std::uint64_t>, kLatencyHistogramBucketCount>
-        acquireWaitHistogram_{};
-    mutable std::array<std::atomic<std::uint64_t>, kLatencyHistogramBucketCount>
-        renderLatencyHistogram_{};
-    mutable std::array<std::atomic<std::uint64_t>, kLatencyHistogramBucketCount>
-        requestLatencyHistogram_{};
+    mutable std::atomic<std::uint64_t> tracedRequestCount_{0};
+    mutable LatencyHistogram acquireWaitHistogram_;
+    mutable LatencyHistogram renderLatencyHistogram_;
+    mutable LatencyHistogram requestLatencyHistogram_;
+    // Prometheus `le` bounds, kept in both units so export does not convert.
+    std::vector<double> histogramBoundsMs_;
+    std::vector<std::uint64_t> histogramBoundsUs_;
+    std::vector<double> latencyQuantiles_;
     static constexpr std::size_t kHttpStatusCodeMax = 599;
     mutable std::array<std::atomic<std::uint64_t>, kHttpStatusCodeMax + 1>
         requestCodeCounts_{};
     std::unordered_set<std::string> apiBridgeAllowedMethods_ = {"GET", "POST"};
     std::vector<std::string> apiBridgeAllowedPathPrefixes_ = {"/hydra/internal/"};
     std::size_t apiBridgeMaxBodyBytes_ = 64 * 1024;
+    std::size_t apiBridgeAsyncThreads_ = 4;
+    std::size_t apiBridgeMaxBatch_ = 0;
+    bool apiBridgeMemoize_ = true;
     mutable std::mutex apiBridgeMutex_;
     ApiBridgeHandler apiBridgeHandler_;
+    ApiBridgeBatchHandler apiBridgeBatchHandler_;
+    mutable std::atomic<std::uint64_t> bridgeSyncCalls_{0};
+    mutable std::atomic<std::uint64_t> bridgeAsyncCalls_{0};
+    mutable std::atomic<std::uint64_t> bridgeMemoizedCalls_{0};
+    mutable std::atomic<std::uint64_t> bridgeRenders_{0};
+    mutable std::atomic<std::uint64_t> bridgeWaitUs_{0};
+    mutable std::atomic<std::uint64_t> gzipResponses_{0};
+    mutable std::atomic<std::uint64_t> gzipSplicedResponses_{0};
+    mutable std::atomic<std::uint64_t> brotliResponses_{0};
+    mutable std::atomic<std::uint64_t> compressionFailures_{0};
+    mutable std::atomic<std::uint64_t> compressionBytesIn_{0};
+    mutable std::atomic<std::uint64_t> compressionBytesOut_{0};
+    mutable std::atomic<std::uint64_t> linkHeaderResponses_{0};
+    mutable std::atomic<std::uint64_t> linkHeaderStreams_{0};
+    mutable std::atomic<std::uint64_t> criticalCssPageHits_{0};
+    mutable std::atomic<std::uint64_t> criticalCssClassSetHits_{0};
+    mutable std::atomic<std::uint64_t> criticalCssSelections_{0};
+    mutable std::atomic<std::uint64_t> criticalCssFallbacks_{0};
+    mutable std::atomic<std::uint64_t> etagNotModifiedCached_{0};
+    mutable std::atomic<std::uint64_t> etagNotModifiedRendered_{0};
+    mutable std::atomic<std::uint64_t> etagModified_{0};
+    mutable std::atomic<std::uint64_t> fragmentJsonResponses_{0};
+    mutable std::atomic<std::uint64_t> fragmentHtmlResponses_{0};
+    mutable std::atomic<std::uint64_t> warmupRenderFailures_{0};
+    // Handler latency per call; a batched call records its batch's time.
+    mutable LatencyHistogram bridgeCallHistogram_;
 
-    std::unique_ptr<V8IsolatePool, V8IsolatePoolDeleter> isolatePool_;
+    std::unique_ptr<RenderCache> renderCache_;
+    std::shared_ptr<SharedRenderCache> sharedRenderCache_;
+    std::unique_ptr<Prerenderer> prerenderer_;
+    // Marks the plugin's own prerender requests so they reach the handler.
+    std::string prerenderToken_;
+    std::atomic<bool> prerenderStopping_{false};
+    RenderCache::Policy renderCacheDefaultPolicy_;
+    std::unordered_map<std::string, RenderCache::Policy> renderCachePolicies_;
+    // Builds the generation after `previous` (null at startup) from the
+    // files on disk; throws when no runtime can be created.
+    std::function<std::shared_ptr<RenderGeneration>(const RenderGeneration *previous)>
+        buildGeneration_;
+    mutable std::mutex generationMutex_;
+    GenerationPtr generation_;
+    std::string lastReloadError_;
+    std::atomic<std::uint64_t> reloadsOk_{0};
+    std::atomic<std::uint64_t> reloadsFailed_{0};
+    std::atomic<std::size_t> drainingGenerations_{0};
+    std::mutex reloadMutex_;
+    std::condition_variable reloadCv_;
+    std::deque<ReloadRequest> reloadQueue_;
+    bool reloadStopping_ = false;
+    std::thread reloadThread_;
+    std::unique_ptr<RenderExecutor> renderExecutor_;
+    // Shared with every runtime; null when api_bridge.async_threads is 0.
+    std::shared_ptr<BridgeDispatcher> bridgeDispatcher_;
+    std::unique_ptr<RenderEventLog> renderEventLog_;
+    std::unique_ptr<AdmissionController> admission_;
+    std::unique_ptr<RouteLatencyMetrics> routeLatency_;
+    std::unique_ptr<TraceExporter> traceExporter_;
 };
 
 }  // namespace hydra
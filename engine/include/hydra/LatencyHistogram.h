@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hydra {
+
+// Log-linear latency histogram over microseconds. Every power of two is
+// split into kSubBuckets equal buckets, so a bucket is never wider than
+// 1/8 of its lower bound (about 6% error at the midpoint) from 8us up
+// to ~268s; larger values land in the last bucket.
+//
+// Counts live in per-thread shards: record() is a bucket index computed
+// from the value's leading bit plus relaxed adds on the caller's shard.
+// snapshot() sums the shards and is meant for the metrics endpoints.
+class LatencyHistogram {
+  public:
+    static constexpr unsigned kSubBucketBits = 3;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+    static constexpr unsigned kMaxExponent = 27;
+    static constexpr std::size_t kBucketCount =
+        (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+    static constexpr std::size_t kDefaultShards = 8;
+
+    struct Snapshot {
+        std::array<std::uint64_t, kBucketCount> counts{};
+        std::uint64_t count = 0;
+        std::uint64_t sumUs = 0;
+
+        // Value at quantile `q` (0..1), interpolated within its bucket; 0
+        // when empty.
+        [[nodiscard]] double quantileUs(double q) const;
+        // Samples at or below `boundUs`, interpolating the bucket that
+        // straddles the bound. Non-decreasing in `boundUs`.
+        [[nodiscard]] std::uint64_t countAtOrBelow(std::uint64_t boundUs) const;
+    };
+
+    // `shards` is rounded up to a power of two.
+    explicit LatencyHistogram(std::size_t shards = kDefaultShards);
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    void record(std::uint64_t valueUs);
+    [[nodiscard]] Snapshot snapshot() const;
+
+    [[nodiscard]] static std::size_t bucketIndex(std::uint64_t valueUs);
+    [[nodiscard]] static std::uint64_t bucketLowerUs(std::size_t index);
+    // Exclusive.
+    [[nodiscard]] static std::uint64_t bucketUpperUs(std::size_t index);
+
+  private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, kBucketCount> counts{};
+        std::atomic<std::uint64_t> sumUs{0};
+    };
+
+    std::size_t shardMask_ = 0;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+// Per-route render and request histograms keyed by pageId. Lookups never
+// lock: routes sit in a fixed open-addressed table that only grows, under
+// a mutex, until maxRoutes. Past the cap every new route shares the
+// kOverflowRoute entry, so a client inventing page ids cannot grow memory.
+class RouteLatencyMetrics {
+  public:
+    static constexpr std::string_view kOverflowRoute = "_other";
+
+    struct Route {
+        Route(std::string routeName, std::size_t shards);
+
+        const std::string name;
+        LatencyHistogram render;
+        LatencyHistogram request;
+    };
+
+    RouteLatencyMetrics(std::size_t maxRoutes, std::size_t shards);
+    ~RouteLatencyMetrics();
+
+    RouteLatencyMetrics(const RouteLatencyMetrics &) = delete;
+    RouteLatencyMetrics &operator=(const RouteLatencyMetrics &) = delete;
+
+    // Never null; the reference stays valid for the registry's lifetime.
+    [[nodiscard]] Route &route(std::string_view name);
+    // Tracked routes sorted by name, then the overflow route if it was used.
+    [[nodiscard]] std::vector<const Route *> routes() const;
+    [[nodiscard]] std::size_t maxRoutes() const;
+
+  private:
+    [[nodiscard]] Route *find(std::string_view name, std::size_t hash) const;
+
+    std::size_t maxRoutes_ = 0;
+    std::size_t shards_ = 0;
+    std::size_t tableMask_ = 0;
+    std::unique_ptr<std::atomic<Route *>[]> table_;
+    std::atomic<bool> overflowUsed_{false};
+    std::unique_ptr<Route> overflow_;
+    // Owns every tracked route; guarded by mutex_. Readers go through table_.
+    std::vector<std::unique_ptr<Route>> owned_;
+    std::mutex mutex_;
+};
+
+}  // namespace hydra
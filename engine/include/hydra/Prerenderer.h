@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+// Keeps rendered copies of a fixed route list on disk, one file per
+// locale/theme variant, so the static file handler can serve hot pages
+// without an isolate. Files are replaced atomically; a variant keeps being
+// served from its previous file while it is regenerated, and a failed
+// render leaves that file in place and retries later. Thread-safe.
+class Prerenderer {
+  public:
+    struct Route {
+        std::string path;
+        // 0 renders the variant once and keeps it until invalidate().
+        std::chrono::seconds revalidate{0};
+        std::vector<std::string> locales;
+        std::vector<std::string> themes;
+    };
+
+    struct Variant {
+        std::string path;
+        std::string locale;
+        std::string theme;
+    };
+
+    // The variant's HTML, or nullopt when it must not be written (render
+    // failure or a non-200 page).
+    using RenderFn = std::function<std::optional<std::string>(const Variant &)>;
+
+    struct Options {
+        // Directory the files are written under, and the URL path the
+        // static file handler serves it at.
+        std::filesystem::path outputRoot;
+        std::string urlPrefix = "/_prerender";
+        std::vector<Route> routes;
+        // How often the background thread looks for due variants.
+        std::chrono::milliseconds tickInterval{1000};
+        // Delay before a failed variant is rendered again.
+        std::chrono::seconds retryDelay{10};
+    };
+
+    struct Stats {
+        std::size_t routes = 0;
+        std::size_t variants = 0;
+        std::size_t ready = 0;
+        std::uint64_t renders = 0;
+        std::uint64_t failures = 0;
+        std::uint64_t hits = 0;
+    };
+
+    // Throws std::runtime_error for a route path or locale/theme tag that
+    // cannot be mapped to a file under outputRoot. Every variant starts out
+    // due: files left by an earlier process may belong to another bundle.
+    Prerenderer(Options options, RenderFn render);
+    ~Prerenderer();
+
+    Prerenderer(const Prerenderer &) = delete;
+    Prerenderer &operator=(const Prerenderer &) = delete;
+
+    // Starts the background thread; safe to call once the render function
+    // can serve requests.
+    void start();
+    void stop();
+
+    // Whether `path` is one of the configured routes.
+    [[nodiscard]] bool covers(std::string_view path) const;
+
+    // URL path of the file to serve for `path` in this variant, or nullopt
+    // when the route is not prerendered or the file has not been written yet.
+    [[nodiscard]] std::optional<std::string> lookup(std::string_view path,
+                                                    std::string_view locale,
+                                                    std::string_view theme) const;
+
+    // Marks every variant of `paths` (all routes when empty) due now and
+    // wakes the background thread; returns the number of variants marked.
+    std::size_t invalidate(const std::vector<std::string> &paths = {});
+
+    // Renders every due variant on the calling thread; returns how many
+    // were written.
+    std::size_t regenerateDue();
+
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct VariantState {
+        Variant variant;
+        std::filesystem::path file;
+        std::string urlPath;
+        Clock::time_point due;
+        bool ready = false;
+        bool rendering = false;
+        // invalidate() arrived while rendering.
+        bool invalidated = false;
+    };
+
+    struct RouteState {
+        std::chrono::seconds revalidate{0};
+        std::vector<VariantState> variants;
+    };
+
+    bool writeFile(const std::filesystem::path &file, const std::string &html) const;
+    void run();
+
+    Options options_;
+    RenderFn render_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, RouteState> routes_;
+    std::uint64_t renders_ = 0;
+    std::uint64_t failures_ = 0;
+    mutable std::atomic<std::uint64_t> hits_{0};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool stopping_ = false;
+    bool wakeRequested_ = false;
+    std::thread thread_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace hydra::props_json {
+
+// Top-level layout of a props object, read in a single pass without
+// building a Json::Value.
+struct ObjectShape {
+    bool isObject = false;
+    // True for `{}`; decides whether a spliced member needs a leading comma.
+    bool empty = true;
+    // Offset of the closing brace.
+    std::size_t closeOffset = 0;
+    // __hydra_route.pageId when it is a string, else a top-level "page"
+    // string, else empty.
+    std::string pageId;
+};
+
+// Validates the object's structure (strings, nesting, separators) but not
+// number or literal syntax; isObject is false for anything that is not a
+// well-formed top-level object.
+[[nodiscard]] ObjectShape scanObject(std::string_view json);
+
+// Returns `json` with "key":valueJson added as its last member. `key` must
+// not need JSON escaping and `valueJson` must already be serialized. When
+// the object already has `key`, JSON.parse keeps the appended (last) value.
+// Returns `json` unchanged when shape.isObject is false.
+[[nodiscard]] std::string appendMember(std::string_view json,
+                                       const ObjectShape &shape,
+                                       std::string_view key,
+                                       std::string_view valueJson);
+
+}  // namespace hydra::props_json
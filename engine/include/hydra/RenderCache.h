@@ -0,0 +1,170 @@
+#pragma once
+
+#include "hydra/ResponseCompression.h"
+#include "hydra/SsrRenderResult.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+
+// A cached pre-shell render. With response compression on it also keeps
+// gzip blocks of the shared runs of the wrapped document
+// (CompiledHtmlShell::wrapRuns), so a hit splices them instead of
+// compressing the page again.
+struct CachedRender : SsrRenderResult {
+    // Generation whose shell produced sharedGzip.
+    std::uint64_t generation = 0;
+    std::vector<DeflateBlock> sharedGzip;
+    // ETag of the page under that generation's shell; empty when ETags are
+    // off or the page is not revalidated.
+    std::string etag;
+    // Time the value had already spent in the shared tier when this node
+    // took it; counted against the local TTL.
+    std::chrono::milliseconds inheritedAge{0};
+};
+
+// In-process cache of pre-shell SSR output (app HTML, status, headers and
+// head metadata). Entries are sharded by key hash, each shard an LRU with an
+// equal slice of the byte budget. Concurrent misses for one key share a
+// single render, and entries past their TTL keep being served for the
+// stale-while-revalidate window while one caller refreshes them.
+class RenderCache {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Value = std::shared_ptr<const CachedRender>;
+    using Producer = std::function<Value()>;
+
+    // Two independently seeded hashes of the key material; `check` guards
+    // against serving another page's output on a 64-bit collision.
+    struct Key {
+        std::uint64_t hash = 0;
+        std::uint64_t check = 0;
+    };
+
+    struct Policy {
+        std::chrono::milliseconds ttl{0};
+        std::chrono::milliseconds staleWhileRevalidate{0};
+    };
+
+    enum class Outcome {
+        kHit,
+        kStale,
+        kMiss,
+        kCoalesced,
+    };
+
+    struct Lookup {
+        Value value;
+        Outcome outcome = Outcome::kMiss;
+        // Set on the one stale hit that claimed the refresh; the caller must
+        // finish it with store() or refreshFailed().
+        bool refresh = false;
+    };
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t staleHits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t coalesced = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t refreshFailures = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+    };
+
+    RenderCache(std::size_t maxBytes, std::size_t shardCount);
+
+    RenderCache(const RenderCache &) = delete;
+    RenderCache &operator=(const RenderCache &) = delete;
+
+    // `tagVersion` is the invalidation version of the page's tag
+    // (SharedRenderCache::tagVersion); bumping it retires every key built
+    // with the old one. 0 leaves the key as if there were no tag.
+    [[nodiscard]] static Key makeKey(std::string_view routeUrl,
+                                     std::string_view locale,
+                                     std::string_view theme,
+                                     std::string_view propsJson,
+                                     std::uint64_t tagVersion = 0);
+
+    // Byte encoding of a value for a cache shared between processes.
+    // `storedAtMs` is the writer's wall clock in Unix milliseconds; gzip
+    // blocks are only written with `withGzip`. The generation is not
+    // encoded: it means nothing to another process.
+    [[nodiscard]] static std::string encode(const CachedRender &value,
+                                            std::uint64_t storedAtMs,
+                                            bool withGzip);
+    // Null for bytes encode() did not produce, including truncated ones.
+    [[nodiscard]] static std::shared_ptr<CachedRender> decode(std::string_view bytes,
+                                                              std::uint64_t *storedAtMs);
+
+    // Only successful, cookie-free responses are shared between requests.
+    [[nodiscard]] static bool cacheable(const SsrRenderResult &result);
+
+    // Returns the cached value, or runs `produce` on a miss. Callers that miss
+    // while another render of the same key is in flight wait for it instead;
+    // exceptions thrown by `produce` reach every waiter. A nonzero
+    // `generation` treats values of any other generation as missing: a
+    // render in flight across a reload may store after the cache was cleared.
+    [[nodiscard]] Lookup getOrRender(const Key &key,
+                                     const Policy &policy,
+                                     const Producer &produce,
+                                     std::uint64_t generation = 0);
+
+    // Whether getOrRender() would answer from an entry right now, fresh or
+    // stale, without rendering. Leaves recency and stats alone.
+    [[nodiscard]] bool contains(const Key &key, std::uint64_t generation = 0);
+
+    void store(const Key &key, const Policy &policy, Value value);
+    void refreshFailed(const Key &key);
+    void clear();
+
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    struct Entry {
+        Key key;
+        Value value;
+        std::size_t bytes = 0;
+        Clock::time_point freshUntil;
+        Clock::time_point staleUntil;
+        bool refreshing = false;
+        std::list<std::uint64_t>::iterator lruPosition;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, Entry> entries;
+        std::unordered_map<std::uint64_t, std::pair<Key, std::shared_future<Value>>> inflight;
+        // Most recently used first.
+        std::list<std::uint64_t> lru;
+        std::size_t bytes = 0;
+    };
+
+    [[nodiscard]] Shard &shardFor(const Key &key);
+    void insertLocked(Shard &shard, const Key &key, const Policy &policy, Value value);
+    void eraseLocked(Shard &shard, std::unordered_map<std::uint64_t, Entry>::iterator it);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::size_t shardBudgetBytes_ = 0;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> staleHits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> coalesced_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+    std::atomic<std::uint64_t> refreshFailures_{0};
+};
+
+}  // namespace hydra
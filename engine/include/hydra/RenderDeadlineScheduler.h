@@ -0,0 +1,72 @@
+#pragma once
+
+#include <v8.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+// One process-wide thread that enforces render deadlines for every isolate.
+// Each runtime owns a slot holding at most one armed deadline (a runtime
+// renders one request at a time), so arming and cancelling are single atomic
+// operations; the scheduler only takes its lock when a new deadline is
+// earlier than the one it is currently sleeping towards.
+class RenderDeadlineScheduler {
+  public:
+    class Slot {
+      public:
+        explicit Slot(v8::Isolate *isolate) : isolate_(isolate) {}
+
+      private:
+        friend class RenderDeadlineScheduler;
+
+        v8::Isolate *isolate_ = nullptr;
+        // Steady-clock deadline in ns, or one of the k* states below.
+        std::atomic<std::int64_t> deadlineNs_{0};
+    };
+
+    [[nodiscard]] static RenderDeadlineScheduler &instance();
+
+    RenderDeadlineScheduler(const RenderDeadlineScheduler &) = delete;
+    RenderDeadlineScheduler &operator=(const RenderDeadlineScheduler &) = delete;
+
+    [[nodiscard]] std::shared_ptr<Slot> registerIsolate(v8::Isolate *isolate);
+    // After this returns the scheduler never touches the slot's isolate again.
+    void unregisterIsolate(const std::shared_ptr<Slot> &slot);
+
+    void arm(Slot &slot, std::uint64_t timeoutMs);
+    // Disarms the slot. Returns true when the deadline already fired, i.e.
+    // TerminateExecution was requested on the slot's isolate.
+    [[nodiscard]] bool cancel(Slot &slot);
+
+    [[nodiscard]] std::uint64_t firedCount() const;
+    [[nodiscard]] std::size_t registeredCount() const;
+
+  private:
+    static constexpr std::int64_t kIdle = 0;
+    static constexpr std::int64_t kFiring = -1;
+    static constexpr std::int64_t kFired = -2;
+
+    RenderDeadlineScheduler();
+    ~RenderDeadlineScheduler();
+
+    void run();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::shared_ptr<Slot>> slots_;
+    bool stopping_ = false;
+    // Deadline the scheduler thread is sleeping towards; INT64_MAX while it
+    // is idle or rescanning, so any arm in that window wakes it.
+    std::atomic<std::int64_t> nextWakeNs_;
+    std::atomic<std::uint64_t> firedCount_{0};
+    std::thread thread_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+// Inline, truncating text field so events can be written into the ring
+// without heap allocation.
+template <std::size_t Capacity>
+class FixedText {
+  public:
+    void assign(std::string_view value) {
+        size_ = value.size() < Capacity ? value.size() : Capacity;
+        value.copy(data_.data(), size_);
+        truncated_ = size_ < value.size();
+    }
+
+    [[nodiscard]] std::string_view view() const {
+        return {data_.data(), size_};
+    }
+
+    [[nodiscard]] bool truncated() const {
+        return truncated_;
+    }
+
+  private:
+    std::array<char, Capacity> data_{};
+    std::size_t size_ = 0;
+    bool truncated_ = false;
+};
+
+// One finished SSR request, as recorded on the request path.
+struct RenderEvent {
+    bool failed = false;
+    bool streamed = false;
+    int httpStatus = 0;
+    std::uint64_t renderIndex = 0;
+    std::uint64_t acquireUs = 0;
+    std::uint64_t renderUs = 0;
+    std::uint64_t wrapUs = 0;
+    std::uint64_t totalUs = 0;
+    std::uint64_t streamedBytes = 0;
+    // API bridge calls made by the render (memoized ones included), and
+    // time spent blocked on async ones.
+    std::uint32_t bridgeCalls = 0;
+    std::uint32_t bridgeMemoized = 0;
+    std::uint64_t bridgeWaitUs = 0;
+    // Static string (cache outcome) or nullptr.
+    const char *cache = nullptr;
+    FixedText<16> method;
+    FixedText<256> route;
+    FixedText<64> requestId;
+    FixedText<64> pageId;
+    FixedText<256> error;
+};
+
+// Asynchronous, sampled sink for RenderEvents. Each producing thread owns a
+// single-producer ring, so record() is a few relaxed/release stores and
+// never blocks; a full ring drops the event and counts it. A background
+// thread drains every ring and hands events to the formatter.
+class RenderEventLog {
+  public:
+    using Sink = std::function<void(const RenderEvent &)>;
+
+    struct Options {
+        // Rounded up to a power of two.
+        std::size_t ringCapacity = 512;
+        // Fraction of successful, fast requests that are logged.
+        double sampleRate = 1.0;
+        // Requests at or above this total latency are always logged; 0 = off.
+        std::uint64_t slowThresholdUs = 0;
+        bool alwaysLogFailures = true;
+        std::chrono::milliseconds flushInterval{50};
+    };
+
+    RenderEventLog(Options options, Sink sink);
+    ~RenderEventLog();
+
+    RenderEventLog(const RenderEventLog &) = delete;
+    RenderEventLog &operator=(const RenderEventLog &) = delete;
+
+    // Sampling decision, made before the event is filled in.
+    [[nodiscard]] bool shouldRecord(bool failed, std::uint64_t totalUs);
+
+    // Returns false when the calling thread's ring is full and the event
+    // was dropped.
+    bool record(const RenderEvent &event);
+
+    // Drains everything recorded so far on the calling thread.
+    void flush();
+
+    [[nodiscard]] std::uint64_t recordedCount() const;
+    [[nodiscard]] std::uint64_t droppedCount() const;
+    [[nodiscard]] std::uint64_t sampledOutCount() const;
+
+  private:
+    struct Ring {
+        explicit Ring(std::size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+        std::vector<RenderEvent> slots;
+        std::size_t mask;
+        // Written by the owning thread only; tail doubles as its record count.
+        alignas(64) std::atomic<std::size_t> tail{0};
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t> sampledOut{0};
+        std::uint64_t rng = 0;
+        // Written by the drainer only.
+        alignas(64) std::atomic<std::size_t> head{0};
+    };
+
+    [[nodiscard]] Ring &localRing();
+    bool drainOnce();
+    void run();
+
+    Options options_;
+    Sink sink_;
+    std::uint64_t id_ = 0;
+    std::size_t ringCapacity_ = 0;
+    std::uint64_t sampleThreshold_ = 0;
+
+    mutable std::mutex ringsMutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    // Serializes draining between the background thread and flush().
+    std::mutex drainMutex_;
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+// Fixed set of worker threads that run SSR work off the Drogon IO loops.
+// Workers are the only threads that block on V8IsolatePool::acquire and run
+// V8 renders; IO threads only enqueue tasks.
+class RenderExecutor {
+  public:
+    using Task = std::function<void()>;
+
+    // `maxQueueDepth` bounds the tasks waiting for a worker; 0 = unbounded.
+    explicit RenderExecutor(std::size_t threadCount,
+                            std::string name = "hydra-render",
+                            std::size_t maxQueueDepth = 0);
+    ~RenderExecutor();
+
+    RenderExecutor(const RenderExecutor &) = delete;
+    RenderExecutor &operator=(const RenderExecutor &) = delete;
+
+    // Enqueues a task. Throws std::runtime_error once shutdown() has started
+    // or when maxQueueDepth tasks are already waiting, so a burst fails fast
+    // instead of piling up behind the workers.
+    void post(Task task);
+
+    // Stops accepting work, drains already-queued tasks, and joins workers.
+    void shutdown();
+
+    [[nodiscard]] std::size_t threadCount() const;
+    [[nodiscard]] std::size_t queueDepth() const;
+    [[nodiscard]] std::size_t maxQueueDepth() const;
+    // Tasks refused because the queue was full.
+    [[nodiscard]] std::uint64_t rejectedCount() const;
+    [[nodiscard]] std::size_t activeCount() const;
+    [[nodiscard]] std::uint64_t completedCount() const;
+
+  private:
+    void workerLoop();
+
+    std::string name_;
+    std::size_t maxQueueDepth_ = 0;
+    std::vector<std::thread> workers_;
+    std::deque<Task> tasks_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::atomic<std::size_t> activeCount_{0};
+    std::atomic<std::uint64_t> completedCount_{0};
+    std::atomic<std::uint64_t> rejectedCount_{0};
+};
+
+}  // namespace hydra
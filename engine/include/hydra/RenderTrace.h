@@ -0,0 +1,182 @@
+#pragma once
+
+#include <json/value.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+// Phase spans for one sampled request. Unsampled requests carry no trace at
+// all, so every instrumentation point is a null check. Spans are appended
+// by whichever thread is running the request at the time (event loop,
+// render thread, API bridge), one at a time; the mutex only makes that
+// hand-off safe, it is never contended.
+class RenderTrace {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Span {
+        // "serialize", "request_context", "props", "acquire", "render",
+        // "parse", "bridge", "wrap", "stream" or "response".
+        const char *name = "";
+        // Bridge path, for example.
+        std::string detail;
+        Clock::time_point start;
+        Clock::time_point end;
+        bool error = false;
+        std::array<std::uint8_t, 8> spanId{};
+    };
+
+    struct TraceContext {
+        std::array<std::uint8_t, 16> traceId{};
+        std::array<std::uint8_t, 8> parentSpanId{};
+        bool sampled = false;
+    };
+
+    // Parses a W3C `traceparent` header; nullopt when malformed.
+    [[nodiscard]] static std::optional<TraceContext> parseTraceparent(std::string_view header);
+
+    // Starts a root span now. Without a parent a new trace id is generated.
+    RenderTrace(std::string requestId, const std::optional<TraceContext> &parent);
+
+    RenderTrace(const RenderTrace &) = delete;
+    RenderTrace &operator=(const RenderTrace &) = delete;
+
+    void addSpan(const char *name,
+                 Clock::time_point start,
+                 Clock::time_point end,
+                 std::string detail = {},
+                 bool error = false);
+    void setRoute(std::string routeUrl, std::string pageId);
+    // Ends the root span; later calls are ignored.
+    void finish(int httpStatus, bool failed);
+
+    // `Server-Timing` value: one entry per span plus `total`, durations in ms.
+    [[nodiscard]] std::string serverTiming() const;
+    // `traceparent` for this trace's root span, for propagation and logs.
+    [[nodiscard]] std::string traceparent() const;
+    [[nodiscard]] std::string traceIdHex() const;
+    [[nodiscard]] const std::string &requestId() const;
+
+    // Appends this trace's spans, root first, as OTLP/JSON span objects.
+    void appendOtlpSpans(Json::Value *spans) const;
+
+    // The trace the current thread is rendering for, so V8 host callbacks
+    // such as the fetch bridge can attach spans without plumbing.
+    class Activation {
+      public:
+        explicit Activation(RenderTrace *trace);
+        ~Activation();
+
+        Activation(const Activation &) = delete;
+        Activation &operator=(const Activation &) = delete;
+
+      private:
+        RenderTrace *previous_ = nullptr;
+    };
+
+    [[nodiscard]] static RenderTrace *active();
+
+    // Records one span from construction to end() or destruction; a span
+    // cut short by an exception is marked as an error. Does nothing when
+    // `trace` is null.
+    class Scope {
+      public:
+        Scope(RenderTrace *trace, const char *name, std::string detail = {});
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        void end(bool error = false);
+
+      private:
+        RenderTrace *trace_ = nullptr;
+        const char *name_ = "";
+        std::string detail_;
+        Clock::time_point start_;
+        int uncaughtExceptions_ = 0;
+    };
+
+  private:
+    std::string requestId_;
+    std::array<std::uint8_t, 16> traceId_{};
+    std::array<std::uint8_t, 8> rootSpanId_{};
+    std::array<std::uint8_t, 8> parentSpanId_{};
+    bool hasParent_ = false;
+    Clock::time_point start_;
+    std::chrono::system_clock::time_point wallStart_;
+
+    mutable std::mutex mutex_;
+    Clock::time_point end_;
+    bool finished_ = false;
+    int httpStatus_ = 0;
+    bool failed_ = false;
+    std::string routeUrl_;
+    std::string pageId_;
+    std::vector<Span> spans_;
+};
+
+// Batches finished traces and hands them to `sink` as OTLP/HTTP JSON
+// (ExportTraceServiceRequest) from a background thread. submit() never
+// blocks on the sink; past maxQueuedTraces new traces are dropped and
+// counted.
+class TraceExporter {
+  public:
+    using Sink = std::function<void(std::string otlpJson)>;
+
+    struct Options {
+        std::string serviceName = "hydrastack";
+        std::size_t maxQueuedTraces = 2048;
+        std::size_t maxBatchTraces = 256;
+        std::chrono::milliseconds flushInterval{1000};
+    };
+
+    TraceExporter(Options options, Sink sink);
+    // Flushes what is queued before returning.
+    ~TraceExporter();
+
+    TraceExporter(const TraceExporter &) = delete;
+    TraceExporter &operator=(const TraceExporter &) = delete;
+
+    bool submit(std::shared_ptr<const RenderTrace> trace);
+    void flush();
+
+    [[nodiscard]] std::uint64_t exportedCount() const;
+    [[nodiscard]] std::uint64_t droppedCount() const;
+
+    [[nodiscard]] static std::string encode(
+        const std::string &serviceName,
+        const std::vector<std::shared_ptr<const RenderTrace>> &traces);
+
+  private:
+    void run();
+    bool drainOnce();
+
+    Options options_;
+    Sink sink_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::shared_ptr<const RenderTrace>> queue_;
+    bool stopping_ = false;
+    // Serializes drains between the background thread and flush().
+    std::mutex drainMutex_;
+    std::atomic<std::uint64_t> exported_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::thread thread_;
+};
+
+}  // namespace hydra
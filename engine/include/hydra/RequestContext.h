@@ -0,0 +1,171 @@
+#pragma once
+
+#include <drogon/HttpRequest.h>
+#include <json/value.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+
+// The i18n, theme and request_context settings that shape the
+// `__hydra_request` object handed to the bundle on every render.
+struct RequestContextOptions {
+    std::string defaultLocale = "en";
+    std::string localeQueryParam = "lang";
+    std::string localeCookieName = "hydra_lang";
+    bool includeLocaleCandidates = false;
+    std::unordered_set<std::string> supportedLocales;
+    std::vector<std::string> supportedLocaleOrder;
+    std::string defaultTheme = "ocean";
+    std::string themeQueryParam = "theme";
+    std::string themeCookieName = "hydra_theme";
+    bool includeThemeCandidates = false;
+    std::unordered_set<std::string> supportedThemes;
+    std::vector<std::string> supportedThemeOrder;
+    bool includeCookies = false;
+    bool includeCookieMap = false;
+    // Lowercased names.
+    std::unordered_set<std::string> allowedCookies;
+    std::unordered_set<std::string> headerAllowlist;
+    std::unordered_set<std::string> headerBlocklist = {
+        "authorization",
+        "proxy-authorization",
+        "cookie",
+        "set-cookie",
+        "x-api-key",
+    };
+    // Accept-Language values whose locale candidates are memoized; 0
+    // disables the cache.
+    std::size_t localeCacheEntries = 1024;
+    // Leave headers, cookies and cookieMap out of the context; the bundle
+    // reads them on demand through __hydraRequestDetail, during SSR only.
+    bool lazyDetails = false;
+};
+
+// Builds `__hydra_request` objects for one set of options. The header
+// filter is merged into a single lookup up front, and Accept-Language
+// values are resolved to locale candidates once and shared by all render
+// threads through a bounded, sharded cache. Thread-safe.
+class RequestContextBuilder {
+  public:
+    explicit RequestContextBuilder(RequestContextOptions options);
+
+    RequestContextBuilder(const RequestContextBuilder &) = delete;
+    RequestContextBuilder &operator=(const RequestContextBuilder &) = delete;
+
+    // Resolves locale and theme and copies the permitted headers and
+    // cookies, or lists them under `lazyFields` when lazyDetails is set. A
+    // null `req` yields the defaults only.
+    [[nodiscard]] Json::Value build(const drogon::HttpRequestPtr &req,
+                                    const std::string &routeUrl,
+                                    const std::string &requestId) const;
+
+    // Compact JSON for one lazy field ("headers", "cookies" or
+    // "cookieMap") of `req`; nullopt for any other name.
+    [[nodiscard]] std::optional<std::string> detailJson(const drogon::HttpRequestPtr &req,
+                                                        std::string_view name) const;
+
+    [[nodiscard]] const RequestContextOptions &options() const;
+
+    struct LocaleCacheStats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t entries = 0;
+    };
+    [[nodiscard]] LocaleCacheStats localeCacheStats() const;
+
+    // The request the current thread is rendering, so the V8 host callback
+    // can answer lazy field reads without plumbing.
+    class Activation {
+      public:
+        Activation(const RequestContextBuilder *builder, const drogon::HttpRequestPtr &req);
+        ~Activation();
+
+        Activation(const Activation &) = delete;
+        Activation &operator=(const Activation &) = delete;
+
+      private:
+        const RequestContextBuilder *previousBuilder_ = nullptr;
+        const drogon::HttpRequestPtr *previousRequest_ = nullptr;
+    };
+
+    // detailJson() for the active request; nullopt outside an Activation.
+    [[nodiscard]] static std::optional<std::string> activeDetailJson(std::string_view name);
+
+  private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view value) const {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+    using NameSet = std::unordered_set<std::string, StringHash, std::equal_to<>>;
+
+    // Normalized candidates (with fallbacks) for an Accept-Language value
+    // followed by the default locale, and the locale they resolve to.
+    struct LocaleResolution {
+        std::vector<std::string> candidates;
+        std::string locale;
+    };
+    using LocaleResolutionPtr = std::shared_ptr<const LocaleResolution>;
+
+    struct LocaleShard {
+        std::mutex mutex;
+        std::unordered_map<std::string, LocaleResolutionPtr> entries;
+    };
+
+    [[nodiscard]] LocaleResolutionPtr resolveAcceptLanguage(const std::string &header) const;
+    [[nodiscard]] LocaleResolutionPtr computeAcceptLanguage(const std::string &header) const;
+    [[nodiscard]] std::string resolveLocale(const std::vector<std::string> &candidates) const;
+    [[nodiscard]] bool includeHeader(std::string_view lowercaseName) const;
+    [[nodiscard]] Json::Value headersValue(const drogon::HttpRequest &req) const;
+    // Fills whichever of `cookieHeader` and `cookieMap` is non-null.
+    void collectCookies(const drogon::HttpRequest &req,
+                        std::string *cookieHeader,
+                        Json::Value *cookieMap) const;
+
+    RequestContextOptions options_;
+    // Always-excluded names merged with headerBlocklist.
+    NameSet excludedHeaders_;
+    // headerAllowlist minus everything excluded; unused when the allowlist
+    // is empty.
+    NameSet allowedHeaders_;
+    std::size_t localeShardCapacity_ = 0;
+    std::unique_ptr<LocaleShard[]> localeShards_;
+    mutable std::atomic<std::uint64_t> localeCacheHits_{0};
+    mutable std::atomic<std::uint64_t> localeCacheMisses_{0};
+};
+
+namespace request_context {
+
+// Trimmed text before the first comma, for proxy headers that may repeat.
+[[nodiscard]] std::string firstHeaderToken(const std::string &value);
+// Keeps [A-Za-z0-9._-], at most 64 characters; empty when nothing is left.
+[[nodiscard]] std::string sanitizeRequestId(std::string value);
+// 24 random base64 characters for the CSP script nonce.
+[[nodiscard]] std::string generateScriptNonce();
+
+// "EN_us " -> "en-us"; empty when nothing usable remains.
+[[nodiscard]] std::string normalizeLocaleTag(std::string locale);
+// Lowercased, keeping [a-z0-9_-].
+[[nodiscard]] std::string normalizeThemeTag(std::string theme);
+// "zh-hant-tw" -> {"zh-hant-tw", "zh-hant", "zh"}.
+[[nodiscard]] std::vector<std::string> localeFallbackChain(const std::string &normalizedLocale);
+// Language ranges ordered by q-value (stable for ties), without `*` and
+// q=0 entries. Tags are returned as sent, not normalized.
+[[nodiscard]] std::vector<std::string> parseAcceptLanguageCandidates(
+    const std::string &headerValue);
+
+}  // namespace request_context
+}  // namespace hydra
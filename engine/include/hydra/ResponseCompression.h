@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hydra {
+
+enum class ContentEncoding : std::uint8_t {
+    kIdentity,
+    kGzip,
+    kBrotli,
+};
+
+// Content-Encoding token; empty for identity.
+[[nodiscard]] std::string_view contentEncodingToken(ContentEncoding encoding);
+
+// Whether this build links a brotli encoder.
+[[nodiscard]] bool brotliSupported();
+
+// Picks the coding to answer an Accept-Encoding header with: brotli over
+// gzip at equal q, a q=0 coding is never chosen, and `*` stands in for codings
+// the header does not name. identity when nothing allowed is acceptable.
+[[nodiscard]] ContentEncoding negotiateContentEncoding(std::string_view acceptEncoding,
+                                                       bool allowGzip,
+                                                       bool allowBrotli);
+
+// Compresses a whole body; `level` is the zlib level (1-9) for gzip and the
+// quality (0-11) for brotli. Throws std::runtime_error if the codec fails.
+[[nodiscard]] std::string compressBody(std::string_view body, ContentEncoding encoding, int level);
+
+// Raw deflate data for one piece of a gzip body, compressed on its own and
+// ended on a byte boundary so it never refers back to the bytes before it.
+// Pieces shared by many responses can be compressed once and joined with
+// per-response ones by gzipFromBlocks().
+struct DeflateBlock {
+    std::string data;
+    std::uint32_t crc = 0;
+    std::size_t size = 0;
+};
+
+[[nodiscard]] DeflateBlock deflateBlock(std::string_view text, int level);
+
+// A complete gzip member whose payload is the blocks' text in order.
+[[nodiscard]] std::string gzipFromBlocks(const std::vector<const DeflateBlock *> &blocks);
+
+}  // namespace hydra
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "hydra/RenderCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace drogon::nosql {
+class RedisClient;
+class RedisSubscriber;
+}  // namespace drogon::nosql
+
+namespace hydra {
+
+// Second render cache tier kept in Redis through one of Drogon's Redis
+// clients and shared by every node using the same key prefix. A local
+// RenderCache miss asks it before rendering and finished renders are
+// written back asynchronously. A lookup waits at most `timeout` for the
+// reply, and after repeated timeouts or errors lookups are skipped for a
+// while, so a slow or unreachable Redis costs a bounded wait on a local
+// miss and never fails a render.
+//
+// Entries are keyed by the build (SSR bundle, manifest and shell) and the
+// RenderCache key, which folds in the page's tag version: invalidate()
+// bumps a pageId's version in Redis and announces it on a pub/sub channel,
+// and every node's keys for that page change with it.
+class SharedRenderCache : public std::enable_shared_from_this<SharedRenderCache> {
+  public:
+    struct Options {
+        // Name of the client in Drogon's redis_clients config.
+        std::string redisClient = "default";
+        std::string keyPrefix = "hydra";
+        std::chrono::milliseconds timeout{5};
+        // Larger encoded values are not written.
+        std::size_t maxEntryBytes = 1024 * 1024;
+        // Whether precompressed gzip blocks are shared along with the page.
+        bool gzip = true;
+        // How often all tag versions are re-read, covering invalidation
+        // messages missed while disconnected; 0 disables it.
+        std::chrono::milliseconds tagRefreshInterval{5000};
+    };
+
+    struct Stats {
+        bool ready = false;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        // Found, but older than the reader's TTL.
+        std::uint64_t expired = 0;
+        std::uint64_t timeouts = 0;
+        std::uint64_t errors = 0;
+        // Lookups skipped while not ready or backing off.
+        std::uint64_t bypassed = 0;
+        std::uint64_t writes = 0;
+        std::uint64_t writeErrors = 0;
+        std::uint64_t oversized = 0;
+        std::uint64_t invalidations = 0;
+        std::uint64_t invalidationFailures = 0;
+        std::size_t tags = 0;
+    };
+
+    explicit SharedRenderCache(Options options);
+    ~SharedRenderCache();
+
+    SharedRenderCache(const SharedRenderCache &) = delete;
+    SharedRenderCache &operator=(const SharedRenderCache &) = delete;
+
+    // Resolves the Redis client, subscribes to invalidations and loads the
+    // tag versions; lookups and writes wait for that first load. Call on
+    // Drogon's main loop once the app runs (Redis clients are created at
+    // startup). Logs and stays disabled when the client is not configured.
+    void start();
+    void stop();
+
+    [[nodiscard]] bool ready() const;
+
+    // Current invalidation version of `tag` (a pageId); 0 until it is first
+    // invalidated.
+    [[nodiscard]] std::uint64_t tagVersion(std::string_view tag) const;
+
+    // The entry for `key` under `buildId`, or null on a miss, a timeout, an
+    // error or an entry older than `ttl`. The value's inheritedAge is its
+    // age in the tier. Blocks for at most Options::timeout.
+    [[nodiscard]] std::shared_ptr<CachedRender> lookup(std::string_view buildId,
+                                                       const RenderCache::Key &key,
+                                                       std::chrono::milliseconds ttl);
+    // Writes `value` with a Redis expiry of `ttl`; does not wait for the
+    // reply.
+    void store(std::string_view buildId,
+               const RenderCache::Key &key,
+               std::chrono::milliseconds ttl,
+               const CachedRender &value);
+
+    // Bumps the version of `tag` in Redis and tells every node. The local
+    // version follows once Redis replies.
+    void invalidate(const std::string &tag);
+
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using RedisClientPtr = std::shared_ptr<drogon::nosql::RedisClient>;
+
+    [[nodiscard]] RedisClientPtr client() const;
+    [[nodiscard]] std::string entryKey(std::string_view buildId,
+                                       const RenderCache::Key &key) const;
+    // Whether lookups and writes should go to Redis right now.
+    [[nodiscard]] bool available();
+    void noteFailure();
+    void refreshTags();
+    void applyTagVersion(const std::string &tag, std::uint64_t version);
+
+    Options options_;
+    std::string tagsKey_;
+    std::string channel_;
+
+    mutable std::mutex clientMutex_;
+    RedisClientPtr client_;
+    std::shared_ptr<drogon::nosql::RedisSubscriber> subscriber_;
+    std::uint64_t refreshTimer_ = 0;
+    bool timerRunning_ = false;
+
+    std::atomic<bool> tagsLoaded_{false};
+    mutable std::shared_mutex tagMutex_;
+    std::unordered_map<std::string, std::uint64_t> tagVersions_;
+
+    std::atomic<std::uint32_t> consecutiveFailures_{0};
+    std::atomic<std::int64_t> backoffUntilUs_{0};
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> expired_{0};
+    std::atomic<std::uint64_t> timeouts_{0};
+    std::atomic<std::uint64_t> errors_{0};
+    std::atomic<std::uint64_t> bypassed_{0};
+    std::atomic<std::uint64_t> writes_{0};
+    std::atomic<std::uint64_t> writeErrors_{0};
+    std::atomic<std::uint64_t> oversized_{0};
+    std::atomic<std::uint64_t> invalidations_{0};
+    std::atomic<std::uint64_t> invalidationFailures_{0};
+};
+
+}  // namespace hydra
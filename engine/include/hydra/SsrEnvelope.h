@@ -0,0 +1,39 @@
+#pragma once
+
+#include "hydra/SsrRenderResult.h"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+
+// Envelope members as read from the bundle's return value, before the
+// shared status, meta and redirect rules are applied. Filled either from
+// JSON text or directly from a V8 object.
+struct SsrEnvelopeFields {
+    std::string html;
+    // Absent or non-numeric leaves 200.
+    std::optional<double> status;
+    // Values already rendered as text; other value types are dropped.
+    std::vector<std::pair<std::string, std::string>> headers;
+    // String-valued meta members only.
+    std::unordered_map<std::string, std::string> meta;
+    std::optional<std::string> redirect;
+    // Compact JSON of an object-valued `props` member; empty when absent.
+    std::string props;
+};
+
+// Applies the envelope rules: out-of-range statuses become 200, meta values
+// are trimmed (camelCase keys win over snake_case), and a `redirect` or
+// Location header forces a 3xx.
+[[nodiscard]] SsrRenderResult finishSsrEnvelope(SsrEnvelopeFields fields);
+
+// Reads the `{ html, status, headers, meta, redirect, props }` object a bundle may
+// return instead of bare HTML. nullopt when `renderOutput` is not a JSON
+// object with an `html` member, in which case it is the HTML itself.
+[[nodiscard]] std::optional<SsrRenderResult> tryParseSsrEnvelope(const std::string &renderOutput);
+
+}  // namespace hydra
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+namespace hydra {
+
+struct SsrRenderResult {
+    std::string html;
+    int status = 200;
+    std::unordered_map<std::string, std::string> headers;
+    std::string title;
+    std::string description;
+    std::string canonicalUrl;
+    std::string robots;
+    std::string ogType;
+    std::string imageUrl;
+    std::string siteName;
+    std::string twitterCard;
+    // The envelope's `props` object as compact JSON: the props delta a
+    // renderFragment() bundle entry sends with the subtree it rendered.
+    std::string propsJson;
+};
+
+}  // namespace hydra
@@ -2,17 +2,66 @@
 
 #include "hydra/V8SsrRuntime.h"
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace hydra {
 
+// Sizing for an elastic pool. minSize runtimes are built up front; the pool
+// grows towards maxSize in the background when acquirers queue up or wait
+// too long, and tears down runtimes idle for longer than idleTtl.
+//
+// All runtime construction after startup happens on the pool's builder
+// thread. It keeps standbyCount spare runtimes ready so a runtime that
+// failed a render can be swapped out without waiting for bundle compile.
+//
+// Leasing itself is lock-free: each slot carries an atomic state and a lease
+// is a compare-and-swap on it. With threadAffinity every acquiring thread
+// pins the first runtime it gets and tries that slot first, so an event loop
+// keeps rendering on a runtime whose caches it already warmed; when the
+// pinned runtime is busy the thread steals any idle slot. The pool mutex
+// is only taken when nothing is idle and the caller has to wait.
+struct V8IsolatePoolOptions {
+    std::size_t minSize = 1;
+    // 0 = fixed at minSize.
+    std::size_t maxSize = 0;
+    // Grow when this many acquirers are waiting at once.
+    std::size_t growQueueDepth = 1;
+    // Grow when an acquirer has waited this long.
+    std::chrono::milliseconds growWait{5};
+    std::chrono::milliseconds idleTtl{60000};
+    // Pre-built runtimes held outside the pool for recycle swaps and growth.
+    std::size_t standbyCount = 1;
+    // Full GC for runtimes idle this long after rendering, run by the
+    // builder thread between leases.
+    bool idleGc = true;
+    std::chrono::milliseconds idleGcDelay{1000};
+    // Reaper tick and back-off after a failed build.
+    std::chrono::milliseconds scaleInterval{1000};
+    // false = every acquire scans from slot 0, which keeps load on the
+    // lowest slots and leaves the rest idle for reaping.
+    bool threadAffinity = true;
+    // Run on every new runtime before it takes leases: the initial set,
+    // growth, standby and rebuilds. Renders made here do not count towards
+    // the runtime's recycle policy. An exception ends that runtime's
+    // warm-up early; the runtime is still used.
+    std::function<void(V8SsrRuntime &)> warmup;
+    // Warm the initial runtimes on background threads instead of in the
+    // constructor. Each stays parked until it is warm; warm() reports when
+    // all of them are.
+    bool warmupInBackground = false;
+};
+
 class V8IsolatePool {
   public:
     using FetchBridge = V8SsrRuntime::FetchBridge;
@@ -20,7 +69,7 @@ class V8IsolatePool {
     class Lease {
       public:
         Lease() = default;
-        Lease(V8IsolatePool *pool, std::size_t runtimeIndex);
+        Lease(V8IsolatePool *pool, std::size_t runtimeIndex, V8SsrRuntime *runtime);
         ~Lease();
 
         Lease(const Lease &) = delete;
@@ -38,33 +87,204 @@ class V8IsolatePool {
 
         V8IsolatePool *pool_ = nullptr;
         std::size_t runtimeIndex_ = 0;
+        V8SsrRuntime *runtime_ = nullptr;
         bool recycle_ = false;
     };
 
+    struct ScalingEvent {
+        std::chrono::system_clock::time_point at;
+        // "grow", "grow_failed" or "reap".
+        const char *action = "";
+        // "queue_depth", "acquire_wait" or "idle_ttl".
+        const char *reason = "";
+        std::size_t sizeAfter = 0;
+    };
+
+    struct RecycleCounts {
+        // Lease marked for recycle after a render error or timeout.
+        std::uint64_t renderFailure = 0;
+        std::uint64_t renderCount = 0;
+        std::uint64_t heapGrowth = 0;
+        std::uint64_t heapLimit = 0;
+    };
+
+    struct LeaseCounts {
+        // Served by the calling thread's pinned runtime.
+        std::uint64_t affine = 0;
+        // Pinned runtime busy (or none yet): took another idle slot.
+        std::uint64_t stolen = 0;
+        // Nothing idle: blocked on the slow path first.
+        std::uint64_t waited = 0;
+    };
+
+    struct ScalingStats {
+        std::size_t minSize = 0;
+        std::size_t maxSize = 0;
+        std::size_t size = 0;
+        std::size_t available = 0;
+        std::size_t waiters = 0;
+        std::uint64_t grows = 0;
+        std::uint64_t growFailures = 0;
+        std::uint64_t reaps = 0;
+        std::size_t standbyTarget = 0;
+        std::size_t standby = 0;
+        // Recycled runtimes still waiting for a replacement to be built.
+        std::size_t pendingRebuilds = 0;
+        // Recycles served from a standby runtime.
+        std::uint64_t standbySwaps = 0;
+        // Runtimes built by the builder thread: recycle replacements, standby
+        // refills and growth.
+        std::uint64_t rebuilds = 0;
+        std::uint64_t rebuildFailures = 0;
+        std::uint64_t rebuildUsTotal = 0;
+        std::uint64_t rebuildUsMax = 0;
+        RecycleCounts recycles;
+        LeaseCounts leases;
+        std::uint64_t idleGcRuns = 0;
+        std::uint64_t idleGcUsTotal = 0;
+        bool warm = true;
+        // Runtimes warmed, and those whose warmup hook threw. Rebuild
+        // latency includes warm-up.
+        std::uint64_t warmups = 0;
+        std::uint64_t warmupFailures = 0;
+        std::uint64_t warmupUsTotal = 0;
+        std::uint64_t warmupUsMax = 0;
+        // Oldest first.
+        std::vector<ScalingEvent> recentEvents;
+    };
+
+    struct RuntimeStats {
+        std::size_t slot = 0;
+        bool inUse = false;
+        V8SsrRuntime::HeapSample heap;
+        std::uint64_t renders = 0;
+    };
+
+    // Fixed-size pool.
     V8IsolatePool(std::size_t size,
                   std::string bundlePath,
                   std::uint64_t renderTimeoutMs,
-                  FetchBridge fetchBridge = {});
+                  FetchBridge fetchBridge = {},
+                  V8RuntimeOptions runtimeOptions = {});
+    V8IsolatePool(V8IsolatePoolOptions options,
+                  std::string bundlePath,
+                  std::uint64_t renderTimeoutMs,
+                  FetchBridge fetchBridge = {},
+                  V8RuntimeOptions runtimeOptions = {});
+    ~V8IsolatePool();
+
+    V8IsolatePool(const V8IsolatePool &) = delete;
+    V8IsolatePool &operator=(const V8IsolatePool &) = delete;
 
     [[nodiscard]] Lease acquire(std::uint64_t acquireTimeoutMs = 0);
     [[nodiscard]] std::uint64_t renderTimeoutMs() const;
+    // size(), availableCount() and inUseCount() read atomics only and never
+    // contend with leasing.
     [[nodiscard]] std::size_t size() const;
     [[nodiscard]] std::size_t availableCount() const;
     [[nodiscard]] std::size_t inUseCount() const;
+    // Whether every initial runtime has finished warm-up; true from the
+    // start without a warmup hook.
+    [[nodiscard]] bool warm() const;
+    [[nodiscard]] ScalingStats scalingStats() const;
+    // Cached heap telemetry for every live runtime in the pool.
+    [[nodiscard]] std::vector<RuntimeStats> runtimeStats() const;
 
   private:
     friend class Lease;
 
+    using Clock = std::chrono::steady_clock;
+
+    enum class SlotState : std::uint8_t {
+        kEmpty,
+        kIdle,
+        kLeased,
+        // Held by the pool: waiting for a rebuild or in an idle GC.
+        kParked,
+    };
+
+    // One cache line per slot so a thread hitting its pinned runtime shares
+    // nothing with other threads. The runtime pointer only changes while
+    // the slot is not idle or leased, and always under mutex_.
+    struct alignas(64) Slot {
+        std::unique_ptr<V8SsrRuntime> runtime;
+        std::atomic<SlotState> state{SlotState::kEmpty};
+        std::atomic<Clock::rep> idleSince{0};
+        // Written by the slot's current holder only.
+        std::atomic<std::uint64_t> affineLeases{0};
+        std::atomic<std::uint64_t> stolenLeases{0};
+        std::atomic<std::uint64_t> waitedLeases{0};
+    };
+
+    enum class LeasePath { kFast, kWaited };
+
     void release(std::size_t runtimeIndex);
-    void recycle(std::size_t runtimeIndex) noexcept;
+    void recycle(std::size_t runtimeIndex, V8SsrRuntime::RecycleReason reason) noexcept;
+    // recycle() for a leased or parked slot with mutex_ held; returns
+    // whether the slot is idle again (swapped for a standby runtime).
+    bool recycleLocked(std::size_t runtimeIndex, V8SsrRuntime::RecycleReason reason) noexcept;
+    // Claims an idle slot or returns maxSize when none is idle.
+    [[nodiscard]] std::size_t tryClaim(LeasePath path);
+    [[nodiscard]] bool tryClaimSlot(std::size_t index);
+    void markIdle(std::size_t index);
+    void wakeWaiter();
+    [[nodiscard]] std::size_t countState(SlotState state) const;
+    [[nodiscard]] bool elastic() const;
+    void requestGrowthLocked(const char *reason);
+    void recordEventLocked(const char *action, const char *reason);
+    // Builds and warms a runtime; null when the build failed.
+    [[nodiscard]] std::unique_ptr<V8SsrRuntime> buildRuntime();
+    void warmUp(V8SsrRuntime &runtime);
+    // Warms the parked initial runtimes in parallel, marking each idle as it
+    // finishes.
+    void warmInitialRuntimes();
+    void runBuilder();
 
-    std::vector<std::unique_ptr<V8SsrRuntime>> runtimes_;
-    std::queue<std::size_t> availableRuntimes_;
+    V8IsolatePoolOptions options_;
+    // Keys the per-thread pinned slot; never reused.
+    std::uint64_t id_ = 0;
+    // Sized to maxSize up front and never reallocated.
+    std::vector<Slot> slots_;
+    std::atomic<std::size_t> liveCount_{0};
+    std::atomic<std::size_t> waiters_{0};
     std::string bundlePath_;
     FetchBridge fetchBridge_;
+    V8RuntimeOptions runtimeOptions_;
+    // Waiters, runtime swaps and builder state. A lease that finds an idle
+    // slot never takes it.
     mutable std::mutex mutex_;
     std::condition_variable cv_;
     std::uint64_t renderTimeoutMs_ = 0;
+
+    std::condition_variable builderCv_;
+    bool growRequested_ = false;
+    const char *growReason_ = "";
+    Clock::time_point buildBackoffUntil_{};
+    bool stopping_ = false;
+    std::vector<std::unique_ptr<V8SsrRuntime>> standby_;
+    // Slots whose runtime failed and has no standby replacement yet. The
+    // failed runtime stays in the slot, parked, until the rebuild lands.
+    std::deque<std::size_t> rebuildQueue_;
+    // Failed runtimes swapped out for a standby, destroyed by the builder.
+    std::vector<std::unique_ptr<V8SsrRuntime>> retired_;
+    std::uint64_t grows_ = 0;
+    std::uint64_t growFailures_ = 0;
+    std::uint64_t reaps_ = 0;
+    std::uint64_t standbySwaps_ = 0;
+    std::uint64_t rebuilds_ = 0;
+    std::uint64_t rebuildFailures_ = 0;
+    std::uint64_t rebuildUsTotal_ = 0;
+    std::uint64_t rebuildUsMax_ = 0;
+    RecycleCounts recycleCounts_;
+    std::uint64_t idleGcRuns_ = 0;
+    std::uint64_t idleGcUsTotal_ = 0;
+    std::atomic<bool> warm_{false};
+    std::uint64_t warmups_ = 0;
+    std::uint64_t warmupFailures_ = 0;
+    std::uint64_t warmupUsTotal_ = 0;
+    std::uint64_t warmupUsMax_ = 0;
+    std::deque<ScalingEvent> recentEvents_;
+    std::thread builder_;
 };
 
 }  // namespace hydra
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <v8.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace hydra {
+
+// Startup snapshot holding the bootstrap globals plus the evaluated SSR
+// bundle. Runtimes created from it skip bootstrap and bundle evaluation.
+class V8StartupSnapshot {
+  public:
+    V8StartupSnapshot(std::string data, std::string key, std::string origin);
+
+    V8StartupSnapshot(const V8StartupSnapshot &) = delete;
+    V8StartupSnapshot &operator=(const V8StartupSnapshot &) = delete;
+
+    // Loads the snapshot persisted at `cachePath` when its key matches the
+    // current bundle, otherwise builds a fresh one (and writes it back when
+    // `persist` is set). An empty `cachePath` means "<bundlePath>.snapshot".
+    // Throws std::runtime_error if the bundle cannot be snapshotted.
+    [[nodiscard]] static std::shared_ptr<const V8StartupSnapshot> loadOrCreate(
+        const std::string &bundlePath,
+        const std::string &cachePath,
+        bool persist);
+
+    // Bundle content hash, V8 version and native callback revision; any
+    // change invalidates the blob.
+    [[nodiscard]] static std::string keyForBundle(const std::string &bundleSource);
+
+    [[nodiscard]] const v8::StartupData *blob() const;
+    [[nodiscard]] const std::string &key() const;
+    [[nodiscard]] const std::string &origin() const;
+    [[nodiscard]] std::size_t sizeBytes() const;
+
+  private:
+    std::string data_;
+    std::string key_;
+    std::string origin_;
+    v8::StartupData blob_{nullptr, 0};
+};
+
+// Compiled-bundle code cache shared by every runtime of a pool. The first
+// runtime that compiles the bundle produces the cache; later runtimes (and,
+// when persisted, later processes) consume it instead of reparsing.
+class V8CodeCache {
+  public:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> data;
+    };
+
+    struct Stats {
+        std::string origin = "none";
+        std::string status = "none";
+        std::string key;
+        std::size_t bytes = 0;
+        std::uint64_t produced = 0;
+        std::uint64_t accepted = 0;
+        std::uint64_t rejected = 0;
+    };
+
+    // An empty `cachePath` means "<bundlePath>.codecache".
+    V8CodeCache(const std::string &bundlePath, std::string cachePath, bool persist);
+
+    V8CodeCache(const V8CodeCache &) = delete;
+    V8CodeCache &operator=(const V8CodeCache &) = delete;
+
+    // Returns the cached data for `bundleSource`, loading the persisted file
+    // on first use. `data` is null when nothing usable is cached yet.
+    [[nodiscard]] Entry lookup(const std::string &bundleSource);
+
+    // Replaces the cached data for `key` (and persists it when enabled).
+    void store(const std::string &key, std::string data);
+
+    // Records whether V8 accepted data handed out by lookup(). A rejected
+    // entry is dropped so the rejecting runtime can produce a fresh one.
+    void recordConsumed(const std::string &key, bool accepted);
+
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    std::string cachePath_;
+    bool persist_ = false;
+
+    mutable std::mutex mutex_;
+    std::string key_;
+    std::shared_ptr<const std::string> data_;
+    std::string origin_ = "none";
+    std::string status_ = "none";
+    bool fileChecked_ = false;
+    std::uint64_t produced_ = 0;
+    std::uint64_t accepted_ = 0;
+    std::uint64_t rejected_ = 0;
+};
+
+}  // namespace hydra
@@ -1,53 +1,254 @@
 #pragma once
 
+#include "hydra/BridgeDispatcher.h"
+#include "hydra/RenderDeadlineScheduler.h"
+#include "hydra/SsrRenderResult.h"
+
 #include <v8.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace hydra {
 
+class V8CodeCache;
+class V8StartupSnapshot;
+
+struct V8RuntimeOptions {
+    // When set, the isolate is deserialized from this blob and loadBundle()
+    // is skipped entirely.
+    std::shared_ptr<const V8StartupSnapshot> startupSnapshot;
+    // Shared compiled-bundle cache consumed (or produced) by loadBundle().
+    std::shared_ptr<V8CodeCache> codeCache;
+    // Heap cap for the isolate; 0 keeps V8's default. Reaching it terminates
+    // the current render instead of aborting the process.
+    std::size_t maxHeapBytes = 0;
+    // Recycle policy, checked when a lease is released; 0 disables a rule.
+    std::uint64_t recycleAfterRenders = 0;
+    // Live heap growth over the post-load baseline, in percent.
+    std::uint64_t recycleHeapGrowthPercent = 0;
+    // Runs hydra.fetchAsync()/fetch() calls; when null they run one after
+    // another on the render thread, still deduplicated.
+    std::shared_ptr<BridgeDispatcher> bridgeDispatcher;
+    // Answer identical (method, path, query, body) bridge calls within one
+    // render from the first call's response.
+    bool bridgeMemoize = true;
+};
+
 class V8SsrRuntime {
   public:
-    struct BridgeRequest {
-        std::string method = "GET";
-        std::string path;
-        std::string query;
-        std::string body;
-        std::unordered_map<std::string, std::string> headers;
+    using BridgeRequest = hydra::BridgeRequest;
+    using BridgeResponse = hydra::BridgeResponse;
+
+    // Last sampled heap statistics, refreshed after every render and idle GC.
+    struct HeapSample {
+        std::uint64_t usedBytes = 0;
+        std::uint64_t totalBytes = 0;
+        std::uint64_t limitBytes = 0;
+        std::uint64_t externalBytes = 0;
+        std::uint64_t mallocedBytes = 0;
     };
 
-    struct BridgeResponse {
-        int status = 200;
-        std::string body;
-        std::unordered_map<std::string, std::string> headers;
+    enum class RecycleReason {
+        kNone,
+        kRenderCount,
+        kHeapGrowth,
+        kHeapLimit,
     };
 
     using FetchBridge = std::function<BridgeResponse(const BridgeRequest &)>;
+    // Receives streamed HTML chunks; returning false aborts the render
+    // (for example when the client has gone away).
+    using ChunkSink = std::function<bool(std::string_view)>;
 
-    explicit V8SsrRuntime(std::string bundlePath, FetchBridge fetchBridge = {});
+    explicit V8SsrRuntime(std::string bundlePath,
+                          FetchBridge fetchBridge = {},
+                          V8RuntimeOptions options = {});
     ~V8SsrRuntime();
 
     V8SsrRuntime(const V8SsrRuntime &) = delete;
     V8SsrRuntime &operator=(const V8SsrRuntime &) = delete;
 
+    // Shared props buffer. Large ASCII payloads back an external V8 string
+    // instead of being copied into the heap; V8 holds a reference until the
+    // string is collected.
+    using PropsPayload = std::shared_ptr<const std::string>;
+
     [[nodiscard]] std::string render(const std::string &url,
                                      const std::string &propsJson,
                                      const std::string &requestContextJson = "{}",
                                      std::uint64_t timeoutMs = 0);
+    [[nodiscard]] std::string render(const std::string &url,
+                                     const PropsPayload &propsJson,
+                                     const std::string &requestContextJson,
+                                     std::uint64_t timeoutMs);
+
+    // What the bundle's render() or renderStream() returned. A plain
+    // `{ html, status, headers, meta, redirect }` object is read field by
+    // field into `envelope`; anything else is converted to `text`, which may
+    // still be an envelope the bundle stringified itself.
+    struct RenderOutput {
+        std::string text;
+        std::optional<SsrRenderResult> envelope;
+    };
+
+    // render() without converting an envelope object back to JSON.
+    [[nodiscard]] RenderOutput renderOutput(const std::string &url,
+                                            const PropsPayload &propsJson,
+                                            const std::string &requestContextJson,
+                                            std::uint64_t timeoutMs);
+
+    // Calls globalThis.renderFragment(url, propsJson, requestContextJson,
+    // componentId), which renders only that component's subtree; its
+    // envelope may carry a `props` delta. Throws when the bundle has no
+    // renderFragment.
+    [[nodiscard]] RenderOutput renderFragmentOutput(const std::string &url,
+                                                    const PropsPayload &propsJson,
+                                                    const std::string &requestContextJson,
+                                                    const std::string &componentId,
+                                                    std::uint64_t timeoutMs);
+
+    // render(), renderFragment() and renderStream() may return a promise. It is driven to
+    // completion here: microtasks are drained, async bridge calls are
+    // dispatched and their responses fed back, until it settles or the
+    // timeout passes.
+
+    // Calls globalThis.renderStream(url, propsJson, requestContextJson, write)
+    // and forwards every write(chunk) (string or Uint8Array) to `sink`. The
+    // function may return a promise. Returns its resolved value as a string
+    // (empty when undefined); bundles without renderStream fall back to
+    // render() and the full output is returned without touching `sink`.
+    [[nodiscard]] std::string renderStream(const std::string &url,
+                                           const std::string &propsJson,
+                                           const std::string &requestContextJson,
+                                           std::uint64_t timeoutMs,
+                                           const ChunkSink &sink);
+    [[nodiscard]] std::string renderStream(const std::string &url,
+                                           const PropsPayload &propsJson,
+                                           const std::string &requestContextJson,
+                                           std::uint64_t timeoutMs,
+                                           const ChunkSink &sink);
+    [[nodiscard]] RenderOutput renderStreamOutput(const std::string &url,
+                                                  const PropsPayload &propsJson,
+                                                  const std::string &requestContextJson,
+                                                  std::uint64_t timeoutMs,
+                                                  const ChunkSink &sink);
+
+    [[nodiscard]] bool fromSnapshot() const;
+
+    // Thread-safe reads of cached telemetry; never touch the isolate.
+    [[nodiscard]] HeapSample heapSample() const;
+    [[nodiscard]] std::uint64_t renderCount() const;
+    [[nodiscard]] bool rendersSinceGc() const;
+    [[nodiscard]] RecycleReason recycleReason() const;
+    // Bridge activity of the last render; read while holding the runtime.
+    [[nodiscard]] const BridgeRenderStats &lastBridgeStats() const;
+
+    // Full GC. Call only while holding the runtime exclusively and outside a
+    // render, e.g. from the pool between leases.
+    void collectGarbage();
+    // Ends a warm-up: collects garbage and restarts the recycle policy's
+    // render count and heap baseline from the warmed state. Same calling
+    // rules as collectGarbage().
+    void finishWarmup();
+
+    // Runs bootstrap + bundle inside a v8::SnapshotCreator and returns the
+    // serialized startup blob. Throws std::runtime_error on script failures.
+    [[nodiscard]] static std::string createStartupSnapshotBlob(const std::string &bundlePath,
+                                                               const std::string &bundleSource);
+
+    // Null-terminated list of native callbacks; must match between snapshot
+    // creation and deserialization.
+    [[nodiscard]] static const intptr_t *externalReferences();
 
   private:
+    // Completions posted by bridge workers; shared so a worker never
+    // outlives what it writes to.
+    struct AsyncBridgeState;
+
+    // One distinct bridge call of the current render. Memoized calls share
+    // the entry; `resolver` is empty for a call only made synchronously.
+    struct BridgeCall {
+        v8::Global<v8::Promise::Resolver> resolver;
+        BridgeResponse response;
+        bool settled = false;
+    };
+
+    enum class BridgeWait { kResolved, kIdle, kTimedOut };
+
     static void hydraFetchCallback(const v8::FunctionCallbackInfo<v8::Value> &info);
+    static void hydraFetchAsyncCallback(const v8::FunctionCallbackInfo<v8::Value> &info);
+    static void streamChunkCallback(const v8::FunctionCallbackInfo<v8::Value> &info);
+    static void requestDetailCallback(const v8::FunctionCallbackInfo<v8::Value> &info);
+    static std::size_t nearHeapLimitCallback(void *data,
+                                             std::size_t currentHeapLimit,
+                                             std::size_t initialHeapLimit);
+    // Requires the isolate lock.
+    void sampleHeap();
+    static void prepareContext(v8::Isolate *isolate,
+                               v8::Local<v8::Context> context,
+                               const std::string &bundlePath,
+                               const std::string &bundleSource,
+                               V8CodeCache *codeCache);
     void loadBundle();
+    [[nodiscard]] BridgeResponse callFetchBridge(const BridgeRequest &request) const;
+    // Dispatches the calls queued since the last flush.
+    void flushBridgeCalls(v8::Local<v8::Context> context);
+    // Blocks for async responses and resolves their promises. kIdle when
+    // nothing is outstanding, kTimedOut once `deadline` passes.
+    [[nodiscard]] BridgeWait awaitBridgeCalls(v8::Local<v8::Context> context,
+                                              std::chrono::steady_clock::time_point deadline);
+    void settleBridgeCall(v8::Local<v8::Context> context,
+                          std::size_t index,
+                          BridgeResponse response);
+    // Waits out calls still running on workers and forgets the render's
+    // calls, without resolving anything.
+    void resetBridgeCalls();
+    [[nodiscard]] RenderOutput invokeRender(const std::string &url,
+                                            const PropsPayload &propsJson,
+                                            const std::string &requestContextJson,
+                                            std::uint64_t timeoutMs,
+                                            const ChunkSink *sink,
+                                            const std::string *componentId,
+                                            bool readEnvelope);
 
     std::string bundlePath_;
     FetchBridge fetchBridge_;
+    V8RuntimeOptions options_;
     std::unique_ptr<v8::ArrayBuffer::Allocator> allocator_;
     v8::Isolate *isolate_ = nullptr;
     v8::Global<v8::Context> context_;
+    std::shared_ptr<RenderDeadlineScheduler::Slot> deadlineSlot_;
+    const ChunkSink *activeChunkSink_ = nullptr;
+    bool streamAborted_ = false;
+    // Per-render bridge state, isolate thread only.
+    std::vector<BridgeCall> bridgeCalls_;
+    std::unordered_map<std::string, std::size_t> bridgeMemo_;
+    std::vector<std::pair<std::size_t, BridgeRequest>> bridgeQueued_;
+    std::shared_ptr<AsyncBridgeState> bridgeState_;
+    BridgeRenderStats bridgeStats_;
+
+    std::atomic<std::uint64_t> heapUsedBytes_{0};
+    std::atomic<std::uint64_t> heapTotalBytes_{0};
+    std::atomic<std::uint64_t> heapLimitBytes_{0};
+    std::atomic<std::uint64_t> externalBytes_{0};
+    std::atomic<std::uint64_t> mallocedBytes_{0};
+    // Used heap after loading the bundle, and after the last full GC.
+    std::atomic<std::uint64_t> baselineHeapUsedBytes_{0};
+    std::atomic<std::uint64_t> postGcHeapUsedBytes_{0};
+    std::atomic<std::uint64_t> renderCount_{0};
+    std::atomic<std::uint64_t> rendersAtLastGc_{0};
+    std::atomic<bool> heapLimitReached_{false};
 };
 
 }  // namespace hydra
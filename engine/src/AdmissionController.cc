@@ -0,0 +1,175 @@
+#include "hydra/AdmissionController.h"
+
+#include <algorithm>
+#include <string>
+
+namespace hydra {
+
+const char *requestPriorityName(RequestPriority priority) {
+    switch (priority) {
+        case RequestPriority::kCritical:
+            return "critical";
+        case RequestPriority::kHigh:
+            return "high";
+        case RequestPriority::kNormal:
+            return "normal";
+        case RequestPriority::kLow:
+            return "low";
+    }
+    return "normal";
+}
+
+AdmissionRejectedError::AdmissionRejectedError(RequestPriority priority,
+                                               std::uint64_t expectedWaitUs,
+                                               bool timedOut)
+    : std::runtime_error(
+          timedOut ? std::string("SSR admission deadline missed for ") +
+                         requestPriorityName(priority) + " priority request"
+                   : std::string("SSR admission shed ") + requestPriorityName(priority) +
+                         " priority request (expected wait " +
+                         std::to_string(expectedWaitUs / 1000) + "ms)"),
+      priority_(priority),
+      expectedWaitUs_(expectedWaitUs),
+      timedOut_(timedOut) {}
+
+RequestPriority AdmissionRejectedError::priority() const {
+    return priority_;
+}
+
+std::uint64_t AdmissionRejectedError::expectedWaitUs() const {
+    return expectedWaitUs_;
+}
+
+bool AdmissionRejectedError::timedOut() const {
+    return timedOut_;
+}
+
+AdmissionController::Ticket::Ticket(AdmissionController *controller, std::uint64_t expectedWaitUs)
+    : controller_(controller), expectedWaitUs_(expectedWaitUs) {}
+
+AdmissionController::Ticket::~Ticket() {
+    release();
+}
+
+AdmissionController::Ticket::Ticket(Ticket &&other) noexcept
+    : controller_(other.controller_), expectedWaitUs_(other.expectedWaitUs_) {
+    other.controller_ = nullptr;
+    other.expectedWaitUs_ = 0;
+}
+
+AdmissionController::Ticket &AdmissionController::Ticket::operator=(Ticket &&other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    release();
+
+    controller_ = other.controller_;
+    expectedWaitUs_ = other.expectedWaitUs_;
+    other.controller_ = nullptr;
+    other.expectedWaitUs_ = 0;
+
+    return *this;
+}
+
+AdmissionController::Ticket::operator bool() const {
+    return controller_ != nullptr;
+}
+
+std::uint64_t AdmissionController::Ticket::expectedWaitUs() const {
+    return expectedWaitUs_;
+}
+
+void AdmissionController::Ticket::release() {
+    if (controller_ == nullptr) {
+        return;
+    }
+    controller_->inFlight_.fetch_sub(1, std::memory_order_relaxed);
+    controller_ = nullptr;
+}
+
+AdmissionController::AdmissionController(Options options) : options_(options) {
+    options_.policies[static_cast<std::size_t>(RequestPriority::kCritical)] = PriorityPolicy{};
+    renderEstimateUs_.store(std::max<std::uint64_t>(1, options_.initialRenderUs),
+                            std::memory_order_relaxed);
+}
+
+AdmissionController::Ticket AdmissionController::admit(RequestPriority priority,
+                                                       std::size_t capacity,
+                                                       std::size_t pending) {
+    auto &counters = counters_[static_cast<std::size_t>(priority)];
+    // Claim the slot first so concurrent admits see each other.
+    const auto ahead = std::max(inFlight_.fetch_add(1, std::memory_order_relaxed), pending);
+    const auto expectedWaitUs = waitForPosition(ahead, capacity);
+    const auto maxWaitUs = policy(priority).maxWaitUs;
+    if (maxWaitUs > 0 && expectedWaitUs > maxWaitUs) {
+        inFlight_.fetch_sub(1, std::memory_order_relaxed);
+        counters.shed.fetch_add(1, std::memory_order_relaxed);
+        Ticket shed;
+        shed.expectedWaitUs_ = expectedWaitUs;
+        return shed;
+    }
+    counters.admitted.fetch_add(1, std::memory_order_relaxed);
+    return Ticket(this, expectedWaitUs);
+}
+
+std::uint64_t AdmissionController::acquireTimeoutMs(RequestPriority priority,
+                                                    std::uint64_t configuredTimeoutMs) const {
+    const auto maxWaitUs = policy(priority).maxWaitUs;
+    if (maxWaitUs == 0) {
+        return configuredTimeoutMs;
+    }
+    // Round up so a sub-millisecond budget still waits rather than meaning
+    // "unbounded".
+    const auto maxWaitMs = (maxWaitUs + 999) / 1000;
+    return configuredTimeoutMs == 0 ? maxWaitMs : std::min(configuredTimeoutMs, maxWaitMs);
+}
+
+void AdmissionController::recordTimeout(RequestPriority priority) {
+    counters_[static_cast<std::size_t>(priority)].timedOut.fetch_add(1,
+                                                                     std::memory_order_relaxed);
+}
+
+void AdmissionController::observeRender(std::uint64_t renderUs) {
+    // EWMA with alpha = 1/8. Concurrent updates may drop a sample, which an
+    // average over thousands of renders does not notice.
+    const auto current = renderEstimateUs_.load(std::memory_order_relaxed);
+    const auto next =
+        renderUs >= current ? current + (renderUs - current) / 8 : current - (current - renderUs) / 8;
+    renderEstimateUs_.store(std::max<std::uint64_t>(1, next), std::memory_order_relaxed);
+}
+
+std::uint64_t AdmissionController::expectedWaitUs(std::size_t capacity) const {
+    return waitForPosition(inFlight_.load(std::memory_order_relaxed), capacity);
+}
+
+const AdmissionController::PriorityPolicy &AdmissionController::policy(
+    RequestPriority priority) const {
+    return options_.policies[static_cast<std::size_t>(priority)];
+}
+
+AdmissionController::Stats AdmissionController::stats() const {
+    Stats stats;
+    stats.inFlight = inFlight_.load(std::memory_order_relaxed);
+    stats.renderEstimateUs = renderEstimateUs_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kRequestPriorityCount; ++i) {
+        stats.priorities[i].admitted = counters_[i].admitted.load(std::memory_order_relaxed);
+        stats.priorities[i].shed = counters_[i].shed.load(std::memory_order_relaxed);
+        stats.priorities[i].timedOut = counters_[i].timedOut.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+std::uint64_t AdmissionController::waitForPosition(std::size_t ahead,
+                                                   std::size_t capacity) const {
+    capacity = std::max<std::size_t>(1, capacity);
+    if (ahead < capacity) {
+        return 0;
+    }
+    // With `capacity` runtimes each finishing every estimate on average, the
+    // request starts once (ahead - capacity + 1) earlier renders complete.
+    const auto renders = static_cast<std::uint64_t>(ahead - capacity + 1);
+    return renders * renderEstimateUs_.load(std::memory_order_relaxed) / capacity;
+}
+
+}  // namespace hydra
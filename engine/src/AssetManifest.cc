@@ -0,0 +1,294 @@
+#include "hydra/AssetManifest.h"
+
+#include <json/json.h>
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace hydra {
+namespace {
+
+std::string normalizePublicPrefix(std::string publicPrefix) {
+    std::replace(publicPrefix.begin(), publicPrefix.end(), '\\', '/');
+    if (publicPrefix.empty()) {
+        return "/assets";
+    }
+    if (publicPrefix.front() != '/') {
+        publicPrefix.insert(publicPrefix.begin(), '/');
+    }
+    while (publicPrefix.size() > 1 && publicPrefix.back() == '/') {
+        publicPrefix.pop_back();
+    }
+    return publicPrefix;
+}
+
+std::vector<std::string> readKeys(const Json::Value &entry, const char *field) {
+    std::vector<std::string> keys;
+    const auto &value = entry[field];
+    if (!value.isArray()) {
+        return keys;
+    }
+    for (const auto &item : value) {
+        if (item.isString() && !item.asString().empty()) {
+            keys.push_back(item.asString());
+        }
+    }
+    return keys;
+}
+
+bool isStylesheet(const std::string &file) {
+    return file.ends_with(".css");
+}
+
+// Manifest paths are build output names; anything that would break out of
+// the <...> of a Link header is left out rather than escaped.
+bool safeForLinkHeader(std::string_view href) {
+    return !href.empty() && std::none_of(href.begin(), href.end(), [](char c) {
+        const auto byte = static_cast<unsigned char>(c);
+        return byte <= 0x20 || byte == 0x7f || c == '<' || c == '>' || c == '"' || c == ',' ||
+               c == ';';
+    });
+}
+
+}  // namespace
+
+AssetManifest AssetManifest::parse(std::string_view json, std::string publicPrefix) {
+    Json::Value root;
+    Json::CharReaderBuilder readerBuilder;
+    JSONCPP_STRING errors;
+    const std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    if (!reader->parse(json.data(), json.data() + json.size(), &root, &errors)) {
+        throw std::runtime_error("Asset manifest is not valid JSON: " + errors);
+    }
+    if (!root.isObject()) {
+        throw std::runtime_error("Asset manifest must be a JSON object");
+    }
+
+    AssetManifest manifest;
+    manifest.publicPrefix_ = std::move(publicPrefix);
+    for (const auto &key : root.getMemberNames()) {
+        const auto &entry = root[key];
+        if (!entry.isObject()) {
+            continue;
+        }
+        Chunk chunk;
+        chunk.file = entry.get("file", "").asString();
+        chunk.name = entry.get("name", "").asString();
+        chunk.isEntry = entry.get("isEntry", false).asBool();
+        chunk.isDynamicEntry = entry.get("isDynamicEntry", false).asBool();
+        chunk.imports = readKeys(entry, "imports");
+        chunk.dynamicImports = readKeys(entry, "dynamicImports");
+        chunk.css = readKeys(entry, "css");
+        manifest.chunks_.emplace(key, std::move(chunk));
+    }
+    return manifest;
+}
+
+AssetManifest AssetManifest::load(const std::filesystem::path &path, std::string publicPrefix) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Asset manifest not found: " + path.string());
+    }
+    std::ostringstream json;
+    json << input.rdbuf();
+    return parse(json.str(), std::move(publicPrefix));
+}
+
+const AssetManifest::Chunk *AssetManifest::chunk(const std::string &key) const {
+    const auto it = chunks_.find(key);
+    return it == chunks_.end() ? nullptr : &it->second;
+}
+
+std::string AssetManifest::clientEntryKey(const std::string &preferredKey) const {
+    if (chunk(preferredKey) != nullptr) {
+        return preferredKey;
+    }
+    std::string fallback;
+    for (const auto &[key, entry] : chunks_) {
+        if (!entry.isEntry || entry.file.empty()) {
+            continue;
+        }
+        if (key.find("entry-client") != std::string::npos ||
+            entry.file.find("client") != std::string::npos) {
+            return key;
+        }
+        if (fallback.empty() && entry.file.ends_with(".js")) {
+            fallback = key;
+        }
+    }
+    return fallback;
+}
+
+std::string AssetManifest::stylesheetFor(const std::string &entryKey) const {
+    if (const auto *entry = chunk(entryKey)) {
+        if (!entry->css.empty()) {
+            return publicPath(entry->css.front());
+        }
+        for (const auto &importKey : entry->imports) {
+            const auto *imported = chunk(importKey);
+            if (imported != nullptr && !imported->css.empty()) {
+                return publicPath(imported->css.front());
+            }
+        }
+    }
+    if (const auto *style = chunk("style.css"); style != nullptr && !style->file.empty()) {
+        return publicPath(style->file);
+    }
+    for (const auto &[key, entry] : chunks_) {
+        if (isStylesheet(entry.file)) {
+            return publicPath(entry.file);
+        }
+    }
+    return {};
+}
+
+std::vector<AssetPreload> AssetManifest::preloadsFor(const std::vector<std::string> &keys) const {
+    std::vector<const Chunk *> visited;
+    std::unordered_set<std::string> seenKeys;
+    std::vector<std::string> pending(keys.rbegin(), keys.rend());
+    while (!pending.empty()) {
+        auto key = std::move(pending.back());
+        pending.pop_back();
+        const auto *entry = chunk(key);
+        if (entry == nullptr || !seenKeys.insert(key).second) {
+            continue;
+        }
+        visited.push_back(entry);
+        pending.insert(pending.end(), entry->imports.rbegin(), entry->imports.rend());
+    }
+
+    std::vector<AssetPreload> preloads;
+    std::unordered_set<std::string> seenFiles;
+    const auto add = [&](AssetPreload::Kind kind, const std::string &file) {
+        if (!file.empty() && seenFiles.insert(file).second) {
+            preloads.push_back({kind, publicPath(file)});
+        }
+    };
+    for (const auto *entry : visited) {
+        if (!isStylesheet(entry->file)) {
+            add(AssetPreload::Kind::kScript, entry->file);
+        }
+    }
+    for (const auto *entry : visited) {
+        if (isStylesheet(entry->file)) {
+            add(AssetPreload::Kind::kStyle, entry->file);
+        }
+        for (const auto &css : entry->css) {
+            add(AssetPreload::Kind::kStyle, css);
+        }
+    }
+    return preloads;
+}
+
+std::map<std::string, std::string> AssetManifest::lazyChunksByPage(
+    const std::string &entryKey) const {
+    std::map<std::string, std::string> pages;
+    std::unordered_set<std::string> seen{entryKey};
+    std::deque<std::string> pending{entryKey};
+    while (!pending.empty()) {
+        const auto *entry = chunk(pending.front());
+        pending.pop_front();
+        if (entry == nullptr) {
+            continue;
+        }
+        for (const auto &key : entry->imports) {
+            if (seen.insert(key).second) {
+                pending.push_back(key);
+            }
+        }
+        for (const auto &key : entry->dynamicImports) {
+            if (!seen.insert(key).second) {
+                continue;
+            }
+            pending.push_back(key);
+            const auto *lazy = chunk(key);
+            if (lazy == nullptr) {
+                continue;
+            }
+            auto name = lazy->name;
+            if (name.empty()) {
+                // Module path without directory or extension.
+                name = key.substr(key.find_last_of('/') + 1);
+                name = name.substr(0, name.find('.'));
+            }
+            if (auto page = pageKey(name); !page.empty()) {
+                pages.try_emplace(std::move(page), key);
+            }
+        }
+    }
+    return pages;
+}
+
+std::string AssetManifest::pageKey(std::string_view name) {
+    std::string key;
+    key.reserve(name.size());
+    for (const char c : name) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) != 0) {
+            key.push_back(static_cast<char>(std::tolower(byte)));
+        }
+    }
+    return key;
+}
+
+std::string AssetManifest::publicPath(std::string file) const {
+    std::replace(file.begin(), file.end(), '\\', '/');
+    while (file.rfind("./", 0) == 0) {
+        file.erase(0, 2);
+    }
+
+    if (file.empty()) {
+        return {};
+    }
+    if (file.front() == '/') {
+        return file;
+    }
+    if (file.rfind("assets/", 0) == 0) {
+        return "/" + file;
+    }
+
+    return normalizePublicPrefix(publicPrefix_) + "/" + file;
+}
+
+std::string AssetManifest::fileFor(const std::string &publicPath) const {
+    for (const auto &[key, entry] : chunks_) {
+        if (!entry.file.empty() && this->publicPath(entry.file) == publicPath) {
+            return entry.file;
+        }
+        for (const auto &css : entry.css) {
+            if (this->publicPath(css) == publicPath) {
+                return css;
+            }
+        }
+    }
+    return {};
+}
+
+std::string formatLinkHeader(const std::vector<AssetPreload> &preloads, bool moduleScripts) {
+    std::string header;
+    for (const auto &preload : preloads) {
+        if (!safeForLinkHeader(preload.href)) {
+            continue;
+        }
+        if (!header.empty()) {
+            header += ", ";
+        }
+        header += "<" + preload.href + ">; ";
+        if (preload.kind == AssetPreload::Kind::kStyle) {
+            header += "rel=preload; as=style";
+        } else if (moduleScripts) {
+            header += "rel=modulepreload";
+        } else {
+            header += "rel=preload; as=script";
+        }
+    }
+    return header;
+}
+
+}  // namespace hydra
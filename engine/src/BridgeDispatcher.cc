@@ -0,0 +1,130 @@
+#include "hydra/BridgeDispatcher.h"
+
+#include "hydra/RenderTrace.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+BridgeResponse errorResponse(std::string body, int status = 500) {
+    BridgeResponse response;
+    response.status = status;
+    response.body = std::move(body);
+    return response;
+}
+
+}  // namespace
+
+BridgeDispatcher::BridgeDispatcher(Options options, Handler handler, BatchHandler batchHandler)
+    : options_(options),
+      handler_(std::move(handler)),
+      batchHandler_(std::move(batchHandler)),
+      executor_(std::max<std::size_t>(1, options.threads), "hydra-bridge") {}
+
+BridgeDispatcher::~BridgeDispatcher() {
+    shutdown();
+}
+
+std::size_t BridgeDispatcher::dispatch(std::vector<BridgeRequest> requests,
+                                       Completion onResponse) {
+    if (requests.empty()) {
+        return 0;
+    }
+    calls_.fetch_add(requests.size(), std::memory_order_relaxed);
+    // The caller keeps the trace alive until every completion has run.
+    auto *trace = RenderTrace::active();
+    auto shared = std::make_shared<const std::vector<BridgeRequest>>(std::move(requests));
+    auto done = std::make_shared<const Completion>(std::move(onResponse));
+
+    // Every request must complete exactly once, or the render waiting on it
+    // never finishes; work the executor refuses is answered here.
+    const auto post = [&](RenderExecutor::Task task, std::size_t first, std::size_t last) {
+        try {
+            executor_.post(std::move(task));
+            return true;
+        } catch (const std::exception &) {
+            for (std::size_t index = first; index < last; ++index) {
+                (*done)(index, errorResponse("Hydra API bridge is shutting down", 503));
+            }
+            return false;
+        }
+    };
+
+    const bool batching = batchHandler_ && options_.maxBatch > 1 && shared->size() > 1;
+    if (!batching) {
+        for (std::size_t index = 0; index < shared->size(); ++index) {
+            post([this, trace, shared, done, index] {
+                RenderTrace::Activation activation(trace);
+                BridgeResponse response;
+                try {
+                    response = handler_ ? handler_((*shared)[index])
+                                        : errorResponse("Hydra API bridge is not configured");
+                } catch (const std::exception &ex) {
+                    response = errorResponse(ex.what());
+                } catch (...) {
+                    response = errorResponse("Unknown Hydra API bridge error");
+                }
+                (*done)(index, std::move(response));
+            }, index, index + 1);
+        }
+        return 0;
+    }
+
+    std::size_t batchCount = 0;
+    for (std::size_t first = 0; first < shared->size(); first += options_.maxBatch) {
+        const auto last = std::min(shared->size(), first + options_.maxBatch);
+        const bool posted = post([this, trace, shared, done, first, last] {
+            RenderTrace::Activation activation(trace);
+            std::vector<BridgeResponse> responses;
+            std::string failure;
+            try {
+                responses = batchHandler_(std::vector<BridgeRequest>(
+                    shared->begin() + static_cast<std::ptrdiff_t>(first),
+                    shared->begin() + static_cast<std::ptrdiff_t>(last)));
+            } catch (const std::exception &ex) {
+                failure = ex.what();
+            } catch (...) {
+                failure = "Unknown Hydra API bridge error";
+            }
+            for (std::size_t index = first; index < last; ++index) {
+                const auto offset = index - first;
+                if (failure.empty() && offset < responses.size()) {
+                    (*done)(index, std::move(responses[offset]));
+                } else {
+                    (*done)(index,
+                            errorResponse(failure.empty()
+                                              ? "Hydra API bridge batch returned too few responses"
+                                              : failure));
+                }
+            }
+        }, first, last);
+        if (posted) {
+            ++batchCount;
+        }
+    }
+    batches_.fetch_add(batchCount, std::memory_order_relaxed);
+    return batchCount;
+}
+
+void BridgeDispatcher::shutdown() {
+    executor_.shutdown();
+}
+
+BridgeDispatcher::Stats BridgeDispatcher::stats() const {
+    Stats stats;
+    stats.threads = executor_.threadCount();
+    stats.maxBatch = options_.maxBatch;
+    stats.queueDepth = executor_.queueDepth();
+    stats.active = executor_.activeCount();
+    stats.calls = calls_.load(std::memory_order_relaxed);
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace hydra
@@ -1,6 +1,7 @@
 #include "hydra/Config.h"
 
 #include <json/reader.h>
+#include <json/writer.h>
 
 #include <algorithm>
 #include <cctype>
@@ -15,7 +16,40 @@ namespace {
 
 constexpr std::uint64_t kMaxAcquireTimeoutMs = 300000;
 constexpr std::uint64_t kMaxRenderTimeoutMs = 120000;
+constexpr std::uint64_t kMaxRenderThreads = 1024;
+constexpr std::uint64_t kMaxRenderQueue = 1000000;
+constexpr std::uint64_t kMaxPoolSize = 1024;
+constexpr std::uint64_t kMaxPoolIdleTtlMs = 24ULL * 60 * 60 * 1000;
+constexpr std::uint64_t kMaxPoolStandby = 64;
+constexpr std::uint64_t kMaxWarmupIterations = 10000;
+constexpr std::size_t kMaxWarmupRoutes = 64;
+constexpr std::uint64_t kMinV8HeapMb = 16;
+constexpr std::uint64_t kMaxV8HeapMb = 65536;
+constexpr std::uint64_t kMaxV8HeapGrowthPercent = 10000;
 constexpr std::uint64_t kMaxReloadIntervalMs = 600000;
+constexpr std::uint64_t kMaxRenderCacheShards = 256;
+constexpr std::uint64_t kMaxRenderCacheTtlMs = 24ULL * 60 * 60 * 1000;
+constexpr std::uint64_t kMaxSharedCacheTimeoutMs = 1000;
+constexpr std::uint64_t kMaxSharedCacheEntryBytes = 64ULL * 1024 * 1024;
+constexpr std::uint64_t kMaxSharedCacheTagRefreshMs = 600000;
+constexpr std::size_t kMaxSharedCacheKeyPrefix = 64;
+constexpr std::uint64_t kMinRenderLogRingCapacity = 16;
+constexpr std::uint64_t kMaxRenderLogRingCapacity = 65536;
+constexpr std::uint64_t kMaxRenderLogFlushIntervalMs = 10000;
+constexpr std::uint64_t kMaxAdmissionRetryAfterSec = 3600;
+constexpr std::uint64_t kMaxMetricsRoutes = 4096;
+constexpr std::size_t kMaxMetricsListSize = 64;
+constexpr std::uint64_t kMaxTracingFlushIntervalMs = 60000;
+constexpr std::uint64_t kMaxTracingQueuedTraces = 65536;
+constexpr std::uint64_t kMinHotReloadWatchIntervalMs = 100;
+constexpr std::uint64_t kMaxHotReloadWatchIntervalMs = 60000;
+constexpr std::uint64_t kMaxPrerenderRevalidateSec = 30ULL * 24 * 60 * 60;
+constexpr std::size_t kMaxPrerenderRoutes = 1024;
+constexpr std::uint64_t kMaxCompressionMinBytes = 16ULL * 1024 * 1024;
+constexpr std::uint64_t kMaxEarlyHintsLinks = 64;
+constexpr std::uint64_t kMinCriticalCssBytes = 1024;
+constexpr std::uint64_t kMaxCriticalCssBytes = 1024ULL * 1024;
+constexpr std::uint64_t kMaxCriticalCssCacheEntries = 65536;
 constexpr double kMaxProxyTimeoutSec = 300.0;
 
 std::string toLowerCopy(std::string value) {
@@ -37,6 +71,35 @@ std::string trimAsciiWhitespace(std::string value) {
     return value;
 }
 
+// Prerender paths become file paths under document_root, so they are held
+// to unreserved URL characters with no empty or dot-dot segments.
+bool isSafeRelativePath(std::string_view value) {
+    if (value.empty() || value.front() == '/' || value.back() == '/') {
+        return false;
+    }
+    std::size_t segmentStart = 0;
+    for (std::size_t i = 0; i <= value.size(); ++i) {
+        if (i < value.size() && value[i] != '/') {
+            const auto ch = static_cast<unsigned char>(value[i]);
+            if (std::isalnum(ch) == 0 && ch != '-' && ch != '_' && ch != '.' && ch != '~') {
+                return false;
+            }
+            continue;
+        }
+        const auto segment = value.substr(segmentStart, i - segmentStart);
+        if (segment.empty() || segment == "." || segment == "..") {
+            return false;
+        }
+        segmentStart = i + 1;
+    }
+    return true;
+}
+
+bool isSafePrerenderPath(std::string_view value) {
+    return value == "/" ||
+           (value.size() > 1 && value.front() == '/' && isSafeRelativePath(value.substr(1)));
+}
+
 bool hasHttpScheme(std::string_view value) {
     return value.rfind("http://", 0) == 0 || value.rfind("https://", 0) == 0;
 }
@@ -100,6 +163,40 @@ std::uint64_t readNestedUInt64(const Json::Value *object,
     return fallbackRoot.get(fallbackKey, fallbackValue).asUInt64();
 }
 
+std::vector<std::string> readStringList(const Json::Value &value, const std::string &path) {
+    if (!value.isArray()) {
+        throw std::runtime_error("HydraSsrPlugin config '" + path + "' must be an array of strings");
+    }
+    std::vector<std::string> out;
+    for (const auto &entry : value) {
+        if (!entry.isString()) {
+            throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                     "' must be an array of strings");
+        }
+        auto item = trimAsciiWhitespace(entry.asString());
+        if (!item.empty()) {
+            out.push_back(std::move(item));
+        }
+    }
+    return out;
+}
+
+std::vector<double> readNumberList(const Json::Value &value, const std::string &path) {
+    if (!value.isArray() || value.size() > kMaxMetricsListSize) {
+        throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                 "' must be an array of at most 64 numbers");
+    }
+    std::vector<double> out;
+    for (const auto &entry : value) {
+        if (!entry.isNumeric()) {
+            throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                     "' must be an array of at most 64 numbers");
+        }
+        out.push_back(entry.asDouble());
+    }
+    return out;
+}
+
 void validateManifestPath(const std::string &manifestPath) {
     if (trimAsciiWhitespace(manifestPath).empty()) {
         throw std::runtime_error("HydraSsrPlugin config 'asset_manifest_path' must be set");
@@ -196,10 +293,943 @@ HydraSsrPluginConfig validateAndNormalizeHydraSsrPluginConfig(const Json::Value
 
     normalized.acquireTimeoutMs = config.get("acquire_timeout_ms", 0).asUInt64();
     normalized.renderTimeoutMs = config.get("render_timeout_ms", normalized.renderTimeoutMs).asUInt64();
+    normalized.renderThreads = config.get("render_threads", normalized.renderThreads).asUInt64();
+    normalized.renderQueueMax =
+        config.get("render_queue_max", normalized.renderQueueMax).asUInt64();
     normalized.wrapFragment = config.get("wrap_fragment", normalized.wrapFragment).asBool();
+    normalized.poolSize = config.isMember("pool_size")
+                              ? config["pool_size"].asUInt64()
+                              : config.get("isolate_pool_size", 0).asUInt64();
+
+    const Json::Value *poolConfig =
+        config.isMember("pool") && config["pool"].isObject() ? &config["pool"] : nullptr;
+    if (poolConfig != nullptr) {
+        static const std::unordered_set<std::string> knownPoolKeys = {
+            "min",
+            "max",
+            "grow_queue_depth",
+            "grow_wait_ms",
+            "idle_ttl_ms",
+            "standby",
+            "thread_affinity",
+        };
+        for (const auto &key : poolConfig->getMemberNames()) {
+            if (knownPoolKeys.find(key) == knownPoolKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'pool." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.poolMin = readNestedUInt64(poolConfig, config, "min", "pool_min", 0);
+    normalized.poolMax = readNestedUInt64(poolConfig, config, "max", "pool_max", 0);
+    normalized.poolGrowQueueDepth = readNestedUInt64(
+        poolConfig, config, "grow_queue_depth", "pool_grow_queue_depth",
+        normalized.poolGrowQueueDepth);
+    normalized.poolGrowWaitMs = readNestedUInt64(
+        poolConfig, config, "grow_wait_ms", "pool_grow_wait_ms", normalized.poolGrowWaitMs);
+    normalized.poolIdleTtlMs = readNestedUInt64(
+        poolConfig, config, "idle_ttl_ms", "pool_idle_ttl_ms", normalized.poolIdleTtlMs);
+    normalized.poolStandby =
+        readNestedUInt64(poolConfig, config, "standby", "pool_standby", normalized.poolStandby);
+    normalized.poolThreadAffinity = readNestedBool(poolConfig, config, "thread_affinity",
+                                                   "pool_thread_affinity",
+                                                   normalized.poolThreadAffinity);
+    if (normalized.poolSize > kMaxPoolSize) {
+        throw std::runtime_error("HydraSsrPlugin config 'pool_size' must be in range 0..1024");
+    }
+    if (normalized.poolMin > kMaxPoolSize) {
+        throw std::runtime_error("HydraSsrPlugin config 'pool.min' must be in range 0..1024");
+    }
+    if (normalized.poolMax > kMaxPoolSize) {
+        throw std::runtime_error("HydraSsrPlugin config 'pool.max' must be in range 0..1024");
+    }
+    const auto effectivePoolMin = normalized.poolMin > 0 ? normalized.poolMin : normalized.poolSize;
+    if (normalized.poolMax > 0 && effectivePoolMin > normalized.poolMax) {
+        throw std::runtime_error("HydraSsrPlugin config 'pool.min' must be <= 'pool.max'");
+    }
+    if (normalized.poolGrowQueueDepth == 0 || normalized.poolGrowQueueDepth > kMaxPoolSize) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'pool.grow_queue_depth' must be in range 1..1024");
+    }
+    if (normalized.poolGrowWaitMs > kMaxAcquireTimeoutMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'pool.grow_wait_ms' must be in range 0..300000");
+    }
+    if (normalized.poolIdleTtlMs > kMaxPoolIdleTtlMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'pool.idle_ttl_ms' must be in range 0..86400000");
+    }
+    if (normalized.poolStandby > kMaxPoolStandby) {
+        throw std::runtime_error("HydraSsrPlugin config 'pool.standby' must be in range 0..64");
+    }
+
+    const Json::Value *warmupConfig =
+        config.isMember("warmup") && config["warmup"].isObject() ? &config["warmup"] : nullptr;
+    if (warmupConfig != nullptr) {
+        static const std::unordered_set<std::string> knownWarmupKeys = {
+            "enabled",
+            "iterations",
+            "routes",
+        };
+        for (const auto &key : warmupConfig->getMemberNames()) {
+            if (knownWarmupKeys.find(key) == knownWarmupKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'warmup." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.warmupEnabled =
+        readNestedBool(warmupConfig, config, "enabled", "warmup_enabled", false);
+    normalized.warmupIterations = readNestedUInt64(
+        warmupConfig, config, "iterations", "warmup_iterations", normalized.warmupIterations);
+    if (normalized.warmupIterations == 0 ||
+        normalized.warmupIterations > kMaxWarmupIterations) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'warmup.iterations' must be in range 1..10000");
+    }
+    const Json::Value *warmupRoutes =
+        warmupConfig != nullptr && warmupConfig->isMember("routes")
+            ? &(*warmupConfig)["routes"]
+            : (config.isMember("warmup_routes") ? &config["warmup_routes"] : nullptr);
+    if (warmupRoutes != nullptr) {
+        if (!warmupRoutes->isArray()) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'warmup.routes' must be an array of URLs or objects");
+        }
+        if (warmupRoutes->size() > kMaxWarmupRoutes) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'warmup.routes' must have at most 64 entries");
+        }
+        static const std::unordered_set<std::string> knownRouteKeys = {
+            "url",
+            "props",
+        };
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        for (Json::ArrayIndex i = 0; i < warmupRoutes->size(); ++i) {
+            const auto &entry = (*warmupRoutes)[i];
+            const auto path = "warmup.routes[" + std::to_string(i) + "]";
+            HydraWarmupRouteConfig route;
+            if (entry.isString()) {
+                route.url = trimAsciiWhitespace(entry.asString());
+            } else if (entry.isObject()) {
+                for (const auto &key : entry.getMemberNames()) {
+                    if (knownRouteKeys.find(key) == knownRouteKeys.end()) {
+                        throw std::runtime_error(
+                            "HydraSsrPlugin config '" + path + "." + key + "' is not supported");
+                    }
+                }
+                route.url = trimAsciiWhitespace(entry.get("url", "").asString());
+                if (entry.isMember("props")) {
+                    if (!entry["props"].isObject()) {
+                        throw std::runtime_error(
+                            "HydraSsrPlugin config '" + path + ".props' must be an object");
+                    }
+                    route.propsJson = Json::writeString(writer, entry["props"]);
+                }
+            } else {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config '" + path + "' must be a URL or an object");
+            }
+            if (route.url.empty() || route.url.front() != '/') {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config '" + path + ".url' must start with '/'");
+            }
+            normalized.warmupRoutes.push_back(std::move(route));
+        }
+    }
+    if (normalized.warmupEnabled && normalized.warmupRoutes.empty()) {
+        normalized.warmupRoutes.push_back({"/", "{}"});
+    }
+
     normalized.logRenderMetrics =
         config.get("log_render_metrics", normalized.logRenderMetrics).asBool();
 
+    const Json::Value *renderLogConfig =
+        config.isMember("render_log") && config["render_log"].isObject()
+            ? &config["render_log"]
+            : nullptr;
+    if (renderLogConfig != nullptr) {
+        static const std::unordered_set<std::string> knownRenderLogKeys = {
+            "sample_rate",
+            "slow_ms",
+            "always_log_failures",
+            "ring_capacity",
+            "flush_interval_ms",
+        };
+        for (const auto &key : renderLogConfig->getMemberNames()) {
+            if (knownRenderLogKeys.find(key) == knownRenderLogKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'render_log." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.renderLogSampleRate = readNestedDouble(
+        renderLogConfig, config, "sample_rate", "render_log_sample_rate",
+        normalized.renderLogSampleRate);
+    normalized.renderLogSlowMs = readNestedUInt64(
+        renderLogConfig, config, "slow_ms", "render_log_slow_ms", normalized.renderLogSlowMs);
+    normalized.renderLogAlwaysFailures = readNestedBool(
+        renderLogConfig, config, "always_log_failures", "render_log_always_log_failures",
+        normalized.renderLogAlwaysFailures);
+    normalized.renderLogRingCapacity = readNestedUInt64(
+        renderLogConfig, config, "ring_capacity", "render_log_ring_capacity",
+        normalized.renderLogRingCapacity);
+    normalized.renderLogFlushIntervalMs = readNestedUInt64(
+        renderLogConfig, config, "flush_interval_ms", "render_log_flush_interval_ms",
+        normalized.renderLogFlushIntervalMs);
+    if (!(normalized.renderLogSampleRate >= 0.0 && normalized.renderLogSampleRate <= 1.0)) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_log.sample_rate' must be in range 0..1");
+    }
+    if (normalized.renderLogSlowMs > kMaxRenderTimeoutMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_log.slow_ms' must be in range 0..120000");
+    }
+    if (normalized.renderLogRingCapacity < kMinRenderLogRingCapacity ||
+        normalized.renderLogRingCapacity > kMaxRenderLogRingCapacity) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_log.ring_capacity' must be in range 16..65536");
+    }
+    if (normalized.renderLogFlushIntervalMs == 0 ||
+        normalized.renderLogFlushIntervalMs > kMaxRenderLogFlushIntervalMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_log.flush_interval_ms' must be in range 1..10000");
+    }
+
+    const Json::Value *admissionConfig =
+        config.isMember("admission") && config["admission"].isObject() ? &config["admission"]
+                                                                         : nullptr;
+    if (admissionConfig != nullptr) {
+        static const std::unordered_set<std::string> knownAdmissionKeys = {
+            "enabled",
+            "retry_after_s",
+            "health_paths",
+            "session_cookies",
+            "bot_user_agents",
+            "priorities",
+        };
+        for (const auto &key : admissionConfig->getMemberNames()) {
+            if (knownAdmissionKeys.find(key) == knownAdmissionKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'admission." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.admissionEnabled =
+        readNestedBool(admissionConfig, config, "enabled", "admission_enabled", false);
+    normalized.admissionRetryAfterSec = readNestedUInt64(
+        admissionConfig, config, "retry_after_s", "admission_retry_after_s",
+        normalized.admissionRetryAfterSec);
+    if (normalized.admissionRetryAfterSec > kMaxAdmissionRetryAfterSec) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'admission.retry_after_s' must be in range 0..3600");
+    }
+    if (admissionConfig != nullptr) {
+        if (admissionConfig->isMember("health_paths")) {
+            normalized.admissionHealthPaths =
+                readStringList((*admissionConfig)["health_paths"], "admission.health_paths");
+        }
+        if (admissionConfig->isMember("session_cookies")) {
+            normalized.admissionSessionCookies =
+                readStringList((*admissionConfig)["session_cookies"], "admission.session_cookies");
+        }
+        if (admissionConfig->isMember("bot_user_agents")) {
+            normalized.admissionBotUserAgents =
+                readStringList((*admissionConfig)["bot_user_agents"], "admission.bot_user_agents");
+            for (auto &agent : normalized.admissionBotUserAgents) {
+                agent = toLowerCopy(std::move(agent));
+            }
+        }
+    }
+    if (admissionConfig != nullptr && admissionConfig->isMember("priorities")) {
+        const auto &priorities = (*admissionConfig)["priorities"];
+        if (!priorities.isObject()) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'admission.priorities' must be an object");
+        }
+        static const std::unordered_set<std::string> knownPriorityKeys = {
+            "max_wait_ms",
+            "action",
+        };
+        for (const auto &name : priorities.getMemberNames()) {
+            const auto path = "admission.priorities." + name;
+            HydraAdmissionPriorityConfig *policy = nullptr;
+            if (name == "high") {
+                policy = &normalized.admissionHigh;
+            } else if (name == "normal") {
+                policy = &normalized.admissionNormal;
+            } else if (name == "low") {
+                policy = &normalized.admissionLow;
+            } else {
+                throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                         "' is not supported (expected high|normal|low)");
+            }
+            const auto &entry = priorities[name];
+            if (!entry.isObject()) {
+                throw std::runtime_error("HydraSsrPlugin config '" + path + "' must be an object");
+            }
+            for (const auto &key : entry.getMemberNames()) {
+                if (knownPriorityKeys.find(key) == knownPriorityKeys.end()) {
+                    throw std::runtime_error(
+                        "HydraSsrPlugin config '" + path + "." + key + "' is not supported");
+                }
+            }
+            policy->maxWaitMs = entry.get("max_wait_ms", policy->maxWaitMs).asUInt64();
+            if (policy->maxWaitMs > kMaxAcquireTimeoutMs) {
+                throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                         ".max_wait_ms' must be in range 0..300000");
+            }
+            if (entry.isMember("action")) {
+                const auto action = toLowerCopy(trimAsciiWhitespace(entry["action"].asString()));
+                if (action != "shell" && action != "reject") {
+                    throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                             ".action' must be one of: shell|reject");
+                }
+                policy->reject = action == "reject";
+            }
+        }
+    }
+
+    const Json::Value *metricsConfig =
+        config.isMember("metrics") && config["metrics"].isObject() ? &config["metrics"] : nullptr;
+    if (metricsConfig != nullptr) {
+        static const std::unordered_set<std::string> knownMetricsKeys = {
+            "histogram_bounds_ms",
+            "quantiles",
+            "max_routes",
+        };
+        for (const auto &key : metricsConfig->getMemberNames()) {
+            if (knownMetricsKeys.find(key) == knownMetricsKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'metrics." + key + "' is not supported");
+            }
+        }
+        if (metricsConfig->isMember("histogram_bounds_ms")) {
+            normalized.metricsHistogramBoundsMs = readNumberList(
+                (*metricsConfig)["histogram_bounds_ms"], "metrics.histogram_bounds_ms");
+        }
+        if (metricsConfig->isMember("quantiles")) {
+            normalized.metricsQuantiles =
+                readNumberList((*metricsConfig)["quantiles"], "metrics.quantiles");
+        }
+    }
+    double previousBoundMs = 0.0;
+    for (const auto boundMs : normalized.metricsHistogramBoundsMs) {
+        if (!(boundMs > previousBoundMs && boundMs <= static_cast<double>(kMaxAcquireTimeoutMs))) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'metrics.histogram_bounds_ms' must be increasing values in "
+                "range 0..300000");
+        }
+        previousBoundMs = boundMs;
+    }
+    for (const auto quantile : normalized.metricsQuantiles) {
+        if (!(quantile > 0.0 && quantile < 1.0)) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'metrics.quantiles' values must be in range 0..1");
+        }
+    }
+    normalized.metricsMaxRoutes = readNestedUInt64(
+        metricsConfig, config, "max_routes", "metrics_max_routes", normalized.metricsMaxRoutes);
+    if (normalized.metricsMaxRoutes > kMaxMetricsRoutes) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'metrics.max_routes' must be in range 0..4096");
+    }
+
+    const Json::Value *tracingConfig =
+        config.isMember("tracing") && config["tracing"].isObject() ? &config["tracing"] : nullptr;
+    if (tracingConfig != nullptr) {
+        static const std::unordered_set<std::string> knownTracingKeys = {
+            "enabled",
+            "sample_rate",
+            "server_timing",
+            "otlp_endpoint",
+            "service_name",
+            "flush_interval_ms",
+            "max_queued_traces",
+        };
+        for (const auto &key : tracingConfig->getMemberNames()) {
+            if (knownTracingKeys.find(key) == knownTracingKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'tracing." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.tracingEnabled =
+        readNestedBool(tracingConfig, config, "enabled", "tracing_enabled", false);
+    normalized.tracingSampleRate = readNestedDouble(
+        tracingConfig, config, "sample_rate", "tracing_sample_rate", normalized.tracingSampleRate);
+    normalized.tracingServerTiming = readNestedBool(
+        tracingConfig, config, "server_timing", "tracing_server_timing", false);
+    normalized.tracingOtlpEndpoint = trimAsciiWhitespace(
+        readNestedString(tracingConfig, config, "otlp_endpoint", "tracing_otlp_endpoint", ""));
+    normalized.tracingServiceName = trimAsciiWhitespace(readNestedString(
+        tracingConfig, config, "service_name", "tracing_service_name",
+        normalized.tracingServiceName));
+    normalized.tracingFlushIntervalMs = readNestedUInt64(
+        tracingConfig, config, "flush_interval_ms", "tracing_flush_interval_ms",
+        normalized.tracingFlushIntervalMs);
+    normalized.tracingMaxQueuedTraces = readNestedUInt64(
+        tracingConfig, config, "max_queued_traces", "tracing_max_queued_traces",
+        normalized.tracingMaxQueuedTraces);
+    if (!(normalized.tracingSampleRate >= 0.0 && normalized.tracingSampleRate <= 1.0)) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'tracing.sample_rate' must be in range 0..1");
+    }
+    if (!normalized.tracingOtlpEndpoint.empty() &&
+        !hasHttpScheme(normalized.tracingOtlpEndpoint)) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'tracing.otlp_endpoint' must start with http:// or https://");
+    }
+    if (normalized.tracingServiceName.empty()) {
+        throw std::runtime_error("HydraSsrPlugin config 'tracing.service_name' must not be empty");
+    }
+    if (normalized.tracingFlushIntervalMs == 0 ||
+        normalized.tracingFlushIntervalMs > kMaxTracingFlushIntervalMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'tracing.flush_interval_ms' must be in range 1..60000");
+    }
+    if (normalized.tracingMaxQueuedTraces == 0 ||
+        normalized.tracingMaxQueuedTraces > kMaxTracingQueuedTraces) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'tracing.max_queued_traces' must be in range 1..65536");
+    }
+
+    const Json::Value *snapshotConfig =
+        config.isMember("v8_snapshot") && config["v8_snapshot"].isObject()
+            ? &config["v8_snapshot"]
+            : nullptr;
+    if (snapshotConfig != nullptr) {
+        static const std::unordered_set<std::string> knownSnapshotKeys = {
+            "enabled",
+            "persist",
+            "path",
+        };
+        for (const auto &key : snapshotConfig->getMemberNames()) {
+            if (knownSnapshotKeys.find(key) == knownSnapshotKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'v8_snapshot." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.v8SnapshotEnabled =
+        readNestedBool(snapshotConfig, config, "enabled", "v8_snapshot_enabled", false);
+    normalized.v8SnapshotPersist =
+        readNestedBool(snapshotConfig, config, "persist", "v8_snapshot_persist", true);
+    normalized.v8SnapshotPath = trimAsciiWhitespace(
+        readNestedString(snapshotConfig, config, "path", "v8_snapshot_path", ""));
+
+    const Json::Value *codeCacheConfig =
+        config.isMember("v8_code_cache") && config["v8_code_cache"].isObject()
+            ? &config["v8_code_cache"]
+            : nullptr;
+    if (codeCacheConfig != nullptr) {
+        static const std::unordered_set<std::string> knownCodeCacheKeys = {
+            "enabled",
+            "persist",
+            "path",
+        };
+        for (const auto &key : codeCacheConfig->getMemberNames()) {
+            if (knownCodeCacheKeys.find(key) == knownCodeCacheKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'v8_code_cache." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.v8CodeCacheEnabled =
+        readNestedBool(codeCacheConfig, config, "enabled", "v8_code_cache_enabled", true);
+    normalized.v8CodeCachePersist =
+        readNestedBool(codeCacheConfig, config, "persist", "v8_code_cache_persist", false);
+    normalized.v8CodeCachePath = trimAsciiWhitespace(
+        readNestedString(codeCacheConfig, config, "path", "v8_code_cache_path", ""));
+
+    const Json::Value *hotReloadConfig =
+        config.isMember("hot_reload") && config["hot_reload"].isObject() ? &config["hot_reload"]
+                                                                           : nullptr;
+    if (hotReloadConfig != nullptr) {
+        static const std::unordered_set<std::string> knownHotReloadKeys = {
+            "enabled",
+            "watch",
+            "watch_interval_ms",
+            "signal",
+        };
+        for (const auto &key : hotReloadConfig->getMemberNames()) {
+            if (knownHotReloadKeys.find(key) == knownHotReloadKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'hot_reload." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.hotReloadEnabled =
+        readNestedBool(hotReloadConfig, config, "enabled", "hot_reload_enabled", false);
+    normalized.hotReloadWatch =
+        readNestedBool(hotReloadConfig, config, "watch", "hot_reload_watch", true);
+    normalized.hotReloadWatchIntervalMs = readNestedUInt64(
+        hotReloadConfig, config, "watch_interval_ms", "hot_reload_watch_interval_ms",
+        normalized.hotReloadWatchIntervalMs);
+    normalized.hotReloadSignal =
+        readNestedBool(hotReloadConfig, config, "signal", "hot_reload_signal", false);
+    if (normalized.hotReloadWatchIntervalMs < kMinHotReloadWatchIntervalMs ||
+        normalized.hotReloadWatchIntervalMs > kMaxHotReloadWatchIntervalMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'hot_reload.watch_interval_ms' must be in range 100..60000");
+    }
+
+    const Json::Value *heapConfig =
+        config.isMember("v8_heap") && config["v8_heap"].isObject() ? &config["v8_heap"]
+                                                                     : nullptr;
+    if (heapConfig != nullptr) {
+        static const std::unordered_set<std::string> knownHeapKeys = {
+            "max_mb",
+            "recycle_after_renders",
+            "recycle_heap_growth_percent",
+            "idle_gc",
+            "idle_gc_delay_ms",
+        };
+        for (const auto &key : heapConfig->getMemberNames()) {
+            if (knownHeapKeys.find(key) == knownHeapKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'v8_heap." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.v8HeapMaxMb = readNestedUInt64(heapConfig, config, "max_mb", "v8_heap_max_mb", 0);
+    normalized.v8HeapRecycleAfterRenders = readNestedUInt64(
+        heapConfig, config, "recycle_after_renders", "v8_heap_recycle_after_renders", 0);
+    normalized.v8HeapRecycleGrowthPercent = readNestedUInt64(
+        heapConfig, config, "recycle_heap_growth_percent", "v8_heap_recycle_growth_percent", 0);
+    normalized.v8HeapIdleGc =
+        readNestedBool(heapConfig, config, "idle_gc", "v8_heap_idle_gc", normalized.v8HeapIdleGc);
+    normalized.v8HeapIdleGcDelayMs = readNestedUInt64(
+        heapConfig, config, "idle_gc_delay_ms", "v8_heap_idle_gc_delay_ms",
+        normalized.v8HeapIdleGcDelayMs);
+    if (normalized.v8HeapMaxMb != 0 &&
+        (normalized.v8HeapMaxMb < kMinV8HeapMb || normalized.v8HeapMaxMb > kMaxV8HeapMb)) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'v8_heap.max_mb' must be 0 or in range 16..65536");
+    }
+    if (normalized.v8HeapRecycleGrowthPercent > kMaxV8HeapGrowthPercent) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'v8_heap.recycle_heap_growth_percent' must be in range "
+            "0..10000");
+    }
+    if (normalized.v8HeapIdleGcDelayMs > kMaxReloadIntervalMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'v8_heap.idle_gc_delay_ms' must be in range 0..600000");
+    }
+
+    const Json::Value *renderCacheConfig =
+        config.isMember("render_cache") && config["render_cache"].isObject()
+            ? &config["render_cache"]
+            : nullptr;
+    if (renderCacheConfig != nullptr) {
+        static const std::unordered_set<std::string> knownRenderCacheKeys = {
+            "enabled",
+            "max_bytes",
+            "shards",
+            "ttl_ms",
+            "stale_while_revalidate_ms",
+            "pages",
+            "shared",
+        };
+        for (const auto &key : renderCacheConfig->getMemberNames()) {
+            if (knownRenderCacheKeys.find(key) == knownRenderCacheKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'render_cache." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.renderCacheEnabled =
+        readNestedBool(renderCacheConfig, config, "enabled", "render_cache_enabled", false);
+    normalized.renderCacheMaxBytes = readNestedUInt64(
+        renderCacheConfig, config, "max_bytes", "render_cache_max_bytes",
+        normalized.renderCacheMaxBytes);
+    normalized.renderCacheShards = readNestedUInt64(
+        renderCacheConfig, config, "shards", "render_cache_shards", normalized.renderCacheShards);
+    normalized.renderCacheDefaultPolicy.ttlMs =
+        readNestedUInt64(renderCacheConfig, config, "ttl_ms", "render_cache_ttl_ms", 0);
+    normalized.renderCacheDefaultPolicy.staleWhileRevalidateMs = readNestedUInt64(
+        renderCacheConfig, config, "stale_while_revalidate_ms",
+        "render_cache_stale_while_revalidate_ms", 0);
+    if (normalized.renderCacheMaxBytes == 0) {
+        throw std::runtime_error("HydraSsrPlugin config 'render_cache.max_bytes' must be > 0");
+    }
+    if (normalized.renderCacheShards == 0 || normalized.renderCacheShards > kMaxRenderCacheShards) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_cache.shards' must be in range 1..256");
+    }
+    const auto validateCachePolicy = [](const HydraRenderCachePageConfig &policy,
+                                        const std::string &path) {
+        if (policy.ttlMs > kMaxRenderCacheTtlMs) {
+            throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                     ".ttl_ms' must be in range 0..86400000");
+        }
+        if (policy.staleWhileRevalidateMs > kMaxRenderCacheTtlMs) {
+            throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                     ".stale_while_revalidate_ms' must be in range 0..86400000");
+        }
+    };
+    validateCachePolicy(normalized.renderCacheDefaultPolicy, "render_cache");
+    if (renderCacheConfig != nullptr && renderCacheConfig->isMember("pages")) {
+        const auto &pages = (*renderCacheConfig)["pages"];
+        if (!pages.isObject()) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'render_cache.pages' must be an object keyed by pageId");
+        }
+        static const std::unordered_set<std::string> knownPageKeys = {
+            "ttl_ms",
+            "stale_while_revalidate_ms",
+        };
+        for (const auto &pageId : pages.getMemberNames()) {
+            const auto &page = pages[pageId];
+            const auto path = "render_cache.pages." + pageId;
+            if (!page.isObject()) {
+                throw std::runtime_error("HydraSsrPlugin config '" + path + "' must be an object");
+            }
+            for (const auto &key : page.getMemberNames()) {
+                if (knownPageKeys.find(key) == knownPageKeys.end()) {
+                    throw std::runtime_error(
+                        "HydraSsrPlugin config '" + path + "." + key + "' is not supported");
+                }
+            }
+            HydraRenderCachePageConfig policy = normalized.renderCacheDefaultPolicy;
+            policy.ttlMs = page.get("ttl_ms", policy.ttlMs).asUInt64();
+            policy.staleWhileRevalidateMs =
+                page.get("stale_while_revalidate_ms", policy.staleWhileRevalidateMs).asUInt64();
+            validateCachePolicy(policy, path);
+            normalized.renderCachePages[pageId] = policy;
+        }
+    }
+
+    const Json::Value *sharedCacheConfig =
+        renderCacheConfig != nullptr && renderCacheConfig->isMember("shared") &&
+                (*renderCacheConfig)["shared"].isObject()
+            ? &(*renderCacheConfig)["shared"]
+            : nullptr;
+    if (sharedCacheConfig != nullptr) {
+        static const std::unordered_set<std::string> knownSharedCacheKeys = {
+            "enabled",
+            "redis_client",
+            "key_prefix",
+            "timeout_ms",
+            "max_entry_bytes",
+            "gzip",
+            "tag_refresh_ms",
+        };
+        for (const auto &key : sharedCacheConfig->getMemberNames()) {
+            if (knownSharedCacheKeys.find(key) == knownSharedCacheKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'render_cache.shared." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.renderCacheSharedEnabled = readNestedBool(
+        sharedCacheConfig, config, "enabled", "render_cache_shared_enabled", false);
+    normalized.renderCacheSharedRedisClient =
+        readNestedString(sharedCacheConfig, config, "redis_client",
+                         "render_cache_shared_redis_client",
+                         normalized.renderCacheSharedRedisClient);
+    normalized.renderCacheSharedKeyPrefix =
+        readNestedString(sharedCacheConfig, config, "key_prefix",
+                         "render_cache_shared_key_prefix", normalized.renderCacheSharedKeyPrefix);
+    normalized.renderCacheSharedTimeoutMs =
+        readNestedUInt64(sharedCacheConfig, config, "timeout_ms", "render_cache_shared_timeout_ms",
+                         normalized.renderCacheSharedTimeoutMs);
+    normalized.renderCacheSharedMaxEntryBytes = readNestedUInt64(
+        sharedCacheConfig, config, "max_entry_bytes", "render_cache_shared_max_entry_bytes",
+        normalized.renderCacheSharedMaxEntryBytes);
+    normalized.renderCacheSharedGzip = readNestedBool(
+        sharedCacheConfig, config, "gzip", "render_cache_shared_gzip",
+        normalized.renderCacheSharedGzip);
+    normalized.renderCacheSharedTagRefreshMs = readNestedUInt64(
+        sharedCacheConfig, config, "tag_refresh_ms", "render_cache_shared_tag_refresh_ms",
+        normalized.renderCacheSharedTagRefreshMs);
+    if (normalized.renderCacheSharedEnabled && !normalized.renderCacheEnabled) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_cache.shared' requires render_cache.enabled");
+    }
+    if (normalized.renderCacheSharedRedisClient.empty()) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_cache.shared.redis_client' must not be empty");
+    }
+    const auto &keyPrefix = normalized.renderCacheSharedKeyPrefix;
+    if (keyPrefix.empty() || keyPrefix.size() > kMaxSharedCacheKeyPrefix ||
+        std::any_of(keyPrefix.begin(), keyPrefix.end(), [](unsigned char ch) {
+            return ch <= ' ' || ch >= 0x7F;
+        })) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_cache.shared.key_prefix' must be 1..64 printable "
+            "characters without spaces");
+    }
+    if (normalized.renderCacheSharedTimeoutMs == 0 ||
+        normalized.renderCacheSharedTimeoutMs > kMaxSharedCacheTimeoutMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_cache.shared.timeout_ms' must be in range 1..1000");
+    }
+    if (normalized.renderCacheSharedMaxEntryBytes == 0 ||
+        normalized.renderCacheSharedMaxEntryBytes > kMaxSharedCacheEntryBytes) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_cache.shared.max_entry_bytes' must be in range "
+            "1..67108864");
+    }
+    if (normalized.renderCacheSharedTagRefreshMs > kMaxSharedCacheTagRefreshMs) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_cache.shared.tag_refresh_ms' must be in range "
+            "0..600000");
+    }
+
+    const Json::Value *prerenderConfig =
+        config.isMember("prerender") && config["prerender"].isObject() ? &config["prerender"]
+                                                                         : nullptr;
+    if (prerenderConfig != nullptr) {
+        static const std::unordered_set<std::string> knownPrerenderKeys = {
+            "enabled",
+            "output_dir",
+            "revalidate_s",
+            "routes",
+        };
+        for (const auto &key : prerenderConfig->getMemberNames()) {
+            if (knownPrerenderKeys.find(key) == knownPrerenderKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'prerender." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.prerenderEnabled =
+        readNestedBool(prerenderConfig, config, "enabled", "prerender_enabled", false);
+    normalized.prerenderOutputDir = trimAsciiWhitespace(readNestedString(
+        prerenderConfig, config, "output_dir", "prerender_output_dir",
+        normalized.prerenderOutputDir));
+    normalized.prerenderRevalidateSec = readNestedUInt64(
+        prerenderConfig, config, "revalidate_s", "prerender_revalidate_s",
+        normalized.prerenderRevalidateSec);
+    if (!isSafeRelativePath(normalized.prerenderOutputDir)) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'prerender.output_dir' must be a relative path of "
+            "[A-Za-z0-9._~-] segments");
+    }
+    if (normalized.prerenderRevalidateSec > kMaxPrerenderRevalidateSec) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'prerender.revalidate_s' must be in range 0..2592000");
+    }
+    const Json::Value *prerenderRoutes =
+        prerenderConfig != nullptr && prerenderConfig->isMember("routes")
+            ? &(*prerenderConfig)["routes"]
+            : (config.isMember("prerender_routes") ? &config["prerender_routes"] : nullptr);
+    if (prerenderRoutes != nullptr) {
+        if (!prerenderRoutes->isArray()) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'prerender.routes' must be an array of paths or objects");
+        }
+        if (prerenderRoutes->size() > kMaxPrerenderRoutes) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'prerender.routes' must have at most 1024 entries");
+        }
+        static const std::unordered_set<std::string> knownRouteKeys = {
+            "path",
+            "revalidate_s",
+            "locales",
+            "themes",
+        };
+        std::unordered_set<std::string> seenPaths;
+        for (Json::ArrayIndex i = 0; i < prerenderRoutes->size(); ++i) {
+            const auto &entry = (*prerenderRoutes)[i];
+            const auto path = "prerender.routes[" + std::to_string(i) + "]";
+            HydraPrerenderRouteConfig route;
+            route.revalidateSec = normalized.prerenderRevalidateSec;
+            if (entry.isString()) {
+                route.path = trimAsciiWhitespace(entry.asString());
+            } else if (entry.isObject()) {
+                for (const auto &key : entry.getMemberNames()) {
+                    if (knownRouteKeys.find(key) == knownRouteKeys.end()) {
+                        throw std::runtime_error(
+                            "HydraSsrPlugin config '" + path + "." + key + "' is not supported");
+                    }
+                }
+                route.path = trimAsciiWhitespace(entry.get("path", "").asString());
+                route.revalidateSec = entry.get("revalidate_s", route.revalidateSec).asUInt64();
+                if (entry.isMember("locales")) {
+                    route.locales = readStringList(entry["locales"], path + ".locales");
+                }
+                if (entry.isMember("themes")) {
+                    route.themes = readStringList(entry["themes"], path + ".themes");
+                }
+            } else {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config '" + path + "' must be a path or an object");
+            }
+            if (!isSafePrerenderPath(route.path)) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config '" + path +
+                    ".path' must start with '/' and use [A-Za-z0-9._~-] segments without a "
+                    "query");
+            }
+            if (route.revalidateSec > kMaxPrerenderRevalidateSec) {
+                throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                         ".revalidate_s' must be in range 0..2592000");
+            }
+            if (!seenPaths.insert(route.path).second) {
+                throw std::runtime_error("HydraSsrPlugin config '" + path + ".path' duplicates " +
+                                         route.path);
+            }
+            normalized.prerenderRoutes.push_back(std::move(route));
+        }
+    }
+
+    const Json::Value *compressionConfig =
+        config.isMember("compression") && config["compression"].isObject()
+            ? &config["compression"]
+            : nullptr;
+    if (compressionConfig != nullptr) {
+        static const std::unordered_set<std::string> knownCompressionKeys = {
+            "enabled",
+            "gzip",
+            "brotli",
+            "gzip_level",
+            "brotli_quality",
+            "min_bytes",
+            "static_sidecars",
+        };
+        for (const auto &key : compressionConfig->getMemberNames()) {
+            if (knownCompressionKeys.find(key) == knownCompressionKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'compression." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.compressionEnabled =
+        readNestedBool(compressionConfig, config, "enabled", "compression_enabled", false);
+    normalized.compressionGzip = readNestedBool(
+        compressionConfig, config, "gzip", "compression_gzip", normalized.compressionGzip);
+    normalized.compressionBrotli = readNestedBool(
+        compressionConfig, config, "brotli", "compression_brotli", normalized.compressionBrotli);
+    normalized.compressionGzipLevel = readNestedUInt64(
+        compressionConfig, config, "gzip_level", "compression_gzip_level",
+        normalized.compressionGzipLevel);
+    normalized.compressionBrotliQuality = readNestedUInt64(
+        compressionConfig, config, "brotli_quality", "compression_brotli_quality",
+        normalized.compressionBrotliQuality);
+    normalized.compressionMinBytes = readNestedUInt64(
+        compressionConfig, config, "min_bytes", "compression_min_bytes",
+        normalized.compressionMinBytes);
+    normalized.compressionStaticSidecars = readNestedBool(
+        compressionConfig, config, "static_sidecars", "compression_static_sidecars",
+        normalized.compressionStaticSidecars);
+    if (normalized.compressionGzipLevel < 1 || normalized.compressionGzipLevel > 9) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'compression.gzip_level' must be in range 1..9");
+    }
+    if (normalized.compressionBrotliQuality > 11) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'compression.brotli_quality' must be in range 0..11");
+    }
+    if (normalized.compressionMinBytes > kMaxCompressionMinBytes) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'compression.min_bytes' must be in range 0..16777216");
+    }
+
+    const Json::Value *earlyHintsConfig =
+        config.isMember("early_hints") && config["early_hints"].isObject()
+            ? &config["early_hints"]
+            : nullptr;
+    if (earlyHintsConfig != nullptr) {
+        static const std::unordered_set<std::string> knownEarlyHintsKeys = {
+            "enabled",
+            "html_tags",
+            "max_links",
+            "pages",
+        };
+        for (const auto &key : earlyHintsConfig->getMemberNames()) {
+            if (knownEarlyHintsKeys.find(key) == knownEarlyHintsKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'early_hints." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.earlyHintsEnabled =
+        readNestedBool(earlyHintsConfig, config, "enabled", "early_hints_enabled", false);
+    normalized.earlyHintsHtmlTags = readNestedBool(
+        earlyHintsConfig, config, "html_tags", "early_hints_html_tags",
+        normalized.earlyHintsHtmlTags);
+    normalized.earlyHintsMaxLinks = readNestedUInt64(
+        earlyHintsConfig, config, "max_links", "early_hints_max_links",
+        normalized.earlyHintsMaxLinks);
+    if (normalized.earlyHintsMaxLinks < 1 || normalized.earlyHintsMaxLinks > kMaxEarlyHintsLinks) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'early_hints.max_links' must be in range 1..64");
+    }
+    if (earlyHintsConfig != nullptr && earlyHintsConfig->isMember("pages")) {
+        const auto &pages = (*earlyHintsConfig)["pages"];
+        if (!pages.isObject()) {
+            throw std::runtime_error(
+                "HydraSsrPlugin config 'early_hints.pages' must be an object keyed by pageId");
+        }
+        for (const auto &pageId : pages.getMemberNames()) {
+            const auto &page = pages[pageId];
+            const auto path = "early_hints.pages." + pageId;
+            auto keys = page.isString() ? std::vector<std::string>{trimAsciiWhitespace(
+                                              page.asString())}
+                                        : readStringList(page, path);
+            keys.erase(std::remove(keys.begin(), keys.end(), std::string{}), keys.end());
+            if (keys.empty()) {
+                throw std::runtime_error("HydraSsrPlugin config '" + path +
+                                         "' must name at least one manifest key");
+            }
+            normalized.earlyHintsPages[pageId] = std::move(keys);
+        }
+    }
+
+    const Json::Value *criticalCssConfig =
+        config.isMember("critical_css") && config["critical_css"].isObject()
+            ? &config["critical_css"]
+            : nullptr;
+    if (criticalCssConfig != nullptr) {
+        static const std::unordered_set<std::string> knownCriticalCssKeys = {
+            "enabled",
+            "max_bytes",
+            "cache_entries",
+        };
+        for (const auto &key : criticalCssConfig->getMemberNames()) {
+            if (knownCriticalCssKeys.find(key) == knownCriticalCssKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'critical_css." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.criticalCssEnabled =
+        readNestedBool(criticalCssConfig, config, "enabled", "critical_css_enabled", false);
+    normalized.criticalCssMaxBytes = readNestedUInt64(
+        criticalCssConfig, config, "max_bytes", "critical_css_max_bytes",
+        normalized.criticalCssMaxBytes);
+    if (normalized.criticalCssMaxBytes < kMinCriticalCssBytes ||
+        normalized.criticalCssMaxBytes > kMaxCriticalCssBytes) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'critical_css.max_bytes' must be in range 1024..1048576");
+    }
+    normalized.criticalCssCacheEntries = readNestedUInt64(
+        criticalCssConfig, config, "cache_entries", "critical_css_cache_entries",
+        normalized.criticalCssCacheEntries);
+    if (normalized.criticalCssCacheEntries < 1 ||
+        normalized.criticalCssCacheEntries > kMaxCriticalCssCacheEntries) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'critical_css.cache_entries' must be in range 1..65536");
+    }
+
+    const Json::Value *etagConfig =
+        config.isMember("etag") && config["etag"].isObject() ? &config["etag"] : nullptr;
+    if (etagConfig != nullptr) {
+        static const std::unordered_set<std::string> knownEtagKeys = {
+            "enabled",
+        };
+        for (const auto &key : etagConfig->getMemberNames()) {
+            if (knownEtagKeys.find(key) == knownEtagKeys.end()) {
+                throw std::runtime_error(
+                    "HydraSsrPlugin config 'etag." + key + "' is not supported");
+            }
+        }
+    }
+    normalized.etagEnabled = readNestedBool(etagConfig, config, "enabled", "etag_enabled", false);
+
     const Json::Value *devModeConfig =
         config.isMember("dev_mode") && config["dev_mode"].isObject() ? &config["dev_mode"]
                                                                        : nullptr;
@@ -305,6 +1335,14 @@ HydraSsrPluginConfig validateAndNormalizeHydraSsrPluginConfig(const Json::Value
         throw std::runtime_error(
             "HydraSsrPlugin config 'render_timeout_ms' must be in range 1..120000");
     }
+    if (normalized.renderThreads > kMaxRenderThreads) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_threads' must be in range 0..1024");
+    }
+    if (normalized.renderQueueMax > kMaxRenderQueue) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'render_queue_max' must be in range 0..1000000");
+    }
 
     if (normalized.devModeEnabled) {
         if (!hasHttpScheme(trimAsciiWhitespace(normalized.devProxyOrigin))) {
@@ -345,7 +1383,111 @@ std::string summarizeHydraSsrPluginConfig(const HydraSsrPluginConfig &config) {
     out << "runtime{title=" << config.shellTitle
         << ", bundle=" << config.ssrBundlePath
         << ", timeout_ms{acquire=" << config.acquireTimeoutMs
-        << ", render=" << config.renderTimeoutMs << "}}"
+        << ", render=" << config.renderTimeoutMs << "}"
+        << ", render_threads="
+        << (config.renderThreads == 0 ? std::string("pool") : std::to_string(config.renderThreads))
+        << ", render_queue_max="
+        << (config.renderQueueMax == 0 ? std::string("unbounded")
+                                       : std::to_string(config.renderQueueMax))
+        << ", pool=";
+    const auto poolMin = config.poolMin > 0 ? config.poolMin : config.poolSize;
+    out << (poolMin > 0 ? std::to_string(poolMin) : std::string("threads"));
+    if (config.poolMax > 0) {
+        out << ".." << config.poolMax;
+    }
+    if (!config.poolThreadAffinity) {
+        out << " unpinned";
+    }
+    out << ", warmup=";
+    if (config.warmupEnabled) {
+        out << "on{routes=" << config.warmupRoutes.size()
+            << ", iterations=" << config.warmupIterations << "}";
+    } else {
+        out << "off";
+    }
+    out << ", admission=" << (config.admissionEnabled ? "on" : "off");
+    out << ", route_metrics="
+        << (config.metricsMaxRoutes == 0 ? std::string("off")
+                                         : std::to_string(config.metricsMaxRoutes));
+    out << ", tracing=";
+    if (config.tracingEnabled) {
+        out << "on{sample_rate=" << config.tracingSampleRate
+            << ", server_timing=" << (config.tracingServerTiming ? "on" : "off")
+            << ", otlp=" << (config.tracingOtlpEndpoint.empty() ? "off" : "on") << "}";
+    } else {
+        out << "off";
+    }
+    out << ", snapshot=" << (config.v8SnapshotEnabled ? "on" : "off")
+        << ", code_cache="
+        << (!config.v8CodeCacheEnabled ? "off"
+                                       : (config.v8CodeCachePersist ? "persist" : "memory"))
+        << ", hot_reload="
+        << (!config.hotReloadEnabled
+                ? std::string("off")
+                : "on{watch=" + std::string(config.hotReloadWatch ? "on" : "off") +
+                      ", signal=" + (config.hotReloadSignal ? "on" : "off") + "}")
+        << ", heap_mb=" << (config.v8HeapMaxMb == 0 ? std::string("default")
+                                                     : std::to_string(config.v8HeapMaxMb))
+        << ", render_cache=";
+    if (config.renderCacheEnabled) {
+        out << "on{max_bytes=" << config.renderCacheMaxBytes
+            << ", shards=" << config.renderCacheShards
+            << ", ttl_ms=" << config.renderCacheDefaultPolicy.ttlMs
+            << ", pages=" << config.renderCachePages.size();
+        if (config.renderCacheSharedEnabled) {
+            out << ", shared=redis{client=" << config.renderCacheSharedRedisClient
+                << ", prefix=" << config.renderCacheSharedKeyPrefix
+                << ", timeout_ms=" << config.renderCacheSharedTimeoutMs << "}";
+        }
+        out << "}";
+    } else {
+        out << "off";
+    }
+    out << ", prerender=";
+    if (config.prerenderEnabled) {
+        out << "on{routes=" << config.prerenderRoutes.size()
+            << ", revalidate_s=" << config.prerenderRevalidateSec
+            << ", dir=" << config.prerenderOutputDir << "}";
+    } else {
+        out << "off";
+    }
+    out << ", compression=";
+    if (config.compressionEnabled) {
+        out << "on{gzip=";
+        if (config.compressionGzip) {
+            out << config.compressionGzipLevel;
+        } else {
+            out << "off";
+        }
+        out << ", brotli=";
+        if (config.compressionBrotli) {
+            out << config.compressionBrotliQuality;
+        } else {
+            out << "off";
+        }
+        out << ", min_bytes=" << config.compressionMinBytes << "}";
+    } else {
+        out << "off";
+    }
+    out << ", early_hints=";
+    if (config.earlyHintsEnabled) {
+        out << "on{html_tags=" << (config.earlyHintsHtmlTags ? "on" : "off")
+            << ", max_links=" << config.earlyHintsMaxLinks
+            << ", pages=" << config.earlyHintsPages.size() << "}";
+    } else {
+        out << "off";
+    }
+    out << ", critical_css=";
+    if (config.criticalCssEnabled) {
+        out << "on{max_bytes=" << config.criticalCssMaxBytes
+            << ", cache_entries=" << config.criticalCssCacheEntries << "}";
+    } else {
+        out << "off";
+    }
+    out << ", etag=" << (config.etagEnabled ? "on" : "off");
+    out << ", render_log{sample_rate=" << config.renderLogSampleRate
+        << ", slow_ms=" << config.renderLogSlowMs << "}";
+    out << "}"
         << " | assets{mode=" << config.resolvedAssetMode
         << ", configured=" << assetModeName(config.configuredAssetMode)
         << ", manifest=" << config.assetManifestPath
@@ -0,0 +1,582 @@
+#include "hydra/CriticalCss.h"
+
+#include "hydra/Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace hydra {
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+bool isHexDigit(char c) {
+    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+std::uint32_t hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return static_cast<std::uint32_t>(c - '0');
+    }
+    return static_cast<std::uint32_t>(std::tolower(static_cast<unsigned char>(c)) - 'a' + 10);
+}
+
+bool isIdentChar(char c) {
+    const auto byte = static_cast<unsigned char>(c);
+    return std::isalnum(byte) != 0 || c == '-' || c == '_' || byte >= 0x80;
+}
+
+void appendUtf8(std::string &out, std::uint32_t codepoint) {
+    if (codepoint == 0 || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+        codepoint = 0xFFFD;
+    }
+    if (codepoint < 0x80) {
+        out.push_back(static_cast<char>(codepoint));
+    } else if (codepoint < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else if (codepoint < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+// Moves `pos` past a comment or string starting at it; false when neither
+// starts there.
+bool skipCommentOrString(std::string_view css, std::size_t &pos, std::size_t end) {
+    if (css[pos] == '/' && pos + 1 < end && css[pos + 1] == '*') {
+        const auto close = css.find("*/", pos + 2);
+        pos = close == std::string_view::npos || close + 2 > end ? end : close + 2;
+        return true;
+    }
+    if (css[pos] == '"' || css[pos] == '\'') {
+        const char quote = css[pos++];
+        while (pos < end && css[pos] != quote) {
+            pos += css[pos] == '\\' ? 2 : 1;
+        }
+        pos = std::min(pos + 1, end);
+        return true;
+    }
+    return false;
+}
+
+// First of `stops` at bracket depth 0 in [pos, end), or end.
+std::size_t findDelimiter(std::string_view css,
+                          std::size_t pos,
+                          std::size_t end,
+                          std::string_view stops) {
+    int depth = 0;
+    while (pos < end) {
+        if (skipCommentOrString(css, pos, end)) {
+            continue;
+        }
+        const char c = css[pos];
+        if (c == '\\') {
+            pos += 2;
+            continue;
+        }
+        if (c == '(' || c == '[') {
+            ++depth;
+        } else if ((c == ')' || c == ']') && depth > 0) {
+            --depth;
+        } else if (depth == 0 && stops.find(c) != std::string_view::npos) {
+            return pos;
+        }
+        ++pos;
+    }
+    return end;
+}
+
+// The `}` closing a block whose contents start at `pos`, or end.
+std::size_t matchingBrace(std::string_view css, std::size_t pos, std::size_t end) {
+    int depth = 0;
+    while (pos < end) {
+        if (skipCommentOrString(css, pos, end)) {
+            continue;
+        }
+        const char c = css[pos];
+        if (c == '\\') {
+            pos += 2;
+            continue;
+        }
+        if (c == '{') {
+            ++depth;
+        } else if (c == '}') {
+            if (depth == 0) {
+                return pos;
+            }
+            --depth;
+        }
+        ++pos;
+    }
+    return end;
+}
+
+// Drops comments and collapses whitespace outside strings, keeping a space
+// only where it can matter (descendant combinators, the value of `--x: ;`). "</" becomes
+// "<\/" so the text can never close the <style> element it is inlined in.
+std::string compact(std::string_view css) {
+    std::string out;
+    out.reserve(css.size());
+    bool pendingSpace = false;
+    std::size_t pos = 0;
+    while (pos < css.size()) {
+        const char c = css[pos];
+        if (c == '/' && pos + 1 < css.size() && css[pos + 1] == '*') {
+            const auto close = css.find("*/", pos + 2);
+            pos = close == std::string_view::npos ? css.size() : close + 2;
+            pendingSpace = pendingSpace || !out.empty();
+            continue;
+        }
+        if (isSpace(c)) {
+            pendingSpace = !out.empty();
+            ++pos;
+            continue;
+        }
+        if (pendingSpace) {
+            const char last = out.back();
+            const bool dropAfter = last == '{' || last == '}' || last == ';' || last == ',' ||
+                                   (last == ':' && c != ';' && c != '}');
+            const bool dropBefore = c == '{' || (c == '}' && last != ':') || c == ',';
+            if (!dropAfter && !dropBefore) {
+                out.push_back(' ');
+            }
+            pendingSpace = false;
+        }
+        if (c == '"' || c == '\'') {
+            auto stringEnd = pos;
+            skipCommentOrString(css, stringEnd, css.size());
+            out.append(css.substr(pos, stringEnd - pos));
+            pos = stringEnd;
+            continue;
+        }
+        if (c == '\\' && pos + 1 < css.size()) {
+            out.append(css.substr(pos, 2));
+            pos += 2;
+            continue;
+        }
+        out.push_back(c);
+        ++pos;
+    }
+    for (auto slash = out.find("</"); slash != std::string::npos; slash = out.find("</", slash)) {
+        out.insert(slash + 1, 1, '\\');
+        slash += 3;
+    }
+    return out;
+}
+
+// Reads the class name after the `.` at `pos`, resolving CSS escapes
+// (`.md\:flex`, `.\32xl`); `pos` ends past it.
+std::string readClassName(std::string_view selector, std::size_t &pos) {
+    std::string name;
+    while (pos < selector.size()) {
+        const char c = selector[pos];
+        if (c == '\\' && pos + 1 < selector.size()) {
+            if (!isHexDigit(selector[pos + 1])) {
+                name.push_back(selector[pos + 1]);
+                pos += 2;
+                continue;
+            }
+            std::uint32_t codepoint = 0;
+            std::size_t digits = 0;
+            ++pos;
+            while (pos < selector.size() && digits < 6 && isHexDigit(selector[pos])) {
+                codepoint = codepoint * 16 + hexValue(selector[pos]);
+                ++pos;
+                ++digits;
+            }
+            if (pos < selector.size() && isSpace(selector[pos])) {
+                ++pos;
+            }
+            appendUtf8(name, codepoint);
+            continue;
+        }
+        if (!isIdentChar(c)) {
+            break;
+        }
+        name.push_back(c);
+        ++pos;
+    }
+    return name;
+}
+
+// Class names one complex selector requires; those inside (...) and [...]
+// are left out.
+std::vector<std::string> requiredClasses(std::string_view selector) {
+    std::vector<std::string> classes;
+    int depth = 0;
+    std::size_t pos = 0;
+    while (pos < selector.size()) {
+        if (skipCommentOrString(selector, pos, selector.size())) {
+            continue;
+        }
+        const char c = selector[pos];
+        if (c == '\\') {
+            pos += 2;
+            continue;
+        }
+        if (c == '(' || c == '[') {
+            ++depth;
+        } else if ((c == ')' || c == ']') && depth > 0) {
+            --depth;
+        } else if (c == '.' && depth == 0) {
+            ++pos;
+            if (auto name = readClassName(selector, pos); !name.empty()) {
+                classes.push_back(std::move(name));
+            }
+            continue;
+        }
+        ++pos;
+    }
+    return classes;
+}
+
+bool isConditionalAtRule(std::string_view name) {
+    static constexpr std::array<std::string_view, 4> kConditional = {
+        "media", "supports", "layer", "container"};
+    return std::find(kConditional.begin(), kConditional.end(), name) != kConditional.end();
+}
+
+void decodeEntities(std::string_view token, std::string &out) {
+    out.clear();
+    std::size_t pos = 0;
+    while (pos < token.size()) {
+        const auto semicolon =
+            token[pos] == '&' ? token.find(';', pos) : std::string_view::npos;
+        if (semicolon == std::string_view::npos) {
+            out.push_back(token[pos++]);
+            continue;
+        }
+        const auto entity = token.substr(pos + 1, semicolon - pos - 1);
+        if (entity == "amp") {
+            out.push_back('&');
+        } else if (entity == "lt") {
+            out.push_back('<');
+        } else if (entity == "gt") {
+            out.push_back('>');
+        } else if (entity == "quot") {
+            out.push_back('"');
+        } else if (entity.size() > 1 && entity.front() == '#') {
+            const bool hex = entity[1] == 'x' || entity[1] == 'X';
+            const auto digits = entity.substr(hex ? 2 : 1);
+            std::uint32_t codepoint = 0;
+            bool valid = !digits.empty() && digits.size() <= 7;
+            for (const char c : digits) {
+                if (hex ? !isHexDigit(c) : std::isdigit(static_cast<unsigned char>(c)) == 0) {
+                    valid = false;
+                    break;
+                }
+                codepoint = codepoint * (hex ? 16 : 10) + hexValue(c);
+            }
+            if (!valid) {
+                out.push_back(token[pos++]);
+                continue;
+            }
+            appendUtf8(out, codepoint);
+        } else {
+            out.push_back(token[pos++]);
+            continue;
+        }
+        pos = semicolon + 1;
+    }
+}
+
+}  // namespace
+
+CriticalCss::CriticalCss(std::string_view stylesheet, Options options)
+    : options_(options) {
+    groups_.push_back(Group{});
+    parseBlock(stylesheet, 0, stylesheet.size(), 0);
+}
+
+std::unique_ptr<CriticalCss> CriticalCss::load(const std::filesystem::path &path,
+                                               Options options) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Stylesheet not found: " + path.string());
+    }
+    std::ostringstream css;
+    css << input.rdbuf();
+    return std::make_unique<CriticalCss>(css.str(), options);
+}
+
+void CriticalCss::parseBlock(std::string_view css,
+                             std::size_t begin,
+                             std::size_t end,
+                             std::uint32_t group) {
+    auto pos = begin;
+    while (pos < end) {
+        if (isSpace(css[pos])) {
+            ++pos;
+            continue;
+        }
+        if (skipCommentOrString(css, pos, end)) {
+            continue;
+        }
+        if (css[pos] == '}' || css[pos] == ';') {
+            ++pos;
+            continue;
+        }
+
+        const auto stop = findDelimiter(css, pos, end, "{;");
+        if (css[pos] == '@') {
+            auto nameEnd = pos + 1;
+            while (nameEnd < stop && isIdentChar(css[nameEnd])) {
+                ++nameEnd;
+            }
+            std::string name(css.substr(pos + 1, nameEnd - pos - 1));
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            if (stop == end || css[stop] == ';') {
+                // @import, @charset, `@layer a, b;`: statements kept as-is.
+                addAlways(compact(css.substr(pos, stop - pos)) + ";", group);
+                pos = stop + 1;
+                continue;
+            }
+            const auto close = matchingBrace(css, stop + 1, end);
+            if (isConditionalAtRule(name)) {
+                groups_.push_back(Group{compact(css.substr(pos, stop - pos)), group});
+                parseBlock(css, stop + 1, close, static_cast<std::uint32_t>(groups_.size() - 1));
+            } else {
+                addAlways(compact(css.substr(pos, stop - pos)) + "{" +
+                              compact(css.substr(stop + 1, close - stop - 1)) + "}",
+                          group);
+            }
+            pos = close + 1;
+            continue;
+        }
+
+        if (stop == end) {
+            break;
+        }
+        if (css[stop] == ';') {
+            pos = stop + 1;
+            continue;
+        }
+        const auto close = matchingBrace(css, stop + 1, end);
+        addRule(css.substr(pos, stop - pos), css.substr(stop + 1, close - stop - 1), group);
+        pos = close + 1;
+    }
+}
+
+void CriticalCss::addRule(std::string_view selector, std::string_view body, std::uint32_t group) {
+    auto selectorText = compact(selector);
+    if (selectorText.empty()) {
+        return;
+    }
+    std::vector<std::vector<std::string>> selectors;
+    std::size_t pos = 0;
+    while (pos <= selectorText.size()) {
+        const auto comma = findDelimiter(selectorText, pos, selectorText.size(), ",");
+        auto classes = requiredClasses(std::string_view(selectorText).substr(pos, comma - pos));
+        if (classes.empty()) {
+            addAlways(selectorText + "{" + compact(body) + "}", group);
+            return;
+        }
+        selectors.push_back(std::move(classes));
+        pos = comma + 1;
+    }
+
+    Rule rule;
+    rule.text = selectorText + "{" + compact(body) + "}";
+    rule.group = group;
+    const auto ruleId = static_cast<std::uint32_t>(rules_.size());
+    for (auto &names : selectors) {
+        std::vector<std::uint32_t> ids;
+        ids.reserve(names.size());
+        for (auto &name : names) {
+            ids.push_back(internClass(std::move(name)));
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        auto &candidates = rulesByClass_[ids.front()];
+        if (candidates.empty() || candidates.back() != ruleId) {
+            candidates.push_back(ruleId);
+        }
+        rule.selectors.push_back(std::move(ids));
+    }
+    rules_.push_back(std::move(rule));
+}
+
+void CriticalCss::addAlways(std::string text, std::uint32_t group) {
+    alwaysRules_.push_back(static_cast<std::uint32_t>(rules_.size()));
+    Rule rule;
+    rule.text = std::move(text);
+    rule.group = group;
+    rules_.push_back(std::move(rule));
+}
+
+std::uint32_t CriticalCss::internClass(std::string name) {
+    if (const auto it = classIds_.find(name); it != classIds_.end()) {
+        return it->second;
+    }
+    const auto id = static_cast<std::uint32_t>(classNames_.size());
+    classNames_.push_back(name);
+    classIds_.emplace(std::move(name), id);
+    rulesByClass_.emplace_back();
+    return id;
+}
+
+void CriticalCss::forEachClass(std::string_view html,
+                               const std::function<void(std::string_view)> &visit) {
+    static constexpr std::string_view kAttribute = "class=";
+    std::string decoded;
+    std::size_t pos = 0;
+    while ((pos = html.find(kAttribute, pos)) != std::string_view::npos) {
+        const bool attributeStart = pos > 0 && isSpace(html[pos - 1]);
+        pos += kAttribute.size();
+        if (!attributeStart || pos >= html.size() || (html[pos] != '"' && html[pos] != '\'')) {
+            continue;
+        }
+        const auto valueEnd = html.find(html[pos], pos + 1);
+        if (valueEnd == std::string_view::npos) {
+            return;
+        }
+        const auto value = html.substr(pos + 1, valueEnd - pos - 1);
+        std::size_t tokenStart = 0;
+        while (tokenStart < value.size()) {
+            if (isSpace(value[tokenStart])) {
+                ++tokenStart;
+                continue;
+            }
+            auto tokenEnd = tokenStart;
+            while (tokenEnd < value.size() && !isSpace(value[tokenEnd])) {
+                ++tokenEnd;
+            }
+            const auto token = value.substr(tokenStart, tokenEnd - tokenStart);
+            if (token.find('&') == std::string_view::npos) {
+                visit(token);
+            } else {
+                decodeEntities(token, decoded);
+                visit(decoded);
+            }
+            tokenStart = tokenEnd;
+        }
+        pos = valueEnd + 1;
+    }
+}
+
+std::shared_ptr<const std::string> CriticalCss::rulesFor(std::string_view pageId,
+                                                         std::string_view appHtml,
+                                                         Source *source) const {
+    const auto pageKey = hash64(appHtml, hash64(pageId));
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (const auto it = byPage_.find(pageKey); it != byPage_.end()) {
+            if (source != nullptr) {
+                *source = Source::kPage;
+            }
+            return it->second;
+        }
+    }
+
+    std::vector<std::uint32_t> classIds;
+    forEachClass(appHtml, [&](std::string_view token) {
+        if (const auto it = classIds_.find(token); it != classIds_.end()) {
+            classIds.push_back(it->second);
+        }
+    });
+    std::sort(classIds.begin(), classIds.end());
+    classIds.erase(std::unique(classIds.begin(), classIds.end()), classIds.end());
+    const auto classSetKey = hash64(std::string_view(reinterpret_cast<const char *>(classIds.data()),
+                                                     classIds.size() * sizeof(std::uint32_t)));
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (const auto it = byClassSet_.find(classSetKey); it != byClassSet_.end()) {
+            auto selection = it->second;
+            remember(byPage_, pageKey, selection);
+            if (source != nullptr) {
+                *source = Source::kClassSet;
+            }
+            return selection;
+        }
+    }
+
+    auto selection = select(classIds);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        remember(byClassSet_, classSetKey, selection);
+        remember(byPage_, pageKey, selection);
+    }
+    if (source != nullptr) {
+        *source = Source::kSelected;
+    }
+    return selection;
+}
+
+CriticalCss::Selection CriticalCss::select(const std::vector<std::uint32_t> &classIds) const {
+    std::vector<bool> present(classNames_.size(), false);
+    for (const auto id : classIds) {
+        present[id] = true;
+    }
+    std::vector<std::uint32_t> matched = alwaysRules_;
+    for (const auto id : classIds) {
+        for (const auto ruleId : rulesByClass_[id]) {
+            const auto &selectors = rules_[ruleId].selectors;
+            if (std::any_of(selectors.begin(), selectors.end(), [&](const auto &required) {
+                    return std::all_of(required.begin(), required.end(),
+                                       [&](std::uint32_t classId) { return present[classId]; });
+                })) {
+                matched.push_back(ruleId);
+            }
+        }
+    }
+    std::sort(matched.begin(), matched.end());
+    matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+
+    std::string css;
+    std::vector<std::uint32_t> open;
+    std::vector<std::uint32_t> chain;
+    for (const auto ruleId : matched) {
+        const auto &rule = rules_[ruleId];
+        chain.clear();
+        for (auto group = rule.group; group != 0; group = groups_[group].parent) {
+            chain.push_back(group);
+        }
+        std::reverse(chain.begin(), chain.end());
+        std::size_t common = 0;
+        while (common < open.size() && common < chain.size() && open[common] == chain[common]) {
+            ++common;
+        }
+        for (; open.size() > common; open.pop_back()) {
+            css.push_back('}');
+        }
+        for (; open.size() < chain.size(); open.push_back(chain[open.size()])) {
+            css.append(groups_[chain[open.size()]].prelude);
+            css.push_back('{');
+        }
+        css.append(rule.text);
+        if (css.size() > options_.maxBytes) {
+            return nullptr;
+        }
+    }
+    css.append(open.size(), '}');
+    if (css.size() > options_.maxBytes) {
+        return nullptr;
+    }
+    return std::make_shared<const std::string>(std::move(css));
+}
+
+void CriticalCss::remember(SelectionCache &cache,
+                           std::uint64_t key,
+                           const Selection &value) const {
+    if (cache.size() >= options_.cacheEntries && cache.find(key) == cache.end()) {
+        cache.erase(cache.begin());
+    }
+    cache[key] = value;
+}
+
+}  // namespace hydra
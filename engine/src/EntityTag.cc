@@ -0,0 +1,64 @@
+#include "hydra/EntityTag.h"
+
+#include "hydra/Hash.h"
+
+namespace hydra {
+namespace {
+
+std::string_view opaqueTag(std::string_view etag) {
+    if (etag.size() >= 2 && etag[0] == 'W' && etag[1] == '/') {
+        etag.remove_prefix(2);
+    }
+    return etag;
+}
+
+bool isSpace(char ch) {
+    return ch == ' ' || ch == '\t';
+}
+
+}  // namespace
+
+std::string weakEntityTag(std::uint64_t digest) {
+    return "W/\"" + hashToHex(digest) + "\"";
+}
+
+bool ifNoneMatchMatches(std::string_view ifNoneMatch, std::string_view etag) {
+    const auto wanted = opaqueTag(etag);
+    if (wanted.empty()) {
+        return false;
+    }
+    std::size_t pos = 0;
+    while (pos < ifNoneMatch.size()) {
+        while (pos < ifNoneMatch.size() && (isSpace(ifNoneMatch[pos]) || ifNoneMatch[pos] == ',')) {
+            ++pos;
+        }
+        if (pos >= ifNoneMatch.size()) {
+            break;
+        }
+        if (ifNoneMatch[pos] == '*') {
+            return true;
+        }
+        if (ifNoneMatch.compare(pos, 2, "W/") == 0) {
+            pos += 2;
+        }
+        if (pos < ifNoneMatch.size() && ifNoneMatch[pos] == '"') {
+            const auto close = ifNoneMatch.find('"', pos + 1);
+            if (close == std::string_view::npos) {
+                break;
+            }
+            if (ifNoneMatch.substr(pos, close + 1 - pos) == wanted) {
+                return true;
+            }
+            pos = close + 1;
+        }
+        // Skip the rest of the member, well-formed or not.
+        const auto comma = ifNoneMatch.find(',', pos);
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        pos = comma + 1;
+    }
+    return false;
+}
+
+}  // namespace hydra
@@ -0,0 +1,477 @@
+#include "hydra/HtmlEscape.h"
+
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HYDRA_ESCAPE_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define HYDRA_ESCAPE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(HYDRA_ESCAPE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define HYDRA_ESCAPE_AVX2 1
+#define HYDRA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace hydra::html_escape {
+namespace {
+
+constexpr std::size_t kModeCount = 4;
+// Largest special-byte set of any mode (JsString).
+constexpr std::size_t kMaxNeedles = 6;
+
+constexpr std::size_t modeIndex(Mode mode) {
+    return static_cast<std::size_t>(mode);
+}
+
+constexpr std::size_t byteIndex(char ch) {
+    return static_cast<unsigned char>(ch);
+}
+
+constexpr std::string_view replacementFor(Mode mode, char ch) {
+    switch (mode) {
+        case Mode::HtmlText:
+        case Mode::HtmlAttribute:
+            switch (ch) {
+                case '&':
+                    return "&amp;";
+                case '<':
+                    return "&lt;";
+                case '>':
+                    return "&gt;";
+                case '"':
+                    return mode == Mode::HtmlAttribute ? "&quot;" : std::string_view{};
+                default:
+                    return {};
+            }
+        case Mode::ScriptTag:
+            switch (ch) {
+                case '&':
+                    return "\\u0026";
+                case '<':
+                    return "\\u003c";
+                case '>':
+                    return "\\u003e";
+                default:
+                    return {};
+            }
+        case Mode::JsString:
+            switch (ch) {
+                case '\\':
+                    return "\\\\";
+                case '"':
+                    return "\\\"";
+                case '\n':
+                    return "\\n";
+                case '\r':
+                    return "\\r";
+                case '\t':
+                    return "\\t";
+                case '<':
+                    return "\\u003c";
+                default:
+                    return {};
+            }
+    }
+    return {};
+}
+
+// Extra output bytes per input byte; a branch-free sum gives the exact size.
+using ExtraTable = std::array<std::array<std::uint8_t, 256>, kModeCount>;
+
+constexpr ExtraTable kExtra = [] {
+    ExtraTable table{};
+    for (std::size_t mode = 0; mode < kModeCount; ++mode) {
+        for (std::size_t byte = 0; byte < 256; ++byte) {
+            const auto replacement =
+                replacementFor(static_cast<Mode>(mode), static_cast<char>(byte));
+            table[mode][byte] =
+                replacement.empty() ? 0 : static_cast<std::uint8_t>(replacement.size() - 1);
+        }
+    }
+    return table;
+}();
+
+// Special bytes of a mode for the vector kernels, padded to kMaxNeedles by
+// repeating the first byte with zero extra so every kernel compares a fixed
+// number of needles.
+struct Needles {
+    std::array<char, kMaxNeedles> bytes{};
+    std::array<std::uint8_t, kMaxNeedles> extra{};
+};
+
+constexpr std::array<Needles, kModeCount> kNeedles = [] {
+    std::array<Needles, kModeCount> needles{};
+    for (std::size_t mode = 0; mode < kModeCount; ++mode) {
+        std::size_t count = 0;
+        for (std::size_t byte = 0; byte < 256; ++byte) {
+            if (kExtra[mode][byte] != 0) {
+                needles[mode].bytes[count] = static_cast<char>(byte);
+                needles[mode].extra[count] = kExtra[mode][byte];
+                ++count;
+            }
+        }
+        for (std::size_t i = count; i < kMaxNeedles; ++i) {
+            needles[mode].bytes[i] = needles[mode].bytes[0];
+            needles[mode].extra[i] = 0;
+        }
+    }
+    return needles;
+}();
+
+// Appends [data, data + size) escaped for `mode`.
+using AppendFn = void (*)(std::string &out, const char *data, std::size_t size, Mode mode);
+// Sum of kExtra over [data, data + size).
+using ExtraFn = std::size_t (*)(const char *data, std::size_t size, Mode mode);
+
+struct KernelOps {
+    AppendFn append = nullptr;
+    ExtraFn extra = nullptr;
+};
+
+std::size_t scalarExtra(const char *data, std::size_t size, Mode mode) {
+    const auto &extra = kExtra[modeIndex(mode)];
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        total += extra[byteIndex(data[i])];
+    }
+    return total;
+}
+
+// Reference implementation: one byte at a time.
+void scalarAppend(std::string &out, const char *data, std::size_t size, Mode mode) {
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto replacement = replacementFor(mode, data[i]);
+        if (replacement.empty()) {
+            out.push_back(data[i]);
+        } else {
+            out.append(replacement);
+        }
+    }
+}
+
+// Vector kernels keep a pending clean run starting at `runStart` and flush it
+// only at special bytes, so clean input is copied in as few appends as
+// possible. `mask` has one set bit per special byte of the block at `block`,
+// `kBitsPerByte` mask bits per input byte.
+template <unsigned kBitsPerByte, typename Mask>
+std::size_t emitHits(std::string &out,
+                     const char *data,
+                     std::size_t block,
+                     Mask mask,
+                     std::size_t runStart,
+                     Mode mode) {
+    while (mask != 0) {
+        const auto pos = block + static_cast<std::size_t>(std::countr_zero(mask)) / kBitsPerByte;
+        out.append(data + runStart, pos - runStart);
+        out.append(replacementFor(mode, data[pos]));
+        runStart = pos + 1;
+        mask &= mask - 1;
+    }
+    return runStart;
+}
+
+void appendTail(std::string &out,
+                const char *data,
+                std::size_t from,
+                std::size_t size,
+                std::size_t runStart,
+                Mode mode) {
+    const auto &extra = kExtra[modeIndex(mode)];
+    for (auto i = from; i < size; ++i) {
+        if (extra[byteIndex(data[i])] == 0) {
+            continue;
+        }
+        out.append(data + runStart, i - runStart);
+        out.append(replacementFor(mode, data[i]));
+        runStart = i + 1;
+    }
+    out.append(data + runStart, size - runStart);
+}
+
+#if defined(HYDRA_ESCAPE_X86)
+
+// SSE2 is part of the x86-64 baseline, so this needs no target attribute.
+void sse2Append(std::string &out, const char *data, std::size_t size, Mode mode) {
+    const auto &needles = kNeedles[modeIndex(mode)];
+    __m128i bytes[kMaxNeedles];
+    for (std::size_t n = 0; n < kMaxNeedles; ++n) {
+        bytes[n] = _mm_set1_epi8(needles.bytes[n]);
+    }
+
+    std::size_t runStart = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto hits = _mm_cmpeq_epi8(block, bytes[0]);
+        for (std::size_t n = 1; n < kMaxNeedles; ++n) {
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, bytes[n]));
+        }
+        if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits)); mask != 0) {
+            runStart = emitHits<1>(out, data, i, mask, runStart, mode);
+        }
+    }
+    appendTail(out, data, i, size, runStart, mode);
+}
+
+std::size_t sse2Extra(const char *data, std::size_t size, Mode mode) {
+    const auto &needles = kNeedles[modeIndex(mode)];
+    __m128i bytes[kMaxNeedles];
+    __m128i extra[kMaxNeedles];
+    for (std::size_t n = 0; n < kMaxNeedles; ++n) {
+        bytes[n] = _mm_set1_epi8(needles.bytes[n]);
+        extra[n] = _mm_set1_epi8(static_cast<char>(needles.extra[n]));
+    }
+
+    const auto zero = _mm_setzero_si128();
+    auto total = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto weights = _mm_and_si128(_mm_cmpeq_epi8(block, bytes[0]), extra[0]);
+        for (std::size_t n = 1; n < kMaxNeedles; ++n) {
+            weights = _mm_or_si128(weights,
+                                   _mm_and_si128(_mm_cmpeq_epi8(block, bytes[n]), extra[n]));
+        }
+        // Horizontal byte sums into the two 64-bit lanes.
+        total = _mm_add_epi64(total, _mm_sad_epu8(weights, zero));
+    }
+
+    const auto lanes =
+        static_cast<std::size_t>(_mm_cvtsi128_si64(total)) +
+        static_cast<std::size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total)));
+    return lanes + scalarExtra(data + i, size - i, mode);
+}
+
+#endif
+
+#if defined(HYDRA_ESCAPE_AVX2)
+
+HYDRA_TARGET_AVX2 void avx2Append(std::string &out,
+                                   const char *data,
+                                   std::size_t size,
+                                   Mode mode) {
+    const auto &needles = kNeedles[modeIndex(mode)];
+    __m256i bytes[kMaxNeedles];
+    for (std::size_t n = 0; n < kMaxNeedles; ++n) {
+        bytes[n] = _mm256_set1_epi8(needles.bytes[n]);
+    }
+
+    std::size_t runStart = 0;
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        auto hits = _mm256_cmpeq_epi8(block, bytes[0]);
+        for (std::size_t n = 1; n < kMaxNeedles; ++n) {
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, bytes[n]));
+        }
+        if (const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(hits)); mask != 0) {
+            runStart = emitHits<1>(out, data, i, mask, runStart, mode);
+        }
+    }
+    appendTail(out, data, i, size, runStart, mode);
+}
+
+HYDRA_TARGET_AVX2 std::size_t avx2Extra(const char *data, std::size_t size, Mode mode) {
+    const auto &needles = kNeedles[modeIndex(mode)];
+    __m256i bytes[kMaxNeedles];
+    __m256i extra[kMaxNeedles];
+    for (std::size_t n = 0; n < kMaxNeedles; ++n) {
+        bytes[n] = _mm256_set1_epi8(needles.bytes[n]);
+        extra[n] = _mm256_set1_epi8(static_cast<char>(needles.extra[n]));
+    }
+
+    const auto zero = _mm256_setzero_si256();
+    auto total = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        auto weights = _mm256_and_si256(_mm256_cmpeq_epi8(block, bytes[0]), extra[0]);
+        for (std::size_t n = 1; n < kMaxNeedles; ++n) {
+            weights = _mm256_or_si256(
+                weights, _mm256_and_si256(_mm256_cmpeq_epi8(block, bytes[n]), extra[n]));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(weights, zero));
+    }
+
+    const auto half = _mm_add_epi64(_mm256_castsi256_si128(total),
+                                    _mm256_extracti128_si256(total, 1));
+    const auto lanes =
+        static_cast<std::size_t>(_mm_cvtsi128_si64(half)) +
+        static_cast<std::size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half)));
+    return lanes + sse2Extra(data + i, size - i, mode);
+}
+
+#endif
+
+#if defined(HYDRA_ESCAPE_NEON)
+
+void neonAppend(std::string &out, const char *data, std::size_t size, Mode mode) {
+    const auto &needles = kNeedles[modeIndex(mode)];
+    uint8x16_t bytes[kMaxNeedles];
+    for (std::size_t n = 0; n < kMaxNeedles; ++n) {
+        bytes[n] = vdupq_n_u8(static_cast<std::uint8_t>(needles.bytes[n]));
+    }
+
+    std::size_t runStart = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto block = vld1q_u8(reinterpret_cast<const std::uint8_t *>(data + i));
+        auto hits = vceqq_u8(block, bytes[0]);
+        for (std::size_t n = 1; n < kMaxNeedles; ++n) {
+            hits = vorrq_u8(hits, vceqq_u8(block, bytes[n]));
+        }
+        // Narrow each 0x00/0xff byte to a nibble (a 64-bit mask, 4 bits per
+        // byte), then keep one bit per nibble for emitHits.
+        const auto mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        if (mask != 0) {
+            runStart = emitHits<4>(out, data, i, mask & 0x8888888888888888ULL, runStart, mode);
+        }
+    }
+    appendTail(out, data, i, size, runStart, mode);
+}
+
+std::size_t neonExtra(const char *data, std::size_t size, Mode mode) {
+    const auto &needles = kNeedles[modeIndex(mode)];
+    uint8x16_t bytes[kMaxNeedles];
+    uint8x16_t extra[kMaxNeedles];
+    for (std::size_t n = 0; n < kMaxNeedles; ++n) {
+        bytes[n] = vdupq_n_u8(static_cast<std::uint8_t>(needles.bytes[n]));
+        extra[n] = vdupq_n_u8(needles.extra[n]);
+    }
+
+    std::size_t total = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto block = vld1q_u8(reinterpret_cast<const std::uint8_t *>(data + i));
+        auto weights = vandq_u8(vceqq_u8(block, bytes[0]), extra[0]);
+        for (std::size_t n = 1; n < kMaxNeedles; ++n) {
+            weights = vorrq_u8(weights, vandq_u8(vceqq_u8(block, bytes[n]), extra[n]));
+        }
+        total += vaddlvq_u8(weights);
+    }
+    return total + scalarExtra(data + i, size - i, mode);
+}
+
+#endif
+
+Kernel detectKernel() {
+#if defined(HYDRA_ESCAPE_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return Kernel::Avx2;
+    }
+#endif
+#if defined(HYDRA_ESCAPE_X86)
+    return Kernel::Sse2;
+#elif defined(HYDRA_ESCAPE_NEON)
+    return Kernel::Neon;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+KernelOps opsFor(Kernel kernel) {
+    if (!kernelSupported(kernel)) {
+        throw std::runtime_error(std::string("html_escape kernel '") + kernelName(kernel) +
+                                 "' is not supported on this CPU");
+    }
+
+    switch (kernel) {
+#if defined(HYDRA_ESCAPE_X86)
+        case Kernel::Sse2:
+            return {sse2Append, sse2Extra};
+#endif
+#if defined(HYDRA_ESCAPE_AVX2)
+        case Kernel::Avx2:
+            return {avx2Append, avx2Extra};
+#endif
+#if defined(HYDRA_ESCAPE_NEON)
+        case Kernel::Neon:
+            return {neonAppend, neonExtra};
+#endif
+        default:
+            return {scalarAppend, scalarExtra};
+    }
+}
+
+const KernelOps &activeOps() {
+    static const KernelOps ops = opsFor(activeKernel());
+    return ops;
+}
+
+}  // namespace
+
+Kernel activeKernel() {
+    static const Kernel kernel = detectKernel();
+    return kernel;
+}
+
+bool kernelSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+        case Kernel::Sse2:
+#if defined(HYDRA_ESCAPE_X86)
+            return true;
+#else
+            return false;
+#endif
+        case Kernel::Avx2:
+#if defined(HYDRA_ESCAPE_AVX2)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case Kernel::Neon:
+#if defined(HYDRA_ESCAPE_NEON)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+const char *kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return "scalar";
+        case Kernel::Sse2:
+            return "sse2";
+        case Kernel::Avx2:
+            return "avx2";
+        case Kernel::Neon:
+            return "neon";
+    }
+    return "unknown";
+}
+
+std::size_t escapedSize(std::string_view value, Mode mode) {
+    return value.size() + activeOps().extra(value.data(), value.size(), mode);
+}
+
+std::size_t escapedSize(std::string_view value, Mode mode, Kernel kernel) {
+    return value.size() + opsFor(kernel).extra(value.data(), value.size(), mode);
+}
+
+void appendEscaped(std::string &out, std::string_view value, Mode mode) {
+    activeOps().append(out, value.data(), value.size(), mode);
+}
+
+void appendEscaped(std::string &out, std::string_view value, Mode mode, Kernel kernel) {
+    opsFor(kernel).append(out, value.data(), value.size(), mode);
+}
+
+std::string escape(std::string_view value, Mode mode) {
+    std::string out;
+    out.reserve(escapedSize(value, mode));
+    appendEscaped(out, value, mode);
+    return out;
+}
+
+}  // namespace hydra::html_escape
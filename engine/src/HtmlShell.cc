@@ -1,5 +1,9 @@
 #include "hydra/HtmlShell.h"
 
+#include "hydra/Hash.h"
+#include "hydra/HtmlEscape.h"
+
+#include <algorithm>
 #include <sstream>
 
 namespace hydra {
@@ -16,248 +20,525 @@ std::string deriveReactRefreshPath(const std::string &hmrClientPath) {
     return hmrClientPath.substr(0, suffixPos) + "/@react-refresh";
 }
 
-std::string escapeForJsString(std::string_view value) {
-    std::string escaped;
-    escaped.reserve(value.size());
-    for (const auto ch : value) {
-        switch (ch) {
-            case '\\':
-                escaped.append("\\\\");
-                break;
-            case '"':
-                escaped.append("\\\"");
+using html_escape::Mode;
+
+constexpr std::string_view kNonceOpen = " nonce=\"";
+constexpr std::string_view kStyleOpen = "    <style";
+constexpr std::string_view kStyleClose = "</style>\n";
+
+std::size_t nonceAttributeSize(std::string_view scriptNonce) {
+    return scriptNonce.empty() ? 0 : kNonceOpen.size() + scriptNonce.size() + 1;
+}
+
+void appendNonceAttribute(std::string &out, std::string_view scriptNonce) {
+    if (scriptNonce.empty()) {
+        return;
+    }
+    out.append(kNonceOpen);
+    out.append(scriptNonce);
+    out.push_back('"');
+}
+
+std::string devReloadScriptBody(const HtmlShellAssets &assets) {
+    std::string script;
+    script.append(">\n"
+                  "      (() => {\n"
+                  "        const probePath = \"");
+    script.append(html_escape::escape(assets.devReloadProbePath, Mode::JsString));
+    script.append("\";\n"
+                  "        const intervalMs = ");
+    script.append(std::to_string(assets.devReloadIntervalMs));
+    script.append(";\n"
+                  "        let lastProcessStartedMs = 0;\n"
+                  "        let sawServerUnavailable = false;\n"
+                  "\n"
+                  "        const poll = async () => {\n"
+                  "          try {\n"
+                  "            const separator = probePath.includes(\"?\") ? \"&\" : \"?\";\n"
+                  "            const response = await fetch(`${probePath}${separator}"
+                  "__hydra_reload_ts=${Date.now()}`, {\n"
+                  "              cache: \"no-store\",\n"
+                  "              credentials: \"same-origin\"\n"
+                  "            });\n"
+                  "            if (!response.ok) {\n"
+                  "              sawServerUnavailable = true;\n"
+                  "              return;\n"
+                  "            }\n"
+                  "\n"
+                  "            const payload = await response.json();\n"
+                  "            const current = Number(payload.process_started_ms ?? 0);\n"
+                  "            if (!Number.isFinite(current) || current <= 0) {\n"
+                  "              return;\n"
+                  "            }\n"
+                  "\n"
+                  "            if (lastProcessStartedMs === 0) {\n"
+                  "              lastProcessStartedMs = current;\n"
+                  "              if (sawServerUnavailable) {\n"
+                  "                window.location.reload();\n"
+                  "                return;\n"
+                  "              }\n"
+                  "              sawServerUnavailable = false;\n"
+                  "              return;\n"
+                  "            }\n"
+                  "\n"
+                  "            if (current !== lastProcessStartedMs || sawServerUnavailable) {\n"
+                  "              window.location.reload();\n"
+                  "              return;\n"
+                  "            }\n"
+                  "\n"
+                  "            sawServerUnavailable = false;\n"
+                  "          } catch (error) {\n"
+                  "            sawServerUnavailable = true;\n"
+                  "          }\n"
+                  "        };\n"
+                  "\n"
+                  "        window.setInterval(() => {\n"
+                  "          void poll();\n"
+                  "        }, intervalMs);\n"
+                  "        void poll();\n"
+                  "      })();\n"
+                  "    </script>\n");
+    return script;
+}
+
+}  // namespace
+
+CompiledHtmlShell::CompiledHtmlShell(const HtmlShellAssets &assets) {
+    const auto setDefault = [this](MetaField field, std::string value) {
+        defaultsEscaped_[static_cast<std::size_t>(field)] =
+            html_escape::escape(value, Mode::HtmlAttribute);
+        defaults_[static_cast<std::size_t>(field)] = std::move(value);
+    };
+    setDefault(MetaField::Title, assets.title.empty() ? "HydraStack" : assets.title);
+    setDefault(MetaField::Description, assets.description);
+    setDefault(MetaField::CanonicalUrl, assets.canonicalUrl);
+    setDefault(MetaField::Robots, assets.robots);
+    setDefault(MetaField::OgType, assets.ogType.empty() ? "website" : assets.ogType);
+    setDefault(MetaField::ImageUrl, assets.imageUrl);
+    setDefault(MetaField::SiteName, assets.siteName);
+    setDefault(MetaField::TwitterCard, assets.twitterCard);
+    defaultTitleText_ = html_escape::escape(
+        defaults_[static_cast<std::size_t>(MetaField::Title)], Mode::HtmlText);
+
+    // Adjacent static text is merged so a render walks as few segments as
+    // possible.
+    const auto text = [](std::vector<Segment> &segments, std::string_view value) {
+        if (segments.empty() || segments.back().kind != Segment::Kind::Static) {
+            segments.push_back(Segment{});
+        }
+        segments.back().text.append(value);
+    };
+    const auto slot = [](std::vector<Segment> &segments, Segment::Kind kind) {
+        Segment segment;
+        segment.kind = kind;
+        segments.push_back(std::move(segment));
+    };
+    const auto metaName = [this](std::string_view name, MetaField field) {
+        Segment segment;
+        segment.kind = Segment::Kind::Meta;
+        segment.field = field;
+        segment.text = "    <meta name=\"" + std::string(name) + "\" content=\"";
+        segment.close = "\" />\n";
+        prefix_.push_back(std::move(segment));
+    };
+    const auto metaProperty = [this](std::string_view property, MetaField field) {
+        Segment segment;
+        segment.kind = Segment::Kind::Meta;
+        segment.field = field;
+        segment.text = "    <meta property=\"" + std::string(property) + "\" content=\"";
+        segment.close = "\" />\n";
+        prefix_.push_back(std::move(segment));
+    };
+
+    text(prefix_,
+         "<!doctype html>\n"
+         "<html lang=\"en\">\n"
+         "  <head>\n"
+         "    <meta charset=\"utf-8\" />\n"
+         "    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1\" />\n");
+    {
+        Segment title;
+        title.kind = Segment::Kind::MetaText;
+        title.field = MetaField::Title;
+        title.text = "    <title>";
+        title.close = "</title>\n";
+        prefix_.push_back(std::move(title));
+    }
+    metaName("description", MetaField::Description);
+    metaName("robots", MetaField::Robots);
+    metaProperty("og:title", MetaField::Title);
+    metaProperty("og:description", MetaField::Description);
+    metaProperty("og:type", MetaField::OgType);
+    metaProperty("og:url", MetaField::CanonicalUrl);
+    metaProperty("og:image", MetaField::ImageUrl);
+    metaProperty("og:site_name", MetaField::SiteName);
+    metaName("twitter:card", MetaField::TwitterCard);
+    metaName("twitter:title", MetaField::Title);
+    metaName("twitter:description", MetaField::Description);
+    metaName("twitter:image", MetaField::ImageUrl);
+    {
+        Segment canonical;
+        canonical.kind = Segment::Kind::Meta;
+        canonical.field = MetaField::CanonicalUrl;
+        canonical.text = "    <link rel=\"canonical\" href=\"";
+        canonical.close = "\" />\n";
+        prefix_.push_back(std::move(canonical));
+    }
+
+    text(prefix_,
+         "    <link rel=\"preconnect\" href=\"https://fonts.googleapis.com\" />\n"
+         "    <link rel=\"preconnect\" href=\"https://fonts.gstatic.com\" crossorigin />\n"
+         "    <link rel=\"stylesheet\" href=\"https://fonts.googleapis.com/css2?family=Sora:wght@400;500;600;700&display=swap\" />\n");
+    const auto stylesheetLink = "    <link rel=\"stylesheet\" href=\"" + assets.cssPath + "\" />\n";
+    const bool criticalCss = assets.inlineCriticalCss && !assets.cssPath.empty();
+    if (criticalCss) {
+        Segment style;
+        style.kind = Segment::Kind::CriticalStyle;
+        style.text = stylesheetLink;
+        style.close = "    <link rel=\"preload\" href=\"" + assets.cssPath + "\" as=\"style\" />\n";
+        prefix_.push_back(std::move(style));
+    } else if (!assets.cssPath.empty()) {
+        text(prefix_, stylesheetLink);
+    }
+    for (const auto &path : assets.scriptPreloadPaths) {
+        const auto href = html_escape::escape(path, Mode::HtmlAttribute);
+        text(prefix_, assets.clientJsModule
+                          ? "    <link rel=\"modulepreload\" href=\"" + href + "\" />\n"
+                          : "    <link rel=\"preload\" href=\"" + href + "\" as=\"script\" />\n");
+    }
+    for (const auto &path : assets.stylePreloadPaths) {
+        text(prefix_, "    <link rel=\"preload\" href=\"" +
+                          html_escape::escape(path, Mode::HtmlAttribute) + "\" as=\"style\" />\n");
+    }
+    text(prefix_,
+         "  </head>\n"
+         "  <body>\n"
+         "    <div id=\"root\">");
+
+    text(suffix_, "</div>\n");
+    if (criticalCss) {
+        Segment deferred;
+        deferred.kind = Segment::Kind::DeferredStyle;
+        deferred.text = stylesheetLink;
+        suffix_.push_back(std::move(deferred));
+    }
+    text(suffix_, "    <script id=\"__HYDRA_PROPS__\" type=\"application/json\"");
+    slot(suffix_, Segment::Kind::Nonce);
+    text(suffix_, ">");
+    slot(suffix_, Segment::Kind::Props);
+    text(suffix_, "</script>\n");
+
+    if (!assets.hmrClientPath.empty()) {
+        if (const auto reactRefreshPath = deriveReactRefreshPath(assets.hmrClientPath);
+            !reactRefreshPath.empty()) {
+            text(suffix_, "    <script type=\"module\"");
+            slot(suffix_, Segment::Kind::Nonce);
+            text(suffix_,
+                 ">\n"
+                 "      import RefreshRuntime from \"" + reactRefreshPath + "\";\n"
+                 "      RefreshRuntime.injectIntoGlobalHook(window);\n"
+                 "      window.$RefreshReg$ = () => {};\n"
+                 "      window.$RefreshSig$ = () => (type) => type;\n"
+                 "      window.__vite_plugin_react_preamble_installed__ = true;\n"
+                 "    </script>\n");
+        }
+
+        text(suffix_, "    <script type=\"module\" src=\"" + assets.hmrClientPath + "\"");
+        slot(suffix_, Segment::Kind::Nonce);
+        text(suffix_, "></script>\n");
+    }
+
+    if (!assets.clientJsPath.empty()) {
+        if (assets.clientJsModule) {
+            text(suffix_, "    <script type=\"module\" src=\"" + assets.clientJsPath + "\"");
+            slot(suffix_, Segment::Kind::Nonce);
+            text(suffix_, "></script>\n");
+        } else {
+            text(suffix_, "    <script src=\"" + assets.clientJsPath + "\" defer");
+            slot(suffix_, Segment::Kind::Nonce);
+            text(suffix_, "></script>\n");
+        }
+    }
+
+    if (!assets.devReloadProbePath.empty() && assets.devReloadIntervalMs > 0) {
+        text(suffix_, "    <script");
+        slot(suffix_, Segment::Kind::Nonce);
+        text(suffix_, devReloadScriptBody(assets));
+    }
+
+    text(suffix_,
+         "  </body>\n"
+         "</html>\n");
+
+    for (const auto *segments : {&prefix_, &suffix_}) {
+        templateHash_ = combineHash(templateHash_, segments->size());
+        for (const auto &segment : *segments) {
+            templateHash_ = combineHash(templateHash_, static_cast<std::uint64_t>(segment.kind));
+            templateHash_ = combineHash(templateHash_, static_cast<std::uint64_t>(segment.field));
+            templateHash_ = combineHash(templateHash_, hash64(segment.text));
+            templateHash_ = combineHash(templateHash_, hash64(segment.close));
+        }
+    }
+}
+
+CompiledHtmlShell::ResolvedMeta CompiledHtmlShell::resolve(const HtmlShellPageMeta &page) const {
+    ResolvedMeta meta;
+    const auto pick = [&](MetaField field, std::string_view override) {
+        const auto index = static_cast<std::size_t>(field);
+        meta[index] = override.empty() ? MetaValue{defaults_[index], true}
+                                       : MetaValue{override, false};
+    };
+    pick(MetaField::Title, page.title);
+    pick(MetaField::Description, page.description);
+    pick(MetaField::CanonicalUrl, page.canonicalUrl);
+    pick(MetaField::Robots, page.robots);
+    pick(MetaField::OgType, page.ogType);
+    pick(MetaField::ImageUrl, page.imageUrl);
+    pick(MetaField::SiteName, page.siteName);
+    pick(MetaField::TwitterCard, page.twitterCard);
+
+    auto &twitterCard = meta[static_cast<std::size_t>(MetaField::TwitterCard)];
+    if (twitterCard.value.empty()) {
+        const auto hasImage = !meta[static_cast<std::size_t>(MetaField::ImageUrl)].value.empty();
+        twitterCard = MetaValue{hasImage ? "summary_large_image" : "summary", false};
+    }
+    return meta;
+}
+
+std::size_t CompiledHtmlShell::measure(const std::vector<Segment> &segments,
+                                       const Slots &slots) const {
+    std::size_t size = 0;
+    for (const auto &segment : segments) {
+        switch (segment.kind) {
+            case Segment::Kind::Static:
+                size += segment.text.size();
                 break;
-            case '\n':
-                escaped.append("\\n");
+            case Segment::Kind::Nonce:
+                size += nonceAttributeSize(slots.scriptNonce);
                 break;
-            case '\r':
-                escaped.append("\\r");
+            case Segment::Kind::Props:
+                size += html_escape::escapedSize(slots.propsJson, Mode::ScriptTag);
                 break;
-            case '\t':
-                escaped.append("\\t");
+            case Segment::Kind::Meta:
+            case Segment::Kind::MetaText: {
+                const auto index = static_cast<std::size_t>(segment.field);
+                const auto &value = (*slots.meta)[index];
+                if (value.value.empty()) {
+                    break;
+                }
+                size += segment.text.size() + segment.close.size();
+                if (!value.fromDefault) {
+                    size += html_escape::escapedSize(value.value,
+                                                     segment.kind == Segment::Kind::MetaText
+                                                         ? Mode::HtmlText
+                                                         : Mode::HtmlAttribute);
+                } else {
+                    size += segment.kind == Segment::Kind::MetaText
+                                ? defaultTitleText_.size()
+                                : defaultsEscaped_[index].size();
+                }
                 break;
-            case '<':
-                escaped.append("\\u003c");
+            }
+            case Segment::Kind::CriticalStyle:
+                size += slots.criticalCss.empty()
+                            ? segment.text.size()
+                            : kStyleOpen.size() + nonceAttributeSize(slots.scriptNonce) + 1 +
+                                  slots.criticalCss.size() + kStyleClose.size() +
+                                  segment.close.size();
                 break;
-            default:
-                escaped.push_back(ch);
+            case Segment::Kind::DeferredStyle:
+                size += slots.criticalCss.empty() ? 0 : segment.text.size();
                 break;
         }
     }
-    return escaped;
+    return size;
 }
 
-std::string nonceAttribute(const HtmlShellAssets &assets) {
-    if (assets.scriptNonce.empty()) {
-        return {};
+void CompiledHtmlShell::emit(std::string &out,
+                             const std::vector<Segment> &segments,
+                             const Slots &slots) const {
+    for (const auto &segment : segments) {
+        emitSegment(out, segment, slots);
     }
-    return " nonce=\"" + assets.scriptNonce + "\"";
 }
 
-std::string escapeHtmlText(std::string_view value) {
-    std::string escaped;
-    escaped.reserve(value.size());
-    for (const auto ch : value) {
-        switch (ch) {
-            case '&':
-                escaped.append("&amp;");
-                break;
-            case '<':
-                escaped.append("&lt;");
-                break;
-            case '>':
-                escaped.append("&gt;");
-                break;
-            default:
-                escaped.push_back(ch);
+void CompiledHtmlShell::emitSegment(std::string &out,
+                                    const Segment &segment,
+                                    const Slots &slots) const {
+    switch (segment.kind) {
+        case Segment::Kind::Static:
+            out.append(segment.text);
+            break;
+        case Segment::Kind::Nonce:
+            appendNonceAttribute(out, slots.scriptNonce);
+            break;
+        case Segment::Kind::Props:
+            html_escape::appendEscaped(out, slots.propsJson, Mode::ScriptTag);
+            break;
+        case Segment::Kind::Meta:
+        case Segment::Kind::MetaText: {
+            const auto index = static_cast<std::size_t>(segment.field);
+            const auto &value = (*slots.meta)[index];
+            if (value.value.empty()) {
                 break;
+            }
+            out.append(segment.text);
+            if (!value.fromDefault) {
+                html_escape::appendEscaped(out,
+                                           value.value,
+                                           segment.kind == Segment::Kind::MetaText
+                                               ? Mode::HtmlText
+                                               : Mode::HtmlAttribute);
+            } else {
+                out.append(segment.kind == Segment::Kind::MetaText ? defaultTitleText_
+                                                                   : defaultsEscaped_[index]);
+            }
+            out.append(segment.close);
+            break;
         }
+        case Segment::Kind::CriticalStyle:
+            if (slots.criticalCss.empty()) {
+                out.append(segment.text);
+                break;
+            }
+            out.append(kStyleOpen);
+            appendNonceAttribute(out, slots.scriptNonce);
+            out.push_back('>');
+            out.append(slots.criticalCss);
+            out.append(kStyleClose);
+            out.append(segment.close);
+            break;
+        case Segment::Kind::DeferredStyle:
+            if (!slots.criticalCss.empty()) {
+                out.append(segment.text);
+            }
+            break;
     }
-    return escaped;
 }
 
-std::string escapeHtmlAttribute(std::string_view value) {
-    std::string escaped;
-    escaped.reserve(value.size());
-    for (const auto ch : value) {
-        switch (ch) {
-            case '&':
-                escaped.append("&amp;");
-                break;
-            case '<':
-                escaped.append("&lt;");
+std::string CompiledHtmlShell::wrap(std::string_view appHtml,
+                                    std::string_view propsJson,
+                                    const HtmlShellPageMeta &page,
+                                    std::string_view scriptNonce) const {
+    const auto meta = resolve(page);
+    const Slots slots{&meta, page.criticalCss, propsJson, scriptNonce};
+    std::string html;
+    html.reserve(measure(prefix_, slots) + appHtml.size() + measure(suffix_, slots));
+    emit(html, prefix_, slots);
+    html.append(appHtml);
+    emit(html, suffix_, slots);
+    return html;
+}
+
+std::vector<std::string> CompiledHtmlShell::wrapRuns(std::string_view appHtml,
+                                                     std::string_view propsJson,
+                                                     std::size_t requestBegin,
+                                                     std::size_t requestEnd,
+                                                     const HtmlShellPageMeta &page,
+                                                     std::string_view scriptNonce) const {
+    requestEnd = std::min(requestEnd, propsJson.size());
+    requestBegin = std::min(requestBegin, requestEnd);
+    std::vector<std::string> runs(1);
+    const auto run = [&runs](bool perRequest) -> std::string & {
+        if ((runs.size() % 2 == 0) != perRequest) {
+            runs.emplace_back();
+        }
+        return runs.back();
+    };
+
+    const auto meta = resolve(page);
+    const Slots slots{&meta, page.criticalCss, propsJson, scriptNonce};
+    for (const auto &segment : prefix_) {
+        if (segment.kind == Segment::Kind::CriticalStyle && !page.criticalCss.empty()) {
+            run(false).append(kStyleOpen);
+            appendNonceAttribute(run(true), scriptNonce);
+            run(false).push_back('>');
+            run(false).append(page.criticalCss);
+            run(false).append(kStyleClose);
+            run(false).append(segment.close);
+        } else {
+            emitSegment(run(false), segment, slots);
+        }
+    }
+    run(false).append(appHtml);
+    for (const auto &segment : suffix_) {
+        switch (segment.kind) {
+            case Segment::Kind::Nonce:
+                appendNonceAttribute(run(true), scriptNonce);
                 break;
-            case '>':
-                escaped.append("&gt;");
+            case Segment::Kind::Props:
+                html_escape::appendEscaped(
+                    run(false), propsJson.substr(0, requestBegin), Mode::ScriptTag);
+                html_escape::appendEscaped(
+                    run(true), propsJson.substr(requestBegin, requestEnd - requestBegin),
+                    Mode::ScriptTag);
+                html_escape::appendEscaped(
+                    run(false), propsJson.substr(requestEnd), Mode::ScriptTag);
                 break;
-            case '"':
-                escaped.append("&quot;");
+            case Segment::Kind::Static:
+            case Segment::Kind::DeferredStyle:
+                emitSegment(run(false), segment, slots);
                 break;
-            default:
-                escaped.push_back(ch);
+            case Segment::Kind::Meta:
+            case Segment::Kind::MetaText:
+            case Segment::Kind::CriticalStyle:
+                // Only the prefix carries page metadata and inlined rules.
                 break;
         }
     }
-    return escaped;
+    return runs;
 }
 
-void appendMetaName(std::ostringstream &html,
-                    std::string_view name,
-                    const std::string &content) {
-    if (content.empty()) {
-        return;
+std::uint64_t CompiledHtmlShell::contentHash(std::string_view appHtml,
+                                             std::string_view propsJson,
+                                             std::size_t requestBegin,
+                                             std::size_t requestEnd,
+                                             const HtmlShellPageMeta &page) const {
+    requestEnd = std::min(requestEnd, propsJson.size());
+    requestBegin = std::min(requestBegin, requestEnd);
+    // Resolved values, so a default and an equal override (which render
+    // the same) share a digest.
+    auto digest = templateHash_;
+    for (const auto &value : resolve(page)) {
+        digest = combineHash(digest, hash64(value.value));
     }
-    html << "    <meta name=\"" << name << "\" content=\""
-         << escapeHtmlAttribute(content) << "\" />\n";
+    digest = combineHash(digest, hash64(page.criticalCss));
+    digest = combineHash(digest, hash64(appHtml));
+    digest = combineHash(digest, hash64(propsJson.substr(0, requestBegin)));
+    return combineHash(digest, hash64(propsJson.substr(requestEnd)));
 }
 
-void appendMetaProperty(std::ostringstream &html,
-                        std::string_view property,
-                        const std::string &content) {
-    if (content.empty()) {
-        return;
-    }
-    html << "    <meta property=\"" << property << "\" content=\""
-         << escapeHtmlAttribute(content) << "\" />\n";
+std::string CompiledHtmlShell::prefix(const HtmlShellPageMeta &page) const {
+    const auto meta = resolve(page);
+    const Slots slots{&meta, {}, {}, {}};
+    std::string html;
+    html.reserve(measure(prefix_, slots));
+    emit(html, prefix_, slots);
+    return html;
 }
 
-}  // namespace
+std::string CompiledHtmlShell::suffix(std::string_view propsJson,
+                                      std::string_view scriptNonce) const {
+    const Slots slots{nullptr, {}, propsJson, scriptNonce};
+    std::string html;
+    html.reserve(measure(suffix_, slots));
+    emit(html, suffix_, slots);
+    return html;
+}
 
 std::string HtmlShell::wrap(const std::string &appHtml,
                             const std::string &propsJson,
                             const HtmlShellAssets &assets) {
-    std::ostringstream html;
-    html << "<!doctype html>\n"
-         << "<html lang=\"en\">\n"
-         << "  <head>\n"
-         << "    <meta charset=\"utf-8\" />\n"
-         << "    <meta name=\"viewport\" content=\"width=device-width, initial-scale=1\" />\n"
-         << "    <title>" << escapeHtmlText(assets.title.empty() ? "HydraStack" : assets.title)
-         << "</title>\n";
-
-    const auto title = assets.title.empty() ? std::string("HydraStack") : assets.title;
-    const auto twitterCard = !assets.twitterCard.empty()
-                                 ? assets.twitterCard
-                                 : (assets.imageUrl.empty() ? "summary" : "summary_large_image");
-    appendMetaName(html, "description", assets.description);
-    appendMetaName(html, "robots", assets.robots);
-    appendMetaProperty(html, "og:title", title);
-    appendMetaProperty(html, "og:description", assets.description);
-    appendMetaProperty(html, "og:type", assets.ogType.empty() ? "website" : assets.ogType);
-    appendMetaProperty(html, "og:url", assets.canonicalUrl);
-    appendMetaProperty(html, "og:image", assets.imageUrl);
-    appendMetaProperty(html, "og:site_name", assets.siteName);
-    appendMetaName(html, "twitter:card", twitterCard);
-    appendMetaName(html, "twitter:title", title);
-    appendMetaName(html, "twitter:description", assets.description);
-    appendMetaName(html, "twitter:image", assets.imageUrl);
-    if (!assets.canonicalUrl.empty()) {
-        html << "    <link rel=\"canonical\" href=\""
-             << escapeHtmlAttribute(assets.canonicalUrl) << "\" />\n";
-    }
-
-    html << "    <link rel=\"preconnect\" href=\"https://fonts.googleapis.com\" />\n"
-         << "    <link rel=\"preconnect\" href=\"https://fonts.gstatic.com\" crossorigin />\n"
-         << "    <link rel=\"stylesheet\" href=\"https://fonts.googleapis.com/css2?family=Sora:wght@400;500;600;700&display=swap\" />\n";
-
-    if (!assets.cssPath.empty()) {
-        html << "    <link rel=\"stylesheet\" href=\"" << assets.cssPath << "\" />\n";
-    }
-
-    const auto nonceAttr = nonceAttribute(assets);
-
-    html << "  </head>\n"
-         << "  <body>\n"
-         << "    <div id=\"root\">" << appHtml << "</div>\n"
-         << "    <script id=\"__HYDRA_PROPS__\" type=\"application/json\"" << nonceAttr << ">"
-         << escapeForScriptTag(propsJson) << "</script>\n";
-
-    if (!assets.hmrClientPath.empty()) {
-        if (const auto reactRefreshPath = deriveReactRefreshPath(assets.hmrClientPath);
-            !reactRefreshPath.empty()) {
-            html << "    <script type=\"module\"" << nonceAttr << ">\n"
-                 << "      import RefreshRuntime from \"" << reactRefreshPath << "\";\n"
-                 << "      RefreshRuntime.injectIntoGlobalHook(window);\n"
-                 << "      window.$RefreshReg$ = () => {};\n"
-                 << "      window.$RefreshSig$ = () => (type) => type;\n"
-                 << "      window.__vite_plugin_react_preamble_installed__ = true;\n"
-                 << "    </script>\n";
-        }
-
-        html << "    <script type=\"module\" src=\"" << assets.hmrClientPath << "\""
-             << nonceAttr << "></script>\n";
-    }
-
-    if (!assets.clientJsPath.empty()) {
-        if (assets.clientJsModule) {
-            html << "    <script type=\"module\" src=\"" << assets.clientJsPath
-                 << "\"" << nonceAttr << "></script>\n";
-        } else {
-            html << "    <script src=\"" << assets.clientJsPath << "\" defer"
-                 << nonceAttr << "></script>\n";
-        }
-    }
+    return CompiledHtmlShell(assets).wrap(appHtml, propsJson, {}, assets.scriptNonce);
+}
 
-    if (!assets.devReloadProbePath.empty() && assets.devReloadIntervalMs > 0) {
-        html << "    <script" << nonceAttr << ">\n"
-             << "      (() => {\n"
-             << "        const probePath = \"" << escapeForJsString(assets.devReloadProbePath)
-             << "\";\n"
-             << "        const intervalMs = " << assets.devReloadIntervalMs << ";\n"
-             << "        let lastProcessStartedMs = 0;\n"
-             << "        let sawServerUnavailable = false;\n"
-             << "\n"
-             << "        const poll = async () => {\n"
-             << "          try {\n"
-             << "            const separator = probePath.includes(\"?\") ? \"&\" : \"?\";\n"
-             << "            const response = await fetch(`${probePath}${separator}"
-                "__hydra_reload_ts=${Date.now()}`, {\n"
-             << "              cache: \"no-store\",\n"
-             << "              credentials: \"same-origin\"\n"
-             << "            });\n"
-             << "            if (!response.ok) {\n"
-             << "              sawServerUnavailable = true;\n"
-             << "              return;\n"
-             << "            }\n"
-             << "\n"
-             << "            const payload = await response.json();\n"
-             << "            const current = Number(payload.process_started_ms ?? 0);\n"
-             << "            if (!Number.isFinite(current) || current <= 0) {\n"
-             << "              return;\n"
-             << "            }\n"
-             << "\n"
-             << "            if (lastProcessStartedMs === 0) {\n"
-             << "              lastProcessStartedMs = current;\n"
-             << "              if (sawServerUnavailable) {\n"
-             << "                window.location.reload();\n"
-             << "                return;\n"
-             << "              }\n"
-             << "              sawServerUnavailable = false;\n"
-             << "              return;\n"
-             << "            }\n"
-             << "\n"
-             << "            if (current !== lastProcessStartedMs || sawServerUnavailable) {\n"
-             << "              window.location.reload();\n"
-             << "              return;\n"
-             << "            }\n"
-             << "\n"
-             << "            sawServerUnavailable = false;\n"
-             << "          } catch (error) {\n"
-             << "            sawServerUnavailable = true;\n"
-             << "          }\n"
-             << "        };\n"
-             << "\n"
-             << "        window.setInterval(() => {\n"
-             << "          void poll();\n"
-             << "        }, intervalMs);\n"
-             << "        void poll();\n"
-             << "      })();\n"
-             << "    </script>\n";
-    }
+std::string HtmlShell::shellPrefix(const HtmlShellAssets &assets) {
+    return CompiledHtmlShell(assets).prefix({});
+}
 
-    html << "  </body>\n"
-         << "</html>\n";
-    return html.str();
+std::string HtmlShell::shellSuffix(const std::string &propsJson,
+                                   const HtmlShellAssets &assets) {
+    return CompiledHtmlShell(assets).suffix(propsJson, assets.scriptNonce);
 }
 
 std::string HtmlShell::errorPage(const std::string &message) {
@@ -274,27 +555,7 @@ std::string HtmlShell::errorPage(const std::string &message) {
 }
 
 std::string HtmlShell::escapeForScriptTag(std::string_view value) {
-    std::string escaped;
-    escaped.reserve(value.size());
-
-    for (const char ch : value) {
-        switch (ch) {
-            case '<':
-                escaped.append("\\u003c");
-                break;
-            case '>':
-                escaped.append("\\u003e");
-                break;
-            case '&':
-                escaped.append("\\u0026");
-                break;
-            default:
-                escaped.push_back(ch);
-                break;
-        }
-    }
-
-    return escaped;
+    return html_escape::escape(value, Mode::ScriptTag);
 }
 
 }  // namespace hydra
@@ -1,6 +1,8 @@
 #include "hydra/HydraSsrPlugin.h"
 
 #include "hydra/HtmlShell.h"
+#include "hydra/Prerenderer.h"
+#include "hydra/RenderExecutor.h"
 
 #include <json/reader.h>
 #include <json/writer.h>
@@ -148,6 +150,18 @@ void appendUnique(std::vector<std::string> *values, const std::string &value) {
     }
 }
 
+drogon::HttpResponsePtr toHttpResponse(const SsrRenderResult &rendered) {
+    auto response = drogon::HttpResponse::newHttpResponse();
+    const auto normalizedStatus = std::clamp(rendered.status, 100, 599);
+    response->setStatusCode(static_cast<drogon::HttpStatusCode>(normalizedStatus));
+    response->setContentTypeCode(drogon::CT_TEXT_HTML);
+    response->setBody(rendered.html);
+    for (const auto &[headerName, headerValue] : rendered.headers) {
+        response->addHeader(headerName, headerValue);
+    }
+    return response;
+}
+
 }  // namespace
 
 void V8IsolatePoolDeleter::operator()(V8IsolatePool *) const noexcept {}
@@ -174,30 +188,36 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
         readStringOrDefault(config, "client_manifest_entry", clientManifestEntry_);
 
     const auto &i18n = config["i18n"];
-    i18nDefaultLocale_ =
-        normalizeLocale(readStringOrDefault(i18n, "defaultLocale", i18nDefaultLocale_));
-    i18nQueryParam_ = readStringOrDefault(i18n, "queryParam", i18nQueryParam_);
-    i18nCookieName_ = readStringOrDefault(i18n, "cookieName", i18nCookieName_);
-    i18nIncludeLocaleCandidates_ =
-        readBoolOrDefault(i18n, "includeLocaleCandidates", i18nIncludeLocaleCandidates_);
-    i18nSupportedLocaleOrder_ =
-        readStringArray(i18n, "supportedLocales", {i18nDefaultLocale_}, true);
-    i18nSupportedLocales_.clear();
-    for (const auto &locale : i18nSupportedLocaleOrder_) {
-        i18nSupportedLocales_.insert(locale);
+    auto &contextOptions = requestContext_;
+    contextOptions.defaultLocale =
+        normalizeLocale(readStringOrDefault(i18n, "defaultLocale", contextOptions.defaultLocale));
+    contextOptions.localeQueryParam =
+        readStringOrDefault(i18n, "queryParam", contextOptions.localeQueryParam);
+    contextOptions.localeCookieName =
+        readStringOrDefault(i18n, "cookieName", contextOptions.localeCookieName);
+    contextOptions.includeLocaleCandidates =
+        readBoolOrDefault(i18n, "includeLocaleCandidates", contextOptions.includeLocaleCandidates);
+    contextOptions.supportedLocaleOrder =
+        readStringArray(i18n, "supportedLocales", {contextOptions.defaultLocale}, true);
+    contextOptions.supportedLocales.clear();
+    for (const auto &locale : contextOptions.supportedLocaleOrder) {
+        contextOptions.supportedLocales.insert(locale);
     }
 
     const auto &theme = config["theme"];
-    themeDefault_ = normalizeTheme(readStringOrDefault(theme, "defaultTheme", themeDefault_));
-    themeQueryParam_ = readStringOrDefault(theme, "queryParam", themeQueryParam_);
-    themeCookieName_ = readStringOrDefault(theme, "cookieName", themeCookieName_);
-    themeIncludeThemeCandidates_ =
-        readBoolOrDefault(theme, "includeThemeCandidates", themeIncludeThemeCandidates_);
-    themeSupportedThemeOrder_ =
-        readStringArray(theme, "supportedThemes", {themeDefault_}, false);
-    themeSupportedThemes_.clear();
-    for (const auto &themeName : themeSupportedThemeOrder_) {
-        themeSupportedThemes_.insert(themeName);
+    contextOptions.defaultTheme =
+        normalizeTheme(readStringOrDefault(theme, "defaultTheme", contextOptions.defaultTheme));
+    contextOptions.themeQueryParam =
+        readStringOrDefault(theme, "queryParam", contextOptions.themeQueryParam);
+    contextOptions.themeCookieName =
+        readStringOrDefault(theme, "cookieName", contextOptions.themeCookieName);
+    contextOptions.includeThemeCandidates =
+        readBoolOrDefault(theme, "includeThemeCandidates", contextOptions.includeThemeCandidates);
+    contextOptions.supportedThemeOrder =
+        readStringArray(theme, "supportedThemes", {contextOptions.defaultTheme}, false);
+    contextOptions.supportedThemes.clear();
+    for (const auto &themeName : contextOptions.supportedThemeOrder) {
+        contextOptions.supportedThemes.insert(themeName);
     }
 
     Json::Value manifest(Json::objectValue);
@@ -230,6 +250,25 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
         hmrClientPath_ = readStringOrDefault(devMode, "hmr_client_path", hmrClientPath_);
         clientJsModule_ = readBoolOrDefault(devMode, "client_js_module", true);
     }
+
+    HtmlShellAssets assets;
+    assets.title = shellTitle_;
+    assets.description = shellDescription_;
+    assets.canonicalUrl = shellCanonicalUrl_;
+    assets.robots = shellRobots_;
+    assets.ogType = shellOgType_;
+    assets.imageUrl = shellImageUrl_;
+    assets.siteName = shellSiteName_;
+    assets.twitterCard = shellTwitterCard_;
+    assets.cssPath = cssPath_;
+    assets.clientJsPath = clientJsPath_;
+    assets.hmrClientPath = hmrClientPath_;
+    assets.clientJsModule = clientJsModule_;
+    if (devModeEnabled_ && devAutoReloadEnabled_) {
+        assets.devReloadProbePath = devReloadProbePath_;
+        assets.devReloadIntervalMs = devReloadIntervalMs_;
+    }
+    staticShell_ = std::make_unique<const CompiledHtmlShell>(assets);
 }
 
 void HydraSsrPlugin::shutdown() {}
@@ -253,6 +292,7 @@ std::string HydraSsrPlugin::buildRouteUrl(const drogon::HttpRequestPtr &req,
 Json::Value HydraSsrPlugin::buildRequestContext(const drogon::HttpRequestPtr &req,
                                                 const std::string &routeUrl,
                                                 const std::string &requestId) const {
+    const auto &options = requestContext_;
     Json::Value context(Json::objectValue);
 
     const std::string routePath = req && !req->path().empty() ? req->path() : "/";
@@ -266,21 +306,22 @@ Json::Value HydraSsrPlugin::buildRequestContext(const drogon::HttpRequestPtr &re
 
     std::vector<std::string> localeCandidates;
     if (req) {
-        appendUnique(&localeCandidates, normalizeLocale(req->getParameter(i18nQueryParam_)));
-        appendUnique(&localeCandidates, normalizeLocale(req->getCookie(i18nCookieName_)));
+        appendUnique(&localeCandidates,
+                     normalizeLocale(req->getParameter(options.localeQueryParam)));
+        appendUnique(&localeCandidates, normalizeLocale(req->getCookie(options.localeCookieName)));
     }
-    appendUnique(&localeCandidates, i18nDefaultLocale_);
+    appendUnique(&localeCandidates, options.defaultLocale);
 
-    std::string locale = i18nDefaultLocale_.empty() ? "en" : i18nDefaultLocale_;
+    std::string locale = options.defaultLocale.empty() ? "en" : options.defaultLocale;
     for (const auto &candidate : localeCandidates) {
-        if (i18nSupportedLocales_.empty() || i18nSupportedLocales_.contains(candidate)) {
+        if (options.supportedLocales.empty() || options.supportedLocales.contains(candidate)) {
             locale = candidate;
             break;
         }
     }
     context["locale"] = locale;
 
-    if (i18nIncludeLocaleCandidates_) {
+    if (options.includeLocaleCandidates) {
         Json::Value candidates(Json::arrayValue);
         for (const auto &candidate : localeCandidates) {
             candidates.append(candidate);
@@ -297,21 +338,21 @@ Json::Value HydraSsrPlugin::buildRequestContext(const drogon::HttpRequestPtr &re
 
     std::vector<std::string> themeCandidates;
     if (req) {
-        appendUnique(&themeCandidates, normalizeTheme(req->getParameter(themeQueryParam_)));
-        appendUnique(&themeCandidates, normalizeTheme(req->getCookie(themeCookieName_)));
+        appendUnique(&themeCandidates, normalizeTheme(req->getParameter(options.themeQueryParam)));
+        appendUnique(&themeCandidates, normalizeTheme(req->getCookie(options.themeCookieName)));
     }
-    appendUnique(&themeCandidates, themeDefault_);
+    appendUnique(&themeCandidates, options.defaultTheme);
 
-    std::string theme = themeDefault_.empty() ? "default" : themeDefault_;
+    std::string theme = options.defaultTheme.empty() ? "default" : options.defaultTheme;
     for (const auto &candidate : themeCandidates) {
-        if (themeSupportedThemes_.empty() || themeSupportedThemes_.contains(candidate)) {
+        if (options.supportedThemes.empty() || options.supportedThemes.contains(candidate)) {
             theme = candidate;
             break;
         }
     }
     context["theme"] = theme;
 
-    if (themeIncludeThemeCandidates_) {
+    if (options.includeThemeCandidates) {
         Json::Value candidates(Json::arrayValue);
         for (const auto &candidate : themeCandidates) {
             candidates.append(candidate);
@@ -365,27 +406,9 @@ SsrRenderResult HydraSsrPlugin::renderResult(const drogon::HttpRequestPtr &req,
     propsObject["__hydra_request"] = requestContext;
     const auto effectivePropsJson = compactJson(propsObject);
 
-    HtmlShellAssets assets;
-    assets.title = shellTitle_;
-    assets.description = shellDescription_;
-    assets.canonicalUrl = shellCanonicalUrl_;
-    assets.robots = shellRobots_;
-    assets.ogType = shellOgType_;
-    assets.imageUrl = shellImageUrl_;
-    assets.siteName = shellSiteName_;
-    assets.twitterCard = shellTwitterCard_;
-    assets.cssPath = cssPath_;
-    assets.clientJsPath = clientJsPath_;
-    assets.hmrClientPath = hmrClientPath_;
-    assets.clientJsModule = clientJsModule_;
-    if (devModeEnabled_ && devAutoReloadEnabled_) {
-        assets.devReloadProbePath = devReloadProbePath_;
-        assets.devReloadIntervalMs = devReloadIntervalMs_;
-    }
-
     SsrRenderResult result;
     result.status = 200;
-    result.html = HtmlShell::wrap("", effectivePropsJson, assets);
+    result.html = staticShell_->wrap("", effectivePropsJson, {}, {});
     result.headers["X-Request-Id"] = requestId;
     result.headers["X-Content-Type-Options"] = "nosniff";
     result.headers["Referrer-Policy"] = "strict-origin-when-cross-origin";
@@ -395,11 +418,127 @@ SsrRenderResult HydraSsrPlugin::renderResult(const drogon::HttpRequestPtr &req,
     return result;
 }
 
+void HydraSsrPlugin::renderResultAsync(const drogon::HttpRequestPtr &req,
+                                       Json::Value props,
+                                       const RenderOptions &options,
+                                       SsrRenderCallback callback) const {
+    // The shell engine never touches V8, so rendering inline cannot park the loop.
+    auto result = renderResult(req, props, options);
+    if (callback) {
+        callback(std::move(result));
+    }
+}
+
+void HydraSsrPlugin::renderResultAsync(const drogon::HttpRequestPtr &req,
+                                       std::string propsJson,
+                                       const RenderOptions &options,
+                                       SsrRenderCallback callback) const {
+    auto result = renderResult(req, propsJson, options);
+    if (callback) {
+        callback(std::move(result));
+    }
+}
+
+// Nothing can render a subtree without a JS runtime; the client renders it
+// from the page props instead.
+SsrRenderResult HydraSsrPlugin::renderFragment(const drogon::HttpRequestPtr &req,
+                                               const Json::Value &props,
+                                               const std::string &componentId,
+                                               const RenderOptions &options) const {
+    return renderFragment(req, compactJson(props), componentId, options);
+}
+
+SsrRenderResult HydraSsrPlugin::renderFragment(const drogon::HttpRequestPtr &req,
+                                               const std::string &,
+                                               const std::string &,
+                                               const RenderOptions &) const {
+    SsrRenderResult result;
+    result.status = 501;
+    result.headers["X-Request-Id"] = resolveRequestId(req);
+    result.headers["Cache-Control"] = "no-store";
+    result.headers["X-Content-Type-Options"] = "nosniff";
+    requestFailCount_.fetch_add(1, std::memory_order_relaxed);
+    observeRequestCode(result.status);
+    return result;
+}
+
+void HydraSsrPlugin::renderFragmentAsync(const drogon::HttpRequestPtr &req,
+                                         Json::Value props,
+                                         std::string componentId,
+                                         const RenderOptions &options,
+                                         SsrRenderCallback callback) const {
+    auto result = renderFragment(req, props, componentId, options);
+    if (callback) {
+        callback(std::move(result));
+    }
+}
+
+// Nothing to stream without a JS runtime; both overloads answer with the
+// whole shell in one response.
+void HydraSsrPlugin::renderStream(const drogon::HttpRequestPtr &req,
+                                  Json::Value props,
+                                  const RenderOptions &options,
+                                  SsrStreamCallback callback) const {
+    if (callback) {
+        callback(toHttpResponse(renderResult(req, props, options)));
+    }
+}
+
+void HydraSsrPlugin::renderStream(const drogon::HttpRequestPtr &req,
+                                  std::string propsJson,
+                                  const RenderOptions &options,
+                                  SsrStreamCallback callback) const {
+    if (callback) {
+        callback(toHttpResponse(renderResult(req, propsJson, options)));
+    }
+}
+
+#ifdef __cpp_impl_coroutine
+drogon::Task<SsrRenderResult> HydraSsrPlugin::renderResultCoro(drogon::HttpRequestPtr req,
+                                                               Json::Value props,
+                                                               RenderOptions options) const {
+    co_return renderResult(req, props, options);
+}
+
+drogon::Task<SsrRenderResult> HydraSsrPlugin::renderResultCoro(drogon::HttpRequestPtr req,
+                                                               std::string propsJson,
+                                                               RenderOptions options) const {
+    co_return renderResult(req, propsJson, options);
+}
+#endif
+
+ReloadResult HydraSsrPlugin::reload(std::string) {
+    return {false, 0, "hot reload requires the V8 engine"};
+}
+
+void HydraSsrPlugin::reloadAsync(std::string, std::function<void(ReloadResult)> done) {
+    if (done) {
+        done(reload());
+    }
+}
+
+// Nothing to warm up; ready as soon as the plugin is.
+ReadinessReport HydraSsrPlugin::readiness() const {
+    return {true, {}, 0};
+}
+
+std::size_t HydraSsrPlugin::prerender(const std::vector<std::string> &) {
+    return 0;
+}
+
+// No render cache to invalidate.
+void HydraSsrPlugin::invalidateRenderCache(const std::string &) {}
+
 void HydraSsrPlugin::setApiBridgeHandler(ApiBridgeHandler handler) {
     std::lock_guard<std::mutex> lock(apiBridgeMutex_);
     apiBridgeHandler_ = std::move(handler);
 }
 
+void HydraSsrPlugin::setApiBridgeBatchHandler(ApiBridgeBatchHandler handler) {
+    std::lock_guard<std::mutex> lock(apiBridgeMutex_);
+    apiBridgeBatchHandler_ = std::move(handler);
+}
+
 ApiBridgeResponse HydraSsrPlugin::dispatchApiBridge(const ApiBridgeRequest &request) const {
     ApiBridgeResponse response;
     ApiBridgeHandler handler;
@@ -417,9 +556,17 @@ ApiBridgeResponse HydraSsrPlugin::dispatchApiBridge(const ApiBridgeRequest &requ
 
 void HydraSsrPlugin::registerDevProxyRoutes() {}
 
-void HydraSsrPlugin::observeAcquireWait(double) const {}
-void HydraSsrPlugin::observeRenderLatency(double) const {}
-void HydraSsrPlugin::observeRequestLatency(double) const {}
+std::shared_ptr<RenderTrace> HydraSsrPlugin::startTrace(const drogon::HttpRequestPtr &,
+                                                        const std::string &) const {
+    return nullptr;
+}
+
+void HydraSsrPlugin::finishTrace(const PreparedRender &, int, bool, SsrRenderResult *) const {}
+
+void HydraSsrPlugin::observeAcquireWait(std::uint64_t) const {}
+void HydraSsrPlugin::observeRenderLatency(const PreparedRender &, std::uint64_t) const {}
+void HydraSsrPlugin::observeRequestLatency(const PreparedRender &, std::uint64_t) const {}
+void HydraSsrPlugin::observeBridgeCalls(const BridgeRenderStats &) const {}
 
 void HydraSsrPlugin::observeRequestCode(int statusCode) const {
     if (statusCode < 100 || statusCode > static_cast<int>(kHttpStatusCodeMax)) {
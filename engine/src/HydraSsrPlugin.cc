@@ -1,19 +1,45 @@
 #include "hydra/HydraSsrPlugin.h"
 
+#include "hydra/AdmissionController.h"
+#include "hydra/AssetManifest.h"
+#include "hydra/BridgeDispatcher.h"
+#include "hydra/CriticalCss.h"
+#include "hydra/EntityTag.h"
+#include "hydra/Hash.h"
+#include "hydra/HtmlEscape.h"
 #include "hydra/HtmlShell.h"
+#include "hydra/LatencyHistogram.h"
 #include "hydra/LogFmt.h"
+#include "hydra/Prerenderer.h"
+#include "hydra/PropsJson.h"
+#include "hydra/RenderCache.h"
+#include "hydra/RenderDeadlineScheduler.h"
+#include "hydra/RenderEventLog.h"
+#include "hydra/RenderExecutor.h"
+#include "hydra/RenderTrace.h"
+#include "hydra/RequestContext.h"
+#include "hydra/SharedRenderCache.h"
+#include "hydra/SsrEnvelope.h"
 #include "hydra/V8IsolatePool.h"
 #include "hydra/V8Platform.h"
+#include "hydra/V8Snapshot.h"
 
+#include <drogon/HttpClient.h>
 #include <drogon/drogon.h>
 #include <json/reader.h>
 #include <json/writer.h>
+#include <trantor/net/EventLoop.h>
 
 #include <algorithm>
 #include <cctype>
 #include <chrono>
+#include <cmath>
+#include <csignal>
 #include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <future>
+#include <map>
 #include <optional>
 #include <random>
 #include <sstream>
@@ -30,6 +56,12 @@
 namespace hydra {
 namespace {
 
+using request_context::firstHeaderToken;
+using request_context::generateScriptNonce;
+using request_context::normalizeLocaleTag;
+using request_context::normalizeThemeTag;
+using request_context::sanitizeRequestId;
+
 std::string toCompactJson(const Json::Value &value) {
     Json::StreamWriterBuilder builder;
     builder["indentation"] = "";
@@ -86,212 +118,21 @@ std::string maybeColorizeLog(const std::string &line, const char *ansiCode, bool
     return out;
 }
 
-std::string firstHeaderToken(const std::string &value) {
-    if (value.empty()) {
-        return {};
-    }
-
-    const auto commaPos = value.find(',');
-    if (commaPos == std::string::npos) {
-        return trimAsciiWhitespace(value);
-    }
-
-    return trimAsciiWhitespace(value.substr(0, commaPos));
-}
-
-std::string sanitizeRequestId(std::string value) {
-    value = trimAsciiWhitespace(std::move(value));
-    if (value.empty()) {
-        return {};
-    }
-
-    std::string sanitized;
-    sanitized.reserve(value.size());
-    for (const auto ch : value) {
-        const auto uch = static_cast<unsigned char>(ch);
-        if (std::isalnum(uch) || ch == '-' || ch == '_' || ch == '.') {
-            sanitized.push_back(ch);
-        }
-    }
-
-    constexpr std::size_t kMaxRequestIdLen = 64;
-    if (sanitized.size() > kMaxRequestIdLen) {
-        sanitized.resize(kMaxRequestIdLen);
-    }
-    return sanitized;
-}
-
-std::string generateScriptNonce() {
-    static constexpr char kNonceChars[] =
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    thread_local std::mt19937 generator(std::random_device{}());
-    std::uniform_int_distribution<std::size_t> distribution(0, sizeof(kNonceChars) - 2);
-
-    std::string nonce;
-    nonce.reserve(24);
-    for (std::size_t i = 0; i < 24; ++i) {
-        nonce.push_back(kNonceChars[distribution(generator)]);
-    }
-    return nonce;
-}
-
-void appendUniqueString(std::vector<std::string> *values, const std::string &value) {
-    if (values == nullptr || value.empty()) {
-        return;
-    }
-    if (std::find(values->begin(), values->end(), value) != values->end()) {
-        return;
-    }
-    values->push_back(value);
-}
-
-std::string normalizeLocaleTag(std::string locale) {
-    locale = trimAsciiWhitespace(std::move(locale));
-    if (locale.empty()) {
-        return {};
-    }
-
-    for (auto &ch : locale) {
-        if (ch == '_') {
-            ch = '-';
-        }
-    }
-
-    locale = toLowerCopy(std::move(locale));
-
-    std::string normalized;
-    normalized.reserve(locale.size());
-    bool previousDash = false;
-    for (const auto ch : locale) {
-        const auto uch = static_cast<unsigned char>(ch);
-        if (std::isalnum(uch)) {
-            normalized.push_back(ch);
-            previousDash = false;
-            continue;
-        }
-        if (ch == '-' && !previousDash && !normalized.empty()) {
-            normalized.push_back(ch);
-            previousDash = true;
-        }
-    }
-
-    while (!normalized.empty() && normalized.back() == '-') {
-        normalized.pop_back();
-    }
-
-    return normalized;
-}
-
-std::string normalizeThemeTag(std::string theme) {
-    theme = trimAsciiWhitespace(std::move(theme));
-    if (theme.empty()) {
-        return {};
-    }
-
-    theme = toLowerCopy(std::move(theme));
-
-    std::string normalized;
-    normalized.reserve(theme.size());
-    for (const auto ch : theme) {
-        const auto uch = static_cast<unsigned char>(ch);
-        if (std::isalnum(uch) || ch == '-' || ch == '_') {
-            normalized.push_back(ch);
-        }
-    }
-
-    return normalized;
-}
-
-std::vector<std::string> localeFallbackChain(const std::string &normalizedLocale) {
-    std::vector<std::string> chain;
-    auto current = normalizedLocale;
-    while (!current.empty()) {
-        chain.push_back(current);
-        const auto separator = current.rfind('-');
-        if (separator == std::string::npos) {
-            break;
-        }
-        current = current.substr(0, separator);
-    }
-    return chain;
-}
-
-struct AcceptLanguageItem {
-    std::string locale;
-    double quality = 1.0;
-    std::size_t order = 0;
-};
-
-std::vector<std::string> parseAcceptLanguageCandidates(const std::string &headerValue) {
-    std::vector<AcceptLanguageItem> parsed;
-    std::size_t order = 0;
-    std::size_t start = 0;
-
-    while (start <= headerValue.size()) {
-        const auto comma = headerValue.find(',', start);
-        const auto chunk = comma == std::string::npos
-                               ? headerValue.substr(start)
-                               : headerValue.substr(start, comma - start);
-        const auto token = trimAsciiWhitespace(chunk);
-        if (!token.empty()) {
-            auto language = token;
-            auto quality = 1.0;
-            const auto semicolon = token.find(';');
-            if (semicolon != std::string::npos) {
-                language = trimAsciiWhitespace(token.substr(0, semicolon));
-                auto params = token.substr(semicolon + 1);
-                std::size_t paramStart = 0;
-                while (paramStart <= params.size()) {
-                    const auto paramEnd = params.find(';', paramStart);
-                    const auto rawParam = paramEnd == std::string::npos
-                                              ? params.substr(paramStart)
-                                              : params.substr(paramStart, paramEnd - paramStart);
-                    const auto param = trimAsciiWhitespace(rawParam);
-                    if (!param.empty()) {
-                        const auto equals = param.find('=');
-                        if (equals != std::string::npos) {
-                            const auto key = toLowerCopy(trimAsciiWhitespace(param.substr(0, equals)));
-                            const auto value = trimAsciiWhitespace(param.substr(equals + 1));
-                            if (key == "q") {
-                                try {
-                                    quality = std::stod(value);
-                                } catch (...) {
-                                    quality = 0.0;
-                                }
-                            }
-                        }
-                    }
-                    if (paramEnd == std::string::npos) {
-                        break;
-                    }
-                    paramStart = paramEnd + 1;
-                }
-            }
-
-            if (!language.empty() && language != "*" && quality > 0.0) {
-                parsed.push_back({language, quality, order++});
-            }
-        }
+constexpr double kOtlpExportTimeoutSec = 5.0;
+constexpr const char *kPrerenderHeader = "x-hydra-prerender";
+// Slack on top of the acquire and render timeouts for bridge calls and the
+// loop round trip of one prerender request.
+constexpr std::chrono::seconds kPrerenderRequestSlack{10};
 
-        if (comma == std::string::npos) {
-            break;
-        }
-        start = comma + 1;
+bool shouldSampleTrace(double sampleRate) {
+    if (sampleRate >= 1.0) {
+        return true;
     }
-
-    std::stable_sort(parsed.begin(), parsed.end(), [](const auto &lhs, const auto &rhs) {
-        if (lhs.quality == rhs.quality) {
-            return lhs.order < rhs.order;
-        }
-        return lhs.quality > rhs.quality;
-    });
-
-    std::vector<std::string> orderedLocales;
-    orderedLocales.reserve(parsed.size());
-    for (const auto &item : parsed) {
-        orderedLocales.push_back(item.locale);
+    if (sampleRate <= 0.0) {
+        return false;
     }
-    return orderedLocales;
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    return std::uniform_real_distribution<double>(0.0, 1.0)(generator) < sampleRate;
 }
 
 void appendNormalizedLocaleArray(const Json::Value &value,
@@ -394,6 +235,30 @@ bool parseJsonObject(const std::string &json, Json::Value *out) {
     return out->isObject();
 }
 
+bool isRedirectResult(const SsrRenderResult &result) {
+    return result.status >= 300 && result.status <= 399 &&
+           result.headers.find("Location") != result.headers.end();
+}
+
+const char *cacheOutcomeName(RenderCache::Outcome outcome) {
+    switch (outcome) {
+        case RenderCache::Outcome::kHit:
+            return "hit";
+        case RenderCache::Outcome::kStale:
+            return "stale";
+        case RenderCache::Outcome::kCoalesced:
+            return "coalesced";
+        case RenderCache::Outcome::kMiss:
+            return "miss";
+    }
+    return nullptr;
+}
+
+const char *fragmentContentType(FragmentFormat format) {
+    return format == FragmentFormat::kHtml ? "text/html; charset=utf-8"
+                                           : "application/json; charset=utf-8";
+}
+
 bool isLikelyFullDocument(const std::string &html) {
     return html.find("<html") != std::string::npos ||
            html.find("<!doctype") != std::string::npos ||
@@ -408,6 +273,16 @@ bool hasHttpScheme(const std::string &value) {
     return value.rfind("http://", 0) == 0 || value.rfind("https://", 0) == 0;
 }
 
+// "http://collector:4318/v1/traces" -> {"http://collector:4318", "/v1/traces"}.
+std::pair<std::string, std::string> splitOtlpEndpoint(const std::string &endpoint) {
+    const auto hostStart = endpoint.find("://") + 3;
+    const auto pathStart = endpoint.find('/', hostStart);
+    if (pathStart == std::string::npos) {
+        return {endpoint, "/v1/traces"};
+    }
+    return {endpoint.substr(0, pathStart), endpoint.substr(pathStart)};
+}
+
 std::string normalizeBrowserPath(std::string path) {
     if (path.empty() || hasHttpScheme(path) || path.front() == '/') {
         return path;
@@ -430,251 +305,169 @@ std::string joinOriginAndPath(std::string origin, std::string path) {
     return origin + path;
 }
 
-std::string normalizePublicPrefix(std::string publicPrefix) {
-    std::replace(publicPrefix.begin(), publicPrefix.end(), '\\', '/');
-    if (publicPrefix.empty()) {
-        return "/assets";
-    }
-    if (publicPrefix.front() != '/') {
-        publicPrefix.insert(publicPrefix.begin(), '/');
-    }
-    while (publicPrefix.size() > 1 && publicPrefix.back() == '/') {
-        publicPrefix.pop_back();
-    }
-    return publicPrefix;
-}
-
-std::string toPublicAssetPath(std::string filePath, const std::string &publicPrefix) {
-    std::replace(filePath.begin(), filePath.end(), '\\', '/');
-    while (filePath.rfind("./", 0) == 0) {
-        filePath.erase(0, 2);
-    }
-
-    if (filePath.empty()) {
-        return {};
-    }
-    if (filePath.front() == '/') {
-        return filePath;
+void resumeOnLoop(trantor::EventLoop *loop,
+                  const SsrRenderCallback &callback,
+                  SsrRenderResult result) {
+    if (!callback) {
+        return;
     }
-    if (filePath.rfind("assets/", 0) == 0) {
-        return "/" + filePath;
+    if (loop == nullptr) {
+        callback(std::move(result));
+        return;
     }
 
-    return normalizePublicPrefix(publicPrefix) + "/" + filePath;
+    loop->queueInLoop([callback, result = std::move(result)]() mutable {
+        callback(std::move(result));
+    });
 }
 
-const Json::Value *findClientEntry(const Json::Value &manifest,
-                                   const std::string &clientEntryKey) {
-    if (manifest.isMember(clientEntryKey) && manifest[clientEntryKey].isObject()) {
-        return &manifest[clientEntryKey];
-    }
-
-    const Json::Value *fallback = nullptr;
-    for (const auto &key : manifest.getMemberNames()) {
-        const auto &entry = manifest[key];
-        if (!entry.isObject() || !entry.get("isEntry", false).asBool()) {
-            continue;
-        }
+#ifdef __cpp_impl_coroutine
+template <typename Props>
+class RenderResultAwaiter : public drogon::CallbackAwaiter<SsrRenderResult> {
+  public:
+    RenderResultAwaiter(const HydraSsrPlugin *plugin,
+                        drogon::HttpRequestPtr req,
+                        Props props,
+                        RenderOptions options)
+        : plugin_(plugin),
+          req_(std::move(req)),
+          props_(std::move(props)),
+          options_(std::move(options)) {}
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        plugin_->renderResultAsync(
+            req_, std::move(props_), options_, [this, handle](SsrRenderResult result) {
+                setValue(std::move(result));
+                handle.resume();
+            });
+    }
+
+  private:
+    const HydraSsrPlugin *plugin_ = nullptr;
+    drogon::HttpRequestPtr req_;
+    Props props_;
+    RenderOptions options_;
+};
+#endif
 
-        const auto file = entry.get("file", "").asString();
-        if (file.empty()) {
+drogon::HttpResponsePtr toHttpResponse(const SsrRenderResult &rendered) {
+    auto response = drogon::HttpResponse::newHttpResponse();
+    const auto normalizedStatus = std::clamp(rendered.status, 100, 599);
+    response->setStatusCode(static_cast<drogon::HttpStatusCode>(normalizedStatus));
+    response->setContentTypeCode(drogon::CT_TEXT_HTML);
+    response->setBody(rendered.html);
+    for (const auto &[headerName, headerValue] : rendered.headers) {
+        if (toLowerCopy(headerName) == "content-type") {
+            // A fragment's JSON body; drogon keeps the content type apart
+            // from the other headers.
+            response->setContentTypeString(headerValue);
             continue;
         }
-
-        if (key.find("entry-client") != std::string::npos ||
-            file.find("client") != std::string::npos) {
-            return &entry;
-        }
-
-        if (fallback == nullptr && file.ends_with(".js")) {
-            fallback = &entry;
-        }
+        response->addHeader(headerName, headerValue);
     }
-
-    return fallback;
+    return response;
 }
 
-std::optional<HtmlShellAssets> resolveAssetsFromManifest(
-    const std::string &manifestPath,
-    const std::string &publicPrefix,
-    const std::string &clientEntryKey) {
-    std::ifstream input(manifestPath);
-    if (!input) {
-        LOG_WARN << "HydraStack manifest not found: " << manifestPath;
-        return std::nullopt;
-    }
-
-    Json::Value manifest;
-    Json::CharReaderBuilder readerBuilder;
-    JSONCPP_STRING errors;
-    if (!Json::parseFromStream(readerBuilder, input, &manifest, &errors) ||
-        !manifest.isObject()) {
-        LOG_WARN << "HydraStack manifest parse failed: " << manifestPath
-                 << " error: " << errors;
-        return std::nullopt;
-    }
-
-    const auto *clientEntry = findClientEntry(manifest, clientEntryKey);
-    if (clientEntry == nullptr) {
-        LOG_WARN << "HydraStack manifest has no client entry: " << clientEntryKey;
-        return std::nullopt;
-    }
+HtmlShellPageMeta pageMetaFor(const SsrRenderResult &page) {
+    HtmlShellPageMeta meta;
+    meta.title = page.title;
+    meta.description = page.description;
+    meta.canonicalUrl = page.canonicalUrl;
+    meta.robots = page.robots;
+    meta.ogType = page.ogType;
+    meta.imageUrl = page.imageUrl;
+    meta.siteName = page.siteName;
+    meta.twitterCard = page.twitterCard;
+    return meta;
+}
 
-    HtmlShellAssets assets;
-    assets.cssPath.clear();
-    assets.clientJsPath.clear();
-    assets.clientJsPath =
-        toPublicAssetPath(clientEntry->get("file", "").asString(), publicPrefix);
+// Copies a cached fragment's status/headers/meta; the HTML is re-wrapped.
+SsrRenderResult withoutHtml(const SsrRenderResult &fragment) {
+    SsrRenderResult result;
+    result.status = fragment.status;
+    result.headers = fragment.headers;
+    result.title = fragment.title;
+    result.description = fragment.description;
+    result.canonicalUrl = fragment.canonicalUrl;
+    result.robots = fragment.robots;
+    result.ogType = fragment.ogType;
+    result.imageUrl = fragment.imageUrl;
+    result.siteName = fragment.siteName;
+    result.twitterCard = fragment.twitterCard;
+    return result;
+}
 
-    if (clientEntry->isMember("css") && (*clientEntry)["css"].isArray() &&
-        !(*clientEntry)["css"].empty()) {
-        assets.cssPath =
-            toPublicAssetPath((*clientEntry)["css"][0].asString(), publicPrefix);
+void addVary(SsrRenderResult *response, const std::string &header) {
+    auto &vary = response->headers["Vary"];
+    if (vary.empty()) {
+        vary = header;
+    } else if (!containsText(toLowerCopy(vary), toLowerCopy(header))) {
+        vary += ", " + header;
     }
+}
 
-    if (assets.cssPath.empty()) {
-        if (clientEntry->isMember("imports") && (*clientEntry)["imports"].isArray()) {
-            for (const auto &importValue : (*clientEntry)["imports"]) {
-                if (!importValue.isString()) {
-                    continue;
-                }
-                const auto importKey = importValue.asString();
-                if (!manifest.isMember(importKey) || !manifest[importKey].isObject()) {
-                    continue;
-                }
-                const auto &importEntry = manifest[importKey];
-                if (!importEntry.isMember("css") || !importEntry["css"].isArray() ||
-                    importEntry["css"].empty()) {
-                    continue;
-                }
+props_json::ObjectShape propsShapeOf(const Json::Value &props, const std::string &propsJson) {
+    props_json::ObjectShape shape;
+    const auto closeOffset = propsJson.rfind('}');
+    if (!props.isObject() || closeOffset == std::string::npos) {
+        return shape;
+    }
+    shape.isObject = true;
+    shape.empty = props.empty();
+    shape.closeOffset = closeOffset;
+    const auto &route = props["__hydra_route"];
+    if (route.isObject() && route["pageId"].isString()) {
+        shape.pageId = route["pageId"].asString();
+    } else if (props["page"].isString()) {
+        shape.pageId = props["page"].asString();
+    }
+    return shape;
+}
 
-                assets.cssPath =
-                    toPublicAssetPath(importEntry["css"][0].asString(), publicPrefix);
+// Page ids come from props, so anything can reach a label value.
+std::string escapePrometheusLabel(std::string_view value) {
+    std::string out;
+    out.reserve(value.size());
+    for (const char ch : value) {
+        switch (ch) {
+            case '\\':
+                out += "\\\\";
                 break;
-            }
-        }
-    }
-
-    if (assets.cssPath.empty()) {
-        if (manifest.isMember("style.css") && manifest["style.css"].isObject()) {
-            const auto file = manifest["style.css"].get("file", "").asString();
-            if (!file.empty()) {
-                assets.cssPath = toPublicAssetPath(file, publicPrefix);
-            }
-        }
-    }
-
-    if (assets.cssPath.empty()) {
-        for (const auto &key : manifest.getMemberNames()) {
-            if (!manifest[key].isObject()) {
-                continue;
-            }
-
-            const auto file = manifest[key].get("file", "").asString();
-            if (file.ends_with(".css")) {
-                assets.cssPath = toPublicAssetPath(file, publicPrefix);
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += ch;
                 break;
-            }
         }
     }
-
-    if (assets.clientJsPath.empty()) {
-        LOG_WARN << "HydraStack manifest missing JS file for client entry";
-        return std::nullopt;
-    }
-
-    return assets;
+    return out;
 }
 
-std::optional<SsrRenderResult> tryParseSsrEnvelope(const std::string &renderOutput) {
-    const auto firstNonWs = std::find_if_not(
-        renderOutput.begin(), renderOutput.end(), [](unsigned char ch) {
-            return std::isspace(ch) != 0;
-        });
-    if (firstNonWs == renderOutput.end() || *firstNonWs != '{') {
-        return std::nullopt;
-    }
-
-    Json::Value payload;
-    Json::CharReaderBuilder builder;
-    JSONCPP_STRING errors;
-    std::istringstream stream(renderOutput);
-    if (!Json::parseFromStream(builder, stream, &payload, &errors) || !payload.isObject()) {
-        return std::nullopt;
-    }
-    if (!payload.isMember("html")) {
-        return std::nullopt;
-    }
-
-    SsrRenderResult result;
-    if (payload["html"].isString()) {
-        result.html = payload["html"].asString();
-    } else {
-        result.html.clear();
-    }
-
-    const auto status = payload.get("status", 200).asInt();
-    result.status = status >= 100 && status <= 599 ? status : 200;
+// Set from the SIGHUP handler, consumed by the reload thread.
+std::atomic<bool> reloadSignalled{false};
 
-    if (payload.isMember("headers") && payload["headers"].isObject()) {
-        for (const auto &headerName : payload["headers"].getMemberNames()) {
-            const auto &headerValue = payload["headers"][headerName];
-            if (headerValue.isString()) {
-                result.headers[headerName] = headerValue.asString();
-            } else if (headerValue.isBool()) {
-                result.headers[headerName] = headerValue.asBool() ? "true" : "false";
-            } else if (headerValue.isNumeric()) {
-                result.headers[headerName] = headerValue.asString();
-            }
-        }
-    }
+extern "C" void onReloadSignal(int) {
+    reloadSignalled.store(true, std::memory_order_relaxed);
+}
 
-    if (payload.isMember("meta") && payload["meta"].isObject()) {
-        const auto &meta = payload["meta"];
-        const auto readMetaString = [&](const char *key) {
-            return meta.isMember(key) && meta[key].isString()
-                       ? trimAsciiWhitespace(meta[key].asString())
-                       : std::string();
-        };
-        result.title = readMetaString("title");
-        result.description = readMetaString("description");
-        result.canonicalUrl = readMetaString("canonicalUrl");
-        if (result.canonicalUrl.empty()) {
-            result.canonicalUrl = readMetaString("canonical_url");
-        }
-        result.robots = readMetaString("robots");
-        result.ogType = readMetaString("ogType");
-        if (result.ogType.empty()) {
-            result.ogType = readMetaString("og_type");
-        }
-        result.imageUrl = readMetaString("imageUrl");
-        if (result.imageUrl.empty()) {
-            result.imageUrl = readMetaString("image_url");
-        }
-        result.siteName = readMetaString("siteName");
-        if (result.siteName.empty()) {
-            result.siteName = readMetaString("site_name");
-        }
-        result.twitterCard = readMetaString("twitterCard");
-        if (result.twitterCard.empty()) {
-            result.twitterCard = readMetaString("twitter_card");
-        }
+// Size and mtime of `path`, or empty when it cannot be read; a reload is due
+// once this changes and holds still for one watch tick.
+std::string fileStamp(const std::string &path) {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return {};
     }
-
-    if (payload.isMember("redirect") && payload["redirect"].isString()) {
-        const auto redirectTarget = trimAsciiWhitespace(payload["redirect"].asString());
-        if (!redirectTarget.empty()) {
-            result.headers["Location"] = redirectTarget;
-            if (result.status < 300 || result.status > 399) {
-                result.status = 302;
-            }
-        }
-    } else if (result.headers.find("Location") != result.headers.end() &&
-               (result.status < 300 || result.status > 399)) {
-        result.status = 302;
+    const auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return {};
     }
-
-    return result;
+    return std::to_string(size) + ":" +
+           std::to_string(modified.time_since_epoch().count());
 }
 
 }  // namespace
@@ -706,338 +499,163 @@ std::string HydraSsrPlugin::buildRouteUrl(const drogon::HttpRequestPtr &req,
 Json::Value HydraSsrPlugin::buildRequestContext(const drogon::HttpRequestPtr &req,
                                                 const std::string &routeUrl,
                                                 const std::string &requestId) const {
-    Json::Value context(Json::objectValue);
-    context["routeUrl"] = routeUrl;
-    context["requestId"] = requestId;
-    context["locale"] = i18nDefaultLocale_;
-    context["theme"] = themeDefault_;
-    context["themeCookieName"] = themeCookieName_;
-    context["themeQueryParam"] = themeQueryParam_;
-    {
-        Json::Value supportedThemes(Json::arrayValue);
-        for (const auto &themeName : themeSupportedThemeOrder_) {
-            supportedThemes.append(themeName);
-        }
-        if (supportedThemes.empty()) {
-            supportedThemes.append(themeDefault_);
-        }
-        context["themeSupportedThemes"] = std::move(supportedThemes);
-    }
-    if (!req) {
-        context["routePath"] = routeUrl;
-        context["pathWithQuery"] = routeUrl;
-        context["url"] = routeUrl;
-        if (i18nIncludeLocaleCandidates_) {
-            Json::Value candidates(Json::arrayValue);
-            candidates.append(i18nDefaultLocale_);
-            context["localeCandidates"] = std::move(candidates);
-        }
-        if (themeIncludeThemeCandidates_) {
-            Json::Value candidates(Json::arrayValue);
-            candidates.append(themeDefault_);
-            context["themeCandidates"] = std::move(candidates);
+    return requestContextBuilder_->build(req, routeUrl, requestId);
+}
+
+std::string HydraSsrPlugin::resolveRequestId(const drogon::HttpRequestPtr &req) const {
+    if (req) {
+        const auto headerRequestId =
+            sanitizeRequestId(firstHeaderToken(req->getHeader("x-request-id")));
+        if (!headerRequestId.empty()) {
+            return headerRequestId;
         }
-        return context;
     }
 
-    const std::string routePath = req->path().empty() ? "/" : req->path();
-    const auto &query = req->query();
-    std::string pathWithQuery = routePath;
-    if (!query.empty()) {
-        pathWithQuery.push_back('?');
-        pathWithQuery.append(query);
-    }
-    context["routePath"] = routePath;
-    context["pathWithQuery"] = pathWithQuery;
+    const auto generated = requestIdCounter_.fetch_add(1, std::memory_order_relaxed) + 1;
+    return "hydra-" + std::to_string(generated);
+}
 
-    std::string host = firstHeaderToken(req->getHeader("x-forwarded-host"));
-    if (host.empty()) {
-        host = firstHeaderToken(req->getHeader("host"));
+std::optional<ApiBridgeResponse> HydraSsrPlugin::rejectApiBridge(
+    ApiBridgeRequest *request) const {
+    ApiBridgeResponse response;
+    if (!apiBridgeEnabled_) {
+        response.status = 503;
+        response.body = "Hydra API bridge disabled";
+        return response;
     }
 
-    std::string proto = toLowerCopy(firstHeaderToken(req->getHeader("x-forwarded-proto")));
-    if (proto.empty()) {
-        proto = "http";
-    } else if (proto != "https" && proto != "http") {
-        proto = "http";
+    auto normalizedMethod = trimAsciiWhitespace(request->method);
+    std::transform(normalizedMethod.begin(),
+                   normalizedMethod.end(),
+                   normalizedMethod.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::toupper(ch)); });
+    if (normalizedMethod.empty()) {
+        normalizedMethod = "GET";
     }
 
-    if (!host.empty()) {
-        context["url"] = proto + "://" + host + pathWithQuery;
-    } else {
-        context["url"] = pathWithQuery;
+    if (apiBridgeAllowedMethods_.find(normalizedMethod) == apiBridgeAllowedMethods_.end()) {
+        response.status = 405;
+        response.body = "Hydra API bridge method is not allowed: " + normalizedMethod;
+        return response;
     }
-    context["path"] = routePath;
-    context["query"] = query;
-    context["method"] = req->methodString();
 
-    std::vector<std::string> rawLocaleCandidates;
-    if (!i18nCookieName_.empty()) {
-        const auto cookieLocale = req->getCookie(i18nCookieName_);
-        if (!cookieLocale.empty()) {
-            rawLocaleCandidates.push_back(cookieLocale);
+    bool pathAllowed = false;
+    for (const auto &prefix : apiBridgeAllowedPathPrefixes_) {
+        if (prefix.empty()) {
+            continue;
         }
-    }
-    if (!i18nQueryParam_.empty()) {
-        const auto queryLocale = req->getParameter(i18nQueryParam_);
-        if (!queryLocale.empty()) {
-            rawLocaleCandidates.push_back(queryLocale);
+        if (request->path.rfind(prefix, 0) == 0) {
+            pathAllowed = true;
+            break;
         }
     }
+    if (!pathAllowed) {
+        response.status = 403;
+        response.body = "Hydra API bridge path is not allowed: " + request->path;
+        return response;
+    }
 
-    const auto acceptLanguageCandidates =
-        parseAcceptLanguageCandidates(req->getHeader("accept-language"));
-    rawLocaleCandidates.insert(rawLocaleCandidates.end(),
-                               acceptLanguageCandidates.begin(),
-                               acceptLanguageCandidates.end());
-    rawLocaleCandidates.push_back(i18nDefaultLocale_);
+    if (request->body.size() > apiBridgeMaxBodyBytes_) {
+        response.status = 413;
+        response.body = "Hydra API bridge body exceeds max_body_bytes";
+        return response;
+    }
 
-    std::vector<std::string> localeCandidates;
-    for (const auto &candidate : rawLocaleCandidates) {
-        const auto normalized = normalizeLocaleTag(candidate);
-        if (normalized.empty()) {
-            continue;
-        }
+    request->method = std::move(normalizedMethod);
+    return std::nullopt;
+}
 
-        for (const auto &fallbackLocale : localeFallbackChain(normalized)) {
-            appendUniqueString(&localeCandidates, fallbackLocale);
-        }
+ApiBridgeResponse HydraSsrPlugin::dispatchApiBridge(
+    const ApiBridgeRequest &request) const {
+    ApiBridgeHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(apiBridgeMutex_);
+        handler = apiBridgeHandler_;
     }
 
-    std::string resolvedLocale = i18nDefaultLocale_;
-    if (resolvedLocale.empty()) {
-        resolvedLocale = "en";
-    }
-    for (const auto &candidate : localeCandidates) {
-        if (i18nSupportedLocales_.empty() ||
-            i18nSupportedLocales_.find(candidate) != i18nSupportedLocales_.end()) {
-            resolvedLocale = candidate;
-            break;
-        }
-    }
-    if (!i18nSupportedLocales_.empty() &&
-        i18nSupportedLocales_.find(resolvedLocale) == i18nSupportedLocales_.end() &&
-        !i18nSupportedLocaleOrder_.empty()) {
-        resolvedLocale = i18nSupportedLocaleOrder_.front();
-    }
-    context["locale"] = resolvedLocale;
-    if (i18nIncludeLocaleCandidates_) {
-        Json::Value candidates(Json::arrayValue);
-        for (const auto &candidate : localeCandidates) {
-            candidates.append(candidate);
-        }
-        context["localeCandidates"] = std::move(candidates);
+    ApiBridgeResponse response;
+    if (!handler) {
+        response.status = apiBridgeEnabled_ ? 404 : 503;
+        response.body = apiBridgeEnabled_ ? "No Hydra API bridge handler registered"
+                                          : "Hydra API bridge disabled";
+        return response;
     }
 
-    std::vector<std::string> rawThemeCandidates;
-    if (!themeCookieName_.empty()) {
-        const auto cookieTheme = req->getCookie(themeCookieName_);
-        if (!cookieTheme.empty()) {
-            rawThemeCandidates.push_back(cookieTheme);
-        }
-    }
-    if (!themeQueryParam_.empty()) {
-        const auto queryTheme = req->getParameter(themeQueryParam_);
-        if (!queryTheme.empty()) {
-            rawThemeCandidates.push_back(queryTheme);
-        }
+    auto apiRequest = request;
+    if (auto rejected = rejectApiBridge(&apiRequest)) {
+        return std::move(*rejected);
     }
-    rawThemeCandidates.push_back(themeDefault_);
 
-    std::vector<std::string> themeCandidates;
-    for (const auto &candidate : rawThemeCandidates) {
-        const auto normalized = normalizeThemeTag(candidate);
-        if (normalized.empty()) {
-            continue;
-        }
-        appendUniqueString(&themeCandidates, normalized);
-    }
-
-    std::string resolvedTheme = themeDefault_.empty() ? "ocean" : themeDefault_;
-    for (const auto &candidate : themeCandidates) {
-        if (themeSupportedThemes_.empty() ||
-            themeSupportedThemes_.find(candidate) != themeSupportedThemes_.end()) {
-            resolvedTheme = candidate;
-            break;
-        }
-    }
-    if (!themeSupportedThemes_.empty() &&
-        themeSupportedThemes_.find(resolvedTheme) == themeSupportedThemes_.end() &&
-        !themeSupportedThemeOrder_.empty()) {
-        resolvedTheme = themeSupportedThemeOrder_.front();
-    }
-    context["theme"] = resolvedTheme;
-    if (themeIncludeThemeCandidates_) {
-        Json::Value candidates(Json::arrayValue);
-        for (const auto &candidate : themeCandidates) {
-            candidates.append(candidate);
-        }
-        context["themeCandidates"] = std::move(candidates);
-    }
-
-    const auto shouldIncludeHeader = [&](const std::string &headerName) {
-        const auto normalized = toLowerCopy(headerName);
-        if (normalized.rfind("x-forwarded-", 0) == 0) {
-            return false;
-        }
-        if (normalized == "authorization" ||
-            normalized == "proxy-authorization" ||
-            normalized == "cookie" ||
-            normalized == "set-cookie" ||
-            normalized == "x-api-key") {
-            return false;
-        }
-        if (!requestContextHeaderAllowlist_.empty() &&
-            requestContextHeaderAllowlist_.find(normalized) ==
-                requestContextHeaderAllowlist_.end()) {
-            return false;
-        }
-        return requestContextHeaderBlocklist_.find(normalized) ==
-               requestContextHeaderBlocklist_.end();
-    };
-
-    Json::Value headers(Json::objectValue);
-    for (const auto &[headerName, headerValue] : req->getHeaders()) {
-        if (!shouldIncludeHeader(headerName)) {
-            continue;
-        }
-        headers[headerName] = headerValue;
-    }
-    context["headers"] = std::move(headers);
-
-    const auto shouldIncludeCookie = [&](const std::string &cookieName) {
-        if (requestContextAllowedCookies_.empty()) {
-            return true;
-        }
-        return requestContextAllowedCookies_.find(toLowerCopy(cookieName)) !=
-               requestContextAllowedCookies_.end();
-    };
-
-    Json::Value cookieMap(Json::objectValue);
-    std::string cookieHeader;
-    bool firstCookie = true;
-    if (requestContextIncludeCookies_ || requestContextIncludeCookieMap_) {
-        for (const auto &[cookieName, cookieValue] : req->getCookies()) {
-            if (!shouldIncludeCookie(cookieName)) {
-                continue;
-            }
-
-            if (requestContextIncludeCookieMap_) {
-                cookieMap[cookieName] = cookieValue;
-            }
-
-            if (requestContextIncludeCookies_) {
-                if (!firstCookie) {
-                    cookieHeader.append("; ");
-                }
-                cookieHeader.append(cookieName);
-                cookieHeader.push_back('=');
-                cookieHeader.append(cookieValue);
-                firstCookie = false;
-            }
-        }
-    }
-
-    if (requestContextIncludeCookies_ &&
-        cookieHeader.empty() &&
-        requestContextAllowedCookies_.empty()) {
-        cookieHeader = req->getHeader("cookie");
-    }
-
-    context["cookies"] = requestContextIncludeCookies_ ? cookieHeader : "";
-    if (requestContextIncludeCookieMap_) {
-        context["cookieMap"] = std::move(cookieMap);
-    }
-    return context;
-}
-
-std::string HydraSsrPlugin::resolveRequestId(const drogon::HttpRequestPtr &req) const {
-    if (req) {
-        const auto headerRequestId =
-            sanitizeRequestId(firstHeaderToken(req->getHeader("x-request-id")));
-        if (!headerRequestId.empty()) {
-            return headerRequestId;
-        }
+    try {
+        const auto apiResponse = handler(apiRequest);
+        response.status = apiResponse.status;
+        response.body = apiResponse.body;
+        response.headers = apiResponse.headers;
+    } catch (const std::exception &ex) {
+        response.status = 500;
+        response.body = ex.what();
+    } catch (...) {
+        response.status = 500;
+        response.body = "Unknown Hydra API bridge error";
     }
 
-    const auto generated = requestIdCounter_.fetch_add(1, std::memory_order_relaxed) + 1;
-    return "hydra-" + std::to_string(generated);
+    return response;
 }
 
-ApiBridgeResponse HydraSsrPlugin::dispatchApiBridge(
-    const ApiBridgeRequest &request) const {
-    ApiBridgeResponse response;
-    if (!apiBridgeEnabled_) {
-        response.status = 503;
-        response.body = "Hydra API bridge disabled";
-        return response;
-    }
-
-    ApiBridgeHandler handler;
+std::vector<ApiBridgeResponse> HydraSsrPlugin::dispatchApiBridgeBatch(
+    std::vector<ApiBridgeRequest> requests) const {
+    ApiBridgeBatchHandler batchHandler;
     {
         std::lock_guard<std::mutex> lock(apiBridgeMutex_);
-        handler = apiBridgeHandler_;
-    }
-
-    if (!handler) {
-        response.status = 404;
-        response.body = "No Hydra API bridge handler registered";
-        return response;
-    }
-
-    auto normalizedMethod = trimAsciiWhitespace(request.method);
-    std::transform(normalizedMethod.begin(),
-                   normalizedMethod.end(),
-                   normalizedMethod.begin(),
-                   [](unsigned char ch) { return static_cast<char>(std::toupper(ch)); });
-    if (normalizedMethod.empty()) {
-        normalizedMethod = "GET";
+        batchHandler = apiBridgeBatchHandler_;
     }
 
-    if (apiBridgeAllowedMethods_.find(normalizedMethod) == apiBridgeAllowedMethods_.end()) {
-        response.status = 405;
-        response.body = "Hydra API bridge method is not allowed: " + normalizedMethod;
-        return response;
+    std::vector<ApiBridgeResponse> responses(requests.size());
+    if (!batchHandler) {
+        for (std::size_t index = 0; index < requests.size(); ++index) {
+            responses[index] = dispatchApiBridge(requests[index]);
+        }
+        return responses;
     }
 
-    bool pathAllowed = false;
-    for (const auto &prefix : apiBridgeAllowedPathPrefixes_) {
-        if (prefix.empty()) {
-            continue;
-        }
-        if (request.path.rfind(prefix, 0) == 0) {
-            pathAllowed = true;
-            break;
+    // Rejected calls are answered here; the rest go to the handler at once.
+    std::vector<ApiBridgeRequest> allowed;
+    std::vector<std::size_t> allowedIndices;
+    for (std::size_t index = 0; index < requests.size(); ++index) {
+        if (auto rejected = rejectApiBridge(&requests[index])) {
+            responses[index] = std::move(*rejected);
+        } else {
+            allowedIndices.push_back(index);
+            allowed.push_back(std::move(requests[index]));
         }
     }
-    if (!pathAllowed) {
-        response.status = 403;
-        response.body = "Hydra API bridge path is not allowed: " + request.path;
-        return response;
-    }
-
-    if (request.body.size() > apiBridgeMaxBodyBytes_) {
-        response.status = 413;
-        response.body = "Hydra API bridge body exceeds max_body_bytes";
-        return response;
+    if (allowed.empty()) {
+        return responses;
     }
 
+    std::vector<ApiBridgeResponse> handled;
+    std::string failure;
     try {
-        auto apiRequest = request;
-        apiRequest.method = normalizedMethod;
-        const auto apiResponse = handler(apiRequest);
-        response.status = apiResponse.status;
-        response.body = apiResponse.body;
-        response.headers = apiResponse.headers;
+        handled = batchHandler(allowed);
     } catch (const std::exception &ex) {
-        response.status = 500;
-        response.body = ex.what();
+        failure = ex.what();
     } catch (...) {
-        response.status = 500;
-        response.body = "Unknown Hydra API bridge error";
+        failure = "Unknown Hydra API bridge error";
     }
-
-    return response;
+    if (failure.empty() && handled.size() != allowed.size()) {
+        failure = "Hydra API bridge batch handler returned " + std::to_string(handled.size()) +
+                  " responses for " + std::to_string(allowed.size()) + " requests";
+    }
+    for (std::size_t position = 0; position < allowedIndices.size(); ++position) {
+        auto &response = responses[allowedIndices[position]];
+        if (failure.empty()) {
+            response = std::move(handled[position]);
+        } else {
+            response.status = 500;
+            response.body = failure;
+        }
+    }
+    return responses;
 }
 
 void HydraSsrPlugin::registerDevProxyRoutes() {
@@ -1111,6 +729,7 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
     logRenderMetrics_ = normalizedConfig_.logRenderMetrics;
     logRequestRoutes_ = normalizedConfig_.logRequestRoutes;
     devModeEnabled_ = normalizedConfig_.devModeEnabled;
+    etagEnabled_ = normalizedConfig_.etagEnabled && !devModeEnabled_;
     devProxyAssetsEnabled_ = normalizedConfig_.devProxyAssetsEnabled;
     devInjectHmrClient_ = normalizedConfig_.devInjectHmrClient;
     devAnsiColorLogs_ = normalizedConfig_.devAnsiColorLogs;
@@ -1134,6 +753,7 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
     const Json::Value *apiBridgeConfig =
         config.isMember("api_bridge") && config["api_bridge"].isObject() ? &config["api_bridge"]
                                                                            : nullptr;
+    auto &contextOptions = requestContext_;
     auto readRequestContextBool = [&](const char *nestedKey,
                                       const char *topLevelKey,
                                       bool fallback) -> bool {
@@ -1142,6 +762,14 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
         }
         return config.get(topLevelKey, fallback).asBool();
     };
+    auto readRequestContextUInt64 = [&](const char *nestedKey,
+                                        const char *topLevelKey,
+                                        std::uint64_t fallback) -> std::uint64_t {
+        if (requestContextConfig && requestContextConfig->isMember(nestedKey)) {
+            return (*requestContextConfig)[nestedKey].asUInt64();
+        }
+        return config.get(topLevelKey, fallback).asUInt64();
+    };
     auto readI18nString = [&](const char *nestedKey,
                               const char *topLevelKey,
                               const std::string &fallback) -> std::string {
@@ -1190,26 +818,29 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
     };
     auto appendI18nLocaleArray = [&](const char *nestedKey, const char *topLevelKey) {
         if (i18nConfig && i18nConfig->isMember(nestedKey)) {
-            appendNormalizedLocaleArray(
-                (*i18nConfig)[nestedKey], &i18nSupportedLocales_, &i18nSupportedLocaleOrder_);
+            appendNormalizedLocaleArray((*i18nConfig)[nestedKey],
+                                        &contextOptions.supportedLocales,
+                                        &contextOptions.supportedLocaleOrder);
             return;
         }
         if (config.isMember(topLevelKey)) {
-            appendNormalizedLocaleArray(
-                config[topLevelKey], &i18nSupportedLocales_, &i18nSupportedLocaleOrder_);
+            appendNormalizedLocaleArray(config[topLevelKey],
+                                        &contextOptions.supportedLocales,
+                                        &contextOptions.supportedLocaleOrder);
         }
     };
     auto appendThemeArray = [&](const char *nestedKey, const char *topLevelKey) {
         if (themeConfig && themeConfig->isMember(nestedKey)) {
             appendNormalizedThemeArray(
                 (*themeConfig)[nestedKey],
-                &themeSupportedThemes_,
-                &themeSupportedThemeOrder_);
+                &contextOptions.supportedThemes,
+                &contextOptions.supportedThemeOrder);
             return;
         }
         if (config.isMember(topLevelKey)) {
-            appendNormalizedThemeArray(
-                config[topLevelKey], &themeSupportedThemes_, &themeSupportedThemeOrder_);
+            appendNormalizedThemeArray(config[topLevelKey],
+                                       &contextOptions.supportedThemes,
+                                       &contextOptions.supportedThemeOrder);
         }
     };
     auto appendApiBridgePathPrefixes = [&](const Json::Value &value) {
@@ -1260,100 +891,130 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
     }
     apiBridgeMaxBodyBytes_ = static_cast<std::size_t>(maxBodyBytes);
 
-    i18nDefaultLocale_ =
+    const auto readApiBridgeValue = [&](const char *nestedKey,
+                                        const char *topLevelKey) -> const Json::Value * {
+        if (apiBridgeConfig != nullptr && apiBridgeConfig->isMember(nestedKey)) {
+            return &(*apiBridgeConfig)[nestedKey];
+        }
+        if (config.isMember(topLevelKey)) {
+            return &config[topLevelKey];
+        }
+        return nullptr;
+    };
+    const auto *asyncThreadsValue =
+        readApiBridgeValue("async_threads", "api_bridge_async_threads");
+    const auto asyncThreads = asyncThreadsValue != nullptr ? asyncThreadsValue->asUInt64() : 4;
+    if (asyncThreads > 64) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'api_bridge.async_threads' must be in range 0..64");
+    }
+    apiBridgeAsyncThreads_ = static_cast<std::size_t>(asyncThreads);
+    const auto *maxBatchValue = readApiBridgeValue("max_batch", "api_bridge_max_batch");
+    const auto maxBatch = maxBatchValue != nullptr ? maxBatchValue->asUInt64() : 0;
+    if (maxBatch > 256) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'api_bridge.max_batch' must be in range 0..256");
+    }
+    apiBridgeMaxBatch_ = static_cast<std::size_t>(maxBatch);
+    const auto *memoizeValue = readApiBridgeValue("memoize", "api_bridge_memoize");
+    apiBridgeMemoize_ = memoizeValue != nullptr ? memoizeValue->asBool() : true;
+
+    contextOptions.defaultLocale =
         normalizeLocaleTag(readI18nString("defaultLocale", "i18n_default_locale", "en"));
-    if (i18nDefaultLocale_.empty()) {
-        i18nDefaultLocale_ = "en";
+    if (contextOptions.defaultLocale.empty()) {
+        contextOptions.defaultLocale = "en";
     }
-    i18nQueryParam_ = trimAsciiWhitespace(
+    contextOptions.localeQueryParam = trimAsciiWhitespace(
         readI18nString("queryParam", "i18n_query_param", "lang"));
-    if (i18nQueryParam_.empty()) {
-        i18nQueryParam_ = "lang";
+    if (contextOptions.localeQueryParam.empty()) {
+        contextOptions.localeQueryParam = "lang";
     }
-    i18nCookieName_ = trimAsciiWhitespace(
+    contextOptions.localeCookieName = trimAsciiWhitespace(
         readI18nString("cookieName", "i18n_cookie_name", "hydra_lang"));
-    if (i18nCookieName_.empty()) {
-        i18nCookieName_ = "hydra_lang";
+    if (contextOptions.localeCookieName.empty()) {
+        contextOptions.localeCookieName = "hydra_lang";
     }
-    i18nIncludeLocaleCandidates_ = readI18nBool(
+    contextOptions.includeLocaleCandidates = readI18nBool(
         "includeLocaleCandidates",
         "i18n_include_locale_candidates",
         false);
-    i18nIncludeLocaleCandidates_ = readI18nBool(
+    contextOptions.includeLocaleCandidates = readI18nBool(
         "include_locale_candidates",
         "i18n_includeLocaleCandidates",
-        i18nIncludeLocaleCandidates_);
-    i18nSupportedLocales_.clear();
-    i18nSupportedLocaleOrder_.clear();
+        contextOptions.includeLocaleCandidates);
+    contextOptions.supportedLocales.clear();
+    contextOptions.supportedLocaleOrder.clear();
     appendI18nLocaleArray("supportedLocales", "i18n_supported_locales");
     appendI18nLocaleArray("supported_locales", "i18n_supportedLocales");
-    if (i18nSupportedLocales_.empty()) {
-        i18nSupportedLocales_.insert(i18nDefaultLocale_);
-        i18nSupportedLocaleOrder_.push_back(i18nDefaultLocale_);
-    } else if (i18nSupportedLocales_.find(i18nDefaultLocale_) ==
-               i18nSupportedLocales_.end()) {
-        i18nSupportedLocales_.insert(i18nDefaultLocale_);
-        i18nSupportedLocaleOrder_.push_back(i18nDefaultLocale_);
+    if (contextOptions.supportedLocales.empty()) {
+        contextOptions.supportedLocales.insert(contextOptions.defaultLocale);
+        contextOptions.supportedLocaleOrder.push_back(contextOptions.defaultLocale);
+    } else if (contextOptions.supportedLocales.find(contextOptions.defaultLocale) ==
+               contextOptions.supportedLocales.end()) {
+        contextOptions.supportedLocales.insert(contextOptions.defaultLocale);
+        contextOptions.supportedLocaleOrder.push_back(contextOptions.defaultLocale);
     }
 
-    themeDefault_ = normalizeThemeTag(readThemeString("defaultTheme", "theme_default", "ocean"));
-    if (themeDefault_.empty()) {
-        themeDefault_ = "ocean";
+    contextOptions.defaultTheme =
+        normalizeThemeTag(readThemeString("defaultTheme", "theme_default", "ocean"));
+    if (contextOptions.defaultTheme.empty()) {
+        contextOptions.defaultTheme = "ocean";
     }
-    themeQueryParam_ = trimAsciiWhitespace(
+    contextOptions.themeQueryParam = trimAsciiWhitespace(
         readThemeString("queryParam", "theme_query_param", "theme"));
-    if (themeQueryParam_.empty()) {
-        themeQueryParam_ = "theme";
+    if (contextOptions.themeQueryParam.empty()) {
+        contextOptions.themeQueryParam = "theme";
     }
-    themeCookieName_ = trimAsciiWhitespace(
+    contextOptions.themeCookieName = trimAsciiWhitespace(
         readThemeString("cookieName", "theme_cookie_name", "hydra_theme"));
-    if (themeCookieName_.empty()) {
-        themeCookieName_ = "hydra_theme";
+    if (contextOptions.themeCookieName.empty()) {
+        contextOptions.themeCookieName = "hydra_theme";
     }
-    themeIncludeThemeCandidates_ = readThemeBool(
+    contextOptions.includeThemeCandidates = readThemeBool(
         "includeThemeCandidates",
         "theme_include_theme_candidates",
         false);
-    themeIncludeThemeCandidates_ = readThemeBool(
+    contextOptions.includeThemeCandidates = readThemeBool(
         "include_theme_candidates",
         "theme_includeThemeCandidates",
-        themeIncludeThemeCandidates_);
-    themeSupportedThemes_.clear();
-    themeSupportedThemeOrder_.clear();
+        contextOptions.includeThemeCandidates);
+    contextOptions.supportedThemes.clear();
+    contextOptions.supportedThemeOrder.clear();
     appendThemeArray("supportedThemes", "theme_supported_themes");
     appendThemeArray("supported_themes", "theme_supportedThemes");
-    if (themeSupportedThemes_.empty()) {
-        themeSupportedThemes_.insert(themeDefault_);
-        themeSupportedThemeOrder_.push_back(themeDefault_);
-    } else if (themeSupportedThemes_.find(themeDefault_) == themeSupportedThemes_.end()) {
-        themeSupportedThemes_.insert(themeDefault_);
-        themeSupportedThemeOrder_.push_back(themeDefault_);
+    if (contextOptions.supportedThemes.empty()) {
+        contextOptions.supportedThemes.insert(contextOptions.defaultTheme);
+        contextOptions.supportedThemeOrder.push_back(contextOptions.defaultTheme);
+    } else if (contextOptions.supportedThemes.find(contextOptions.defaultTheme) ==
+               contextOptions.supportedThemes.end()) {
+        contextOptions.supportedThemes.insert(contextOptions.defaultTheme);
+        contextOptions.supportedThemeOrder.push_back(contextOptions.defaultTheme);
     }
 
-    requestContextIncludeCookies_ = readRequestContextBool(
+    contextOptions.includeCookies = readRequestContextBool(
         "include_cookies", "request_context_include_cookies", false);
-    requestContextIncludeCookieMap_ = readRequestContextBool(
+    contextOptions.includeCookieMap = readRequestContextBool(
         "includeCookieMap",
         "request_context_includeCookieMap",
-        requestContextIncludeCookies_);
-    requestContextIncludeCookieMap_ = readRequestContextBool(
+        contextOptions.includeCookies);
+    contextOptions.includeCookieMap = readRequestContextBool(
         "include_cookie_map",
         "request_context_include_cookie_map",
-        requestContextIncludeCookieMap_);
+        contextOptions.includeCookieMap);
 
-    requestContextAllowedCookies_.clear();
+    contextOptions.allowedCookies.clear();
     appendRequestContextArray(
-        "allowed_cookies", "request_context_allowed_cookies", &requestContextAllowedCookies_);
+        "allowed_cookies", "request_context_allowed_cookies", &contextOptions.allowedCookies);
 
-    requestContextHeaderAllowlist_.clear();
+    contextOptions.headerAllowlist.clear();
     appendRequestContextArray(
-        "include_headers", "request_context_include_headers", &requestContextHeaderAllowlist_);
+        "include_headers", "request_context_include_headers", &contextOptions.headerAllowlist);
     appendRequestContextArray(
         "include_header_allowlist",
         "request_context_include_header_allowlist",
-        &requestContextHeaderAllowlist_);
+        &contextOptions.headerAllowlist);
 
-    requestContextHeaderBlocklist_ = {
+    contextOptions.headerBlocklist = {
         "authorization",
         "proxy-authorization",
         "cookie",
@@ -1361,11 +1022,23 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
         "x-api-key",
     };
     appendRequestContextArray(
-        "exclude_headers", "request_context_exclude_headers", &requestContextHeaderBlocklist_);
+        "exclude_headers", "request_context_exclude_headers", &contextOptions.headerBlocklist);
     appendRequestContextArray(
         "include_header_blocklist",
         "request_context_include_header_blocklist",
-        &requestContextHeaderBlocklist_);
+        &contextOptions.headerBlocklist);
+
+    contextOptions.lazyDetails = readRequestContextBool(
+        "lazy_details", "request_context_lazy_details", false);
+    const auto localeCacheEntries = readRequestContextUInt64(
+        "locale_cache_entries", "request_context_locale_cache_entries", 1024);
+    if (localeCacheEntries > 65536) {
+        throw std::runtime_error(
+            "HydraSsrPlugin config 'request_context.locale_cache_entries' must be in range "
+            "0..65536");
+    }
+    contextOptions.localeCacheEntries = static_cast<std::size_t>(localeCacheEntries);
+    requestContextBuilder_ = std::make_unique<RequestContextBuilder>(contextOptions);
 
     {
         std::lock_guard<std::mutex> lock(apiBridgeMutex_);
@@ -1389,111 +1062,574 @@ void HydraSsrPlugin::initAndStart(const Json::Value &config) {
 
     clientJsModule_ = false;
     hmrClientPath_.clear();
-
-    if (auto manifestAssets = resolveAssetsFromManifest(
-            assetManifestPath_, assetPublicPrefix_, clientManifestEntry_)) {
-        if (cssPath_.empty()) {
-            cssPath_ = manifestAssets->cssPath;
-        }
-        if (clientJsPath_.empty()) {
-            clientJsPath_ = manifestAssets->clientJsPath;
-        }
-    }
-
     if (devModeEnabled_) {
-        cssPath_ = devProxyAssetsEnabled_
-                       ? normalizeBrowserPath(devCssPath_)
-                       : joinOriginAndPath(devProxyOrigin_, devCssPath_);
         clientJsModule_ = true;
-
         if (devProxyAssetsEnabled_) {
-            clientJsPath_ = normalizeBrowserPath(devClientEntryPath_);
             if (devInjectHmrClient_) {
                 hmrClientPath_ = normalizeBrowserPath(devHmrClientPath_);
             }
             registerDevProxyRoutes();
-        } else {
-            clientJsPath_ = joinOriginAndPath(devProxyOrigin_, devClientEntryPath_);
-            if (devInjectHmrClient_) {
-                hmrClientPath_ = joinOriginAndPath(devProxyOrigin_, devHmrClientPath_);
-            }
-        }
-    } else {
-        if (cssPath_.empty()) {
-            cssPath_ = "/assets/app.css";
-            LOG_WARN << "HydraStack falling back to default css path: " << cssPath_;
-        }
-        if (clientJsPath_.empty()) {
-            clientJsPath_ = "/assets/client.js";
-            LOG_WARN << "HydraStack falling back to default client path: " << clientJsPath_;
+        } else if (devInjectHmrClient_) {
+            hmrClientPath_ = joinOriginAndPath(devProxyOrigin_, devHmrClientPath_);
         }
     }
 
-    const auto configuredPoolSize = config.isMember("pool_size")
-                                        ? config["pool_size"].asUInt()
-                                        : config.get("isolate_pool_size", 0).asUInt();
     const auto threadCount = std::max<std::size_t>(1, drogon::app().getThreadNum());
+    const auto configuredPoolMin = normalizedConfig_.poolMin > 0 ? normalizedConfig_.poolMin
+                                                                 : normalizedConfig_.poolSize;
     isolatePoolSize_ =
-        configuredPoolSize > 0 ? static_cast<std::size_t>(configuredPoolSize) : threadCount;
+        configuredPoolMin > 0 ? static_cast<std::size_t>(configuredPoolMin) : threadCount;
+    isolatePoolMax_ = normalizedConfig_.poolMax > 0
+                          ? static_cast<std::size_t>(normalizedConfig_.poolMax)
+                          : isolatePoolSize_;
+    // An unset minimum defaults to the IO thread count, which may exceed an
+    // explicit maximum.
+    isolatePoolSize_ = std::min(isolatePoolSize_, isolatePoolMax_);
+    V8IsolatePoolOptions poolOptions;
+    poolOptions.minSize = isolatePoolSize_;
+    poolOptions.maxSize = isolatePoolMax_;
+    poolOptions.growQueueDepth = static_cast<std::size_t>(normalizedConfig_.poolGrowQueueDepth);
+    poolOptions.growWait = std::chrono::milliseconds(normalizedConfig_.poolGrowWaitMs);
+    poolOptions.idleTtl = std::chrono::milliseconds(normalizedConfig_.poolIdleTtlMs);
+    poolOptions.standbyCount = static_cast<std::size_t>(normalizedConfig_.poolStandby);
+    poolOptions.threadAffinity = normalizedConfig_.poolThreadAffinity;
+    poolOptions.idleGc = normalizedConfig_.v8HeapIdleGc;
+    poolOptions.idleGcDelay = std::chrono::milliseconds(normalizedConfig_.v8HeapIdleGcDelayMs);
+    if (normalizedConfig_.warmupEnabled && devModeEnabled_) {
+        LOG_WARN << "HydraSsrPlugin warmup is ignored in dev mode";
+    } else if (normalizedConfig_.warmupEnabled) {
+        struct WarmupRender {
+            std::string url;
+            V8SsrRuntime::PropsPayload propsJson;
+            std::string requestContextJson;
+        };
+        auto renders = std::make_shared<std::vector<WarmupRender>>();
+        for (const auto &route : normalizedConfig_.warmupRoutes) {
+            WarmupRender render;
+            render.url = route.url;
+            render.requestContextJson =
+                toCompactJson(buildRequestContext(nullptr, route.url, "hydra-warmup"));
+            render.propsJson = std::make_shared<const std::string>(
+                props_json::appendMember(route.propsJson,
+                                         props_json::scanObject(route.propsJson),
+                                         "__hydra_request",
+                                         render.requestContextJson));
+            renders->push_back(std::move(render));
+        }
+        // Routes are interleaved so V8 optimizes for the mix rather than for
+        // whichever route ran last. A route that fails is dropped for the
+        // rest of that runtime's warm-up.
+        poolOptions.warmup = [this, renders, iterations = normalizedConfig_.warmupIterations](
+                                 V8SsrRuntime &runtime) {
+            std::vector<bool> failed(renders->size(), false);
+            auto remaining = renders->size();
+            for (std::uint64_t i = 0; i < iterations && remaining > 0; ++i) {
+                for (std::size_t r = 0; r < renders->size(); ++r) {
+                    if (failed[r]) {
+                        continue;
+                    }
+                    const auto &render = (*renders)[r];
+                    try {
+                        (void)runtime.renderOutput(render.url,
+                                                   render.propsJson,
+                                                   render.requestContextJson,
+                                                   renderTimeoutMs_);
+                    } catch (const std::exception &ex) {
+                        failed[r] = true;
+                        --remaining;
+                        warmupRenderFailures_.fetch_add(1, std::memory_order_relaxed);
+                        LOG_WARN << "HydraSsrPlugin warm-up render of " << render.url
+                                 << " failed: " << ex.what();
+                    }
+                }
+            }
+        };
+    }
 
     V8Platform::initialize();
+    V8RuntimeOptions runtimeOptions;
+    runtimeOptions.maxHeapBytes = static_cast<std::size_t>(normalizedConfig_.v8HeapMaxMb) << 20;
+    runtimeOptions.recycleAfterRenders = normalizedConfig_.v8HeapRecycleAfterRenders;
+    runtimeOptions.recycleHeapGrowthPercent = normalizedConfig_.v8HeapRecycleGrowthPercent;
+    if (normalizedConfig_.v8CodeCacheEnabled) {
+        v8CodeCache_ = std::make_shared<V8CodeCache>(ssrBundlePath_,
+                                                     normalizedConfig_.v8CodeCachePath,
+                                                     normalizedConfig_.v8CodeCachePersist);
+        runtimeOptions.codeCache = v8CodeCache_;
+    }
+
+    const auto toApiRequest = [](const BridgeRequest &request) {
+        ApiBridgeRequest apiRequest;
+        apiRequest.method = request.method;
+        apiRequest.path = request.path;
+        apiRequest.query = request.query;
+        apiRequest.body = request.body;
+        apiRequest.headers = request.headers;
+        return apiRequest;
+    };
+    const auto toBridgeResponse = [](ApiBridgeResponse apiResponse) {
+        BridgeResponse response;
+        response.status = apiResponse.status;
+        response.body = std::move(apiResponse.body);
+        response.headers = std::move(apiResponse.headers);
+        return response;
+    };
+    const V8IsolatePool::FetchBridge fetchBridge =
+        [this, toApiRequest, toBridgeResponse](const BridgeRequest &request) {
+            // Runs inside lease->render(), on the render thread or on a
+            // bridge worker, with the calling request's trace active.
+            auto *trace = RenderTrace::active();
+            RenderTrace::Scope bridgeSpan(
+                trace, "bridge", trace != nullptr ? request.method + " " + request.path : "");
+            const auto startedAt = std::chrono::steady_clock::now();
+            auto apiResponse = dispatchApiBridge(toApiRequest(request));
+            bridgeCallHistogram_.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - startedAt)
+                    .count()));
+            bridgeSpan.end(apiResponse.status >= 500);
+            return toBridgeResponse(std::move(apiResponse));
+        };
+    if (apiBridgeAsyncThreads_ > 0) {
+        BridgeDispatcher::Options dispatcherOptions;
+        dispatcherOptions.threads = apiBridgeAsyncThreads_;
+        dispatcherOptions.maxBatch = apiBridgeMaxBatch_;
+        bridgeDispatcher_ = std::make_shared<BridgeDispatcher>(
+            dispatcherOptions,
+            fetchBridge,
+            [this, toApiRequest, toBridgeResponse](const std::vector<BridgeRequest> &requests) {
+                auto *trace = RenderTrace::active();
+                RenderTrace::Scope bridgeSpan(
+                    trace,
+                    "bridge",
+                    trace != nullptr ? "batch " + std::to_string(requests.size()) : "");
+                std::vector<ApiBridgeRequest> apiRequests;
+                apiRequests.reserve(requests.size());
+                for (const auto &request : requests) {
+                    apiRequests.push_back(toApiRequest(request));
+                }
+                const auto startedAt = std::chrono::steady_clock::now();
+                auto apiResponses = dispatchApiBridgeBatch(std::move(apiRequests));
+                const auto batchUs = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - startedAt)
+                        .count());
+                std::vector<BridgeResponse> responses;
+                responses.reserve(apiResponses.size());
+                bool failed = false;
+                for (auto &apiResponse : apiResponses) {
+                    bridgeCallHistogram_.record(batchUs);
+                    failed = failed || apiResponse.status >= 500;
+                    responses.push_back(toBridgeResponse(std::move(apiResponse)));
+                }
+                bridgeSpan.end(failed);
+                return responses;
+            });
+        runtimeOptions.bridgeDispatcher = bridgeDispatcher_;
+    }
+    runtimeOptions.bridgeMemoize = apiBridgeMemoize_;
+
+    buildGeneration_ = [this, poolOptions, runtimeOptions, fetchBridge](
+                           const RenderGeneration *previous) {
+        auto generation = std::make_shared<RenderGeneration>();
+        const auto manifest = loadAssetManifest();
+        resolveAssetPaths(manifest ? &*manifest : nullptr,
+                          &generation->cssPath,
+                          &generation->clientJsPath);
+        if (normalizedConfig_.criticalCssEnabled && !devModeEnabled_) {
+            generation->criticalCss =
+                loadCriticalCss(manifest ? &*manifest : nullptr, generation->cssPath);
+        }
+        generation->shell = std::make_unique<const CompiledHtmlShell>(shellDefaults(*generation));
+        // Dev servers serve unbundled modules the manifest does not describe.
+        if (manifest && normalizedConfig_.earlyHintsEnabled && !devModeEnabled_) {
+            buildPreloads(*manifest, generation.get());
+        }
+        if (normalizedConfig_.renderCacheSharedEnabled && !devModeEnabled_) {
+            std::ifstream bundle(ssrBundlePath_, std::ios::binary);
+            std::ostringstream bundleText;
+            bundleText << bundle.rdbuf();
+            std::ifstream manifestFile(assetManifestPath_, std::ios::binary);
+            std::ostringstream manifestText;
+            manifestText << manifestFile.rdbuf();
+            // The empty page stands in for the shell's config-derived text.
+            auto digest = combineHash(hash64(bundleText.str()), hash64(manifestText.str()));
+            digest = combineHash(digest, hash64(generation->shell->wrap({}, "{}", {}, {})));
+            generation->buildId = hashToHex(digest);
+        }
+
+        auto options = runtimeOptions;
+        if (normalizedConfig_.v8SnapshotEnabled) {
+            const auto snapshotStartedAt = std::chrono::steady_clock::now();
+            try {
+                if (previous != nullptr && previous->snapshot) {
+                    std::ifstream input(ssrBundlePath_, std::ios::binary);
+                    std::ostringstream bundle;
+                    bundle << input.rdbuf();
+                    if (input &&
+                        V8StartupSnapshot::keyForBundle(bundle.str()) == previous->snapshot->key()) {
+                        generation->snapshot = previous->snapshot;
+                        generation->snapshotStatus = "reused";
+                    }
+                }
+                if (!generation->snapshot) {
+                    generation->snapshot = V8StartupSnapshot::loadOrCreate(
+                        ssrBundlePath_,
+                        normalizedConfig_.v8SnapshotPath,
+                        normalizedConfig_.v8SnapshotPersist);
+                    generation->snapshotStatus = generation->snapshot->origin();
+                }
+                const auto snapshotMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                            std::chrono::steady_clock::now() - snapshotStartedAt)
+                                            .count();
+                LOG_INFO << logfmt::Line("HydraSnapshot")
+                                .group("v8_snapshot",
+                                       {{"origin", generation->snapshotStatus},
+                                        {"bytes",
+                                         std::to_string(generation->snapshot->sizeBytes())},
+                                        {"key", generation->snapshot->key()},
+                                        {"ms", std::to_string(snapshotMs)}})
+                                .str();
+            } catch (const std::exception &ex) {
+                generation->snapshot.reset();
+                generation->snapshotStatus = "failed";
+                LOG_WARN << "HydraSsrPlugin V8 snapshot unavailable, evaluating bundle per "
+                            "runtime: "
+                         << ex.what();
+            }
+            options.startupSnapshot = generation->snapshot;
+        }
+
+        // At startup the pool warms in the background and readiness() waits
+        // for it; a reload warms before the swap while the old pool serves.
+        auto generationPoolOptions = poolOptions;
+        generationPoolOptions.warmupInBackground = previous == nullptr;
+        try {
+            generation->pool.reset(new V8IsolatePool(
+                generationPoolOptions, ssrBundlePath_, renderTimeoutMs_, fetchBridge, options));
+        } catch (const std::exception &ex) {
+            if (!options.startupSnapshot) {
+                throw;
+            }
+            // A blob V8 refuses to deserialize must not take the service down.
+            LOG_WARN << "HydraSsrPlugin V8 snapshot rejected at isolate creation, "
+                     << "evaluating bundle per runtime: " << ex.what();
+            generation->snapshot.reset();
+            generation->snapshotStatus = "rejected";
+            options.startupSnapshot.reset();
+            generation->pool.reset(new V8IsolatePool(
+                generationPoolOptions, ssrBundlePath_, renderTimeoutMs_, fetchBridge, options));
+        }
+        return generation;
+    };
+
     try {
-        isolatePool_.reset(new V8IsolatePool(
-            isolatePoolSize_,
-            ssrBundlePath_,
-            renderTimeoutMs_,
-            [this](const V8SsrRuntime::BridgeRequest &request) {
-                ApiBridgeRequest apiRequest;
-                apiRequest.method = request.method;
-                apiRequest.path = request.path;
-                apiRequest.query = request.query;
-                apiRequest.body = request.body;
-                apiRequest.headers = request.headers;
-
-                const auto apiResponse = dispatchApiBridge(apiRequest);
-                V8SsrRuntime::BridgeResponse response;
-                response.status = apiResponse.status;
-                response.body = apiResponse.body;
-                response.headers = apiResponse.headers;
-                return response;
-            }));
+        const auto buildStartedAt = std::chrono::steady_clock::now();
+        auto generation = buildGeneration_(nullptr);
+        generation->id = 1;
+        generation->reason = "startup";
+        generation->loadedAt = std::chrono::system_clock::now();
+        generation->buildMs = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - buildStartedAt)
+                .count());
+        std::lock_guard<std::mutex> lock(generationMutex_);
+        generation_ = std::move(generation);
     } catch (...) {
         V8Platform::shutdown();
         throw;
     }
 
+    renderThreadCount_ = normalizedConfig_.renderThreads > 0
+                             ? static_cast<std::size_t>(normalizedConfig_.renderThreads)
+                             : isolatePoolMax_;
+    renderExecutor_ = std::make_unique<RenderExecutor>(
+        renderThreadCount_,
+        "hydra-render",
+        static_cast<std::size_t>(normalizedConfig_.renderQueueMax));
+
+    if (normalizedConfig_.renderCacheEnabled && devModeEnabled_) {
+        LOG_WARN << "HydraSsrPlugin render_cache is ignored in dev mode";
+    } else if (normalizedConfig_.renderCacheEnabled) {
+        const auto toPolicy = [](const HydraRenderCachePageConfig &page) {
+            RenderCache::Policy policy;
+            policy.ttl = std::chrono::milliseconds(page.ttlMs);
+            policy.staleWhileRevalidate = std::chrono::milliseconds(page.staleWhileRevalidateMs);
+            return policy;
+        };
+        renderCacheDefaultPolicy_ = toPolicy(normalizedConfig_.renderCacheDefaultPolicy);
+        for (const auto &[pageId, page] : normalizedConfig_.renderCachePages) {
+            renderCachePolicies_[pageId] = toPolicy(page);
+        }
+        renderCache_ = std::make_unique<RenderCache>(
+            static_cast<std::size_t>(normalizedConfig_.renderCacheMaxBytes),
+            static_cast<std::size_t>(normalizedConfig_.renderCacheShards));
+        if (normalizedConfig_.renderCacheSharedEnabled) {
+            SharedRenderCache::Options sharedOptions;
+            sharedOptions.redisClient = normalizedConfig_.renderCacheSharedRedisClient;
+            sharedOptions.keyPrefix = normalizedConfig_.renderCacheSharedKeyPrefix;
+            sharedOptions.timeout =
+                std::chrono::milliseconds(normalizedConfig_.renderCacheSharedTimeoutMs);
+            sharedOptions.maxEntryBytes =
+                static_cast<std::size_t>(normalizedConfig_.renderCacheSharedMaxEntryBytes);
+            sharedOptions.gzip = normalizedConfig_.renderCacheSharedGzip;
+            sharedOptions.tagRefreshInterval =
+                std::chrono::milliseconds(normalizedConfig_.renderCacheSharedTagRefreshMs);
+            sharedRenderCache_ = std::make_shared<SharedRenderCache>(std::move(sharedOptions));
+            // Drogon creates its Redis clients once the app runs.
+            drogon::app().getLoop()->queueInLoop(
+                [shared = sharedRenderCache_] { shared->start(); });
+        }
+    }
+
+    if (normalizedConfig_.compressionEnabled && normalizedConfig_.compressionBrotli &&
+        !brotliSupported()) {
+        LOG_WARN << "HydraSsrPlugin compression.brotli is on but this build has no brotli "
+                 << "encoder; responses fall back to gzip";
+    }
+    if (normalizedConfig_.compressionStaticSidecars) {
+        // The UI build writes .gz/.br files beside hashed assets; Drogon's
+        // static handler picks them by Accept-Encoding.
+        drogon::app().setGzipStatic(true);
+        drogon::app().setBrStatic(true);
+    }
+
+    if (normalizedConfig_.prerenderEnabled && devModeEnabled_) {
+        LOG_WARN << "HydraSsrPlugin prerender is ignored in dev mode";
+    } else if (normalizedConfig_.prerenderEnabled && !normalizedConfig_.prerenderRoutes.empty()) {
+        Prerenderer::Options prerenderOptions;
+        prerenderOptions.outputRoot = std::filesystem::path(drogon::app().getDocumentRoot()) /
+                                      normalizedConfig_.prerenderOutputDir;
+        prerenderOptions.urlPrefix = "/" + normalizedConfig_.prerenderOutputDir;
+        const auto variantTags = [](const std::vector<std::string> &configured,
+                                    const std::vector<std::string> &supportedOrder,
+                                    const std::unordered_set<std::string> &supported,
+                                    std::string (*normalize)(std::string),
+                                    const std::string &routePath) {
+            if (configured.empty()) {
+                return supportedOrder;
+            }
+            std::vector<std::string> tags;
+            for (const auto &value : configured) {
+                auto tag = normalize(value);
+                if (supported.find(tag) == supported.end()) {
+                    LOG_WARN << "HydraSsrPlugin prerender skips unsupported variant '" << value
+                             << "' for " << routePath;
+                    continue;
+                }
+                tags.push_back(std::move(tag));
+            }
+            return tags;
+        };
+        for (const auto &routeConfig : normalizedConfig_.prerenderRoutes) {
+            Prerenderer::Route route;
+            route.path = routeConfig.path;
+            route.revalidate = std::chrono::seconds(routeConfig.revalidateSec);
+            route.locales = variantTags(routeConfig.locales,
+                                        contextOptions.supportedLocaleOrder,
+                                        contextOptions.supportedLocales,
+                                        normalizeLocaleTag,
+                                        routeConfig.path);
+            route.themes = variantTags(routeConfig.themes,
+                                       contextOptions.supportedThemeOrder,
+                                       contextOptions.supportedThemes,
+                                       normalizeThemeTag,
+                                       routeConfig.path);
+            prerenderOptions.routes.push_back(std::move(route));
+        }
+        prerenderToken_ = generateScriptNonce();
+        prerenderStopping_ = false;
+        const auto requestTimeout =
+            std::chrono::milliseconds(isolateAcquireTimeoutMs_ + renderTimeoutMs_) +
+            kPrerenderRequestSlack;
+        // Each variant goes through the app's own handler, so the page gets
+        // the props its controller builds and renders through renderResult();
+        // the resolved locale and theme ride along as cookies.
+        prerenderer_ = std::make_unique<Prerenderer>(
+            std::move(prerenderOptions),
+            [this, requestTimeout](
+                const Prerenderer::Variant &variant) -> std::optional<std::string> {
+                auto req = drogon::HttpRequest::newHttpRequest();
+                req->setMethod(drogon::Get);
+                req->setPath(variant.path);
+                req->addCookie(requestContext_.localeCookieName, variant.locale);
+                req->addCookie(requestContext_.themeCookieName, variant.theme);
+                req->addHeader(kPrerenderHeader, prerenderToken_);
+                auto promise = std::make_shared<std::promise<drogon::HttpResponsePtr>>();
+                auto future = promise->get_future();
+                drogon::app().forward(
+                    req,
+                    [promise](const drogon::HttpResponsePtr &response) {
+                        promise->set_value(response);
+                    },
+                    "",
+                    static_cast<double>(requestTimeout.count()) / 1000.0);
+                const auto deadline = std::chrono::steady_clock::now() + requestTimeout;
+                while (future.wait_for(std::chrono::milliseconds(50)) !=
+                       std::future_status::ready) {
+                    if (prerenderStopping_.load(std::memory_order_relaxed) ||
+                        std::chrono::steady_clock::now() >= deadline) {
+                        LOG_WARN << "HydraSsrPlugin prerender of " << variant.path
+                                 << " gave up waiting for the response";
+                        return std::nullopt;
+                    }
+                }
+                const auto response = future.get();
+                if (!response || response->getStatusCode() != drogon::k200OK) {
+                    LOG_WARN << "HydraSsrPlugin prerender of " << variant.path << " ["
+                             << variant.locale << "/" << variant.theme << "] returned "
+                             << (response ? static_cast<int>(response->getStatusCode()) : 0)
+                             << ", keeping the previous file";
+                    return std::nullopt;
+                }
+                return std::string(response->getBody());
+            });
+        drogon::app().registerPreRoutingAdvice(
+            [this](const drogon::HttpRequestPtr &req) { routeToPrerendered(req); });
+        // Forwarded requests need running loops.
+        drogon::app().getLoop()->queueInLoop([this] {
+            if (prerenderer_) {
+                prerenderer_->start();
+            }
+        });
+    }
+
+    if (logRenderMetrics_ || logRequestRoutes_) {
+        RenderEventLog::Options logOptions;
+        logOptions.ringCapacity = static_cast<std::size_t>(normalizedConfig_.renderLogRingCapacity);
+        logOptions.sampleRate = normalizedConfig_.renderLogSampleRate;
+        logOptions.slowThresholdUs = normalizedConfig_.renderLogSlowMs * 1000;
+        logOptions.alwaysLogFailures = normalizedConfig_.renderLogAlwaysFailures;
+        logOptions.flushInterval =
+            std::chrono::milliseconds(normalizedConfig_.renderLogFlushIntervalMs);
+        renderEventLog_ = std::make_unique<RenderEventLog>(
+            logOptions, [this](const RenderEvent &event) { writeRenderEvent(event); });
+    }
+
+    if (normalizedConfig_.admissionEnabled) {
+        const auto toPolicy = [](const HydraAdmissionPriorityConfig &priority) {
+            AdmissionController::PriorityPolicy policy;
+            policy.maxWaitUs = priority.maxWaitMs * 1000;
+            policy.action = priority.reject ? ShedAction::kReject : ShedAction::kShell;
+            return policy;
+        };
+        AdmissionController::Options admissionOptions;
+        admissionOptions.policies[static_cast<std::size_t>(RequestPriority::kHigh)] =
+            toPolicy(normalizedConfig_.admissionHigh);
+        admissionOptions.policies[static_cast<std::size_t>(RequestPriority::kNormal)] =
+            toPolicy(normalizedConfig_.admissionNormal);
+        admissionOptions.policies[static_cast<std::size_t>(RequestPriority::kLow)] =
+            toPolicy(normalizedConfig_.admissionLow);
+        admissionHealthPaths_ = normalizedConfig_.admissionHealthPaths;
+        admissionSessionCookies_ = normalizedConfig_.admissionSessionCookies;
+        admissionBotUserAgents_ = normalizedConfig_.admissionBotUserAgents;
+        admissionRetryAfterSec_ = normalizedConfig_.admissionRetryAfterSec;
+        admission_ = std::make_unique<AdmissionController>(admissionOptions);
+    }
+
+    histogramBoundsMs_ = normalizedConfig_.metricsHistogramBoundsMs;
+    histogramBoundsUs_.clear();
+    for (const auto boundMs : histogramBoundsMs_) {
+        histogramBoundsUs_.push_back(static_cast<std::uint64_t>(std::llround(boundMs * 1000.0)));
+    }
+    latencyQuantiles_ = normalizedConfig_.metricsQuantiles;
+    if (normalizedConfig_.metricsMaxRoutes > 0) {
+        routeLatency_ = std::make_unique<RouteLatencyMetrics>(
+            static_cast<std::size_t>(normalizedConfig_.metricsMaxRoutes),
+            LatencyHistogram::kDefaultShards);
+    }
+
+    tracingEnabled_ = normalizedConfig_.tracingEnabled;
+    tracingSampleRate_ = normalizedConfig_.tracingSampleRate;
+    tracingServerTiming_ = normalizedConfig_.tracingServerTiming;
+    if (tracingEnabled_ && !normalizedConfig_.tracingOtlpEndpoint.empty()) {
+        auto [origin, path] = splitOtlpEndpoint(normalizedConfig_.tracingOtlpEndpoint);
+        TraceExporter::Options exporterOptions;
+        exporterOptions.serviceName = normalizedConfig_.tracingServiceName;
+        exporterOptions.maxQueuedTraces =
+            static_cast<std::size_t>(normalizedConfig_.tracingMaxQueuedTraces);
+        exporterOptions.flushInterval =
+            std::chrono::milliseconds(normalizedConfig_.tracingFlushIntervalMs);
+        // POSTs go out on the app loop; the exporter thread only encodes.
+        auto client = drogon::HttpClient::newHttpClient(origin);
+        traceExporter_ = std::make_unique<TraceExporter>(
+            std::move(exporterOptions),
+            [client, endpointPath = std::move(path)](std::string otlpJson) {
+                auto request = drogon::HttpRequest::newHttpRequest();
+                request->setMethod(drogon::Post);
+                request->setPath(endpointPath);
+                request->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+                request->setBody(std::move(otlpJson));
+                client->sendRequest(
+                    request,
+                    [](drogon::ReqResult result, const drogon::HttpResponsePtr &response) {
+                        if (result != drogon::ReqResult::Ok || !response ||
+                            static_cast<int>(response->getStatusCode()) >= 300) {
+                            LOG_WARN << "HydraSsrPlugin OTLP trace export failed"
+                                     << (response ? ", status=" +
+                                                        std::to_string(static_cast<int>(
+                                                            response->getStatusCode()))
+                                                  : std::string{});
+                        }
+                    },
+                    kOtlpExportTimeoutSec);
+            });
+    }
+
+    if (normalizedConfig_.hotReloadEnabled) {
+#ifdef SIGHUP
+        if (normalizedConfig_.hotReloadSignal) {
+            std::signal(SIGHUP, onReloadSignal);
+        }
+#endif
+        reloadStopping_ = false;
+        reloadThread_ = std::thread([this] { runReloadLoop(); });
+    }
+
+    const auto poolSizeText =
+        isolatePoolMax_ > isolatePoolSize_
+            ? std::to_string(isolatePoolSize_) + ".." + std::to_string(isolatePoolMax_)
+            : std::to_string(isolatePoolSize_);
     if (devModeEnabled_) {
         auto line = logfmt::Line("HydraInit")
                         .block(summarizeHydraSsrPluginConfig(normalizedConfig_))
-                        .group("runtime", {{"pool", std::to_string(isolatePoolSize_)}})
+                        .group("runtime",
+                               {{"pool", poolSizeText},
+                                {"render_threads", std::to_string(renderThreadCount_)},
+                                {"bridge_threads", std::to_string(apiBridgeAsyncThreads_)}})
                         .group("flags",
                                {{"dev", logfmt::onOff(devModeEnabled_)},
                                 {"api_bridge", logfmt::onOff(apiBridgeEnabled_)},
-                                {"include_cookies", logfmt::onOff(requestContextIncludeCookies_)},
+                                {"include_cookies", logfmt::onOff(contextOptions.includeCookies)},
                                 {"include_cookie_map",
-                                 logfmt::onOff(requestContextIncludeCookieMap_)},
+                                 logfmt::onOff(contextOptions.includeCookieMap)},
                                 {"request_routes", logfmt::onOff(logRequestRoutes_)}})
                         .group("defaults",
-                               {{"locale", i18nDefaultLocale_}, {"theme", themeDefault_}});
+                               {{"locale", contextOptions.defaultLocale},
+                                {"theme", contextOptions.defaultTheme}});
         LOG_INFO << maybeColorizeLog(line.str(), "1;36", ansiColorLogsActive_);
     } else {
         auto infoLine = logfmt::Line("HydraInit")
                             .block(summarizeHydraSsrPluginConfig(normalizedConfig_))
-                            .group("runtime", {{"pool", std::to_string(isolatePoolSize_)}})
+                            .group("runtime",
+                               {{"pool", poolSizeText},
+                                {"render_threads", std::to_string(renderThreadCount_)},
+                                {"bridge_threads", std::to_string(apiBridgeAsyncThreads_)}})
                             .group("flags",
                                    {{"dev", logfmt::onOff(devModeEnabled_)},
                                     {"api_bridge", logfmt::onOff(apiBridgeEnabled_)},
                                     {"request_routes", logfmt::onOff(logRequestRoutes_)}})
                             .group("defaults",
-                                   {{"locale", i18nDefaultLocale_}, {"theme", themeDefault_}});
+                                   {{"locale", contextOptions.defaultLocale},
+                                    {"theme", contextOptions.defaultTheme}});
         LOG_INFO << maybeColorizeLog(infoLine.str(), "1;36", ansiColorLogsActive_);
 
         auto debugLine = logfmt::Line("HydraInit detail")
                              .group("flags",
                                     {{"include_cookies",
-                                      logfmt::onOff(requestContextIncludeCookies_)},
+                                      logfmt::onOff(contextOptions.includeCookies)},
                                      {"include_cookie_map",
-                                      logfmt::onOff(requestContextIncludeCookieMap_)}});
+                                      logfmt::onOff(contextOptions.includeCookieMap)}});
         LOG_DEBUG << maybeColorizeLog(debugLine.str(), "2;37", ansiColorLogsActive_);
     }
 }
@@ -1503,65 +1639,141 @@ void HydraSsrPlugin::setApiBridgeHandler(ApiBridgeHandler handler) {
     apiBridgeHandler_ = std::move(handler);
 }
 
+void HydraSsrPlugin::setApiBridgeBatchHandler(ApiBridgeBatchHandler handler) {
+    std::lock_guard<std::mutex> lock(apiBridgeMutex_);
+    apiBridgeBatchHandler_ = std::move(handler);
+}
+
 void HydraSsrPlugin::shutdown() {
-    isolatePool_.reset();
+    if (reloadThread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(reloadMutex_);
+            reloadStopping_ = true;
+        }
+        reloadCv_.notify_all();
+        reloadThread_.join();
+    }
+    if (prerenderer_) {
+        prerenderStopping_ = true;
+        prerenderer_->stop();
+        prerenderer_.reset();
+    }
+    if (renderExecutor_) {
+        renderExecutor_->shutdown();
+        renderExecutor_.reset();
+    }
+    if (sharedRenderCache_) {
+        sharedRenderCache_->stop();
+        sharedRenderCache_.reset();
+    }
+    // Joins the drain thread after writing out whatever is still queued.
+    renderEventLog_.reset();
+    // Hands whatever is still queued to the collector before the loop stops.
+    traceExporter_.reset();
+    admission_.reset();
+    {
+        std::lock_guard<std::mutex> lock(generationMutex_);
+        generation_.reset();
+    }
+    // After the pool: no render is left waiting on a bridge call.
+    if (bridgeDispatcher_) {
+        bridgeDispatcher_->shutdown();
+        bridgeDispatcher_.reset();
+    }
     V8Platform::shutdown();
 }
 
 std::string HydraSsrPlugin::render(const drogon::HttpRequestPtr &req,
                                    const Json::Value &props,
                                    const RenderOptions &options) const {
-    return renderResult(req, props, options).html;
+    auto plain = options;
+    plain.compress = false;
+    return renderResult(req, props, plain).html;
 }
 
 std::string HydraSsrPlugin::render(const drogon::HttpRequestPtr &req,
                                    const std::string &propsJson,
                                    const RenderOptions &options) const {
-    return renderResult(req, propsJson, options).html;
+    auto plain = options;
+    plain.compress = false;
+    return renderResult(req, propsJson, plain).html;
 }
 
 SsrRenderResult HydraSsrPlugin::renderResult(const drogon::HttpRequestPtr &req,
                                              const Json::Value &props,
                                              const RenderOptions &options) const {
-    return renderResult(req, toCompactJson(props), options);
+    if (!currentGeneration()) {
+        return unavailableResult(req, 500, "HydraSsrPlugin is not initialized");
+    }
+
+    // Serialized once; the page id and splice point come from the value
+    // itself rather than from re-parsing the JSON.
+    const auto serializeStartedAt = RenderTrace::Clock::now();
+    const auto propsJson = toCompactJson(props);
+    const auto serializedAt = RenderTrace::Clock::now();
+    auto prepared = prepareRender(req, propsJson, propsShapeOf(props, propsJson), options);
+    if (prepared.trace) {
+        prepared.trace->addSpan("serialize", serializeStartedAt, serializedAt);
+    }
+    return renderPrepared(req, propsJson, prepared);
 }
 
 SsrRenderResult HydraSsrPlugin::renderResult(const drogon::HttpRequestPtr &req,
                                              const std::string &propsJson,
                                              const RenderOptions &options) const {
-    if (!isolatePool_) {
-        SsrRenderResult unavailable;
-        unavailable.status = 500;
-        unavailable.html = HtmlShell::errorPage("HydraSsrPlugin is not initialized");
-        unavailable.headers["X-Request-Id"] = resolveRequestId(req);
-        unavailable.headers["X-Content-Type-Options"] = "nosniff";
-        unavailable.headers["Referrer-Policy"] = "strict-origin-when-cross-origin";
-        return unavailable;
-    }
-
-    const auto routeUrl = buildRouteUrl(req, options);
-    const auto requestId = resolveRequestId(req);
-    const auto requestContext = buildRequestContext(req, routeUrl, requestId);
-    const auto requestContextJson = toCompactJson(requestContext);
-    std::string effectivePropsJson = propsJson;
-    Json::Value propsObject;
-    std::string pageId;
-    if (parseJsonObject(propsJson, &propsObject)) {
-        const auto route = propsObject["__hydra_route"];
-        if (route.isObject() && route["pageId"].isString()) {
-            pageId = route["pageId"].asString();
-        } else if (propsObject["page"].isString()) {
-            pageId = propsObject["page"].asString();
-        }
-        propsObject["__hydra_request"] = requestContext;
-        effectivePropsJson = toCompactJson(propsObject);
+    if (!currentGeneration()) {
+        return unavailableResult(req, 500, "HydraSsrPlugin is not initialized");
     }
-    const auto acquireStartedAt = std::chrono::steady_clock::now();
-    const auto requestStartedAt = acquireStartedAt;
+
+    return renderPrepared(req, propsJson, prepareRender(req, propsJson, options));
+}
+
+SsrRenderResult HydraSsrPlugin::renderFragment(const drogon::HttpRequestPtr &req,
+                                               const Json::Value &props,
+                                               const std::string &componentId,
+                                               const RenderOptions &options) const {
+    if (!currentGeneration()) {
+        return unavailableResult(req, 500, "HydraSsrPlugin is not initialized");
+    }
+    if (componentId.empty()) {
+        return unavailableResult(req, 400, "renderFragment requires a component id");
+    }
+
+    const auto propsJson = toCompactJson(props);
+    auto prepared = prepareRender(req, propsJson, propsShapeOf(props, propsJson), options);
+    prepared.componentId = componentId;
+    prepared.fragmentFormat = options.fragmentFormat;
+    return renderComponentPrepared(req, propsJson, prepared);
+}
+
+SsrRenderResult HydraSsrPlugin::renderFragment(const drogon::HttpRequestPtr &req,
+                                               const std::string &propsJson,
+                                               const std::string &componentId,
+                                               const RenderOptions &options) const {
+    if (!currentGeneration()) {
+        return unavailableResult(req, 500, "HydraSsrPlugin is not initialized");
+    }
+    if (componentId.empty()) {
+        return unavailableResult(req, 400, "renderFragment requires a component id");
+    }
+
+    auto prepared = prepareRender(req, propsJson, options);
+    prepared.componentId = componentId;
+    prepared.fragmentFormat = options.fragmentFormat;
+    return renderComponentPrepared(req, propsJson, prepared);
+}
+
+SsrRenderResult HydraSsrPlugin::renderPrepared(const drogon::HttpRequestPtr &req,
+                                               const std::string &propsJson,
+                                               const PreparedRender &prepared) const {
+    const auto &routeUrl = prepared.routeUrl;
+    const auto &requestId = prepared.requestId;
+    const auto &effectivePropsJson = *prepared.propsJson;
+    const auto &pageId = prepared.pageId;
+    const auto &scriptNonce = prepared.scriptNonce;
+    const auto requestStartedAt = std::chrono::steady_clock::now();
     std::uint64_t acquireWaitUs = 0;
-    double acquireWaitMs = 0.0;
     const auto requestMethod = req ? req->methodString() : std::string("GET");
-    const auto scriptNonce = devModeEnabled_ ? std::string{} : generateScriptNonce();
     const auto requestElapsedUs = [&]() {
         return static_cast<std::uint64_t>(
             std::chrono::duration_cast<std::chrono::microseconds>(
@@ -1569,238 +1781,1903 @@ SsrRenderResult HydraSsrPlugin::renderResult(const drogon::HttpRequestPtr &req,
                 .count());
     };
 
-    const auto logRenderOk = [&](std::uint64_t renderIndex,
-                                 double renderMs,
-                                 double wrapMs,
-                                 int statusCode) {
-        if (!logRenderMetrics_) {
-            return;
-        }
-
-        LOG_INFO << "HydraMetrics"
-                 << " | status=ok"
-                 << " | count=" << renderIndex
-                 << " | route=" << routeUrl
-                 << " | request_id=" << requestId
-                 << " | http_status=" << statusCode
-                 << " | latency_ms{acquire=" << acquireWaitMs
-                 << ", render=" << renderMs
-                 << ", wrap=" << wrapMs << "}"
-                 << " | counters{pool_timeouts="
-                 << poolTimeoutCount_.load(std::memory_order_relaxed)
-                 << ", render_timeouts="
-                 << renderTimeoutCount_.load(std::memory_order_relaxed)
-                 << ", runtime_recycles="
-                 << runtimeRecycleCount_.load(std::memory_order_relaxed)
-                 << "}";
-    };
-
-    const auto logRenderFail = [&](const std::string &errorMessage, int statusCode) {
-        if (!logRenderMetrics_) {
+    FragmentTiming timing;
+    const auto logRequest = [&](bool failed,
+                                int statusCode,
+                                std::uint64_t totalUs,
+                                std::uint64_t renderIndex,
+                                std::uint64_t renderUs,
+                                std::uint64_t wrapUs,
+                                const char *cacheStatus,
+                                std::string_view errorMessage) {
+        if (!shouldLogRenderEvent(failed, totalUs)) {
             return;
         }
-
-        LOG_WARN << "HydraMetrics"
-                 << " | status=fail"
-                 << " | route=" << routeUrl
-                 << " | request_id=" << requestId
-                 << " | http_status=" << statusCode
-                 << " | latency_ms{acquire=" << acquireWaitMs
-                 << ", wrap=0}"
-                 << " | counters{pool_timeouts="
-                 << poolTimeoutCount_.load(std::memory_order_relaxed)
-                 << ", render_timeouts="
-                 << renderTimeoutCount_.load(std::memory_order_relaxed)
-                 << ", runtime_recycles="
-                 << runtimeRecycleCount_.load(std::memory_order_relaxed)
-                 << "} | error=\"" << errorMessage << "\"";
+        RenderEvent event;
+        event.failed = failed;
+        event.httpStatus = statusCode;
+        event.renderIndex = renderIndex;
+        event.acquireUs = acquireWaitUs;
+        event.renderUs = renderUs;
+        event.wrapUs = wrapUs;
+        event.totalUs = totalUs;
+        event.cache = cacheStatus;
+        event.bridgeCalls = timing.bridge.syncCalls + timing.bridge.asyncCalls;
+        event.bridgeMemoized = timing.bridge.memoized;
+        event.bridgeWaitUs = timing.bridge.waitUs;
+        event.method.assign(requestMethod);
+        event.error.assign(errorMessage);
+        logRenderEvent(prepared, event);
     };
-
-    const auto logRequestRoute = [&](const char *status,
-                                     double totalMs,
-                                     int statusCode,
-                                     const std::string *errorMessage = nullptr) {
-        if (!logRequestRoutes_) {
-            return;
+    const char *cacheStatus = nullptr;
+    const auto cachePolicy = renderCachePolicyFor(pageId);
+    try {
+        SsrRenderResult renderResult;
+        RenderCache::Value cachedFragment;
+        if (renderCache_ && cachePolicy.ttl.count() > 0) {
+            // Keyed on the controller props, not effectivePropsJson: the
+            // embedded __hydra_request differs on every request.
+            const auto cacheKey = renderCacheKey(prepared, routeUrl, propsJson);
+            bool sharedHit = false;
+            auto lookup = renderCache_->getOrRender(
+                cacheKey,
+                cachePolicy,
+                [&]() {
+                    return produceCachedRender(
+                        cacheKey, cachePolicy, prepared, &timing, &sharedHit);
+                },
+                prepared.generation->id);
+            if (lookup.refresh) {
+                refreshCachedRender(cacheKey, cachePolicy, prepared);
+            }
+            cachedFragment = std::move(lookup.value);
+            cacheStatus = sharedHit ? "shared" : cacheOutcomeName(lookup.outcome);
+        } else {
+            renderResult = renderOnIsolate(prepared, &timing);
         }
-        if (errorMessage != nullptr) {
-            LOG_WARN << "HydraRequest"
-                     << " | status=" << status
-                     << " | method=" << requestMethod
-                     << " | route=" << routeUrl
-                     << " | request_id=" << requestId
-                     << " | http_status=" << statusCode
-                     << " | total_ms=" << totalMs
-                     << " | error=\"" << *errorMessage << "\"";
-            return;
+        const SsrRenderResult &fragment =
+            cachedFragment ? static_cast<const SsrRenderResult &>(*cachedFragment) : renderResult;
+        acquireWaitUs = timing.acquireWaitUs;
+        observeAcquireWait(acquireWaitUs);
+        const auto renderUs = timing.renderUs;
+        const auto renderIndex = timing.renderIndex > 0
+                                     ? timing.renderIndex
+                                     : renderCount_.load(std::memory_order_relaxed);
+        std::uint64_t wrapUs = 0;
+
+        const bool isRedirect = isRedirectResult(fragment);
+
+        // A cached page's ETag is only reused under the shell it was taken
+        // with; after a reload it is recomputed like a fresh render's.
+        std::string etag;
+        if (cachedFragment && cachedFragment->generation == prepared.generation->id) {
+            etag = cachedFragment->etag;
         }
-
-        LOG_INFO << "HydraRequest"
-                 << " | status=" << status
-                 << " | method=" << requestMethod
-                 << " | route=" << routeUrl
-                 << " | request_id=" << requestId
-                 << " | http_status=" << statusCode
-                 << " | page=" << (pageId.empty() ? "-" : pageId)
-                 << " | total_ms=" << totalMs;
+        // The 304 repeats the 200's caching headers but not its
+        // Content-Security-Policy: the client keeps the stored body, and the
+        // stored policy names that body's nonce.
+        const auto notModified = [&](std::string matched) {
+            SsrRenderResult response;
+            response.status = 304;
+            for (const char *name : {"Cache-Control", "Expires", "Vary"}) {
+                if (const auto it = fragment.headers.find(name); it != fragment.headers.end()) {
+                    response.headers.emplace(name, it->second);
+                }
+            }
+            response.headers["ETag"] = std::move(matched);
+            response.headers["X-Request-Id"] = requestId;
+            if (cacheStatus != nullptr) {
+                response.headers["X-Hydra-Cache"] = cacheStatus;
+            }
+            if (normalizedConfig_.compressionEnabled) {
+                addVary(&response, "Accept-Encoding");
+            }
+            (timing.renderIndex > 0 ? etagNotModifiedRendered_ : etagNotModifiedCached_)
+                .fetch_add(1, std::memory_order_relaxed);
+            const auto totalUs = requestElapsedUs();
+            requestOkCount_.fetch_add(1, std::memory_order_relaxed);
+            observeRequestCode(response.status);
+            observeRequestLatency(prepared, totalUs);
+            totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+            totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
+            logRequest(false, response.status, totalUs, renderIndex, renderUs, 0, cacheStatus,
+                       {});
+            finishTrace(prepared, response.status, false, &response);
+            return response;
+        };
+        // A hit that still validates skips critical CSS, wrapping and
+        // compression as well as the isolate.
+        if (!etag.empty() && ifNoneMatchMatches(prepared.ifNoneMatch, etag)) {
+            return notModified(std::move(etag));
+        }
+
+        if (wrapsFragment(fragment)) {
+            const auto wrapStartedAt = std::chrono::steady_clock::now();
+            RenderTrace::Scope wrapSpan(prepared.trace.get(), "wrap");
+            // A cached page spliced from its gzip blocks only needs the runs;
+            // the identity document is never assembled.
+            const bool splice = canSpliceGzip(prepared, cachedFragment.get());
+            std::vector<std::string> runs;
+            std::string wrappedHtml;
+            std::shared_ptr<const std::string> criticalCss;
+            const auto pageMeta = shellPageMeta(prepared, fragment, &criticalCss);
+            if (etag.empty()) {
+                etag = entityTagFor(prepared, fragment, &pageMeta);
+                if (!etag.empty() && ifNoneMatchMatches(prepared.ifNoneMatch, etag)) {
+                    return notModified(std::move(etag));
+                }
+            }
+            if (splice) {
+                runs = prepared.shell->wrapRuns(fragment.html,
+                                                effectivePropsJson,
+                                                prepared.requestPropsBegin,
+                                                prepared.requestPropsEnd,
+                                                pageMeta,
+                                                scriptNonce);
+            } else {
+                wrappedHtml = prepared.shell->wrap(
+                    fragment.html,
+                    effectivePropsJson,
+                    pageMeta,
+                    scriptNonce);
+            }
+            wrapSpan.end();
+            wrapUs = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - wrapStartedAt)
+                    .count());
+            if (cachedFragment) {
+                renderResult = withoutHtml(*cachedFragment);
+            }
+            const auto totalUs = requestElapsedUs();
+            requestOkCount_.fetch_add(1, std::memory_order_relaxed);
+            observeRequestCode(renderResult.status);
+            observeRequestLatency(prepared, totalUs);
+            totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+            totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
+            totalWrapUs_.fetch_add(wrapUs, std::memory_order_relaxed);
+            RenderTrace::Scope responseSpan(prepared.trace.get(), "response");
+            renderResult.html = std::move(wrappedHtml);
+            renderResult.headers.try_emplace("X-Request-Id", requestId);
+            applyEntityTag(prepared, std::move(etag), &renderResult);
+            if (cacheStatus != nullptr) {
+                renderResult.headers["X-Hydra-Cache"] = cacheStatus;
+            }
+            applySecurityHeaders(&renderResult, true, scriptNonce);
+            applyLinkHeader(prepared, false, &renderResult);
+            responseSpan.end();
+            encodeResponse(prepared, cachedFragment.get(), splice ? &runs : nullptr, &renderResult);
+            logRequest(false, renderResult.status, totalUs, renderIndex, renderUs, wrapUs,
+                       cacheStatus, {});
+            finishTrace(prepared, renderResult.status, false, &renderResult);
+            return renderResult;
+        }
+
+        if (etag.empty()) {
+            etag = entityTagFor(prepared, fragment, nullptr);
+            if (!etag.empty() && ifNoneMatchMatches(prepared.ifNoneMatch, etag)) {
+                return notModified(std::move(etag));
+            }
+        }
+        if (cachedFragment) {
+            renderResult = *cachedFragment;
+        }
+        if (!isRedirect &&
+            !wrapFragment_ &&
+            !renderResult.html.empty() &&
+            !isLikelyFullDocument(renderResult.html)) {
+            bool expected = false;
+            if (warnedUnwrappedFragment_.compare_exchange_strong(
+                    expected, true, std::memory_order_relaxed)) {
+                LOG_WARN << "HydraSsrPlugin wrap_fragment=false while SSR returned HTML fragment. "
+                         << "This can break CSS/JS injection.";
+            }
+        }
+
+        const auto totalUs = requestElapsedUs();
+        requestOkCount_.fetch_add(1, std::memory_order_relaxed);
+        observeRequestCode(renderResult.status);
+        observeRequestLatency(prepared, totalUs);
+        totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+        totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
+        totalWrapUs_.fetch_add(wrapUs, std::memory_order_relaxed);
+        RenderTrace::Scope responseSpan(prepared.trace.get(), "response");
+        renderResult.headers.try_emplace("X-Request-Id", requestId);
+        applyEntityTag(prepared, std::move(etag), &renderResult);
+        if (cacheStatus != nullptr) {
+            renderResult.headers["X-Hydra-Cache"] = cacheStatus;
+        }
+        applySecurityHeaders(&renderResult, false, scriptNonce);
+        responseSpan.end();
+        if (!isRedirect) {
+            encodeResponse(prepared, cachedFragment.get(), nullptr, &renderResult);
+        }
+        logRequest(false, renderResult.status, totalUs, renderIndex, renderUs, wrapUs, cacheStatus,
+                   {});
+        finishTrace(prepared, renderResult.status, false, &renderResult);
+
+        return renderResult;
+    } catch (const AdmissionRejectedError &shedEx) {
+        return shedRequest(prepared, shedEx, requestStartedAt, timing.acquireWaitUs);
+    } catch (const std::exception &ex) {
+        acquireWaitUs = timing.acquireWaitUs;
+        const std::string message = ex.what();
+        if (containsText(message, "Timed out waiting for available V8 isolate")) {
+            poolTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (containsText(message, "SSR render exceeded timeout")) {
+            renderTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        const auto totalUs = requestElapsedUs();
+        requestFailCount_.fetch_add(1, std::memory_order_relaxed);
+        observeRequestCode(500);
+        observeRequestLatency(prepared, totalUs);
+        renderErrorCount_.fetch_add(1, std::memory_order_relaxed);
+        totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+        totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
+        observeAcquireWait(acquireWaitUs);
+        logRequest(true, 500, totalUs, 0, 0, 0, nullptr, message);
+        LOG_ERROR << "HydraStack render failed for url=" << routeUrl
+                  << ", request_id=" << requestId << ": " << ex.what();
+        SsrRenderResult failed;
+        failed.status = 500;
+        failed.html = HtmlShell::errorPage(ex.what());
+        failed.headers["X-Request-Id"] = requestId;
+        applySecurityHeaders(&failed, false, scriptNonce);
+        finishTrace(prepared, failed.status, true, &failed);
+        return failed;
+    } catch (...) {
+        acquireWaitUs = timing.acquireWaitUs;
+        const auto totalUs = requestElapsedUs();
+        requestFailCount_.fetch_add(1, std::memory_order_relaxed);
+        observeRequestCode(500);
+        observeRequestLatency(prepared, totalUs);
+        renderErrorCount_.fetch_add(1, std::memory_order_relaxed);
+        totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+        totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
+        observeAcquireWait(acquireWaitUs);
+        logRequest(true, 500, totalUs, 0, 0, 0, nullptr, "unknown");
+        LOG_ERROR << "HydraStack render failed for url=" << routeUrl
+                  << ", request_id=" << requestId << ": unknown exception";
+        SsrRenderResult failed;
+        failed.status = 500;
+        failed.html = HtmlShell::errorPage("Unknown SSR runtime error");
+        failed.headers["X-Request-Id"] = requestId;
+        applySecurityHeaders(&failed, false, scriptNonce);
+        finishTrace(prepared, failed.status, true, &failed);
+        return failed;
+    }
+}
+
+SsrRenderResult HydraSsrPlugin::renderComponentPrepared(const drogon::HttpRequestPtr &req,
+                                                        const std::string &propsJson,
+                                                        const PreparedRender &prepared) const {
+    const auto requestStartedAt = std::chrono::steady_clock::now();
+    const auto requestMethod = req ? req->methodString() : std::string("GET");
+    FragmentTiming timing;
+    const char *cacheStatus = nullptr;
+    // There is no shell, wrap or 304 step: the cached value is already the
+    // response body.
+    const auto finish = [&](SsrRenderResult response, bool failed, std::string_view error) {
+        const auto totalUs = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - requestStartedAt)
+                .count());
+        (failed ? requestFailCount_ : requestOkCount_).fetch_add(1, std::memory_order_relaxed);
+        if (failed) {
+            renderErrorCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        (prepared.fragmentFormat == FragmentFormat::kHtml ? fragmentHtmlResponses_
+                                                          : fragmentJsonResponses_)
+            .fetch_add(1, std::memory_order_relaxed);
+        observeRequestCode(response.status);
+        observeRequestLatency(prepared, totalUs);
+        totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+        totalAcquireWaitUs_.fetch_add(timing.acquireWaitUs, std::memory_order_relaxed);
+        observeAcquireWait(timing.acquireWaitUs);
+        if (shouldLogRenderEvent(failed, totalUs)) {
+            RenderEvent event;
+            event.failed = failed;
+            event.httpStatus = response.status;
+            event.renderIndex = timing.renderIndex;
+            event.acquireUs = timing.acquireWaitUs;
+            event.renderUs = timing.renderUs;
+            event.totalUs = totalUs;
+            event.cache = cacheStatus;
+            event.bridgeCalls = timing.bridge.syncCalls + timing.bridge.asyncCalls;
+            event.bridgeMemoized = timing.bridge.memoized;
+            event.bridgeWaitUs = timing.bridge.waitUs;
+            event.method.assign(requestMethod);
+            event.error.assign(error);
+            logRenderEvent(prepared, event);
+        }
+        finishTrace(prepared, response.status, failed, &response);
+        return response;
+    };
+    const auto failedResponse = [&](std::string_view message) {
+        SsrRenderResult failed;
+        failed.status = 500;
+        failed.html = fragmentPayload(prepared, failed, message);
+        failed.headers["Content-Type"] = fragmentContentType(prepared.fragmentFormat);
+        failed.headers["Cache-Control"] = "no-store";
+        failed.headers["X-Request-Id"] = prepared.requestId;
+        applySecurityHeaders(&failed, false, prepared.scriptNonce);
+        return finish(std::move(failed), true, message);
     };
-    const auto applySecurityHeaders = [&](SsrRenderResult *response, bool wrappedWithShell) {
-        if (response == nullptr) {
+
+    try {
+        RenderCache::Value cached;
+        const auto cachePolicy = renderCachePolicyFor(prepared.pageId);
+        if (renderCache_ && cachePolicy.ttl.count() > 0) {
+            const auto cacheKey =
+                renderCacheKey(prepared, renderCacheRoute(prepared), propsJson);
+            bool sharedHit = false;
+            auto lookup = renderCache_->getOrRender(
+                cacheKey,
+                cachePolicy,
+                [&]() {
+                    return produceCachedRender(
+                        cacheKey, cachePolicy, prepared, &timing, &sharedHit);
+                },
+                prepared.generation->id);
+            if (lookup.refresh) {
+                refreshCachedRender(cacheKey, cachePolicy, prepared);
+            }
+            cached = std::move(lookup.value);
+            cacheStatus = sharedHit ? "shared" : cacheOutcomeName(lookup.outcome);
+        } else {
+            cached = makeCachedRender(prepared, renderOnIsolate(prepared, &timing));
+        }
+
+        RenderTrace::Scope responseSpan(prepared.trace.get(), "response");
+        auto response = withoutHtml(*cached);
+        response.html = cached->html;
+        response.headers.try_emplace("X-Request-Id", prepared.requestId);
+        if (cacheStatus != nullptr) {
+            response.headers["X-Hydra-Cache"] = cacheStatus;
+        }
+        applySecurityHeaders(&response, false, prepared.scriptNonce);
+        responseSpan.end();
+        encodeResponse(prepared, cached.get(), nullptr, &response);
+        return finish(std::move(response), false, {});
+    } catch (const AdmissionRejectedError &shedEx) {
+        return shedRequest(prepared, shedEx, requestStartedAt, timing.acquireWaitUs);
+    } catch (const std::exception &ex) {
+        const std::string message = ex.what();
+        if (containsText(message, "Timed out waiting for available V8 isolate")) {
+            poolTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (containsText(message, "SSR render exceeded timeout")) {
+            renderTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        LOG_ERROR << "HydraStack fragment render failed for url=" << prepared.routeUrl
+                  << ", component=" << prepared.componentId
+                  << ", request_id=" << prepared.requestId << ": " << message;
+        return failedResponse(message);
+    } catch (...) {
+        LOG_ERROR << "HydraStack fragment render failed for url=" << prepared.routeUrl
+                  << ", component=" << prepared.componentId
+                  << ", request_id=" << prepared.requestId << ": unknown exception";
+        return failedResponse("Unknown SSR runtime error");
+    }
+}
+
+std::string HydraSsrPlugin::fragmentPayload(const PreparedRender &prepared,
+                                            const SsrRenderResult &fragment,
+                                            std::string_view error) const {
+    const bool redirect = isRedirectResult(fragment);
+    if (prepared.fragmentFormat == FragmentFormat::kHtml) {
+        if (!error.empty()) {
+            return html_escape::escape(error, html_escape::Mode::HtmlText);
+        }
+        if (redirect) {
+            return {};
+        }
+        std::string body = fragment.html;
+        if (!fragment.propsJson.empty()) {
+            body += "<script type=\"application/json\" data-hydra-fragment=\"";
+            html_escape::appendEscaped(
+                body, prepared.componentId, html_escape::Mode::HtmlAttribute);
+            body += "\">";
+            body += HtmlShell::escapeForScriptTag(fragment.propsJson);
+            body += "</script>";
+        }
+        return body;
+    }
+
+    Json::Value payload(Json::objectValue);
+    payload["component"] = prepared.componentId;
+    payload["status"] = fragment.status;
+    if (!error.empty()) {
+        payload["error"] = std::string(error);
+    } else if (redirect) {
+        payload["redirect"] = fragment.headers.at("Location");
+    } else {
+        payload["html"] = fragment.html;
+    }
+    auto body = toCompactJson(payload);
+    if (error.empty() && !redirect && !fragment.propsJson.empty()) {
+        // Already compact JSON from the bundle; spliced rather than parsed.
+        body = props_json::appendMember(body, props_json::scanObject(body), "props",
+                                        fragment.propsJson);
+    }
+    return body;
+}
+
+HydraSsrPlugin::PreparedRender HydraSsrPlugin::prepareRender(
+    const drogon::HttpRequestPtr &req,
+    const std::string &propsJson,
+    const RenderOptions &options) const {
+    return prepareRender(req, propsJson, props_json::scanObject(propsJson), options);
+}
+
+HydraSsrPlugin::PreparedRender HydraSsrPlugin::prepareRender(
+    const drogon::HttpRequestPtr &req,
+    const std::string &propsJson,
+    const props_json::ObjectShape &propsShape,
+    const RenderOptions &options) const {
+    PreparedRender prepared;
+    // Pinned for the whole request so a reload mid-render cannot mix the old
+    // bundle's markup with the new shell's asset URLs.
+    prepared.generation = currentGeneration();
+    prepared.routeUrl = buildRouteUrl(req, options);
+    prepared.requestId = resolveRequestId(req);
+    prepared.trace = startTrace(req, prepared.requestId);
+    auto *trace = prepared.trace.get();
+    RenderTrace::Scope contextSpan(trace, "request_context");
+    const auto requestContext = buildRequestContext(req, prepared.routeUrl, prepared.requestId);
+    prepared.requestContextJson = toCompactJson(requestContext);
+    contextSpan.end();
+    prepared.pageId = propsShape.pageId;
+    if (prepared.generation) {
+        prepared.shell = prepared.generation->shell.get();
+        prepared.linkHeader = &prepared.generation->linkHeader;
+        const auto &pagePreloads = prepared.generation->pagePreloads;
+        if (!pagePreloads.empty() && !prepared.pageId.empty()) {
+            if (const auto it = pagePreloads.find(AssetManifest::pageKey(prepared.pageId));
+                it != pagePreloads.end()) {
+                prepared.shell = it->second.shell.get();
+                prepared.linkHeader = &it->second.linkHeader;
+            }
+        }
+    }
+    if (routeLatency_) {
+        prepared.latencyRoute =
+            &routeLatency_->route(prepared.pageId.empty() ? "-" : prepared.pageId);
+    }
+    if (trace != nullptr) {
+        trace->setRoute(prepared.routeUrl, prepared.pageId);
+    }
+    // Props that are not a JSON object are passed through untouched.
+    RenderTrace::Scope propsSpan(trace, "props");
+    prepared.propsJson = std::make_shared<const std::string>(props_json::appendMember(
+        propsJson, propsShape, "__hydra_request", prepared.requestContextJson));
+    propsSpan.end();
+    prepared.requestPropsEnd = prepared.propsJson->size();
+    prepared.requestPropsBegin = prepared.requestPropsEnd;
+    if (propsShape.isObject && propsShape.closeOffset < propsJson.size()) {
+        prepared.requestPropsBegin = propsShape.closeOffset;
+        prepared.requestPropsEnd -= propsJson.size() - propsShape.closeOffset;
+    }
+    if (normalizedConfig_.compressionEnabled && options.compress && req) {
+        const auto &acceptEncoding = req->getHeader("accept-encoding");
+        prepared.encoding = negotiateContentEncoding(acceptEncoding,
+                                                     normalizedConfig_.compressionGzip,
+                                                     normalizedConfig_.compressionBrotli);
+        prepared.gzipAccepted =
+            normalizedConfig_.compressionGzip &&
+            negotiateContentEncoding(acceptEncoding, true, false) == ContentEncoding::kGzip;
+    }
+    prepared.scriptNonce = devModeEnabled_ ? std::string{} : generateScriptNonce();
+    if (etagEnabled_ && req &&
+        (req->method() == drogon::Get || req->method() == drogon::Head)) {
+        prepared.ifNoneMatch = req->getHeader("if-none-match");
+    }
+    prepared.locale = requestContext["locale"].asString();
+    prepared.theme = requestContext["theme"].asString();
+    if (requestContext_.lazyDetails) {
+        prepared.lazyRequest = req;
+    }
+    if (admission_) {
+        prepared.priority = classifyRequest(req, options);
+    }
+    return prepared;
+}
+
+RequestPriority HydraSsrPlugin::classifyRequest(const drogon::HttpRequestPtr &req,
+                                                const RenderOptions &options) const {
+    if (options.priority.has_value()) {
+        return *options.priority;
+    }
+    if (!req) {
+        return RequestPriority::kNormal;
+    }
+    const auto &path = req->path();
+    for (const auto &prefix : admissionHealthPaths_) {
+        if (path.rfind(prefix, 0) == 0) {
+            return RequestPriority::kCritical;
+        }
+    }
+    if (!admissionBotUserAgents_.empty()) {
+        const auto userAgent = toLowerCopy(req->getHeader("user-agent"));
+        for (const auto &token : admissionBotUserAgents_) {
+            if (userAgent.find(token) != std::string::npos) {
+                return RequestPriority::kLow;
+            }
+        }
+    }
+    for (const auto &cookie : admissionSessionCookies_) {
+        if (!req->getCookie(cookie).empty()) {
+            return RequestPriority::kHigh;
+        }
+    }
+    return RequestPriority::kNormal;
+}
+
+AdmissionController::Ticket HydraSsrPlugin::admitRender(const PreparedRender &prepared) const {
+    const auto pending =
+        renderExecutor_ ? renderExecutor_->queueDepth() + renderExecutor_->activeCount() : 0;
+    auto ticket =
+        admission_->admit(prepared.priority, prepared.generation->pool->size(), pending);
+    if (!ticket) {
+        throw AdmissionRejectedError(prepared.priority, ticket.expectedWaitUs(), false);
+    }
+    return ticket;
+}
+
+std::uint64_t HydraSsrPlugin::acquireTimeoutFor(const PreparedRender &prepared) const {
+    const auto timeoutMs =
+        admission_ ? admission_->acquireTimeoutMs(prepared.priority, isolateAcquireTimeoutMs_)
+                   : isolateAcquireTimeoutMs_;
+    if (timeoutMs == 0 || prepared.queuedAt == std::chrono::steady_clock::time_point{}) {
+        return timeoutMs;
+    }
+    const auto queuedMs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - prepared.queuedAt)
+            .count());
+    // 0 would mean no timeout; a spent budget still gets one quick try.
+    return queuedMs < timeoutMs ? timeoutMs - queuedMs : 1;
+}
+
+SsrRenderResult HydraSsrPlugin::shedRequest(const PreparedRender &prepared,
+                                            const AdmissionRejectedError &error,
+                                            std::chrono::steady_clock::time_point requestStartedAt,
+                                            std::uint64_t acquireWaitUs) const {
+    // A fragment has no shell to degrade to.
+    const bool reject = !prepared.componentId.empty() ||
+                        admission_->policy(error.priority()).action == ShedAction::kReject;
+    SsrRenderResult shed;
+    if (reject) {
+        constexpr std::string_view kBusy = "Server is busy, please retry shortly";
+        shed.status = 503;
+        if (prepared.componentId.empty()) {
+            shed.html = HtmlShell::errorPage(std::string(kBusy));
+        } else {
+            shed.html = fragmentPayload(prepared, shed, kBusy);
+            shed.headers["Content-Type"] = fragmentContentType(prepared.fragmentFormat);
+        }
+        shed.headers["Retry-After"] = std::to_string(admissionRetryAfterSec_);
+    } else {
+        // The document the shell engine serves: the client bundle renders
+        // into the empty root.
+        shed.status = 200;
+        shed.html = prepared.shell->wrap("", *prepared.propsJson, {}, prepared.scriptNonce);
+    }
+    shed.headers["X-Request-Id"] = prepared.requestId;
+    shed.headers["X-Hydra-Admission"] = reject ? "rejected" : "shell";
+    shed.headers["Cache-Control"] = "no-store";
+    applySecurityHeaders(&shed, !reject, prepared.scriptNonce);
+    if (!reject) {
+        applyLinkHeader(prepared, false, &shed);
+    }
+
+    const auto totalUs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - requestStartedAt)
+            .count());
+    if (error.timedOut()) {
+        poolTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
+        observeAcquireWait(acquireWaitUs);
+    }
+    (reject ? requestFailCount_ : requestOkCount_).fetch_add(1, std::memory_order_relaxed);
+    observeRequestCode(shed.status);
+    observeRequestLatency(prepared, totalUs);
+    totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+    if (shouldLogRenderEvent(reject, totalUs)) {
+        RenderEvent event;
+        event.failed = reject;
+        event.httpStatus = shed.status;
+        event.acquireUs = acquireWaitUs;
+        event.totalUs = totalUs;
+        event.cache = reject ? "shed_rejected" : "shed_shell";
+        event.error.assign(error.what());
+        logRenderEvent(prepared, event);
+    }
+    finishTrace(prepared, shed.status, reject, &shed);
+    return shed;
+}
+
+SsrRenderResult HydraSsrPlugin::renderOnIsolate(const PreparedRender &prepared,
+                                                FragmentTiming *timing) const {
+    AdmissionController::Ticket admission;
+    if (admission_ && !prepared.admission) {
+        admission = admitRender(prepared);
+    }
+    const auto expectedWaitUs =
+        prepared.admission ? prepared.admission->expectedWaitUs() : admission.expectedWaitUs();
+    const auto acquireTimeoutMs = acquireTimeoutFor(prepared);
+
+    auto *trace = prepared.trace.get();
+    RenderTrace::Scope acquireSpan(trace, "acquire");
+    const auto acquireStartedAt = std::chrono::steady_clock::now();
+    const auto acquireElapsedUs = [&acquireStartedAt]() {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - acquireStartedAt)
+                .count());
+    };
+    auto lease = [&]() {
+        try {
+            return prepared.generation->pool->acquire(acquireTimeoutMs);
+        } catch (const std::exception &acquireEx) {
+            timing->acquireWaitUs = acquireElapsedUs();
+            // An admitted request that still misses its deadline degrades
+            // like one shed up front instead of failing with a 500.
+            if (!admission_ ||
+                !containsText(acquireEx.what(), "Timed out waiting for available V8 isolate")) {
+                throw;
+            }
+            admission_->recordTimeout(prepared.priority);
+            throw AdmissionRejectedError(prepared.priority, expectedWaitUs, true);
+        }
+    }();
+    timing->acquireWaitUs = acquireElapsedUs();
+    acquireSpan.end();
+
+    try {
+        const auto renderStartedAt = std::chrono::steady_clock::now();
+        V8SsrRuntime::RenderOutput renderOutput;
+        {
+            RenderTrace::Scope renderSpan(trace, "render");
+            RenderTrace::Activation activation(trace);
+            RequestContextBuilder::Activation requestDetails(requestContextBuilder_.get(),
+                                                             prepared.lazyRequest);
+            const auto timeoutMs = prepared.generation->pool->renderTimeoutMs();
+            renderOutput = prepared.componentId.empty()
+                               ? lease->renderOutput(prepared.routeUrl,
+                                                     prepared.propsJson,
+                                                     prepared.requestContextJson,
+                                                     timeoutMs)
+                               : lease->renderFragmentOutput(prepared.routeUrl,
+                                                             prepared.propsJson,
+                                                             prepared.requestContextJson,
+                                                             prepared.componentId,
+                                                             timeoutMs);
+        }
+        timing->bridge = lease->lastBridgeStats();
+        observeBridgeCalls(timing->bridge);
+        timing->renderUs = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - renderStartedAt)
+                .count());
+        observeRenderLatency(prepared, timing->renderUs);
+        totalRenderUs_.fetch_add(timing->renderUs, std::memory_order_relaxed);
+        if (admission_) {
+            admission_->observeRender(timing->renderUs);
+        }
+        timing->renderIndex = renderCount_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        if (renderOutput.envelope.has_value()) {
+            return std::move(*renderOutput.envelope);
+        }
+        // Bundles that still stringify their envelope.
+        RenderTrace::Scope parseSpan(trace, "parse");
+        if (auto parsed = tryParseSsrEnvelope(renderOutput.text); parsed.has_value()) {
+            return std::move(*parsed);
+        }
+        SsrRenderResult result;
+        result.html = std::move(renderOutput.text);
+        result.status = 200;
+        return result;
+    } catch (const std::exception &renderEx) {
+        lease.markForRecycle();
+        runtimeRecycleCount_.fetch_add(1, std::memory_order_relaxed);
+        const std::string message = renderEx.what();
+        if (containsText(message, "SSR render exceeded timeout")) {
+            renderTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        throw;
+    } catch (...) {
+        lease.markForRecycle();
+        runtimeRecycleCount_.fetch_add(1, std::memory_order_relaxed);
+        throw;
+    }
+}
+
+RenderCache::Policy HydraSsrPlugin::renderCachePolicyFor(const std::string &pageId) const {
+    if (!renderCache_) {
+        return {};
+    }
+    if (!pageId.empty()) {
+        if (const auto it = renderCachePolicies_.find(pageId); it != renderCachePolicies_.end()) {
+            return it->second;
+        }
+    }
+    return renderCacheDefaultPolicy_;
+}
+
+RenderCache::Key HydraSsrPlugin::renderCacheKey(const PreparedRender &prepared,
+                                                std::string_view routeKey,
+                                                std::string_view propsJson) const {
+    return RenderCache::makeKey(
+        routeKey,
+        prepared.locale,
+        prepared.theme,
+        propsJson,
+        sharedRenderCache_ ? sharedRenderCache_->tagVersion(prepared.pageId) : 0);
+}
+
+std::string HydraSsrPlugin::renderCacheRoute(const PreparedRender &prepared) const {
+    if (prepared.componentId.empty()) {
+        return prepared.routeUrl;
+    }
+    // '#' never reaches the server in a request target, so a component key
+    // cannot collide with a page's.
+    return prepared.routeUrl + "#" + prepared.componentId +
+           (prepared.fragmentFormat == FragmentFormat::kHtml ? ".html" : ".json");
+}
+
+RenderCache::Value HydraSsrPlugin::produceCachedRender(const RenderCache::Key &key,
+                                                       const RenderCache::Policy &policy,
+                                                       const PreparedRender &prepared,
+                                                       FragmentTiming *timing,
+                                                       bool *sharedHit) const {
+    const auto &buildId = prepared.generation->buildId;
+    if (sharedRenderCache_ && !buildId.empty()) {
+        std::shared_ptr<CachedRender> shared;
+        {
+            RenderTrace::Scope sharedSpan(prepared.trace.get(), "shared_cache");
+            shared = sharedRenderCache_->lookup(buildId, key, policy.ttl);
+        }
+        if (shared) {
+            // Same build, same shell: its ETag and gzip blocks hold here.
+            shared->generation = prepared.generation->id;
+            *sharedHit = true;
+            return shared;
+        }
+    }
+    auto value = makeCachedRender(prepared, renderOnIsolate(prepared, timing));
+    shareCachedRender(key, policy, prepared, *value);
+    return value;
+}
+
+void HydraSsrPlugin::shareCachedRender(const RenderCache::Key &key,
+                                       const RenderCache::Policy &policy,
+                                       const PreparedRender &prepared,
+                                       const CachedRender &value) const {
+    const auto &buildId = prepared.generation->buildId;
+    if (sharedRenderCache_ && !buildId.empty() && RenderCache::cacheable(value)) {
+        sharedRenderCache_->store(buildId, key, policy.ttl, value);
+    }
+}
+
+bool HydraSsrPlugin::wrapsFragment(const SsrRenderResult &fragment) const {
+    return !isRedirectResult(fragment) && wrapFragment_ && !fragment.html.empty() &&
+           !isLikelyFullDocument(fragment.html);
+}
+
+RenderCache::Value HydraSsrPlugin::makeCachedRender(const PreparedRender &prepared,
+                                                    SsrRenderResult fragment) const {
+    auto cached = std::make_shared<CachedRender>();
+    static_cast<SsrRenderResult &>(*cached) = std::move(fragment);
+    cached->generation = prepared.generation->id;
+    const auto &config = normalizedConfig_;
+    const bool precompress =
+        config.compressionEnabled && config.compressionGzip && RenderCache::cacheable(*cached);
+    if (!prepared.componentId.empty()) {
+        cached->html = fragmentPayload(prepared, *cached, {});
+        if (const auto location = cached->headers.find("Location");
+            location != cached->headers.end()) {
+            cached->headers["X-Hydra-Redirect"] = std::move(location->second);
+            cached->headers.erase(location);
+        }
+        cached->headers["Content-Type"] = fragmentContentType(prepared.fragmentFormat);
+        if (!precompress || cached->html.size() < config.compressionMinBytes) {
+            return cached;
+        }
+        try {
+            cached->sharedGzip.push_back(
+                deflateBlock(cached->html, static_cast<int>(config.compressionGzipLevel)));
+        } catch (const std::exception &ex) {
+            compressionFailures_.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN << "HydraStack could not precompress fragment " << prepared.componentId
+                     << " for url=" << prepared.routeUrl << ": " << ex.what();
+        }
+        return cached;
+    }
+    const bool wrapped = wrapsFragment(*cached);
+    if (!etagEnabled_ && !precompress) {
+        return cached;
+    }
+    std::shared_ptr<const std::string> criticalCss;
+    HtmlShellPageMeta pageMeta;
+    if (wrapped) {
+        pageMeta = shellPageMeta(prepared, *cached, &criticalCss);
+    }
+    cached->etag = entityTagFor(prepared, *cached, wrapped ? &pageMeta : nullptr);
+    if (!precompress) {
+        return cached;
+    }
+
+    // Only the even runs are kept; the per-request ones are compressed by
+    // each hit. A page that is not wrapped is one shared run.
+    std::vector<std::string> runs;
+    if (wrapped) {
+        runs = prepared.shell->wrapRuns(cached->html,
+                                        *prepared.propsJson,
+                                        prepared.requestPropsBegin,
+                                        prepared.requestPropsEnd,
+                                        pageMeta,
+                                        {});
+    } else if (!isRedirectResult(*cached)) {
+        runs.push_back(cached->html);
+    }
+    std::size_t sharedBytes = 0;
+    for (std::size_t i = 0; i < runs.size(); i += 2) {
+        sharedBytes += runs[i].size();
+    }
+    if (runs.empty() || sharedBytes < config.compressionMinBytes) {
+        return cached;
+    }
+    try {
+        const auto level = static_cast<int>(config.compressionGzipLevel);
+        for (std::size_t i = 0; i < runs.size(); i += 2) {
+            cached->sharedGzip.push_back(deflateBlock(runs[i], level));
+        }
+    } catch (const std::exception &ex) {
+        cached->sharedGzip.clear();
+        compressionFailures_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "HydraStack could not precompress cached page for url=" << prepared.routeUrl
+                 << ": " << ex.what();
+    }
+    return cached;
+}
+
+bool HydraSsrPlugin::canSpliceGzip(const PreparedRender &prepared,
+                                   const CachedRender *cached) const {
+    // Cached pages go out as gzip even to brotli clients: brotli streams
+    // cannot be spliced, and recompressing a hit is what the blocks avoid.
+    return cached != nullptr && prepared.gzipAccepted && !cached->sharedGzip.empty() &&
+           cached->generation == prepared.generation->id;
+}
+
+void HydraSsrPlugin::encodeResponse(const PreparedRender &prepared,
+                                    const CachedRender *cached,
+                                    const std::vector<std::string> *runs,
+                                    SsrRenderResult *response) const {
+    if (!normalizedConfig_.compressionEnabled) {
+        return;
+    }
+    addVary(response, "Accept-Encoding");
+    if (response->headers.find("Content-Encoding") != response->headers.end()) {
+        // The bundle already encoded the body itself.
+        if (runs != nullptr) {
+            response->html.clear();
+            for (const auto &run : *runs) {
+                response->html.append(run);
+            }
+        }
+        return;
+    }
+
+    RenderTrace::Scope compressSpan(prepared.trace.get(), "compress");
+    const auto level = [this](ContentEncoding encoding) {
+        return static_cast<int>(encoding == ContentEncoding::kBrotli
+                                    ? normalizedConfig_.compressionBrotliQuality
+                                    : normalizedConfig_.compressionGzipLevel);
+    };
+    const bool splice = canSpliceGzip(prepared, cached) &&
+                        (runs != nullptr ? cached->sharedGzip.size() == (runs->size() + 1) / 2
+                                         : cached->sharedGzip.size() == 1);
+    const auto encoding = splice ? ContentEncoding::kGzip : prepared.encoding;
+    std::size_t identityBytes = 0;
+    try {
+        if (splice) {
+            std::vector<DeflateBlock> perRequest;
+            std::vector<const DeflateBlock *> blocks;
+            if (runs != nullptr) {
+                perRequest.reserve(runs->size() / 2);
+                for (std::size_t i = 0; i < runs->size(); ++i) {
+                    identityBytes += (*runs)[i].size();
+                    if (i % 2 == 1) {
+                        perRequest.push_back(deflateBlock((*runs)[i], level(encoding)));
+                    }
+                }
+                for (std::size_t i = 0; i < runs->size(); ++i) {
+                    blocks.push_back(i % 2 == 0 ? &cached->sharedGzip[i / 2]
+                                                : &perRequest[i / 2]);
+                }
+            } else {
+                identityBytes = response->html.size();
+                blocks.push_back(&cached->sharedGzip.front());
+            }
+            response->html = gzipFromBlocks(blocks);
+            gzipSplicedResponses_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            if (runs != nullptr) {
+                for (const auto &run : *runs) {
+                    response->html.append(run);
+                }
+            }
+            identityBytes = response->html.size();
+            if (encoding == ContentEncoding::kIdentity ||
+                identityBytes < normalizedConfig_.compressionMinBytes) {
+                return;
+            }
+            response->html = compressBody(response->html, encoding, level(encoding));
+        }
+    } catch (const std::exception &ex) {
+        // Identity is always a valid answer.
+        compressionFailures_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "HydraStack response compression failed for url=" << prepared.routeUrl
+                 << ", request_id=" << prepared.requestId << ": " << ex.what();
+        if (runs != nullptr) {
+            response->html.clear();
+            for (const auto &run : *runs) {
+                response->html.append(run);
+            }
+        }
+        return;
+    }
+    (encoding == ContentEncoding::kBrotli ? brotliResponses_ : gzipResponses_)
+        .fetch_add(1, std::memory_order_relaxed);
+    compressionBytesIn_.fetch_add(identityBytes, std::memory_order_relaxed);
+    compressionBytesOut_.fetch_add(response->html.size(), std::memory_order_relaxed);
+    response->headers["Content-Encoding"] = std::string(contentEncodingToken(encoding));
+}
+
+void HydraSsrPlugin::refreshCachedRender(const RenderCache::Key &key,
+                                         const RenderCache::Policy &policy,
+                                         PreparedRender prepared) const {
+    // A stale copy is already being served, so the refresh yields to
+    // requests that are waiting on a render.
+    prepared.priority = RequestPriority::kLow;
+    // The request that triggered the refresh has already been answered; the
+    // refresh is admitted on its own when it runs.
+    prepared.trace.reset();
+    prepared.admission.reset();
+    prepared.queuedAt = std::chrono::steady_clock::now();
+    auto task = [this, key, policy, prepared = std::move(prepared)]() {
+        try {
+            FragmentTiming timing;
+            auto value = makeCachedRender(prepared, renderOnIsolate(prepared, &timing));
+            shareCachedRender(key, policy, prepared, *value);
+            renderCache_->store(key, policy, std::move(value));
+        } catch (const AdmissionRejectedError &) {
+            // Shed under load; the stale copy keeps serving.
+            renderCache_->refreshFailed(key);
+        } catch (const std::exception &ex) {
+            renderCache_->refreshFailed(key);
+            LOG_WARN << "HydraStack render cache refresh failed for url=" << prepared.routeUrl
+                     << ", request_id=" << prepared.requestId << ": " << ex.what();
+        } catch (...) {
+            renderCache_->refreshFailed(key);
+        }
+    };
+    if (!renderExecutor_) {
+        renderCache_->refreshFailed(key);
+        return;
+    }
+    try {
+        renderExecutor_->post(std::move(task));
+    } catch (const std::exception &) {
+        // Queue full or shutting down; the stale copy stays until it expires.
+        renderCache_->refreshFailed(key);
+    }
+}
+
+std::string HydraSsrPlugin::entityTagFor(const PreparedRender &prepared,
+                                         const SsrRenderResult &page,
+                                         const HtmlShellPageMeta *meta) const {
+    if (!etagEnabled_ || page.status != 200 || isRedirectResult(page)) {
+        return {};
+    }
+    // The bundle's own validator wins, and no-store pages are never
+    // revalidated.
+    if (page.headers.find("ETag") != page.headers.end()) {
+        return {};
+    }
+    if (const auto it = page.headers.find("Cache-Control");
+        it != page.headers.end() && containsText(toLowerCopy(it->second), "no-store")) {
+        return {};
+    }
+    // Locale and theme pick the cache entry too; the rest of __hydra_request
+    // is left out with the request id.
+    auto digest = combineHash(hash64(prepared.locale), hash64(prepared.theme));
+    digest = combineHash(digest,
+                         meta != nullptr
+                             ? prepared.shell->contentHash(page.html,
+                                                           *prepared.propsJson,
+                                                           prepared.requestPropsBegin,
+                                                           prepared.requestPropsEnd,
+                                                           *meta)
+                             : hash64(page.html));
+    return weakEntityTag(digest);
+}
+
+HtmlShellAssets HydraSsrPlugin::shellDefaults(const RenderGeneration &generation) const {
+    HtmlShellAssets assets;
+    assets.title = shellTitle_;
+    assets.description = shellDescription_;
+    assets.canonicalUrl = shellCanonicalUrl_;
+    assets.robots = shellRobots_;
+    assets.ogType = shellOgType_;
+    assets.imageUrl = shellImageUrl_;
+    assets.siteName = shellSiteName_;
+    assets.twitterCard = shellTwitterCard_;
+    assets.cssPath = generation.cssPath;
+    assets.clientJsPath = generation.clientJsPath;
+    assets.inlineCriticalCss = generation.criticalCss != nullptr;
+    assets.hmrClientPath = hmrClientPath_;
+    assets.clientJsModule = clientJsModule_;
+    if (devModeEnabled_ && devAutoReloadEnabled_) {
+        assets.devReloadProbePath = normalizeBrowserPath(devReloadProbePath_);
+        assets.devReloadIntervalMs = devReloadIntervalMs_;
+    }
+    return assets;
+}
+
+std::optional<AssetManifest> HydraSsrPlugin::loadAssetManifest() const {
+    try {
+        return AssetManifest::load(assetManifestPath_, assetPublicPrefix_);
+    } catch (const std::exception &ex) {
+        LOG_WARN << "HydraStack " << ex.what();
+        return std::nullopt;
+    }
+}
+
+std::unique_ptr<const CriticalCss> HydraSsrPlugin::loadCriticalCss(
+    const AssetManifest *manifest,
+    const std::string &cssPath) const {
+    const auto file = manifest != nullptr ? manifest->fileFor(cssPath) : std::string{};
+    if (file.empty()) {
+        LOG_WARN << "HydraStack critical_css needs a stylesheet from the asset manifest; "
+                    "keeping the <link> for "
+                 << cssPath;
+        return nullptr;
+    }
+    // Manifest files are relative to the build's outDir, which is the
+    // manifest's directory or, for Vite's default .vite/manifest.json, its
+    // parent.
+    auto outDir = std::filesystem::path(assetManifestPath_).parent_path();
+    if (outDir.filename() == ".vite") {
+        outDir = outDir.parent_path();
+    }
+    const auto path = outDir / file;
+    try {
+        CriticalCss::Options options;
+        options.maxBytes = static_cast<std::size_t>(normalizedConfig_.criticalCssMaxBytes);
+        options.cacheEntries = static_cast<std::size_t>(normalizedConfig_.criticalCssCacheEntries);
+        auto criticalCss = CriticalCss::load(path, options);
+        LOG_INFO << logfmt::Line("HydraCriticalCss")
+                        .group("critical_css",
+                               {{"stylesheet", path.string()},
+                                {"rules", std::to_string(criticalCss->ruleCount())},
+                                {"classes", std::to_string(criticalCss->classCount())}})
+                        .str();
+        return criticalCss;
+    } catch (const std::exception &ex) {
+        LOG_WARN << "HydraStack critical_css disabled for this bundle: " << ex.what();
+        return nullptr;
+    }
+}
+
+void HydraSsrPlugin::resolveAssetPaths(const AssetManifest *manifest,
+                                       std::string *cssPath,
+                                       std::string *clientJsPath) const {
+    *cssPath = cssPath_;
+    *clientJsPath = clientJsPath_;
+    if (manifest != nullptr) {
+        const auto entryKey = manifest->clientEntryKey(clientManifestEntry_);
+        const auto *entry = manifest->chunk(entryKey);
+        if (entry == nullptr) {
+            LOG_WARN << "HydraStack manifest has no client entry: " << clientManifestEntry_;
+        } else if (entry->file.empty()) {
+            LOG_WARN << "HydraStack manifest missing JS file for client entry";
+        } else {
+            if (cssPath->empty()) {
+                *cssPath = manifest->stylesheetFor(entryKey);
+            }
+            if (clientJsPath->empty()) {
+                *clientJsPath = manifest->publicPath(entry->file);
+            }
+        }
+    }
+
+    if (devModeEnabled_) {
+        *cssPath = devProxyAssetsEnabled_ ? normalizeBrowserPath(devCssPath_)
+                                          : joinOriginAndPath(devProxyOrigin_, devCssPath_);
+        *clientJsPath = devProxyAssetsEnabled_
+                            ? normalizeBrowserPath(devClientEntryPath_)
+                            : joinOriginAndPath(devProxyOrigin_, devClientEntryPath_);
+        return;
+    }
+    if (cssPath->empty()) {
+        *cssPath = "/assets/app.css";
+        LOG_WARN << "HydraStack falling back to default css path: " << *cssPath;
+    }
+    if (clientJsPath->empty()) {
+        *clientJsPath = "/assets/client.js";
+        LOG_WARN << "HydraStack falling back to default client path: " << *clientJsPath;
+    }
+}
+
+HtmlShellPageMeta HydraSsrPlugin::shellPageMeta(
+    const PreparedRender &prepared,
+    const SsrRenderResult &page,
+    std::shared_ptr<const std::string> *criticalCss) const {
+    auto meta = pageMetaFor(page);
+    const auto *index = prepared.generation ? prepared.generation->criticalCss.get() : nullptr;
+    if (index == nullptr) {
+        return meta;
+    }
+    auto source = CriticalCss::Source::kSelected;
+    *criticalCss = index->rulesFor(prepared.pageId, page.html, &source);
+    switch (source) {
+        case CriticalCss::Source::kPage:
+            criticalCssPageHits_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case CriticalCss::Source::kClassSet:
+            criticalCssClassSetHits_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case CriticalCss::Source::kSelected:
+            criticalCssSelections_.fetch_add(1, std::memory_order_relaxed);
+            break;
+    }
+    if (*criticalCss) {
+        meta.criticalCss = **criticalCss;
+    } else {
+        criticalCssFallbacks_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return meta;
+}
+
+void HydraSsrPlugin::buildPreloads(const AssetManifest &manifest,
+                                   RenderGeneration *generation) const {
+    const auto entryKey = manifest.clientEntryKey(clientManifestEntry_);
+    if (manifest.chunk(entryKey) == nullptr) {
+        return;
+    }
+    const auto maxLinks = static_cast<std::size_t>(normalizedConfig_.earlyHintsMaxLinks);
+    const auto compile = [&](std::vector<AssetPreload> preloads,
+                             std::unique_ptr<const CompiledHtmlShell> *shell,
+                             std::string *linkHeader) {
+        // Stylesheets block first paint, so they are the last to be cut.
+        std::stable_partition(preloads.begin(), preloads.end(), [](const AssetPreload &preload) {
+            return preload.kind == AssetPreload::Kind::kStyle;
+        });
+        if (preloads.size() > maxLinks) {
+            preloads.resize(maxLinks);
+        }
+        *linkHeader = formatLinkHeader(preloads, clientJsModule_);
+        auto assets = shellDefaults(*generation);
+        if (normalizedConfig_.earlyHintsHtmlTags) {
+            for (const auto &preload : preloads) {
+                if (preload.kind == AssetPreload::Kind::kScript) {
+                    assets.scriptPreloadPaths.push_back(preload.href);
+                } else if (preload.href != assets.cssPath) {
+                    assets.stylePreloadPaths.push_back(preload.href);
+                }
+            }
+        }
+        *shell = std::make_unique<const CompiledHtmlShell>(assets);
+    };
+
+    const auto entryPreloads = manifest.preloadsFor({entryKey});
+    compile(entryPreloads, &generation->shell, &generation->linkHeader);
+
+    // Configured chunks win over the lazy chunk named like the page.
+    std::map<std::string, std::vector<std::string>> pageChunks;
+    for (const auto &[pageId, keys] : normalizedConfig_.earlyHintsPages) {
+        for (const auto &key : keys) {
+            if (manifest.chunk(key) == nullptr) {
+                LOG_WARN << "HydraStack early_hints.pages." << pageId
+                         << " names a key missing from the manifest: " << key;
+            }
+        }
+        if (auto page = AssetManifest::pageKey(pageId); !page.empty()) {
+            pageChunks[std::move(page)] = keys;
+        }
+    }
+    for (const auto &[page, key] : manifest.lazyChunksByPage(entryKey)) {
+        pageChunks.try_emplace(page, std::vector<std::string>{key});
+    }
+
+    std::unordered_set<std::string> entryHrefs;
+    for (const auto &preload : entryPreloads) {
+        entryHrefs.insert(preload.href);
+    }
+    for (const auto &[page, keys] : pageChunks) {
+        auto preloads = entryPreloads;
+        for (auto &preload : manifest.preloadsFor(keys)) {
+            if (entryHrefs.find(preload.href) == entryHrefs.end()) {
+                preloads.push_back(std::move(preload));
+            }
+        }
+        if (preloads.size() == entryPreloads.size()) {
+            continue;
+        }
+        auto &target = generation->pagePreloads[page];
+        compile(std::move(preloads), &target.shell, &target.linkHeader);
+    }
+}
+
+void HydraSsrPlugin::applyLinkHeader(const PreparedRender &prepared,
+                                     bool streamed,
+                                     SsrRenderResult *response) const {
+    if (prepared.linkHeader == nullptr || prepared.linkHeader->empty()) {
+        return;
+    }
+    // Render-supplied preloads go first.
+    auto &link = response->headers["Link"];
+    link = link.empty() ? *prepared.linkHeader : link + ", " + *prepared.linkHeader;
+    (streamed ? linkHeaderStreams_ : linkHeaderResponses_).fetch_add(1, std::memory_order_relaxed);
+}
+
+void HydraSsrPlugin::applyEntityTag(const PreparedRender &prepared,
+                                    std::string etag,
+                                    SsrRenderResult *response) const {
+    if (etag.empty()) {
+        return;
+    }
+    if (!prepared.ifNoneMatch.empty()) {
+        etagModified_.fetch_add(1, std::memory_order_relaxed);
+    }
+    response->headers["ETag"] = std::move(etag);
+}
+
+ReadinessReport HydraSsrPlugin::readiness() const {
+    ReadinessReport report;
+    const auto generation = currentGeneration();
+    if (!generation) {
+        report.reason = "not_initialized";
+        return report;
+    }
+    report.generation = generation->id;
+    if (!generation->pool->warm()) {
+        report.reason = "warming";
+        return report;
+    }
+    report.ready = true;
+    return report;
+}
+
+HydraSsrPlugin::GenerationPtr HydraSsrPlugin::currentGeneration() const {
+    std::lock_guard<std::mutex> lock(generationMutex_);
+    return generation_;
+}
+
+ReloadResult HydraSsrPlugin::performReload(const GenerationPtr &previous,
+                                           const std::string &reason) {
+    ReloadResult result;
+    const auto startedAt = std::chrono::steady_clock::now();
+    try {
+        auto next = buildGeneration_(previous.get());
+        next->id = (previous ? previous->id : 0) + 1;
+        next->reason = reason;
+        next->loadedAt = std::chrono::system_clock::now();
+        next->buildMs = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - startedAt)
+                .count());
+        result.ok = true;
+        result.generation = next->id;
+        result.message = "loaded in " + std::to_string(next->buildMs) + "ms";
+        {
+            std::lock_guard<std::mutex> lock(generationMutex_);
+            generation_ = std::move(next);
+            lastReloadError_.clear();
+        }
+        // Cached pages carry the old bundle's markup and asset URLs. Renders
+        // still running on the old generation may store after this; lookups
+        // skip entries of any generation but their own.
+        if (renderCache_) {
+            renderCache_->clear();
+        }
+        if (prerenderer_) {
+            prerenderer_->invalidate();
+        }
+        reloadsOk_.fetch_add(1, std::memory_order_relaxed);
+    } catch (const std::exception &ex) {
+        result.generation = previous ? previous->id : 0;
+        result.message = ex.what();
+        {
+            std::lock_guard<std::mutex> lock(generationMutex_);
+            lastReloadError_ = result.message;
+        }
+        reloadsFailed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto line = logfmt::Line("HydraReload")
+                    .group("reload",
+                           {{"result", result.ok ? "ok" : "failed"},
+                            {"reason", reason},
+                            {"generation", std::to_string(result.generation)}})
+                    .block(result.message);
+    if (result.ok) {
+        LOG_INFO << line.str();
+    } else {
+        LOG_ERROR << line.str() << " (still serving the previous generation)";
+    }
+    return result;
+}
+
+void HydraSsrPlugin::runReloadLoop() {
+    const auto interval = std::chrono::milliseconds(normalizedConfig_.hotReloadWatchIntervalMs);
+    const auto watchStamp = [this] {
+        return fileStamp(ssrBundlePath_) + "|" + fileStamp(assetManifestPath_);
+    };
+    std::string loadedStamp = watchStamp();
+    std::string pendingStamp = loadedStamp;
+    // Generations swapped out, kept here until their last lease returns so
+    // the isolates are never torn down on an IO or render thread.
+    std::vector<std::pair<GenerationPtr, std::chrono::steady_clock::time_point>> retired;
+
+    std::unique_lock<std::mutex> lock(reloadMutex_);
+    while (!reloadStopping_) {
+        reloadCv_.wait_for(lock, interval, [this] {
+            return reloadStopping_ || !reloadQueue_.empty();
+        });
+        if (reloadStopping_) {
+            break;
+        }
+        auto requests = std::move(reloadQueue_);
+        reloadQueue_.clear();
+        lock.unlock();
+
+        std::string reason;
+        if (!requests.empty()) {
+            reason = requests.front().reason;
+        } else if (reloadSignalled.exchange(false, std::memory_order_relaxed)) {
+            reason = "signal";
+        } else if (normalizedConfig_.hotReloadWatch) {
+            const auto stamp = watchStamp();
+            // Wait for the stamp to hold still so a half-written bundle from
+            // an in-progress build is not picked up.
+            if (stamp != loadedStamp && stamp == pendingStamp) {
+                reason = "watch";
+            }
+            pendingStamp = stamp;
+        }
+
+        if (!reason.empty()) {
+            auto previous = currentGeneration();
+            auto result = performReload(previous, reason);
+            // Also after a failure, so a broken build is not retried every
+            // tick; the next change to either file triggers again.
+            loadedStamp = watchStamp();
+            pendingStamp = loadedStamp;
+            if (result.ok && previous) {
+                retired.emplace_back(std::move(previous), std::chrono::steady_clock::now());
+            }
+            for (auto &request : requests) {
+                if (request.done) {
+                    request.done(result);
+                }
+            }
+        }
+
+        for (auto it = retired.begin(); it != retired.end();) {
+            if (it->first.use_count() > 1) {
+                ++it;
+                continue;
+            }
+            const auto drainMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::steady_clock::now() - it->second)
+                                     .count();
+            LOG_INFO << logfmt::Line("HydraReload")
+                            .group("drained",
+                                   {{"generation", std::to_string(it->first->id)},
+                                    {"ms", std::to_string(drainMs)}})
+                            .str();
+            it = retired.erase(it);
+        }
+        drainingGenerations_.store(retired.size(), std::memory_order_relaxed);
+        lock.lock();
+    }
+
+    auto pending = std::move(reloadQueue_);
+    reloadQueue_.clear();
+    lock.unlock();
+    for (auto &request : pending) {
+        if (request.done) {
+            request.done({false, 0, "Hydra runtime is shutting down"});
+        }
+    }
+    // Whatever has not drained yet goes when the last lease is released.
+    retired.clear();
+    drainingGenerations_.store(0, std::memory_order_relaxed);
+}
+
+ReloadResult HydraSsrPlugin::reload(std::string reason) {
+    auto promise = std::make_shared<std::promise<ReloadResult>>();
+    auto future = promise->get_future();
+    reloadAsync(std::move(reason), [promise](ReloadResult result) {
+        promise->set_value(std::move(result));
+    });
+    return future.get();
+}
+
+void HydraSsrPlugin::reloadAsync(std::string reason, std::function<void(ReloadResult)> done) {
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex_);
+        if (reloadThread_.joinable() && !reloadStopping_) {
+            reloadQueue_.push_back({std::move(reason), std::move(done)});
+            reloadCv_.notify_all();
             return;
         }
+    }
+    if (done) {
+        done({false, 0, "hot_reload is disabled"});
+    }
+}
+
+std::size_t HydraSsrPlugin::prerender(const std::vector<std::string> &paths) {
+    return prerenderer_ ? prerenderer_->invalidate(paths) : 0;
+}
 
-        response->headers.try_emplace("X-Content-Type-Options", "nosniff");
-        response->headers.try_emplace("Referrer-Policy", "strict-origin-when-cross-origin");
-        response->headers.try_emplace("X-Frame-Options", "DENY");
+void HydraSsrPlugin::invalidateRenderCache(const std::string &pageId) {
+    if (sharedRenderCache_) {
+        // Local keys carry the tag version too, so this node's copies retire
+        // along with the shared ones.
+        sharedRenderCache_->invalidate(pageId);
+    } else if (renderCache_) {
+        renderCache_->clear();
+    }
+}
 
-        if (devModeEnabled_ ||
-            response->headers.find("Content-Security-Policy") != response->headers.end()) {
+void HydraSsrPlugin::routeToPrerendered(const drogon::HttpRequestPtr &req) const {
+    if (!prerenderer_ || (req->method() != drogon::Get && req->method() != drogon::Head)) {
+        return;
+    }
+    const auto &path = req->path();
+    if (!prerenderer_->covers(path) || req->getHeader(kPrerenderHeader) == prerenderToken_) {
+        return;
+    }
+    // Any other query parameter may change the page.
+    for (const auto &[name, value] : req->getParameters()) {
+        if (name != requestContext_.localeQueryParam && name != requestContext_.themeQueryParam) {
             return;
         }
+    }
+    const auto context = requestContextBuilder_->build(req, path, {});
+    if (auto file = prerenderer_->lookup(
+            path, context["locale"].asString(), context["theme"].asString())) {
+        req->setPath(*file);
+    }
+}
+
+bool HydraSsrPlugin::shouldLogRenderEvent(bool failed, std::uint64_t totalUs) const {
+    return renderEventLog_ && renderEventLog_->shouldRecord(failed, totalUs);
+}
+
+void HydraSsrPlugin::logRenderEvent(const PreparedRender &prepared, RenderEvent &event) const {
+    event.route.assign(prepared.routeUrl);
+    event.requestId.assign(prepared.requestId);
+    event.pageId.assign(prepared.pageId);
+    renderEventLog_->record(event);
+}
+
+void HydraSsrPlugin::writeRenderEvent(const RenderEvent &event) const {
+    const auto toMs = [](std::uint64_t us) { return static_cast<double>(us) / 1000.0; };
+    const auto route = event.route.view();
+    const auto requestId = event.requestId.view();
+    const auto error = event.error.view();
+
+    // Counters are read when the event is written, not when it was recorded.
+    if (logRenderMetrics_ && !(event.failed && event.streamed)) {
+        std::ostringstream line;
+        line << "HydraMetrics"
+             << " | status=" << (event.failed ? "fail" : "ok");
+        if (event.streamed) {
+            line << " | mode=stream";
+        }
+        if (!event.failed) {
+            line << " | count=" << event.renderIndex;
+            if (!event.streamed) {
+                line << " | cache=" << (event.cache != nullptr ? event.cache : "off");
+            }
+        }
+        line << " | route=" << route
+             << " | request_id=" << requestId
+             << " | http_status=" << event.httpStatus
+             << " | latency_ms{acquire=" << toMs(event.acquireUs);
+        if (event.failed) {
+            line << ", wrap=0}";
+        } else if (event.streamed) {
+            line << ", render=" << toMs(event.renderUs) << "}"
+                 << " | bytes=" << event.streamedBytes;
+        } else {
+            line << ", render=" << toMs(event.renderUs)
+                 << ", wrap=" << toMs(event.wrapUs) << "}";
+        }
+        if (event.bridgeCalls > 0) {
+            line << " | bridge{calls=" << event.bridgeCalls
+                 << ", memoized=" << event.bridgeMemoized
+                 << ", wait_ms=" << toMs(event.bridgeWaitUs) << "}";
+        }
+        if (!event.streamed) {
+            line << " | counters{pool_timeouts="
+                 << poolTimeoutCount_.load(std::memory_order_relaxed)
+                 << ", render_timeouts="
+                 << renderTimeoutCount_.load(std::memory_order_relaxed)
+                 << ", runtime_recycles="
+                 << runtimeRecycleCount_.load(std::memory_order_relaxed)
+                 << "}";
+        }
+        if (event.failed) {
+            line << " | error=\"" << error << "\"";
+            LOG_WARN << line.str();
+        } else {
+            LOG_INFO << line.str();
+        }
+    }
 
-        if (wrappedWithShell && !scriptNonce.empty()) {
-            response->headers["Content-Security-Policy"] =
-                "default-src 'self'; script-src 'self' 'nonce-" + scriptNonce +
-                "'; style-src 'self' 'unsafe-inline'; connect-src 'self'; img-src 'self' data:; "
-                "object-src 'none'; base-uri 'self'; frame-ancestors 'none'";
+    if (logRequestRoutes_) {
+        std::ostringstream line;
+        line << "HydraRequest"
+             << " | status=" << (event.failed ? "fail" : "ok");
+        if (event.streamed) {
+            line << " | mode=stream";
+        } else {
+            line << " | method=" << event.method.view();
+        }
+        line << " | route=" << route
+             << " | request_id=" << requestId
+             << " | http_status=" << event.httpStatus;
+        if (!event.failed) {
+            line << " | page=" << (event.pageId.view().empty() ? "-" : event.pageId.view());
+        }
+        line << " | total_ms=" << toMs(event.totalUs);
+        if (event.failed) {
+            line << " | error=\"" << error << "\"";
+            LOG_WARN << line.str();
         } else {
-            response->headers["Content-Security-Policy"] =
-                "default-src 'self'; object-src 'none'; base-uri 'self'; frame-ancestors 'none'";
+            LOG_INFO << line.str();
+        }
+    }
+}
+
+void HydraSsrPlugin::applySecurityHeaders(SsrRenderResult *response,
+                                          bool wrappedWithShell,
+                                          const std::string &scriptNonce) const {
+    if (response == nullptr) {
+        return;
+    }
+
+    response->headers.try_emplace("X-Content-Type-Options", "nosniff");
+    response->headers.try_emplace("Referrer-Policy", "strict-origin-when-cross-origin");
+    response->headers.try_emplace("X-Frame-Options", "DENY");
+
+    if (devModeEnabled_ ||
+        response->headers.find("Content-Security-Policy") != response->headers.end()) {
+        return;
+    }
+
+    if (wrappedWithShell && !scriptNonce.empty()) {
+        response->headers["Content-Security-Policy"] =
+            "default-src 'self'; script-src 'self' 'nonce-" + scriptNonce +
+            "'; style-src 'self' 'unsafe-inline'; connect-src 'self'; img-src 'self' data:; "
+            "object-src 'none'; base-uri 'self'; frame-ancestors 'none'";
+    } else {
+        response->headers["Content-Security-Policy"] =
+            "default-src 'self'; object-src 'none'; base-uri 'self'; frame-ancestors 'none'";
+    }
+}
+
+void HydraSsrPlugin::postPrepared(const drogon::HttpRequestPtr &req,
+                                  std::string propsJson,
+                                  PreparedRender prepared,
+                                  SsrRenderCallback callback) const {
+    auto *callerLoop = trantor::EventLoop::getEventLoopOfCurrentThread();
+    // Admitted before queueing, like renderStream: a request admitted on the
+    // render thread has already spent its wait in the executor queue. Local
+    // cache hits skip admission; if the entry is gone by the time the render
+    // runs, renderOnIsolate() admits it there.
+    const auto cached = [&] {
+        if (!renderCache_ || renderCachePolicyFor(prepared.pageId).ttl.count() <= 0) {
+            return false;
+        }
+        return renderCache_->contains(
+            renderCacheKey(prepared, renderCacheRoute(prepared), propsJson),
+            prepared.generation->id);
+    };
+    if (admission_ && !cached()) {
+        try {
+            prepared.admission =
+                std::make_shared<AdmissionController::Ticket>(admitRender(prepared));
+        } catch (const AdmissionRejectedError &shedEx) {
+            resumeOnLoop(callerLoop,
+                         callback,
+                         shedRequest(prepared, shedEx, std::chrono::steady_clock::now(), 0));
+            return;
         }
+    }
+    prepared.queuedAt = std::chrono::steady_clock::now();
+    auto task = [this,
+                 req,
+                 propsJson = std::move(propsJson),
+                 prepared = std::move(prepared),
+                 callback,
+                 callerLoop]() mutable {
+        auto result = prepared.componentId.empty()
+                          ? renderPrepared(req, propsJson, prepared)
+                          : renderComponentPrepared(req, propsJson, prepared);
+        // The render is done; the ticket should not wait for the loop hop.
+        prepared.admission.reset();
+        resumeOnLoop(callerLoop, callback, std::move(result));
     };
 
     try {
-        auto lease = isolatePool_->acquire(isolateAcquireTimeoutMs_);
-        acquireWaitUs = static_cast<std::uint64_t>(
+        renderExecutor_->post(std::move(task));
+    } catch (const std::exception &ex) {
+        resumeOnLoop(callerLoop, callback, unavailableResult(req, 503, ex.what()));
+    }
+}
+
+void HydraSsrPlugin::renderResultAsync(const drogon::HttpRequestPtr &req,
+                                       Json::Value props,
+                                       const RenderOptions &options,
+                                       SsrRenderCallback callback) const {
+    if (!currentGeneration() || !renderExecutor_) {
+        resumeOnLoop(trantor::EventLoop::getEventLoopOfCurrentThread(),
+                     callback,
+                     renderResult(req, props, options));
+        return;
+    }
+
+    const auto serializeStartedAt = RenderTrace::Clock::now();
+    auto propsJson = toCompactJson(props);
+    const auto serializedAt = RenderTrace::Clock::now();
+    auto prepared = prepareRender(req, propsJson, propsShapeOf(props, propsJson), options);
+    if (prepared.trace) {
+        prepared.trace->addSpan("serialize", serializeStartedAt, serializedAt);
+    }
+    postPrepared(req, std::move(propsJson), std::move(prepared), std::move(callback));
+}
+
+void HydraSsrPlugin::renderFragmentAsync(const drogon::HttpRequestPtr &req,
+                                         Json::Value props,
+                                         std::string componentId,
+                                         const RenderOptions &options,
+                                         SsrRenderCallback callback) const {
+    if (!currentGeneration() || !renderExecutor_ || componentId.empty()) {
+        resumeOnLoop(trantor::EventLoop::getEventLoopOfCurrentThread(),
+                     callback,
+                     renderFragment(req, props, componentId, options));
+        return;
+    }
+
+    auto propsJson = toCompactJson(props);
+    auto prepared = prepareRender(req, propsJson, propsShapeOf(props, propsJson), options);
+    prepared.componentId = std::move(componentId);
+    prepared.fragmentFormat = options.fragmentFormat;
+    postPrepared(req, std::move(propsJson), std::move(prepared), std::move(callback));
+}
+
+void HydraSsrPlugin::renderResultAsync(const drogon::HttpRequestPtr &req,
+                                       std::string propsJson,
+                                       const RenderOptions &options,
+                                       SsrRenderCallback callback) const {
+    if (!currentGeneration() || !renderExecutor_) {
+        resumeOnLoop(trantor::EventLoop::getEventLoopOfCurrentThread(),
+                     callback,
+                     renderResult(req, propsJson, options));
+        return;
+    }
+
+    auto prepared = prepareRender(req, propsJson, options);
+    postPrepared(req, std::move(propsJson), std::move(prepared), std::move(callback));
+}
+
+#ifdef __cpp_impl_coroutine
+drogon::Task<SsrRenderResult> HydraSsrPlugin::renderResultCoro(drogon::HttpRequestPtr req,
+                                                               Json::Value props,
+                                                               RenderOptions options) const {
+    co_return co_await RenderResultAwaiter<Json::Value>(
+        this, std::move(req), std::move(props), std::move(options));
+}
+
+drogon::Task<SsrRenderResult> HydraSsrPlugin::renderResultCoro(drogon::HttpRequestPtr req,
+                                                               std::string propsJson,
+                                                               RenderOptions options) const {
+    co_return co_await RenderResultAwaiter<std::string>(
+        this, std::move(req), std::move(propsJson), std::move(options));
+}
+#endif
+
+void HydraSsrPlugin::renderStream(const drogon::HttpRequestPtr &req,
+                                  Json::Value props,
+                                  const RenderOptions &options,
+                                  SsrStreamCallback callback) const {
+    renderStream(req, toCompactJson(props), options, std::move(callback));
+}
+
+void HydraSsrPlugin::renderStream(const drogon::HttpRequestPtr &req,
+                                  std::string propsJson,
+                                  const RenderOptions &options,
+                                  SsrStreamCallback callback) const {
+    if (!callback) {
+        return;
+    }
+    if (!currentGeneration() || !renderExecutor_) {
+        callback(toHttpResponse(
+            unavailableResult(req, 500, "HydraSsrPlugin is not initialized")));
+        return;
+    }
+
+    // Past this point the 200 head is sent, so a full render queue has to be
+    // turned away here to still answer with a 503.
+    if (const auto maxQueue = renderExecutor_->maxQueueDepth();
+        maxQueue > 0 && renderExecutor_->queueDepth() >= maxQueue) {
+        callback(toHttpResponse(unavailableResult(req, 503, "Render queue is full")));
+        return;
+    }
+
+    const auto requestStartedAt = std::chrono::steady_clock::now();
+    auto preparedRender = prepareRender(req, propsJson, options);
+    preparedRender.queuedAt = requestStartedAt;
+    auto prepared = std::make_shared<const PreparedRender>(std::move(preparedRender));
+    // Decided before the 200 head goes out; a shed stream gets a regular
+    // shell or 503 response instead.
+    std::shared_ptr<AdmissionController::Ticket> admission;
+    if (admission_) {
+        try {
+            admission = std::make_shared<AdmissionController::Ticket>(admitRender(*prepared));
+        } catch (const AdmissionRejectedError &shedEx) {
+            callback(toHttpResponse(shedRequest(*prepared, shedEx, requestStartedAt, 0)));
+            return;
+        }
+    }
+    // The head is flushed before the bundle runs, so it always carries the
+    // configured shell metadata rather than per-page envelope values.
+    const auto &shell = *prepared->shell;
+    auto prefix = shell.prefix({});
+    auto suffix = std::make_shared<const std::string>(
+        shell.suffix(*prepared->propsJson, prepared->scriptNonce));
+
+    SsrRenderResult head;
+    head.headers["X-Request-Id"] = prepared->requestId;
+    applySecurityHeaders(&head, true, prepared->scriptNonce);
+    // Goes out with the head, before the render waits for an isolate.
+    applyLinkHeader(*prepared, true, &head);
+
+    auto response = drogon::HttpResponse::newAsyncStreamResponse(
+        [this, prepared, prefix = std::move(prefix), suffix, requestStartedAt, admission](
+            drogon::ResponseStreamPtr stream) mutable {
+            std::shared_ptr<drogon::ResponseStream> sharedStream(std::move(stream));
+            sharedStream->send(prefix);
+            try {
+                // The ticket moves with the render so it is released when
+                // the render finishes, not when the response is destroyed.
+                renderExecutor_->post([this,
+                                       prepared,
+                                       sharedStream,
+                                       suffix,
+                                       requestStartedAt,
+                                       admission = std::move(admission)]() mutable {
+                    streamDocument(*prepared, *sharedStream, *suffix, requestStartedAt);
+                    admission.reset();
+                });
+            } catch (const std::exception &ex) {
+                failStreamedDocument(
+                    *prepared, *sharedStream, *suffix, ex.what(), requestStartedAt, 0);
+            }
+        });
+    response->setContentTypeCode(drogon::CT_TEXT_HTML);
+    for (const auto &[headerName, headerValue] : head.headers) {
+        response->addHeader(headerName, headerValue);
+    }
+    callback(response);
+}
+
+void HydraSsrPlugin::streamDocument(const PreparedRender &prepared,
+                                    drogon::ResponseStream &stream,
+                                    const std::string &suffix,
+                                    std::chrono::steady_clock::time_point requestStartedAt) const {
+    const auto elapsedUs = [](std::chrono::steady_clock::time_point since) {
+        return static_cast<std::uint64_t>(
             std::chrono::duration_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now() - acquireStartedAt)
+                std::chrono::steady_clock::now() - since)
                 .count());
-        acquireWaitMs = static_cast<double>(acquireWaitUs) / 1000.0;
+    };
+
+    std::uint64_t acquireWaitUs = 0;
+    try {
+        const auto acquireTimeoutMs = acquireTimeoutFor(prepared);
+        auto *trace = prepared.trace.get();
+        RenderTrace::Scope acquireSpan(trace, "acquire");
+        const auto acquireStartedAt = std::chrono::steady_clock::now();
+        auto lease = prepared.generation->pool->acquire(acquireTimeoutMs);
+        acquireWaitUs = elapsedUs(acquireStartedAt);
+        acquireSpan.end();
 
         try {
             const auto renderStartedAt = std::chrono::steady_clock::now();
-            auto rawRenderOutput =
-                lease->render(
-                    routeUrl,
-                    effectivePropsJson,
-                    requestContextJson,
-                    isolatePool_->renderTimeoutMs());
-            observeAcquireWait(acquireWaitMs);
-            const auto renderUs = static_cast<std::uint64_t>(
-                std::chrono::duration_cast<std::chrono::microseconds>(
-                    std::chrono::steady_clock::now() - renderStartedAt)
-                    .count());
-            const auto renderMs = static_cast<double>(renderUs) / 1000.0;
-            observeRenderLatency(renderMs);
-            const auto renderIndex =
-                renderCount_.fetch_add(1, std::memory_order_relaxed) + 1;
-            std::uint64_t wrapUs = 0;
-            double wrapMs = 0.0;
-            SsrRenderResult renderResult;
-            if (const auto parsed = tryParseSsrEnvelope(rawRenderOutput); parsed.has_value()) {
-                renderResult = *parsed;
-            } else {
-                renderResult.html = std::move(rawRenderOutput);
-                renderResult.status = 200;
+            std::uint64_t streamedBytes = 0;
+            V8SsrRuntime::RenderOutput tail;
+            {
+                RenderTrace::Scope streamSpan(trace, "stream");
+                RenderTrace::Activation activation(trace);
+                RequestContextBuilder::Activation requestDetails(requestContextBuilder_.get(),
+                                                                 prepared.lazyRequest);
+                tail = lease->renderStreamOutput(
+                    prepared.routeUrl,
+                    prepared.propsJson,
+                    prepared.requestContextJson,
+                    prepared.generation->pool->renderTimeoutMs(),
+                    [&stream, &streamedBytes](std::string_view chunk) {
+                        streamedBytes += chunk.size();
+                        return stream.send(std::string(chunk));
+                    });
             }
-
-            const bool isRedirect =
-                renderResult.status >= 300 &&
-                renderResult.status <= 399 &&
-                renderResult.headers.find("Location") != renderResult.headers.end();
-
-            if (!isRedirect &&
-                wrapFragment_ &&
-                !renderResult.html.empty() &&
-                !isLikelyFullDocument(renderResult.html)) {
-                HtmlShellAssets assets;
-                assets.title = renderResult.title.empty() ? shellTitle_ : renderResult.title;
-                assets.description = renderResult.description.empty()
-                                         ? shellDescription_
-                                         : renderResult.description;
-                assets.canonicalUrl = renderResult.canonicalUrl.empty()
-                                          ? shellCanonicalUrl_
-                                          : renderResult.canonicalUrl;
-                assets.robots = renderResult.robots.empty() ? shellRobots_ : renderResult.robots;
-                assets.ogType = renderResult.ogType.empty() ? shellOgType_ : renderResult.ogType;
-                assets.imageUrl = renderResult.imageUrl.empty()
-                                      ? shellImageUrl_
-                                      : renderResult.imageUrl;
-                assets.siteName = renderResult.siteName.empty()
-                                      ? shellSiteName_
-                                      : renderResult.siteName;
-                assets.twitterCard = renderResult.twitterCard.empty()
-                                         ? shellTwitterCard_
-                                         : renderResult.twitterCard;
-                assets.cssPath = cssPath_;
-                assets.clientJsPath = clientJsPath_;
-                assets.hmrClientPath = hmrClientPath_;
-                assets.scriptNonce = scriptNonce;
-                assets.clientJsModule = clientJsModule_;
-                if (devModeEnabled_ && devAutoReloadEnabled_) {
-                    assets.devReloadProbePath = normalizeBrowserPath(devReloadProbePath_);
-                    assets.devReloadIntervalMs = devReloadIntervalMs_;
+            const auto bridgeStats = lease->lastBridgeStats();
+            observeBridgeCalls(bridgeStats);
+            // render() fallback, or a renderStream that returned its HTML.
+            std::string tailHtml;
+            if (tail.envelope.has_value()) {
+                tailHtml = std::move(tail.envelope->html);
+            } else if (!tail.text.empty()) {
+                RenderTrace::Scope parseSpan(trace, "parse");
+                if (auto parsed = tryParseSsrEnvelope(tail.text); parsed.has_value()) {
+                    tail.text = std::move(parsed->html);
                 }
-                const auto wrapStartedAt = std::chrono::steady_clock::now();
-                auto wrappedHtml = HtmlShell::wrap(
-                    renderResult.html,
-                    effectivePropsJson,
-                    assets);
-                wrapUs = static_cast<std::uint64_t>(
-                    std::chrono::duration_cast<std::chrono::microseconds>(
-                        std::chrono::steady_clock::now() - wrapStartedAt)
-                        .count());
-                wrapMs = static_cast<double>(wrapUs) / 1000.0;
-                const auto totalUs = requestElapsedUs();
-                const auto totalMs = static_cast<double>(totalUs) / 1000.0;
-                requestOkCount_.fetch_add(1, std::memory_order_relaxed);
-                observeRequestCode(renderResult.status);
-                observeRequestLatency(totalMs);
-                totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
-                totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
-                totalRenderUs_.fetch_add(renderUs, std::memory_order_relaxed);
-                totalWrapUs_.fetch_add(wrapUs, std::memory_order_relaxed);
-                renderResult.html = std::move(wrappedHtml);
-                renderResult.headers.try_emplace("X-Request-Id", requestId);
-                applySecurityHeaders(&renderResult, true);
-                logRenderOk(renderIndex, renderMs, wrapMs, renderResult.status);
-                logRequestRoute("ok", totalMs, renderResult.status);
-                return renderResult;
+                tailHtml = std::move(tail.text);
             }
-
-            if (!isRedirect &&
-                !wrapFragment_ &&
-                !renderResult.html.empty() &&
-                !isLikelyFullDocument(renderResult.html)) {
-                bool expected = false;
-                if (warnedUnwrappedFragment_.compare_exchange_strong(
-                        expected, true, std::memory_order_relaxed)) {
-                    LOG_WARN << "HydraSsrPlugin wrap_fragment=false while SSR returned HTML fragment. "
-                             << "This can break CSS/JS injection.";
-                }
+            if (!tailHtml.empty()) {
+                streamedBytes += tailHtml.size();
+                stream.send(tailHtml);
             }
-
-            const auto totalUs = requestElapsedUs();
-            const auto totalMs = static_cast<double>(totalUs) / 1000.0;
+            stream.send(suffix);
+            stream.close();
+
+            const auto renderUs = elapsedUs(renderStartedAt);
+            const auto totalUs = elapsedUs(requestStartedAt);
+            const auto renderIndex = renderCount_.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (admission_) {
+                admission_->observeRender(renderUs);
+            }
+            observeAcquireWait(acquireWaitUs);
+            observeRenderLatency(prepared, renderUs);
             requestOkCount_.fetch_add(1, std::memory_order_relaxed);
-            observeRequestCode(renderResult.status);
-            observeRequestLatency(totalMs);
+            observeRequestCode(200);
+            observeRequestLatency(prepared, totalUs);
             totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
             totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
             totalRenderUs_.fetch_add(renderUs, std::memory_order_relaxed);
-            totalWrapUs_.fetch_add(wrapUs, std::memory_order_relaxed);
-            renderResult.headers.try_emplace("X-Request-Id", requestId);
-            applySecurityHeaders(&renderResult, false);
-            logRenderOk(renderIndex, renderMs, wrapMs, renderResult.status);
-            logRequestRoute("ok", totalMs, renderResult.status);
-
-            return renderResult;
+            if (shouldLogRenderEvent(false, totalUs)) {
+                RenderEvent event;
+                event.streamed = true;
+                event.httpStatus = 200;
+                event.renderIndex = renderIndex;
+                event.acquireUs = acquireWaitUs;
+                event.renderUs = renderUs;
+                event.totalUs = totalUs;
+                event.streamedBytes = streamedBytes;
+                event.bridgeCalls = bridgeStats.syncCalls + bridgeStats.asyncCalls;
+                event.bridgeMemoized = bridgeStats.memoized;
+                event.bridgeWaitUs = bridgeStats.waitUs;
+                logRenderEvent(prepared, event);
+            }
+            finishTrace(prepared, 200, false, nullptr);
+            return;
         } catch (const std::exception &renderEx) {
-            lease.markForRecycle();
-            runtimeRecycleCount_.fetch_add(1, std::memory_order_relaxed);
-            const std::string message = renderEx.what();
-            if (containsText(message, "SSR render exceeded timeout")) {
-                renderTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+            // A client that went away is not the runtime's fault.
+            if (!containsText(renderEx.what(), "SSR stream closed by client")) {
+                lease.markForRecycle();
+                runtimeRecycleCount_.fetch_add(1, std::memory_order_relaxed);
             }
             throw;
         } catch (...) {
@@ -1809,84 +3686,144 @@ SsrRenderResult HydraSsrPlugin::renderResult(const drogon::HttpRequestPtr &req,
             throw;
         }
     } catch (const std::exception &ex) {
-        const std::string message = ex.what();
-        if (containsText(message, "Timed out waiting for available V8 isolate")) {
-            poolTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        failStreamedDocument(prepared, stream, suffix, ex.what(), requestStartedAt, acquireWaitUs);
+    } catch (...) {
+        failStreamedDocument(
+            prepared, stream, suffix, "Unknown SSR runtime error", requestStartedAt, acquireWaitUs);
+    }
+}
+
+void HydraSsrPlugin::failStreamedDocument(const PreparedRender &prepared,
+                                          drogon::ResponseStream &stream,
+                                          const std::string &suffix,
+                                          const std::string &message,
+                                          std::chrono::steady_clock::time_point requestStartedAt,
+                                          std::uint64_t acquireWaitUs) const {
+    if (containsText(message, "Timed out waiting for available V8 isolate")) {
+        poolTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+        if (admission_) {
+            // Too late to shed: the head is out, so this still ends as a
+            // client-rendered document.
+            admission_->recordTimeout(prepared.priority);
         }
-        if (containsText(message, "SSR render exceeded timeout")) {
-            renderTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (containsText(message, "SSR render exceeded timeout")) {
+        renderTimeoutCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    const auto totalUs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - requestStartedAt)
+            .count());
+    // The 200 status left with the head; the wire code is what gets counted.
+    requestFailCount_.fetch_add(1, std::memory_order_relaxed);
+    observeRequestCode(200);
+    observeRequestLatency(prepared, totalUs);
+    renderErrorCount_.fetch_add(1, std::memory_order_relaxed);
+    totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
+    totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
+    observeAcquireWait(acquireWaitUs);
+    if (shouldLogRenderEvent(true, totalUs)) {
+        RenderEvent event;
+        event.failed = true;
+        event.streamed = true;
+        event.httpStatus = 200;
+        event.acquireUs = acquireWaitUs;
+        event.totalUs = totalUs;
+        event.error.assign(message);
+        logRenderEvent(prepared, event);
+    }
+    LOG_ERROR << "HydraStack stream render failed for url=" << prepared.routeUrl
+              << ", request_id=" << prepared.requestId << ": " << message;
+    finishTrace(prepared, 200, true, nullptr);
+
+    // Close the document so the client bundle boots and renders on its own;
+    // the marker tells it to skip hydration of the partial markup.
+    stream.send("<template id=\"__HYDRA_SSR_ERROR__\" data-request-id=\"" +
+                prepared.requestId + "\"></template>");
+    stream.send(suffix);
+    stream.close();
+}
+
+SsrRenderResult HydraSsrPlugin::unavailableResult(const drogon::HttpRequestPtr &req,
+                                                  int status,
+                                                  const std::string &message) const {
+    SsrRenderResult unavailable;
+    unavailable.status = status;
+    unavailable.html = HtmlShell::errorPage(message);
+    unavailable.headers["X-Request-Id"] = resolveRequestId(req);
+    unavailable.headers["X-Content-Type-Options"] = "nosniff";
+    unavailable.headers["Referrer-Policy"] = "strict-origin-when-cross-origin";
+    return unavailable;
+}
+
+std::shared_ptr<RenderTrace> HydraSsrPlugin::startTrace(const drogon::HttpRequestPtr &req,
+                                                        const std::string &requestId) const {
+    if (!tracingEnabled_) {
+        return nullptr;
+    }
+    std::optional<RenderTrace::TraceContext> parent;
+    if (req) {
+        if (const auto &header = req->getHeader("traceparent"); !header.empty()) {
+            parent = RenderTrace::parseTraceparent(header);
         }
-        const auto totalUs = requestElapsedUs();
-        const auto totalMs = static_cast<double>(totalUs) / 1000.0;
-        requestFailCount_.fetch_add(1, std::memory_order_relaxed);
-        observeRequestCode(500);
-        observeRequestLatency(totalMs);
-        renderErrorCount_.fetch_add(1, std::memory_order_relaxed);
-        totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
-        totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
-        observeAcquireWait(acquireWaitMs);
-        logRenderFail(message, 500);
-        logRequestRoute("fail", totalMs, 500, &message);
-        LOG_ERROR << "HydraStack render failed for url=" << routeUrl
-                  << ", request_id=" << requestId << ": " << ex.what();
-        SsrRenderResult failed;
-        failed.status = 500;
-        failed.html = HtmlShell::errorPage(ex.what());
-        failed.headers["X-Request-Id"] = requestId;
-        applySecurityHeaders(&failed, false);
-        return failed;
-    } catch (...) {
-        const auto totalUs = requestElapsedUs();
-        const auto totalMs = static_cast<double>(totalUs) / 1000.0;
-        requestFailCount_.fetch_add(1, std::memory_order_relaxed);
-        observeRequestCode(500);
-        observeRequestLatency(totalMs);
-        renderErrorCount_.fetch_add(1, std::memory_order_relaxed);
-        totalRequestUs_.fetch_add(totalUs, std::memory_order_relaxed);
-        totalAcquireWaitUs_.fetch_add(acquireWaitUs, std::memory_order_relaxed);
-        observeAcquireWait(acquireWaitMs);
-        logRenderFail("unknown", 500);
-        const std::string unknownError = "unknown";
-        logRequestRoute("fail", totalMs, 500, &unknownError);
-        LOG_ERROR << "HydraStack render failed for url=" << routeUrl
-                  << ", request_id=" << requestId << ": unknown exception";
-        SsrRenderResult failed;
-        failed.status = 500;
-        failed.html = HtmlShell::errorPage("Unknown SSR runtime error");
-        failed.headers["X-Request-Id"] = requestId;
-        applySecurityHeaders(&failed, false);
-        return failed;
     }
+    // Parent-based: an upstream that decided not to sample is respected.
+    const bool sampled =
+        parent.has_value() ? parent->sampled : shouldSampleTrace(tracingSampleRate_);
+    if (!sampled) {
+        return nullptr;
+    }
+    tracedRequestCount_.fetch_add(1, std::memory_order_relaxed);
+    return std::make_shared<RenderTrace>(requestId, parent);
+}
+
+void HydraSsrPlugin::finishTrace(const PreparedRender &prepared,
+                                 int httpStatus,
+                                 bool failed,
+                                 SsrRenderResult *response) const {
+    if (!prepared.trace) {
+        return;
+    }
+    prepared.trace->finish(httpStatus, failed);
+    if (response != nullptr && tracingServerTiming_) {
+        auto &header = response->headers["Server-Timing"];
+        header = header.empty() ? prepared.trace->serverTiming()
+                                : header + ", " + prepared.trace->serverTiming();
+    }
+    if (traceExporter_) {
+        traceExporter_->submit(prepared.trace);
+    }
+}
+
+void HydraSsrPlugin::observeAcquireWait(std::uint64_t acquireWaitUs) const {
+    acquireWaitHistogram_.record(acquireWaitUs);
 }
 
-void HydraSsrPlugin::observeAcquireWait(double valueMs) const {
-    static constexpr std::array<double, kLatencyHistogramBucketCount - 1> kUpperBoundsMs = {
-        1.0, 5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0};
-    std::size_t bucketIndex = 0;
-    while (bucketIndex < kUpperBoundsMs.size() && valueMs > kUpperBoundsMs[bucketIndex]) {
-        ++bucketIndex;
+void HydraSsrPlugin::observeRenderLatency(const PreparedRender &prepared,
+                                          std::uint64_t renderUs) const {
+    renderLatencyHistogram_.record(renderUs);
+    if (prepared.latencyRoute != nullptr) {
+        prepared.latencyRoute->render.record(renderUs);
     }
-    acquireWaitHistogram_[bucketIndex].fetch_add(1, std::memory_order_relaxed);
 }
 
-void HydraSsrPlugin::observeRenderLatency(double valueMs) const {
-    static constexpr std::array<double, kLatencyHistogramBucketCount - 1> kUpperBoundsMs = {
-        1.0, 5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0};
-    std::size_t bucketIndex = 0;
-    while (bucketIndex < kUpperBoundsMs.size() && valueMs > kUpperBoundsMs[bucketIndex]) {
-        ++bucketIndex;
+void HydraSsrPlugin::observeRequestLatency(const PreparedRender &prepared,
+                                           std::uint64_t totalUs) const {
+    requestLatencyHistogram_.record(totalUs);
+    if (prepared.latencyRoute != nullptr) {
+        prepared.latencyRoute->request.record(totalUs);
     }
-    renderLatencyHistogram_[bucketIndex].fetch_add(1, std::memory_order_relaxed);
 }
 
-void HydraSsrPlugin::observeRequestLatency(double valueMs) const {
-    static constexpr std::array<double, kLatencyHistogramBucketCount - 1> kUpperBoundsMs = {
-        1.0, 5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0};
-    std::size_t bucketIndex = 0;
-    while (bucketIndex < kUpperBoundsMs.size() && valueMs > kUpperBoundsMs[bucketIndex]) {
-        ++bucketIndex;
+void HydraSsrPlugin::observeBridgeCalls(const BridgeRenderStats &stats) const {
+    if (stats.syncCalls == 0 && stats.asyncCalls == 0) {
+        return;
     }
-    requestLatencyHistogram_[bucketIndex].fetch_add(1, std::memory_order_relaxed);
+    bridgeRenders_.fetch_add(1, std::memory_order_relaxed);
+    bridgeSyncCalls_.fetch_add(stats.syncCalls, std::memory_order_relaxed);
+    bridgeAsyncCalls_.fetch_add(stats.asyncCalls, std::memory_order_relaxed);
+    bridgeMemoizedCalls_.fetch_add(stats.memoized, std::memory_order_relaxed);
+    bridgeWaitUs_.fetch_add(stats.waitUs, std::memory_order_relaxed);
 }
 
 void HydraSsrPlugin::observeRequestCode(int statusCode) const {
@@ -1909,6 +3846,7 @@ HydraMetricsSnapshot HydraSsrPlugin::metricsSnapshot() const {
     snapshot.totalRenderUs = totalRenderUs_.load(std::memory_order_relaxed);
     snapshot.totalWrapUs = totalWrapUs_.load(std::memory_order_relaxed);
     snapshot.totalRequestUs = totalRequestUs_.load(std::memory_order_relaxed);
+    snapshot.renders = renderCount_.load(std::memory_order_relaxed);
     snapshot.totalAcquireWaitMs = snapshot.totalAcquireWaitUs / 1000;
     snapshot.totalRenderMs = snapshot.totalRenderUs / 1000;
     snapshot.totalWrapMs = snapshot.totalWrapUs / 1000;
@@ -1918,63 +3856,261 @@ HydraMetricsSnapshot HydraSsrPlugin::metricsSnapshot() const {
 
 std::string HydraSsrPlugin::metricsPrometheus() const {
     const auto snapshot = metricsSnapshot();
-    const auto totalRequests = snapshot.requestsOk + snapshot.requestsFail;
-    const auto poolInUse = isolatePool_ ? isolatePool_->inUseCount() : 0;
-    const auto poolSize = isolatePool_ ? isolatePool_->size() : 0;
-    static constexpr std::array<double, kLatencyHistogramBucketCount - 1> kUpperBoundsMs = {
-        1.0, 5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2500.0, 5000.0, 10000.0};
+    const auto generation = currentGeneration();
+    const auto *isolatePool = generation ? generation->pool.get() : nullptr;
+    const auto poolInUse = isolatePool ? isolatePool->inUseCount() : 0;
+    const auto poolSize = isolatePool ? isolatePool->size() : 0;
 
     std::ostringstream out;
-    const auto emitHistogram = [&](const char *name,
-                                   const char *helpText,
-                                   const auto &histogramBuckets,
-                                   double sumMs,
-                                   std::uint64_t count) {
+    const auto emitHistogramHeader = [&](const char *name, const char *helpText) {
         out << "# HELP " << name << " " << helpText << '\n';
         out << "# TYPE " << name << " histogram\n";
-        std::uint64_t cumulative = 0;
-        for (std::size_t i = 0; i < kUpperBoundsMs.size(); ++i) {
-            cumulative += histogramBuckets[i].load(std::memory_order_relaxed);
-            out << name << "_bucket{le=\"" << static_cast<std::uint64_t>(kUpperBoundsMs[i]) << "\"} "
-                << cumulative << '\n';
-        }
-        cumulative += histogramBuckets[kUpperBoundsMs.size()].load(std::memory_order_relaxed);
-        out << name << "_bucket{le=\"+Inf\"} " << cumulative << '\n';
-        out << name << "_sum " << sumMs << '\n';
-        out << name << "_count " << count << '\n';
+    };
+    // `labels` is empty or a `name="value",` prefix for the bucket labels.
+    const auto emitHistogramSeries = [&](const char *name,
+                                         const std::string &labels,
+                                         const LatencyHistogram::Snapshot &histogram) {
+        for (std::size_t i = 0; i < histogramBoundsUs_.size(); ++i) {
+            out << name << "_bucket{" << labels << "le=\"" << histogramBoundsMs_[i] << "\"} "
+                << histogram.countAtOrBelow(histogramBoundsUs_[i]) << '\n';
+        }
+        out << name << "_bucket{" << labels << "le=\"+Inf\"} " << histogram.count << '\n';
+        const auto series =
+            labels.empty() ? std::string{} : "{" + labels.substr(0, labels.size() - 1) + "}";
+        out << name << "_sum" << series << ' ' << static_cast<double>(histogram.sumUs) / 1000.0
+            << '\n';
+        out << name << "_count" << series << ' ' << histogram.count << '\n';
+    };
+    const auto emitQuantiles = [&](const char *name,
+                                   const std::string &labels,
+                                   const LatencyHistogram::Snapshot &histogram) {
+        for (const auto quantile : latencyQuantiles_) {
+            out << name << '{' << labels << "quantile=\"" << quantile << "\"} "
+                << histogram.quantileUs(quantile) / 1000.0 << '\n';
+        }
     };
 
-    emitHistogram(
-        "hydra_acquire_wait_ms",
-        "Hydra isolate acquire wait histogram in milliseconds.",
-        acquireWaitHistogram_,
-        static_cast<double>(snapshot.totalAcquireWaitUs) / 1000.0,
-        totalRequests);
-    emitHistogram(
-        "hydra_render_latency_ms",
-        "Hydra engine-side SSR render latency histogram in milliseconds.",
-        renderLatencyHistogram_,
-        static_cast<double>(snapshot.totalRenderUs) / 1000.0,
-        snapshot.requestsOk);
-    emitHistogram(
-        "hydra_request_total_ms",
-        "Hydra end-to-end request latency histogram in milliseconds.",
-        requestLatencyHistogram_,
-        static_cast<double>(snapshot.totalRequestUs) / 1000.0,
-        totalRequests);
+    const auto acquireWait = acquireWaitHistogram_.snapshot();
+    const auto renderLatency = renderLatencyHistogram_.snapshot();
+    const auto requestLatency = requestLatencyHistogram_.snapshot();
+    emitHistogramHeader("hydra_acquire_wait_ms",
+                        "Hydra isolate acquire wait histogram in milliseconds.");
+    emitHistogramSeries("hydra_acquire_wait_ms", {}, acquireWait);
+    emitHistogramHeader("hydra_render_latency_ms",
+                        "Hydra engine-side SSR render latency histogram in milliseconds.");
+    emitHistogramSeries("hydra_render_latency_ms", {}, renderLatency);
+    emitHistogramHeader("hydra_request_total_ms",
+                        "Hydra end-to-end request latency histogram in milliseconds.");
+    emitHistogramSeries("hydra_request_total_ms", {}, requestLatency);
+    const auto bridgeCallLatency = bridgeCallHistogram_.snapshot();
+    emitHistogramHeader("hydra_bridge_call_latency_ms",
+                        "Hydra API bridge handler latency per call in milliseconds.");
+    emitHistogramSeries("hydra_bridge_call_latency_ms", {}, bridgeCallLatency);
+    if (!latencyQuantiles_.empty()) {
+        out << "# HELP hydra_latency_quantile_ms Latency quantiles since start, estimated from the log-linear histograms.\n";
+        out << "# TYPE hydra_latency_quantile_ms gauge\n";
+        emitQuantiles("hydra_latency_quantile_ms", "stage=\"acquire_wait\",", acquireWait);
+        emitQuantiles("hydra_latency_quantile_ms", "stage=\"render\",", renderLatency);
+        emitQuantiles("hydra_latency_quantile_ms", "stage=\"request\",", requestLatency);
+        emitQuantiles("hydra_latency_quantile_ms", "stage=\"bridge_call\",", bridgeCallLatency);
+    }
+
+    if (routeLatency_) {
+        struct RouteSnapshot {
+            std::string labels;
+            LatencyHistogram::Snapshot render;
+            LatencyHistogram::Snapshot request;
+        };
+        std::vector<RouteSnapshot> routes;
+        for (const auto *route : routeLatency_->routes()) {
+            routes.push_back({"route=\"" + escapePrometheusLabel(route->name) + "\",",
+                              route->render.snapshot(),
+                              route->request.snapshot()});
+        }
+        emitHistogramHeader("hydra_route_render_latency_ms",
+                            "Engine-side SSR render latency by pageId in milliseconds.");
+        for (const auto &route : routes) {
+            emitHistogramSeries("hydra_route_render_latency_ms", route.labels, route.render);
+        }
+        emitHistogramHeader("hydra_route_request_total_ms",
+                            "End-to-end request latency by pageId in milliseconds.");
+        for (const auto &route : routes) {
+            emitHistogramSeries("hydra_route_request_total_ms", route.labels, route.request);
+        }
+        if (!latencyQuantiles_.empty()) {
+            out << "# HELP hydra_route_latency_quantile_ms Latency quantiles by pageId since start.\n";
+            out << "# TYPE hydra_route_latency_quantile_ms gauge\n";
+            for (const auto &route : routes) {
+                emitQuantiles("hydra_route_latency_quantile_ms", route.labels + "stage=\"render\",",
+                              route.render);
+                emitQuantiles("hydra_route_latency_quantile_ms",
+                              route.labels + "stage=\"request\",", route.request);
+            }
+        }
+        out << "# HELP hydra_route_metrics_routes Page ids with their own latency series.\n";
+        out << "# TYPE hydra_route_metrics_routes gauge\n";
+        out << "hydra_route_metrics_routes " << routes.size() << '\n';
+    }
 
     out << "# HELP hydra_pool_in_use Number of V8 runtimes currently leased.\n";
     out << "# TYPE hydra_pool_in_use gauge\n";
     out << "hydra_pool_in_use " << poolInUse << '\n';
 
+    if (isolatePool) {
+        const auto scaling = isolatePool->scalingStats();
+        out << "# HELP hydra_pool_scale_events_total Elastic pool scaling decisions by action.\n";
+        out << "# TYPE hydra_pool_scale_events_total counter\n";
+        out << "hydra_pool_scale_events_total{action=\"grow\"} " << scaling.grows << '\n';
+        out << "hydra_pool_scale_events_total{action=\"grow_failed\"} " << scaling.growFailures
+            << '\n';
+        out << "hydra_pool_scale_events_total{action=\"reap\"} " << scaling.reaps << '\n';
+
+        out << "# HELP hydra_pool_leases_total Runtime leases by path: pinned runtime, stolen idle slot, or after waiting.\n";
+        out << "# TYPE hydra_pool_leases_total counter\n";
+        out << "hydra_pool_leases_total{path=\"affine\"} " << scaling.leases.affine << '\n';
+        out << "hydra_pool_leases_total{path=\"stolen\"} " << scaling.leases.stolen << '\n';
+        out << "hydra_pool_leases_total{path=\"waited\"} " << scaling.leases.waited << '\n';
+
+        out << "# HELP hydra_pool_standby_runtimes Pre-built runtimes ready to replace a failed one.\n";
+        out << "# TYPE hydra_pool_standby_runtimes gauge\n";
+        out << "hydra_pool_standby_runtimes " << scaling.standby << '\n';
+
+        out << "# HELP hydra_pool_pending_rebuilds Failed runtimes waiting for a replacement.\n";
+        out << "# TYPE hydra_pool_pending_rebuilds gauge\n";
+        out << "hydra_pool_pending_rebuilds " << scaling.pendingRebuilds << '\n';
+
+        out << "# HELP hydra_pool_standby_swaps_total Recycles served from a standby runtime.\n";
+        out << "# TYPE hydra_pool_standby_swaps_total counter\n";
+        out << "hydra_pool_standby_swaps_total " << scaling.standbySwaps << '\n';
+
+        out << "# HELP hydra_pool_rebuild_ms Background runtime build latency.\n";
+        out << "# TYPE hydra_pool_rebuild_ms summary\n";
+        out << "hydra_pool_rebuild_ms_sum "
+            << static_cast<double>(scaling.rebuildUsTotal) / 1000.0 << '\n';
+        out << "hydra_pool_rebuild_ms_count " << scaling.rebuilds << '\n';
+
+        out << "# HELP hydra_pool_rebuild_ms_max Slowest background runtime build.\n";
+        out << "# TYPE hydra_pool_rebuild_ms_max gauge\n";
+        out << "hydra_pool_rebuild_ms_max " << static_cast<double>(scaling.rebuildUsMax) / 1000.0
+            << '\n';
+
+        out << "# HELP hydra_pool_rebuild_failures_total Background runtime builds that failed.\n";
+        out << "# TYPE hydra_pool_rebuild_failures_total counter\n";
+        out << "hydra_pool_rebuild_failures_total " << scaling.rebuildFailures << '\n';
+
+        out << "# HELP hydra_pool_warm Whether every initial runtime has finished warm-up.\n";
+        out << "# TYPE hydra_pool_warm gauge\n";
+        out << "hydra_pool_warm " << (scaling.warm ? 1 : 0) << '\n';
+
+        if (normalizedConfig_.warmupEnabled && !devModeEnabled_) {
+            out << "# HELP hydra_pool_warmup_ms Runtime warm-up latency.\n";
+            out << "# TYPE hydra_pool_warmup_ms summary\n";
+            out << "hydra_pool_warmup_ms_sum "
+                << static_cast<double>(scaling.warmupUsTotal) / 1000.0 << '\n';
+            out << "hydra_pool_warmup_ms_count " << scaling.warmups << '\n';
+
+            out << "# HELP hydra_warmup_render_failures_total Warm-up renders that threw; the "
+                   "route is skipped for the rest of that runtime's warm-up.\n";
+            out << "# TYPE hydra_warmup_render_failures_total counter\n";
+            out << "hydra_warmup_render_failures_total "
+                << warmupRenderFailures_.load(std::memory_order_relaxed) << '\n';
+        }
+    }
+
     out << "# HELP hydra_pool_size Total V8 runtimes in the pool.\n";
     out << "# TYPE hydra_pool_size gauge\n";
     out << "hydra_pool_size " << poolSize << '\n';
 
+    out << "# HELP hydra_generation Render generation (bundle and manifest build) serving requests.\n";
+    out << "# TYPE hydra_generation gauge\n";
+    out << "hydra_generation " << (generation ? generation->id : 0) << '\n';
+
+    out << "# HELP hydra_reloads_total Hot reloads of the SSR bundle by result.\n";
+    out << "# TYPE hydra_reloads_total counter\n";
+    out << "hydra_reloads_total{result=\"ok\"} " << reloadsOk_.load(std::memory_order_relaxed)
+        << '\n';
+    out << "hydra_reloads_total{result=\"failed\"} "
+        << reloadsFailed_.load(std::memory_order_relaxed) << '\n';
+
+    out << "# HELP hydra_generations_draining Replaced generations still finishing in-flight renders.\n";
+    out << "# TYPE hydra_generations_draining gauge\n";
+    out << "hydra_generations_draining "
+        << drainingGenerations_.load(std::memory_order_relaxed) << '\n';
+
+    if (isolatePool) {
+        const auto runtimes = isolatePool->runtimeStats();
+        const auto emitRuntimeGauge = [&](const char *name, const char *helpText, auto value) {
+            out << "# HELP " << name << " " << helpText << '\n';
+            out << "# TYPE " << name << " gauge\n";
+            for (const auto &runtime : runtimes) {
+                out << name << "{runtime=\"" << runtime.slot << "\"} " << value(runtime) << '\n';
+            }
+        };
+        using RuntimeStats = V8IsolatePool::RuntimeStats;
+        emitRuntimeGauge("hydra_runtime_heap_used_bytes",
+                         "V8 heap in use per runtime, sampled after each render.",
+                         [](const RuntimeStats &runtime) { return runtime.heap.usedBytes; });
+        emitRuntimeGauge("hydra_runtime_heap_total_bytes",
+                         "V8 heap reserved per runtime.",
+                         [](const RuntimeStats &runtime) { return runtime.heap.totalBytes; });
+        emitRuntimeGauge("hydra_runtime_heap_limit_bytes",
+                         "V8 heap size limit per runtime.",
+                         [](const RuntimeStats &runtime) { return runtime.heap.limitBytes; });
+        emitRuntimeGauge("hydra_runtime_external_bytes",
+                         "External memory (ArrayBuffers, external strings) per runtime.",
+                         [](const RuntimeStats &runtime) { return runtime.heap.externalBytes; });
+        emitRuntimeGauge("hydra_runtime_renders",
+                         "Renders served by each runtime since it was built.",
+                         [](const RuntimeStats &runtime) { return runtime.renders; });
+
+        const auto scaling = isolatePool->scalingStats();
+        out << "# HELP hydra_runtime_recycles_total Runtime recycles by reason.\n";
+        out << "# TYPE hydra_runtime_recycles_total counter\n";
+        out << "hydra_runtime_recycles_total{reason=\"render_failure\"} "
+            << scaling.recycles.renderFailure << '\n';
+        out << "hydra_runtime_recycles_total{reason=\"render_count\"} "
+            << scaling.recycles.renderCount << '\n';
+        out << "hydra_runtime_recycles_total{reason=\"heap_growth\"} "
+            << scaling.recycles.heapGrowth << '\n';
+        out << "hydra_runtime_recycles_total{reason=\"heap_limit\"} "
+            << scaling.recycles.heapLimit << '\n';
+
+        out << "# HELP hydra_idle_gc_ms Full GCs run on idle runtimes between leases.\n";
+        out << "# TYPE hydra_idle_gc_ms summary\n";
+        out << "hydra_idle_gc_ms_sum " << static_cast<double>(scaling.idleGcUsTotal) / 1000.0
+            << '\n';
+        out << "hydra_idle_gc_ms_count " << scaling.idleGcRuns << '\n';
+    }
+
+    const auto renderQueueDepth = renderExecutor_ ? renderExecutor_->queueDepth() : 0;
+    const auto renderActive = renderExecutor_ ? renderExecutor_->activeCount() : 0;
+    out << "# HELP hydra_render_queue_depth SSR renders waiting for a render executor thread.\n";
+    out << "# TYPE hydra_render_queue_depth gauge\n";
+    out << "hydra_render_queue_depth " << renderQueueDepth << '\n';
+
+    out << "# HELP hydra_render_executor_active Render executor threads currently running a render.\n";
+    out << "# TYPE hydra_render_executor_active gauge\n";
+    out << "hydra_render_executor_active " << renderActive << '\n';
+
+    out << "# HELP hydra_render_executor_threads Total render executor threads.\n";
+    out << "# TYPE hydra_render_executor_threads gauge\n";
+    out << "hydra_render_executor_threads " << renderThreadCount_ << '\n';
+
+    out << "# HELP hydra_render_queue_rejected_total Renders refused with 503 because the "
+           "render queue was full.\n";
+    out << "# TYPE hydra_render_queue_rejected_total counter\n";
+    out << "hydra_render_queue_rejected_total "
+        << (renderExecutor_ ? renderExecutor_->rejectedCount() : 0) << '\n';
+
     out << "# HELP hydra_render_timeouts_total Total SSR render timeout terminations.\n";
     out << "# TYPE hydra_render_timeouts_total counter\n";
     out << "hydra_render_timeouts_total " << snapshot.renderTimeouts << '\n';
 
+    out << "# HELP hydra_render_deadlines_fired_total Render deadlines fired by the shared scheduler.\n";
+    out << "# TYPE hydra_render_deadlines_fired_total counter\n";
+    out << "hydra_render_deadlines_fired_total "
+        << RenderDeadlineScheduler::instance().firedCount() << '\n';
+
     out << "# HELP hydra_recycles_total Total runtime recycle events.\n";
     out << "# TYPE hydra_recycles_total counter\n";
     out << "hydra_recycles_total " << snapshot.runtimeRecycles << '\n';
@@ -1983,6 +4119,262 @@ std::string HydraSsrPlugin::metricsPrometheus() const {
     out << "# TYPE hydra_render_errors_total counter\n";
     out << "hydra_render_errors_total " << snapshot.renderErrors << '\n';
 
+    if (renderCache_) {
+        const auto cacheStats = renderCache_->stats();
+        out << "# HELP hydra_render_cache_lookups_total Render cache lookups by result.\n";
+        out << "# TYPE hydra_render_cache_lookups_total counter\n";
+        out << "hydra_render_cache_lookups_total{result=\"hit\"} " << cacheStats.hits << '\n';
+        out << "hydra_render_cache_lookups_total{result=\"stale\"} " << cacheStats.staleHits
+            << '\n';
+        out << "hydra_render_cache_lookups_total{result=\"coalesced\"} " << cacheStats.coalesced
+            << '\n';
+        out << "hydra_render_cache_lookups_total{result=\"miss\"} " << cacheStats.misses << '\n';
+
+        out << "# HELP hydra_render_cache_evictions_total Render cache entries evicted for space.\n";
+        out << "# TYPE hydra_render_cache_evictions_total counter\n";
+        out << "hydra_render_cache_evictions_total " << cacheStats.evictions << '\n';
+
+        out << "# HELP hydra_render_cache_refresh_failures_total Failed background refreshes.\n";
+        out << "# TYPE hydra_render_cache_refresh_failures_total counter\n";
+        out << "hydra_render_cache_refresh_failures_total " << cacheStats.refreshFailures << '\n';
+
+        out << "# HELP hydra_render_cache_entries Render cache entries.\n";
+        out << "# TYPE hydra_render_cache_entries gauge\n";
+        out << "hydra_render_cache_entries " << cacheStats.entries << '\n';
+
+        out << "# HELP hydra_render_cache_bytes Approximate render cache size in bytes.\n";
+        out << "# TYPE hydra_render_cache_bytes gauge\n";
+        out << "hydra_render_cache_bytes " << cacheStats.bytes << '\n';
+    }
+
+    if (sharedRenderCache_) {
+        const auto shared = sharedRenderCache_->stats();
+        out << "# HELP hydra_shared_cache_lookups_total Shared render cache lookups by result.\n";
+        out << "# TYPE hydra_shared_cache_lookups_total counter\n";
+        out << "hydra_shared_cache_lookups_total{result=\"hit\"} " << shared.hits << '\n';
+        out << "hydra_shared_cache_lookups_total{result=\"miss\"} " << shared.misses << '\n';
+        out << "hydra_shared_cache_lookups_total{result=\"expired\"} " << shared.expired
+            << '\n';
+        out << "hydra_shared_cache_lookups_total{result=\"timeout\"} " << shared.timeouts
+            << '\n';
+        out << "hydra_shared_cache_lookups_total{result=\"error\"} " << shared.errors << '\n';
+        out << "hydra_shared_cache_lookups_total{result=\"bypass\"} " << shared.bypassed
+            << '\n';
+
+        out << "# HELP hydra_shared_cache_writes_total Shared render cache writes by result.\n";
+        out << "# TYPE hydra_shared_cache_writes_total counter\n";
+        out << "hydra_shared_cache_writes_total{result=\"ok\"} " << shared.writes << '\n';
+        out << "hydra_shared_cache_writes_total{result=\"error\"} " << shared.writeErrors
+            << '\n';
+        out << "hydra_shared_cache_writes_total{result=\"oversized\"} " << shared.oversized
+            << '\n';
+
+        out << "# HELP hydra_shared_cache_invalidations_total Page invalidations sent, by "
+               "result.\n";
+        out << "# TYPE hydra_shared_cache_invalidations_total counter\n";
+        out << "hydra_shared_cache_invalidations_total{result=\"ok\"} " << shared.invalidations
+            << '\n';
+        out << "hydra_shared_cache_invalidations_total{result=\"error\"} "
+            << shared.invalidationFailures << '\n';
+
+        out << "# HELP hydra_shared_cache_ready Whether the shared render cache is in use.\n";
+        out << "# TYPE hydra_shared_cache_ready gauge\n";
+        out << "hydra_shared_cache_ready " << (shared.ready ? 1 : 0) << '\n';
+    }
+
+    if (normalizedConfig_.compressionEnabled) {
+        out << "# HELP hydra_compressed_responses_total SSR responses sent compressed, by "
+               "encoding and whether cached gzip blocks were spliced.\n";
+        out << "# TYPE hydra_compressed_responses_total counter\n";
+        const auto gzipSpliced = gzipSplicedResponses_.load(std::memory_order_relaxed);
+        out << "hydra_compressed_responses_total{encoding=\"gzip\",mode=\"spliced\"} "
+            << gzipSpliced << '\n';
+        out << "hydra_compressed_responses_total{encoding=\"gzip\",mode=\"compressed\"} "
+            << gzipResponses_.load(std::memory_order_relaxed) - gzipSpliced << '\n';
+        out << "hydra_compressed_responses_total{encoding=\"br\",mode=\"compressed\"} "
+            << brotliResponses_.load(std::memory_order_relaxed) << '\n';
+
+        out << "# HELP hydra_compression_bytes_total SSR body bytes before and after "
+               "compression.\n";
+        out << "# TYPE hydra_compression_bytes_total counter\n";
+        out << "hydra_compression_bytes_total{stage=\"identity\"} "
+            << compressionBytesIn_.load(std::memory_order_relaxed) << '\n';
+        out << "hydra_compression_bytes_total{stage=\"encoded\"} "
+            << compressionBytesOut_.load(std::memory_order_relaxed) << '\n';
+
+        out << "# HELP hydra_compression_failures_total Bodies sent uncompressed because the "
+               "codec failed.\n";
+        out << "# TYPE hydra_compression_failures_total counter\n";
+        out << "hydra_compression_failures_total "
+            << compressionFailures_.load(std::memory_order_relaxed) << '\n';
+    }
+
+    if (normalizedConfig_.earlyHintsEnabled) {
+        out << "# HELP hydra_preload_link_headers_total SSR documents sent with a preload Link "
+               "header, by whether it went out with a streamed head.\n";
+        out << "# TYPE hydra_preload_link_headers_total counter\n";
+        out << "hydra_preload_link_headers_total{mode=\"document\"} "
+            << linkHeaderResponses_.load(std::memory_order_relaxed) << '\n';
+        out << "hydra_preload_link_headers_total{mode=\"stream\"} "
+            << linkHeaderStreams_.load(std::memory_order_relaxed) << '\n';
+    }
+
+    if (normalizedConfig_.criticalCssEnabled) {
+        out << "# HELP hydra_critical_css_lookups_total Critical CSS lookups, by whether the page, "
+               "its class set or a fresh selection answered them.\n";
+        out << "# TYPE hydra_critical_css_lookups_total counter\n";
+        out << "hydra_critical_css_lookups_total{source=\"page\"} "
+            << criticalCssPageHits_.load(std::memory_order_relaxed) << '\n';
+        out << "hydra_critical_css_lookups_total{source=\"class_set\"} "
+            << criticalCssClassSetHits_.load(std::memory_order_relaxed) << '\n';
+        out << "hydra_critical_css_lookups_total{source=\"selected\"} "
+            << criticalCssSelections_.load(std::memory_order_relaxed) << '\n';
+        out << "# HELP hydra_critical_css_fallbacks_total Pages whose critical CSS exceeded "
+               "max_bytes and kept the blocking stylesheet.\n";
+        out << "# TYPE hydra_critical_css_fallbacks_total counter\n";
+        out << "hydra_critical_css_fallbacks_total "
+            << criticalCssFallbacks_.load(std::memory_order_relaxed) << '\n';
+    }
+
+    if (etagEnabled_) {
+        out << "# HELP hydra_etag_not_modified_total SSR requests answered with 304, by whether "
+               "the ETag came from the render cache or a render.\n";
+        out << "# TYPE hydra_etag_not_modified_total counter\n";
+        out << "hydra_etag_not_modified_total{source=\"cache\"} "
+            << etagNotModifiedCached_.load(std::memory_order_relaxed) << '\n';
+        out << "hydra_etag_not_modified_total{source=\"render\"} "
+            << etagNotModifiedRendered_.load(std::memory_order_relaxed) << '\n';
+        out << "# HELP hydra_etag_modified_total Conditional SSR requests whose ETag no longer "
+               "matched.\n";
+        out << "# TYPE hydra_etag_modified_total counter\n";
+        out << "hydra_etag_modified_total " << etagModified_.load(std::memory_order_relaxed)
+            << '\n';
+    }
+
+    out << "# HELP hydra_fragment_responses_total renderFragment() responses by body format.\n";
+    out << "# TYPE hydra_fragment_responses_total counter\n";
+    out << "hydra_fragment_responses_total{format=\"json\"} "
+        << fragmentJsonResponses_.load(std::memory_order_relaxed) << '\n';
+    out << "hydra_fragment_responses_total{format=\"html\"} "
+        << fragmentHtmlResponses_.load(std::memory_order_relaxed) << '\n';
+
+    if (prerenderer_) {
+        const auto prerenderStats = prerenderer_->stats();
+        out << "# HELP hydra_prerender_hits_total Requests served from a prerendered file.\n";
+        out << "# TYPE hydra_prerender_hits_total counter\n";
+        out << "hydra_prerender_hits_total " << prerenderStats.hits << '\n';
+
+        out << "# HELP hydra_prerender_renders_total Prerender regenerations by result.\n";
+        out << "# TYPE hydra_prerender_renders_total counter\n";
+        out << "hydra_prerender_renders_total{result=\"ok\"} " << prerenderStats.renders << '\n';
+        out << "hydra_prerender_renders_total{result=\"failed\"} " << prerenderStats.failures
+            << '\n';
+
+        out << "# HELP hydra_prerender_variants Prerendered route variants by state.\n";
+        out << "# TYPE hydra_prerender_variants gauge\n";
+        out << "hydra_prerender_variants{state=\"ready\"} " << prerenderStats.ready << '\n';
+        out << "hydra_prerender_variants{state=\"pending\"} "
+            << prerenderStats.variants - prerenderStats.ready << '\n';
+    }
+
+    if (renderEventLog_) {
+        out << "# HELP hydra_render_log_dropped_total Render log events dropped on a full ring.\n";
+        out << "# TYPE hydra_render_log_dropped_total counter\n";
+        out << "hydra_render_log_dropped_total " << renderEventLog_->droppedCount() << '\n';
+
+        out << "# HELP hydra_render_log_sampled_out_total Render log events skipped by sampling.\n";
+        out << "# TYPE hydra_render_log_sampled_out_total counter\n";
+        out << "hydra_render_log_sampled_out_total " << renderEventLog_->sampledOutCount()
+            << '\n';
+    }
+
+    if (admission_) {
+        const auto admissionStats = admission_->stats();
+        out << "# HELP hydra_admission_in_flight Admitted renders waiting for or holding a runtime.\n";
+        out << "# TYPE hydra_admission_in_flight gauge\n";
+        out << "hydra_admission_in_flight " << admissionStats.inFlight << '\n';
+
+        out << "# HELP hydra_admission_render_estimate_ms Moving average render latency used for wait estimates.\n";
+        out << "# TYPE hydra_admission_render_estimate_ms gauge\n";
+        out << "hydra_admission_render_estimate_ms "
+            << static_cast<double>(admissionStats.renderEstimateUs) / 1000.0 << '\n';
+
+        out << "# HELP hydra_admission_decisions_total Admission outcomes by request priority.\n";
+        out << "# TYPE hydra_admission_decisions_total counter\n";
+        for (std::size_t i = 0; i < kRequestPriorityCount; ++i) {
+            const auto *priority = requestPriorityName(static_cast<RequestPriority>(i));
+            const auto &counts = admissionStats.priorities[i];
+            out << "hydra_admission_decisions_total{priority=\"" << priority
+                << "\",outcome=\"admitted\"} " << counts.admitted << '\n';
+            out << "hydra_admission_decisions_total{priority=\"" << priority
+                << "\",outcome=\"shed\"} " << counts.shed << '\n';
+            out << "hydra_admission_decisions_total{priority=\"" << priority
+                << "\",outcome=\"timed_out\"} " << counts.timedOut << '\n';
+        }
+    }
+
+    if (tracingEnabled_) {
+        out << "# HELP hydra_traces_sampled_total Requests sampled for tracing.\n";
+        out << "# TYPE hydra_traces_sampled_total counter\n";
+        out << "hydra_traces_sampled_total "
+            << tracedRequestCount_.load(std::memory_order_relaxed) << '\n';
+    }
+    if (traceExporter_) {
+        out << "# HELP hydra_traces_exported_total Traces handed to the OTLP endpoint.\n";
+        out << "# TYPE hydra_traces_exported_total counter\n";
+        out << "hydra_traces_exported_total " << traceExporter_->exportedCount() << '\n';
+
+        out << "# HELP hydra_traces_dropped_total Traces dropped because the export queue was full.\n";
+        out << "# TYPE hydra_traces_dropped_total counter\n";
+        out << "hydra_traces_dropped_total " << traceExporter_->droppedCount() << '\n';
+    }
+
+    if (requestContextBuilder_ && requestContext_.localeCacheEntries > 0) {
+        const auto localeStats = requestContextBuilder_->localeCacheStats();
+        out << "# HELP hydra_locale_cache_lookups_total Accept-Language resolutions by cache result.\n";
+        out << "# TYPE hydra_locale_cache_lookups_total counter\n";
+        out << "hydra_locale_cache_lookups_total{result=\"hit\"} " << localeStats.hits << '\n';
+        out << "hydra_locale_cache_lookups_total{result=\"miss\"} " << localeStats.misses
+            << '\n';
+
+        out << "# HELP hydra_locale_cache_entries Memoized Accept-Language values.\n";
+        out << "# TYPE hydra_locale_cache_entries gauge\n";
+        out << "hydra_locale_cache_entries " << localeStats.entries << '\n';
+    }
+
+    out << "# HELP hydra_bridge_calls_total API bridge calls made by renders, memoized ones included.\n";
+    out << "# TYPE hydra_bridge_calls_total counter\n";
+    out << "hydra_bridge_calls_total{mode=\"sync\"} "
+        << bridgeSyncCalls_.load(std::memory_order_relaxed) << '\n';
+    out << "hydra_bridge_calls_total{mode=\"async\"} "
+        << bridgeAsyncCalls_.load(std::memory_order_relaxed) << '\n';
+
+    out << "# HELP hydra_bridge_memoized_total API bridge calls answered from the render's memo.\n";
+    out << "# TYPE hydra_bridge_memoized_total counter\n";
+    out << "hydra_bridge_memoized_total " << bridgeMemoizedCalls_.load(std::memory_order_relaxed)
+        << '\n';
+
+    out << "# HELP hydra_bridge_renders_total Renders that made at least one API bridge call.\n";
+    out << "# TYPE hydra_bridge_renders_total counter\n";
+    out << "hydra_bridge_renders_total " << bridgeRenders_.load(std::memory_order_relaxed)
+        << '\n';
+
+    out << "# HELP hydra_bridge_wait_ms_total Render time spent blocked on async API bridge calls.\n";
+    out << "# TYPE hydra_bridge_wait_ms_total counter\n";
+    out << "hydra_bridge_wait_ms_total "
+        << static_cast<double>(bridgeWaitUs_.load(std::memory_order_relaxed)) / 1000.0 << '\n';
+
+    if (bridgeDispatcher_) {
+        const auto dispatcherStats = bridgeDispatcher_->stats();
+        out << "# HELP hydra_bridge_batches_total Batch handler invocations for async API bridge calls.\n";
+        out << "# TYPE hydra_bridge_batches_total counter\n";
+        out << "hydra_bridge_batches_total " << dispatcherStats.batches << '\n';
+
+        out << "# HELP hydra_bridge_queue_depth Async API bridge calls waiting for a worker.\n";
+        out << "# TYPE hydra_bridge_queue_depth gauge\n";
+        out << "hydra_bridge_queue_depth " << dispatcherStats.queueDepth << '\n';
+    }
+
     out << "# HELP hydra_requests_total Total SSR requests by status.\n";
     out << "# TYPE hydra_requests_total counter\n";
     out << "hydra_requests_total{status=\"ok\"} " << snapshot.requestsOk << '\n';
@@ -2004,8 +4396,10 @@ std::string HydraSsrPlugin::metricsPrometheus() const {
 Json::Value HydraSsrPlugin::observatoryReport() const {
     const auto snapshot = metricsSnapshot();
     const auto totalRequests = snapshot.requestsOk + snapshot.requestsFail;
-    const auto poolInUse = isolatePool_ ? isolatePool_->inUseCount() : 0;
-    const auto poolSize = isolatePool_ ? isolatePool_->size() : 0;
+    const auto generation = currentGeneration();
+    const auto *isolatePool = generation ? generation->pool.get() : nullptr;
+    const auto poolInUse = isolatePool ? isolatePool->inUseCount() : 0;
+    const auto poolSize = isolatePool ? isolatePool->size() : 0;
 
     const auto avgMs = [](std::uint64_t totalUs, std::uint64_t count) {
         if (count == 0) {
@@ -2022,11 +4416,387 @@ Json::Value HydraSsrPlugin::observatoryReport() const {
     config["render_timeout_ms"] = static_cast<Json::UInt64>(renderTimeoutMs_);
     config["acquire_timeout_ms"] = static_cast<Json::UInt64>(isolateAcquireTimeoutMs_);
     config["pool_size"] = static_cast<Json::UInt64>(isolatePoolSize_);
+    config["pool_min"] = static_cast<Json::UInt64>(isolatePoolSize_);
+    config["pool_max"] = static_cast<Json::UInt64>(isolatePoolMax_);
+    config["render_threads"] = static_cast<Json::UInt64>(renderThreadCount_);
+    config["render_queue_max"] = static_cast<Json::UInt64>(normalizedConfig_.renderQueueMax);
     report["config"] = std::move(config);
 
+    Json::Value runtime(Json::objectValue);
+    Json::Value snapshotReport(Json::objectValue);
+    snapshotReport["enabled"] = normalizedConfig_.v8SnapshotEnabled;
+    snapshotReport["status"] = generation ? generation->snapshotStatus : "disabled";
+    const auto *startupSnapshot = generation ? generation->snapshot.get() : nullptr;
+    snapshotReport["key"] = startupSnapshot ? startupSnapshot->key() : std::string{};
+    snapshotReport["bytes"] =
+        static_cast<Json::UInt64>(startupSnapshot ? startupSnapshot->sizeBytes() : 0);
+    runtime["v8_snapshot"] = std::move(snapshotReport);
+
+    Json::Value hotReloadReport(Json::objectValue);
+    hotReloadReport["enabled"] = normalizedConfig_.hotReloadEnabled;
+    hotReloadReport["watch"] = normalizedConfig_.hotReloadWatch;
+    hotReloadReport["signal"] = normalizedConfig_.hotReloadSignal;
+    if (generation) {
+        hotReloadReport["generation"] = static_cast<Json::UInt64>(generation->id);
+        hotReloadReport["reason"] = generation->reason;
+        hotReloadReport["loaded_at_ms"] = static_cast<Json::Int64>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                generation->loadedAt.time_since_epoch())
+                .count());
+        hotReloadReport["build_ms"] = static_cast<Json::UInt64>(generation->buildMs);
+        hotReloadReport["css_path"] = generation->cssPath;
+        hotReloadReport["client_js_path"] = generation->clientJsPath;
+    }
+    hotReloadReport["reloads_ok"] =
+        static_cast<Json::UInt64>(reloadsOk_.load(std::memory_order_relaxed));
+    hotReloadReport["reloads_failed"] =
+        static_cast<Json::UInt64>(reloadsFailed_.load(std::memory_order_relaxed));
+    hotReloadReport["draining"] =
+        static_cast<Json::UInt64>(drainingGenerations_.load(std::memory_order_relaxed));
+    {
+        std::lock_guard<std::mutex> lock(generationMutex_);
+        hotReloadReport["last_error"] = lastReloadError_;
+    }
+    runtime["hot_reload"] = std::move(hotReloadReport);
+
+    Json::Value poolReport(Json::objectValue);
+    if (isolatePool) {
+        const auto scaling = isolatePool->scalingStats();
+        poolReport["elastic"] = scaling.maxSize > scaling.minSize;
+        poolReport["size"] = static_cast<Json::UInt64>(scaling.size);
+        poolReport["min"] = static_cast<Json::UInt64>(scaling.minSize);
+        poolReport["max"] = static_cast<Json::UInt64>(scaling.maxSize);
+        poolReport["available"] = static_cast<Json::UInt64>(scaling.available);
+        poolReport["waiters"] = static_cast<Json::UInt64>(scaling.waiters);
+        poolReport["grows"] = static_cast<Json::UInt64>(scaling.grows);
+        poolReport["grow_failures"] = static_cast<Json::UInt64>(scaling.growFailures);
+        poolReport["reaps"] = static_cast<Json::UInt64>(scaling.reaps);
+        poolReport["standby"] = static_cast<Json::UInt64>(scaling.standby);
+        poolReport["standby_target"] = static_cast<Json::UInt64>(scaling.standbyTarget);
+        poolReport["standby_swaps"] = static_cast<Json::UInt64>(scaling.standbySwaps);
+        poolReport["pending_rebuilds"] = static_cast<Json::UInt64>(scaling.pendingRebuilds);
+        poolReport["rebuilds"] = static_cast<Json::UInt64>(scaling.rebuilds);
+        poolReport["rebuild_failures"] = static_cast<Json::UInt64>(scaling.rebuildFailures);
+        poolReport["rebuild_avg_ms"] = avgMs(scaling.rebuildUsTotal, scaling.rebuilds);
+        poolReport["rebuild_max_ms"] = static_cast<double>(scaling.rebuildUsMax) / 1000.0;
+        Json::Value recycles(Json::objectValue);
+        recycles["render_failure"] = static_cast<Json::UInt64>(scaling.recycles.renderFailure);
+        recycles["render_count"] = static_cast<Json::UInt64>(scaling.recycles.renderCount);
+        recycles["heap_growth"] = static_cast<Json::UInt64>(scaling.recycles.heapGrowth);
+        recycles["heap_limit"] = static_cast<Json::UInt64>(scaling.recycles.heapLimit);
+        poolReport["recycles"] = std::move(recycles);
+        Json::Value leases(Json::objectValue);
+        leases["thread_affinity"] = normalizedConfig_.poolThreadAffinity;
+        leases["affine"] = static_cast<Json::UInt64>(scaling.leases.affine);
+        leases["stolen"] = static_cast<Json::UInt64>(scaling.leases.stolen);
+        leases["waited"] = static_cast<Json::UInt64>(scaling.leases.waited);
+        poolReport["leases"] = std::move(leases);
+        poolReport["idle_gc_runs"] = static_cast<Json::UInt64>(scaling.idleGcRuns);
+        poolReport["idle_gc_avg_ms"] = avgMs(scaling.idleGcUsTotal, scaling.idleGcRuns);
+        Json::Value warmup(Json::objectValue);
+        warmup["enabled"] = normalizedConfig_.warmupEnabled && !devModeEnabled_;
+        warmup["warm"] = scaling.warm;
+        warmup["runtimes"] = static_cast<Json::UInt64>(scaling.warmups);
+        warmup["failures"] = static_cast<Json::UInt64>(scaling.warmupFailures);
+        warmup["render_failures"] =
+            static_cast<Json::UInt64>(warmupRenderFailures_.load(std::memory_order_relaxed));
+        warmup["avg_ms"] = avgMs(scaling.warmupUsTotal, scaling.warmups);
+        warmup["max_ms"] = static_cast<double>(scaling.warmupUsMax) / 1000.0;
+        poolReport["warmup"] = std::move(warmup);
+        Json::Value runtimes(Json::arrayValue);
+        for (const auto &runtime : isolatePool->runtimeStats()) {
+            Json::Value entry(Json::objectValue);
+            entry["slot"] = static_cast<Json::UInt64>(runtime.slot);
+            entry["in_use"] = runtime.inUse;
+            entry["renders"] = static_cast<Json::UInt64>(runtime.renders);
+            entry["heap_used_bytes"] = static_cast<Json::UInt64>(runtime.heap.usedBytes);
+            entry["heap_total_bytes"] = static_cast<Json::UInt64>(runtime.heap.totalBytes);
+            entry["heap_limit_bytes"] = static_cast<Json::UInt64>(runtime.heap.limitBytes);
+            entry["external_bytes"] = static_cast<Json::UInt64>(runtime.heap.externalBytes);
+            entry["malloced_bytes"] = static_cast<Json::UInt64>(runtime.heap.mallocedBytes);
+            runtimes.append(std::move(entry));
+        }
+        poolReport["runtimes"] = std::move(runtimes);
+        Json::Value decisions(Json::arrayValue);
+        for (const auto &event : scaling.recentEvents) {
+            Json::Value decision(Json::objectValue);
+            decision["at_ms"] = static_cast<Json::Int64>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    event.at.time_since_epoch())
+                    .count());
+            decision["action"] = event.action;
+            decision["reason"] = event.reason;
+            decision["size_after"] = static_cast<Json::UInt64>(event.sizeAfter);
+            decisions.append(std::move(decision));
+        }
+        poolReport["recent_decisions"] = std::move(decisions);
+    }
+    runtime["pool"] = std::move(poolReport);
+
+    Json::Value codeCacheReport(Json::objectValue);
+    codeCacheReport["enabled"] = normalizedConfig_.v8CodeCacheEnabled;
+    codeCacheReport["persist"] = normalizedConfig_.v8CodeCachePersist;
+    if (v8CodeCache_) {
+        const auto codeCacheStats = v8CodeCache_->stats();
+        codeCacheReport["status"] = codeCacheStats.status;
+        codeCacheReport["origin"] = codeCacheStats.origin;
+        codeCacheReport["key"] = codeCacheStats.key;
+        codeCacheReport["bytes"] = static_cast<Json::UInt64>(codeCacheStats.bytes);
+        codeCacheReport["produced"] = static_cast<Json::UInt64>(codeCacheStats.produced);
+        codeCacheReport["accepted"] = static_cast<Json::UInt64>(codeCacheStats.accepted);
+        codeCacheReport["rejected"] = static_cast<Json::UInt64>(codeCacheStats.rejected);
+    } else {
+        codeCacheReport["status"] = "disabled";
+    }
+    runtime["v8_code_cache"] = std::move(codeCacheReport);
+
+    Json::Value renderCacheReport(Json::objectValue);
+    renderCacheReport["enabled"] = renderCache_ != nullptr;
+    if (renderCache_) {
+        const auto cacheStats = renderCache_->stats();
+        renderCacheReport["hits"] = static_cast<Json::UInt64>(cacheStats.hits);
+        renderCacheReport["stale_hits"] = static_cast<Json::UInt64>(cacheStats.staleHits);
+        renderCacheReport["coalesced"] = static_cast<Json::UInt64>(cacheStats.coalesced);
+        renderCacheReport["misses"] = static_cast<Json::UInt64>(cacheStats.misses);
+        renderCacheReport["evictions"] = static_cast<Json::UInt64>(cacheStats.evictions);
+        renderCacheReport["refresh_failures"] =
+            static_cast<Json::UInt64>(cacheStats.refreshFailures);
+        renderCacheReport["entries"] = static_cast<Json::UInt64>(cacheStats.entries);
+        renderCacheReport["bytes"] = static_cast<Json::UInt64>(cacheStats.bytes);
+        renderCacheReport["max_bytes"] =
+            static_cast<Json::UInt64>(normalizedConfig_.renderCacheMaxBytes);
+    }
+    if (sharedRenderCache_) {
+        const auto shared = sharedRenderCache_->stats();
+        Json::Value sharedReport(Json::objectValue);
+        sharedReport["ready"] = shared.ready;
+        sharedReport["redis_client"] = normalizedConfig_.renderCacheSharedRedisClient;
+        sharedReport["key_prefix"] = normalizedConfig_.renderCacheSharedKeyPrefix;
+        sharedReport["timeout_ms"] =
+            static_cast<Json::UInt64>(normalizedConfig_.renderCacheSharedTimeoutMs);
+        sharedReport["hits"] = static_cast<Json::UInt64>(shared.hits);
+        sharedReport["misses"] = static_cast<Json::UInt64>(shared.misses);
+        sharedReport["expired"] = static_cast<Json::UInt64>(shared.expired);
+        sharedReport["timeouts"] = static_cast<Json::UInt64>(shared.timeouts);
+        sharedReport["errors"] = static_cast<Json::UInt64>(shared.errors);
+        sharedReport["bypassed"] = static_cast<Json::UInt64>(shared.bypassed);
+        sharedReport["writes"] = static_cast<Json::UInt64>(shared.writes);
+        sharedReport["write_errors"] = static_cast<Json::UInt64>(shared.writeErrors);
+        sharedReport["oversized"] = static_cast<Json::UInt64>(shared.oversized);
+        sharedReport["invalidations"] = static_cast<Json::UInt64>(shared.invalidations);
+        sharedReport["tags"] = static_cast<Json::UInt64>(shared.tags);
+        renderCacheReport["shared"] = std::move(sharedReport);
+    }
+    runtime["render_cache"] = std::move(renderCacheReport);
+
+    Json::Value compressionReport(Json::objectValue);
+    compressionReport["enabled"] = normalizedConfig_.compressionEnabled;
+    if (normalizedConfig_.compressionEnabled) {
+        compressionReport["gzip_level"] = normalizedConfig_.compressionGzip
+                                               ? Json::Value(static_cast<Json::UInt64>(
+                                                     normalizedConfig_.compressionGzipLevel))
+                                               : Json::Value(false);
+        compressionReport["brotli_quality"] =
+            normalizedConfig_.compressionBrotli && brotliSupported()
+                ? Json::Value(static_cast<Json::UInt64>(normalizedConfig_.compressionBrotliQuality))
+                : Json::Value(false);
+        compressionReport["min_bytes"] =
+            static_cast<Json::UInt64>(normalizedConfig_.compressionMinBytes);
+        compressionReport["gzip_responses"] =
+            static_cast<Json::UInt64>(gzipResponses_.load(std::memory_order_relaxed));
+        compressionReport["gzip_spliced_responses"] =
+            static_cast<Json::UInt64>(gzipSplicedResponses_.load(std::memory_order_relaxed));
+        compressionReport["brotli_responses"] =
+            static_cast<Json::UInt64>(brotliResponses_.load(std::memory_order_relaxed));
+        compressionReport["failures"] =
+            static_cast<Json::UInt64>(compressionFailures_.load(std::memory_order_relaxed));
+        compressionReport["bytes_identity"] =
+            static_cast<Json::UInt64>(compressionBytesIn_.load(std::memory_order_relaxed));
+        compressionReport["bytes_encoded"] =
+            static_cast<Json::UInt64>(compressionBytesOut_.load(std::memory_order_relaxed));
+    }
+    compressionReport["static_sidecars"] = normalizedConfig_.compressionStaticSidecars;
+    runtime["compression"] = std::move(compressionReport);
+
+    Json::Value earlyHintsReport(Json::objectValue);
+    earlyHintsReport["enabled"] = normalizedConfig_.earlyHintsEnabled;
+    if (normalizedConfig_.earlyHintsEnabled) {
+        earlyHintsReport["html_tags"] = normalizedConfig_.earlyHintsHtmlTags;
+        earlyHintsReport["max_links"] =
+            static_cast<Json::UInt64>(normalizedConfig_.earlyHintsMaxLinks);
+        if (const auto generation = currentGeneration()) {
+            earlyHintsReport["link_header"] = generation->linkHeader;
+            Json::Value pages(Json::arrayValue);
+            for (const auto &[page, preloads] : generation->pagePreloads) {
+                pages.append(page);
+            }
+            earlyHintsReport["pages"] = std::move(pages);
+        }
+        earlyHintsReport["document_responses"] =
+            static_cast<Json::UInt64>(linkHeaderResponses_.load(std::memory_order_relaxed));
+        earlyHintsReport["stream_responses"] =
+            static_cast<Json::UInt64>(linkHeaderStreams_.load(std::memory_order_relaxed));
+    }
+    runtime["early_hints"] = std::move(earlyHintsReport);
+
+    Json::Value criticalCssReport(Json::objectValue);
+    criticalCssReport["enabled"] = normalizedConfig_.criticalCssEnabled;
+    if (normalizedConfig_.criticalCssEnabled) {
+        criticalCssReport["max_bytes"] =
+            static_cast<Json::UInt64>(normalizedConfig_.criticalCssMaxBytes);
+        if (const auto generation = currentGeneration(); generation && generation->criticalCss) {
+            criticalCssReport["active"] = true;
+            criticalCssReport["rules"] =
+                static_cast<Json::UInt64>(generation->criticalCss->ruleCount());
+            criticalCssReport["classes"] =
+                static_cast<Json::UInt64>(generation->criticalCss->classCount());
+        } else {
+            criticalCssReport["active"] = false;
+        }
+        criticalCssReport["page_hits"] =
+            static_cast<Json::UInt64>(criticalCssPageHits_.load(std::memory_order_relaxed));
+        criticalCssReport["class_set_hits"] =
+            static_cast<Json::UInt64>(criticalCssClassSetHits_.load(std::memory_order_relaxed));
+        criticalCssReport["selections"] =
+            static_cast<Json::UInt64>(criticalCssSelections_.load(std::memory_order_relaxed));
+        criticalCssReport["fallbacks"] =
+            static_cast<Json::UInt64>(criticalCssFallbacks_.load(std::memory_order_relaxed));
+    }
+    runtime["critical_css"] = std::move(criticalCssReport);
+
+    Json::Value etagReport(Json::objectValue);
+    etagReport["enabled"] = etagEnabled_;
+    if (etagEnabled_) {
+        etagReport["not_modified_cached"] =
+            static_cast<Json::UInt64>(etagNotModifiedCached_.load(std::memory_order_relaxed));
+        etagReport["not_modified_rendered"] =
+            static_cast<Json::UInt64>(etagNotModifiedRendered_.load(std::memory_order_relaxed));
+        etagReport["modified"] =
+            static_cast<Json::UInt64>(etagModified_.load(std::memory_order_relaxed));
+    }
+    runtime["etag"] = std::move(etagReport);
+
+    Json::Value fragmentReport(Json::objectValue);
+    fragmentReport["json"] =
+        static_cast<Json::UInt64>(fragmentJsonResponses_.load(std::memory_order_relaxed));
+    fragmentReport["html"] =
+        static_cast<Json::UInt64>(fragmentHtmlResponses_.load(std::memory_order_relaxed));
+    runtime["fragments"] = std::move(fragmentReport);
+
+    Json::Value prerenderReport(Json::objectValue);
+    prerenderReport["enabled"] = prerenderer_ != nullptr;
+    if (prerenderer_) {
+        const auto prerenderStats = prerenderer_->stats();
+        prerenderReport["output_dir"] = normalizedConfig_.prerenderOutputDir;
+        prerenderReport["routes"] = static_cast<Json::UInt64>(prerenderStats.routes);
+        prerenderReport["variants"] = static_cast<Json::UInt64>(prerenderStats.variants);
+        prerenderReport["ready"] = static_cast<Json::UInt64>(prerenderStats.ready);
+        prerenderReport["renders"] = static_cast<Json::UInt64>(prerenderStats.renders);
+        prerenderReport["failures"] = static_cast<Json::UInt64>(prerenderStats.failures);
+        prerenderReport["hits"] = static_cast<Json::UInt64>(prerenderStats.hits);
+    }
+    runtime["prerender"] = std::move(prerenderReport);
+
+    Json::Value renderLogReport(Json::objectValue);
+    renderLogReport["enabled"] = renderEventLog_ != nullptr;
+    if (renderEventLog_) {
+        renderLogReport["sample_rate"] = normalizedConfig_.renderLogSampleRate;
+        renderLogReport["slow_ms"] = static_cast<Json::UInt64>(normalizedConfig_.renderLogSlowMs);
+        renderLogReport["recorded"] = static_cast<Json::UInt64>(renderEventLog_->recordedCount());
+        renderLogReport["dropped"] = static_cast<Json::UInt64>(renderEventLog_->droppedCount());
+        renderLogReport["sampled_out"] =
+            static_cast<Json::UInt64>(renderEventLog_->sampledOutCount());
+    }
+    runtime["render_log"] = std::move(renderLogReport);
+
+    Json::Value admissionReport(Json::objectValue);
+    admissionReport["enabled"] = admission_ != nullptr;
+    if (admission_) {
+        const auto admissionStats = admission_->stats();
+        const auto capacity = isolatePool ? isolatePool->size() : 0;
+        admissionReport["in_flight"] = static_cast<Json::UInt64>(admissionStats.inFlight);
+        admissionReport["render_estimate_ms"] =
+            static_cast<double>(admissionStats.renderEstimateUs) / 1000.0;
+        admissionReport["expected_wait_ms"] =
+            static_cast<double>(admission_->expectedWaitUs(capacity)) / 1000.0;
+        admissionReport["retry_after_s"] = static_cast<Json::UInt64>(admissionRetryAfterSec_);
+        Json::Value priorities(Json::objectValue);
+        for (std::size_t i = 0; i < kRequestPriorityCount; ++i) {
+            const auto priority = static_cast<RequestPriority>(i);
+            const auto &policy = admission_->policy(priority);
+            const auto &counts = admissionStats.priorities[i];
+            Json::Value entry(Json::objectValue);
+            entry["max_wait_ms"] = static_cast<Json::UInt64>(policy.maxWaitUs / 1000);
+            entry["action"] = policy.action == ShedAction::kReject ? "reject" : "shell";
+            entry["admitted"] = static_cast<Json::UInt64>(counts.admitted);
+            entry["shed"] = static_cast<Json::UInt64>(counts.shed);
+            entry["timed_out"] = static_cast<Json::UInt64>(counts.timedOut);
+            priorities[requestPriorityName(priority)] = std::move(entry);
+        }
+        admissionReport["priorities"] = std::move(priorities);
+    }
+    runtime["admission"] = std::move(admissionReport);
+
+    Json::Value tracingReport(Json::objectValue);
+    tracingReport["enabled"] = tracingEnabled_;
+    if (tracingEnabled_) {
+        tracingReport["sample_rate"] = tracingSampleRate_;
+        tracingReport["server_timing"] = tracingServerTiming_;
+        tracingReport["sampled"] =
+            static_cast<Json::UInt64>(tracedRequestCount_.load(std::memory_order_relaxed));
+        tracingReport["otlp"] = traceExporter_ != nullptr;
+        if (traceExporter_) {
+            tracingReport["exported"] = static_cast<Json::UInt64>(traceExporter_->exportedCount());
+            tracingReport["dropped"] = static_cast<Json::UInt64>(traceExporter_->droppedCount());
+        }
+    }
+    runtime["tracing"] = std::move(tracingReport);
+
+    Json::Value requestContextReport(Json::objectValue);
+    requestContextReport["lazy_details"] = requestContext_.lazyDetails;
+    requestContextReport["locale_cache_entries"] =
+        static_cast<Json::UInt64>(requestContext_.localeCacheEntries);
+    if (requestContextBuilder_ && requestContext_.localeCacheEntries > 0) {
+        const auto localeStats = requestContextBuilder_->localeCacheStats();
+        Json::Value localeCache(Json::objectValue);
+        localeCache["hits"] = static_cast<Json::UInt64>(localeStats.hits);
+        localeCache["misses"] = static_cast<Json::UInt64>(localeStats.misses);
+        localeCache["entries"] = static_cast<Json::UInt64>(localeStats.entries);
+        requestContextReport["locale_cache"] = std::move(localeCache);
+    }
+    runtime["request_context"] = std::move(requestContextReport);
+
+    Json::Value apiBridgeReport(Json::objectValue);
+    apiBridgeReport["enabled"] = apiBridgeEnabled_;
+    apiBridgeReport["async_threads"] = static_cast<Json::UInt64>(apiBridgeAsyncThreads_);
+    apiBridgeReport["max_batch"] = static_cast<Json::UInt64>(apiBridgeMaxBatch_);
+    apiBridgeReport["memoize"] = apiBridgeMemoize_;
+    Json::Value bridgeCalls(Json::objectValue);
+    bridgeCalls["sync"] =
+        static_cast<Json::UInt64>(bridgeSyncCalls_.load(std::memory_order_relaxed));
+    bridgeCalls["async"] =
+        static_cast<Json::UInt64>(bridgeAsyncCalls_.load(std::memory_order_relaxed));
+    bridgeCalls["memoized"] =
+        static_cast<Json::UInt64>(bridgeMemoizedCalls_.load(std::memory_order_relaxed));
+    apiBridgeReport["calls"] = std::move(bridgeCalls);
+    apiBridgeReport["renders"] =
+        static_cast<Json::UInt64>(bridgeRenders_.load(std::memory_order_relaxed));
+    apiBridgeReport["wait_ms_total"] =
+        static_cast<double>(bridgeWaitUs_.load(std::memory_order_relaxed)) / 1000.0;
+    if (bridgeDispatcher_) {
+        const auto dispatcherStats = bridgeDispatcher_->stats();
+        apiBridgeReport["batches"] = static_cast<Json::UInt64>(dispatcherStats.batches);
+        apiBridgeReport["queue_depth"] = static_cast<Json::UInt64>(dispatcherStats.queueDepth);
+        apiBridgeReport["active"] = static_cast<Json::UInt64>(dispatcherStats.active);
+    }
+    runtime["api_bridge"] = std::move(apiBridgeReport);
+    report["runtime"] = std::move(runtime);
+
     Json::Value metrics(Json::objectValue);
     metrics["hydra_render_timeouts_total"] =
         static_cast<Json::UInt64>(snapshot.renderTimeouts);
+    metrics["hydra_render_deadlines_fired_total"] =
+        static_cast<Json::UInt64>(RenderDeadlineScheduler::instance().firedCount());
     metrics["hydra_render_errors_total"] =
         static_cast<Json::UInt64>(snapshot.renderErrors);
     metrics["hydra_pool_timeouts_total"] =
@@ -2035,6 +4805,10 @@ Json::Value HydraSsrPlugin::observatoryReport() const {
         static_cast<Json::UInt64>(snapshot.runtimeRecycles);
     metrics["hydra_pool_in_use"] = static_cast<Json::UInt64>(poolInUse);
     metrics["hydra_pool_size"] = static_cast<Json::UInt64>(poolSize);
+    metrics["hydra_render_queue_depth"] = static_cast<Json::UInt64>(
+        renderExecutor_ ? renderExecutor_->queueDepth() : 0);
+    metrics["hydra_render_queue_rejected_total"] = static_cast<Json::UInt64>(
+        renderExecutor_ ? renderExecutor_->rejectedCount() : 0);
     metrics["hydra_requests_ok_total"] =
         static_cast<Json::UInt64>(snapshot.requestsOk);
     metrics["hydra_requests_fail_total"] =
@@ -2043,7 +4817,7 @@ Json::Value HydraSsrPlugin::observatoryReport() const {
 
     Json::Value latency(Json::objectValue);
     latency["hydra_render_latency_avg_ms"] =
-        avgMs(snapshot.totalRenderUs, snapshot.requestsOk);
+        avgMs(snapshot.totalRenderUs, snapshot.renders);
     latency["hydra_acquire_wait_avg_ms"] =
         avgMs(snapshot.totalAcquireWaitUs, totalRequests);
     latency["hydra_request_total_avg_ms"] =
@@ -2054,8 +4828,44 @@ Json::Value HydraSsrPlugin::observatoryReport() const {
         static_cast<Json::UInt64>(snapshot.totalAcquireWaitMs);
     latency["hydra_request_total_ms"] =
         static_cast<Json::UInt64>(snapshot.totalRequestMs);
+    // {"p50": ms, "p99": ms, ...} for the configured quantiles.
+    const auto quantileReport = [this](const LatencyHistogram::Snapshot &histogram) {
+        Json::Value out(Json::objectValue);
+        for (const auto quantile : latencyQuantiles_) {
+            std::ostringstream key;
+            key << 'p' << quantile * 100.0;
+            out[key.str()] = histogram.quantileUs(quantile) / 1000.0;
+        }
+        return out;
+    };
+    Json::Value quantiles(Json::objectValue);
+    quantiles["acquire_wait_ms"] = quantileReport(acquireWaitHistogram_.snapshot());
+    quantiles["render_ms"] = quantileReport(renderLatencyHistogram_.snapshot());
+    quantiles["request_ms"] = quantileReport(requestLatencyHistogram_.snapshot());
+    quantiles["bridge_call_ms"] = quantileReport(bridgeCallHistogram_.snapshot());
+    latency["quantiles"] = std::move(quantiles);
     report["latency"] = std::move(latency);
 
+    Json::Value routesReport(Json::objectValue);
+    routesReport["enabled"] = routeLatency_ != nullptr;
+    if (routeLatency_) {
+        routesReport["max_routes"] = static_cast<Json::UInt64>(routeLatency_->maxRoutes());
+        Json::Value entries(Json::arrayValue);
+        for (const auto *route : routeLatency_->routes()) {
+            const auto render = route->render.snapshot();
+            const auto request = route->request.snapshot();
+            Json::Value entry(Json::objectValue);
+            entry["route"] = route->name;
+            entry["renders"] = static_cast<Json::UInt64>(render.count);
+            entry["requests"] = static_cast<Json::UInt64>(request.count);
+            entry["render_ms"] = quantileReport(render);
+            entry["request_ms"] = quantileReport(request);
+            entries.append(std::move(entry));
+        }
+        routesReport["entries"] = std::move(entries);
+    }
+    report["routes"] = std::move(routesReport);
+
     Json::Value recommendations(Json::arrayValue);
     const auto addRecommendation = [&recommendations](const char *level,
                                                       const char *metric,
@@ -2095,7 +4905,7 @@ Json::Value HydraSsrPlugin::observatoryReport() const {
             "warning",
             "hydra_pool_timeouts_total",
             "Requests timed out while waiting for a V8 runtime.",
-            "Increase pool_size if CPU and memory allow, or reduce SSR latency so runtimes return to the pool faster.");
+            "Increase pool_size (or pool.max for an elastic pool) if CPU and memory allow, or reduce SSR latency so runtimes return to the pool faster.");
     }
     if (poolSize > 0 && poolInUse >= poolSize) {
         addRecommendation(
@@ -2104,7 +4914,15 @@ Json::Value HydraSsrPlugin::observatoryReport() const {
             "All V8 runtimes are currently leased.",
             "Watch hydra_acquire_wait_ms and consider increasing pool_size if this persists under normal traffic.");
     }
-    const auto renderAvgMs = avgMs(snapshot.totalRenderUs, snapshot.requestsOk);
+    if (renderExecutor_ && renderThreadCount_ > 0 &&
+        renderExecutor_->queueDepth() >= renderThreadCount_) {
+        addRecommendation(
+            "warning",
+            "hydra_render_queue_depth",
+            "SSR renders are queueing behind the render executor.",
+            "Raise render_threads together with pool_size, or reduce SSR render cost for hot routes.");
+    }
+    const auto renderAvgMs = avgMs(snapshot.totalRenderUs, snapshot.renders);
     if (renderTimeoutMs_ > 0 &&
         renderAvgMs >= static_cast<double>(renderTimeoutMs_) * 0.8) {
         addRecommendation(
@@ -0,0 +1,193 @@
+#include "hydra/LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+std::atomic<std::size_t> nextThreadOrdinal{0};
+
+std::size_t threadOrdinal() {
+    thread_local const std::size_t ordinal =
+        nextThreadOrdinal.fetch_add(1, std::memory_order_relaxed);
+    return ordinal;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram(std::size_t shards) {
+    const auto count = std::bit_ceil(std::max<std::size_t>(1, shards));
+    shardMask_ = count - 1;
+    shards_ = std::make_unique<Shard[]>(count);
+}
+
+void LatencyHistogram::record(std::uint64_t valueUs) {
+    auto &shard = shards_[threadOrdinal() & shardMask_];
+    shard.counts[bucketIndex(valueUs)].fetch_add(1, std::memory_order_relaxed);
+    shard.sumUs.fetch_add(valueUs, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot out;
+    for (std::size_t s = 0; s <= shardMask_; ++s) {
+        const auto &shard = shards_[s];
+        for (std::size_t i = 0; i < kBucketCount; ++i) {
+            out.counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+        }
+        out.sumUs += shard.sumUs.load(std::memory_order_relaxed);
+    }
+    for (const auto count : out.counts) {
+        out.count += count;
+    }
+    return out;
+}
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t valueUs) {
+    if (valueUs < kSubBuckets) {
+        return static_cast<std::size_t>(valueUs);
+    }
+    const auto exponent = static_cast<unsigned>(std::bit_width(valueUs)) - 1;
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    const auto shift = exponent - kSubBucketBits;
+    const auto subBucket = static_cast<std::size_t>(valueUs >> shift) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + subBucket;
+}
+
+std::uint64_t LatencyHistogram::bucketLowerUs(std::size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const auto shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+    const auto subBucket = static_cast<std::uint64_t>(index % kSubBuckets);
+    return (kSubBuckets + subBucket) << shift;
+}
+
+std::uint64_t LatencyHistogram::bucketUpperUs(std::size_t index) {
+    if (index < kSubBuckets) {
+        return index + 1;
+    }
+    const auto shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+    return bucketLowerUs(index) + (std::uint64_t{1} << shift);
+}
+
+double LatencyHistogram::Snapshot::quantileUs(double q) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    const auto rank = std::max(1.0, std::ceil(q * static_cast<double>(count)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        if (static_cast<double>(seen + counts[i]) >= rank) {
+            const auto lower = static_cast<double>(bucketLowerUs(i));
+            const auto width = static_cast<double>(bucketUpperUs(i) - bucketLowerUs(i));
+            const auto within = (rank - static_cast<double>(seen)) / static_cast<double>(counts[i]);
+            return lower + within * width;
+        }
+        seen += counts[i];
+    }
+    return static_cast<double>(bucketUpperUs(kBucketCount - 1));
+}
+
+std::uint64_t LatencyHistogram::Snapshot::countAtOrBelow(std::uint64_t boundUs) const {
+    const auto straddling = bucketIndex(boundUs);
+    std::uint64_t below = 0;
+    for (std::size_t i = 0; i < straddling; ++i) {
+        below += counts[i];
+    }
+    if (straddling == kBucketCount - 1) {
+        // The overflow bucket has no upper edge to interpolate against.
+        return below;
+    }
+    // Values are whole microseconds, so [lower, boundUs] holds
+    // boundUs - lower + 1 of the bucket's width.
+    const auto lower = bucketLowerUs(straddling);
+    const auto width = bucketUpperUs(straddling) - lower;
+    return below + counts[straddling] * (boundUs - lower + 1) / width;
+}
+
+RouteLatencyMetrics::Route::Route(std::string routeName, std::size_t shards)
+    : name(std::move(routeName)), render(shards), request(shards) {}
+
+RouteLatencyMetrics::RouteLatencyMetrics(std::size_t maxRoutes, std::size_t shards)
+    : maxRoutes_(maxRoutes),
+      shards_(shards),
+      overflow_(std::make_unique<Route>(std::string(kOverflowRoute), shards)) {
+    // At most half full, so probes stay short and always reach a null slot.
+    const auto tableSize = std::bit_ceil(std::max<std::size_t>(2, maxRoutes * 2));
+    tableMask_ = tableSize - 1;
+    table_ = std::make_unique<std::atomic<Route *>[]>(tableSize);
+    owned_.reserve(maxRoutes_);
+}
+
+RouteLatencyMetrics::~RouteLatencyMetrics() = default;
+
+RouteLatencyMetrics::Route &RouteLatencyMetrics::route(std::string_view name) {
+    const auto hash = std::hash<std::string_view>{}(name);
+    if (auto *found = find(name, hash)) {
+        return *found;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto *found = find(name, hash)) {
+        return *found;
+    }
+    if (owned_.size() >= maxRoutes_) {
+        overflowUsed_.store(true, std::memory_order_relaxed);
+        return *overflow_;
+    }
+    auto route = std::make_unique<Route>(std::string(name), shards_);
+    auto *raw = route.get();
+    owned_.push_back(std::move(route));
+    for (auto slot = hash & tableMask_;; slot = (slot + 1) & tableMask_) {
+        if (table_[slot].load(std::memory_order_relaxed) == nullptr) {
+            table_[slot].store(raw, std::memory_order_release);
+            break;
+        }
+    }
+    return *raw;
+}
+
+std::vector<const RouteLatencyMetrics::Route *> RouteLatencyMetrics::routes() const {
+    std::vector<const Route *> out;
+    for (std::size_t slot = 0; slot <= tableMask_; ++slot) {
+        if (const auto *route = table_[slot].load(std::memory_order_acquire)) {
+            out.push_back(route);
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Route *lhs, const Route *rhs) {
+        return lhs->name < rhs->name;
+    });
+    if (overflowUsed_.load(std::memory_order_relaxed)) {
+        out.push_back(overflow_.get());
+    }
+    return out;
+}
+
+std::size_t RouteLatencyMetrics::maxRoutes() const {
+    return maxRoutes_;
+}
+
+RouteLatencyMetrics::Route *RouteLatencyMetrics::find(std::string_view name,
+                                                      std::size_t hash) const {
+    for (auto slot = hash & tableMask_;; slot = (slot + 1) & tableMask_) {
+        auto *route = table_[slot].load(std::memory_order_acquire);
+        if (route == nullptr) {
+            return nullptr;
+        }
+        if (route->name == name) {
+            return route;
+        }
+    }
+}
+
+}  // namespace hydra
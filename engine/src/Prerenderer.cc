@@ -0,0 +1,265 @@
+#include "hydra/Prerenderer.h"
+
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+bool isSafeTag(std::string_view value) {
+    if (value.empty() || value.size() > 64) {
+        return false;
+    }
+    for (const auto ch : value) {
+        const auto byte = static_cast<unsigned char>(ch);
+        if (std::isalnum(byte) == 0 && ch != '-' && ch != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isSafeRoutePath(std::string_view path) {
+    if (path.empty() || path.front() != '/') {
+        return false;
+    }
+    return path.find("..") == std::string_view::npos &&
+           path.find("//") == std::string_view::npos &&
+           path.find_first_of("\\?#%") == std::string_view::npos;
+}
+
+}  // namespace
+
+Prerenderer::Prerenderer(Options options, RenderFn render)
+    : options_(std::move(options)), render_(std::move(render)) {
+    if (options_.tickInterval.count() <= 0) {
+        options_.tickInterval = std::chrono::milliseconds(1000);
+    }
+    while (!options_.urlPrefix.empty() && options_.urlPrefix.back() == '/') {
+        options_.urlPrefix.pop_back();
+    }
+    const auto now = Clock::now();
+    for (const auto &route : options_.routes) {
+        if (!isSafeRoutePath(route.path)) {
+            throw std::runtime_error("Prerenderer route path is not file-safe: " + route.path);
+        }
+        // "/" and "/about/" both map onto a directory index.
+        auto relative = route.path.substr(1);
+        if (!relative.empty() && relative.back() != '/') {
+            relative += '/';
+        }
+        RouteState state;
+        state.revalidate = route.revalidate;
+        for (const auto &locale : route.locales) {
+            for (const auto &theme : route.themes) {
+                if (!isSafeTag(locale) || !isSafeTag(theme)) {
+                    throw std::runtime_error("Prerenderer variant tag is not file-safe: " +
+                                             locale + "/" + theme);
+                }
+                VariantState variant;
+                variant.variant = {route.path, locale, theme};
+                const auto variantPath = locale + "/" + theme + "/" + relative + "index.html";
+                variant.file = options_.outputRoot / variantPath;
+                variant.urlPath = options_.urlPrefix + "/" + variantPath;
+                variant.due = now;
+                state.variants.push_back(std::move(variant));
+            }
+        }
+        routes_[route.path] = std::move(state);
+    }
+}
+
+Prerenderer::~Prerenderer() {
+    stop();
+}
+
+void Prerenderer::start() {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    if (thread_.joinable() || stopping_) {
+        return;
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+void Prerenderer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wakeCv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool Prerenderer::covers(std::string_view path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return routes_.find(std::string(path)) != routes_.end();
+}
+
+std::optional<std::string> Prerenderer::lookup(std::string_view path,
+                                               std::string_view locale,
+                                               std::string_view theme) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto route = routes_.find(std::string(path));
+    if (route == routes_.end()) {
+        return std::nullopt;
+    }
+    for (const auto &variant : route->second.variants) {
+        if (variant.ready && variant.variant.locale == locale && variant.variant.theme == theme) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return variant.urlPath;
+        }
+    }
+    return std::nullopt;
+}
+
+std::size_t Prerenderer::invalidate(const std::vector<std::string> &paths) {
+    std::size_t marked = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto now = Clock::now();
+        const auto mark = [&](RouteState &state) {
+            for (auto &variant : state.variants) {
+                variant.due = now;
+                variant.invalidated = variant.rendering;
+                ++marked;
+            }
+        };
+        if (paths.empty()) {
+            for (auto &[path, state] : routes_) {
+                mark(state);
+            }
+        } else {
+            for (const auto &path : paths) {
+                const auto route = routes_.find(path);
+                if (route != routes_.end()) {
+                    mark(route->second);
+                }
+            }
+        }
+    }
+    if (marked > 0) {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeRequested_ = true;
+        }
+        wakeCv_.notify_all();
+    }
+    return marked;
+}
+
+std::size_t Prerenderer::regenerateDue() {
+    struct Job {
+        std::string path;
+        std::size_t index = 0;
+        Variant variant;
+        std::filesystem::path file;
+    };
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto now = Clock::now();
+        for (auto &[path, state] : routes_) {
+            for (std::size_t i = 0; i < state.variants.size(); ++i) {
+                auto &variant = state.variants[i];
+                if (variant.rendering || variant.due > now) {
+                    continue;
+                }
+                variant.rendering = true;
+                jobs.push_back({path, i, variant.variant, variant.file});
+            }
+        }
+    }
+
+    std::size_t written = 0;
+    for (const auto &job : jobs) {
+        bool ok = false;
+        try {
+            const auto html = render_(job.variant);
+            ok = html.has_value() && writeFile(job.file, *html);
+        } catch (const std::exception &) {
+            ok = false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &state = routes_[job.path];
+        auto &variant = state.variants[job.index];
+        variant.rendering = false;
+        if (ok) {
+            variant.ready = true;
+            variant.due = state.revalidate.count() > 0 ? Clock::now() + state.revalidate
+                                                       : Clock::time_point::max();
+            ++renders_;
+            ++written;
+        } else {
+            variant.due = Clock::now() + options_.retryDelay;
+            ++failures_;
+        }
+        // An invalidate() that landed mid-render may predate the data this
+        // render saw, so the variant goes again on the next pass.
+        if (variant.invalidated) {
+            variant.due = Clock::now();
+            variant.invalidated = false;
+        }
+    }
+    return written;
+}
+
+Prerenderer::Stats Prerenderer::stats() const {
+    Stats stats;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.routes = routes_.size();
+    for (const auto &[path, state] : routes_) {
+        stats.variants += state.variants.size();
+        for (const auto &variant : state.variants) {
+            stats.ready += variant.ready ? 1 : 0;
+        }
+    }
+    stats.renders = renders_;
+    stats.failures = failures_;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool Prerenderer::writeFile(const std::filesystem::path &file, const std::string &html) const {
+    std::error_code error;
+    std::filesystem::create_directories(file.parent_path(), error);
+    if (error) {
+        return false;
+    }
+    // Written beside the target and renamed over it, so the static handler
+    // never reads a partial page.
+    auto staging = file;
+    staging += ".tmp";
+    {
+        std::ofstream output(staging, std::ios::binary | std::ios::trunc);
+        output.write(html.data(), static_cast<std::streamsize>(html.size()));
+        if (!output) {
+            return false;
+        }
+    }
+    std::filesystem::rename(staging, file, error);
+    if (error) {
+        std::filesystem::remove(staging, error);
+        return false;
+    }
+    return true;
+}
+
+void Prerenderer::run() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (!stopping_) {
+        wakeRequested_ = false;
+        lock.unlock();
+        regenerateDue();
+        lock.lock();
+        wakeCv_.wait_for(
+            lock, options_.tickInterval, [this] { return stopping_ || wakeRequested_; });
+    }
+}
+
+}  // namespace hydra
@@ -0,0 +1,376 @@
+#include "hydra/PropsJson.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace hydra::props_json {
+namespace {
+
+constexpr int kMaxDepth = 512;
+
+bool isJsonWhitespace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+bool isScalarChar(char ch) {
+    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || ch == '-' || ch == '+' ||
+           ch == '.' || ch == 'E';
+}
+
+int hexValue(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    if (ch >= 'A' && ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+    return -1;
+}
+
+bool readHex4(std::string_view raw, std::size_t pos, std::uint32_t *out) {
+    if (pos + 4 > raw.size()) {
+        return false;
+    }
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const auto digit = hexValue(raw[pos + i]);
+        if (digit < 0) {
+            return false;
+        }
+        value = (value << 4) | static_cast<std::uint32_t>(digit);
+    }
+    *out = value;
+    return true;
+}
+
+void appendUtf8(std::string &out, std::uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// Decodes the body of a JSON string literal (without quotes).
+std::optional<std::string> decodeString(std::string_view raw) {
+    std::string out;
+    out.reserve(raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\') {
+            out += raw[i];
+            continue;
+        }
+        if (++i >= raw.size()) {
+            return std::nullopt;
+        }
+        switch (raw[i]) {
+            case '"':
+            case '\\':
+            case '/':
+                out += raw[i];
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'n':
+                out += '\n';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'u': {
+                std::uint32_t unit = 0;
+                if (!readHex4(raw, i + 1, &unit)) {
+                    return std::nullopt;
+                }
+                i += 4;
+                if (unit >= 0xD800 && unit <= 0xDBFF) {
+                    std::uint32_t low = 0;
+                    if (i + 2 >= raw.size() || raw[i + 1] != '\\' || raw[i + 2] != 'u' ||
+                        !readHex4(raw, i + 3, &low) || low < 0xDC00 || low > 0xDFFF) {
+                        return std::nullopt;
+                    }
+                    i += 6;
+                    unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, unit);
+                break;
+            }
+            default:
+                return std::nullopt;
+        }
+    }
+    return out;
+}
+
+class Scanner {
+  public:
+    explicit Scanner(std::string_view json) : json_(json) {}
+
+    [[nodiscard]] std::size_t position() const {
+        return pos_;
+    }
+
+    [[nodiscard]] bool atEnd() const {
+        return pos_ >= json_.size();
+    }
+
+    [[nodiscard]] bool peek(char ch) const {
+        return pos_ < json_.size() && json_[pos_] == ch;
+    }
+
+    bool consume(char ch) {
+        if (!peek(ch)) {
+            return false;
+        }
+        ++pos_;
+        return true;
+    }
+
+    void skipWhitespace() {
+        while (pos_ < json_.size() && isJsonWhitespace(json_[pos_])) {
+            ++pos_;
+        }
+    }
+
+    // Reads a string literal at the cursor; `raw` is its undecoded body.
+    bool scanString(std::string_view *raw, bool *escaped) {
+        if (!consume('"')) {
+            return false;
+        }
+        const auto start = pos_;
+        *escaped = false;
+        while (pos_ < json_.size()) {
+            const char ch = json_[pos_];
+            if (ch == '"') {
+                *raw = json_.substr(start, pos_ - start);
+                ++pos_;
+                return true;
+            }
+            if (ch == '\\') {
+                *escaped = true;
+                pos_ += 2;
+                continue;
+            }
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                return false;
+            }
+            ++pos_;
+        }
+        return false;
+    }
+
+    // Reads a string literal at the cursor and decodes it.
+    std::optional<std::string> readString() {
+        std::string_view raw;
+        bool escaped = false;
+        if (!scanString(&raw, &escaped)) {
+            return std::nullopt;
+        }
+        if (!escaped) {
+            return std::string(raw);
+        }
+        return decodeString(raw);
+    }
+
+    bool skipValue(int depth) {
+        if (depth > kMaxDepth || atEnd()) {
+            return false;
+        }
+        const char ch = json_[pos_];
+        if (ch == '"') {
+            std::string_view raw;
+            bool escaped = false;
+            return scanString(&raw, &escaped);
+        }
+        if (ch == '{') {
+            return skipContainer('{', '}', depth, true);
+        }
+        if (ch == '[') {
+            return skipContainer('[', ']', depth, false);
+        }
+        const auto start = pos_;
+        while (pos_ < json_.size() && isScalarChar(json_[pos_])) {
+            ++pos_;
+        }
+        return pos_ > start;
+    }
+
+    // Walks object members, handing each decoded key to `onMember` with the
+    // cursor on its value; `onMember` must consume the value. Stops on the
+    // closing brace without consuming it.
+    template <typename OnMember>
+    bool scanMembers(int depth, OnMember &&onMember) {
+        if (!consume('{')) {
+            return false;
+        }
+        skipWhitespace();
+        if (peek('}')) {
+            return true;
+        }
+        for (;;) {
+            std::string_view rawKey;
+            bool escaped = false;
+            if (!scanString(&rawKey, &escaped)) {
+                return false;
+            }
+            std::optional<std::string> decodedKey;
+            if (escaped) {
+                decodedKey = decodeString(rawKey);
+                if (!decodedKey) {
+                    return false;
+                }
+            }
+            skipWhitespace();
+            if (!consume(':')) {
+                return false;
+            }
+            skipWhitespace();
+            if (!onMember(decodedKey ? std::string_view(*decodedKey) : rawKey, depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (consume(',')) {
+                skipWhitespace();
+                continue;
+            }
+            return peek('}');
+        }
+    }
+
+  private:
+    bool skipContainer(char open, char close, int depth, bool isObject) {
+        if (isObject) {
+            if (!scanMembers(depth, [this](std::string_view, int memberDepth) {
+                    return skipValue(memberDepth);
+                })) {
+                return false;
+            }
+            return consume(close);
+        }
+        consume(open);
+        skipWhitespace();
+        if (consume(close)) {
+            return true;
+        }
+        for (;;) {
+            if (!skipValue(depth + 1)) {
+                return false;
+            }
+            skipWhitespace();
+            if (consume(',')) {
+                skipWhitespace();
+                continue;
+            }
+            return consume(close);
+        }
+    }
+
+    std::string_view json_;
+    std::size_t pos_ = 0;
+};
+
+}  // namespace
+
+ObjectShape scanObject(std::string_view json) {
+    Scanner scanner(json);
+    std::optional<std::string> routePageId;
+    std::optional<std::string> page;
+    bool empty = true;
+
+    scanner.skipWhitespace();
+    const bool scanned = scanner.scanMembers(0, [&](std::string_view key, int depth) {
+        empty = false;
+        if (key == "page") {
+            page.reset();
+            if (scanner.peek('"')) {
+                page = scanner.readString();
+                return page.has_value();
+            }
+            return scanner.skipValue(depth);
+        }
+        if (key == "__hydra_route") {
+            routePageId.reset();
+            if (!scanner.peek('{')) {
+                return scanner.skipValue(depth);
+            }
+            const bool routeScanned =
+                scanner.scanMembers(depth, [&](std::string_view routeKey, int routeDepth) {
+                    if (routeKey == "pageId") {
+                        routePageId.reset();
+                        if (scanner.peek('"')) {
+                            routePageId = scanner.readString();
+                            return routePageId.has_value();
+                        }
+                    }
+                    return scanner.skipValue(routeDepth);
+                });
+            return routeScanned && scanner.consume('}');
+        }
+        return scanner.skipValue(depth);
+    });
+
+    ObjectShape shape;
+    if (!scanned) {
+        return shape;
+    }
+    const auto closeOffset = scanner.position();
+    scanner.consume('}');
+    scanner.skipWhitespace();
+    if (!scanner.atEnd()) {
+        return shape;
+    }
+
+    shape.isObject = true;
+    shape.empty = empty;
+    shape.closeOffset = closeOffset;
+    if (routePageId) {
+        shape.pageId = std::move(*routePageId);
+    } else if (page) {
+        shape.pageId = std::move(*page);
+    }
+    return shape;
+}
+
+std::string appendMember(std::string_view json,
+                         const ObjectShape &shape,
+                         std::string_view key,
+                         std::string_view valueJson) {
+    if (!shape.isObject || shape.closeOffset >= json.size()) {
+        return std::string(json);
+    }
+
+    std::string out;
+    out.reserve(json.size() + key.size() + valueJson.size() + 4);
+    out.append(json.substr(0, shape.closeOffset));
+    if (!shape.empty) {
+        out += ',';
+    }
+    out += '"';
+    out.append(key);
+    out += "\":";
+    out.append(valueJson);
+    out.append(json.substr(shape.closeOffset));
+    return out;
+}
+
+}  // namespace hydra::props_json
@@ -0,0 +1,468 @@
+#include "hydra/RenderCache.h"
+
+#include "hydra/Hash.h"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+constexpr std::uint64_t kKeySeed = 0x6879647261726331ULL;    // "hydrarc1"
+constexpr std::uint64_t kCheckSeed = 0x6879647261726332ULL;  // "hydrarc2"
+// Rough per-entry bookkeeping (map node, LRU node, shared_ptr control block).
+constexpr std::size_t kEntryOverheadBytes = 256;
+constexpr std::size_t kHeaderOverheadBytes = 64;
+// "HRC" and a format version; bump the version when the layout changes so
+// nodes on different builds skip each other's entries.
+constexpr std::string_view kEncodingMagic{"HRC\x01", 4};
+
+std::uint64_t hashKeyParts(std::uint64_t seed,
+                           std::string_view routeUrl,
+                           std::string_view locale,
+                           std::string_view theme,
+                           std::string_view propsJson) {
+    auto hash = hash64(routeUrl, seed);
+    hash = combineHash(hash, hash64(locale, seed));
+    hash = combineHash(hash, hash64(theme, seed));
+    return combineHash(hash, hash64(propsJson, seed));
+}
+
+std::size_t estimateBytes(const CachedRender &result) {
+    std::size_t bytes = kEntryOverheadBytes + sizeof(CachedRender) + result.html.size() +
+                        result.title.size() + result.description.size() +
+                        result.canonicalUrl.size() + result.robots.size() +
+                        result.ogType.size() + result.imageUrl.size() +
+                        result.siteName.size() + result.twitterCard.size() + result.etag.size() +
+                        result.propsJson.size();
+    for (const auto &[name, value] : result.headers) {
+        bytes += kHeaderOverheadBytes + name.size() + value.size();
+    }
+    for (const auto &block : result.sharedGzip) {
+        bytes += sizeof(DeflateBlock) + block.data.size();
+    }
+    return bytes;
+}
+
+bool sameKey(const RenderCache::Key &lhs, const RenderCache::Key &rhs) {
+    return lhs.hash == rhs.hash && lhs.check == rhs.check;
+}
+
+char lowerAscii(char ch) {
+    return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+// Case-insensitive match against an all-lowercase `lower`.
+bool equalsLower(std::string_view text, std::string_view lower) {
+    return text.size() == lower.size() &&
+           std::equal(text.begin(), text.end(), lower.begin(), [](char lhs, char rhs) {
+               return lowerAscii(lhs) == rhs;
+           });
+}
+
+// Whether the Cache-Control value has directive `lower`, with or without an
+// argument (`private="set-cookie"` counts as private).
+bool hasDirective(std::string_view cacheControl, std::string_view lower) {
+    while (!cacheControl.empty()) {
+        const auto comma = cacheControl.find(',');
+        auto directive = cacheControl.substr(0, comma);
+        cacheControl = comma == std::string_view::npos ? std::string_view()
+                                                       : cacheControl.substr(comma + 1);
+        directive = directive.substr(0, directive.find('='));
+        while (!directive.empty() && (directive.front() == ' ' || directive.front() == '\t')) {
+            directive.remove_prefix(1);
+        }
+        while (!directive.empty() && (directive.back() == ' ' || directive.back() == '\t')) {
+            directive.remove_suffix(1);
+        }
+        if (equalsLower(directive, lower)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fixed-width little-endian integers and u32 length-prefixed strings.
+void putU32(std::string &out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFFU));
+    }
+}
+
+void putU64(std::string &out, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFFU));
+    }
+}
+
+void putString(std::string &out, std::string_view value) {
+    putU32(out, static_cast<std::uint32_t>(value.size()));
+    out.append(value);
+}
+
+class Reader {
+  public:
+    explicit Reader(std::string_view bytes) : bytes_(bytes) {}
+
+    bool u32(std::uint32_t *value) {
+        std::uint64_t wide = 0;
+        if (!fixed(4, &wide)) {
+            return false;
+        }
+        *value = static_cast<std::uint32_t>(wide);
+        return true;
+    }
+
+    bool u64(std::uint64_t *value) { return fixed(8, value); }
+
+    bool string(std::string *value) {
+        std::uint32_t size = 0;
+        if (!u32(&size) || size > bytes_.size() - offset_) {
+            return false;
+        }
+        value->assign(bytes_.substr(offset_, size));
+        offset_ += size;
+        return true;
+    }
+
+    [[nodiscard]] bool done() const { return offset_ == bytes_.size(); }
+
+  private:
+    bool fixed(std::size_t width, std::uint64_t *value) {
+        if (bytes_.size() - offset_ < width) {
+            return false;
+        }
+        std::uint64_t result = 0;
+        for (std::size_t i = 0; i < width; ++i) {
+            result |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes_[offset_ + i]))
+                      << (8 * i);
+        }
+        offset_ += width;
+        *value = result;
+        return true;
+    }
+
+    std::string_view bytes_;
+    std::size_t offset_ = 0;
+};
+
+}  // namespace
+
+RenderCache::RenderCache(std::size_t maxBytes, std::size_t shardCount) {
+    shardCount = std::max<std::size_t>(shardCount, 1);
+    shardBudgetBytes_ = std::max<std::size_t>(maxBytes / shardCount, 1);
+    shards_.reserve(shardCount);
+    for (std::size_t i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+RenderCache::Key RenderCache::makeKey(std::string_view routeUrl,
+                                      std::string_view locale,
+                                      std::string_view theme,
+                                      std::string_view propsJson,
+                                      std::uint64_t tagVersion) {
+    Key key;
+    key.hash = hashKeyParts(kKeySeed, routeUrl, locale, theme, propsJson);
+    key.check = hashKeyParts(kCheckSeed, routeUrl, locale, theme, propsJson);
+    if (tagVersion != 0) {
+        key.hash = combineHash(key.hash, tagVersion);
+        key.check = combineHash(key.check, tagVersion);
+    }
+    return key;
+}
+
+std::string RenderCache::encode(const CachedRender &value,
+                                std::uint64_t storedAtMs,
+                                bool withGzip) {
+    std::string out;
+    out.reserve(estimateBytes(value));
+    out.append(kEncodingMagic);
+    putU64(out, storedAtMs);
+    putU32(out, static_cast<std::uint32_t>(value.status));
+    for (const std::string *field :
+         {&value.html, &value.title, &value.description, &value.canonicalUrl, &value.robots,
+          &value.ogType, &value.imageUrl, &value.siteName, &value.twitterCard,
+          &value.propsJson, &value.etag}) {
+        putString(out, *field);
+    }
+    putU32(out, static_cast<std::uint32_t>(value.headers.size()));
+    for (const auto &[name, headerValue] : value.headers) {
+        putString(out, name);
+        putString(out, headerValue);
+    }
+    const auto blocks = withGzip ? value.sharedGzip.size() : 0;
+    putU32(out, static_cast<std::uint32_t>(blocks));
+    for (std::size_t i = 0; i < blocks; ++i) {
+        const auto &block = value.sharedGzip[i];
+        putU32(out, block.crc);
+        putU64(out, static_cast<std::uint64_t>(block.size));
+        putString(out, block.data);
+    }
+    return out;
+}
+
+std::shared_ptr<CachedRender> RenderCache::decode(std::string_view bytes,
+                                                  std::uint64_t *storedAtMs) {
+    if (bytes.substr(0, kEncodingMagic.size()) != kEncodingMagic) {
+        return nullptr;
+    }
+    Reader reader(bytes.substr(kEncodingMagic.size()));
+    auto value = std::make_shared<CachedRender>();
+    std::uint64_t storedAt = 0;
+    std::uint32_t status = 0;
+    if (!reader.u64(&storedAt) || !reader.u32(&status) || status < 100 || status > 599) {
+        return nullptr;
+    }
+    value->status = static_cast<int>(status);
+    for (std::string *field :
+         {&value->html, &value->title, &value->description, &value->canonicalUrl,
+          &value->robots, &value->ogType, &value->imageUrl, &value->siteName,
+          &value->twitterCard, &value->propsJson, &value->etag}) {
+        if (!reader.string(field)) {
+            return nullptr;
+        }
+    }
+    std::uint32_t headerCount = 0;
+    if (!reader.u32(&headerCount)) {
+        return nullptr;
+    }
+    for (std::uint32_t i = 0; i < headerCount; ++i) {
+        std::string name;
+        std::string headerValue;
+        if (!reader.string(&name) || !reader.string(&headerValue)) {
+            return nullptr;
+        }
+        value->headers[std::move(name)] = std::move(headerValue);
+    }
+    std::uint32_t blockCount = 0;
+    if (!reader.u32(&blockCount)) {
+        return nullptr;
+    }
+    for (std::uint32_t i = 0; i < blockCount; ++i) {
+        DeflateBlock block;
+        std::uint64_t size = 0;
+        if (!reader.u32(&block.crc) || !reader.u64(&size) || !reader.string(&block.data)) {
+            return nullptr;
+        }
+        block.size = static_cast<std::size_t>(size);
+        value->sharedGzip.push_back(std::move(block));
+    }
+    if (!reader.done()) {
+        return nullptr;
+    }
+    if (storedAtMs != nullptr) {
+        *storedAtMs = storedAt;
+    }
+    return value;
+}
+
+bool RenderCache::cacheable(const SsrRenderResult &result) {
+    if (result.status < 200 || result.status >= 500) {
+        return false;
+    }
+    for (const auto &[name, value] : result.headers) {
+        if (equalsLower(name, "set-cookie")) {
+            return false;
+        }
+        // The bundle marked the page as per-user or not to be kept at all.
+        if (equalsLower(name, "cache-control") &&
+            (hasDirective(value, "no-store") || hasDirective(value, "private"))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RenderCache::Lookup RenderCache::getOrRender(const Key &key,
+                                             const Policy &policy,
+                                             const Producer &produce,
+                                             std::uint64_t generation) {
+    const auto otherGeneration = [generation](const Value &value) {
+        return generation != 0 && value && value->generation != generation;
+    };
+    auto &shard = shardFor(key);
+    std::shared_future<Value> pending;
+    std::promise<Value> promise;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (auto it = shard.entries.find(key.hash); it != shard.entries.end()) {
+            auto &entry = it->second;
+            const auto now = Clock::now();
+            if (!sameKey(entry.key, key) || now >= entry.staleUntil ||
+                otherGeneration(entry.value)) {
+                eraseLocked(shard, it);
+            } else {
+                shard.lru.splice(shard.lru.begin(), shard.lru, entry.lruPosition);
+                Lookup lookup;
+                lookup.value = entry.value;
+                if (now < entry.freshUntil) {
+                    hits_.fetch_add(1, std::memory_order_relaxed);
+                    lookup.outcome = Outcome::kHit;
+                    return lookup;
+                }
+                staleHits_.fetch_add(1, std::memory_order_relaxed);
+                lookup.outcome = Outcome::kStale;
+                lookup.refresh = !entry.refreshing;
+                entry.refreshing = true;
+                return lookup;
+            }
+        }
+
+        if (auto it = shard.inflight.find(key.hash); it == shard.inflight.end()) {
+            pending = promise.get_future().share();
+            shard.inflight.emplace(key.hash, std::make_pair(key, pending));
+            leader = true;
+        } else if (sameKey(it->second.first, key)) {
+            pending = it->second.second;
+        }
+    }
+
+    if (!leader && !pending.valid()) {
+        // Hash collision with a different in-flight key: render uncached.
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        Lookup lookup;
+        lookup.value = produce();
+        return lookup;
+    }
+
+    if (!leader) {
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        Lookup lookup;
+        lookup.value = pending.get();
+        lookup.outcome = Outcome::kCoalesced;
+        if (!otherGeneration(lookup.value)) {
+            return lookup;
+        }
+        // Joined a render of the previous generation; redo it for ours.
+        coalesced_.fetch_sub(1, std::memory_order_relaxed);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        lookup.outcome = Outcome::kMiss;
+        lookup.value = produce();
+        store(key, policy, lookup.value);
+        return lookup;
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    Value value;
+    try {
+        value = produce();
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.inflight.erase(key.hash);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.inflight.erase(key.hash);
+        insertLocked(shard, key, policy, value);
+    }
+    promise.set_value(value);
+
+    Lookup lookup;
+    lookup.value = std::move(value);
+    lookup.outcome = Outcome::kMiss;
+    return lookup;
+}
+
+void RenderCache::store(const Key &key, const Policy &policy, Value value) {
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    insertLocked(shard, key, policy, std::move(value));
+}
+
+void RenderCache::refreshFailed(const Key &key) {
+    refreshFailures_.fetch_add(1, std::memory_order_relaxed);
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto it = shard.entries.find(key.hash);
+        it != shard.entries.end() && sameKey(it->second.key, key)) {
+        // Keep serving the stale copy; the next stale hit retries.
+        it->second.refreshing = false;
+    }
+}
+
+void RenderCache::clear() {
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->lru.clear();
+        shard->bytes = 0;
+    }
+}
+
+RenderCache::Stats RenderCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.staleHits = staleHits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.refreshFailures = refreshFailures_.load(std::memory_order_relaxed);
+    for (const auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.entries += shard->entries.size();
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+bool RenderCache::contains(const Key &key, std::uint64_t generation) {
+    auto &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto it = shard.entries.find(key.hash);
+    if (it == shard.entries.end()) {
+        return false;
+    }
+    const auto &entry = it->second;
+    return sameKey(entry.key, key) && Clock::now() < entry.staleUntil &&
+           (generation == 0 || (entry.value && entry.value->generation == generation));
+}
+
+RenderCache::Shard &RenderCache::shardFor(const Key &key) {
+    // The low bits pick the bucket inside the shard's map; use the high ones.
+    return *shards_[(key.hash >> 40) % shards_.size()];
+}
+
+void RenderCache::insertLocked(Shard &shard, const Key &key, const Policy &policy, Value value) {
+    if (auto it = shard.entries.find(key.hash); it != shard.entries.end()) {
+        eraseLocked(shard, it);
+    }
+    if (!value || policy.ttl.count() <= 0 || !cacheable(*value)) {
+        return;
+    }
+    const auto bytes = estimateBytes(*value);
+    if (bytes > shardBudgetBytes_) {
+        return;
+    }
+    while (shard.bytes + bytes > shardBudgetBytes_ && !shard.lru.empty()) {
+        eraseLocked(shard, shard.entries.find(shard.lru.back()));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const auto now = Clock::now();
+    Entry entry;
+    entry.key = key;
+    entry.bytes = bytes;
+    entry.freshUntil = now + policy.ttl - std::min(value->inheritedAge, policy.ttl);
+    entry.value = std::move(value);
+    entry.staleUntil = entry.freshUntil + policy.staleWhileRevalidate;
+    shard.lru.push_front(key.hash);
+    entry.lruPosition = shard.lru.begin();
+    shard.bytes += bytes;
+    shard.entries.emplace(key.hash, std::move(entry));
+}
+
+void RenderCache::eraseLocked(Shard &shard, std::unordered_map<std::uint64_t, Entry>::iterator it) {
+    shard.bytes -= it->second.bytes;
+    shard.lru.erase(it->second.lruPosition);
+    shard.entries.erase(it);
+}
+
+}  // namespace hydra
@@ -0,0 +1,138 @@
+#include "hydra/RenderDeadlineScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace hydra {
+namespace {
+
+constexpr std::int64_t kNoWake = std::numeric_limits<std::int64_t>::max();
+// Keeps now + timeout far away from overflow; ~1 year.
+constexpr std::uint64_t kMaxTimeoutMs = 365ULL * 24 * 60 * 60 * 1000;
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+RenderDeadlineScheduler &RenderDeadlineScheduler::instance() {
+    static RenderDeadlineScheduler scheduler;
+    return scheduler;
+}
+
+RenderDeadlineScheduler::RenderDeadlineScheduler() : nextWakeNs_(kNoWake) {
+    thread_ = std::thread([this] { run(); });
+}
+
+RenderDeadlineScheduler::~RenderDeadlineScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::shared_ptr<RenderDeadlineScheduler::Slot> RenderDeadlineScheduler::registerIsolate(
+    v8::Isolate *isolate) {
+    auto slot = std::make_shared<Slot>(isolate);
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.push_back(slot);
+    return slot;
+}
+
+void RenderDeadlineScheduler::unregisterIsolate(const std::shared_ptr<Slot> &slot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.erase(std::remove(slots_.begin(), slots_.end(), slot), slots_.end());
+}
+
+void RenderDeadlineScheduler::arm(Slot &slot, std::uint64_t timeoutMs) {
+    const auto deadline =
+        nowNs() + static_cast<std::int64_t>(std::min(timeoutMs, kMaxTimeoutMs)) * 1'000'000;
+    // Sequentially consistent with the scheduler's nextWakeNs_ store / slot
+    // scan: either it sees this deadline or we see that it needs a wake-up.
+    slot.deadlineNs_.store(deadline);
+
+    // Under steady load an earlier deadline is already pending, so this is
+    // the common lock-free path.
+    if (deadline >= nextWakeNs_.load()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cv_.notify_one();
+}
+
+bool RenderDeadlineScheduler::cancel(Slot &slot) {
+    auto current = slot.deadlineNs_.load(std::memory_order_acquire);
+    for (;;) {
+        if (current == kFiring) {
+            // TerminateExecution is in flight; wait so the caller can reliably
+            // clear the pending termination afterwards.
+            slot.deadlineNs_.wait(kFiring, std::memory_order_acquire);
+            current = slot.deadlineNs_.load(std::memory_order_acquire);
+            continue;
+        }
+        if (slot.deadlineNs_.compare_exchange_weak(
+                current, kIdle, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return current == kFired;
+        }
+    }
+}
+
+std::uint64_t RenderDeadlineScheduler::firedCount() const {
+    return firedCount_.load(std::memory_order_relaxed);
+}
+
+std::size_t RenderDeadlineScheduler::registeredCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_.size();
+}
+
+void RenderDeadlineScheduler::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        nextWakeNs_.store(kNoWake);
+
+        const auto now = nowNs();
+        std::int64_t nextWake = kNoWake;
+        for (const auto &slot : slots_) {
+            auto deadline = slot->deadlineNs_.load();
+            if (deadline <= kIdle) {
+                continue;
+            }
+            if (deadline > now) {
+                nextWake = std::min(nextWake, deadline);
+                continue;
+            }
+            // Loses to a concurrent cancel/re-arm, in which case the render
+            // finished in time and there is nothing to terminate.
+            if (!slot->deadlineNs_.compare_exchange_strong(
+                    deadline, kFiring, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                continue;
+            }
+            slot->isolate_->TerminateExecution();
+            firedCount_.fetch_add(1, std::memory_order_relaxed);
+            slot->deadlineNs_.store(kFired, std::memory_order_release);
+            slot->deadlineNs_.notify_all();
+        }
+
+        nextWakeNs_.store(nextWake);
+        if (nextWake == kNoWake) {
+            cv_.wait(lock);
+        } else {
+            cv_.wait_until(lock,
+                           std::chrono::steady_clock::time_point(
+                               std::chrono::nanoseconds(nextWake)));
+        }
+    }
+}
+
+}  // namespace hydra
@@ -0,0 +1,186 @@
+#include "hydra/RenderEventLog.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+std::atomic<std::uint64_t> nextLogId{1};
+
+std::size_t roundUpToPowerOfTwo(std::size_t value) {
+    std::size_t out = 1;
+    while (out < value) {
+        out <<= 1;
+    }
+    return out;
+}
+
+std::uint64_t nextRandom(std::uint64_t *state) {
+    // xorshift64*; quality is plenty for sampling.
+    auto x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+}  // namespace
+
+RenderEventLog::RenderEventLog(Options options, Sink sink)
+    : options_(options),
+      sink_(std::move(sink)),
+      id_(nextLogId.fetch_add(1, std::memory_order_relaxed)),
+      ringCapacity_(roundUpToPowerOfTwo(std::max<std::size_t>(options.ringCapacity, 2))) {
+    const auto rate = std::clamp(options_.sampleRate, 0.0, 1.0);
+    sampleThreshold_ =
+        rate >= 1.0 ? std::numeric_limits<std::uint64_t>::max()
+                    : static_cast<std::uint64_t>(
+                          rate * static_cast<double>(std::numeric_limits<std::uint64_t>::max()));
+    if (options_.flushInterval.count() <= 0) {
+        options_.flushInterval = std::chrono::milliseconds(50);
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+RenderEventLog::~RenderEventLog() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wakeCv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    flush();
+}
+
+bool RenderEventLog::shouldRecord(bool failed, std::uint64_t totalUs) {
+    if (failed && options_.alwaysLogFailures) {
+        return true;
+    }
+    if (options_.slowThresholdUs > 0 && totalUs >= options_.slowThresholdUs) {
+        return true;
+    }
+    if (sampleThreshold_ == std::numeric_limits<std::uint64_t>::max()) {
+        return true;
+    }
+    auto &ring = localRing();
+    if (sampleThreshold_ > 0 && nextRandom(&ring.rng) < sampleThreshold_) {
+        return true;
+    }
+    ring.sampledOut.store(ring.sampledOut.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    return false;
+}
+
+bool RenderEventLog::record(const RenderEvent &event) {
+    auto &ring = localRing();
+    const auto tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail - ring.head.load(std::memory_order_acquire) >= ring.slots.size()) {
+        ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+        return false;
+    }
+    ring.slots[tail & ring.mask] = event;
+    ring.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void RenderEventLog::flush() {
+    while (drainOnce()) {
+    }
+}
+
+std::uint64_t RenderEventLog::recordedCount() const {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    std::uint64_t total = 0;
+    for (const auto &ring : rings_) {
+        total += ring->tail.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::uint64_t RenderEventLog::droppedCount() const {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    std::uint64_t total = 0;
+    for (const auto &ring : rings_) {
+        total += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::uint64_t RenderEventLog::sampledOutCount() const {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    std::uint64_t total = 0;
+    for (const auto &ring : rings_) {
+        total += ring->sampledOut.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+RenderEventLog::Ring &RenderEventLog::localRing() {
+    // Log ids are never reused, so entries for destroyed logs simply stop
+    // matching. A thread normally talks to a single log.
+    thread_local std::vector<std::pair<std::uint64_t, Ring *>> localRings;
+    for (const auto &[logId, ring] : localRings) {
+        if (logId == id_) {
+            return *ring;
+        }
+    }
+
+    auto ring = std::make_shared<Ring>(ringCapacity_);
+    ring->rng = (id_ * 0x9E3779B97F4A7C15ULL) ^
+                static_cast<std::uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) ^
+                0xD1B54A32D192ED03ULL;
+    if (ring->rng == 0) {
+        ring->rng = 1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings_.push_back(ring);
+    }
+    localRings.emplace_back(id_, ring.get());
+    return *ring;
+}
+
+bool RenderEventLog::drainOnce() {
+    std::lock_guard<std::mutex> drainLock(drainMutex_);
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings = rings_;
+    }
+
+    bool drained = false;
+    for (const auto &ring : rings) {
+        auto head = ring->head.load(std::memory_order_relaxed);
+        const auto tail = ring->tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            drained = true;
+            if (sink_) {
+                try {
+                    sink_(ring->slots[head & ring->mask]);
+                } catch (...) {
+                    // Logging must never take the drainer down.
+                }
+            }
+            ring->head.store(head + 1, std::memory_order_release);
+        }
+    }
+    return drained;
+}
+
+void RenderEventLog::run() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (!stopping_) {
+        wakeCv_.wait_for(lock, options_.flushInterval, [this] { return stopping_; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+}  // namespace hydra
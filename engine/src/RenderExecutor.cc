@@ -0,0 +1,113 @@
+#include "hydra/RenderExecutor.h"
+
+#include <trantor/utils/Logger.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace hydra {
+
+RenderExecutor::RenderExecutor(std::size_t threadCount,
+                               std::string name,
+                               std::size_t maxQueueDepth)
+    : name_(std::move(name)), maxQueueDepth_(maxQueueDepth) {
+    const std::size_t workerCount = std::max<std::size_t>(1, threadCount);
+    workers_.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+RenderExecutor::~RenderExecutor() {
+    shutdown();
+}
+
+void RenderExecutor::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            throw std::runtime_error("RenderExecutor '" + name_ + "' is shut down");
+        }
+        if (maxQueueDepth_ > 0 && tasks_.size() >= maxQueueDepth_) {
+            rejectedCount_.fetch_add(1, std::memory_order_relaxed);
+            throw std::runtime_error("RenderExecutor '" + name_ + "' queue is full");
+        }
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void RenderExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ && workers_.empty()) {
+            return;
+        }
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    workers_.clear();
+}
+
+std::size_t RenderExecutor::threadCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return workers_.size();
+}
+
+std::size_t RenderExecutor::queueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+std::size_t RenderExecutor::maxQueueDepth() const {
+    return maxQueueDepth_;
+}
+
+std::uint64_t RenderExecutor::rejectedCount() const {
+    return rejectedCount_.load(std::memory_order_relaxed);
+}
+
+std::size_t RenderExecutor::activeCount() const {
+    return activeCount_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t RenderExecutor::completedCount() const {
+    return completedCount_.load(std::memory_order_relaxed);
+}
+
+void RenderExecutor::workerLoop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            // Queued work is drained on shutdown so every pending callback fires.
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        activeCount_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            task();
+        } catch (const std::exception &ex) {
+            LOG_ERROR << "RenderExecutor '" << name_ << "' task threw: " << ex.what();
+        } catch (...) {
+            LOG_ERROR << "RenderExecutor '" << name_ << "' task threw unknown exception";
+        }
+        activeCount_.fetch_sub(1, std::memory_order_relaxed);
+        completedCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace hydra
@@ -0,0 +1,429 @@
+#include "hydra/RenderTrace.h"
+
+#include <json/writer.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+thread_local RenderTrace *activeTrace = nullptr;
+
+template <std::size_t N>
+void fillRandomId(std::array<std::uint8_t, N> *id) {
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    do {
+        for (std::size_t i = 0; i < N; i += 8) {
+            auto bits = generator();
+            for (std::size_t j = i; j < std::min(N, i + 8); ++j) {
+                (*id)[j] = static_cast<std::uint8_t>(bits & 0xFF);
+                bits >>= 8;
+            }
+        }
+    } while (std::all_of(id->begin(), id->end(), [](std::uint8_t byte) { return byte == 0; }));
+}
+
+template <std::size_t N>
+std::string toHex(const std::array<std::uint8_t, N> &id) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(N * 2);
+    for (const auto byte : id) {
+        out.push_back(kHexDigits[byte >> 4]);
+        out.push_back(kHexDigits[byte & 0x0F]);
+    }
+    return out;
+}
+
+int hexValue(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    return -1;
+}
+
+template <std::size_t N>
+bool parseHex(std::string_view text, std::array<std::uint8_t, N> *out) {
+    if (text.size() != N * 2) {
+        return false;
+    }
+    bool nonZero = false;
+    for (std::size_t i = 0; i < N; ++i) {
+        const auto high = hexValue(text[i * 2]);
+        const auto low = hexValue(text[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        (*out)[i] = static_cast<std::uint8_t>((high << 4) | low);
+        nonZero = nonZero || (*out)[i] != 0;
+    }
+    return nonZero;
+}
+
+std::string formatMs(RenderTrace::Clock::duration duration) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    const auto ms = static_cast<double>(std::max<std::int64_t>(0, us)) / 1000.0;
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", ms);
+    return buffer;
+}
+
+std::string unixNanos(std::chrono::system_clock::time_point at) {
+    return std::to_string(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count());
+}
+
+Json::Value stringAttribute(const char *key, const std::string &value) {
+    Json::Value attribute(Json::objectValue);
+    attribute["key"] = key;
+    attribute["value"]["stringValue"] = value;
+    return attribute;
+}
+
+Json::Value intAttribute(const char *key, std::int64_t value) {
+    Json::Value attribute(Json::objectValue);
+    attribute["key"] = key;
+    // OTLP/JSON encodes 64-bit integers as strings.
+    attribute["value"]["intValue"] = std::to_string(value);
+    return attribute;
+}
+
+}  // namespace
+
+std::optional<RenderTrace::TraceContext> RenderTrace::parseTraceparent(std::string_view header) {
+    // version "-" trace-id "-" parent-id "-" flags; later versions may append
+    // fields, which are ignored.
+    if (header.size() < 55 || header[2] != '-' || header[35] != '-' || header[52] != '-' ||
+        (header.size() > 55 && header[55] != '-')) {
+        return std::nullopt;
+    }
+    const auto version = header.substr(0, 2);
+    if (version == "ff" || hexValue(version[0]) < 0 || hexValue(version[1]) < 0 ||
+        (version == "00" && header.size() != 55)) {
+        return std::nullopt;
+    }
+    TraceContext context;
+    if (!parseHex(header.substr(3, 32), &context.traceId) ||
+        !parseHex(header.substr(36, 16), &context.parentSpanId)) {
+        return std::nullopt;
+    }
+    const auto flagsHigh = hexValue(header[53]);
+    const auto flagsLow = hexValue(header[54]);
+    if (flagsHigh < 0 || flagsLow < 0) {
+        return std::nullopt;
+    }
+    context.sampled = (flagsLow & 0x01) != 0;
+    return context;
+}
+
+RenderTrace::RenderTrace(std::string requestId, const std::optional<TraceContext> &parent)
+    : requestId_(std::move(requestId)),
+      start_(Clock::now()),
+      wallStart_(std::chrono::system_clock::now()) {
+    if (parent.has_value()) {
+        traceId_ = parent->traceId;
+        parentSpanId_ = parent->parentSpanId;
+        hasParent_ = true;
+    } else {
+        fillRandomId(&traceId_);
+    }
+    fillRandomId(&rootSpanId_);
+    spans_.reserve(8);
+}
+
+void RenderTrace::addSpan(const char *name,
+                          Clock::time_point start,
+                          Clock::time_point end,
+                          std::string detail,
+                          bool error) {
+    Span span;
+    span.name = name;
+    span.detail = std::move(detail);
+    span.start = start;
+    span.end = end;
+    span.error = error;
+    fillRandomId(&span.spanId);
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_.push_back(std::move(span));
+}
+
+void RenderTrace::setRoute(std::string routeUrl, std::string pageId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    routeUrl_ = std::move(routeUrl);
+    pageId_ = std::move(pageId);
+}
+
+void RenderTrace::finish(int httpStatus, bool failed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+    end_ = Clock::now();
+    httpStatus_ = httpStatus;
+    failed_ = failed;
+}
+
+std::string RenderTrace::serverTiming() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    auto first = start_;
+    for (const auto &span : spans_) {
+        first = std::min(first, span.start);
+        out += span.name;
+        if (!span.detail.empty()) {
+            out += ";desc=\"";
+            for (const char ch : span.detail) {
+                if (ch == '"' || ch == '\\') {
+                    out.push_back('\\');
+                }
+                if (static_cast<unsigned char>(ch) >= 0x20 && ch != 0x7F) {
+                    out.push_back(ch);
+                }
+            }
+            out.push_back('"');
+        }
+        out += ";dur=" + formatMs(span.end - span.start) + ", ";
+    }
+    out += "total;dur=" + formatMs((finished_ ? end_ : Clock::now()) - first);
+    return out;
+}
+
+std::string RenderTrace::traceparent() const {
+    return "00-" + toHex(traceId_) + "-" + toHex(rootSpanId_) + "-01";
+}
+
+std::string RenderTrace::traceIdHex() const {
+    return toHex(traceId_);
+}
+
+const std::string &RenderTrace::requestId() const {
+    return requestId_;
+}
+
+void RenderTrace::appendOtlpSpans(Json::Value *spans) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto wallAt = [this](Clock::time_point at) {
+        return wallStart_ +
+               std::chrono::duration_cast<std::chrono::system_clock::duration>(at - start_);
+    };
+    const auto traceIdHex = toHex(traceId_);
+    const auto rootSpanIdHex = toHex(rootSpanId_);
+
+    // Props serialization can run before the trace is created.
+    auto rootStart = start_;
+    for (const auto &span : spans_) {
+        rootStart = std::min(rootStart, span.start);
+    }
+    Json::Value root(Json::objectValue);
+    root["traceId"] = traceIdHex;
+    root["spanId"] = rootSpanIdHex;
+    if (hasParent_) {
+        root["parentSpanId"] = toHex(parentSpanId_);
+    }
+    root["name"] = "hydra.request";
+    // SPAN_KIND_SERVER
+    root["kind"] = 2;
+    root["startTimeUnixNano"] = unixNanos(wallAt(rootStart));
+    root["endTimeUnixNano"] = unixNanos(wallAt(finished_ ? end_ : Clock::now()));
+    Json::Value rootAttributes(Json::arrayValue);
+    rootAttributes.append(stringAttribute("hydra.request_id", requestId_));
+    if (!routeUrl_.empty()) {
+        rootAttributes.append(stringAttribute("url.path", routeUrl_));
+    }
+    if (!pageId_.empty()) {
+        rootAttributes.append(stringAttribute("hydra.page_id", pageId_));
+    }
+    if (httpStatus_ > 0) {
+        rootAttributes.append(intAttribute("http.response.status_code", httpStatus_));
+    }
+    root["attributes"] = std::move(rootAttributes);
+    // STATUS_CODE_ERROR / STATUS_CODE_UNSET
+    root["status"]["code"] = failed_ ? 2 : 0;
+    spans->append(std::move(root));
+
+    for (const auto &span : spans_) {
+        Json::Value child(Json::objectValue);
+        child["traceId"] = traceIdHex;
+        child["spanId"] = toHex(span.spanId);
+        child["parentSpanId"] = rootSpanIdHex;
+        child["name"] = std::string("hydra.") + span.name;
+        // SPAN_KIND_INTERNAL
+        child["kind"] = 1;
+        child["startTimeUnixNano"] = unixNanos(wallAt(span.start));
+        child["endTimeUnixNano"] = unixNanos(wallAt(span.end));
+        Json::Value attributes(Json::arrayValue);
+        attributes.append(stringAttribute("hydra.request_id", requestId_));
+        if (!span.detail.empty()) {
+            attributes.append(stringAttribute("hydra.detail", span.detail));
+        }
+        child["attributes"] = std::move(attributes);
+        child["status"]["code"] = span.error ? 2 : 0;
+        spans->append(std::move(child));
+    }
+}
+
+RenderTrace::Activation::Activation(RenderTrace *trace) : previous_(activeTrace) {
+    activeTrace = trace;
+}
+
+RenderTrace::Activation::~Activation() {
+    activeTrace = previous_;
+}
+
+RenderTrace *RenderTrace::active() {
+    return activeTrace;
+}
+
+RenderTrace::Scope::Scope(RenderTrace *trace, const char *name, std::string detail)
+    : trace_(trace), name_(name) {
+    if (trace_ != nullptr) {
+        detail_ = std::move(detail);
+        start_ = Clock::now();
+        uncaughtExceptions_ = std::uncaught_exceptions();
+    }
+}
+
+RenderTrace::Scope::~Scope() {
+    if (trace_ == nullptr) {
+        return;
+    }
+    try {
+        trace_->addSpan(name_, start_, Clock::now(), std::move(detail_),
+                        std::uncaught_exceptions() > uncaughtExceptions_);
+    } catch (...) {
+        // May run during unwinding; losing a span beats terminating.
+    }
+}
+
+void RenderTrace::Scope::end(bool error) {
+    if (trace_ != nullptr) {
+        trace_->addSpan(name_, start_, Clock::now(), std::move(detail_), error);
+        trace_ = nullptr;
+    }
+}
+
+TraceExporter::TraceExporter(Options options, Sink sink)
+    : options_(std::move(options)), sink_(std::move(sink)) {
+    options_.maxQueuedTraces = std::max<std::size_t>(1, options_.maxQueuedTraces);
+    options_.maxBatchTraces = std::max<std::size_t>(1, options_.maxBatchTraces);
+    if (options_.flushInterval.count() <= 0) {
+        options_.flushInterval = std::chrono::milliseconds(1000);
+    }
+    queue_.reserve(options_.maxBatchTraces);
+    thread_ = std::thread([this] { run(); });
+}
+
+TraceExporter::~TraceExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    flush();
+}
+
+bool TraceExporter::submit(std::shared_ptr<const RenderTrace> trace) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= options_.maxQueuedTraces) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(std::move(trace));
+        wake = queue_.size() == options_.maxBatchTraces;
+    }
+    if (wake) {
+        cv_.notify_one();
+    }
+    return true;
+}
+
+void TraceExporter::flush() {
+    while (drainOnce()) {
+    }
+}
+
+std::uint64_t TraceExporter::exportedCount() const {
+    return exported_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TraceExporter::droppedCount() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+std::string TraceExporter::encode(const std::string &serviceName,
+                                  const std::vector<std::shared_ptr<const RenderTrace>> &traces) {
+    Json::Value spans(Json::arrayValue);
+    for (const auto &trace : traces) {
+        trace->appendOtlpSpans(&spans);
+    }
+
+    Json::Value scopeSpans(Json::objectValue);
+    scopeSpans["scope"]["name"] = "hydrastack";
+    scopeSpans["spans"] = std::move(spans);
+
+    Json::Value resourceSpans(Json::objectValue);
+    resourceSpans["resource"]["attributes"].append(stringAttribute("service.name", serviceName));
+    resourceSpans["scopeSpans"].append(std::move(scopeSpans));
+
+    Json::Value request(Json::objectValue);
+    request["resourceSpans"].append(std::move(resourceSpans));
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, request);
+}
+
+void TraceExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        cv_.wait_for(lock, options_.flushInterval, [this] {
+            return stopping_ || queue_.size() >= options_.maxBatchTraces;
+        });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+bool TraceExporter::drainOnce() {
+    std::lock_guard<std::mutex> drainLock(drainMutex_);
+    std::vector<std::shared_ptr<const RenderTrace>> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) {
+            return false;
+        }
+        if (queue_.size() <= options_.maxBatchTraces) {
+            batch.swap(queue_);
+        } else {
+            const auto split =
+                queue_.begin() + static_cast<std::ptrdiff_t>(options_.maxBatchTraces);
+            batch.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(split));
+            queue_.erase(queue_.begin(), split);
+        }
+    }
+    if (sink_) {
+        try {
+            sink_(encode(options_.serviceName, batch));
+        } catch (...) {
+            // Export must never take the drainer down.
+        }
+    }
+    exported_.fetch_add(batch.size(), std::memory_order_relaxed);
+    return true;
+}
+
+}  // namespace hydra
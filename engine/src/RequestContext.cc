@@ -0,0 +1,648 @@
+#include "hydra/RequestContext.h"
+
+#include <json/writer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <string>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+std::string toLowerCopy(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::tolower(ch));
+    });
+    return value;
+}
+
+std::string trimAsciiWhitespace(std::string value) {
+    const auto isWs = [](unsigned char ch) { return std::isspace(ch) != 0; };
+
+    while (!value.empty() && isWs(static_cast<unsigned char>(value.front()))) {
+        value.erase(value.begin());
+    }
+    while (!value.empty() && isWs(static_cast<unsigned char>(value.back()))) {
+        value.pop_back();
+    }
+    return value;
+}
+
+void appendUniqueString(std::vector<std::string> *values, const std::string &value) {
+    if (values == nullptr || value.empty()) {
+        return;
+    }
+    if (std::find(values->begin(), values->end(), value) != values->end()) {
+        return;
+    }
+    values->push_back(value);
+}
+
+struct AcceptLanguageItem {
+    std::string locale;
+    double quality = 1.0;
+    std::size_t order = 0;
+};
+
+constexpr std::size_t kLocaleCacheShards = 16;
+// Longer values are resolved every time rather than cached.
+constexpr std::size_t kMaxCachedAcceptLanguageBytes = 512;
+
+thread_local const RequestContextBuilder *activeBuilder = nullptr;
+thread_local const drogon::HttpRequestPtr *activeRequest = nullptr;
+
+bool hasUppercaseAscii(std::string_view value) {
+    return std::any_of(value.begin(), value.end(), [](unsigned char ch) {
+        return ch >= 'A' && ch <= 'Z';
+    });
+}
+
+std::string toCompactJson(const Json::Value &value) {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    builder["commentStyle"] = "None";
+    return Json::writeString(builder, value);
+}
+
+}  // namespace
+
+namespace request_context {
+
+std::string firstHeaderToken(const std::string &value) {
+    if (value.empty()) {
+        return {};
+    }
+
+    const auto commaPos = value.find(',');
+    if (commaPos == std::string::npos) {
+        return trimAsciiWhitespace(value);
+    }
+
+    return trimAsciiWhitespace(value.substr(0, commaPos));
+}
+
+std::string sanitizeRequestId(std::string value) {
+    value = trimAsciiWhitespace(std::move(value));
+    if (value.empty()) {
+        return {};
+    }
+
+    std::string sanitized;
+    sanitized.reserve(value.size());
+    for (const auto ch : value) {
+        const auto uch = static_cast<unsigned char>(ch);
+        if (std::isalnum(uch) || ch == '-' || ch == '_' || ch == '.') {
+            sanitized.push_back(ch);
+        }
+    }
+
+    constexpr std::size_t kMaxRequestIdLen = 64;
+    if (sanitized.size() > kMaxRequestIdLen) {
+        sanitized.resize(kMaxRequestIdLen);
+    }
+    return sanitized;
+}
+
+std::string generateScriptNonce() {
+    static constexpr char kNonceChars[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    thread_local std::mt19937 generator(std::random_device{}());
+    std::uniform_int_distribution<std::size_t> distribution(0, sizeof(kNonceChars) - 2);
+
+    std::string nonce;
+    nonce.reserve(24);
+    for (std::size_t i = 0; i < 24; ++i) {
+        nonce.push_back(kNonceChars[distribution(generator)]);
+    }
+    return nonce;
+}
+
+std::string normalizeLocaleTag(std::string locale) {
+    locale = trimAsciiWhitespace(std::move(locale));
+    if (locale.empty()) {
+        return {};
+    }
+
+    for (auto &ch : locale) {
+        if (ch == '_') {
+            ch = '-';
+        }
+    }
+
+    locale = toLowerCopy(std::move(locale));
+
+    std::string normalized;
+    normalized.reserve(locale.size());
+    bool previousDash = false;
+    for (const auto ch : locale) {
+        const auto uch = static_cast<unsigned char>(ch);
+        if (std::isalnum(uch)) {
+            normalized.push_back(ch);
+            previousDash = false;
+            continue;
+        }
+        if (ch == '-' && !previousDash && !normalized.empty()) {
+            normalized.push_back(ch);
+            previousDash = true;
+        }
+    }
+
+    while (!normalized.empty() && normalized.back() == '-') {
+        normalized.pop_back();
+    }
+
+    return normalized;
+}
+
+std::string normalizeThemeTag(std::string theme) {
+    theme = trimAsciiWhitespace(std::move(theme));
+    if (theme.empty()) {
+        return {};
+    }
+
+    theme = toLowerCopy(std::move(theme));
+
+    std::string normalized;
+    normalized.reserve(theme.size());
+    for (const auto ch : theme) {
+        const auto uch = static_cast<unsigned char>(ch);
+        if (std::isalnum(uch) || ch == '-' || ch == '_') {
+            normalized.push_back(ch);
+        }
+    }
+
+    return normalized;
+}
+
+std::vector<std::string> localeFallbackChain(const std::string &normalizedLocale) {
+    std::vector<std::string> chain;
+    auto current = normalizedLocale;
+    while (!current.empty()) {
+        chain.push_back(current);
+        const auto separator = current.rfind('-');
+        if (separator == std::string::npos) {
+            break;
+        }
+        current = current.substr(0, separator);
+    }
+    return chain;
+}
+
+std::vector<std::string> parseAcceptLanguageCandidates(const std::string &headerValue) {
+    std::vector<AcceptLanguageItem> parsed;
+    std::size_t order = 0;
+    std::size_t start = 0;
+
+    while (start <= headerValue.size()) {
+        const auto comma = headerValue.find(',', start);
+        const auto chunk = comma == std::string::npos
+                               ? headerValue.substr(start)
+                               : headerValue.substr(start, comma - start);
+        const auto token = trimAsciiWhitespace(chunk);
+        if (!token.empty()) {
+            auto language = token;
+            auto quality = 1.0;
+            const auto semicolon = token.find(';');
+            if (semicolon != std::string::npos) {
+                language = trimAsciiWhitespace(token.substr(0, semicolon));
+                auto params = token.substr(semicolon + 1);
+                std::size_t paramStart = 0;
+                while (paramStart <= params.size()) {
+                    const auto paramEnd = params.find(';', paramStart);
+                    const auto rawParam = paramEnd == std::string::npos
+                                              ? params.substr(paramStart)
+                                              : params.substr(paramStart, paramEnd - paramStart);
+                    const auto param = trimAsciiWhitespace(rawParam);
+                    if (!param.empty()) {
+                        const auto equals = param.find('=');
+                        if (equals != std::string::npos) {
+                            const auto key = toLowerCopy(trimAsciiWhitespace(param.substr(0, equals)));
+                            const auto value = trimAsciiWhitespace(param.substr(equals + 1));
+                            if (key == "q") {
+                                try {
+                                    quality = std::stod(value);
+                                } catch (...) {
+                                    quality = 0.0;
+                                }
+                            }
+                        }
+                    }
+                    if (paramEnd == std::string::npos) {
+                        break;
+                    }
+                    paramStart = paramEnd + 1;
+                }
+            }
+
+            if (!language.empty() && language != "*" && quality > 0.0) {
+                parsed.push_back({language, quality, order++});
+            }
+        }
+
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+
+    std::stable_sort(parsed.begin(), parsed.end(), [](const auto &lhs, const auto &rhs) {
+        if (lhs.quality == rhs.quality) {
+            return lhs.order < rhs.order;
+        }
+        return lhs.quality > rhs.quality;
+    });
+
+    std::vector<std::string> orderedLocales;
+    orderedLocales.reserve(parsed.size());
+    for (const auto &item : parsed) {
+        orderedLocales.push_back(item.locale);
+    }
+    return orderedLocales;
+}
+}  // namespace request_context
+
+RequestContextBuilder::RequestContextBuilder(RequestContextOptions options)
+    : options_(std::move(options)) {
+    excludedHeaders_.insert(options_.headerBlocklist.begin(), options_.headerBlocklist.end());
+    for (const auto *name :
+         {"authorization", "proxy-authorization", "cookie", "set-cookie", "x-api-key"}) {
+        excludedHeaders_.insert(name);
+    }
+    for (const auto &name : options_.headerAllowlist) {
+        if (name.rfind("x-forwarded-", 0) != 0 && !excludedHeaders_.contains(name)) {
+            allowedHeaders_.insert(name);
+        }
+    }
+
+    if (options_.localeCacheEntries > 0) {
+        localeShardCapacity_ =
+            std::max<std::size_t>(1, options_.localeCacheEntries / kLocaleCacheShards);
+        localeShards_ = std::make_unique<LocaleShard[]>(kLocaleCacheShards);
+    }
+}
+
+const RequestContextOptions &RequestContextBuilder::options() const {
+    return options_;
+}
+
+Json::Value RequestContextBuilder::build(const drogon::HttpRequestPtr &req,
+                                         const std::string &routeUrl,
+                                         const std::string &requestId) const {
+    using request_context::firstHeaderToken;
+
+    Json::Value context(Json::objectValue);
+    context["routeUrl"] = routeUrl;
+    context["requestId"] = requestId;
+    context["locale"] = options_.defaultLocale;
+    context["theme"] = options_.defaultTheme;
+    context["themeCookieName"] = options_.themeCookieName;
+    context["themeQueryParam"] = options_.themeQueryParam;
+    {
+        Json::Value supportedThemes(Json::arrayValue);
+        for (const auto &themeName : options_.supportedThemeOrder) {
+            supportedThemes.append(themeName);
+        }
+        if (supportedThemes.empty()) {
+            supportedThemes.append(options_.defaultTheme);
+        }
+        context["themeSupportedThemes"] = std::move(supportedThemes);
+    }
+    if (!req) {
+        context["routePath"] = routeUrl;
+        context["pathWithQuery"] = routeUrl;
+        context["url"] = routeUrl;
+        if (options_.includeLocaleCandidates) {
+            Json::Value candidates(Json::arrayValue);
+            candidates.append(options_.defaultLocale);
+            context["localeCandidates"] = std::move(candidates);
+        }
+        if (options_.includeThemeCandidates) {
+            Json::Value candidates(Json::arrayValue);
+            candidates.append(options_.defaultTheme);
+            context["themeCandidates"] = std::move(candidates);
+        }
+        return context;
+    }
+
+    const std::string routePath = req->path().empty() ? "/" : req->path();
+    const auto &query = req->query();
+    std::string pathWithQuery = routePath;
+    if (!query.empty()) {
+        pathWithQuery.push_back('?');
+        pathWithQuery.append(query);
+    }
+    context["routePath"] = routePath;
+    context["pathWithQuery"] = pathWithQuery;
+
+    std::string host = firstHeaderToken(req->getHeader("x-forwarded-host"));
+    if (host.empty()) {
+        host = firstHeaderToken(req->getHeader("host"));
+    }
+
+    std::string proto = toLowerCopy(firstHeaderToken(req->getHeader("x-forwarded-proto")));
+    if (proto.empty()) {
+        proto = "http";
+    } else if (proto != "https" && proto != "http") {
+        proto = "http";
+    }
+
+    if (!host.empty()) {
+        context["url"] = proto + "://" + host + pathWithQuery;
+    } else {
+        context["url"] = pathWithQuery;
+    }
+    context["path"] = routePath;
+    context["query"] = query;
+    context["method"] = req->methodString();
+
+    // Cookie and query overrides are rare; without them the cached
+    // resolution is the answer.
+    std::vector<std::string> rawLocaleOverrides;
+    if (!options_.localeCookieName.empty()) {
+        const auto &cookieLocale = req->getCookie(options_.localeCookieName);
+        if (!cookieLocale.empty()) {
+            rawLocaleOverrides.push_back(cookieLocale);
+        }
+    }
+    if (!options_.localeQueryParam.empty()) {
+        const auto &queryLocale = req->getParameter(options_.localeQueryParam);
+        if (!queryLocale.empty()) {
+            rawLocaleOverrides.push_back(queryLocale);
+        }
+    }
+
+    const auto acceptLanguage = resolveAcceptLanguage(req->getHeader("accept-language"));
+    const std::vector<std::string> *localeCandidates = &acceptLanguage->candidates;
+    std::string resolvedLocale = acceptLanguage->locale;
+    std::vector<std::string> overriddenCandidates;
+    if (!rawLocaleOverrides.empty()) {
+        for (const auto &candidate : rawLocaleOverrides) {
+            const auto normalized = request_context::normalizeLocaleTag(candidate);
+            for (const auto &fallbackLocale : request_context::localeFallbackChain(normalized)) {
+                appendUniqueString(&overriddenCandidates, fallbackLocale);
+            }
+        }
+        for (const auto &candidate : acceptLanguage->candidates) {
+            appendUniqueString(&overriddenCandidates, candidate);
+        }
+        localeCandidates = &overriddenCandidates;
+        resolvedLocale = resolveLocale(overriddenCandidates);
+    }
+    context["locale"] = resolvedLocale;
+    if (options_.includeLocaleCandidates) {
+        Json::Value candidates(Json::arrayValue);
+        for (const auto &candidate : *localeCandidates) {
+            candidates.append(candidate);
+        }
+        context["localeCandidates"] = std::move(candidates);
+    }
+
+    std::vector<std::string> rawThemeCandidates;
+    if (!options_.themeCookieName.empty()) {
+        const auto cookieTheme = req->getCookie(options_.themeCookieName);
+        if (!cookieTheme.empty()) {
+            rawThemeCandidates.push_back(cookieTheme);
+        }
+    }
+    if (!options_.themeQueryParam.empty()) {
+        const auto queryTheme = req->getParameter(options_.themeQueryParam);
+        if (!queryTheme.empty()) {
+            rawThemeCandidates.push_back(queryTheme);
+        }
+    }
+    rawThemeCandidates.push_back(options_.defaultTheme);
+
+    std::vector<std::string> themeCandidates;
+    for (const auto &candidate : rawThemeCandidates) {
+        const auto normalized = request_context::normalizeThemeTag(candidate);
+        if (normalized.empty()) {
+            continue;
+        }
+        appendUniqueString(&themeCandidates, normalized);
+    }
+
+    std::string resolvedTheme = options_.defaultTheme.empty() ? "ocean" : options_.defaultTheme;
+    for (const auto &candidate : themeCandidates) {
+        if (options_.supportedThemes.empty() || options_.supportedThemes.contains(candidate)) {
+            resolvedTheme = candidate;
+            break;
+        }
+    }
+    if (!options_.supportedThemes.empty() && !options_.supportedThemes.contains(resolvedTheme) &&
+        !options_.supportedThemeOrder.empty()) {
+        resolvedTheme = options_.supportedThemeOrder.front();
+    }
+    context["theme"] = resolvedTheme;
+    if (options_.includeThemeCandidates) {
+        Json::Value candidates(Json::arrayValue);
+        for (const auto &candidate : themeCandidates) {
+            candidates.append(candidate);
+        }
+        context["themeCandidates"] = std::move(candidates);
+    }
+
+    if (options_.lazyDetails) {
+        Json::Value lazyFields(Json::arrayValue);
+        lazyFields.append("headers");
+        lazyFields.append("cookies");
+        if (options_.includeCookieMap) {
+            lazyFields.append("cookieMap");
+        }
+        context["lazyFields"] = std::move(lazyFields);
+        return context;
+    }
+
+    context["headers"] = headersValue(*req);
+
+    std::string cookieHeader;
+    Json::Value cookieMap(Json::objectValue);
+    collectCookies(*req,
+                   options_.includeCookies ? &cookieHeader : nullptr,
+                   options_.includeCookieMap ? &cookieMap : nullptr);
+    context["cookies"] = cookieHeader;
+    if (options_.includeCookieMap) {
+        context["cookieMap"] = std::move(cookieMap);
+    }
+    return context;
+}
+
+std::optional<std::string> RequestContextBuilder::detailJson(const drogon::HttpRequestPtr &req,
+                                                             std::string_view name) const {
+    if (name == "headers") {
+        return toCompactJson(req ? headersValue(*req) : Json::Value(Json::objectValue));
+    }
+    if (name == "cookies") {
+        std::string cookieHeader;
+        if (req && options_.includeCookies) {
+            collectCookies(*req, &cookieHeader, nullptr);
+        }
+        return toCompactJson(Json::Value(cookieHeader));
+    }
+    if (name == "cookieMap" && options_.includeCookieMap) {
+        Json::Value cookieMap(Json::objectValue);
+        if (req) {
+            collectCookies(*req, nullptr, &cookieMap);
+        }
+        return toCompactJson(cookieMap);
+    }
+    return std::nullopt;
+}
+
+RequestContextBuilder::LocaleCacheStats RequestContextBuilder::localeCacheStats() const {
+    LocaleCacheStats stats;
+    stats.hits = localeCacheHits_.load(std::memory_order_relaxed);
+    stats.misses = localeCacheMisses_.load(std::memory_order_relaxed);
+    if (localeShards_) {
+        for (std::size_t i = 0; i < kLocaleCacheShards; ++i) {
+            std::lock_guard<std::mutex> lock(localeShards_[i].mutex);
+            stats.entries += localeShards_[i].entries.size();
+        }
+    }
+    return stats;
+}
+
+RequestContextBuilder::Activation::Activation(const RequestContextBuilder *builder,
+                                              const drogon::HttpRequestPtr &req)
+    : previousBuilder_(activeBuilder), previousRequest_(activeRequest) {
+    activeBuilder = builder;
+    activeRequest = &req;
+}
+
+RequestContextBuilder::Activation::~Activation() {
+    activeBuilder = previousBuilder_;
+    activeRequest = previousRequest_;
+}
+
+std::optional<std::string> RequestContextBuilder::activeDetailJson(std::string_view name) {
+    if (activeBuilder == nullptr || activeRequest == nullptr) {
+        return std::nullopt;
+    }
+    return activeBuilder->detailJson(*activeRequest, name);
+}
+
+RequestContextBuilder::LocaleResolutionPtr RequestContextBuilder::resolveAcceptLanguage(
+    const std::string &header) const {
+    if (!localeShards_ || header.size() > kMaxCachedAcceptLanguageBytes) {
+        return computeAcceptLanguage(header);
+    }
+
+    auto &shard = localeShards_[std::hash<std::string>{}(header) % kLocaleCacheShards];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.entries.find(header);
+        if (it != shard.entries.end()) {
+            localeCacheHits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    // Resolved outside the lock; a racing miss for the same value computes
+    // the same answer and the first insert wins.
+    localeCacheMisses_.fetch_add(1, std::memory_order_relaxed);
+    auto resolution = computeAcceptLanguage(header);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.entries.size() >= localeShardCapacity_ && !shard.entries.contains(header)) {
+        // Distinct values are few in practice; when a shard does fill up,
+        // dropping an arbitrary entry keeps the bound without LRU upkeep.
+        shard.entries.erase(shard.entries.begin());
+    }
+    return shard.entries.try_emplace(header, std::move(resolution)).first->second;
+}
+
+RequestContextBuilder::LocaleResolutionPtr RequestContextBuilder::computeAcceptLanguage(
+    const std::string &header) const {
+    auto rawCandidates = request_context::parseAcceptLanguageCandidates(header);
+    rawCandidates.push_back(options_.defaultLocale);
+
+    auto resolution = std::make_shared<LocaleResolution>();
+    for (const auto &candidate : rawCandidates) {
+        const auto normalized = request_context::normalizeLocaleTag(candidate);
+        for (const auto &fallbackLocale : request_context::localeFallbackChain(normalized)) {
+            appendUniqueString(&resolution->candidates, fallbackLocale);
+        }
+    }
+    resolution->locale = resolveLocale(resolution->candidates);
+    return resolution;
+}
+
+std::string RequestContextBuilder::resolveLocale(
+    const std::vector<std::string> &candidates) const {
+    std::string resolvedLocale = options_.defaultLocale.empty() ? "en" : options_.defaultLocale;
+    for (const auto &candidate : candidates) {
+        if (options_.supportedLocales.empty() || options_.supportedLocales.contains(candidate)) {
+            resolvedLocale = candidate;
+            break;
+        }
+    }
+    if (!options_.supportedLocales.empty() &&
+        !options_.supportedLocales.contains(resolvedLocale) &&
+        !options_.supportedLocaleOrder.empty()) {
+        resolvedLocale = options_.supportedLocaleOrder.front();
+    }
+    return resolvedLocale;
+}
+
+bool RequestContextBuilder::includeHeader(std::string_view lowercaseName) const {
+    if (!options_.headerAllowlist.empty()) {
+        return allowedHeaders_.contains(lowercaseName);
+    }
+    return lowercaseName.rfind("x-forwarded-", 0) != 0 && !excludedHeaders_.contains(lowercaseName);
+}
+
+Json::Value RequestContextBuilder::headersValue(const drogon::HttpRequest &req) const {
+    Json::Value headers(Json::objectValue);
+    for (const auto &[headerName, headerValue] : req.getHeaders()) {
+        // Drogon stores header names lowercased, so the copy is rare.
+        const bool include = hasUppercaseAscii(headerName) ? includeHeader(toLowerCopy(headerName))
+                                                           : includeHeader(headerName);
+        if (include) {
+            headers[headerName] = headerValue;
+        }
+    }
+    return headers;
+}
+
+void RequestContextBuilder::collectCookies(const drogon::HttpRequest &req,
+                                           std::string *cookieHeader,
+                                           Json::Value *cookieMap) const {
+    if (cookieHeader == nullptr && cookieMap == nullptr) {
+        return;
+    }
+
+    const auto shouldIncludeCookie = [&](const std::string &cookieName) {
+        if (options_.allowedCookies.empty()) {
+            return true;
+        }
+        return options_.allowedCookies.find(toLowerCopy(cookieName)) !=
+               options_.allowedCookies.end();
+    };
+
+    bool firstCookie = true;
+    for (const auto &[cookieName, cookieValue] : req.getCookies()) {
+        if (!shouldIncludeCookie(cookieName)) {
+            continue;
+        }
+
+        if (cookieMap != nullptr) {
+            (*cookieMap)[cookieName] = cookieValue;
+        }
+
+        if (cookieHeader != nullptr) {
+            if (!firstCookie) {
+                cookieHeader->append("; ");
+            }
+            cookieHeader->append(cookieName);
+            cookieHeader->push_back('=');
+            cookieHeader->append(cookieValue);
+            firstCookie = false;
+        }
+    }
+
+    if (cookieHeader != nullptr && cookieHeader->empty() && options_.allowedCookies.empty()) {
+        *cookieHeader = req.getHeader("cookie");
+    }
+}
+
+}  // namespace hydra
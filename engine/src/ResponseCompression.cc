@@ -0,0 +1,264 @@
+#include "hydra/ResponseCompression.h"
+
+#include <zlib.h>
+
+#ifdef HYDRA_HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+namespace hydra {
+namespace {
+
+constexpr int kDeflateWindowBits = 15;
+constexpr int kGzipWindowBits = kDeflateWindowBits + 16;
+constexpr int kDeflateMemLevel = 8;
+// Final, fixed-Huffman deflate block holding only end-of-block.
+constexpr std::string_view kFinalEmptyBlock("\x03\x00", 2);
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+    return lhs.size() == rhs.size() &&
+           std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) ==
+                      std::tolower(static_cast<unsigned char>(b));
+           });
+}
+
+// q value of one Accept-Encoding member; malformed values count as 1 the way
+// most servers treat them.
+double qualityOf(std::string_view params) {
+    while (!params.empty()) {
+        const auto semicolon = params.find(';');
+        const auto param = trim(params.substr(0, semicolon));
+        params = semicolon == std::string_view::npos ? std::string_view{}
+                                                     : params.substr(semicolon + 1);
+        if (param.size() < 2 || (param[0] != 'q' && param[0] != 'Q') || param[1] != '=') {
+            continue;
+        }
+        const std::string value(trim(param.substr(2)));
+        char *end = nullptr;
+        const double q = std::strtod(value.c_str(), &end);
+        if (end == value.c_str()) {
+            return 1.0;
+        }
+        return std::clamp(q, 0.0, 1.0);
+    }
+    return 1.0;
+}
+
+void checkSize(std::size_t size) {
+    if (size > std::numeric_limits<uInt>::max()) {
+        throw std::runtime_error("Response body is too large to compress");
+    }
+}
+
+// Feeds all of `input` through `stream` with `flush` and appends the output.
+void runDeflate(z_stream &stream, std::string_view input, int flush, std::string &out) {
+    checkSize(input.size());
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    auto chunk = std::max<std::size_t>(deflateBound(&stream, stream.avail_in) + 16, 64);
+    while (true) {
+        const auto offset = out.size();
+        out.resize(offset + chunk);
+        stream.next_out = reinterpret_cast<Bytef *>(out.data() + offset);
+        stream.avail_out = static_cast<uInt>(chunk);
+        const auto status = deflate(&stream, flush);
+        out.resize(offset + chunk - stream.avail_out);
+        if (status == Z_STREAM_ERROR) {
+            throw std::runtime_error("zlib deflate failed");
+        }
+        if (flush == Z_FINISH ? status == Z_STREAM_END
+                              : stream.avail_in == 0 && stream.avail_out != 0) {
+            return;
+        }
+        chunk *= 2;
+    }
+}
+
+void appendLittleEndian32(std::string &out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xffU));
+    }
+}
+
+}  // namespace
+
+std::string_view contentEncodingToken(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::kGzip:
+            return "gzip";
+        case ContentEncoding::kBrotli:
+            return "br";
+        case ContentEncoding::kIdentity:
+            break;
+    }
+    return {};
+}
+
+bool brotliSupported() {
+#ifdef HYDRA_HAVE_BROTLI
+    return true;
+#else
+    return false;
+#endif
+}
+
+ContentEncoding negotiateContentEncoding(std::string_view acceptEncoding,
+                                         bool allowGzip,
+                                         bool allowBrotli) {
+    // -1 marks a coding the header does not mention.
+    double gzipQ = -1;
+    double brotliQ = -1;
+    double wildcardQ = -1;
+    while (!acceptEncoding.empty()) {
+        const auto comma = acceptEncoding.find(',');
+        const auto member = acceptEncoding.substr(0, comma);
+        acceptEncoding = comma == std::string_view::npos ? std::string_view{}
+                                                         : acceptEncoding.substr(comma + 1);
+        const auto semicolon = member.find(';');
+        const auto coding = trim(member.substr(0, semicolon));
+        const auto q = semicolon == std::string_view::npos ? 1.0
+                                                           : qualityOf(member.substr(semicolon + 1));
+        if (equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip")) {
+            gzipQ = std::max(gzipQ, q);
+        } else if (equalsIgnoreCase(coding, "br")) {
+            brotliQ = std::max(brotliQ, q);
+        } else if (coding == "*") {
+            wildcardQ = std::max(wildcardQ, q);
+        }
+    }
+    if (gzipQ < 0) {
+        gzipQ = wildcardQ;
+    }
+    if (brotliQ < 0) {
+        brotliQ = wildcardQ;
+    }
+    if (!allowGzip) {
+        gzipQ = 0;
+    }
+    if (!allowBrotli || !brotliSupported()) {
+        brotliQ = 0;
+    }
+
+    if (brotliQ > 0 && brotliQ >= gzipQ) {
+        return ContentEncoding::kBrotli;
+    }
+    if (gzipQ > 0) {
+        return ContentEncoding::kGzip;
+    }
+    return ContentEncoding::kIdentity;
+}
+
+std::string compressBody(std::string_view body, ContentEncoding encoding, int level) {
+    switch (encoding) {
+        case ContentEncoding::kIdentity:
+            return std::string(body);
+        case ContentEncoding::kGzip: {
+            z_stream stream{};
+            if (deflateInit2(&stream, std::clamp(level, 1, 9), Z_DEFLATED, kGzipWindowBits,
+                             kDeflateMemLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("zlib deflateInit2 failed");
+            }
+            std::string out;
+            try {
+                runDeflate(stream, body, Z_FINISH, out);
+            } catch (...) {
+                deflateEnd(&stream);
+                throw;
+            }
+            deflateEnd(&stream);
+            return out;
+        }
+        case ContentEncoding::kBrotli: {
+#ifdef HYDRA_HAVE_BROTLI
+            auto outSize = BrotliEncoderMaxCompressedSize(body.size());
+            if (outSize == 0) {
+                throw std::runtime_error("Response body is too large to compress");
+            }
+            std::string out(outSize, '\0');
+            if (BrotliEncoderCompress(std::clamp(level, BROTLI_MIN_QUALITY, BROTLI_MAX_QUALITY),
+                                      BROTLI_DEFAULT_WINDOW,
+                                      BROTLI_MODE_TEXT,
+                                      body.size(),
+                                      reinterpret_cast<const std::uint8_t *>(body.data()),
+                                      &outSize,
+                                      reinterpret_cast<std::uint8_t *>(out.data())) ==
+                BROTLI_FALSE) {
+                throw std::runtime_error("brotli compression failed");
+            }
+            out.resize(outSize);
+            return out;
+#else
+            throw std::runtime_error("brotli compression is not available in this build");
+#endif
+        }
+    }
+    return std::string(body);
+}
+
+DeflateBlock deflateBlock(std::string_view text, int level) {
+    checkSize(text.size());
+    DeflateBlock block;
+    block.size = text.size();
+    block.crc = static_cast<std::uint32_t>(
+        crc32(0L, reinterpret_cast<const Bytef *>(text.data()), static_cast<uInt>(text.size())));
+    if (text.empty()) {
+        return block;
+    }
+    z_stream stream{};
+    if (deflateInit2(&stream, std::clamp(level, 1, 9), Z_DEFLATED, -kDeflateWindowBits,
+                     kDeflateMemLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("zlib deflateInit2 failed");
+    }
+    try {
+        // A sync flush byte-aligns the output without marking it final, so
+        // the next block can start right after it.
+        runDeflate(stream, text, Z_SYNC_FLUSH, block.data);
+    } catch (...) {
+        deflateEnd(&stream);
+        throw;
+    }
+    deflateEnd(&stream);
+    return block;
+}
+
+std::string gzipFromBlocks(const std::vector<const DeflateBlock *> &blocks) {
+    std::size_t capacity = 10 + kFinalEmptyBlock.size() + 8;
+    for (const auto *block : blocks) {
+        capacity += block->data.size();
+    }
+    std::string out;
+    out.reserve(capacity);
+    // Header: magic, deflate, no flags, no mtime, no extra flags, unknown OS.
+    out.append("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    std::uint64_t size = 0;
+    for (const auto *block : blocks) {
+        out.append(block->data);
+        crc = crc32_combine(crc, block->crc, static_cast<z_off_t>(block->size));
+        size += block->size;
+    }
+    out.append(kFinalEmptyBlock);
+    appendLittleEndian32(out, static_cast<std::uint32_t>(crc));
+    appendLittleEndian32(out, static_cast<std::uint32_t>(size & 0xffffffffULL));
+    return out;
+}
+
+}  // namespace hydra
@@ -0,0 +1,358 @@
+#include "hydra/SharedRenderCache.h"
+
+#include "hydra/Hash.h"
+
+#include <drogon/drogon.h>
+#include <drogon/nosql/RedisClient.h>
+#include <trantor/net/EventLoop.h>
+
+#include <charconv>
+#include <exception>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+namespace {
+
+using drogon::nosql::RedisException;
+using drogon::nosql::RedisResult;
+using drogon::nosql::RedisResultType;
+
+// Consecutive timeouts or errors before lookups stop for kBackoff.
+constexpr std::uint32_t kFailuresBeforeBackoff = 3;
+constexpr std::chrono::milliseconds kBackoff{1000};
+
+std::uint64_t unixMillis() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                          std::chrono::system_clock::now().time_since_epoch())
+                                          .count());
+}
+
+std::int64_t steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool parseVersion(std::string_view text, std::uint64_t *version) {
+    const auto *end = text.data() + text.size();
+    const auto [ptr, ec] = std::from_chars(text.data(), end, *version);
+    return ec == std::errc() && ptr == end;
+}
+
+}  // namespace
+
+SharedRenderCache::SharedRenderCache(Options options)
+    : options_(std::move(options)),
+      tagsKey_(options_.keyPrefix + ":tags"),
+      channel_(options_.keyPrefix + ":invalidate") {}
+
+SharedRenderCache::~SharedRenderCache() = default;
+
+void SharedRenderCache::start() {
+    // Drogon asserts the name is configured; a release build hands back null.
+    auto redis = drogon::app().getRedisClient(options_.redisClient);
+    if (!redis) {
+        LOG_WARN << "HydraStack shared render cache has no Redis client named '"
+                 << options_.redisClient << "'; only the local render cache is used";
+        return;
+    }
+    std::weak_ptr<SharedRenderCache> weak = weak_from_this();
+    auto subscriber = redis->newSubscriber();
+    subscriber->subscribe(channel_, [weak](const std::string &, const std::string &message) {
+        const auto self = weak.lock();
+        const auto space = message.find(' ');
+        std::uint64_t version = 0;
+        if (!self || space == std::string::npos ||
+            !parseVersion(std::string_view(message).substr(0, space), &version)) {
+            return;
+        }
+        self->applyTagVersion(message.substr(space + 1), version);
+    });
+    {
+        std::lock_guard<std::mutex> lock(clientMutex_);
+        client_ = redis;
+        subscriber_ = std::move(subscriber);
+        if (options_.tagRefreshInterval.count() > 0) {
+            refreshTimer_ = drogon::app().getLoop()->runEvery(
+                std::chrono::duration<double>(options_.tagRefreshInterval).count(), [weak]() {
+                    if (const auto self = weak.lock()) {
+                        self->refreshTags();
+                    }
+                });
+            timerRunning_ = true;
+        }
+    }
+    refreshTags();
+}
+
+void SharedRenderCache::stop() {
+    std::lock_guard<std::mutex> lock(clientMutex_);
+    if (timerRunning_) {
+        drogon::app().getLoop()->invalidateTimer(refreshTimer_);
+        timerRunning_ = false;
+    }
+    if (subscriber_) {
+        subscriber_->unsubscribe(channel_);
+        subscriber_.reset();
+    }
+    client_.reset();
+    tagsLoaded_.store(false, std::memory_order_release);
+}
+
+bool SharedRenderCache::ready() const {
+    return tagsLoaded_.load(std::memory_order_acquire) && client() != nullptr;
+}
+
+std::uint64_t SharedRenderCache::tagVersion(std::string_view tag) const {
+    if (tag.empty()) {
+        return 0;
+    }
+    std::shared_lock<std::shared_mutex> lock(tagMutex_);
+    const auto it = tagVersions_.find(std::string(tag));
+    return it == tagVersions_.end() ? 0 : it->second;
+}
+
+std::shared_ptr<CachedRender> SharedRenderCache::lookup(std::string_view buildId,
+                                                        const RenderCache::Key &key,
+                                                        std::chrono::milliseconds ttl) {
+    const auto redis = client();
+    if (!redis || !available()) {
+        bypassed_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // The reply may arrive after the caller gave up; the promise outlives it.
+    auto reply = std::make_shared<std::promise<std::optional<std::string>>>();
+    auto pending = reply->get_future();
+    const auto redisKey = entryKey(buildId, key);
+    redis->execCommandAsync(
+        [reply](const RedisResult &result) {
+            if (result.type() == RedisResultType::kString) {
+                reply->set_value(result.asString());
+            } else {
+                reply->set_value(std::nullopt);
+            }
+        },
+        [reply](const RedisException &ex) {
+            reply->set_exception(std::make_exception_ptr(std::runtime_error(ex.what())));
+        },
+        "GET %s",
+        redisKey.c_str());
+
+    if (pending.wait_for(options_.timeout) != std::future_status::ready) {
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+        noteFailure();
+        return nullptr;
+    }
+    std::optional<std::string> bytes;
+    try {
+        bytes = pending.get();
+    } catch (const std::exception &) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        noteFailure();
+        return nullptr;
+    }
+    consecutiveFailures_.store(0, std::memory_order_relaxed);
+    if (!bytes) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    std::uint64_t storedAtMs = 0;
+    auto value = RenderCache::decode(*bytes, &storedAtMs);
+    if (!value) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    // Writers' clocks may run ahead of ours; treat that as brand new.
+    const auto nowMs = unixMillis();
+    const std::chrono::milliseconds age(nowMs > storedAtMs ? nowMs - storedAtMs : 0);
+    if (age >= ttl) {
+        expired_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    value->inheritedAge = age;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return value;
+}
+
+void SharedRenderCache::store(std::string_view buildId,
+                              const RenderCache::Key &key,
+                              std::chrono::milliseconds ttl,
+                              const CachedRender &value) {
+    const auto redis = client();
+    if (!redis || ttl.count() <= 0 || !available()) {
+        return;
+    }
+    const auto bytes = RenderCache::encode(value, unixMillis(), options_.gzip);
+    if (bytes.size() > options_.maxEntryBytes) {
+        oversized_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const auto redisKey = entryKey(buildId, key);
+    std::weak_ptr<SharedRenderCache> weak = weak_from_this();
+    // The command is formatted before this returns, so `bytes` may go.
+    redis->execCommandAsync(
+        [weak](const RedisResult &) {
+            if (const auto self = weak.lock()) {
+                self->writes_.fetch_add(1, std::memory_order_relaxed);
+            }
+        },
+        [weak](const RedisException &) {
+            if (const auto self = weak.lock()) {
+                self->writeErrors_.fetch_add(1, std::memory_order_relaxed);
+            }
+        },
+        "SET %s %b PX %lld",
+        redisKey.c_str(),
+        bytes.data(),
+        bytes.size(),
+        static_cast<long long>(ttl.count()));
+}
+
+void SharedRenderCache::invalidate(const std::string &tag) {
+    const auto redis = client();
+    if (!redis) {
+        invalidationFailures_.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN << "HydraStack shared render cache is not connected; cannot invalidate page "
+                 << tag;
+        return;
+    }
+    std::weak_ptr<SharedRenderCache> weak = weak_from_this();
+    redis->execCommandAsync(
+        [weak, redis, tag](const RedisResult &result) {
+            const auto self = weak.lock();
+            if (!self) {
+                return;
+            }
+            const auto version = static_cast<std::uint64_t>(result.asInteger());
+            self->applyTagVersion(tag, version);
+            self->invalidations_.fetch_add(1, std::memory_order_relaxed);
+            const auto message = std::to_string(version) + " " + tag;
+            // A node that misses the message catches up on its next refresh.
+            redis->execCommandAsync(
+                [](const RedisResult &) {},
+                [tag](const RedisException &ex) {
+                    LOG_WARN << "HydraStack could not announce invalidation of page " << tag
+                             << ": " << ex.what();
+                },
+                "PUBLISH %s %s",
+                self->channel_.c_str(),
+                message.c_str());
+        },
+        [weak, tag](const RedisException &ex) {
+            if (const auto self = weak.lock()) {
+                self->invalidationFailures_.fetch_add(1, std::memory_order_relaxed);
+            }
+            LOG_WARN << "HydraStack could not invalidate page " << tag
+                     << " in the shared render cache: " << ex.what();
+        },
+        "HINCRBY %s %s 1",
+        tagsKey_.c_str(),
+        tag.c_str());
+}
+
+SharedRenderCache::Stats SharedRenderCache::stats() const {
+    Stats stats;
+    stats.ready = ready();
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.expired = expired_.load(std::memory_order_relaxed);
+    stats.timeouts = timeouts_.load(std::memory_order_relaxed);
+    stats.errors = errors_.load(std::memory_order_relaxed);
+    stats.bypassed = bypassed_.load(std::memory_order_relaxed);
+    stats.writes = writes_.load(std::memory_order_relaxed);
+    stats.writeErrors = writeErrors_.load(std::memory_order_relaxed);
+    stats.oversized = oversized_.load(std::memory_order_relaxed);
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    stats.invalidationFailures = invalidationFailures_.load(std::memory_order_relaxed);
+    std::shared_lock<std::shared_mutex> lock(tagMutex_);
+    stats.tags = tagVersions_.size();
+    return stats;
+}
+
+SharedRenderCache::RedisClientPtr SharedRenderCache::client() const {
+    std::lock_guard<std::mutex> lock(clientMutex_);
+    return client_;
+}
+
+std::string SharedRenderCache::entryKey(std::string_view buildId,
+                                        const RenderCache::Key &key) const {
+    std::string out;
+    out.reserve(options_.keyPrefix.size() + buildId.size() + 42);
+    out.append(options_.keyPrefix).append(":render:");
+    out.append(buildId).push_back(':');
+    out.append(hashToHex(key.hash)).append(hashToHex(key.check));
+    return out;
+}
+
+bool SharedRenderCache::available() {
+    // Until the tag versions are known, keys could name invalidated pages.
+    return tagsLoaded_.load(std::memory_order_acquire) &&
+           steadyMicros() >= backoffUntilUs_.load(std::memory_order_relaxed);
+}
+
+void SharedRenderCache::noteFailure() {
+    if (consecutiveFailures_.fetch_add(1, std::memory_order_relaxed) + 1 <
+        kFailuresBeforeBackoff) {
+        return;
+    }
+    consecutiveFailures_.store(0, std::memory_order_relaxed);
+    backoffUntilUs_.store(
+        steadyMicros() + std::chrono::duration_cast<std::chrono::microseconds>(kBackoff).count(),
+        std::memory_order_relaxed);
+    LOG_WARN << "HydraStack shared render cache is slow or failing; skipping it for "
+             << kBackoff.count() << "ms";
+}
+
+void SharedRenderCache::refreshTags() {
+    const auto redis = client();
+    if (!redis) {
+        return;
+    }
+    std::weak_ptr<SharedRenderCache> weak = weak_from_this();
+    redis->execCommandAsync(
+        [weak](const RedisResult &result) {
+            const auto self = weak.lock();
+            if (!self) {
+                return;
+            }
+            if (result.type() == RedisResultType::kArray) {
+                const auto fields = result.asArray();
+                for (std::size_t i = 0; i + 1 < fields.size(); i += 2) {
+                    std::uint64_t version = 0;
+                    if (parseVersion(fields[i + 1].asString(), &version)) {
+                        self->applyTagVersion(fields[i].asString(), version);
+                    }
+                }
+            }
+            if (!self->tagsLoaded_.exchange(true, std::memory_order_acq_rel)) {
+                LOG_INFO << "HydraStack shared render cache ready, prefix="
+                         << self->options_.keyPrefix << ", tags=" << self->stats().tags;
+            }
+        },
+        [weak](const RedisException &ex) {
+            // Stays not ready until a load succeeds; the timer retries.
+            if (const auto self = weak.lock(); self && !self->tagsLoaded_.load()) {
+                LOG_WARN << "HydraStack shared render cache could not load tag versions: "
+                         << ex.what();
+            }
+        },
+        "HGETALL %s",
+        tagsKey_.c_str());
+}
+
+void SharedRenderCache::applyTagVersion(const std::string &tag, std::uint64_t version) {
+    std::unique_lock<std::shared_mutex> lock(tagMutex_);
+    auto &current = tagVersions_[tag];
+    // Messages and refreshes can arrive out of order; versions only grow.
+    if (version > current) {
+        current = version;
+    }
+}
+
+}  // namespace hydra
@@ -0,0 +1,139 @@
+#include "hydra/SsrEnvelope.h"
+
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+std::string trimAsciiWhitespace(std::string value) {
+    const auto isWs = [](unsigned char ch) { return std::isspace(ch) != 0; };
+
+    while (!value.empty() && isWs(static_cast<unsigned char>(value.front()))) {
+        value.erase(value.begin());
+    }
+    while (!value.empty() && isWs(static_cast<unsigned char>(value.back()))) {
+        value.pop_back();
+    }
+    return value;
+}
+
+}  // namespace
+
+SsrRenderResult finishSsrEnvelope(SsrEnvelopeFields fields) {
+    SsrRenderResult result;
+    result.html = std::move(fields.html);
+    result.propsJson = std::move(fields.props);
+    if (fields.status.has_value() && *fields.status >= 100 && *fields.status < 600) {
+        result.status = static_cast<int>(*fields.status);
+    }
+    for (auto &[headerName, headerValue] : fields.headers) {
+        result.headers[std::move(headerName)] = std::move(headerValue);
+    }
+
+    const auto readMetaString = [&](const char *key, const char *alias = nullptr) {
+        auto found = fields.meta.find(key);
+        std::string value =
+            found != fields.meta.end() ? trimAsciiWhitespace(found->second) : std::string();
+        if (value.empty() && alias != nullptr &&
+            (found = fields.meta.find(alias)) != fields.meta.end()) {
+            value = trimAsciiWhitespace(found->second);
+        }
+        return value;
+    };
+    result.title = readMetaString("title");
+    result.description = readMetaString("description");
+    result.canonicalUrl = readMetaString("canonicalUrl", "canonical_url");
+    result.robots = readMetaString("robots");
+    result.ogType = readMetaString("ogType", "og_type");
+    result.imageUrl = readMetaString("imageUrl", "image_url");
+    result.siteName = readMetaString("siteName", "site_name");
+    result.twitterCard = readMetaString("twitterCard", "twitter_card");
+
+    if (fields.redirect.has_value()) {
+        const auto redirectTarget = trimAsciiWhitespace(std::move(*fields.redirect));
+        if (!redirectTarget.empty()) {
+            result.headers["Location"] = redirectTarget;
+            if (result.status < 300 || result.status > 399) {
+                result.status = 302;
+            }
+        }
+    } else if (result.headers.find("Location") != result.headers.end() &&
+               (result.status < 300 || result.status > 399)) {
+        result.status = 302;
+    }
+
+    return result;
+}
+
+std::optional<SsrRenderResult> tryParseSsrEnvelope(const std::string &renderOutput) {
+    const auto firstNonWs = std::find_if_not(
+        renderOutput.begin(), renderOutput.end(), [](unsigned char ch) {
+            return std::isspace(ch) != 0;
+        });
+    if (firstNonWs == renderOutput.end() || *firstNonWs != '{') {
+        return std::nullopt;
+    }
+
+    Json::Value payload;
+    Json::CharReaderBuilder builder;
+    JSONCPP_STRING errors;
+    std::istringstream stream(renderOutput);
+    if (!Json::parseFromStream(builder, stream, &payload, &errors) || !payload.isObject()) {
+        return std::nullopt;
+    }
+    if (!payload.isMember("html")) {
+        return std::nullopt;
+    }
+
+    SsrEnvelopeFields fields;
+    if (payload["html"].isString()) {
+        fields.html = payload["html"].asString();
+    }
+    if (payload["status"].isNumeric()) {
+        fields.status = payload["status"].asDouble();
+    }
+
+    if (payload.isMember("headers") && payload["headers"].isObject()) {
+        for (const auto &headerName : payload["headers"].getMemberNames()) {
+            const auto &headerValue = payload["headers"][headerName];
+            if (headerValue.isString()) {
+                fields.headers.emplace_back(headerName, headerValue.asString());
+            } else if (headerValue.isBool()) {
+                fields.headers.emplace_back(headerName, headerValue.asBool() ? "true" : "false");
+            } else if (headerValue.isNumeric()) {
+                fields.headers.emplace_back(headerName, headerValue.asString());
+            }
+        }
+    }
+
+    if (payload.isMember("meta") && payload["meta"].isObject()) {
+        const auto &meta = payload["meta"];
+        for (const auto &key : meta.getMemberNames()) {
+            if (meta[key].isString()) {
+                fields.meta.emplace(key, meta[key].asString());
+            }
+        }
+    }
+
+    if (payload.isMember("redirect") && payload["redirect"].isString()) {
+        fields.redirect = payload["redirect"].asString();
+    }
+
+    if (payload.isMember("props") && payload["props"].isObject()) {
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        writer["commentStyle"] = "None";
+        fields.props = Json::writeString(writer, payload["props"]);
+    }
+
+    return finishSsrEnvelope(std::move(fields));
+}
+
+}  // namespace hydra
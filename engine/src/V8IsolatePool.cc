@@ -1,23 +1,32 @@
 #include "hydra/V8IsolatePool.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <stdexcept>
+#include <system_error>
 #include <utility>
 
 namespace hydra {
 
-V8IsolatePool::Lease::Lease(V8IsolatePool *pool, std::size_t runtimeIndex)
-    : pool_(pool), runtimeIndex_(runtimeIndex) {}
+V8IsolatePool::Lease::Lease(V8IsolatePool *pool,
+                            std::size_t runtimeIndex,
+                            V8SsrRuntime *runtime)
+    : pool_(pool), runtimeIndex_(runtimeIndex), runtime_(runtime) {}
 
 V8IsolatePool::Lease::~Lease() {
     release();
 }
 
 V8IsolatePool::Lease::Lease(Lease &&other) noexcept
-    : pool_(other.pool_), runtimeIndex_(other.runtimeIndex_) {
+    : pool_(other.pool_),
+      runtimeIndex_(other.runtimeIndex_),
+      runtime_(other.runtime_),
+      recycle_(other.recycle_) {
     other.pool_ = nullptr;
     other.runtimeIndex_ = 0;
+    other.runtime_ = nullptr;
+    other.recycle_ = false;
 }
 
 V8IsolatePool::Lease &V8IsolatePool::Lease::operator=(Lease &&other) noexcept {
@@ -29,8 +38,12 @@ V8IsolatePool::Lease &V8IsolatePool::Lease::operator=(Lease &&other) noexcept {
 
     pool_ = other.pool_;
     runtimeIndex_ = other.runtimeIndex_;
+    runtime_ = other.runtime_;
+    recycle_ = other.recycle_;
     other.pool_ = nullptr;
     other.runtimeIndex_ = 0;
+    other.runtime_ = nullptr;
+    other.recycle_ = false;
 
     return *this;
 }
@@ -40,7 +53,10 @@ V8SsrRuntime *V8IsolatePool::Lease::operator->() const {
 }
 
 V8SsrRuntime &V8IsolatePool::Lease::runtime() const {
-    return *pool_->runtimes_.at(runtimeIndex_);
+    if (runtime_ == nullptr) {
+        throw std::runtime_error("V8IsolatePool lease is empty");
+    }
+    return *runtime_;
 }
 
 void V8IsolatePool::Lease::markForRecycle() {
@@ -52,48 +68,174 @@ void V8IsolatePool::Lease::release() {
         return;
     }
 
-    if (recycle_) {
-        pool_->recycle(runtimeIndex_);
+    const auto reason =
+        runtime_ != nullptr ? runtime_->recycleReason() : V8SsrRuntime::RecycleReason::kNone;
+    if (recycle_ || reason != V8SsrRuntime::RecycleReason::kNone) {
+        pool_->recycle(runtimeIndex_, reason);
     } else {
         pool_->release(runtimeIndex_);
     }
     pool_ = nullptr;
     runtimeIndex_ = 0;
+    runtime_ = nullptr;
     recycle_ = false;
 }
 
+namespace {
+
+V8IsolatePoolOptions fixedSize(std::size_t size) {
+    V8IsolatePoolOptions options;
+    options.minSize = size;
+    options.maxSize = size;
+    return options;
+}
+
+constexpr std::size_t kMaxRecentScalingEvents = 16;
+
+std::atomic<std::uint64_t> nextPoolId{1};
+std::atomic<std::size_t> nextThreadOrdinal{0};
+
+struct PinnedSlot {
+    std::uint64_t poolId = 0;
+    std::size_t slot = 0;
+    bool pinned = false;
+};
+
+PinnedSlot &pinnedSlot(std::uint64_t poolId, std::size_t slotCount) {
+    // One pin per thread: a thread leases from one pool at a time, and a
+    // hot reload replaces the pool for good. Pool ids are never reused, so
+    // a lease from a different pool just starts a fresh pin; while an old
+    // generation drains the pin may flip between pools, which only costs
+    // the affinity, never correctness.
+    thread_local PinnedSlot pin;
+    thread_local const std::size_t ordinal =
+        nextThreadOrdinal.fetch_add(1, std::memory_order_relaxed);
+    if (pin.poolId != poolId) {
+        // Threads start their first scan at different slots so they spread
+        // out before pinning.
+        pin.poolId = poolId;
+        pin.slot = ordinal % slotCount;
+        pin.pinned = false;
+    }
+    return pin;
+}
+
+void bump(std::atomic<std::uint64_t> &counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 V8IsolatePool::V8IsolatePool(std::size_t size,
                              std::string bundlePath,
                              std::uint64_t renderTimeoutMs,
-                             FetchBridge fetchBridge)
-    : bundlePath_(std::move(bundlePath)),
+                             FetchBridge fetchBridge,
+                             V8RuntimeOptions runtimeOptions)
+    : V8IsolatePool(fixedSize(size),
+                    std::move(bundlePath),
+                    renderTimeoutMs,
+                    std::move(fetchBridge),
+                    std::move(runtimeOptions)) {}
+
+V8IsolatePool::V8IsolatePool(V8IsolatePoolOptions options,
+                             std::string bundlePath,
+                             std::uint64_t renderTimeoutMs,
+                             FetchBridge fetchBridge,
+                             V8RuntimeOptions runtimeOptions)
+    : options_(options),
+      id_(nextPoolId.fetch_add(1, std::memory_order_relaxed)),
+      bundlePath_(std::move(bundlePath)),
       fetchBridge_(std::move(fetchBridge)),
+      runtimeOptions_(std::move(runtimeOptions)),
       renderTimeoutMs_(renderTimeoutMs) {
-    const std::size_t poolSize = std::max<std::size_t>(1, size);
-    runtimes_.reserve(poolSize);
+    options_.minSize = std::max<std::size_t>(1, options_.minSize);
+    options_.maxSize = std::max(options_.minSize, options_.maxSize);
+    options_.growQueueDepth = std::max<std::size_t>(1, options_.growQueueDepth);
+    if (options_.scaleInterval.count() <= 0) {
+        options_.scaleInterval = std::chrono::milliseconds(1000);
+    }
+
+    slots_ = std::vector<Slot>(options_.maxSize);
+    for (std::size_t i = 0; i < options_.minSize; ++i) {
+        slots_[i].runtime =
+            std::make_unique<V8SsrRuntime>(bundlePath_, fetchBridge_, runtimeOptions_);
+        if (options_.warmup) {
+            slots_[i].state.store(SlotState::kParked);
+        } else {
+            markIdle(i);
+        }
+    }
+    liveCount_.store(options_.minSize);
+
+    const bool warmInBackground = options_.warmup && options_.warmupInBackground;
+    if (!options_.warmup) {
+        warm_.store(true);
+    } else if (!warmInBackground) {
+        warmInitialRuntimes();
+    }
+    builder_ = std::thread([this, warmInBackground] {
+        if (warmInBackground) {
+            warmInitialRuntimes();
+        }
+        runBuilder();
+    });
+}
 
-    for (std::size_t i = 0; i < poolSize; ++i) {
-        runtimes_.push_back(std::make_unique<V8SsrRuntime>(bundlePath_, fetchBridge_));
-        availableRuntimes_.push(i);
+V8IsolatePool::~V8IsolatePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    builderCv_.notify_all();
+    if (builder_.joinable()) {
+        builder_.join();
     }
 }
 
 V8IsolatePool::Lease V8IsolatePool::acquire(std::uint64_t acquireTimeoutMs) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (acquireTimeoutMs == 0) {
-        cv_.wait(lock, [this] { return !availableRuntimes_.empty(); });
-    } else {
-        const auto ready = cv_.wait_for(lock,
-                                        std::chrono::milliseconds(acquireTimeoutMs),
-                                        [this] { return !availableRuntimes_.empty(); });
+    auto index = tryClaim(LeasePath::kFast);
+    if (index == slots_.size()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Registered before the re-scan below: a concurrent release either
+        // leaves an idle slot for the scan or sees the waiter and notifies.
+        const auto waiting = waiters_.fetch_add(1) + 1;
+        const auto hasRuntime = [this, &index] {
+            index = tryClaim(LeasePath::kWaited);
+            return index != slots_.size();
+        };
+        const auto waitStartedAt = Clock::now();
+        const auto deadline = waitStartedAt + std::chrono::milliseconds(acquireTimeoutMs);
+        if (waiting >= options_.growQueueDepth) {
+            requestGrowthLocked("queue_depth");
+        }
+
+        bool ready = false;
+        if (elastic()) {
+            // Wake once at the wait threshold to ask for another runtime.
+            auto growAt = waitStartedAt + options_.growWait;
+            if (acquireTimeoutMs != 0) {
+                growAt = std::min(growAt, deadline);
+            }
+            ready = cv_.wait_until(lock, growAt, hasRuntime);
+            if (!ready && (acquireTimeoutMs == 0 || Clock::now() < deadline)) {
+                requestGrowthLocked("acquire_wait");
+            }
+        }
+        if (!ready) {
+            if (acquireTimeoutMs == 0) {
+                cv_.wait(lock, hasRuntime);
+                ready = true;
+            } else {
+                ready = cv_.wait_until(lock, deadline, hasRuntime);
+            }
+        }
+        waiters_.fetch_sub(1);
         if (!ready) {
             throw std::runtime_error("Timed out waiting for available V8 isolate");
         }
     }
 
-    const std::size_t index = availableRuntimes_.front();
-    availableRuntimes_.pop();
-    return Lease(this, index);
+    return Lease(this, index, slots_[index].runtime.get());
 }
 
 std::uint64_t V8IsolatePool::renderTimeoutMs() const {
@@ -101,44 +243,498 @@ std::uint64_t V8IsolatePool::renderTimeoutMs() const {
 }
 
 std::size_t V8IsolatePool::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return runtimes_.size();
+    return liveCount_.load(std::memory_order_relaxed);
 }
 
 std::size_t V8IsolatePool::availableCount() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return availableRuntimes_.size();
+    return countState(SlotState::kIdle);
 }
 
 std::size_t V8IsolatePool::inUseCount() const {
+    const auto live = liveCount_.load(std::memory_order_relaxed);
+    return live - std::min(live, countState(SlotState::kIdle));
+}
+
+bool V8IsolatePool::warm() const {
+    return warm_.load();
+}
+
+V8IsolatePool::ScalingStats V8IsolatePool::scalingStats() const {
+    ScalingStats stats;
+    stats.minSize = options_.minSize;
+    stats.maxSize = options_.maxSize;
+    stats.size = liveCount_.load(std::memory_order_relaxed);
+    stats.available = countState(SlotState::kIdle);
+    stats.waiters = waiters_.load(std::memory_order_relaxed);
+    stats.standbyTarget = options_.standbyCount;
+    for (const auto &slot : slots_) {
+        stats.leases.affine += slot.affineLeases.load(std::memory_order_relaxed);
+        stats.leases.stolen += slot.stolenLeases.load(std::memory_order_relaxed);
+        stats.leases.waited += slot.waitedLeases.load(std::memory_order_relaxed);
+    }
+
+    // Builder-side counters; this lock is off the lease path.
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.grows = grows_;
+    stats.growFailures = growFailures_;
+    stats.reaps = reaps_;
+    stats.standby = standby_.size();
+    stats.pendingRebuilds = rebuildQueue_.size();
+    stats.standbySwaps = standbySwaps_;
+    stats.rebuilds = rebuilds_;
+    stats.rebuildFailures = rebuildFailures_;
+    stats.rebuildUsTotal = rebuildUsTotal_;
+    stats.rebuildUsMax = rebuildUsMax_;
+    stats.recycles = recycleCounts_;
+    stats.idleGcRuns = idleGcRuns_;
+    stats.idleGcUsTotal = idleGcUsTotal_;
+    stats.warm = warm_.load();
+    stats.warmups = warmups_;
+    stats.warmupFailures = warmupFailures_;
+    stats.warmupUsTotal = warmupUsTotal_;
+    stats.warmupUsMax = warmupUsMax_;
+    stats.recentEvents.assign(recentEvents_.begin(), recentEvents_.end());
+    return stats;
+}
+
+std::vector<V8IsolatePool::RuntimeStats> V8IsolatePool::runtimeStats() const {
+    // Held so the builder cannot swap or destroy a runtime being sampled.
     std::lock_guard<std::mutex> lock(mutex_);
-    return runtimes_.size() - availableRuntimes_.size();
+    std::vector<RuntimeStats> out;
+    out.reserve(liveCount_.load(std::memory_order_relaxed));
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        const auto *runtime = slots_[i].runtime.get();
+        if (runtime == nullptr) {
+            continue;
+        }
+        RuntimeStats stats;
+        stats.slot = i;
+        stats.inUse = slots_[i].state.load(std::memory_order_relaxed) != SlotState::kIdle;
+        stats.heap = runtime->heapSample();
+        stats.renders = runtime->renderCount();
+        out.push_back(stats);
+    }
+    return out;
+}
+
+std::size_t V8IsolatePool::tryClaim(LeasePath path) {
+    const auto slotCount = slots_.size();
+    std::size_t start = 0;
+    PinnedSlot *pin = nullptr;
+    if (options_.threadAffinity) {
+        pin = &pinnedSlot(id_, slotCount);
+        if (pin->pinned && tryClaimSlot(pin->slot)) {
+            bump(path == LeasePath::kWaited ? slots_[pin->slot].waitedLeases
+                                            : slots_[pin->slot].affineLeases);
+            return pin->slot;
+        }
+        start = pin->pinned ? pin->slot + 1 : pin->slot;
+    }
+
+    for (std::size_t n = 0; n < slotCount; ++n) {
+        const auto index = (start + n) % slotCount;
+        if (!tryClaimSlot(index)) {
+            continue;
+        }
+        auto &slot = slots_[index];
+        bump(path == LeasePath::kWaited ? slot.waitedLeases : slot.stolenLeases);
+        // Pin on the first lease, and again once the pinned runtime is
+        // reaped; a busy pinned runtime keeps its pin.
+        if (pin != nullptr &&
+            (!pin->pinned ||
+             slots_[pin->slot].state.load(std::memory_order_relaxed) == SlotState::kEmpty)) {
+            pin->slot = index;
+            pin->pinned = true;
+        }
+        return index;
+    }
+    return slotCount;
+}
+
+bool V8IsolatePool::tryClaimSlot(std::size_t index) {
+    auto &state = slots_[index].state;
+    // Plain load first so scans over busy slots do not bounce their lines.
+    if (state.load(std::memory_order_relaxed) != SlotState::kIdle) {
+        return false;
+    }
+    auto expected = SlotState::kIdle;
+    return state.compare_exchange_strong(expected, SlotState::kLeased);
+}
+
+void V8IsolatePool::markIdle(std::size_t index) {
+    auto &slot = slots_[index];
+    slot.idleSince.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    slot.state.store(SlotState::kIdle);
+}
+
+void V8IsolatePool::wakeWaiter() {
+    if (waiters_.load() == 0) {
+        return;
+    }
+    // Taking the lock orders the notify after a waiter that registered but
+    // has not started waiting yet.
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_one();
+}
+
+std::size_t V8IsolatePool::countState(SlotState state) const {
+    std::size_t count = 0;
+    for (const auto &slot : slots_) {
+        count += slot.state.load(std::memory_order_relaxed) == state ? 1 : 0;
+    }
+    return count;
 }
 
 void V8IsolatePool::release(std::size_t runtimeIndex) {
+    markIdle(runtimeIndex);
+    wakeWaiter();
+}
+
+void V8IsolatePool::recycle(std::size_t runtimeIndex,
+                            V8SsrRuntime::RecycleReason reason) noexcept {
+    bool swapped = false;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        availableRuntimes_.push(runtimeIndex);
+        swapped = recycleLocked(runtimeIndex, reason);
+    }
+    // Either way the builder has work: retire + refill, or rebuild.
+    builderCv_.notify_one();
+    if (swapped) {
+        cv_.notify_one();
     }
-    cv_.notify_one();
 }
 
-void V8IsolatePool::recycle(std::size_t runtimeIndex) noexcept {
-    std::unique_ptr<V8SsrRuntime> replacement;
+bool V8IsolatePool::recycleLocked(std::size_t runtimeIndex,
+                                  V8SsrRuntime::RecycleReason reason) noexcept {
+    bool swapped = false;
+    switch (reason) {
+        case V8SsrRuntime::RecycleReason::kNone:
+            ++recycleCounts_.renderFailure;
+            break;
+        case V8SsrRuntime::RecycleReason::kRenderCount:
+            ++recycleCounts_.renderCount;
+            break;
+        case V8SsrRuntime::RecycleReason::kHeapGrowth:
+            ++recycleCounts_.heapGrowth;
+            break;
+        case V8SsrRuntime::RecycleReason::kHeapLimit:
+            ++recycleCounts_.heapLimit;
+            break;
+    }
+    auto &slot = slots_[runtimeIndex];
     try {
-        replacement = std::make_unique<V8SsrRuntime>(bundlePath_, fetchBridge_);
+        if (!standby_.empty()) {
+            retired_.push_back(std::move(slot.runtime));
+            slot.runtime = std::move(standby_.back());
+            standby_.pop_back();
+            markIdle(runtimeIndex);
+            ++standbySwaps_;
+            swapped = true;
+        } else {
+            rebuildQueue_.push_back(runtimeIndex);
+            slot.state.store(SlotState::kParked);
+        }
     } catch (...) {
-        // Keep the existing runtime if recycle failed.
+        // Out of memory for the bookkeeping: keep the existing runtime.
+        if (!swapped) {
+            markIdle(runtimeIndex);
+            swapped = true;
+        }
     }
+    return swapped;
+}
 
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (replacement) {
-            runtimes_[runtimeIndex] = std::move(replacement);
+bool V8IsolatePool::elastic() const {
+    return options_.maxSize > options_.minSize;
+}
+
+void V8IsolatePool::requestGrowthLocked(const char *reason) {
+    if (!elastic() || growRequested_ || liveCount_.load() >= options_.maxSize) {
+        return;
+    }
+    growRequested_ = true;
+    growReason_ = reason;
+    builderCv_.notify_one();
+}
+
+void V8IsolatePool::recordEventLocked(const char *action, const char *reason) {
+    ScalingEvent event;
+    event.at = std::chrono::system_clock::now();
+    event.action = action;
+    event.reason = reason;
+    event.sizeAfter = liveCount_.load();
+    recentEvents_.push_back(event);
+    if (recentEvents_.size() > kMaxRecentScalingEvents) {
+        recentEvents_.pop_front();
+    }
+}
+
+std::unique_ptr<V8SsrRuntime> V8IsolatePool::buildRuntime() {
+    std::unique_ptr<V8SsrRuntime> runtime;
+    try {
+        runtime = std::make_unique<V8SsrRuntime>(bundlePath_, fetchBridge_, runtimeOptions_);
+    } catch (...) {
+        return nullptr;
+    }
+    warmUp(*runtime);
+    // Hit its heap limit warming up: a termination is pending, and the
+    // first request on it would fail.
+    if (runtime->recycleReason() != V8SsrRuntime::RecycleReason::kNone) {
+        return nullptr;
+    }
+    return runtime;
+}
+
+void V8IsolatePool::warmUp(V8SsrRuntime &runtime) {
+    if (!options_.warmup) {
+        return;
+    }
+    const auto startedAt = Clock::now();
+    bool failed = false;
+    try {
+        options_.warmup(runtime);
+    } catch (...) {
+        failed = true;
+    }
+    try {
+        runtime.finishWarmup();
+    } catch (...) {
+    }
+    const auto elapsedUs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startedAt)
+            .count());
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++warmups_;
+    warmupFailures_ += failed ? 1 : 0;
+    warmupUsTotal_ += elapsedUs;
+    warmupUsMax_ = std::max(warmupUsMax_, elapsedUs);
+}
+
+void V8IsolatePool::warmInitialRuntimes() {
+    // The slots are parked, so each runtime belongs to its warming thread
+    // until it is marked idle.
+    const auto warmSlot = [this](std::size_t index) {
+        auto &runtime = *slots_[index].runtime;
+        warmUp(runtime);
+        if (const auto reason = runtime.recycleReason();
+            reason != V8SsrRuntime::RecycleReason::kNone) {
+            recycle(index, reason);
+            return;
+        }
+        markIdle(index);
+        wakeWaiter();
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(options_.minSize);
+    for (std::size_t i = 0; i < options_.minSize; ++i) {
+        try {
+            threads.emplace_back(warmSlot, i);
+        } catch (const std::system_error &) {
+            warmSlot(i);
+        }
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    warm_.store(true);
+}
+
+void V8IsolatePool::runBuilder() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto canBuild = [this] { return Clock::now() >= buildBackoffUntil_; };
+    const auto wantsGrowth = [this] {
+        return growRequested_ && liveCount_.load() < options_.maxSize;
+    };
+    const auto idleFor = [this](const Slot &slot, Clock::time_point now) {
+        return now - Clock::time_point(
+                         Clock::duration(slot.idleSince.load(std::memory_order_relaxed)));
+    };
+    // Only the builder hands idle slots to itself, so a successful claim
+    // here cannot race with another pool-side owner.
+    const auto park = [](Slot &slot) {
+        auto expected = SlotState::kIdle;
+        return slot.state.compare_exchange_strong(expected, SlotState::kParked);
+    };
+    // Builds outside the lock (bundle evaluation takes tens of ms) and
+    // records the latency of background builds.
+    const auto timedBuild = [this, &lock]() {
+        lock.unlock();
+        const auto startedAt = Clock::now();
+        auto runtime = buildRuntime();
+        const auto elapsedUs = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startedAt)
+                .count());
+        lock.lock();
+        if (runtime) {
+            ++rebuilds_;
+            rebuildUsTotal_ += elapsedUs;
+            rebuildUsMax_ = std::max(rebuildUsMax_, elapsedUs);
+        } else {
+            ++rebuildFailures_;
+            buildBackoffUntil_ = Clock::now() + options_.scaleInterval;
+        }
+        return runtime;
+    };
+
+    while (!stopping_) {
+        builderCv_.wait_for(lock, options_.scaleInterval, [&] {
+            return stopping_ || !retired_.empty() ||
+                   (canBuild() && (!rebuildQueue_.empty() || wantsGrowth() ||
+                                   standby_.size() < options_.standbyCount));
+        });
+        if (stopping_) {
+            break;
+        }
+
+        if (!retired_.empty()) {
+            auto retired = std::move(retired_);
+            retired_.clear();
+            lock.unlock();
+            retired.clear();
+            lock.lock();
+            continue;
+        }
+
+        // Restoring capacity lost to a failed runtime comes first.
+        if (!rebuildQueue_.empty() && canBuild()) {
+            const auto index = rebuildQueue_.front();
+            rebuildQueue_.pop_front();
+            auto runtime = timedBuild();
+            std::unique_ptr<V8SsrRuntime> failed;
+            if (runtime) {
+                failed = std::move(slots_[index].runtime);
+                slots_[index].runtime = std::move(runtime);
+            }
+            // A failed rebuild keeps the old runtime, as an inline recycle did.
+            markIdle(index);
+            cv_.notify_one();
+            if (failed) {
+                lock.unlock();
+                failed.reset();
+                lock.lock();
+            }
+            continue;
+        }
+
+        if (wantsGrowth() && canBuild()) {
+            const char *reason = growReason_;
+            std::unique_ptr<V8SsrRuntime> runtime;
+            if (!standby_.empty()) {
+                runtime = std::move(standby_.back());
+                standby_.pop_back();
+            } else {
+                runtime = timedBuild();
+            }
+            growRequested_ = false;
+            if (!runtime) {
+                ++growFailures_;
+                recordEventLocked("grow_failed", reason);
+                continue;
+            }
+            // Empty slots are only filled and emptied here.
+            std::size_t index = 0;
+            while (slots_[index].state.load(std::memory_order_relaxed) != SlotState::kEmpty) {
+                ++index;
+            }
+            slots_[index].runtime = std::move(runtime);
+            liveCount_.fetch_add(1);
+            markIdle(index);
+            ++grows_;
+            recordEventLocked("grow", reason);
+            cv_.notify_one();
+            // Still backed up: keep growing without waiting for a new signal.
+            const auto waiting = waiters_.load();
+            if (waiting > 1 && waiting - 1 >= options_.growQueueDepth) {
+                requestGrowthLocked("queue_depth");
+            }
+            continue;
+        }
+
+        if (standby_.size() < options_.standbyCount && canBuild()) {
+            if (auto runtime = timedBuild()) {
+                standby_.push_back(std::move(runtime));
+            }
+            continue;
+        }
+
+        // Reap the longest-idle runtimes first. A reaped runtime tops up the
+        // standby set before being destroyed.
+        auto now = Clock::now();
+        std::vector<std::unique_ptr<V8SsrRuntime>> reaped;
+        while (options_.idleTtl.count() > 0 && liveCount_.load() > options_.minSize &&
+               waiters_.load() == 0) {
+            Slot *oldest = nullptr;
+            for (auto &slot : slots_) {
+                if (slot.state.load(std::memory_order_relaxed) == SlotState::kIdle &&
+                    (oldest == nullptr || idleFor(slot, now) > idleFor(*oldest, now))) {
+                    oldest = &slot;
+                }
+            }
+            if (oldest == nullptr || idleFor(*oldest, now) < options_.idleTtl) {
+                break;
+            }
+            if (!park(*oldest)) {
+                // Leased since the scan; look again.
+                continue;
+            }
+            if (standby_.size() < options_.standbyCount) {
+                standby_.push_back(std::move(oldest->runtime));
+            } else {
+                reaped.push_back(std::move(oldest->runtime));
+            }
+            oldest->state.store(SlotState::kEmpty);
+            liveCount_.fetch_sub(1);
+            ++reaps_;
+            recordEventLocked("reap", "idle_ttl");
+        }
+        if (!reaped.empty()) {
+            lock.unlock();
+            reaped.clear();
+            lock.lock();
+        }
+
+        // Full GC for runtimes that rendered and then sat idle, parked so no
+        // lease lands on it mid-collection. The last free runtime is never
+        // taken.
+        now = Clock::now();
+        for (std::size_t index = 0; options_.idleGc && !stopping_ && index < slots_.size();
+             ++index) {
+            auto &slot = slots_[index];
+            if (waiters_.load() != 0 || countState(SlotState::kIdle) <= 1) {
+                break;
+            }
+            if (slot.state.load(std::memory_order_relaxed) != SlotState::kIdle ||
+                idleFor(slot, now) < options_.idleGcDelay || !slot.runtime->rendersSinceGc() ||
+                !park(slot)) {
+                continue;
+            }
+            auto *runtime = slot.runtime.get();
+            lock.unlock();
+            const auto startedAt = Clock::now();
+            try {
+                runtime->collectGarbage();
+            } catch (...) {
+            }
+            const auto elapsedUs = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startedAt)
+                    .count());
+            lock.lock();
+            ++idleGcRuns_;
+            idleGcUsTotal_ += elapsedUs;
+            // The collection can hit the heap limit and leave a termination
+            // pending; such a runtime goes the way of any other recycle.
+            if (const auto reason = runtime->recycleReason();
+                reason != V8SsrRuntime::RecycleReason::kNone) {
+                if (recycleLocked(index, reason)) {
+                    cv_.notify_one();
+                }
+                continue;
+            }
+            // idleSince is left alone: still idle for reaping purposes.
+            slot.state.store(SlotState::kIdle);
+            cv_.notify_one();
         }
-        availableRuntimes_.push(runtimeIndex);
     }
-    cv_.notify_one();
 }
 
 }  // namespace hydra
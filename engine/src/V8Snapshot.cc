@@ -0,0 +1,206 @@
+#include "hydra/V8Snapshot.h"
+
+#include "hydra/Hash.h"
+#include "hydra/V8SsrRuntime.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace hydra {
+namespace {
+
+constexpr std::string_view kSnapshotMagic = "hydra-v8-snapshot ";
+constexpr std::string_view kCodeCacheMagic = "hydra-v8-code-cache ";
+// Bump when the native callbacks installed by the bootstrap change, so
+// blobs built against the old V8SsrRuntime::externalReferences() are not
+// reused.
+constexpr std::string_view kHostRevision = "-host-4";
+
+std::string readBinaryFile(const std::string &path, bool *ok) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        *ok = false;
+        return {};
+    }
+
+    *ok = true;
+    return std::string(std::istreambuf_iterator<char>(input),
+                       std::istreambuf_iterator<char>());
+}
+
+// Writes to a sibling temp file first so concurrent boots never observe a
+// half-written snapshot.
+bool writeFileAtomically(const std::string &path,
+                         const std::string &header,
+                         const std::string &data) {
+    const auto tempPath =
+        path + ".tmp." +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            return false;
+        }
+        output.write(header.data(), static_cast<std::streamsize>(header.size()));
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!output) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+V8StartupSnapshot::V8StartupSnapshot(std::string data, std::string key, std::string origin)
+    : data_(std::move(data)), key_(std::move(key)), origin_(std::move(origin)) {
+    blob_.data = data_.data();
+    blob_.raw_size = static_cast<int>(data_.size());
+}
+
+std::shared_ptr<const V8StartupSnapshot> V8StartupSnapshot::loadOrCreate(
+    const std::string &bundlePath,
+    const std::string &cachePath,
+    bool persist) {
+    bool bundleRead = false;
+    const auto bundleSource = readBinaryFile(bundlePath, &bundleRead);
+    if (!bundleRead) {
+        throw std::runtime_error("Unable to open SSR bundle: " + bundlePath);
+    }
+
+    const auto key = keyForBundle(bundleSource);
+    const auto resolvedPath = cachePath.empty() ? bundlePath + ".snapshot" : cachePath;
+    const auto header = std::string(kSnapshotMagic) + key + "\n";
+
+    bool cacheRead = false;
+    auto cached = readBinaryFile(resolvedPath, &cacheRead);
+    if (cacheRead && cached.size() > header.size() &&
+        cached.compare(0, header.size(), header) == 0) {
+        auto snapshot = std::make_shared<V8StartupSnapshot>(
+            cached.substr(header.size()), key, "file");
+        if (snapshot->blob()->IsValid()) {
+            return snapshot;
+        }
+    }
+
+    auto snapshot = std::make_shared<V8StartupSnapshot>(
+        V8SsrRuntime::createStartupSnapshotBlob(bundlePath, bundleSource), key, "built");
+    if (persist) {
+        // A read-only deploy directory only costs the next boot a rebuild.
+        (void)writeFileAtomically(resolvedPath, header, snapshot->data_);
+    }
+    return snapshot;
+}
+
+std::string V8StartupSnapshot::keyForBundle(const std::string &bundleSource) {
+    return hashToHex(hash64(bundleSource)) + "-v8-" + v8::V8::GetVersion() +
+           std::string(kHostRevision);
+}
+
+const v8::StartupData *V8StartupSnapshot::blob() const {
+    return &blob_;
+}
+
+const std::string &V8StartupSnapshot::key() const {
+    return key_;
+}
+
+const std::string &V8StartupSnapshot::origin() const {
+    return origin_;
+}
+
+std::size_t V8StartupSnapshot::sizeBytes() const {
+    return data_.size();
+}
+
+V8CodeCache::V8CodeCache(const std::string &bundlePath, std::string cachePath, bool persist)
+    : cachePath_(cachePath.empty() ? bundlePath + ".codecache" : std::move(cachePath)),
+      persist_(persist) {}
+
+V8CodeCache::Entry V8CodeCache::lookup(const std::string &bundleSource) {
+    Entry entry;
+    entry.key = V8StartupSnapshot::keyForBundle(bundleSource);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (key_ == entry.key && data_) {
+        entry.data = data_;
+        return entry;
+    }
+
+    // Only a persisted cache needs a disk probe, and only once per process.
+    if (persist_ && !fileChecked_) {
+        fileChecked_ = true;
+        const auto header = std::string(kCodeCacheMagic) + entry.key + "\n";
+        bool cacheRead = false;
+        auto cached = readBinaryFile(cachePath_, &cacheRead);
+        if (cacheRead && cached.size() > header.size() &&
+            cached.compare(0, header.size(), header) == 0) {
+            key_ = entry.key;
+            data_ = std::make_shared<const std::string>(cached.substr(header.size()));
+            origin_ = "file";
+            entry.data = data_;
+        }
+    }
+    return entry;
+}
+
+void V8CodeCache::store(const std::string &key, std::string data) {
+    auto shared = std::make_shared<const std::string>(std::move(data));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        key_ = key;
+        data_ = shared;
+        origin_ = "produced";
+        ++produced_;
+    }
+
+    if (persist_) {
+        // Same policy as the snapshot: a failed write only costs a recompile.
+        (void)writeFileAtomically(
+            cachePath_, std::string(kCodeCacheMagic) + key + "\n", *shared);
+    }
+}
+
+void V8CodeCache::recordConsumed(const std::string &key, bool accepted) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (accepted) {
+        ++accepted_;
+        status_ = "accepted";
+        return;
+    }
+
+    ++rejected_;
+    status_ = "rejected";
+    if (key_ == key) {
+        data_.reset();
+        origin_ = "none";
+    }
+}
+
+V8CodeCache::Stats V8CodeCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.origin = origin_;
+    stats.status = status_;
+    stats.key = key_;
+    stats.bytes = data_ ? data_->size() : 0;
+    stats.produced = produced_;
+    stats.accepted = accepted_;
+    stats.rejected = rejected_;
+    return stats;
+}
+
+}  // namespace hydra
@@ -1,18 +1,24 @@
 #include "hydra/V8SsrRuntime.h"
 
+#include "hydra/RenderDeadlineScheduler.h"
+#include "hydra/RequestContext.h"
+#include "hydra/SsrEnvelope.h"
+#include "hydra/V8Snapshot.h"
+
 #include <v8.h>
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iterator>
-#include <json/reader.h>
-#include <json/writer.h>
 #include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
-#include <thread>
 #include <unordered_map>
 #include <utility>
 
@@ -30,50 +36,35 @@ class IsolateCleanup {
     }
 };
 
-class RenderWatchdog {
+// Arms the runtime's deadline slot for the duration of one render.
+class RenderDeadlineGuard {
   public:
-    RenderWatchdog(v8::Isolate *isolate, std::uint64_t timeoutMs)
-        : isolate_(isolate), timeoutMs_(timeoutMs) {
-        if (timeoutMs_ == 0) {
-            return;
+    RenderDeadlineGuard(RenderDeadlineScheduler::Slot *slot, std::uint64_t timeoutMs)
+        : slot_(timeoutMs > 0 ? slot : nullptr) {
+        if (slot_ != nullptr) {
+            RenderDeadlineScheduler::instance().arm(*slot_, timeoutMs);
         }
-
-        thread_ = std::thread([this] {
-            std::unique_lock<std::mutex> lock(mutex_);
-            const auto stopped = cv_.wait_for(lock,
-                                              std::chrono::milliseconds(timeoutMs_),
-                                              [this] { return done_; });
-            if (!stopped) {
-                isolate_->TerminateExecution();
-            }
-        });
     }
 
-    ~RenderWatchdog() {
-        stop();
+    ~RenderDeadlineGuard() {
+        (void)finish();
     }
 
-    RenderWatchdog(const RenderWatchdog &) = delete;
-    RenderWatchdog &operator=(const RenderWatchdog &) = delete;
+    RenderDeadlineGuard(const RenderDeadlineGuard &) = delete;
+    RenderDeadlineGuard &operator=(const RenderDeadlineGuard &) = delete;
 
-    void stop() {
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            done_ = true;
-        }
-        cv_.notify_all();
-        if (thread_.joinable()) {
-            thread_.join();
+    // Disarms the deadline; returns true when it fired first.
+    bool finish() {
+        if (slot_ == nullptr) {
+            return false;
         }
+        auto *slot = slot_;
+        slot_ = nullptr;
+        return RenderDeadlineScheduler::instance().cancel(*slot);
     }
 
   private:
-    v8::Isolate *isolate_ = nullptr;
-    std::uint64_t timeoutMs_ = 0;
-    std::thread thread_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    bool done_ = false;
+    RenderDeadlineScheduler::Slot *slot_ = nullptr;
 };
 
 std::string readFile(const std::string &path) {
@@ -119,32 +110,282 @@ v8::Local<v8::String> toV8String(v8::Isolate *isolate, const std::string &value)
     return out;
 }
 
-bool parseJsonString(const std::string &json, Json::Value *out) {
-    if (out == nullptr) {
-        return false;
+// Below this a heap copy is cheaper than an external resource.
+constexpr std::size_t kExternalPayloadMinBytes = 1024;
+// Extra heap granted past the cap so a terminated render can unwind; the
+// runtime is recycled on release, so the overshoot is short-lived.
+constexpr std::size_t kHeapLimitHeadroomBytes = 16 * 1024 * 1024;
+
+bool isAscii(std::string_view value) {
+    constexpr std::uint64_t kHighBits = 0x8080808080808080ULL;
+    const char *ptr = value.data();
+    const char *const end = ptr + value.size();
+    std::uint64_t seen = 0;
+    for (; ptr + sizeof(std::uint64_t) <= end; ptr += sizeof(std::uint64_t)) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, ptr, sizeof(word));
+        seen |= word;
+    }
+    for (; ptr < end; ++ptr) {
+        seen |= static_cast<unsigned char>(*ptr);
+    }
+    return (seen & kHighBits) == 0;
+}
+
+// Lets V8 read the props buffer in place. V8 deletes the resource when the
+// string is collected, which is when the buffer reference is released.
+class SharedPayloadResource : public v8::String::ExternalOneByteStringResource {
+  public:
+    explicit SharedPayloadResource(std::shared_ptr<const std::string> payload)
+        : payload_(std::move(payload)) {}
+
+    const char *data() const override {
+        return payload_->data();
+    }
+
+    size_t length() const override {
+        return payload_->size();
+    }
+
+  private:
+    std::shared_ptr<const std::string> payload_;
+};
+
+v8::Local<v8::String> toV8Payload(v8::Isolate *isolate,
+                                  const std::shared_ptr<const std::string> &payload) {
+    // One-byte strings are Latin-1, so only pure-ASCII UTF-8 can be shared;
+    // jsoncpp's writer escapes non-ASCII by default, so serialized props
+    // usually qualify.
+    if (payload->size() >= kExternalPayloadMinBytes &&
+        payload->size() <= static_cast<std::size_t>(v8::String::kMaxLength) &&
+        isAscii(*payload)) {
+        auto *resource = new SharedPayloadResource(payload);
+        v8::Local<v8::String> out;
+        if (v8::String::NewExternalOneByte(isolate, resource).ToLocal(&out)) {
+            return out;
+        }
+        delete resource;
+    }
+    return toV8String(isolate, *payload);
+}
+
+std::string toStdString(v8::Isolate *isolate, v8::Local<v8::Value> value) {
+    v8::String::Utf8Value utf8(isolate, value);
+    return *utf8 ? std::string(*utf8, static_cast<std::size_t>(utf8.length())) : std::string();
+}
+
+// `object[key]`; undefined when the getter throws.
+v8::Local<v8::Value> getMember(v8::Local<v8::Context> context,
+                               v8::Local<v8::Object> object,
+                               const char *key) {
+    auto *isolate = context->GetIsolate();
+    v8::Local<v8::Value> value;
+    if (!object->Get(context, toV8String(isolate, key)).ToLocal(&value)) {
+        return v8::Undefined(isolate);
+    }
+    return value;
+}
+
+bool isPlainObject(v8::Local<v8::Value> value) {
+    return value->IsObject() && !value->IsArray();
+}
+
+// Calls `visit(name, value)` for each own enumerable string-keyed property.
+template <typename Visit>
+void forEachMember(v8::Local<v8::Context> context, v8::Local<v8::Object> object, Visit visit) {
+    auto *isolate = context->GetIsolate();
+    v8::Local<v8::Array> names;
+    if (!object->GetOwnPropertyNames(context).ToLocal(&names)) {
+        return;
+    }
+    for (std::uint32_t i = 0; i < names->Length(); ++i) {
+        v8::Local<v8::Value> name;
+        v8::Local<v8::Value> value;
+        if (!names->Get(context, i).ToLocal(&name) ||
+            !object->Get(context, name).ToLocal(&value)) {
+            continue;
+        }
+        visit(toStdString(isolate, name), value);
+    }
+}
+
+// Reads the argument of hydra.fetch() straight off the V8 object. A string
+// argument is the older JSON payload and is parsed by V8 first.
+BridgeRequest readBridgeRequest(v8::Local<v8::Context> context,
+                                const v8::FunctionCallbackInfo<v8::Value> &info) {
+    auto *isolate = context->GetIsolate();
+    BridgeRequest request;
+    if (info.Length() == 0) {
+        return request;
+    }
+    // Malformed payloads read as an empty request, as they always have.
+    v8::TryCatch tryCatch(isolate);
+    auto value = info[0];
+    if (value->IsString() &&
+        !v8::JSON::Parse(context, value.As<v8::String>()).ToLocal(&value)) {
+        return request;
+    }
+    if (!isPlainObject(value)) {
+        return request;
     }
 
-    Json::CharReaderBuilder builder;
-    std::string errors;
-    std::istringstream stream(json);
-    return Json::parseFromStream(builder, stream, out, &errors);
+    auto object = value.As<v8::Object>();
+    if (const auto method = getMember(context, object, "method"); !method->IsNullOrUndefined()) {
+        request.method = toStdString(isolate, method);
+    }
+    if (const auto path = getMember(context, object, "path"); !path->IsNullOrUndefined()) {
+        request.path = toStdString(isolate, path);
+    }
+    if (const auto query = getMember(context, object, "query"); !query->IsNullOrUndefined()) {
+        request.query = toStdString(isolate, query);
+    }
+    const auto body = getMember(context, object, "body");
+    if (body->IsString()) {
+        request.body = toStdString(isolate, body);
+    } else if (!body->IsUndefined()) {
+        v8::Local<v8::String> bodyJson;
+        if (v8::JSON::Stringify(context, body).ToLocal(&bodyJson)) {
+            request.body = toStdString(isolate, bodyJson);
+        }
+    }
+    if (const auto headers = getMember(context, object, "headers"); isPlainObject(headers)) {
+        forEachMember(context, headers.As<v8::Object>(),
+                      [&](std::string name, v8::Local<v8::Value> headerValue) {
+                          request.headers.emplace(std::move(name),
+                                                  toStdString(isolate, headerValue));
+                      });
+    }
+    return request;
+}
+
+// `{ status, body, headers }` for the bundle, built as a V8 object.
+v8::Local<v8::Object> bridgeResponseObject(v8::Local<v8::Context> context,
+                                           const BridgeResponse &response) {
+    auto *isolate = context->GetIsolate();
+    auto headers = v8::Object::New(isolate);
+    for (const auto &[headerName, headerValue] : response.headers) {
+        (void)headers->Set(context, toV8String(isolate, headerName),
+                           toV8String(isolate, headerValue))
+            .FromMaybe(false);
+    }
+    auto object = v8::Object::New(isolate);
+    (void)object->Set(context, toV8String(isolate, "status"),
+                      v8::Integer::New(isolate, response.status))
+        .FromMaybe(false);
+    (void)object->Set(context, toV8String(isolate, "body"), toV8String(isolate, response.body))
+        .FromMaybe(false);
+    (void)object->Set(context, toV8String(isolate, "headers"), headers).FromMaybe(false);
+    return object;
+}
+
+BridgeResponse runtimeUnavailableResponse() {
+    BridgeResponse response;
+    response.status = 500;
+    response.body = "Hydra runtime unavailable";
+    return response;
+}
+
+// A promise already settled with `response`; empty when V8 cannot make one,
+// with the exception left pending.
+v8::MaybeLocal<v8::Promise::Resolver> resolvedBridgePromise(v8::Local<v8::Context> context,
+                                                            const BridgeResponse &response) {
+    v8::Local<v8::Promise::Resolver> resolver;
+    if (!v8::Promise::Resolver::New(context).ToLocal(&resolver) ||
+        resolver->Resolve(context, bridgeResponseObject(context, response)).IsNothing()) {
+        return {};
+    }
+    return resolver;
+}
+
+// Reads a `{ html, status, headers, meta, redirect }` object returned by the
+// bundle field by field, with the same rules as tryParseSsrEnvelope().
+SsrRenderResult readEnvelopeObject(v8::Local<v8::Context> context, v8::Local<v8::Object> object) {
+    auto *isolate = context->GetIsolate();
+    SsrEnvelopeFields fields;
+    if (const auto html = getMember(context, object, "html"); html->IsString()) {
+        fields.html = toStdString(isolate, html);
+    }
+    if (const auto status = getMember(context, object, "status"); status->IsNumber()) {
+        fields.status = status.As<v8::Number>()->Value();
+    }
+    if (const auto headers = getMember(context, object, "headers"); isPlainObject(headers)) {
+        forEachMember(context, headers.As<v8::Object>(),
+                      [&](std::string name, v8::Local<v8::Value> value) {
+                          if (value->IsBoolean()) {
+                              fields.headers.emplace_back(std::move(name),
+                                                          value->IsTrue() ? "true" : "false");
+                          } else if (value->IsString() || value->IsNumber()) {
+                              fields.headers.emplace_back(std::move(name),
+                                                          toStdString(isolate, value));
+                          }
+                      });
+    }
+    if (const auto meta = getMember(context, object, "meta"); isPlainObject(meta)) {
+        forEachMember(context, meta.As<v8::Object>(),
+                      [&](std::string key, v8::Local<v8::Value> value) {
+                          if (value->IsString()) {
+                              fields.meta.emplace(std::move(key), toStdString(isolate, value));
+                          }
+                      });
+    }
+    if (const auto redirect = getMember(context, object, "redirect"); redirect->IsString()) {
+        fields.redirect = toStdString(isolate, redirect);
+    }
+    if (const auto props = getMember(context, object, "props"); isPlainObject(props)) {
+        v8::Local<v8::String> propsJson;
+        if (v8::JSON::Stringify(context, props).ToLocal(&propsJson)) {
+            fields.props = toStdString(isolate, propsJson);
+        }
+    }
+    return finishSsrEnvelope(std::move(fields));
 }
 
-std::string toCompactJsonString(const Json::Value &value) {
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "";
-    builder["commentStyle"] = "None";
-    return Json::writeString(builder, value);
+// Memo key: (method, path, query, body). Headers are left out; within one
+// render they come from the same bundle code path.
+std::string bridgeMemoKey(const BridgeRequest &request) {
+    std::string key;
+    key.reserve(request.method.size() + request.path.size() + request.query.size() +
+                request.body.size() + 3);
+    for (const char ch : request.method) {
+        key.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(ch))));
+    }
+    key.push_back('\n');
+    key.append(request.path);
+    key.push_back('\n');
+    key.append(request.query);
+    key.push_back('\n');
+    key.append(request.body);
+    return key;
 }
 
 }  // namespace
 
-V8SsrRuntime::V8SsrRuntime(std::string bundlePath, FetchBridge fetchBridge)
+struct V8SsrRuntime::AsyncBridgeState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    // (call index, response); turned into V8 objects on the render thread.
+    std::vector<std::pair<std::size_t, BridgeResponse>> completed;
+    // Dispatched calls that have not completed yet.
+    std::size_t outstanding = 0;
+};
+
+V8SsrRuntime::V8SsrRuntime(std::string bundlePath,
+                           FetchBridge fetchBridge,
+                           V8RuntimeOptions options)
     : bundlePath_(std::move(bundlePath)),
       fetchBridge_(std::move(fetchBridge)),
-      allocator_(v8::ArrayBuffer::Allocator::NewDefaultAllocator()) {
+      options_(std::move(options)),
+      allocator_(v8::ArrayBuffer::Allocator::NewDefaultAllocator()),
+      bridgeState_(std::make_shared<AsyncBridgeState>()) {
     v8::Isolate::CreateParams createParams;
     createParams.array_buffer_allocator = allocator_.get();
+    createParams.external_references = externalReferences();
+    if (options_.startupSnapshot) {
+        createParams.snapshot_blob = options_.startupSnapshot->blob();
+    }
+    if (options_.maxHeapBytes > 0) {
+        createParams.constraints.ConfigureDefaultsFromHeapSize(0, options_.maxHeapBytes);
+    }
     IsolateCleanup cleanup;
     cleanup.isolate = v8::Isolate::New(createParams);
     isolate_ = cleanup.isolate;
@@ -159,11 +400,21 @@ V8SsrRuntime::V8SsrRuntime(std::string bundlePath, FetchBridge fetchBridge)
             v8::Isolate::Scope isolateScope(isolate_);
             v8::HandleScope handleScope(isolate_);
             auto context = v8::Context::New(isolate_);
+            if (context.IsEmpty()) {
+                throw std::runtime_error("Failed to create V8 context");
+            }
             context_.Reset(isolate_, context);
             isolate_->SetData(0, this);
-            loadBundle();
+            isolate_->AddNearHeapLimitCallback(&V8SsrRuntime::nearHeapLimitCallback, this);
+            if (!options_.startupSnapshot) {
+                loadBundle();
+            }
+            sampleHeap();
+            baselineHeapUsedBytes_.store(heapUsedBytes_.load(std::memory_order_relaxed),
+                                         std::memory_order_relaxed);
         }
 
+        deadlineSlot_ = RenderDeadlineScheduler::instance().registerIsolate(isolate_);
         cleanup.isolate = nullptr;
     } catch (...) {
         // Ensure the global context handle is released before isolate cleanup.
@@ -173,6 +424,10 @@ V8SsrRuntime::V8SsrRuntime(std::string bundlePath, FetchBridge fetchBridge)
 }
 
 V8SsrRuntime::~V8SsrRuntime() {
+    if (deadlineSlot_) {
+        RenderDeadlineScheduler::instance().unregisterIsolate(deadlineSlot_);
+        deadlineSlot_.reset();
+    }
     context_.Reset();
     if (isolate_ != nullptr) {
         isolate_->Dispose();
@@ -183,47 +438,95 @@ V8SsrRuntime::~V8SsrRuntime() {
 void V8SsrRuntime::hydraFetchCallback(
     const v8::FunctionCallbackInfo<v8::Value> &info) {
     auto *isolate = info.GetIsolate();
+    auto context = isolate->GetCurrentContext();
     auto *runtime = static_cast<V8SsrRuntime *>(isolate->GetData(0));
     if (runtime == nullptr) {
-        info.GetReturnValue().Set(toV8String(
-            isolate,
-            R"({"status":500,"body":"Hydra runtime unavailable"})"));
+        info.GetReturnValue().Set(bridgeResponseObject(context, runtimeUnavailableResponse()));
         return;
     }
 
-    std::string requestJson = "{}";
-    if (info.Length() > 0) {
-        v8::String::Utf8Value requestUtf8(isolate, info[0]);
-        if (*requestUtf8) {
-            requestJson = *requestUtf8;
+    const auto request = readBridgeRequest(context, info);
+    ++runtime->bridgeStats_.syncCalls;
+    std::string memoKey;
+    if (runtime->options_.bridgeMemoize) {
+        memoKey = bridgeMemoKey(request);
+        const auto memo = runtime->bridgeMemo_.find(memoKey);
+        if (memo != runtime->bridgeMemo_.end() &&
+            runtime->bridgeCalls_[memo->second].settled) {
+            ++runtime->bridgeStats_.memoized;
+            // A fresh object, so one caller mutating it cannot leak into
+            // another's.
+            info.GetReturnValue().Set(
+                bridgeResponseObject(context, runtime->bridgeCalls_[memo->second].response));
+            return;
         }
     }
 
-    BridgeRequest request;
-    Json::Value parsedRequest;
-    if (parseJsonString(requestJson, &parsedRequest) && parsedRequest.isObject()) {
-        request.method = parsedRequest.get("method", "GET").asString();
-        request.path = parsedRequest.get("path", "").asString();
-        request.query = parsedRequest.get("query", "").asString();
-        if (parsedRequest.isMember("body")) {
-            if (parsedRequest["body"].isString()) {
-                request.body = parsedRequest["body"].asString();
-            } else {
-                request.body = toCompactJsonString(parsedRequest["body"]);
-            }
+    auto response = runtime->callFetchBridge(request);
+    info.GetReturnValue().Set(bridgeResponseObject(context, response));
+    // A call of the same key still in flight keeps its own entry.
+    if (runtime->options_.bridgeMemoize &&
+        runtime->bridgeMemo_.find(memoKey) == runtime->bridgeMemo_.end()) {
+        runtime->bridgeMemo_.emplace(std::move(memoKey), runtime->bridgeCalls_.size());
+        auto &call = runtime->bridgeCalls_.emplace_back();
+        call.response = std::move(response);
+        call.settled = true;
+    }
+}
+
+// __hydraFetchAsync(request): a promise for the response object. The call
+// is queued and dispatched when the render yields to the host.
+void V8SsrRuntime::hydraFetchAsyncCallback(
+    const v8::FunctionCallbackInfo<v8::Value> &info) {
+    auto *isolate = info.GetIsolate();
+    auto context = isolate->GetCurrentContext();
+    auto *runtime = static_cast<V8SsrRuntime *>(isolate->GetData(0));
+    v8::Local<v8::Promise::Resolver> resolver;
+    if (runtime == nullptr) {
+        if (resolvedBridgePromise(context, runtimeUnavailableResponse()).ToLocal(&resolver)) {
+            info.GetReturnValue().Set(resolver->GetPromise());
         }
-        if (parsedRequest.isMember("headers") && parsedRequest["headers"].isObject()) {
-            for (const auto &headerName : parsedRequest["headers"].getMemberNames()) {
-                request.headers.emplace(headerName,
-                                        parsedRequest["headers"][headerName].asString());
+        return;
+    }
+
+    auto request = readBridgeRequest(context, info);
+    ++runtime->bridgeStats_.asyncCalls;
+    std::string memoKey;
+    if (runtime->options_.bridgeMemoize) {
+        memoKey = bridgeMemoKey(request);
+        const auto memo = runtime->bridgeMemo_.find(memoKey);
+        if (memo != runtime->bridgeMemo_.end()) {
+            ++runtime->bridgeStats_.memoized;
+            auto &call = runtime->bridgeCalls_[memo->second];
+            if (call.resolver.IsEmpty()) {
+                // Only made synchronously so far; its response is at hand.
+                if (!resolvedBridgePromise(context, call.response).ToLocal(&resolver)) {
+                    return;
+                }
+                call.resolver.Reset(isolate, resolver);
             }
+            info.GetReturnValue().Set(call.resolver.Get(isolate)->GetPromise());
+            return;
         }
     }
 
+    if (!v8::Promise::Resolver::New(context).ToLocal(&resolver)) {
+        return;
+    }
+    const auto index = runtime->bridgeCalls_.size();
+    runtime->bridgeCalls_.emplace_back().resolver.Reset(isolate, resolver);
+    if (runtime->options_.bridgeMemoize) {
+        runtime->bridgeMemo_.emplace(std::move(memoKey), index);
+    }
+    runtime->bridgeQueued_.emplace_back(index, std::move(request));
+    info.GetReturnValue().Set(resolver->GetPromise());
+}
+
+V8SsrRuntime::BridgeResponse V8SsrRuntime::callFetchBridge(const BridgeRequest &request) const {
     BridgeResponse response;
     try {
-        if (runtime->fetchBridge_) {
-            response = runtime->fetchBridge_(request);
+        if (fetchBridge_) {
+            response = fetchBridge_(request);
         } else {
             response.status = 501;
             response.body = "Hydra API bridge is not configured";
@@ -235,17 +538,240 @@ void V8SsrRuntime::hydraFetchCallback(
         response.status = 500;
         response.body = "Unknown Hydra API bridge error";
     }
+    return response;
+}
 
-    Json::Value responseJson(Json::objectValue);
-    responseJson["status"] = response.status;
-    responseJson["body"] = response.body;
-    Json::Value responseHeaders(Json::objectValue);
-    for (const auto &[headerName, headerValue] : response.headers) {
-        responseHeaders[headerName] = headerValue;
+void V8SsrRuntime::flushBridgeCalls(v8::Local<v8::Context> context) {
+    if (bridgeQueued_.empty()) {
+        return;
+    }
+    auto queued = std::move(bridgeQueued_);
+    bridgeQueued_.clear();
+
+    if (!options_.bridgeDispatcher) {
+        for (const auto &[index, request] : queued) {
+            settleBridgeCall(context, index, callFetchBridge(request));
+        }
+        return;
     }
-    responseJson["headers"] = std::move(responseHeaders);
 
-    info.GetReturnValue().Set(toV8String(isolate, toCompactJsonString(responseJson)));
+    std::vector<std::size_t> indices;
+    std::vector<BridgeRequest> requests;
+    indices.reserve(queued.size());
+    requests.reserve(queued.size());
+    for (auto &[index, request] : queued) {
+        indices.push_back(index);
+        requests.push_back(std::move(request));
+    }
+    {
+        std::lock_guard<std::mutex> lock(bridgeState_->mutex);
+        bridgeState_->outstanding += requests.size();
+    }
+    bridgeStats_.batches += static_cast<std::uint32_t>(options_.bridgeDispatcher->dispatch(
+        std::move(requests),
+        [state = bridgeState_, indices = std::move(indices)](std::size_t position,
+                                                             BridgeResponse response) {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->completed.emplace_back(indices[position], std::move(response));
+                --state->outstanding;
+            }
+            state->cv.notify_all();
+        }));
+}
+
+V8SsrRuntime::BridgeWait V8SsrRuntime::awaitBridgeCalls(
+    v8::Local<v8::Context> context,
+    std::chrono::steady_clock::time_point deadline) {
+    std::vector<std::pair<std::size_t, BridgeResponse>> completed;
+    {
+        std::unique_lock<std::mutex> lock(bridgeState_->mutex);
+        auto &state = *bridgeState_;
+        if (state.completed.empty() && state.outstanding == 0) {
+            return BridgeWait::kIdle;
+        }
+        const auto ready = [&state] { return !state.completed.empty() || state.outstanding == 0; };
+        const auto waitStartedAt = std::chrono::steady_clock::now();
+        bool settled = true;
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            state.cv.wait(lock, ready);
+        } else {
+            settled = state.cv.wait_until(lock, deadline, ready);
+        }
+        bridgeStats_.waitUs += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - waitStartedAt)
+                .count());
+        if (!settled) {
+            return BridgeWait::kTimedOut;
+        }
+        completed.swap(state.completed);
+    }
+    for (auto &[index, response] : completed) {
+        settleBridgeCall(context, index, std::move(response));
+    }
+    return BridgeWait::kResolved;
+}
+
+void V8SsrRuntime::settleBridgeCall(v8::Local<v8::Context> context,
+                                    std::size_t index,
+                                    BridgeResponse response) {
+    auto &call = bridgeCalls_[index];
+    call.settled = true;
+    if (!call.resolver.IsEmpty() &&
+        call.resolver.Get(isolate_)
+            ->Resolve(context, bridgeResponseObject(context, response))
+            .IsNothing()) {
+        throw std::runtime_error("Unable to resolve Hydra API bridge promise");
+    }
+    call.response = std::move(response);
+}
+
+void V8SsrRuntime::resetBridgeCalls() {
+    {
+        // Workers may still be running calls of an abandoned render; they
+        // reach into the active trace, so the render cannot return first.
+        std::unique_lock<std::mutex> lock(bridgeState_->mutex);
+        auto &state = *bridgeState_;
+        state.cv.wait(lock, [&state] { return state.outstanding == 0; });
+        state.completed.clear();
+    }
+    bridgeCalls_.clear();
+    bridgeMemo_.clear();
+    bridgeQueued_.clear();
+}
+
+bool V8SsrRuntime::fromSnapshot() const {
+    return options_.startupSnapshot != nullptr;
+}
+
+V8SsrRuntime::HeapSample V8SsrRuntime::heapSample() const {
+    HeapSample sample;
+    sample.usedBytes = heapUsedBytes_.load(std::memory_order_relaxed);
+    sample.totalBytes = heapTotalBytes_.load(std::memory_order_relaxed);
+    sample.limitBytes = heapLimitBytes_.load(std::memory_order_relaxed);
+    sample.externalBytes = externalBytes_.load(std::memory_order_relaxed);
+    sample.mallocedBytes = mallocedBytes_.load(std::memory_order_relaxed);
+    return sample;
+}
+
+std::uint64_t V8SsrRuntime::renderCount() const {
+    return renderCount_.load(std::memory_order_relaxed);
+}
+
+bool V8SsrRuntime::rendersSinceGc() const {
+    return renderCount_.load(std::memory_order_relaxed) !=
+           rendersAtLastGc_.load(std::memory_order_relaxed);
+}
+
+const BridgeRenderStats &V8SsrRuntime::lastBridgeStats() const {
+    return bridgeStats_;
+}
+
+V8SsrRuntime::RecycleReason V8SsrRuntime::recycleReason() const {
+    if (heapLimitReached_.load(std::memory_order_relaxed)) {
+        return RecycleReason::kHeapLimit;
+    }
+    if (options_.recycleAfterRenders > 0 &&
+        renderCount_.load(std::memory_order_relaxed) >= options_.recycleAfterRenders) {
+        return RecycleReason::kRenderCount;
+    }
+    if (options_.recycleHeapGrowthPercent > 0) {
+        // Prefer the post-GC reading: right after a render the heap still
+        // holds that render's garbage.
+        const auto postGc = postGcHeapUsedBytes_.load(std::memory_order_relaxed);
+        const auto live = postGc > 0 ? postGc : heapUsedBytes_.load(std::memory_order_relaxed);
+        const auto baseline = baselineHeapUsedBytes_.load(std::memory_order_relaxed);
+        if (baseline > 0 &&
+            live * 100 > baseline * (100 + options_.recycleHeapGrowthPercent)) {
+            return RecycleReason::kHeapGrowth;
+        }
+    }
+    return RecycleReason::kNone;
+}
+
+void V8SsrRuntime::collectGarbage() {
+    v8::Locker locker(isolate_);
+    v8::Isolate::Scope isolateScope(isolate_);
+    isolate_->LowMemoryNotification();
+    sampleHeap();
+    postGcHeapUsedBytes_.store(heapUsedBytes_.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+    rendersAtLastGc_.store(renderCount_.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+}
+
+void V8SsrRuntime::finishWarmup() {
+    collectGarbage();
+    // The warmed heap holds optimized code and inline caches a fresh one
+    // does not; growth is measured from here.
+    baselineHeapUsedBytes_.store(heapUsedBytes_.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+    renderCount_.store(0, std::memory_order_relaxed);
+    rendersAtLastGc_.store(0, std::memory_order_relaxed);
+}
+
+void V8SsrRuntime::sampleHeap() {
+    v8::HeapStatistics stats;
+    isolate_->GetHeapStatistics(&stats);
+    heapUsedBytes_.store(stats.used_heap_size(), std::memory_order_relaxed);
+    heapTotalBytes_.store(stats.total_heap_size(), std::memory_order_relaxed);
+    heapLimitBytes_.store(stats.heap_size_limit(), std::memory_order_relaxed);
+    externalBytes_.store(stats.external_memory(), std::memory_order_relaxed);
+    mallocedBytes_.store(stats.malloced_memory(), std::memory_order_relaxed);
+}
+
+std::size_t V8SsrRuntime::nearHeapLimitCallback(void *data,
+                                                std::size_t currentHeapLimit,
+                                                std::size_t /*initialHeapLimit*/) {
+    auto *runtime = static_cast<V8SsrRuntime *>(data);
+    runtime->heapLimitReached_.store(true, std::memory_order_relaxed);
+    runtime->isolate_->TerminateExecution();
+    return currentHeapLimit + std::max(currentHeapLimit / 8, kHeapLimitHeadroomBytes);
+}
+
+const intptr_t *V8SsrRuntime::externalReferences() {
+    static const intptr_t kExternalReferences[] = {
+        reinterpret_cast<intptr_t>(&V8SsrRuntime::hydraFetchCallback),
+        reinterpret_cast<intptr_t>(&V8SsrRuntime::hydraFetchAsyncCallback),
+        reinterpret_cast<intptr_t>(&V8SsrRuntime::requestDetailCallback),
+        0,
+    };
+    return kExternalReferences;
+}
+
+std::string V8SsrRuntime::createStartupSnapshotBlob(const std::string &bundlePath,
+                                                    const std::string &bundleSource) {
+    std::unique_ptr<v8::ArrayBuffer::Allocator> allocator(
+        v8::ArrayBuffer::Allocator::NewDefaultAllocator());
+    v8::Isolate::CreateParams createParams;
+    createParams.array_buffer_allocator = allocator.get();
+    createParams.external_references = externalReferences();
+
+    v8::StartupData blob{nullptr, 0};
+    {
+        v8::SnapshotCreator creator(createParams);
+        auto *isolate = creator.GetIsolate();
+        {
+            v8::HandleScope handleScope(isolate);
+            auto context = v8::Context::New(isolate);
+            prepareContext(isolate, context, bundlePath, bundleSource, nullptr);
+            // Settle promises queued during bundle evaluation; pending
+            // microtasks cannot be serialized.
+            isolate->PerformMicrotaskCheckpoint();
+            creator.SetDefaultContext(context);
+        }
+        blob = creator.CreateBlob(v8::SnapshotCreator::FunctionCodeHandling::kKeep);
+    }
+
+    if (blob.data == nullptr || blob.raw_size <= 0) {
+        delete[] blob.data;
+        throw std::runtime_error("Failed to serialize V8 startup snapshot for " + bundlePath);
+    }
+
+    std::string serialized(blob.data, static_cast<std::size_t>(blob.raw_size));
+    delete[] blob.data;
+    return serialized;
 }
 
 void V8SsrRuntime::loadBundle() {
@@ -254,18 +780,49 @@ void V8SsrRuntime::loadBundle() {
     v8::Locker locker(isolate_);
     v8::Isolate::Scope isolateScope(isolate_);
     v8::HandleScope handleScope(isolate_);
-    auto context = context_.Get(isolate_);
+    prepareContext(isolate_,
+                   context_.Get(isolate_),
+                   bundlePath_,
+                   bundleSource,
+                   options_.codeCache.get());
+}
+
+void V8SsrRuntime::prepareContext(v8::Isolate *isolate,
+                                  v8::Local<v8::Context> context,
+                                  const std::string &bundlePath,
+                                  const std::string &bundleSource,
+                                  V8CodeCache *codeCache) {
     v8::Context::Scope contextScope(context);
-    v8::TryCatch tryCatch(isolate_);
+    v8::TryCatch tryCatch(isolate);
 
     auto fetchFunction = v8::Function::New(context, &V8SsrRuntime::hydraFetchCallback);
     if (fetchFunction.IsEmpty() ||
         !context->Global()
-             ->Set(context, toV8String(isolate_, "__hydraFetch"), fetchFunction.ToLocalChecked())
+             ->Set(context, toV8String(isolate, "__hydraFetch"), fetchFunction.ToLocalChecked())
              .FromMaybe(false)) {
         throw std::runtime_error("Failed to install Hydra API bridge function");
     }
 
+    auto fetchAsyncFunction = v8::Function::New(context, &V8SsrRuntime::hydraFetchAsyncCallback);
+    if (fetchAsyncFunction.IsEmpty() ||
+        !context->Global()
+             ->Set(context,
+                   toV8String(isolate, "__hydraFetchAsync"),
+                   fetchAsyncFunction.ToLocalChecked())
+             .FromMaybe(false)) {
+        throw std::runtime_error("Failed to install Hydra async API bridge function");
+    }
+
+    auto requestDetailFunction = v8::Function::New(context, &V8SsrRuntime::requestDetailCallback);
+    if (requestDetailFunction.IsEmpty() ||
+        !context->Global()
+             ->Set(context,
+                   toV8String(isolate, "__hydraRequestDetail"),
+                   requestDetailFunction.ToLocalChecked())
+             .FromMaybe(false)) {
+        throw std::runtime_error("Failed to install Hydra request detail function");
+    }
+
     const char *bootstrapSource = R"(
 if (typeof globalThis.global === "undefined") globalThis.global = globalThis;
 if (typeof globalThis.self === "undefined") globalThis.self = globalThis;
@@ -316,41 +873,70 @@ if (typeof globalThis.hydra === "undefined") {
   globalThis.hydra = {};
 }
 if (typeof globalThis.hydra.fetch !== "function") {
-  globalThis.hydra.fetch = (request = {}) => {
-    const payload = typeof request === "string" ? request : JSON.stringify(request);
-    const raw = globalThis.__hydraFetch(payload);
-    if (typeof raw === "string") {
-      try {
-        return JSON.parse(raw);
-      } catch {
-        return { status: 500, body: "Invalid bridge response", headers: {} };
-      }
-    }
-    return raw;
-  };
+  globalThis.hydra.fetch = (request = {}) => globalThis.__hydraFetch(request);
+}
+if (typeof globalThis.hydra.fetchAsync !== "function") {
+  globalThis.hydra.fetchAsync = (request = {}) => globalThis.__hydraFetchAsync(request);
 }
 if (typeof globalThis.fetch !== "function") {
-  globalThis.fetch = (request = {}) => Promise.resolve(globalThis.hydra.fetch(request));
+  globalThis.fetch = (request = {}) => globalThis.hydra.fetchAsync(request);
 }
 )";
     v8::Local<v8::Script> bootstrapScript;
-    if (!v8::Script::Compile(context, toV8String(isolate_, bootstrapSource))
+    if (!v8::Script::Compile(context, toV8String(isolate, bootstrapSource))
              .ToLocal(&bootstrapScript) ||
         bootstrapScript->Run(context).IsEmpty()) {
         throw std::runtime_error("Failed to run V8 bootstrap script: " +
-                                 formatException(isolate_, tryCatch));
+                                 formatException(isolate, tryCatch));
+    }
+
+    V8CodeCache::Entry cacheEntry;
+    if (codeCache != nullptr) {
+        cacheEntry = codeCache->lookup(bundleSource);
     }
 
-    auto source = toV8String(isolate_, bundleSource);
+    // `source` owns the CachedData wrapper; the bytes stay owned by
+    // cacheEntry.data, which outlives the compile below.
+    v8::ScriptCompiler::CachedData *cachedData = nullptr;
+    if (cacheEntry.data) {
+        cachedData = new v8::ScriptCompiler::CachedData(
+            reinterpret_cast<const std::uint8_t *>(cacheEntry.data->data()),
+            static_cast<int>(cacheEntry.data->size()),
+            v8::ScriptCompiler::CachedData::BufferNotOwned);
+    }
+    v8::ScriptOrigin origin(toV8String(isolate, bundlePath));
+    v8::ScriptCompiler::Source source(toV8String(isolate, bundleSource), origin, cachedData);
+    const auto compileOptions = cachedData != nullptr
+                                    ? v8::ScriptCompiler::kConsumeCodeCache
+                                    : v8::ScriptCompiler::kNoCompileOptions;
+
     v8::Local<v8::Script> script;
-    if (!v8::Script::Compile(context, source).ToLocal(&script)) {
+    if (!v8::ScriptCompiler::Compile(context, &source, compileOptions).ToLocal(&script)) {
         throw std::runtime_error("Failed to compile SSR bundle: " +
-                                 formatException(isolate_, tryCatch));
+                                 formatException(isolate, tryCatch));
+    }
+
+    bool cacheAccepted = false;
+    if (cachedData != nullptr) {
+        cacheAccepted = !source.GetCachedData()->rejected;
+        codeCache->recordConsumed(cacheEntry.key, cacheAccepted);
     }
 
     if (script->Run(context).IsEmpty()) {
         throw std::runtime_error("Failed to run SSR bundle: " +
-                                 formatException(isolate_, tryCatch));
+                                 formatException(isolate, tryCatch));
+    }
+
+    // Produced after the top-level run so functions compiled lazily during
+    // bundle evaluation are included in the cache.
+    if (codeCache != nullptr && !cacheAccepted) {
+        std::unique_ptr<v8::ScriptCompiler::CachedData> produced(
+            v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript()));
+        if (produced && produced->data != nullptr && produced->length > 0) {
+            codeCache->store(cacheEntry.key,
+                             std::string(reinterpret_cast<const char *>(produced->data),
+                                         static_cast<std::size_t>(produced->length)));
+        }
     }
 }
 
@@ -358,49 +944,317 @@ std::string V8SsrRuntime::render(const std::string &url,
                                  const std::string &propsJson,
                                  const std::string &requestContextJson,
                                  std::uint64_t timeoutMs) {
+    return invokeRender(url,
+                        std::make_shared<const std::string>(propsJson),
+                        requestContextJson,
+                        timeoutMs,
+                        nullptr,
+                        nullptr,
+                        false)
+        .text;
+}
+
+std::string V8SsrRuntime::render(const std::string &url,
+                                 const PropsPayload &propsJson,
+                                 const std::string &requestContextJson,
+                                 std::uint64_t timeoutMs) {
+    return invokeRender(url, propsJson, requestContextJson, timeoutMs, nullptr, nullptr, false)
+        .text;
+}
+
+V8SsrRuntime::RenderOutput V8SsrRuntime::renderOutput(const std::string &url,
+                                                      const PropsPayload &propsJson,
+                                                      const std::string &requestContextJson,
+                                                      std::uint64_t timeoutMs) {
+    return invokeRender(url, propsJson, requestContextJson, timeoutMs, nullptr, nullptr, true);
+}
+
+V8SsrRuntime::RenderOutput V8SsrRuntime::renderFragmentOutput(
+    const std::string &url,
+    const PropsPayload &propsJson,
+    const std::string &requestContextJson,
+    const std::string &componentId,
+    std::uint64_t timeoutMs) {
+    return invokeRender(url, propsJson, requestContextJson, timeoutMs, nullptr, &componentId, true);
+}
+
+std::string V8SsrRuntime::renderStream(const std::string &url,
+                                       const std::string &propsJson,
+                                       const std::string &requestContextJson,
+                                       std::uint64_t timeoutMs,
+                                       const ChunkSink &sink) {
+    return invokeRender(url,
+                        std::make_shared<const std::string>(propsJson),
+                        requestContextJson,
+                        timeoutMs,
+                        &sink,
+                        nullptr,
+                        false)
+        .text;
+}
+
+std::string V8SsrRuntime::renderStream(const std::string &url,
+                                       const PropsPayload &propsJson,
+                                       const std::string &requestContextJson,
+                                       std::uint64_t timeoutMs,
+                                       const ChunkSink &sink) {
+    return invokeRender(url, propsJson, requestContextJson, timeoutMs, &sink, nullptr, false)
+        .text;
+}
+
+V8SsrRuntime::RenderOutput V8SsrRuntime::renderStreamOutput(
+    const std::string &url,
+    const PropsPayload &propsJson,
+    const std::string &requestContextJson,
+    std::uint64_t timeoutMs,
+    const ChunkSink &sink) {
+    return invokeRender(url, propsJson, requestContextJson, timeoutMs, &sink, nullptr, true);
+}
+
+// __hydraRequestDetail(name): JSON for a lazy __hydra_request field of the
+// request being rendered on this thread, or undefined.
+void V8SsrRuntime::requestDetailCallback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+    auto *isolate = info.GetIsolate();
+    if (info.Length() == 0) {
+        return;
+    }
+    v8::String::Utf8Value nameUtf8(isolate, info[0]);
+    if (*nameUtf8 == nullptr) {
+        return;
+    }
+    const auto detail = RequestContextBuilder::activeDetailJson(
+        std::string_view(*nameUtf8, static_cast<std::size_t>(nameUtf8.length())));
+    if (detail.has_value()) {
+        info.GetReturnValue().Set(toV8String(isolate, *detail));
+    }
+}
+
+void V8SsrRuntime::streamChunkCallback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+    auto *isolate = info.GetIsolate();
+    auto *runtime = static_cast<V8SsrRuntime *>(isolate->GetData(0));
+    // A bundle that keeps `write` around past its render gets a no-op.
+    if (runtime == nullptr || runtime->activeChunkSink_ == nullptr || info.Length() == 0 ||
+        info[0]->IsNullOrUndefined()) {
+        return;
+    }
+
+    std::string chunk;
+    if (info[0]->IsArrayBufferView()) {
+        auto view = info[0].As<v8::ArrayBufferView>();
+        chunk.resize(view->ByteLength());
+        view->CopyContents(chunk.data(), chunk.size());
+    } else {
+        v8::String::Utf8Value chunkUtf8(isolate, info[0]);
+        if (*chunkUtf8 == nullptr) {
+            return;
+        }
+        chunk.assign(*chunkUtf8, static_cast<std::size_t>(chunkUtf8.length()));
+    }
+    if (chunk.empty()) {
+        return;
+    }
+
+    if (!(*runtime->activeChunkSink_)(chunk)) {
+        runtime->streamAborted_ = true;
+        isolate->ThrowException(
+            v8::Exception::Error(toV8String(isolate, "Hydra SSR stream closed")));
+    }
+}
+
+V8SsrRuntime::RenderOutput V8SsrRuntime::invokeRender(const std::string &url,
+                                                      const PropsPayload &propsJson,
+                                                      const std::string &requestContextJson,
+                                                      std::uint64_t timeoutMs,
+                                                      const ChunkSink *sink,
+                                                      const std::string *componentId,
+                                                      bool readEnvelope) {
     v8::Locker locker(isolate_);
     v8::Isolate::Scope isolateScope(isolate_);
     v8::HandleScope handleScope(isolate_);
     auto context = context_.Get(isolate_);
     v8::Context::Scope contextScope(context);
+    // Declared before the TryCatch so it runs last, after handles unwind.
+    struct RenderAccounting {
+        V8SsrRuntime *runtime;
+        ~RenderAccounting() {
+            runtime->renderCount_.fetch_add(1, std::memory_order_relaxed);
+            runtime->sampleHeap();
+        }
+    } renderAccounting{this};
+    // Calls left over from bundle evaluation are dropped; this render's are
+    // waited out on every exit path.
+    resetBridgeCalls();
+    bridgeStats_ = {};
+    struct BridgeCallsReset {
+        V8SsrRuntime *runtime;
+        ~BridgeCallsReset() {
+            runtime->resetBridgeCalls();
+        }
+    } bridgeCallsReset{this};
     v8::TryCatch tryCatch(isolate_);
-    RenderWatchdog watchdog(isolate_, timeoutMs);
+    const auto deadlineAt = timeoutMs > 0 ? std::chrono::steady_clock::now() +
+                                                std::chrono::milliseconds(timeoutMs)
+                                          : std::chrono::steady_clock::time_point::max();
+    RenderDeadlineGuard deadline(deadlineSlot_.get(), timeoutMs);
 
-    auto renderName = toV8String(isolate_, "render");
+    // Bundles without renderStream keep working in streaming mode; their
+    // whole render() output is returned for the caller to emit.
     v8::Local<v8::Value> renderValue;
-    if (!context->Global()->Get(context, renderName).ToLocal(&renderValue) ||
-        !renderValue->IsFunction()) {
+    bool streaming = false;
+    if (sink != nullptr) {
+        streaming = context->Global()
+                        ->Get(context, toV8String(isolate_, "renderStream"))
+                        .ToLocal(&renderValue) &&
+                    renderValue->IsFunction();
+    }
+    if (componentId != nullptr) {
+        if (!context->Global()
+                 ->Get(context, toV8String(isolate_, "renderFragment"))
+                 .ToLocal(&renderValue) ||
+            !renderValue->IsFunction()) {
+            throw std::runtime_error(
+                "SSR bundle missing globalThis.renderFragment(url, propsJson, "
+                "requestContextJson, componentId)");
+        }
+    } else if (!streaming &&
+               (!context->Global()
+                     ->Get(context, toV8String(isolate_, "render"))
+                     .ToLocal(&renderValue) ||
+                !renderValue->IsFunction())) {
         throw std::runtime_error(
             "SSR bundle missing globalThis.render(url, propsJson, requestContextJson)");
     }
 
     auto renderFunc = v8::Local<v8::Function>::Cast(renderValue);
-    v8::Local<v8::Value> args[3] = {
+    v8::Local<v8::Value> args[4] = {
         toV8String(isolate_, url),
-        toV8String(isolate_, propsJson),
+        toV8Payload(isolate_, propsJson),
         toV8String(isolate_, requestContextJson),
+        v8::Undefined(isolate_),
     };
+    int argc = 3;
+    if (streaming) {
+        v8::Local<v8::Function> writeFunction;
+        if (!v8::Function::New(context, &V8SsrRuntime::streamChunkCallback)
+                 .ToLocal(&writeFunction)) {
+            throw std::runtime_error("Failed to create SSR stream writer");
+        }
+        args[argc++] = writeFunction;
+    } else if (componentId != nullptr) {
+        args[argc++] = toV8String(isolate_, *componentId);
+    }
+
+    struct ActiveSinkReset {
+        V8SsrRuntime *runtime;
+        ~ActiveSinkReset() {
+            runtime->activeChunkSink_ = nullptr;
+        }
+    } activeSinkReset{this};
+    activeChunkSink_ = streaming ? sink : nullptr;
+    streamAborted_ = false;
 
     v8::Local<v8::Value> result;
-    if (!renderFunc
-             ->Call(context, context->Global(), static_cast<int>(std::size(args)), args)
-             .ToLocal(&result)) {
-        if (tryCatch.HasTerminated()) {
+    bool called =
+        renderFunc->Call(context, context->Global(), argc, args).ToLocal(&result);
+
+    // A returned promise is run to completion by a minimal event loop:
+    // drain microtasks, hand queued bridge calls to the dispatcher, then
+    // block for responses and resolve them, until nothing is left that
+    // could settle it.
+    std::string rejection;
+    bool bridgeTimedOut = false;
+    if (called && result->IsPromise()) {
+        auto promise = result.As<v8::Promise>();
+        for (;;) {
+            isolate_->PerformMicrotaskCheckpoint();
+            if (isolate_->IsExecutionTerminating() ||
+                promise->State() != v8::Promise::kPending) {
+                break;
+            }
+            if (!bridgeQueued_.empty()) {
+                flushBridgeCalls(context);
+                continue;
+            }
+            const auto wait = awaitBridgeCalls(context, deadlineAt);
+            if (wait == BridgeWait::kIdle) {
+                break;
+            }
+            if (wait == BridgeWait::kTimedOut) {
+                bridgeTimedOut = true;
+                break;
+            }
+        }
+        const char *entryName =
+            streaming ? "renderStream" : (componentId != nullptr ? "renderFragment" : "render");
+        if (bridgeTimedOut || isolate_->IsExecutionTerminating()) {
+            called = false;
+        } else if (promise->State() == v8::Promise::kRejected) {
+            v8::String::Utf8Value reason(isolate_, promise->Result());
+            rejection = *reason ? *reason : std::string(entryName) + " promise rejected";
+            called = false;
+        } else if (promise->State() == v8::Promise::kPending) {
+            rejection = std::string(entryName) + " promise did not settle";
+            called = false;
+        } else {
+            result = promise->Result();
+        }
+    }
+
+    const bool deadlineFired = deadline.finish();
+    if (!called) {
+        if (bridgeTimedOut || tryCatch.HasTerminated() || isolate_->IsExecutionTerminating()) {
             isolate_->CancelTerminateExecution();
+            if (heapLimitReached_.load(std::memory_order_relaxed)) {
+                throw std::runtime_error("SSR render exceeded heap limit of " +
+                                         std::to_string(heapLimitBytes_.load(
+                                             std::memory_order_relaxed) >> 20) +
+                                         "MB");
+            }
             throw std::runtime_error("SSR render exceeded timeout of " +
                                      std::to_string(timeoutMs) + "ms");
         }
+        if (streamAborted_) {
+            throw std::runtime_error("SSR stream closed by client");
+        }
         throw std::runtime_error("SSR render threw exception: " +
-                                 formatException(isolate_, tryCatch));
+                                 (rejection.empty() ? formatException(isolate_, tryCatch)
+                                                    : rejection));
+    }
+    if (deadlineFired || heapLimitReached_.load(std::memory_order_relaxed)) {
+        // The deadline or heap limit hit just after render() returned; drop
+        // the pending termination so it cannot leak into the next render.
+        isolate_->CancelTerminateExecution();
+    }
+
+    RenderOutput output;
+    if (streaming && result->IsNullOrUndefined()) {
+        return output;
     }
 
+    // An envelope returned as a plain object is read through the V8 API,
+    // sparing the stringify/parse round trip of its html; the string
+    // entry points get it as JSON, as if the bundle had stringified it.
     v8::Local<v8::String> resultString;
-    if (!result->ToString(context).ToLocal(&resultString)) {
+    if (result->IsObject() && !result->IsStringObject() &&
+        result.As<v8::Object>()->Has(context, toV8String(isolate_, "html")).FromMaybe(false)) {
+        if (readEnvelope) {
+            output.envelope = readEnvelopeObject(context, result.As<v8::Object>());
+            if (tryCatch.HasCaught()) {
+                throw std::runtime_error("SSR render envelope threw exception: " +
+                                         formatException(isolate_, tryCatch));
+            }
+            return output;
+        }
+        if (!v8::JSON::Stringify(context, result).ToLocal(&resultString)) {
+            throw std::runtime_error("SSR render envelope is not serializable: " +
+                                     formatException(isolate_, tryCatch));
+        }
+    } else if (!result->ToString(context).ToLocal(&resultString)) {
         throw std::runtime_error("SSR render did not return a string");
     }
 
-    v8::String::Utf8Value utf8(isolate_, resultString);
-    return *utf8 ? *utf8 : std::string();
+    output.text = toStdString(isolate_, resultString);
+    return output;
 }
 
 }  // namespace hydra
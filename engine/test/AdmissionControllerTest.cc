@@ -0,0 +1,131 @@
+#include "hydra/AdmissionController.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using hydra::AdmissionController;
+using hydra::RequestPriority;
+using hydra::ShedAction;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+AdmissionController::Options makeOptions() {
+    AdmissionController::Options options;
+    options.initialRenderUs = 10000;
+    options.policies[static_cast<std::size_t>(RequestPriority::kHigh)] = {40000,
+                                                                         ShedAction::kShell};
+    options.policies[static_cast<std::size_t>(RequestPriority::kNormal)] = {20000,
+                                                                           ShedAction::kShell};
+    options.policies[static_cast<std::size_t>(RequestPriority::kLow)] = {5000,
+                                                                        ShedAction::kReject};
+    return options;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            AdmissionController admission(makeOptions());
+            std::vector<AdmissionController::Ticket> held;
+            // Two runtimes: the first two renders start right away.
+            for (int i = 0; i < 2; ++i) {
+                auto ticket = admission.admit(RequestPriority::kNormal, 2);
+                expectTrue(static_cast<bool>(ticket) && ticket.expectedWaitUs() == 0,
+                           "free runtimes admit without wait");
+                held.push_back(std::move(ticket));
+            }
+            expectTrue(admission.expectedWaitUs(2) == 5000, "third waits half a render");
+
+            auto bot = admission.admit(RequestPriority::kLow, 2);
+            expectTrue(static_cast<bool>(bot), "low admitted at its budget");
+            held.push_back(std::move(bot));
+            auto lateBot = admission.admit(RequestPriority::kLow, 2);
+            expectTrue(!lateBot && lateBot.expectedWaitUs() == 10000, "low shed over budget");
+            expectTrue(admission.stats().inFlight == 3, "shed does not hold a slot");
+
+            for (int i = 0; i < 3; ++i) {
+                auto ticket = admission.admit(RequestPriority::kNormal, 2);
+                expectTrue(static_cast<bool>(ticket), "normal admitted within budget");
+                held.push_back(std::move(ticket));
+            }
+            expectTrue(admission.expectedWaitUs(2) == 25000, "queue estimate grows per render");
+            expectTrue(!admission.admit(RequestPriority::kNormal, 2), "normal shed over budget");
+            expectTrue(static_cast<bool>(admission.admit(RequestPriority::kHigh, 2)),
+                       "high still admitted");
+            expectTrue(admission.expectedWaitUs(4) == 7500, "more runtimes shorten the wait");
+
+            for (int i = 0; i < 100; ++i) {
+                held.push_back(admission.admit(RequestPriority::kCritical, 2));
+            }
+            expectTrue(static_cast<bool>(held.back()), "critical never shed");
+
+            held.clear();
+            const auto stats = admission.stats();
+            expectTrue(stats.inFlight == 0, "tickets release their slots");
+            expectTrue(stats.priorities[static_cast<std::size_t>(RequestPriority::kLow)].shed == 1 &&
+                           stats.priorities[static_cast<std::size_t>(RequestPriority::kNormal)]
+                                   .admitted == 5,
+                       "per-priority counters");
+        }
+
+        {
+            AdmissionController admission(makeOptions());
+            expectTrue(admission.acquireTimeoutMs(RequestPriority::kNormal, 0) == 20,
+                       "budget bounds an unbounded acquire");
+            expectTrue(admission.acquireTimeoutMs(RequestPriority::kNormal, 5) == 5,
+                       "tighter configured timeout wins");
+            expectTrue(admission.acquireTimeoutMs(RequestPriority::kCritical, 0) == 0,
+                       "critical keeps the configured timeout");
+
+            for (int i = 0; i < 200; ++i) {
+                admission.observeRender(30000);
+            }
+            const auto estimate = admission.stats().renderEstimateUs;
+            expectTrue(estimate > 29000 && estimate <= 30000, "estimate converges on latency");
+
+            auto ticket = admission.admit(RequestPriority::kNormal, 1);
+            auto moved = std::move(ticket);
+            expectTrue(!ticket && static_cast<bool>(moved), "ticket moves");
+            moved.release();
+            expectTrue(admission.stats().inFlight == 0, "explicit release");
+        }
+
+        {
+            // Renders queued for a render thread count even without tickets.
+            AdmissionController admission(makeOptions());
+            auto queued = admission.admit(RequestPriority::kNormal, 2, 3);
+            expectTrue(static_cast<bool>(queued) && queued.expectedWaitUs() == 10000,
+                       "queued work is quoted");
+            expectTrue(!admission.admit(RequestPriority::kNormal, 2, 6),
+                       "deep queue sheds with no tickets held");
+            auto held = admission.admit(RequestPriority::kNormal, 2, 0);
+            expectTrue(held.expectedWaitUs() == 0, "tickets and queue are not added up");
+        }
+
+        {
+            const hydra::AdmissionRejectedError shed(RequestPriority::kLow, 12000, false);
+            expectTrue(std::string(shed.what()).find("low priority") != std::string::npos &&
+                           !shed.timedOut(),
+                       "shed error message");
+            const hydra::AdmissionRejectedError late(RequestPriority::kHigh, 0, true);
+            expectTrue(late.timedOut() && late.priority() == RequestPriority::kHigh,
+                       "deadline error");
+        }
+
+        std::cout << "[admission-controller-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[admission-controller-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,99 @@
+#include "hydra/AssetManifest.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using hydra::AssetManifest;
+using hydra::AssetPreload;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+constexpr const char *kManifest = R"({
+  "src/entry-client.tsx": {
+    "file": "assets/client-abc.js",
+    "isEntry": true,
+    "imports": ["_vendor-123.js"],
+    "dynamicImports": ["src/pages/PostDetail.tsx"],
+    "css": ["assets/client-abc.css"]
+  },
+  "_vendor-123.js": {
+    "file": "assets/vendor-123.js"
+  },
+  "src/pages/PostDetail.tsx": {
+    "file": "assets/PostDetail-9f.js",
+    "name": "PostDetail",
+    "isDynamicEntry": true,
+    "imports": ["_vendor-123.js", "_markdown-77.js"],
+    "css": ["assets/PostDetail-9f.css"]
+  },
+  "_markdown-77.js": {
+    "file": "assets/markdown-77.js"
+  }
+})";
+
+}  // namespace
+
+int main() {
+    try {
+        const auto manifest = AssetManifest::parse(kManifest, "/assets");
+        expectTrue(manifest.size() == 4, "chunks indexed");
+
+        const auto entryKey = manifest.clientEntryKey("missing.tsx");
+        expectTrue(entryKey == "src/entry-client.tsx", "client entry found");
+        expectTrue(manifest.stylesheetFor(entryKey) == "/assets/client-abc.css", "entry css");
+
+        expectTrue(manifest.fileFor("/assets/PostDetail-9f.css") == "assets/PostDetail-9f.css" &&
+                       manifest.fileFor("/assets/missing.css").empty(),
+                   "file for public path");
+
+        const auto entry = manifest.preloadsFor({entryKey});
+        expectTrue(entry.size() == 3, "entry preloads");
+        expectTrue(entry[0].href == "/assets/client-abc.js" &&
+                       entry[1].href == "/assets/vendor-123.js" &&
+                       entry[2].kind == AssetPreload::Kind::kStyle,
+                   "entry preload order");
+
+        const auto pages = manifest.lazyChunksByPage(entryKey);
+        expectTrue(pages.size() == 1 && pages.at("postdetail") == "src/pages/PostDetail.tsx",
+                   "lazy page chunk");
+        expectTrue(AssetManifest::pageKey("post-detail") == "postdetail", "page key");
+
+        const auto page = manifest.preloadsFor({"src/pages/PostDetail.tsx", "unknown"});
+        expectTrue(page.size() == 4, "page preloads deduplicated");
+        expectTrue(page[2].href == "/assets/markdown-77.js", "transitive import");
+
+        const auto header = hydra::formatLinkHeader(entry, true);
+        expectTrue(header ==
+                       "</assets/client-abc.js>; rel=modulepreload, "
+                       "</assets/vendor-123.js>; rel=modulepreload, "
+                       "</assets/client-abc.css>; rel=preload; as=style",
+                   "module link header");
+        expectTrue(hydra::formatLinkHeader({{AssetPreload::Kind::kScript, "/a.js"}}, false) ==
+                       "</a.js>; rel=preload; as=script",
+                   "classic link header");
+        expectTrue(hydra::formatLinkHeader({{AssetPreload::Kind::kScript, "/a>,b.js"}}, true)
+                       .empty(),
+                   "unsafe href skipped");
+
+        bool threw = false;
+        try {
+            (void)AssetManifest::parse("[]", "/assets");
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        expectTrue(threw, "non-object manifest rejected");
+
+        std::cout << "[asset-manifest-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[asset-manifest-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
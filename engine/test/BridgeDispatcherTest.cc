@@ -0,0 +1,161 @@
+#include "hydra/BridgeDispatcher.h"
+#include "hydra/RenderTrace.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using hydra::BridgeDispatcher;
+using hydra::BridgeRequest;
+using hydra::BridgeResponse;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+// Collects completions the way V8SsrRuntime does.
+class Collector {
+  public:
+    explicit Collector(std::size_t expected) : responses_(expected), remaining_(expected) {}
+
+    BridgeDispatcher::Completion completion() {
+        return [this](std::size_t index, BridgeResponse response) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            responses_[index] = std::move(response);
+            --remaining_;
+            cv_.notify_all();
+        };
+    }
+
+    const std::vector<BridgeResponse> &wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, std::chrono::seconds(5), [this] { return remaining_ == 0; })) {
+            throw std::runtime_error("bridge calls did not complete");
+        }
+        return responses_;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<BridgeResponse> responses_;
+    std::size_t remaining_ = 0;
+};
+
+std::vector<BridgeRequest> makeRequests(std::size_t count) {
+    std::vector<BridgeRequest> requests(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        requests[i].path = "/hydra/internal/" + std::to_string(i);
+    }
+    return requests;
+}
+
+BridgeResponse echoPath(const BridgeRequest &request) {
+    BridgeResponse response;
+    response.body = request.path;
+    return response;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            BridgeDispatcher::Options options;
+            options.threads = 4;
+            BridgeDispatcher dispatcher(options, [](const BridgeRequest &request) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                return echoPath(request);
+            });
+            Collector collector(4);
+            const auto startedAt = std::chrono::steady_clock::now();
+            expectTrue(dispatcher.dispatch(makeRequests(4), collector.completion()) == 0,
+                       "no batches without a batch handler");
+            const auto &responses = collector.wait();
+            const auto elapsed = std::chrono::steady_clock::now() - startedAt;
+            expectTrue(elapsed < std::chrono::milliseconds(150), "calls overlap");
+            expectTrue(responses[3].body == "/hydra/internal/3", "responses keep their index");
+            expectTrue(dispatcher.stats().calls == 4, "calls counted");
+        }
+
+        {
+            BridgeDispatcher::Options options;
+            options.threads = 2;
+            options.maxBatch = 3;
+            std::mutex mutex;
+            std::vector<std::size_t> batchSizes;
+            BridgeDispatcher dispatcher(
+                options,
+                echoPath,
+                [&](const std::vector<BridgeRequest> &requests) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        batchSizes.push_back(requests.size());
+                    }
+                    if (requests.front().path == "/hydra/internal/3") {
+                        // Second batch: come up one short.
+                        return std::vector<BridgeResponse>{echoPath(requests.front())};
+                    }
+                    std::vector<BridgeResponse> responses;
+                    for (const auto &request : requests) {
+                        responses.push_back(echoPath(request));
+                    }
+                    return responses;
+                });
+            Collector collector(5);
+            expectTrue(dispatcher.dispatch(makeRequests(5), collector.completion()) == 2,
+                       "five calls in batches of three");
+            const auto &responses = collector.wait();
+            expectTrue(responses[2].body == "/hydra/internal/2", "first batch in order");
+            expectTrue(responses[3].body == "/hydra/internal/3", "short batch keeps its head");
+            expectTrue(responses[4].status == 500, "missing batch response becomes 500");
+            std::lock_guard<std::mutex> lock(mutex);
+            expectTrue(batchSizes.size() == 2 && batchSizes[0] + batchSizes[1] == 5,
+                       "batch sizes");
+            expectTrue(dispatcher.stats().batches == 2, "batches counted");
+        }
+
+        {
+            hydra::RenderTrace trace("req-1", std::nullopt);
+            hydra::RenderTrace *seen = nullptr;
+            BridgeDispatcher dispatcher({}, [&seen](const BridgeRequest &) -> BridgeResponse {
+                seen = hydra::RenderTrace::active();
+                throw std::runtime_error("backend down");
+            });
+            Collector collector(1);
+            {
+                hydra::RenderTrace::Activation activation(&trace);
+                (void)dispatcher.dispatch(makeRequests(1), collector.completion());
+            }
+            const auto &responses = collector.wait();
+            expectTrue(seen == &trace, "trace active on the worker");
+            expectTrue(responses[0].status == 500 && responses[0].body == "backend down",
+                       "handler exception becomes 500");
+        }
+
+        {
+            BridgeDispatcher dispatcher({}, echoPath);
+            dispatcher.shutdown();
+            Collector collector(2);
+            (void)dispatcher.dispatch(makeRequests(2), collector.completion());
+            const auto &responses = collector.wait();
+            expectTrue(responses[0].status == 503 && responses[1].status == 503,
+                       "calls after shutdown complete with 503");
+        }
+
+        std::cout << "[bridge-dispatcher-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[bridge-dispatcher-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
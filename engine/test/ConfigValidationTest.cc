@@ -108,6 +108,571 @@ int main() {
                 "invalid render timeout");
         }
 
+        {
+            auto config = makeBaseConfig("dev");
+            config["render_threads"] = 6;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.renderThreads == 6, "render threads preserved");
+            expectTrue(normalized.renderQueueMax == 1024, "render queue bounded by default");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["render_queue_max"] = 5000000;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "render queue too large");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["render_threads"] = 5000;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "render threads too large");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["v8_snapshot"]["enabled"] = true;
+            config["v8_snapshot"]["path"] = " /tmp/hydra.snapshot ";
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.v8SnapshotEnabled, "v8 snapshot enabled");
+            expectTrue(normalized.v8SnapshotPersist, "v8 snapshot persist default");
+            expectTrue(normalized.v8SnapshotPath == "/tmp/hydra.snapshot", "v8 snapshot path trimmed");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["v8_snapshot"]["mystery_key"] = true;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown v8_snapshot key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(defaults.v8CodeCacheEnabled, "v8 code cache enabled by default");
+            expectTrue(!defaults.v8CodeCachePersist, "v8 code cache persist off by default");
+
+            config["v8_code_cache"]["persist"] = true;
+            config["v8_code_cache"]["path"] = " /tmp/hydra.codecache ";
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.v8CodeCachePersist, "v8 code cache persist");
+            expectTrue(normalized.v8CodeCachePath == "/tmp/hydra.codecache",
+                       "v8 code cache path trimmed");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["v8_code_cache"]["mystery_key"] = true;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown v8_code_cache key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.hotReloadEnabled && defaults.hotReloadWatch &&
+                           defaults.hotReloadWatchIntervalMs == 1000 && !defaults.hotReloadSignal,
+                       "hot reload defaults");
+
+            config["hot_reload"]["enabled"] = true;
+            config["hot_reload"]["watch"] = false;
+            config["hot_reload"]["signal"] = true;
+            config["hot_reload"]["watch_interval_ms"] = 250;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.hotReloadEnabled && !normalized.hotReloadWatch &&
+                           normalized.hotReloadSignal && normalized.hotReloadWatchIntervalMs == 250,
+                       "hot reload parsed");
+
+            config["hot_reload"]["watch_interval_ms"] = 10;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "hot reload watch interval too small");
+            config["hot_reload"]["watch_interval_ms"] = 1000;
+            config["hot_reload"]["mystery_key"] = true;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown hot_reload key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.prerenderEnabled && defaults.prerenderRoutes.empty() &&
+                           defaults.prerenderOutputDir == "_prerender",
+                       "prerender defaults");
+
+            config["prerender"]["enabled"] = true;
+            config["prerender"]["revalidate_s"] = 60;
+            config["prerender"]["routes"].append("/");
+            Json::Value post(Json::objectValue);
+            post["path"] = "/posts/123";
+            post["revalidate_s"] = 0;
+            post["locales"].append("en");
+            config["prerender"]["routes"].append(post);
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.prerenderRoutes.size() == 2, "prerender routes parsed");
+            expectTrue(normalized.prerenderRoutes[0].revalidateSec == 60,
+                       "prerender route inherits revalidate_s");
+            expectTrue(normalized.prerenderRoutes[1].revalidateSec == 0 &&
+                           normalized.prerenderRoutes[1].locales.size() == 1,
+                       "prerender route overrides");
+
+            config["prerender"]["routes"].append("/../etc");
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "prerender path traversal");
+            config["prerender"]["routes"][2] = "/posts/123";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "duplicate prerender path");
+            config["prerender"]["routes"][2] = "/about?x=1";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "prerender path with query");
+            config["prerender"]["routes"].resize(2);
+            config["prerender"]["output_dir"] = "/var/www";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "absolute prerender output_dir");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.compressionEnabled && defaults.compressionGzipLevel == 6 &&
+                           defaults.compressionStaticSidecars,
+                       "compression defaults");
+
+            config["compression"]["enabled"] = true;
+            config["compression"]["brotli"] = false;
+            config["compression"]["gzip_level"] = 9;
+            config["compression"]["min_bytes"] = 0;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.compressionEnabled && !normalized.compressionBrotli &&
+                           normalized.compressionGzipLevel == 9 &&
+                           normalized.compressionMinBytes == 0,
+                       "compression parsed");
+
+            config["compression"]["gzip_level"] = 0;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "gzip_level out of range");
+            config["compression"]["gzip_level"] = 6;
+            config["compression"]["brotli_quality"] = 12;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "brotli_quality out of range");
+            config["compression"].removeMember("brotli_quality");
+            config["compression"]["level"] = 5;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown compression key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.earlyHintsEnabled && defaults.earlyHintsHtmlTags &&
+                           defaults.earlyHintsMaxLinks == 16,
+                       "early hints defaults");
+
+            config["early_hints"]["enabled"] = true;
+            config["early_hints"]["max_links"] = 8;
+            config["early_hints"]["pages"]["post-detail"] = "src/pages/PostDetail.tsx";
+            config["early_hints"]["pages"]["home"].append("src/pages/Home.tsx");
+            config["early_hints"]["pages"]["home"].append("src/widgets/Feed.tsx");
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.earlyHintsEnabled && normalized.earlyHintsMaxLinks == 8,
+                       "early hints parsed");
+            expectTrue(normalized.earlyHintsPages.at("post-detail").size() == 1 &&
+                           normalized.earlyHintsPages.at("home").size() == 2,
+                       "early hints pages parsed");
+
+            config["early_hints"]["max_links"] = 0;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "early hints max_links out of range");
+            config["early_hints"]["max_links"] = 8;
+            config["early_hints"]["pages"]["about"] = Json::Value(Json::arrayValue);
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "early hints page without keys");
+            config["early_hints"]["pages"].removeMember("about");
+            config["early_hints"]["status"] = 103;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown early hints key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.criticalCssEnabled && defaults.criticalCssMaxBytes == 16384,
+                       "critical css defaults");
+
+            config["critical_css"]["enabled"] = true;
+            config["critical_css"]["max_bytes"] = 8192;
+            config["critical_css"]["cache_entries"] = 64;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.criticalCssEnabled && normalized.criticalCssMaxBytes == 8192 &&
+                           normalized.criticalCssCacheEntries == 64,
+                       "critical css parsed");
+
+            config["critical_css"]["max_bytes"] = 512;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "critical css max_bytes out of range");
+            config["critical_css"]["max_bytes"] = 8192;
+            config["critical_css"]["classmap"] = "classmap.json";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown critical css key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            expectTrue(!hydra::validateAndNormalizeHydraSsrPluginConfig(config).etagEnabled,
+                       "etag off by default");
+            config["etag_enabled"] = true;
+            expectTrue(hydra::validateAndNormalizeHydraSsrPluginConfig(config).etagEnabled,
+                       "flat etag key");
+            config["etag"]["enabled"] = false;
+            expectTrue(!hydra::validateAndNormalizeHydraSsrPluginConfig(config).etagEnabled,
+                       "nested etag key wins");
+            config["etag"]["weak"] = true;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown etag key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!normalized.warmupEnabled && normalized.warmupRoutes.empty(),
+                       "warmup off by default");
+            config["warmup_enabled"] = true;
+            normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.warmupRoutes.size() == 1 &&
+                           normalized.warmupRoutes[0].url == "/" &&
+                           normalized.warmupRoutes[0].propsJson == "{}",
+                       "warmup defaults to the root route");
+            config["warmup"]["iterations"] = 20;
+            config["warmup"]["routes"] = Json::Value(Json::arrayValue);
+            config["warmup"]["routes"].append("/posts/123");
+            Json::Value route(Json::objectValue);
+            route["url"] = "/";
+            route["props"]["page"] = "home";
+            config["warmup"]["routes"].append(route);
+            normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.warmupIterations == 20 && normalized.warmupRoutes.size() == 2 &&
+                           normalized.warmupRoutes[1].propsJson == R"({"page":"home"})",
+                       "warmup routes parsed");
+            config["warmup"]["iterations"] = 0;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "warmup iterations out of range");
+            config["warmup"]["iterations"] = 20;
+            config["warmup"]["routes"][0] = "posts";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "warmup url must be absolute");
+            config["warmup"]["routes"][0] = "/posts/123";
+            config["warmup"]["routes"][1]["props"] = "home";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "warmup props must be an object");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.renderCacheEnabled, "render cache off by default");
+
+            config["render_cache"]["enabled"] = true;
+            config["render_cache"]["ttl_ms"] = 1000;
+            config["render_cache"]["stale_while_revalidate_ms"] = 5000;
+            config["render_cache"]["pages"]["home"]["ttl_ms"] = 30000;
+            config["render_cache"]["pages"]["account"]["ttl_ms"] = 0;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.renderCacheEnabled, "render cache enabled");
+            expectTrue(normalized.renderCacheDefaultPolicy.ttlMs == 1000, "render cache default ttl");
+            const auto &home = normalized.renderCachePages.at("home");
+            expectTrue(home.ttlMs == 30000, "render cache page ttl");
+            expectTrue(home.staleWhileRevalidateMs == 5000,
+                       "render cache page inherits stale window");
+            expectTrue(normalized.renderCachePages.at("account").ttlMs == 0,
+                       "render cache page opt-out");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["render_cache"]["shards"] = 0;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "render cache zero shards");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.renderCacheSharedEnabled, "shared render cache off by default");
+
+            config["render_cache"]["enabled"] = true;
+            config["render_cache"]["shared"]["enabled"] = true;
+            config["render_cache"]["shared"]["redis_client"] = "cache";
+            config["render_cache"]["shared"]["timeout_ms"] = 3;
+            config["render_cache"]["shared"]["gzip"] = false;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.renderCacheSharedEnabled, "shared render cache enabled");
+            expectTrue(normalized.renderCacheSharedRedisClient == "cache" &&
+                           normalized.renderCacheSharedKeyPrefix == "hydra",
+                       "shared render cache client and default prefix");
+            expectTrue(normalized.renderCacheSharedTimeoutMs == 3 &&
+                           !normalized.renderCacheSharedGzip,
+                       "shared render cache timeout and gzip");
+
+            config["render_cache"]["shared"]["timeout_ms"] = 0;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "shared render cache zero timeout");
+            config["render_cache"]["shared"]["timeout_ms"] = 5;
+            config["render_cache"]["shared"]["key_prefix"] = "my app";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "shared render cache prefix with space");
+            config["render_cache"]["shared"]["key_prefix"] = "app";
+            config["render_cache"]["shared"]["ttl_ms"] = 10;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown render_cache.shared key");
+            config["render_cache"]["shared"].removeMember("ttl_ms");
+            config["render_cache"]["enabled"] = false;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "shared render cache without local cache");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["render_cache"]["pages"]["home"]["max_age"] = 10;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown render_cache page key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["pool_size"] = 4;
+            config["pool"]["max"] = 16;
+            config["pool"]["idle_ttl_ms"] = 30000;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.poolSize == 4 && normalized.poolMin == 0, "pool_size kept as min");
+            expectTrue(normalized.poolMax == 16, "pool max parsed");
+            expectTrue(normalized.poolIdleTtlMs == 30000, "pool idle ttl parsed");
+            expectTrue(normalized.poolStandby == 1, "pool keeps one standby by default");
+
+            config["pool"]["min"] = 32;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "pool min above max");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["pool_min"] = 2;
+            config["pool_max"] = 8;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.poolMin == 2 && normalized.poolMax == 8, "flat pool keys");
+
+            config["pool"]["grow_queue_depth"] = 0;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "pool zero grow queue depth");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["pool"]["standby"] = 0;
+            expectTrue(hydra::validateAndNormalizeHydraSsrPluginConfig(config).poolStandby == 0,
+                       "pool standby disabled");
+            config["pool"]["standby"] = 65;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "pool standby out of range");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            expectTrue(hydra::validateAndNormalizeHydraSsrPluginConfig(config).poolThreadAffinity,
+                       "pool thread affinity on by default");
+            config["pool"]["thread_affinity"] = false;
+            expectTrue(!hydra::validateAndNormalizeHydraSsrPluginConfig(config).poolThreadAffinity,
+                       "pool thread affinity disabled");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.admissionEnabled && defaults.admissionLow.reject &&
+                           !defaults.admissionNormal.reject,
+                       "admission defaults");
+
+            config["admission"]["enabled"] = true;
+            config["admission"]["session_cookies"].append("sid");
+            config["admission"]["bot_user_agents"].append(" GoogleBot ");
+            config["admission"]["priorities"]["normal"]["max_wait_ms"] = 250;
+            config["admission"]["priorities"]["high"]["action"] = "reject";
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.admissionEnabled && normalized.admissionNormal.maxWaitMs == 250,
+                       "admission priority parsed");
+            expectTrue(normalized.admissionHigh.reject && normalized.admissionHigh.maxWaitMs == 2000,
+                       "admission action keeps default budget");
+            expectTrue(normalized.admissionSessionCookies.size() == 1 &&
+                           normalized.admissionBotUserAgents.size() == 1 &&
+                           normalized.admissionBotUserAgents.front() == "googlebot",
+                       "admission lists replace defaults");
+
+            config["admission"]["priorities"]["critical"]["max_wait_ms"] = 1;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "critical priority is not configurable");
+            config["admission"]["priorities"].removeMember("critical");
+            config["admission"]["priorities"]["low"]["action"] = "drop";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "admission action validated");
+            config["admission"]["priorities"]["low"]["action"] = "shell";
+            config["admission"]["health_paths"] = "/healthz";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "admission health paths must be an array");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(defaults.metricsHistogramBoundsMs.size() == 12 &&
+                           defaults.metricsMaxRoutes == 64,
+                       "metrics defaults");
+
+            config["metrics"]["histogram_bounds_ms"] = Json::Value(Json::arrayValue);
+            config["metrics"]["histogram_bounds_ms"].append(0.5);
+            config["metrics"]["histogram_bounds_ms"].append(120);
+            config["metrics"]["histogram_bounds_ms"].append(180);
+            config["metrics"]["quantiles"].append(0.999);
+            config["metrics"]["max_routes"] = 0;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.metricsHistogramBoundsMs.size() == 3 &&
+                           normalized.metricsQuantiles.size() == 1 &&
+                           normalized.metricsMaxRoutes == 0,
+                       "metrics parsed");
+
+            config["metrics"]["histogram_bounds_ms"].append(100);
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "histogram bounds must increase");
+            config["metrics"].removeMember("histogram_bounds_ms");
+            config["metrics"]["quantiles"].append(1);
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "quantiles out of range");
+            config["metrics"].removeMember("quantiles");
+            config["metrics"]["max_routes"] = 5000;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "metrics route cap out of range");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(!defaults.tracingEnabled && !defaults.tracingServerTiming &&
+                           defaults.tracingOtlpEndpoint.empty(),
+                       "tracing defaults");
+
+            config["tracing"]["enabled"] = true;
+            config["tracing"]["sample_rate"] = 0.25;
+            config["tracing"]["server_timing"] = true;
+            config["tracing"]["otlp_endpoint"] = " http://127.0.0.1:4318/v1/traces ";
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.tracingEnabled && normalized.tracingSampleRate == 0.25 &&
+                           normalized.tracingServerTiming &&
+                           normalized.tracingOtlpEndpoint == "http://127.0.0.1:4318/v1/traces",
+                       "tracing parsed");
+
+            config["tracing"]["otlp_endpoint"] = "127.0.0.1:4318";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "otlp endpoint needs a scheme");
+            config["tracing"]["otlp_endpoint"] = "";
+            config["tracing"]["sample_rate"] = 2;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "tracing sample rate out of range");
+            config["tracing"]["sample_rate"] = 1;
+            config["tracing"]["exporter"] = "zipkin";
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown tracing key rejected");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            const auto defaults = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(defaults.v8HeapMaxMb == 0 && defaults.v8HeapIdleGc, "v8 heap defaults");
+
+            config["v8_heap"]["max_mb"] = 256;
+            config["v8_heap"]["recycle_after_renders"] = 10000;
+            config["v8_heap"]["recycle_heap_growth_percent"] = 200;
+            config["v8_heap"]["idle_gc"] = false;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.v8HeapMaxMb == 256, "v8 heap max parsed");
+            expectTrue(normalized.v8HeapRecycleAfterRenders == 10000, "v8 heap render recycle");
+            expectTrue(normalized.v8HeapRecycleGrowthPercent == 200, "v8 heap growth recycle");
+            expectTrue(!normalized.v8HeapIdleGc, "v8 heap idle gc disabled");
+
+            config["v8_heap"]["max_mb"] = 4;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "v8 heap max too small");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["v8_heap"]["max_heap"] = 256;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "unknown v8_heap key");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["render_log"]["sample_rate"] = 0.01;
+            config["render_log"]["slow_ms"] = 200;
+            const auto normalized = hydra::validateAndNormalizeHydraSsrPluginConfig(config);
+            expectTrue(normalized.renderLogSampleRate == 0.01, "render log sample rate");
+            expectTrue(normalized.renderLogSlowMs == 200, "render log slow threshold");
+            expectTrue(normalized.renderLogAlwaysFailures, "render log keeps failures by default");
+
+            config["render_log"]["sample_rate"] = 1.5;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "render log sample rate out of range");
+        }
+
+        {
+            auto config = makeBaseConfig("dev");
+            config["render_log"]["ring_capacity"] = 4;
+            expectThrows(
+                [&]() { (void)hydra::validateAndNormalizeHydraSsrPluginConfig(config); },
+                "render log ring too small");
+        }
+
         {
             auto config = makeBaseConfig("dev");
             config["dev_mode"]["vite_origin"] = "127.0.0.1:5174";
@@ -0,0 +1,128 @@
+#include "hydra/CriticalCss.h"
+#include "hydra/HtmlShell.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using hydra::CriticalCss;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+bool contains(const std::string &haystack, const std::string &needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+constexpr const char *kStylesheet = R"css(
+@charset "utf-8";
+/* preflight */
+*, ::before, ::after {
+  --tw-pan-x:  ;
+  box-sizing: border-box;
+}
+body { margin: 0 }
+.flex { display: flex; }
+.hidden { display: none; }
+.md\:grid { display: grid; }
+.card .title, .banner { font-weight: 600; }
+.btn:not(.disabled):hover { color: red; }
+.quote::before { content: "}</style>"; }
+@media (min-width: 768px) {
+  .md\:grid { grid-template-columns: repeat(2, 1fr); }
+  .hidden { display: block; }
+}
+@keyframes spin { to { transform: rotate(360deg); } }
+)css";
+
+}  // namespace
+
+int main() {
+    try {
+        const CriticalCss css(kStylesheet, {});
+        expectTrue(css.classCount() == 8, "classes indexed");
+
+        std::vector<std::string> tokens;
+        CriticalCss::forEachClass(
+            R"(<div class="flex md:grid"><p data-class="hidden" class='card'>x</p>)"
+            R"(<span class="title [&amp;>*]:p-2">y</span></div>)",
+            [&](std::string_view token) { tokens.emplace_back(token); });
+        expectTrue((tokens == std::vector<std::string>{"flex", "md:grid", "card", "title",
+                                                       "[&>*]:p-2"}),
+                   "class tokens scanned");
+
+        CriticalCss::Source source = CriticalCss::Source::kPage;
+        const std::string page = R"(<main class="flex md:grid"><h1 class="card"><b class="title">)"
+                                 R"(x</b></h1><a class="btn">go</a></main>)";
+        const auto rules = css.rulesFor("home", page, &source);
+        expectTrue(rules != nullptr && source == CriticalCss::Source::kSelected, "selected");
+        expectTrue(contains(*rules, "@charset \"utf-8\";"), "statement at-rule kept");
+        expectTrue(contains(*rules, "*,::before,::after{--tw-pan-x: ;box-sizing:border-box;}"),
+                   "universal rule kept and compacted");
+        expectTrue(contains(*rules, "body{margin:0}"), "element rule kept");
+        expectTrue(contains(*rules, ".flex{display:flex;}"), "matched class rule");
+        expectTrue(contains(*rules, ".card .title,.banner{"), "descendant selector matched");
+        expectTrue(contains(*rules, ".btn:not(.disabled):hover{"), "classes in :not() ignored");
+        expectTrue(contains(*rules,
+                            "@media (min-width:768px){.md\\:grid{grid-template-columns:"
+                            "repeat(2,1fr);}}"),
+                   "media rule wrapped around matched rules only");
+        expectTrue(contains(*rules, "@keyframes spin{"), "keyframes kept");
+        expectTrue(!contains(*rules, ".hidden"), "unused class dropped");
+        expectTrue(!contains(*rules, ".quote"), "unused rule with string dropped");
+        expectTrue(rules->find(".flex") < rules->find("@media"), "source order kept");
+
+        const auto repeat = css.rulesFor("home", page, &source);
+        expectTrue(repeat == rules && source == CriticalCss::Source::kPage, "page cache hit");
+        (void)css.rulesFor("about", page + "<p>more</p>", &source);
+        expectTrue(source == CriticalCss::Source::kClassSet, "class set cache hit");
+
+        const auto quoted = css.rulesFor("quote", R"(<q class="quote">x</q>)");
+        expectTrue(quoted != nullptr && contains(*quoted, R"(content:"}<\/style>";)") &&
+                       !contains(*quoted, "</style"),
+                   "inlined rules cannot close the style element");
+
+        const CriticalCss tiny(kStylesheet, {.maxBytes = 64, .cacheEntries = 4});
+        expectTrue(tiny.rulesFor("home", page) == nullptr, "oversized selection not inlined");
+
+        hydra::HtmlShellAssets assets;
+        assets.cssPath = "/assets/app.css";
+        assets.inlineCriticalCss = true;
+        const hydra::CompiledHtmlShell shell(assets);
+        hydra::HtmlShellPageMeta meta;
+        meta.criticalCss = *rules;
+        const auto html = shell.wrap("<p>x</p>", "{}", meta, "n0nce");
+        expectTrue(contains(html, "<style nonce=\"n0nce\">" + *rules + "</style>"),
+                   "critical rules inlined with nonce");
+        expectTrue(contains(html, "<link rel=\"preload\" href=\"/assets/app.css\" as=\"style\" />"),
+                   "stylesheet preloaded");
+        expectTrue(html.find("<link rel=\"stylesheet\" href=\"/assets/app.css\" />") >
+                       html.find("<p>x</p>"),
+                   "stylesheet linked after the app");
+        std::string joined;
+        for (const auto &run : shell.wrapRuns("<p>x</p>", "{}", 0, 0, meta, "n0nce")) {
+            joined += run;
+        }
+        expectTrue(joined == html, "runs concatenate to wrap()");
+
+        const auto fallback = shell.wrap("<p>x</p>", "{}", {}, "n0nce");
+        expectTrue(!contains(fallback, "<style") &&
+                       fallback.find("<link rel=\"stylesheet\" href=\"/assets/app.css\" />") <
+                           fallback.find("<p>x</p>"),
+                   "no rules keeps the blocking stylesheet");
+        expectTrue(shell.prefix(meta) + "<p>x</p>" + shell.suffix("{}", "n0nce") == fallback,
+                   "streaming halves ignore critical rules");
+
+        std::cout << "[critical-css-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[critical-css-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,76 @@
+#include "hydra/EntityTag.h"
+#include "hydra/HtmlShell.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using hydra::ifNoneMatchMatches;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        const auto etag = hydra::weakEntityTag(0x1234abcdULL);
+        expectTrue(etag == "W/\"000000001234abcd\"", "weak tag format");
+
+        expectTrue(ifNoneMatchMatches(etag, etag), "exact match");
+        expectTrue(ifNoneMatchMatches("\"000000001234abcd\"", etag), "weak comparison");
+        expectTrue(ifNoneMatchMatches("W/\"x\", W/\"000000001234abcd\"", etag), "listed match");
+        expectTrue(ifNoneMatchMatches(" * ", etag), "wildcard");
+        expectTrue(ifNoneMatchMatches("garbage, \"000000001234abcd\"", etag),
+                   "malformed member skipped");
+        expectTrue(!ifNoneMatchMatches("", etag), "empty header");
+        expectTrue(!ifNoneMatchMatches("W/\"000000001234abce\"", etag), "different tag");
+        expectTrue(!ifNoneMatchMatches("\"000000001234abcd", etag), "unterminated tag");
+        expectTrue(!ifNoneMatchMatches("\"a\"", ""), "empty etag never matches");
+
+        hydra::HtmlShellAssets assets;
+        assets.title = "Hydra";
+        const hydra::CompiledHtmlShell shell(assets);
+        const std::string props = R"({"page":"home","__hydra_request":{"requestId":"r1"}})";
+        const std::string otherRequest = R"({"page":"home","__hydra_request":{"requestId":"r22"}})";
+        const auto begin = props.find(",\"__hydra_request\"");
+        hydra::HtmlShellPageMeta meta;
+        const auto digest = shell.contentHash("<p>x</p>", props, begin, props.size() - 1, meta);
+        expectTrue(digest == shell.contentHash("<p>x</p>", otherRequest, begin,
+                                               otherRequest.size() - 1, meta),
+                   "request props excluded");
+        expectTrue(digest == hydra::CompiledHtmlShell(assets).contentHash(
+                                 "<p>x</p>", props, begin, props.size() - 1, meta),
+                   "stable across shells compiled from equal assets");
+        expectTrue(digest != shell.contentHash("<p>y</p>", props, begin, props.size() - 1, meta),
+                   "app html included");
+        expectTrue(digest != shell.contentHash("<p>x</p>", props, 0, props.size(), meta),
+                   "controller props included");
+        meta.title = "Hydra";
+        expectTrue(digest == shell.contentHash("<p>x</p>", props, begin, props.size() - 1, meta),
+                   "override equal to the default");
+        meta.title = "Other";
+        expectTrue(digest != shell.contentHash("<p>x</p>", props, begin, props.size() - 1, meta),
+                   "page metadata included");
+        meta = {};
+        meta.criticalCss = ".a{}";
+        expectTrue(digest != shell.contentHash("<p>x</p>", props, begin, props.size() - 1, meta),
+                   "critical css included");
+
+        assets.cssPath = "/assets/app-2.css";
+        expectTrue(digest != hydra::CompiledHtmlShell(assets).contentHash(
+                                 "<p>x</p>", props, begin, props.size() - 1, {}),
+                   "template included");
+
+        std::cout << "[entity-tag-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[entity-tag-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,132 @@
+#include "hydra/HtmlEscape.h"
+#include "hydra/HtmlShell.h"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using hydra::html_escape::Kernel;
+using hydra::html_escape::Mode;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+void expectEqual(const std::string &actual, const std::string &expected, const std::string &label) {
+    if (actual != expected) {
+        throw std::runtime_error("assertion failed: " + label + " (got '" + actual +
+                                 "', expected '" + expected + "')");
+    }
+}
+
+const std::vector<Mode> kModes = {
+    Mode::HtmlText, Mode::HtmlAttribute, Mode::ScriptTag, Mode::JsString};
+
+const char *modeName(Mode mode) {
+    switch (mode) {
+        case Mode::HtmlText:
+            return "html_text";
+        case Mode::HtmlAttribute:
+            return "html_attribute";
+        case Mode::ScriptTag:
+            return "script_tag";
+        case Mode::JsString:
+            return "js_string";
+    }
+    return "unknown";
+}
+
+std::vector<Kernel> supportedKernels() {
+    std::vector<Kernel> kernels;
+    for (const auto kernel : {Kernel::Scalar, Kernel::Sse2, Kernel::Avx2, Kernel::Neon}) {
+        if (hydra::html_escape::kernelSupported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+std::string escapeWith(std::string_view value, Mode mode, Kernel kernel) {
+    std::string out = "prefix:";
+    out.reserve(out.size() + hydra::html_escape::escapedSize(value, mode, kernel));
+    hydra::html_escape::appendEscaped(out, value, mode, kernel);
+    return out.substr(7);
+}
+
+void checkAgainstScalar(const std::string &input, const std::string &label) {
+    for (const auto mode : kModes) {
+        const auto reference = escapeWith(input, mode, Kernel::Scalar);
+        for (const auto kernel : supportedKernels()) {
+            const auto name = label + " " + modeName(mode) + "/" +
+                              hydra::html_escape::kernelName(kernel);
+            expectEqual(escapeWith(input, mode, kernel), reference, name);
+            expectTrue(hydra::html_escape::escapedSize(input, mode, kernel) == reference.size(),
+                       name + " size");
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        expectEqual(hydra::html_escape::escape("a<b>&\"c\"", Mode::HtmlText),
+                    "a&lt;b&gt;&amp;\"c\"",
+                    "html text");
+        expectEqual(hydra::html_escape::escape("a<b>&\"c\"", Mode::HtmlAttribute),
+                    "a&lt;b&gt;&amp;&quot;c&quot;",
+                    "html attribute");
+        expectEqual(hydra::html_escape::escape("{\"x\":\"</script>&\"}", Mode::ScriptTag),
+                    "{\"x\":\"\\u003c/script\\u003e\\u0026\"}",
+                    "script tag");
+        expectEqual(hydra::html_escape::escape("a\\\"\n\r\t<", Mode::JsString),
+                    "a\\\\\\\"\\n\\r\\t\\u003c",
+                    "js string");
+        expectEqual(hydra::HtmlShell::escapeForScriptTag("</script>"),
+                    "\\u003c/script\\u003e",
+                    "HtmlShell::escapeForScriptTag");
+        expectTrue(hydra::html_escape::kernelSupported(hydra::html_escape::activeKernel()),
+                   "active kernel supported");
+
+        // Specials on and around the 16/32-byte block edges.
+        for (std::size_t length = 0; length <= 70; ++length) {
+            for (std::size_t at = 0; at < length; ++at) {
+                std::string input(length, 'x');
+                input[at] = '<';
+                checkAgainstScalar(input, "edge len=" + std::to_string(length) +
+                                              " at=" + std::to_string(at));
+            }
+        }
+
+        // Random inputs biased towards special and high (non-ASCII) bytes.
+        std::mt19937 rng(0x48594452U);
+        const std::string specials = "&<>\"\\\n\r\t'/";
+        std::uniform_int_distribution<int> lengthDist(0, 600);
+        std::uniform_int_distribution<int> pickDist(0, 9);
+        std::uniform_int_distribution<int> byteDist(0, 255);
+        std::uniform_int_distribution<std::size_t> specialDist(0, specials.size() - 1);
+        for (int iteration = 0; iteration < 3000; ++iteration) {
+            std::string input(static_cast<std::size_t>(lengthDist(rng)), '\0');
+            const auto density = pickDist(rng);
+            for (auto &ch : input) {
+                ch = pickDist(rng) < density ? specials[specialDist(rng)]
+                                             : static_cast<char>(byteDist(rng));
+            }
+            checkAgainstScalar(input, "fuzz #" + std::to_string(iteration));
+        }
+
+        std::cout << "[html-escape-test] PASS (active kernel: "
+                  << hydra::html_escape::kernelName(hydra::html_escape::activeKernel()) << ")\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[html-escape-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
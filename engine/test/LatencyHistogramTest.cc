@@ -0,0 +1,128 @@
+#include "hydra/LatencyHistogram.h"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using hydra::LatencyHistogram;
+using hydra::RouteLatencyMetrics;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+bool within(double value, double expected, double relativeError) {
+    return std::abs(value - expected) <= expected * relativeError;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            // Buckets tile the range without gaps and every value lands in
+            // the bucket whose bounds contain it.
+            for (std::size_t i = 0; i + 1 < LatencyHistogram::kBucketCount; ++i) {
+                expectTrue(LatencyHistogram::bucketUpperUs(i) ==
+                               LatencyHistogram::bucketLowerUs(i + 1),
+                           "contiguous buckets at " + std::to_string(i));
+            }
+            for (std::uint64_t value : {0ULL, 1ULL, 7ULL, 8ULL, 9ULL, 15ULL, 16ULL, 1000ULL,
+                                        99999ULL, 100000ULL, 250000ULL, 123456789ULL}) {
+                const auto index = LatencyHistogram::bucketIndex(value);
+                expectTrue(LatencyHistogram::bucketLowerUs(index) <= value &&
+                               value < LatencyHistogram::bucketUpperUs(index),
+                           "value in its bucket: " + std::to_string(value));
+            }
+            expectTrue(LatencyHistogram::bucketIndex(~0ULL) == LatencyHistogram::kBucketCount - 1,
+                       "huge values clamp to the last bucket");
+        }
+
+        {
+            LatencyHistogram histogram(4);
+            // 1..1000 ms in 1 ms steps.
+            for (std::uint64_t ms = 1; ms <= 1000; ++ms) {
+                histogram.record(ms * 1000);
+            }
+            const auto snapshot = histogram.snapshot();
+            expectTrue(snapshot.count == 1000, "count");
+            expectTrue(snapshot.sumUs == 500500ULL * 1000, "sum");
+            expectTrue(within(snapshot.quantileUs(0.5), 500000.0, 0.07), "p50");
+            expectTrue(within(snapshot.quantileUs(0.99), 990000.0, 0.07), "p99");
+            expectTrue(within(static_cast<double>(snapshot.countAtOrBelow(100000)), 100.0, 0.07),
+                       "cumulative count at 100ms");
+            expectTrue(snapshot.countAtOrBelow(2000000) == 1000, "everything under 2s");
+            std::uint64_t previous = 0;
+            for (std::uint64_t bound = 0; bound <= 1100000; bound += 777) {
+                const auto below = snapshot.countAtOrBelow(bound);
+                expectTrue(below >= previous, "cumulative counts never decrease");
+                previous = below;
+            }
+        }
+
+        {
+            // Percentile between coarse bounds: 98 fast renders, 2 at 180 ms.
+            LatencyHistogram histogram;
+            for (int i = 0; i < 98; ++i) {
+                histogram.record(20000);
+            }
+            histogram.record(180000);
+            histogram.record(180000);
+            expectTrue(within(histogram.snapshot().quantileUs(0.99), 180000.0, 0.13),
+                       "p99 resolves inside the 100..250 ms range");
+            expectTrue(LatencyHistogram(1).snapshot().quantileUs(0.99) == 0.0, "empty histogram");
+        }
+
+        {
+            LatencyHistogram histogram(8);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 8; ++t) {
+                threads.emplace_back([&histogram, t] {
+                    for (int i = 0; i < 10000; ++i) {
+                        histogram.record(static_cast<std::uint64_t>(t * 1000 + i % 500));
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            expectTrue(histogram.snapshot().count == 80000, "sharded counts add up");
+        }
+
+        {
+            RouteLatencyMetrics metrics(2, 1);
+            auto &home = metrics.route("home");
+            expectTrue(&metrics.route("home") == &home, "stable route lookup");
+            metrics.route("about").request.record(1000);
+            auto &overflow = metrics.route("invented-1");
+            expectTrue(overflow.name == RouteLatencyMetrics::kOverflowRoute, "cap hit");
+            expectTrue(&metrics.route("invented-2") == &overflow, "overflow shared");
+            expectTrue(&metrics.route("about") != &overflow, "tracked routes still found");
+
+            const auto routes = metrics.routes();
+            expectTrue(routes.size() == 3 && routes[0]->name == "about" &&
+                           routes[1]->name == "home" &&
+                           routes[2]->name == RouteLatencyMetrics::kOverflowRoute,
+                       "routes sorted, overflow last");
+            expectTrue(routes[0]->request.snapshot().count == 1, "route histogram recorded");
+
+            RouteLatencyMetrics fresh(4, 1);
+            fresh.route("home").render.record(1);
+            expectTrue(fresh.routes().size() == 1, "overflow hidden until used");
+        }
+
+        std::cout << "[latency-histogram-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[latency-histogram-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,120 @@
+#include "hydra/Prerenderer.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using hydra::Prerenderer;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+std::string readFile(const std::filesystem::path &path) {
+    std::ifstream input(path, std::ios::binary);
+    std::ostringstream out;
+    out << input.rdbuf();
+    return out.str();
+}
+
+Prerenderer::Route makeRoute(std::string path, std::chrono::seconds revalidate) {
+    Prerenderer::Route route;
+    route.path = std::move(path);
+    route.revalidate = revalidate;
+    route.locales = {"en", "fr"};
+    route.themes = {"ocean"};
+    return route;
+}
+
+}  // namespace
+
+int main() {
+    const auto root = std::filesystem::temp_directory_path() /
+                      ("hydra-prerender-test-" +
+                       std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    try {
+        std::filesystem::remove_all(root);
+
+        Prerenderer::Options options;
+        options.outputRoot = root;
+        options.urlPrefix = "/_prerender/";
+        options.retryDelay = std::chrono::seconds(0);
+        options.routes = {makeRoute("/", std::chrono::seconds(0)),
+                          makeRoute("/posts/123", std::chrono::seconds(0))};
+        int renders = 0;
+        bool failing = false;
+        Prerenderer prerenderer(options, [&](const Prerenderer::Variant &variant)
+                                             -> std::optional<std::string> {
+            ++renders;
+            if (failing) {
+                return std::nullopt;
+            }
+            return "<html>" + variant.path + " " + variant.locale + " " +
+                   std::to_string(renders) + "</html>";
+        });
+
+        expectTrue(!prerenderer.lookup("/", "en", "ocean"), "nothing served before rendering");
+        expectTrue(prerenderer.regenerateDue() == 4, "every variant rendered once");
+        expectTrue(prerenderer.regenerateDue() == 0, "revalidate 0 keeps the file");
+
+        const auto home = prerenderer.lookup("/", "fr", "ocean");
+        expectTrue(home && *home == "/_prerender/fr/ocean/index.html", "root maps to an index");
+        const auto post = prerenderer.lookup("/posts/123", "en", "ocean");
+        expectTrue(post && *post == "/_prerender/en/ocean/posts/123/index.html",
+                   "nested route maps under its variant");
+        expectTrue(readFile(root / "en/ocean/posts/123/index.html").find("/posts/123 en") !=
+                       std::string::npos,
+                   "file written");
+        expectTrue(!prerenderer.lookup("/posts/456", "en", "ocean"), "unlisted route");
+        expectTrue(!prerenderer.lookup("/", "de", "ocean"), "unlisted locale");
+
+        const auto before = readFile(root / "en/ocean/index.html");
+        failing = true;
+        expectTrue(prerenderer.invalidate({"/"}) == 2, "invalidate marks a route's variants");
+        expectTrue(prerenderer.regenerateDue() == 0, "failed renders write nothing");
+        expectTrue(readFile(root / "en/ocean/index.html") == before,
+                   "failed render keeps the previous file");
+        expectTrue(prerenderer.lookup("/", "en", "ocean").has_value(),
+                   "stale file still served");
+
+        failing = false;
+        expectTrue(prerenderer.regenerateDue() == 2, "failed variants retried");
+        expectTrue(readFile(root / "en/ocean/index.html") != before, "file replaced");
+        expectTrue(!std::filesystem::exists(root / "en/ocean/index.html.tmp"),
+                   "staging file renamed away");
+
+        const auto stats = prerenderer.stats();
+        expectTrue(stats.routes == 2 && stats.variants == 4 && stats.ready == 4, "stats");
+        expectTrue(stats.renders == 6 && stats.failures == 2, "render counts");
+        expectTrue(stats.hits == 3, "hits counted");
+
+        bool threw = false;
+        try {
+            Prerenderer::Options bad;
+            bad.outputRoot = root;
+            bad.routes = {makeRoute("/../etc", std::chrono::seconds(0))};
+            Prerenderer rejected(bad, [](const Prerenderer::Variant &) {
+                return std::optional<std::string>{};
+            });
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        expectTrue(threw, "path traversal rejected");
+
+        std::filesystem::remove_all(root);
+        std::cout << "[prerenderer-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::filesystem::remove_all(root);
+        std::cerr << "[prerenderer-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,101 @@
+#include "hydra/PropsJson.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using hydra::props_json::appendMember;
+using hydra::props_json::scanObject;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+void expectEqual(const std::string &actual, const std::string &expected, const std::string &label) {
+    if (actual != expected) {
+        throw std::runtime_error("assertion failed: " + label + " (got '" + actual +
+                                 "', expected '" + expected + "')");
+    }
+}
+
+std::string splice(const std::string &json) {
+    return appendMember(json, scanObject(json), "__hydra_request", "{\"locale\":\"en\"}");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            const auto shape = scanObject("{}");
+            expectTrue(shape.isObject && shape.empty, "empty object");
+            expectEqual(splice("{}"), "{\"__hydra_request\":{\"locale\":\"en\"}}", "splice empty");
+            expectEqual(splice(" { } \n"), " { \"__hydra_request\":{\"locale\":\"en\"}} \n",
+                        "splice keeps surrounding whitespace");
+        }
+
+        {
+            const std::string json =
+                "{\"page\":\"home\",\"items\":[1,2.5e3,-3,true,null,{\"a\":\"}\"}],"
+                "\"__hydra_route\":{\"params\":{\"id\":\"7\"},\"pageId\":\"post_detail\"}}";
+            const auto shape = scanObject(json);
+            expectTrue(shape.isObject && !shape.empty, "nested object scanned");
+            expectEqual(shape.pageId, "post_detail", "__hydra_route.pageId wins over page");
+            expectEqual(splice(json),
+                        json.substr(0, json.size() - 1) +
+                            ",\"__hydra_request\":{\"locale\":\"en\"}}",
+                        "splice appends last member");
+        }
+
+        {
+            expectEqual(scanObject("{\"page\":\"home\"}").pageId, "home", "page fallback");
+            expectEqual(scanObject("{\"__hydra_route\":{\"pageId\":7},\"page\":\"home\"}").pageId,
+                        "home",
+                        "non-string route pageId falls back to page");
+            expectEqual(scanObject("{\"page\":\"a\",\"page\":\"b\"}").pageId, "b",
+                        "duplicate keys keep the last value");
+            expectEqual(scanObject("{\"p\\u0061ge\":\"caf\\u00e9\\n\"}").pageId, "caf\xc3\xa9\n",
+                        "escaped key and value decoded");
+            expectEqual(scanObject("{\"page\":\"\\ud83d\\ude00\"}").pageId, "\xf0\x9f\x98\x80",
+                        "surrogate pair decoded");
+            expectEqual(scanObject("{\"title\":\"quote \\\" page\"}").pageId, "",
+                        "escaped quote inside string");
+        }
+
+        {
+            const char *invalid[] = {
+                "",
+                "[]",
+                "\"page\"",
+                "{",
+                "{\"a\":1",
+                "{\"a\" 1}",
+                "{\"a\":1,}",
+                "{\"a\":}",
+                "{\"a\":1}}",
+                "{\"a\":1} x",
+                "{\"a\":[1,2}",
+                "{\"a\":\"unterminated}",
+                "{a:1}",
+            };
+            for (const auto *json : invalid) {
+                expectTrue(!scanObject(json).isObject, std::string("rejects: ") + json);
+                expectEqual(splice(json), json, std::string("invalid props unchanged: ") + json);
+            }
+
+            std::string deep(600, '[');
+            deep = "{\"a\":" + deep + std::string(600, ']') + "}";
+            expectTrue(!scanObject(deep).isObject, "nesting limit");
+        }
+
+        std::cout << "[props-json-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[props-json-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
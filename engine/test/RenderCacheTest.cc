@@ -0,0 +1,305 @@
+#include "hydra/RenderCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using hydra::CachedRender;
+using hydra::RenderCache;
+using hydra::SsrRenderResult;
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+RenderCache::Value makeValue(const std::string &html, int status = 200) {
+    auto result = std::make_shared<CachedRender>();
+    result->html = html;
+    result->status = status;
+    return result;
+}
+
+RenderCache::Policy makePolicy(std::chrono::milliseconds ttl,
+                               std::chrono::milliseconds stale = 0ms) {
+    RenderCache::Policy policy;
+    policy.ttl = ttl;
+    policy.staleWhileRevalidate = stale;
+    return policy;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            const auto a = RenderCache::makeKey("/posts/1", "en", "ocean", "{}");
+            const auto b = RenderCache::makeKey("/posts/1", "fr", "ocean", "{}");
+            const auto c = RenderCache::makeKey("/posts/1en", "", "ocean", "{}");
+            expectTrue(a.hash != b.hash && a.check != b.check, "locale changes key");
+            expectTrue(a.hash != c.hash, "key parts are not concatenated");
+            const auto tagged = RenderCache::makeKey("/posts/1", "en", "ocean", "{}", 2);
+            expectTrue(RenderCache::makeKey("/posts/1", "en", "ocean", "{}", 0).hash == a.hash,
+                       "tag version 0 keeps the key");
+            expectTrue(tagged.hash != a.hash && tagged.check != a.check,
+                       "tag version changes key");
+        }
+
+        {
+            CachedRender page;
+            page.html = "<p>caf\xc3\xa9</p>\0tail"s;
+            page.status = 404;
+            page.title = "Missing";
+            page.propsJson = R"({"id":1})";
+            page.etag = "\"abc\"";
+            page.headers["Cache-Control"] = "public, max-age=60";
+            page.headers["Vary"] = "Accept-Language";
+            page.generation = 7;
+            page.sharedGzip.push_back(hydra::deflateBlock(page.html, 6));
+
+            std::uint64_t storedAt = 0;
+            const auto decoded =
+                RenderCache::decode(RenderCache::encode(page, 1234, true), &storedAt);
+            expectTrue(decoded != nullptr && storedAt == 1234, "encoded value decodes");
+            expectTrue(decoded->html == page.html && decoded->status == 404 &&
+                           decoded->title == "Missing" && decoded->propsJson == page.propsJson &&
+                           decoded->etag == page.etag && decoded->headers == page.headers,
+                       "fields round trip");
+            expectTrue(decoded->generation == 0, "generation is not shared");
+            expectTrue(decoded->sharedGzip.size() == 1 &&
+                           decoded->sharedGzip[0].data == page.sharedGzip[0].data &&
+                           decoded->sharedGzip[0].crc == page.sharedGzip[0].crc &&
+                           decoded->sharedGzip[0].size == page.sharedGzip[0].size,
+                       "gzip blocks round trip");
+
+            const auto bare = RenderCache::decode(RenderCache::encode(page, 1, false), nullptr);
+            expectTrue(bare != nullptr && bare->sharedGzip.empty(), "gzip blocks optional");
+
+            const auto bytes = RenderCache::encode(page, 1, true);
+            expectTrue(RenderCache::decode(bytes.substr(0, bytes.size() - 1), nullptr) == nullptr,
+                       "truncated value rejected");
+            expectTrue(RenderCache::decode(bytes + "x", nullptr) == nullptr,
+                       "trailing bytes rejected");
+            expectTrue(RenderCache::decode("<p>plain</p>", nullptr) == nullptr,
+                       "foreign value rejected");
+        }
+
+        {
+            auto ok = SsrRenderResult{};
+            expectTrue(RenderCache::cacheable(ok), "200 cacheable");
+            ok.headers["set-Cookie"] = "sid=1";
+            expectTrue(!RenderCache::cacheable(ok), "Set-Cookie not cacheable");
+            auto failed = SsrRenderResult{};
+            failed.status = 503;
+            expectTrue(!RenderCache::cacheable(failed), "5xx not cacheable");
+            auto noStore = SsrRenderResult{};
+            noStore.headers["Cache-Control"] = "No-Store";
+            expectTrue(!RenderCache::cacheable(noStore), "no-store not cacheable");
+            auto personal = SsrRenderResult{};
+            personal.headers["cache-control"] = "max-age=0, private=\"set-cookie\"";
+            expectTrue(!RenderCache::cacheable(personal), "private not cacheable");
+            auto shared = SsrRenderResult{};
+            shared.headers["Cache-Control"] = "public, max-age=60, x-privateish";
+            expectTrue(RenderCache::cacheable(shared), "public page cacheable");
+        }
+
+        {
+            RenderCache cache(1 << 20, 4);
+            const auto key = RenderCache::makeKey("/", "en", "ocean", "{}");
+            int renders = 0;
+            const auto produce = [&]() {
+                ++renders;
+                return makeValue("<p>home</p>");
+            };
+            const auto first = cache.getOrRender(key, makePolicy(10s), produce);
+            const auto second = cache.getOrRender(key, makePolicy(10s), produce);
+            expectTrue(first.outcome == RenderCache::Outcome::kMiss, "first lookup misses");
+            expectTrue(second.outcome == RenderCache::Outcome::kHit, "second lookup hits");
+            expectTrue(second.value == first.value, "hit shares the stored value");
+            expectTrue(renders == 1, "hit does not render");
+
+            const auto stats = cache.stats();
+            expectTrue(stats.hits == 1 && stats.misses == 1 && stats.entries == 1, "hit stats");
+            cache.clear();
+            expectTrue(cache.stats().entries == 0 && cache.stats().bytes == 0, "clear");
+        }
+
+        {
+            RenderCache cache(1 << 20, 1);
+            const auto key = RenderCache::makeKey("/error", "en", "ocean", "{}");
+            int renders = 0;
+            const auto produce = [&]() {
+                ++renders;
+                return makeValue("oops", 500);
+            };
+            (void)cache.getOrRender(key, makePolicy(10s), produce);
+            (void)cache.getOrRender(key, makePolicy(10s), produce);
+            expectTrue(renders == 2, "uncacheable results are not stored");
+        }
+
+        {
+            RenderCache cache(1 << 20, 1);
+            const auto key = RenderCache::makeKey("/swr", "en", "ocean", "{}");
+            const auto policy = makePolicy(1ms, 10s);
+            (void)cache.getOrRender(key, policy, [] { return makeValue("v1"); });
+            std::this_thread::sleep_for(5ms);
+
+            const auto stale = cache.getOrRender(key, policy, [] { return makeValue("unused"); });
+            expectTrue(stale.outcome == RenderCache::Outcome::kStale, "expired entry served stale");
+            expectTrue(stale.refresh, "first stale hit claims refresh");
+            expectTrue(stale.value->html == "v1", "stale value served");
+            const auto again = cache.getOrRender(key, policy, [] { return makeValue("unused"); });
+            expectTrue(!again.refresh, "refresh claimed only once");
+
+            cache.refreshFailed(key);
+            const auto retry = cache.getOrRender(key, policy, [] { return makeValue("unused"); });
+            expectTrue(retry.refresh, "failed refresh can be retried");
+
+            cache.store(key, makePolicy(10s), makeValue("v2"));
+            const auto fresh = cache.getOrRender(key, policy, [] { return makeValue("unused"); });
+            expectTrue(fresh.outcome == RenderCache::Outcome::kHit, "refreshed entry is fresh");
+            expectTrue(fresh.value->html == "v2", "refreshed value served");
+            expectTrue(cache.stats().refreshFailures == 1, "refresh failure counted");
+        }
+
+        {
+            RenderCache cache(1 << 20, 1);
+            const auto key = RenderCache::makeKey("/shared", "en", "ocean", "{}");
+            auto aged = std::make_shared<CachedRender>();
+            aged->html = "from another node";
+            aged->inheritedAge = 10s;
+            const auto policy = makePolicy(10s, 10s);
+            (void)cache.getOrRender(key, policy, [&] { return aged; });
+            const auto next = cache.getOrRender(key, policy, [] { return makeValue("unused"); });
+            expectTrue(next.outcome == RenderCache::Outcome::kStale,
+                       "inherited age counts against the TTL");
+        }
+
+        {
+            // A render that started before a reload stores after the clear.
+            RenderCache cache(1 << 20, 1);
+            const auto key = RenderCache::makeKey("/reload", "en", "ocean", "{}");
+            const auto policy = makePolicy(10s);
+            const auto ofGeneration = [](const std::string &html, std::uint64_t generation) {
+                auto value = std::make_shared<CachedRender>();
+                value->html = html;
+                value->generation = generation;
+                return RenderCache::Value(std::move(value));
+            };
+            expectTrue(!cache.contains(key, 1), "empty cache contains nothing");
+            (void)cache.getOrRender(key, policy, [&] { return ofGeneration("old", 1); }, 1);
+            expectTrue(cache.contains(key, 1) && !cache.contains(key, 2),
+                       "contains checks the generation");
+            cache.clear();
+            cache.store(key, policy, ofGeneration("late old", 1));
+
+            int renders = 0;
+            const auto fresh = cache.getOrRender(
+                key,
+                policy,
+                [&] {
+                    ++renders;
+                    return ofGeneration("new", 2);
+                },
+                2);
+            expectTrue(fresh.outcome == RenderCache::Outcome::kMiss && fresh.value->html == "new",
+                       "entry of an older generation is not served");
+            const auto hit = cache.getOrRender(
+                key, policy, [&] { return ofGeneration("unused", 2); }, 2);
+            expectTrue(hit.outcome == RenderCache::Outcome::kHit && hit.value->html == "new" &&
+                           renders == 1,
+                       "new generation's render replaces it");
+        }
+
+        {
+            // Two ~3KB values do not fit a 4KB budget together.
+            RenderCache cache(4096, 1);
+            const auto policy = makePolicy(10s);
+            const std::string body(3000, 'x');
+            const auto keyA = RenderCache::makeKey("/a", "en", "ocean", "{}");
+            const auto keyB = RenderCache::makeKey("/b", "en", "ocean", "{}");
+            (void)cache.getOrRender(keyA, policy, [&] { return makeValue(body); });
+            (void)cache.getOrRender(keyB, policy, [&] { return makeValue(body); });
+            const auto stats = cache.stats();
+            expectTrue(stats.evictions == 1 && stats.entries == 1, "LRU eviction under budget");
+            expectTrue(stats.bytes <= 4096, "bytes within budget");
+            const auto b = cache.getOrRender(keyB, policy, [&] { return makeValue("unused"); });
+            expectTrue(b.outcome == RenderCache::Outcome::kHit, "most recent entry kept");
+
+            const std::string huge(8192, 'x');
+            const auto keyHuge = RenderCache::makeKey("/huge", "en", "ocean", "{}");
+            (void)cache.getOrRender(keyHuge, policy, [&] { return makeValue(huge); });
+            expectTrue(cache.stats().entries == 1, "oversized value not cached");
+        }
+
+        {
+            RenderCache cache(1 << 20, 8);
+            const auto key = RenderCache::makeKey("/slow", "en", "ocean", "{}");
+            std::atomic<int> renders{0};
+            std::atomic<bool> release{false};
+            const auto produce = [&]() {
+                renders.fetch_add(1);
+                while (!release.load()) {
+                    std::this_thread::sleep_for(1ms);
+                }
+                return makeValue("slow");
+            };
+
+            constexpr int kThreads = 8;
+            std::vector<std::thread> threads;
+            std::atomic<int> done{0};
+            std::atomic<int> sawSlow{0};
+            for (int i = 0; i < kThreads; ++i) {
+                threads.emplace_back([&]() {
+                    const auto lookup = cache.getOrRender(key, makePolicy(10s), produce);
+                    if (lookup.value && lookup.value->html == "slow") {
+                        sawSlow.fetch_add(1);
+                    }
+                    done.fetch_add(1);
+                });
+            }
+            while (cache.stats().misses + cache.stats().coalesced < kThreads) {
+                std::this_thread::sleep_for(1ms);
+            }
+            release.store(true);
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            expectTrue(renders.load() == 1, "concurrent misses collapse into one render");
+            expectTrue(sawSlow.load() == kThreads, "waiters receive the leader's value");
+            expectTrue(cache.stats().coalesced == kThreads - 1, "coalesced waiters counted");
+        }
+
+        {
+            RenderCache cache(1 << 20, 1);
+            const auto key = RenderCache::makeKey("/throws", "en", "ocean", "{}");
+            bool threw = false;
+            try {
+                (void)cache.getOrRender(key, makePolicy(10s), []() -> RenderCache::Value {
+                    throw std::runtime_error("render failed");
+                });
+            } catch (const std::runtime_error &) {
+                threw = true;
+            }
+            expectTrue(threw, "producer exception propagates");
+            const auto next = cache.getOrRender(key, makePolicy(10s), [] { return makeValue("ok"); });
+            expectTrue(next.outcome == RenderCache::Outcome::kMiss, "failed render leaves no entry");
+        }
+
+        std::cout << "[render-cache-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[render-cache-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
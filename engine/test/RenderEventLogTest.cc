@@ -0,0 +1,137 @@
+#include "hydra/RenderEventLog.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using hydra::RenderEvent;
+using hydra::RenderEventLog;
+using namespace std::chrono_literals;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+RenderEvent makeEvent(std::uint64_t index) {
+    RenderEvent event;
+    event.renderIndex = index;
+    event.httpStatus = 200;
+    event.route.assign("/posts/" + std::to_string(index));
+    return event;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            hydra::FixedText<8> text;
+            text.assign("short");
+            expectTrue(text.view() == "short" && !text.truncated(), "fixed text fits");
+            text.assign("much longer than eight");
+            expectTrue(text.view() == "much lon" && text.truncated(), "fixed text truncates");
+        }
+
+        {
+            constexpr int kThreads = 4;
+            constexpr int kPerThread = 2000;
+            std::mutex seenMutex;
+            std::vector<int> seen(kThreads * kPerThread, 0);
+            RenderEventLog::Options options;
+            options.ringCapacity = 64;
+            options.flushInterval = 1ms;
+            {
+                RenderEventLog log(options, [&](const RenderEvent &event) {
+                    std::lock_guard<std::mutex> lock(seenMutex);
+                    ++seen[event.renderIndex];
+                });
+                std::vector<std::thread> threads;
+                for (int t = 0; t < kThreads; ++t) {
+                    threads.emplace_back([&log, t]() {
+                        for (int i = 0; i < kPerThread; ++i) {
+                            const auto index = static_cast<std::uint64_t>(t * kPerThread + i);
+                            // Spin on a full ring so every event is delivered.
+                            while (!log.record(makeEvent(index))) {
+                                std::this_thread::sleep_for(100us);
+                            }
+                        }
+                    });
+                }
+                for (auto &thread : threads) {
+                    thread.join();
+                }
+                log.flush();
+                expectTrue(log.recordedCount() == kThreads * kPerThread, "recorded count");
+            }
+            for (const auto count : seen) {
+                expectTrue(count == 1, "each event delivered exactly once");
+            }
+        }
+
+        {
+            std::atomic<bool> entered{false};
+            std::atomic<bool> release{false};
+            std::atomic<int> delivered{0};
+            RenderEventLog::Options options;
+            options.ringCapacity = 8;
+            options.flushInterval = 1ms;
+            RenderEventLog log(options, [&](const RenderEvent &) {
+                entered.store(true);
+                while (!release.load()) {
+                    std::this_thread::sleep_for(1ms);
+                }
+                delivered.fetch_add(1);
+            });
+            log.record(makeEvent(0));
+            while (!entered.load()) {
+                std::this_thread::sleep_for(1ms);
+            }
+            // The drainer is blocked inside the sink holding slot 0, so the
+            // ring has room for 7 more.
+            int accepted = 0;
+            for (int i = 1; i <= 12; ++i) {
+                accepted += log.record(makeEvent(static_cast<std::uint64_t>(i))) ? 1 : 0;
+            }
+            expectTrue(accepted == 7, "record reports drops");
+            expectTrue(log.droppedCount() == 5, "full ring drops and counts");
+            release.store(true);
+            log.flush();
+            expectTrue(delivered.load() == 8, "queued events drained after release");
+        }
+
+        {
+            RenderEventLog::Options options;
+            options.sampleRate = 0.0;
+            options.slowThresholdUs = 1000;
+            RenderEventLog log(options, {});
+            expectTrue(log.shouldRecord(true, 0), "failures always recorded");
+            expectTrue(log.shouldRecord(false, 5000), "slow requests always recorded");
+            expectTrue(!log.shouldRecord(false, 10), "fast successes sampled out at rate 0");
+            expectTrue(log.sampledOutCount() == 1, "sampled-out counted");
+
+            options.sampleRate = 0.25;
+            options.slowThresholdUs = 0;
+            RenderEventLog sampled(options, {});
+            int kept = 0;
+            for (int i = 0; i < 20000; ++i) {
+                kept += sampled.shouldRecord(false, 10) ? 1 : 0;
+            }
+            expectTrue(kept > 4000 && kept < 6000, "sample rate roughly honoured");
+        }
+
+        std::cout << "[render-event-log-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[render-event-log-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,188 @@
+#include "hydra/RenderTrace.h"
+
+#include <json/reader.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using hydra::RenderTrace;
+using hydra::TraceExporter;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+Json::Value parseJson(const std::string &text) {
+    Json::CharReaderBuilder builder;
+    Json::Value value;
+    std::string errors;
+    std::istringstream input(text);
+    if (!Json::parseFromStream(builder, input, &value, &errors)) {
+        throw std::runtime_error("invalid json: " + errors);
+    }
+    return value;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            const auto parsed = RenderTrace::parseTraceparent(
+                "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+            expectTrue(parsed.has_value() && parsed->sampled, "valid traceparent");
+            expectTrue(parsed->traceId[0] == 0x4b && parsed->parentSpanId[7] == 0xb7,
+                       "traceparent ids decoded");
+            expectTrue(!RenderTrace::parseTraceparent(
+                            "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00")
+                            ->sampled,
+                       "unsampled flag");
+            expectTrue(!RenderTrace::parseTraceparent(
+                           "00-00000000000000000000000000000000-00f067aa0ba902b7-01"),
+                       "zero trace id rejected");
+            expectTrue(!RenderTrace::parseTraceparent(
+                           "00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01"),
+                       "uppercase hex rejected");
+            expectTrue(!RenderTrace::parseTraceparent("garbage"), "short header rejected");
+            expectTrue(RenderTrace::parseTraceparent(
+                           "01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-extra")
+                           .has_value(),
+                       "future versions may append fields");
+        }
+
+        {
+            const auto parent = RenderTrace::parseTraceparent(
+                "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+            RenderTrace trace("req-1", parent);
+            expectTrue(trace.traceIdHex() == "4bf92f3577b34da6a3ce929d0e0e4736",
+                       "parent trace id adopted");
+            const auto now = RenderTrace::Clock::now();
+            trace.addSpan("render", now, now + std::chrono::microseconds(2500));
+            trace.addSpan("bridge", now, now + std::chrono::microseconds(1000),
+                          "/hydra/internal/\"x\"");
+            trace.setRoute("/about", "about");
+            trace.finish(200, false);
+            trace.finish(500, true);
+
+            const auto timing = trace.serverTiming();
+            expectTrue(timing.find("render;dur=2.500") == 0, "server-timing span");
+            expectTrue(timing.find("bridge;desc=\"/hydra/internal/\\\"x\\\"\";dur=1.000") !=
+                           std::string::npos,
+                       "server-timing desc escaped");
+            expectTrue(timing.find(", total;dur=") != std::string::npos, "server-timing total");
+            expectTrue(trace.traceparent().rfind("00-4bf92f3577b34da6a3ce929d0e0e4736-", 0) == 0,
+                       "traceparent keeps the trace id");
+
+            Json::Value spans(Json::arrayValue);
+            trace.appendOtlpSpans(&spans);
+            expectTrue(spans.size() == 3, "root plus phase spans");
+            expectTrue(spans[0]["parentSpanId"].asString() == "00f067aa0ba902b7" &&
+                           spans[0]["status"]["code"].asInt() == 0,
+                       "root span parented, first finish wins");
+            expectTrue(spans[1]["parentSpanId"].asString() == spans[0]["spanId"].asString() &&
+                           spans[1]["name"].asString() == "hydra.render",
+                       "phase spans under the root");
+            expectTrue(std::stoull(spans[1]["endTimeUnixNano"].asString()) -
+                               std::stoull(spans[1]["startTimeUnixNano"].asString()) ==
+                           2500000ULL,
+                       "span duration in nanos");
+        }
+
+        {
+            RenderTrace outer("outer", std::nullopt);
+            expectTrue(RenderTrace::active() == nullptr, "nothing active by default");
+            {
+                RenderTrace::Activation activation(&outer);
+                expectTrue(RenderTrace::active() == &outer, "activation sets the trace");
+                {
+                    RenderTrace::Activation none(nullptr);
+                    expectTrue(RenderTrace::active() == nullptr, "nested activation");
+                }
+                expectTrue(RenderTrace::active() == &outer, "nested activation restored");
+            }
+            expectTrue(RenderTrace::active() == nullptr, "activation restored");
+            expectTrue(outer.traceIdHex().size() == 32 &&
+                           outer.traceIdHex() != std::string(32, '0'),
+                       "generated trace id");
+        }
+
+        {
+            RenderTrace trace("scoped", std::nullopt);
+            {
+                RenderTrace::Scope ended(&trace, "parse");
+                ended.end();
+            }
+            try {
+                RenderTrace::Scope failing(&trace, "bridge", "/hydra/internal/x");
+                throw std::runtime_error("bridge failed");
+            } catch (const std::runtime_error &) {
+            }
+            {
+                RenderTrace::Scope untraced(nullptr, "render");
+            }
+            const auto timing = trace.serverTiming();
+            expectTrue(timing.rfind("parse;dur=", 0) == 0 &&
+                           timing.find("bridge;desc=\"/hydra/internal/x\";dur=") !=
+                               std::string::npos &&
+                           timing.find("render") == std::string::npos,
+                       "scoped spans recorded once, null trace ignored");
+            Json::Value spans(Json::arrayValue);
+            trace.appendOtlpSpans(&spans);
+            expectTrue(spans.size() == 3 && spans[1]["status"]["code"].asInt() == 0 &&
+                           spans[2]["status"]["code"].asInt() == 2,
+                       "span left by an exception is an error");
+        }
+
+        {
+            std::mutex mutex;
+            std::vector<std::string> bodies;
+            TraceExporter::Options options;
+            options.maxQueuedTraces = 3;
+            options.maxBatchTraces = 2;
+            options.flushInterval = std::chrono::milliseconds(10000);
+            {
+                TraceExporter exporter(options, [&](std::string body) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    bodies.push_back(std::move(body));
+                });
+                for (int i = 0; i < 5; ++i) {
+                    auto trace = std::make_shared<RenderTrace>("req-" + std::to_string(i),
+                                                               std::nullopt);
+                    trace->finish(200, false);
+                    exporter.submit(std::move(trace));
+                }
+                exporter.flush();
+                expectTrue(exporter.exportedCount() + exporter.droppedCount() == 5,
+                           "every trace exported or dropped");
+                expectTrue(exporter.exportedCount() >= 3, "queue cap bounds drops");
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            expectTrue(!bodies.empty(), "sink received a batch");
+            const auto request = parseJson(bodies.front());
+            const auto &resource = request["resourceSpans"][0];
+            expectTrue(resource["resource"]["attributes"][0]["value"]["stringValue"].asString() ==
+                           "hydrastack",
+                       "service name resource attribute");
+            const auto &spans = resource["scopeSpans"][0]["spans"];
+            expectTrue(spans.size() >= 1 && spans.size() <= 2, "batch size honoured");
+            expectTrue(spans[0]["attributes"][0]["key"].asString() == "hydra.request_id",
+                       "spans carry the request id");
+        }
+
+        std::cout << "[render-trace-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[render-trace-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
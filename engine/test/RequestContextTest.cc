@@ -0,0 +1,194 @@
+#include "hydra/RequestContext.h"
+#include "hydra/SsrEnvelope.h"
+
+#include <drogon/HttpRequest.h>
+
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace rc = hydra::request_context;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        {
+            const auto ordered = rc::parseAcceptLanguageCandidates(
+                "de;q=0.5, fr-CH, *;q=0.9, en;q=0.8, it;q=0, es;q=0.8, ;q=0.1");
+            expectTrue((ordered == std::vector<std::string>{"fr-CH", "en", "es", "de"}),
+                       "q-value order, stable ties, no wildcard or q=0");
+            expectTrue(rc::parseAcceptLanguageCandidates("").empty(), "empty header");
+            expectTrue((rc::parseAcceptLanguageCandidates("pt;q=bad, en") ==
+                        std::vector<std::string>{"en"}),
+                       "unparseable q drops the range");
+
+            expectTrue(rc::normalizeLocaleTag(" ZH_hant--TW- ") == "zh-hant-tw", "locale tag");
+            expectTrue((rc::localeFallbackChain("zh-hant-tw") ==
+                        std::vector<std::string>{"zh-hant-tw", "zh-hant", "zh"}),
+                       "fallback chain");
+            expectTrue(rc::normalizeThemeTag(" Dark Mode!_2 ") == "darkmode_2", "theme tag");
+        }
+
+        {
+            expectTrue(rc::firstHeaderToken(" a.example , b.example") == "a.example",
+                       "first header token");
+            expectTrue(rc::sanitizeRequestId("  abc-123_x.y#<script>  ") == "abc-123_x.yscript",
+                       "request id sanitized");
+            expectTrue(rc::sanitizeRequestId(std::string(100, 'a')).size() == 64,
+                       "request id capped");
+            const auto nonce = rc::generateScriptNonce();
+            expectTrue(nonce.size() == 24 && nonce != rc::generateScriptNonce(), "nonce");
+        }
+
+        {
+            hydra::RequestContextOptions options;
+            options.supportedLocaleOrder = {"en", "fr"};
+            options.supportedLocales = {"en", "fr"};
+            options.supportedThemeOrder = {"ocean", "sunset"};
+            options.supportedThemes = {"ocean", "sunset"};
+            options.includeCookies = true;
+            options.allowedCookies = {"hydra_theme"};
+
+            auto req = drogon::HttpRequest::newHttpRequest();
+            req->setPath("/docs");
+            req->addHeader("host", "example.com");
+            req->addHeader("x-forwarded-proto", "https");
+            req->addHeader("accept-language", "fr-CA, en;q=0.5");
+            req->addHeader("authorization", "Bearer secret");
+            req->addHeader("user-agent", "bench");
+            req->addCookie("hydra_theme", "Sunset");
+            req->addCookie("session", "secret");
+
+            const hydra::RequestContextBuilder builder(options);
+            const auto context = builder.build(req, "/docs", "req-1");
+            expectTrue(context["url"].asString() == "https://example.com/docs", "absolute url");
+            expectTrue(context["locale"].asString() == "fr", "locale falls back to fr");
+            expectTrue(context["theme"].asString() == "sunset", "theme from cookie");
+            expectTrue(!context["headers"].isMember("authorization") &&
+                           context["headers"].isMember("user-agent"),
+                       "credential headers dropped");
+            expectTrue(context["cookies"].asString() == "hydra_theme=Sunset",
+                       "only allowed cookies forwarded");
+
+            const auto defaults = builder.build(nullptr, "/", "req-2");
+            expectTrue(defaults["locale"].asString() == "en" &&
+                           defaults["theme"].asString() == "ocean",
+                       "null request gets defaults");
+
+            const auto before = builder.localeCacheStats();
+            expectTrue(before.misses == 1 && before.hits == 0 && before.entries == 1,
+                       "first accept-language is a miss");
+            const auto again = builder.build(req, "/docs", "req-3");
+            expectTrue(again["locale"].asString() == "fr", "cached locale");
+            expectTrue(builder.localeCacheStats().hits == 1, "repeat accept-language hits");
+
+            auto overridden = drogon::HttpRequest::newHttpRequest();
+            overridden->addHeader("accept-language", "fr-CA, en;q=0.5");
+            overridden->addCookie("hydra_lang", "EN");
+            expectTrue(builder.build(overridden, "/", "req-4")["locale"].asString() == "en",
+                       "cookie overrides cached candidates");
+
+            auto uncachedOptions = options;
+            uncachedOptions.localeCacheEntries = 0;
+            const hydra::RequestContextBuilder uncached(uncachedOptions);
+            expectTrue(uncached.build(req, "/docs", "req-3") == again,
+                       "uncached context matches cached");
+            expectTrue(uncached.localeCacheStats().entries == 0, "cache disabled");
+        }
+
+        {
+            hydra::RequestContextOptions options;
+            options.includeCookies = true;
+            options.includeCookieMap = true;
+            options.lazyDetails = true;
+            const hydra::RequestContextBuilder builder(options);
+
+            auto req = drogon::HttpRequest::newHttpRequest();
+            req->addHeader("user-agent", "bench");
+            req->addCookie("session", "abc");
+
+            const auto context = builder.build(req, "/", "req-1");
+            expectTrue(!context.isMember("headers") && !context.isMember("cookies") &&
+                           !context.isMember("cookieMap"),
+                       "lazy fields omitted");
+            expectTrue(context["lazyFields"].size() == 3, "lazy fields listed");
+
+            const auto headers = builder.detailJson(req, "headers");
+            expectTrue(headers && headers->find("\"user-agent\":\"bench\"") != std::string::npos,
+                       "headers on demand");
+            expectTrue(!builder.detailJson(req, "locale").has_value(), "unknown detail");
+
+            expectTrue(!hydra::RequestContextBuilder::activeDetailJson("cookies").has_value(),
+                       "no active request");
+            {
+                hydra::RequestContextBuilder::Activation active(&builder, req);
+                expectTrue(hydra::RequestContextBuilder::activeDetailJson("cookies") ==
+                               std::optional<std::string>("\"session=abc\""),
+                           "active request cookies");
+            }
+            expectTrue(!hydra::RequestContextBuilder::activeDetailJson("cookies").has_value(),
+                       "activation restored");
+        }
+
+        {
+            expectTrue(!hydra::tryParseSsrEnvelope("<div>{}</div>").has_value(), "bare html");
+            expectTrue(!hydra::tryParseSsrEnvelope("{\"status\":404}").has_value(),
+                       "object without html");
+            const auto envelope = hydra::tryParseSsrEnvelope(
+                " {\"html\":\"<p>x</p>\",\"status\":200,\"redirect\":\" /login \","
+                "\"headers\":{\"X-Flag\":true},\"meta\":{\"title\":\" Hi \"}}");
+            expectTrue(envelope.has_value() && envelope->html == "<p>x</p>", "envelope html");
+            expectTrue(envelope->status == 302 && envelope->headers.at("Location") == "/login",
+                       "redirect forces 302");
+            expectTrue(envelope->headers.at("X-Flag") == "true", "bool header");
+            expectTrue(envelope->title == "Hi", "meta trimmed");
+
+            // Fields read off a V8 object go through the same rules.
+            hydra::SsrEnvelopeFields fields;
+            fields.html = "<p>y</p>";
+            fields.status = 404.0;
+            fields.headers.emplace_back("Cache-Control", "no-store");
+            fields.meta.emplace("canonical_url", " https://example.test/y ");
+            fields.meta.emplace("ogType", "article");
+            fields.meta.emplace("og_type", "website");
+            const auto finished = hydra::finishSsrEnvelope(std::move(fields));
+            expectTrue(finished.status == 404 && finished.html == "<p>y</p>", "fields status");
+            expectTrue(finished.canonicalUrl == "https://example.test/y", "snake_case alias");
+            expectTrue(finished.ogType == "article", "camelCase wins");
+            expectTrue(finished.headers.at("Cache-Control") == "no-store", "fields headers");
+
+            hydra::SsrEnvelopeFields outOfRange;
+            outOfRange.status = 42.0;
+            outOfRange.headers.emplace_back("Location", "/next");
+            const auto located = hydra::finishSsrEnvelope(std::move(outOfRange));
+            expectTrue(located.status == 302, "location header forces 302");
+            const auto stringStatus =
+                hydra::tryParseSsrEnvelope("{\"html\":\"\",\"status\":\"404\"}");
+            expectTrue(stringStatus->status == 200, "non-numeric status ignored");
+            const auto fragment = hydra::tryParseSsrEnvelope(
+                "{\"html\":\"<li>1</li>\",\"props\":{ \"items\": [1] }}");
+            expectTrue(fragment->propsJson == "{\"items\":[1]}", "props delta compacted");
+            expectTrue(hydra::tryParseSsrEnvelope("{\"html\":\"\",\"props\":[1]}")
+                           ->propsJson.empty(),
+                       "non-object props ignored");
+        }
+
+        std::cout << "[request-context-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[request-context-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
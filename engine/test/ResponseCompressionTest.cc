@@ -0,0 +1,143 @@
+#include "hydra/HtmlShell.h"
+#include "hydra/ResponseCompression.h"
+
+#include <zlib.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using hydra::ContentEncoding;
+
+void expectTrue(bool condition, const std::string &label) {
+    if (!condition) {
+        throw std::runtime_error("assertion failed: " + label);
+    }
+}
+
+std::string gunzip(const std::string &compressed) {
+    z_stream stream{};
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        throw std::runtime_error("inflateInit2 failed");
+    }
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    std::string out;
+    char buffer[4096];
+    int status = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_NO_FLUSH);
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    const bool trailingBytes = stream.avail_in != 0;
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END || trailingBytes) {
+        throw std::runtime_error("gzip stream did not decode cleanly");
+    }
+    return out;
+}
+
+std::string samplePage(std::size_t repeat) {
+    std::string html;
+    for (std::size_t i = 0; i < repeat; ++i) {
+        html += "<li class=\"post\"><a href=\"/posts/" + std::to_string(i) + "\">Post " +
+                std::to_string(i) + "</a></li>";
+    }
+    return html;
+}
+
+}  // namespace
+
+int main() {
+    try {
+        const auto negotiate = [](std::string_view header) {
+            return hydra::negotiateContentEncoding(header, true, true);
+        };
+        const auto brotliOrGzip =
+            hydra::brotliSupported() ? ContentEncoding::kBrotli : ContentEncoding::kGzip;
+        expectTrue(negotiate("") == ContentEncoding::kIdentity, "no header");
+        expectTrue(negotiate("gzip, deflate") == ContentEncoding::kGzip, "gzip");
+        expectTrue(negotiate("gzip, deflate, br, zstd") == brotliOrGzip, "brotli preferred");
+        expectTrue(negotiate("br;q=0.5, gzip;q=0.9") == ContentEncoding::kGzip, "q ordering");
+        expectTrue(negotiate("gzip;q=0, br;q=0") == ContentEncoding::kIdentity, "q=0 refused");
+        expectTrue(negotiate("*;q=0.1, br;q=0") == ContentEncoding::kGzip, "wildcard");
+        expectTrue(negotiate("X-GZIP") == ContentEncoding::kGzip, "case and x-gzip");
+        expectTrue(hydra::negotiateContentEncoding("br, gzip", true, false) ==
+                       ContentEncoding::kGzip,
+                   "brotli disabled");
+        expectTrue(hydra::negotiateContentEncoding("gzip", false, true) ==
+                       ContentEncoding::kIdentity,
+                   "gzip disabled");
+
+        const auto page = samplePage(400);
+        const auto gzipped = hydra::compressBody(page, ContentEncoding::kGzip, 6);
+        expectTrue(gunzip(gzipped) == page, "gzip round trip");
+        expectTrue(gzipped.size() * 4 < page.size(), "gzip shrinks markup");
+        if (hydra::brotliSupported()) {
+            const auto brotli = hydra::compressBody(page, ContentEncoding::kBrotli, 5);
+            expectTrue(!brotli.empty() && brotli.size() < gzipped.size(), "brotli shrinks more");
+        }
+
+        // Blocks compressed separately join into one member.
+        const auto head = hydra::deflateBlock(page.substr(0, 7000), 6);
+        const auto middle = hydra::deflateBlock(" nonce=\"abc\"", 1);
+        const auto empty = hydra::deflateBlock("", 6);
+        const auto tail = hydra::deflateBlock(page.substr(7000), 9);
+        expectTrue(gunzip(hydra::gzipFromBlocks({&head, &middle, &empty, &tail})) ==
+                       page.substr(0, 7000) + " nonce=\"abc\"" + page.substr(7000),
+                   "spliced blocks decode in order");
+        expectTrue(gunzip(hydra::gzipFromBlocks({})).empty(), "empty member");
+
+        // Shell runs concatenate to wrap(), and only odd runs change per request.
+        hydra::HtmlShellAssets assets;
+        assets.clientJsModule = true;
+        const hydra::CompiledHtmlShell shell(assets);
+        const std::string controllerProps = "{\"page\":\"home\",\"note\":\"</script>\"}";
+        const auto withRequest = [&](const std::string &requestId) {
+            return controllerProps.substr(0, controllerProps.size() - 1) +
+                   ",\"__hydra_request\":{\"requestId\":\"" + requestId + "\"}}";
+        };
+        const auto requestBegin = controllerProps.size() - 1;
+        const auto propsA = withRequest("a1");
+        const auto propsB = withRequest("b22");
+        const auto runsA = shell.wrapRuns(page, propsA, requestBegin, propsA.size() - 1, {},
+                                          "nonceA");
+        const auto runsB = shell.wrapRuns(page, propsB, requestBegin, propsB.size() - 1, {},
+                                          "nonceBB");
+        std::string joined;
+        for (const auto &run : runsA) {
+            joined += run;
+        }
+        expectTrue(joined == shell.wrap(page, propsA, {}, "nonceA"), "runs equal wrap()");
+        expectTrue(runsA.size() == runsB.size() && runsA.size() % 2 == 1, "stable run layout");
+        for (std::size_t i = 0; i < runsA.size(); i += 2) {
+            expectTrue(runsA[i] == runsB[i], "shared run " + std::to_string(i));
+        }
+
+        std::vector<hydra::DeflateBlock> shared;
+        for (std::size_t i = 0; i < runsA.size(); i += 2) {
+            shared.push_back(hydra::deflateBlock(runsA[i], 6));
+        }
+        std::vector<hydra::DeflateBlock> perRequest;
+        for (std::size_t i = 1; i < runsB.size(); i += 2) {
+            perRequest.push_back(hydra::deflateBlock(runsB[i], 1));
+        }
+        std::vector<const hydra::DeflateBlock *> blocks;
+        for (std::size_t i = 0; i < runsB.size(); ++i) {
+            blocks.push_back(i % 2 == 0 ? &shared[i / 2] : &perRequest[i / 2]);
+        }
+        expectTrue(gunzip(hydra::gzipFromBlocks(blocks)) == shell.wrap(page, propsB, {}, "nonceBB"),
+                   "cached runs splice into another request's document");
+
+        std::cout << "[response-compression-test] PASS\n";
+        return 0;
+    } catch (const std::exception &ex) {
+        std::cerr << "[response-compression-test] FAIL: " << ex.what() << '\n';
+        return 1;
+    }
+}
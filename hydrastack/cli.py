@@ -4,6 +4,7 @@ from __future__ import annotations
 
 import argparse
 import ast
+import json
 import os
 import re
 import shutil
@@ -11,6 +12,8 @@ import signal
 import struct
 import subprocess
 import sys
+import urllib.error
+import urllib.request
 from pathlib import Path
 from typing import Dict, List, Mapping, Sequence, Set, Tuple
 
@@ -1197,6 +1200,45 @@ def cmd_run(args: argparse.Namespace) -> int:
     return 0
 
 
+def cmd_prerender(args: argparse.Namespace) -> int:
+    url = args.url.rstrip("/") + "/__hydra/prerender"
+    body = json.dumps({"paths": list(args.paths)}).encode("utf-8")
+    headers = {"Content-Type": "application/json"}
+    if args.token:
+        headers["Authorization"] = f"Bearer {args.token}"
+    request = urllib.request.Request(
+        url,
+        data=body,
+        method="POST",
+        headers=headers,
+    )
+    try:
+        with urllib.request.urlopen(request, timeout=10) as response:
+            payload = json.loads(response.read().decode("utf-8") or "{}")
+    except urllib.error.HTTPError as exc:
+        if exc.code == 404:
+            raise ValueError(
+                f"{url} is disabled; set custom_config.hydra_admin.enabled in the server config"
+            ) from exc
+        if exc.code == 403:
+            raise ValueError(
+                f"{url} refused the request; it must come from the server host "
+                "with the configured --token"
+            ) from exc
+        raise ValueError(f"{url} failed: {exc}") from exc
+    except urllib.error.URLError as exc:
+        raise ValueError(f"could not reach {url}: {exc}") from exc
+    except json.JSONDecodeError as exc:
+        raise ValueError(f"unexpected response from {url}: {exc}") from exc
+
+    queued = int(payload.get("queued", 0))
+    if queued == 0:
+        print_hydra("No prerendered routes matched; is prerender.enabled set?", color=ANSI_YELLOW)
+    else:
+        print_hydra(f"Queued {queued} prerendered variant(s) for regeneration", color=ANSI_GREEN)
+    return 0
+
+
 def build_parser() -> argparse.ArgumentParser:
     parser = argparse.ArgumentParser(
         prog="hydra",
@@ -1336,6 +1378,27 @@ def build_parser() -> argparse.ArgumentParser:
     )
     run_cmd.set_defaults(func=cmd_run)
 
+    prerender_cmd = subparsers.add_parser(
+        "prerender",
+        help="Regenerate prerendered routes on a running server",
+    )
+    prerender_cmd.add_argument(
+        "paths",
+        nargs="*",
+        help="Route paths to regenerate (default: every prerendered route)",
+    )
+    prerender_cmd.add_argument(
+        "--url",
+        default="http://127.0.0.1:8080",
+        help="Base URL of the running server (default: http://127.0.0.1:8080)",
+    )
+    prerender_cmd.add_argument(
+        "--token",
+        default=os.environ.get("HYDRA_ADMIN_TOKEN", ""),
+        help="custom_config.hydra_admin.token of the server (default: $HYDRA_ADMIN_TOKEN)",
+    )
+    prerender_cmd.set_defaults(func=cmd_prerender)
+
     return parser
 
 
@@ -178,6 +178,18 @@ def run_tests(base_url: str) -> None:
     xcto_header = home_headers.get("X-Content-Type-Options") or home_headers.get("x-content-type-options", "")
     assert_equal(xcto_header.lower(), "nosniff", "X-Content-Type-Options header")
 
+    status, html, stream_headers = fetch_text(f"{base_url}/posts/123?stream=1")
+    assert_equal(status, 200, "GET /posts/123 (stream) status")
+    assert_contains(html, "<div id=\"root\">", "streamed shell root container")
+    assert_contains(html, "Post 123: Controller-provided test data", "streamed post content")
+    props = parse_props(html)
+    route = props.get("__hydra_route", {})
+    assert_equal(route.get("pageId"), "post_detail", "streamed post pageId")
+    csp_header = stream_headers.get("Content-Security-Policy") or stream_headers.get("content-security-policy", "")
+    assert_contains(csp_header, "default-src 'self'", "streamed CSP default-src policy")
+    if "__HYDRA_SSR_ERROR__" in html:
+        raise AssertionError("streamed render reported an SSR error marker")
+
     status, html, _ = fetch_text(
         f"{base_url}/",
         headers={"Accept-Language": "fr", "Cookie": "hydra_lang=ko"},
@@ -1,4 +1,4 @@
-import { hydrateRoot } from "react-dom/client";
+import { createRoot, hydrateRoot } from "react-dom/client";
 
 import App from "./App";
 import {
@@ -62,8 +62,12 @@ if (root) {
       break;
   }
 
-  hydrateRoot(
-    root,
-    <App url={route.routeUrl} initialProps={pageProps} />
-  );
+  const app = <App url={route.routeUrl} initialProps={pageProps} />;
+  // A streamed render that failed midway leaves partial markup plus this
+  // marker; render from scratch instead of hydrating it.
+  if (document.getElementById("__HYDRA_SSR_ERROR__")) {
+    createRoot(root).render(app);
+  } else {
+    hydrateRoot(root, app);
+  }
 }
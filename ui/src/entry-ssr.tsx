@@ -1,11 +1,40 @@
-import { renderToString } from "react-dom/server";
+import { renderToReadableStream, renderToString } from "react-dom/server";
 
 import App from "./App";
 import { attachRouteContract, ensureString, resolveHydraRoute, type JsonObject } from "./routeContract";
 
+type HydraStreamWrite = (chunk: string | Uint8Array) => void;
+type HydraRenderFragment = (
+  url: string,
+  propsJson: string,
+  requestContextJson: string | undefined,
+  componentId: string
+) => HydraRenderEnvelope;
+type HydraRenderStream = (
+  url: string,
+  propsJson: string,
+  requestContextJson: string | undefined,
+  write: HydraStreamWrite
+) => Promise<void> | void;
+
 declare global {
   interface Window {
-    render?: (url: string, propsJson: string, requestContextJson?: string) => string;
+    render?: (
+      url: string,
+      propsJson: string,
+      requestContextJson?: string
+    ) => string | HydraRenderEnvelope;
+    renderStream?: HydraRenderStream;
+    renderFragment?: HydraRenderFragment;
+  }
+
+  interface HydraRenderEnvelope {
+    html: string;
+    status?: number;
+    headers?: Record<string, string | number | boolean>;
+    meta?: Record<string, string>;
+    redirect?: string | null;
+    props?: JsonObject;
   }
 
   interface HydraBridgeResponse {
@@ -16,11 +45,19 @@ declare global {
 
   interface HydraGlobalApi {
     fetch?: (request: Record<string, unknown> | string) => HydraBridgeResponse;
+    fetchAsync?: (request: Record<string, unknown> | string) => Promise<HydraBridgeResponse>;
   }
 
   interface GlobalThis {
-    render?: (url: string, propsJson: string, requestContextJson?: string) => string;
+    render?: (
+      url: string,
+      propsJson: string,
+      requestContextJson?: string
+    ) => string | HydraRenderEnvelope;
+    renderStream?: HydraRenderStream;
+    renderFragment?: HydraRenderFragment;
     hydra?: HydraGlobalApi;
+    __hydraRequestDetail?: (name: string) => string | undefined;
   }
 }
 
@@ -36,13 +73,48 @@ function parseProps(propsJson: string): Record<string, unknown> {
   }
 }
 
+// With request_context.lazy_details the server lists headers/cookies under
+// `lazyFields` instead of sending them; each is fetched from the host on
+// first read and then kept.
+function attachLazyFields(context: Record<string, unknown>): Record<string, unknown> {
+  const lazyFields = context.lazyFields;
+  if (!Array.isArray(lazyFields)) {
+    return context;
+  }
+  delete context.lazyFields;
+
+  for (const field of lazyFields) {
+    if (typeof field !== "string") {
+      continue;
+    }
+    Object.defineProperty(context, field, {
+      configurable: true,
+      enumerable: true,
+      get() {
+        let value: unknown = field === "cookies" ? "" : {};
+        const raw = globalThis.__hydraRequestDetail?.(field);
+        if (typeof raw === "string") {
+          try {
+            value = JSON.parse(raw);
+          } catch {
+            // Keep the empty default.
+          }
+        }
+        Object.defineProperty(context, field, { value, enumerable: true, writable: true });
+        return value;
+      }
+    });
+  }
+  return context;
+}
+
 function parseRequestContext(requestContextJson: string | undefined): Record<string, unknown> {
   if (!requestContextJson) {
     return {};
   }
 
   try {
-    return JSON.parse(requestContextJson) as Record<string, unknown>;
+    return attachLazyFields(JSON.parse(requestContextJson) as Record<string, unknown>);
   } catch {
     return {};
   }
@@ -134,12 +206,18 @@ function applySsrTestHooks(
   return props;
 }
 
-// SSR contract: globalThis.render(url, propsJson, requestContextJson) -> app HTML fragment.
-globalThis.render = (
+type ResolvedPage = {
+  routeUrl: string;
+  props: JsonObject;
+  status: number;
+  redirect: string | null;
+};
+
+function resolvePage(
   url: string,
   propsJson: string,
   requestContextJson?: string
-): string => {
+): ResolvedPage {
   const parsedProps = parseProps(propsJson);
   const requestContext = parseRequestContext(requestContextJson);
   const propsWithContext: JsonObject = {
@@ -216,15 +294,93 @@ globalThis.render = (
       break;
   }
 
-  const hydratedProps = applySsrTestHooks(pageProps);
-  const appHtml = redirect
+  return {
+    routeUrl: route.routeUrl,
+    props: applySsrTestHooks(pageProps),
+    status,
+    redirect
+  };
+}
+
+// SSR contract: globalThis.render(url, propsJson, requestContextJson) -> app HTML fragment,
+// or an envelope object the host reads field by field (no JSON round trip).
+globalThis.render = (
+  url: string,
+  propsJson: string,
+  requestContextJson?: string
+): HydraRenderEnvelope => {
+  const page = resolvePage(url, propsJson, requestContextJson);
+  const appHtml = page.redirect
     ? ""
-    : renderToString(<App url={route.routeUrl} initialProps={hydratedProps} />);
+    : renderToString(<App url={page.routeUrl} initialProps={page.props} />);
 
-  return JSON.stringify({
+  return {
     html: appHtml,
-    status,
+    status: page.status,
     headers: {},
-    redirect
-  });
+    redirect: page.redirect
+  };
+};
+
+// Streaming contract: globalThis.renderStream(url, propsJson, requestContextJson, write).
+// The shell head is already on the wire; app HTML goes to the native `write`
+// and the returned promise settles once the root content is complete.
+globalThis.renderStream = async (
+  url: string,
+  propsJson: string,
+  requestContextJson: string | undefined,
+  write: HydraStreamWrite
+): Promise<void> => {
+  const page = resolvePage(url, propsJson, requestContextJson);
+  if (page.redirect) {
+    return;
+  }
+
+  const element = <App url={page.routeUrl} initialProps={page.props} />;
+  if (typeof ReadableStream === "undefined" || typeof renderToReadableStream !== "function") {
+    write(renderToString(element));
+    return;
+  }
+
+  const stream = await renderToReadableStream(element);
+  const reader = stream.getReader();
+  for (;;) {
+    const { done, value } = await reader.read();
+    if (done) {
+      break;
+    }
+    write(value);
+  }
+};
+
+// Fragment contract: globalThis.renderFragment(url, propsJson, requestContextJson, componentId)
+// renders one registered subtree without the shell. `props` is what the client
+// needs to hydrate or re-render it; the request context stays on the server.
+const fragmentComponents: Record<string, (page: ResolvedPage) => JSX.Element> = {
+  app: (page) => <App url={page.routeUrl} initialProps={page.props} />
+};
+
+globalThis.renderFragment = (
+  url: string,
+  propsJson: string,
+  requestContextJson: string | undefined,
+  componentId: string
+): HydraRenderEnvelope => {
+  const component = Object.prototype.hasOwnProperty.call(fragmentComponents, componentId)
+    ? fragmentComponents[componentId]
+    : undefined;
+  if (!component) {
+    return { html: "", status: 404, headers: {} };
+  }
+
+  const page = resolvePage(url, propsJson, requestContextJson);
+  const clientProps: JsonObject = { ...page.props };
+  delete clientProps.__hydra_request;
+  return {
+    html: page.redirect ? "" : renderToString(component(page)),
+    status: page.status,
+    headers: {},
+    redirect: page.redirect,
+    props: clientProps
+  };
 };
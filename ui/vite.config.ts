@@ -1,5 +1,6 @@
 import fs from "node:fs";
 import { resolve } from "node:path";
+import zlib from "node:zlib";
 import postcss from "postcss";
 import { defineConfig, type Plugin, type UserConfig } from "vite";
 import react from "@vitejs/plugin-react";
@@ -15,7 +16,10 @@ type CssObfuscationConfig = {
 };
 
 type HydraPluginConfig = Record<string, unknown>;
-const GENERATED_ASSET_PATTERN = /^.+-[a-z0-9_-]{8,}\.[a-z0-9]+(?:\.map)?$/i;
+const GENERATED_ASSET_PATTERN = /^.+-[a-z0-9_-]{8,}\.[a-z0-9]+(?:\.map)?(?:\.gz|\.br)?$/i;
+const PRECOMPRESSED_ASSET_PATTERN = /^.+-[a-z0-9_-]{8,}\.(?:js|css)$/i;
+// Below this, the sidecar saves less than its own request headers.
+const PRECOMPRESS_MIN_BYTES = 1024;
 const LEGACY_GENERATED_ASSET_FILES = new Set([
   "client.js",
   "client.js.map",
@@ -110,6 +114,26 @@ function readCssObfuscationConfig(): CssObfuscationConfig {
   return { enabled, emitClassmap };
 }
 
+function readStaticSidecarsEnabled(): boolean {
+  const raw = readHydraPluginConfig().compression;
+  let enabled = true;
+  if (raw && typeof raw === "object") {
+    const value = (raw as Record<string, unknown>).static_sidecars;
+    if (typeof value === "boolean") {
+      enabled = value;
+    }
+  }
+
+  if (process.env.HYDRA_STATIC_SIDECARS === "1") {
+    enabled = true;
+  }
+  if (process.env.HYDRA_STATIC_SIDECARS === "0") {
+    enabled = false;
+  }
+
+  return enabled;
+}
+
 function collectSourceFiles(dirPath: string): string[] {
   const out: string[] = [];
   if (!fs.existsSync(dirPath)) {
@@ -819,6 +843,57 @@ function createPruneHashedAssetsPlugin(options: { enabled: boolean }): Plugin {
   };
 }
 
+// Writes .br and .gz files beside each hashed script and stylesheet at the
+// highest levels, paid once per build, so Drogon's static handler can serve
+// them without compressing on the event loop.
+function createPrecompressPlugin(options: { enabled: boolean }): Plugin {
+  return {
+    name: "hydra-precompress-assets",
+    apply: "build",
+    writeBundle(outputOptions, bundle) {
+      if (!options.enabled) {
+        return;
+      }
+
+      const outputDir = typeof outputOptions.dir === "string" ? outputOptions.dir : outDir;
+      for (const emitted of Object.values(bundle)) {
+        const fileName = emitted.fileName;
+        if (!PRECOMPRESSED_ASSET_PATTERN.test(fileName)) {
+          continue;
+        }
+        const filePath = resolve(outputDir, fileName);
+        if (!fs.existsSync(filePath)) {
+          continue;
+        }
+        const source = fs.readFileSync(filePath);
+        if (source.length < PRECOMPRESS_MIN_BYTES) {
+          continue;
+        }
+
+        const brotli = zlib.brotliCompressSync(source, {
+          params: {
+            [zlib.constants.BROTLI_PARAM_MODE]: zlib.constants.BROTLI_MODE_TEXT,
+            [zlib.constants.BROTLI_PARAM_QUALITY]: zlib.constants.BROTLI_MAX_QUALITY,
+            [zlib.constants.BROTLI_PARAM_SIZE_HINT]: source.length
+          }
+        });
+        const gzip = zlib.gzipSync(source, { level: zlib.constants.Z_BEST_COMPRESSION });
+        for (const [extension, compressed] of [
+          [".br", brotli],
+          [".gz", gzip]
+        ] as const) {
+          const sidecarPath = `${filePath}${extension}`;
+          if (compressed.length < source.length) {
+            fs.writeFileSync(sidecarPath, compressed);
+          } else if (fs.existsSync(sidecarPath)) {
+            fs.unlinkSync(sidecarPath);
+          }
+        }
+      }
+    }
+  };
+}
+
 export default defineConfig(({ mode }) => {
   const isSsrBundle = mode === "ssr";
   const isWatchMode = process.argv.includes("--watch");
@@ -876,6 +951,11 @@ export default defineConfig(({ mode }) => {
       createPruneHashedAssetsPlugin({
         enabled: !isSsrBundle && !isWatchMode
       }),
+      // After pruning, which would otherwise remove this build's sidecars as
+      // files the bundle did not emit.
+      createPrecompressPlugin({
+        enabled: !isSsrBundle && !isWatchMode && readStaticSidecarsEnabled()
+      }),
       react()
     ],
     server: {